@@ -276,6 +276,59 @@ double feature_extraction_test_FASTER( int N, int threshold )
 }
 
 
+// ------------------------------------------------------
+//				Benchmark: ORB detector + descriptors
+// ------------------------------------------------------
+double feature_extraction_test_ORB( int N, int nOctaves )
+{
+	CTicTac			tictac;
+
+	CImage  img;
+	getTestImage(0,img);
+
+	CFeatureExtraction		fExt;
+	CFeatureList			feats;
+
+	fExt.options.featsType	= featORB;
+	fExt.options.ORBOptions.n_levels = nOctaves;
+	fExt.options.patchSize = 0;
+
+	img.grayscaleInPlace();
+
+	tictac.Tic();
+	for (int i=0;i<N;i++)
+		fExt.detectFeatures( img, feats, 0, 500 );
+
+	const double T = tictac.Tac()/N;
+	return T;
+}
+
+// ------------------------------------------------------
+//				Benchmark: ORB descriptors of FASTER-9 features
+// ------------------------------------------------------
+double feature_extraction_test_ORB_desc( int N, int h )
+{
+	CTicTac			tictac;
+
+	CImage  img;
+	getTestImage(0,img);
+	img.grayscaleInPlace();
+
+	CFeatureExtraction		fExt;
+	CFeatureList			feats;
+
+	fExt.options.featsType	= featFASTER9;
+	fExt.options.patchSize = 0;
+	fExt.detectFeatures( img, feats, 0, 500 );
+
+	tictac.Tic();
+	for (int i=0;i<N;i++)
+		fExt.computeDescriptors( img, feats, descORB );
+
+	const double T = tictac.Tac()/N;
+	return T;
+}
+
 // ------------------------------------------------------
 // register_tests_feature_extraction
 // ------------------------------------------------------
@@ -298,6 +351,10 @@ void register_tests_feature_extraction()
 	lstTests.push_back( TestData("feature_extraction [640x480]: FASTER-12", feature_extraction_test_FASTER<featFASTER12,0>, 100 , 20 ) );
 	lstTests.push_back( TestData("feature_extraction [640x480]: FASTER-12 (sorted best 200)", feature_extraction_test_FASTER<featFASTER12,200>, 100 , 20 ) );
 
+	lstTests.push_back( TestData("feature_extraction [640x480]: ORB (1 octave, best 500)", feature_extraction_test_ORB, 100 , 1 ) );
+	lstTests.push_back( TestData("feature_extraction [640x480]: ORB (3 octaves, best 500)", feature_extraction_test_ORB, 100 , 3 ) );
+	lstTests.push_back( TestData("feature_extraction [640x480]: ORB desc. (500 FASTER-9)", feature_extraction_test_ORB_desc, 100 ) );
+
 	lstTests.push_back( TestData("feature_extraction [640x480]: detectFeatures_SSE2_FASTER9()", feature_extraction_test_FAST9<640,480,false>, 1000 ) );
 	lstTests.push_back( TestData("feature_extraction [640x480]: detectFeatures_SSE2_FASTER10()", feature_extraction_test_FAST10<640,480,false>, 1000 ) );
 	lstTests.push_back( TestData("feature_extraction [640x480]: detectFeatures_SSE2_FASTER12()", feature_extraction_test_FAST12<640,480,false>, 1000 ) );
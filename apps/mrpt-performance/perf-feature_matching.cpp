@@ -254,6 +254,41 @@ double feature_matching_test_FAST_SAD( int w, int h )
 	return T;
 }
 
+// ------------------------------------------------------
+//				Benchmark: ORB + Hamming distance
+// ------------------------------------------------------
+double feature_matching_test_ORB( int w, int h )
+{
+	CTicTac	 tictac;
+
+	CImage  imL, imR;
+	CFeatureExtraction	fExt;
+	CFeatureList		featsORB_L, featsORB_R;
+	CMatchedFeatureList	mORB;
+
+	getTestImage(0,imR);
+	getTestImage(1,imL);
+
+	// Extract features: ORB
+	fExt.options.featsType = featORB;
+	fExt.options.patchSize = 0;
+
+	TMatchingOptions	opt;
+	const size_t		N = 20;
+	opt.matching_method			= TMatchingOptions::mmDescriptorORB;
+
+	tictac.Tic();
+	for (size_t i=0;i<N;i++)
+	{
+		fExt.detectFeatures( imL, featsORB_L, 0, NFEATS );
+		fExt.detectFeatures( imR, featsORB_R, 0, NFEATS );
+		matchFeatures( featsORB_L, featsORB_R, mORB, opt );
+	}
+	const double T = tictac.Tac()/N;
+
+	return T;
+}
+
 // ------------------------------------------------------
 // register_tests_feature_extraction
 // ------------------------------------------------------
@@ -265,4 +300,5 @@ void register_tests_feature_matching()
 	lstTests.push_back( TestData("feature_matching [640x480]: SURF", feature_matching_test_SURF, 640, 480 ) );
 	lstTests.push_back( TestData("feature_matching [640x480]: FAST + CC", feature_matching_test_FAST_CC, 640, 480 ) );
 	lstTests.push_back( TestData("feature_matching [640x480]: FAST + SAD", feature_matching_test_FAST_SAD, 640, 480 ) );
+	lstTests.push_back( TestData("feature_matching [640x480]: ORB", feature_matching_test_ORB, 640, 480 ) );
 }
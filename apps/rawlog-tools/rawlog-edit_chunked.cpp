@@ -0,0 +1,67 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "rawlog-edit-declarations.h"
+
+using namespace mrpt;
+using namespace mrpt::utils;
+using namespace mrpt::slam;
+using namespace mrpt::system;
+using namespace mrpt::rawlogtools;
+using namespace std;
+
+
+// ======================================================================
+//		op_to_chunked
+// ======================================================================
+DECLARE_OP_FUNCTION(op_to_chunked)
+{
+	// Do the checks on the output file (-o, --overwrite), then write it with the chunked writer instead of the gz stream:
+	TOutputRawlogCreator	outrawlog;
+	outrawlog.out_rawlog.close();
+
+	size_t chunk_size_kb = 1024;
+	getArgValue<size_t>(cmdline,"chunk-size",chunk_size_kb);
+	if (!chunk_size_kb)
+		throw std::runtime_error("--chunk-size must be greater than zero.");
+
+	CChunkedRawlogWriter  out_rawlog(outrawlog.out_rawlog_filename, chunk_size_kb*1024);
+
+	CTicTac tictac;
+	tictac.Tic();
+
+	// Copy all the objects as they are (including comments, which are not returned by CRawlog::getActionObservationPairOrObservation):
+	for (;;)
+	{
+		CSerializablePtr obj;
+		try
+		{
+			in_rawlog >> obj;
+		}
+		catch (CExceptionEOF &)
+		{
+			break;
+		}
+		out_rawlog.write(*obj);
+
+		if (verbose && (out_rawlog.getEntryCount() % 1000)==0)
+		{
+			std::cout << "[rawlog-edit] Progress: " << out_rawlog.getEntryCount() << " objects\r";
+			std::cout.flush();
+		}
+	}
+	if (verbose) std::cout << "\n"; // new line after the "\r".
+
+	const size_t nEntries = out_rawlog.getEntryCount();
+	out_rawlog.close();
+
+	VERBOSE_COUT << "Time to convert file (sec)  : " << tictac.Tac() << "\n";
+	VERBOSE_COUT << "Number of entries written   : " << nEntries << "\n";
+	VERBOSE_COUT << "Output file size            : " << mrpt::system::unitsFormat(mrpt::system::getFileSize(outrawlog.out_rawlog_filename)) << "B\n";
+}
@@ -58,6 +58,7 @@ DECLARE_OP_FUNCTION(op_stereo_rectify);
 DECLARE_OP_FUNCTION(op_rename_externals);
 DECLARE_OP_FUNCTION(op_list_timestamps);
 DECLARE_OP_FUNCTION(op_remap_timestamps);
+DECLARE_OP_FUNCTION(op_to_chunked);
 
 // Declare the supported command line switches ===========
 TCLAP::CmdLine cmd("rawlog-edit", ' ', MRPT_getVersion().c_str());
@@ -78,6 +79,8 @@ TCLAP::ValueArg<uint64_t> arg_to_index  ("","to-index",  "End index for --cut",f
 TCLAP::ValueArg<double> arg_from_time("","from-time","Starting time for --cut, as UNIX timestamp, optionally with fractions of seconds.",false,0,"T0",cmd);
 TCLAP::ValueArg<double> arg_to_time  ("","to-time",  "End time for --cut, as UNIX timestamp, optionally with fractions of seconds.",false,0,"T1",cmd);
 
+TCLAP::ValueArg<size_t> arg_chunk_size("","chunk-size","Size of the chunks for --to-chunked, in KiB before compression (default: 1024)",false,1024,"KiB",cmd);
+
 TCLAP::SwitchArg arg_overwrite("w","overwrite","Force overwrite target file without prompting.",cmd, false);
 
 TCLAP::SwitchArg arg_quiet("q","quiet","Terse output",cmd, false);
@@ -231,6 +234,14 @@ int main(int argc, char **argv)
 			,cmd,false));
 		ops_functors["rename-externals"] = &op_rename_externals;
 
+		arg_ops.push_back(new TCLAP::SwitchArg("","to-chunked",
+			"Op: Converts the rawlog into the chunked & indexed format (zlib-compressed chunks plus an index with the timestamp, sensor label and class of each entry), "
+			"which allows seeking to any entry or timestamp without decompressing the whole file. It is read by any program that loads rawlogs with CRawlog.\n"
+			"Requires: -o (or --output)\n"
+			"Optional: --chunk-size\n"
+			,cmd,false));
+		ops_functors["to-chunked"] = &op_to_chunked;
+
 
 
 		// --------------- End of list of possible operations --------
@@ -1,6 +1,6 @@
-# SSE{2,3,4} extensions?
+# SSE{2,3,4} and AVX2 extensions?
 # ===================================================
-SET(MRPT_AUTODETECT_SSE ON CACHE BOOL "Check /proc/cpuinfo to determine if SSE{2,3,4} optimizations are available")
+SET(MRPT_AUTODETECT_SSE ON CACHE BOOL "Check /proc/cpuinfo to determine if SSE{2,3,4} and AVX2 optimizations are available")
 MARK_AS_ADVANCED(MRPT_AUTODETECT_SSE)
 
 IF (MRPT_AUTODETECT_SSE AND EXISTS "/proc/cpuinfo")
@@ -46,5 +46,17 @@ ELSE (MRPT_AUTODETECT_SSE AND EXISTS "/proc/cpuinfo")
 
 ENDIF(MRPT_AUTODETECT_SSE AND EXISTS "/proc/cpuinfo")
 
-MESSAGE(STATUS "CPU supported SIMD extensions: SSE2=${CMAKE_MRPT_HAS_SSE2} SSE3=${CMAKE_MRPT_HAS_SSE3} SSE4=${CMAKE_MRPT_HAS_SSE4} ")
+# AVX2 binaries don't run on older CPUs, so it must be explicitly enabled, even if the build machine has it:
+SET(DISABLE_AVX2 ON CACHE BOOL "Forces compilation WITHOUT AVX2 extensions (set to OFF to build binaries which require an AVX2 CPU)")
+MARK_AS_ADVANCED(DISABLE_AVX2)
+SET(CMAKE_MRPT_HAS_AVX2 0)
+IF (NOT DISABLE_AVX2)
+    SET(CMAKE_MRPT_HAS_AVX2 1)
+    # ... but not if autodetection says this CPU doesn't have it:
+    IF (MRPT_AUTODETECT_SSE AND EXISTS "/proc/cpuinfo" AND NOT "${MRPT_CPU_INFO}" MATCHES ".*avx2.*")
+        SET(CMAKE_MRPT_HAS_AVX2 0)
+    ENDIF (MRPT_AUTODETECT_SSE AND EXISTS "/proc/cpuinfo" AND NOT "${MRPT_CPU_INFO}" MATCHES ".*avx2.*")
+ENDIF (NOT DISABLE_AVX2)
+
+MESSAGE(STATUS "CPU supported SIMD extensions: SSE2=${CMAKE_MRPT_HAS_SSE2} SSE3=${CMAKE_MRPT_HAS_SSE3} SSE4=${CMAKE_MRPT_HAS_SSE4} AVX2=${CMAKE_MRPT_HAS_AVX2} ")
 
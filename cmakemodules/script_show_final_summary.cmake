@@ -78,7 +78,7 @@ IF(MRPT_AUTODETECT_SSE)
 ELSE(MRPT_AUTODETECT_SSE)
 	set(STR_SSE_DETECT_MODE "Manually set")
 ENDIF(MRPT_AUTODETECT_SSE)
-MESSAGE(STATUS " Use SIMD optimizations?           : SSE2=" ${CMAKE_MRPT_HAS_SSE2} " SSE3=" ${CMAKE_MRPT_HAS_SSE3} " SSE4=" ${CMAKE_MRPT_HAS_SSE4} " [" ${STR_SSE_DETECT_MODE} "]")
+MESSAGE(STATUS " Use SIMD optimizations?           : SSE2=" ${CMAKE_MRPT_HAS_SSE2} " SSE3=" ${CMAKE_MRPT_HAS_SSE3} " SSE4=" ${CMAKE_MRPT_HAS_SSE4} " AVX2=" ${CMAKE_MRPT_HAS_AVX2} " [" ${STR_SSE_DETECT_MODE} "]")
 
 IF($ENV{VERBOSE})
 	SHOW_CONFIG_LINE("Additional checks even in Release  " CMAKE_MRPT_ALWAYS_CHECKS_DEBUG)
@@ -43,6 +43,9 @@
 	- New classes:
 		- [mrpt-base]
 			- mrpt::synch::CPipe: OS-independent pipe support.
+			- mrpt::math::CIncrementalSparseCholesky: A sparse Cholesky decomposition which only recomputes the rows affected by the changes in the matrix, plus AMD fill-reducing orderings.
+		- [mrpt-graphslam]
+			- mrpt::graphslam::CIncrementalSpaOptimizer: An iSAM-like incremental optimizer for growing graphs of pose constraints, which keeps the Hessian and its decomposition between calls and only relinearizes the nodes with large increments.
 		- [mrpt-hwdrivers]
 			- mrpt::hwdrivers::CIMUXSens_MT4 : Support for 4th generation xSens MT IMU devices.
 			- mrpt::hwdrivers::CNationalInstrumentsDAQ: Support for acquisition boards compatible with National Instruments DAQmx Base - [(commit)](https://github.com/jlblancoc/mrpt/commit/a82a7e37997cfb77e7ee9e903bdb2a55e3040b35).
@@ -59,6 +62,8 @@
 			- mrpt::reactivenav::CAbstractPTGBasedReactive, as part of a large code refactoring of these classes: [(commit)](https://github.com/jlblancoc/mrpt/pull/4)
 				- mrpt::reactivenav::CReactiveNavigationSystem
 				- mrpt::reactivenav::CReactiveNavigationSystem3D
+		- [mrpt-vision]
+			- mrpt::vision::CHammingLSHIndex: Multi-probe LSH index of binary descriptors (ORB) with Hamming distance, with incremental insertion, parallel batched k-NN searches and per-group voting for place recognition. It can be used with a new version of mrpt::vision::find_descriptor_pairings().
 	- Changes in classes:
 		- Clean up and slight optimization of metric map matching API: - [(commit)](http://code.google.com/p/mrpt/source/detail?r=3446)
 			- <b>Methods marked as deprecated: </b>
@@ -71,6 +76,63 @@
 		- Method renamed mrpt::utils::CEnhancedMetaFile::selectVectorTextFont() to avoid shadowing mrpt::utils::CCanvas::selectTextFont()
 		- mrpt::reactivenav::CParameterizedTrajectoryGenerator: New method for inverse look-up of WS to TP space - [(commit)](https://github.com/jlblancoc/mrpt/commit/4d04ef50e3dea581bed6287d4ea6593034c47da3)
 			- mrpt::reactivenav::CParameterizedTrajectoryGenerator::inverseMap_WS2TP()
+		- mrpt::system::parallel_for(), mrpt::system::parallel_do() and mrpt::system::parallel_reduce() now run on a built-in work-stealing thread pool when MRPT is built without TBB, instead of falling back to a serial loop. Nested calls run serially. The number of threads can be set with mrpt::system::setNumberOfParallelThreads().
+		- mrpt::slam::COccupancyGridMap2D: The likelihood field model (lmLikelihoodField_Thrun) now uses an exact Euclidean distance transform built once per map change and updated incrementally after each observation insertion, instead of a search in a window of cells around each point. See mrpt::slam::COccupancyGridMap2D::updateLikelihoodField()
+		- Particle filters: New option mrpt::bayes::CParticleFilter::TParticleFilterOptions::parallelizeLikelihoods to evaluate the observation likelihood of all particles in parallel in mrpt::slam::CMonteCarloLocalization2D, mrpt::slam::CMonteCarloLocalization3D and mrpt::slam::CMultiMetricMapPDF. In the auxiliary PF algorithms, each particle draws its Monte Carlo samples from its own random generator, so results do not depend on the number of threads.
+			- New method mrpt::poses::CPoseRandomSampler::drawSample() with an explicit random generator.
+		- mrpt::slam::PF_implementation::getLastPose() (and its implementations in mrpt::slam::CMonteCarloLocalization2D, mrpt::slam::CMonteCarloLocalization3D and mrpt::slam::CMultiMetricMapPDF) now returns the pose by value instead of a pointer to a static variable, so it can be called from several threads.
+		- mrpt::random::CRandomGenerator: randomize() now also resets the cached second Gaussian sample, so two generators with the same seed always generate the same sequence.
+		- mrpt::slam::COccupancyGridMap2D: Cells (and the likelihood field buffers) are now stored in copy-on-write tiles of rows (new class mrpt::utils::CCopyOnWriteTiledBuffer), so copies of a map share memory until they modify it. In RBPF SLAM, resampling particles no longer duplicates whole grid maps. Only the cells within one row are contiguous now: use COccupancyGridMap2D::getRow() for direct access. Copies sharing tiles can be modified from different threads at once.
+			- New method mrpt::slam::COccupancyGridMap2D::getSharedMemoryStats()
+		- mrpt::math::KDTreeCapable: New option TKDTreeSearchParams::dynamic_index to keep the 2D/3D KD-trees as a forest of sub-trees, which are updated instead of rebuilt when points are appended or removed. Point maps (mrpt::slam::CPointsMap) signal accordingly the points appended by insertPoint(), insertAnotherMap() or the insertion of observations, and those removed by applyDeletionMask() or clipOutOfRange(), and mrpt::slam::CMetricMapBuilderICP enables it for its growing points maps.
+		- mrpt::slam::CPointsMap::determineMatching2D() and mrpt::slam::CPointsMap::determineMatching3D() search the correspondences of large point clouds in parallel blocks (same results than a serial search), and the 3D version transforms the points with SSE2.
+			- New methods mrpt::math::KDTreeCapable::kdTreeBuildIndex2D() and mrpt::math::KDTreeCapable::kdTreeBuildIndex3D(). KD-tree queries are now safe to run from several threads once the index is built.
+		- mrpt::slam::CICP: New algorithms mrpt::slam::icpPointToPlane and mrpt::slam::icpGeneralized (GICP), for both 2D and 3D alignment. The local surfaces come from the KD-tree neighbourhoods of the points, and each set of correspondences is used for several Gauss-Newton steps, so they converge with fewer correspondence searches than icpClassic. Both return a covariance from the Gauss-Newton Hessian.
+			- New options mrpt::slam::CICP::TConfigParams::normals_knn and mrpt::slam::CICP::TConfigParams::GICP_epsilon
+		- mrpt::slam::CICP: New multi-resolution mode (coarse-to-fine ICP on voxel-grid downsampled maps), enabled with mrpt::slam::CICP::TConfigParams::multiresolution_levels and mrpt::slam::CICP::TConfigParams::multiresolution_voxel_size. It works with all the ICP algorithms.
+			- New method mrpt::slam::CPointsMap::getVoxelDownsampled(). Its results, and their KD-trees, are cached until the map is modified.
+		- mrpt::slam::CRawlog: New chunked & indexed rawlog file format, with random access to entries by index or timestamp:
+			- New classes mrpt::slam::CChunkedRawlogWriter and mrpt::slam::CChunkedRawlogReader. The reader is a CStream, so it can be passed to mrpt::slam::CRawlog::readActionObservationPair() and mrpt::slam::CRawlog::getActionObservationPairOrObservation().
+			- New method mrpt::slam::CRawlog::saveToChunkedRawLogFile(). mrpt::slam::CRawlog::loadFromRawLogFile() detects the new format automatically.
+			- New operation `--to-chunked` in [rawlog-edit](http://www.mrpt.org/Application:rawlog-edit).
+		- mrpt::slam::CRawlog: New lazy-load mode for datasets larger than the available memory, with mrpt::slam::CRawlog::loadFromRawLogFileLazy(). Only the position of each entry is kept in memory, and entries are deserialized on demand (transparently for mrpt::slam::CRawlog::getAsObservation(), mrpt::slam::CRawlog::getAsObservations(), the iterators, etc.) and kept in a LRU cache with a maximum size in bytes.
+			- New class mrpt::slam::CRawlogLazyLoader
+			- New class mrpt::utils::CMemoryMappedFile
+		- mrpt::vision::CFeatureExtraction: New ORB features (mrpt::vision::featORB, mrpt::vision::descORB), natively implemented (no OpenCV needed for the descriptors):
+			- Multi-scale FASTER-9 detection with KLT scores and per-octave non-maximum suppression, parallelized over image row bands of all the octaves (see mrpt::system::parallel_for).
+			- New mrpt::vision::CFeatureExtraction::detectFeatures_SSE2_FASTER_pyramid() to detect FASTER corners in all the octaves of a mrpt::vision::CImagePyramid at once.
+			- Oriented rBRIEF-like 256-bit descriptors, computed in parallel. Matched with the new method mrpt::vision::TMatchingOptions::mmDescriptorORB.
+			- New mrpt::vision::CFeature::descriptorORBDistanceTo(). mrpt::vision::CFeature serialization version bumped to 2.
+		- New function mrpt::vision::hammingDistance(), which uses the POPCNT instruction if available.
+		- mrpt::vision::CFeatureTracker_KL: Now uses a native implementation of the pyramidal Lucas-Kanade tracker instead of OpenCV's cvCalcOpticalFlowPyrLK():
+			- The image pyramids and their gradients are kept between calls, so the pyramid of the "new" image of one frame is reused as the "old" one in the next frame.
+			- Features are tracked in parallel, with SSE2-optimized inner loops. New method mrpt::vision::CFeatureTracker_KL::clearPyramidCache().
+			- Fixed: the "LK_epsilon" parameter was truncated to an integer.
+		- mrpt::slam::CObservation3DRangeScan::project3DPointsFromDepthImageInto(): Faster projection of range images into point clouds:
+			- Points are projected, colored and transformed in one pass, by blocks of rows in parallel for large images, with SSE2 or AVX2 (AVX2 is opt-in, with the new CMake option DISABLE_AVX2=OFF, since such binaries do not run on older CPUs; see the macro MRPT_HAS_AVX2). The output point cloud is resized only once.
+			- New overload with mrpt::slam::T3DPointsProjectionParams, which also allows filtering by range and decimating the range image on the fly.
+			- The projection LUTs of the last 8 camera configurations are cached and shared by all threads (see mrpt::slam::CObservation3DRangeScan::get3DProjectionLUT()), so several cameras no longer rebuild each other's LUT.
+			- Fixed: with coinciding depth and intensity cameras, the color of each point was taken from the next pixel.
+		- mrpt::slam::COctoMap and mrpt::slam::CColouredOctoMap: Faster insertion of dense point clouds (e.g. RGB-D cameras):
+			- New option mrpt::slam::COctoMapBase::TInsertionOptions::fastInsertion: the points are downsampled to one ray per voxel, and rays are cast in parallel. See the new method mrpt::slam::COctoMapBase::computeUpdateFast().
+			- mrpt::slam::CObservation3DRangeScan observations with only a depth image (no 3D points) can now be inserted into octomaps: they are projected on the fly.
+		- mrpt::slam::COctoMap and mrpt::slam::CColouredOctoMap: Lower memory and faster save/load of large maps:
+			- New option mrpt::slam::COctoMapBase::TInsertionOptions::pruningMaxMemoryMB to defer pruning until the tree exceeds a memory budget. New methods mrpt::slam::COctoMapBase::prune() and mrpt::slam::COctoMapBase::getMemoryUsageEstimate().
+			- New compact serialization format (version 2 of both classes): only the tree structure and the leaves are stored, with their occupancy quantized to 8 bits, in run-length compressed streams which are decoded directly into the tree (no temporary files). Colors of mrpt::slam::CColouredOctoMap are now serialized too.
+			- Fixed: insertPointCloud() and insertRay() passed the "pruning" option as octomap's "lazy_eval" argument, so inner nodes were not updated.
+		- mrpt::graphslam::optimize_graph_spa_levmarq(): Faster on large graphs:
+			- The errors and Jacobians of the edges, and the gradient and Hessian blocks of the nodes, are computed in parallel for graphs with at least "parallel_min_edges" edges (new parameter). Each node is built by one thread only, so results are the same for any number of threads.
+			- Jacobians are stored in a contiguous vector instead of a map, and the look-up of the free nodes of each edge no longer takes a time quadratic in the graph size.
+		- mrpt-srba: New solver option mrpt::srba::options::solver_parallel<>, which wraps any other solver to build the numeric Hessian blocks and the Schur complement (mrpt::srba::SchurComplement) in parallel. Each block is computed by one thread only, so results are the same than with the serial solvers.
+		- mrpt-srba: Faster and lighter spanning trees for long runs:
+			- Paths in the spanning trees (mrpt::srba::kf2kf_pose_traits::k2k_edge_vector_t) and the adjacency lists of keyframes are now std::vector<> instead of std::deque<>, which allocated ~0.5 KB for each one.
+			- Breadth-first searches (mrpt::srba::RbaEngine::find_path_bfs(), mrpt::srba::RbaEngine::create_complete_spanning_tree()) use reusable working spaces indexed by keyframe ID instead of temporary maps and sets, and each modified path is rebuilt only once after inserting a new keyframe.
+			- Each Levenberg-Marquardt trial in mrpt::srba::RbaEngine::optimize_edges() only recomposes the relative poses actually used by the Jacobians of the optimized observations.
+		- New method mrpt::slam::COccupancyGridMap2D::laserScanSimulatorBatch() to simulate the scans of many robot poses at once (e.g. ray-casting particle filters). Rays skip free space with a chessboard distance transform of the grid and run in parallel, with results identical to laserScanSimulator().
+		- New method mrpt::slam::COccupancyGridMap2D::computeObservationLikelihood_rayTracingBatch() to evaluate the ray tracing (beam) likelihood model of one scan for a whole set of particles in parallel. The per-pose likelihood (lmRayTracing) now uses the same faster ray casting and only simulates the rays with a valid measured range.
+		- New batch methods to transform N points stored as separate arrays of coordinates: mrpt::poses::CPose3D::composePoints(), mrpt::poses::CPose3D::inverseComposePoints(), mrpt::poses::CPose3D::composePointsWithJacobians() and their counterparts in mrpt::poses::CPose2D and mrpt::poses::CPose3DQuat, with SSE2/AVX2 kernels in mrpt::math::transformPoints3D() and mrpt::math::transformPoints2D(). mrpt::slam::CPointsMap uses them in changeCoordinatesReference(), insertAnotherMap() and determineMatching3D().
+		- mrpt::random::CRandomGenerator can now use the counter-based Philox4x32-10 algorithm, with independent streams per (seed,stream) pair and constant-time skip-ahead: mrpt::random::CRandomGenerator::randomizeStream(), mrpt::random::CRandomGenerator::discard(). New bulk methods mrpt::random::CRandomGenerator::drawGaussian1DArray(), mrpt::random::CRandomGenerator::drawUniformArray() and mrpt::random::CRandomGenerator::drawUniform32bitArray(). The per-particle generators of the parallel auxiliary particle filters are now Philox streams.
+		- mrpt::slam::data_association_full_covariance(): the JCBB search now runs in parallel over subtrees sharing the best bound, only evaluates the joint distance of the candidate hypotheses (extending the Cholesky factor of the previous one instead of inverting the joint covariance) and accepts a time budget (see mrpt::slam::TDataAssociationResults::JCBB_timeout). Hypotheses which could tie with the best number of pairings are no longer pruned, so among those the one with the best joint distance is always returned.
 	- Deleted classes:
 		- mrpt::utils::CEvent, which was actually unimplemented (!)
 		- mrpt::hwdrivers::CInterfaceNI845x has been deleted. It didn't offer features enough to justify a class.
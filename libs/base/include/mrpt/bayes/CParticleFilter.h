@@ -145,6 +145,14 @@ namespace mrpt
 				/** (Default=false) In the algorithm "CParticleFilter::pfAuxiliaryPFOptimal", if set to true, do not perform rejection sampling, but just the most-likely (ML) particle found in the preliminary weight-determination stage.
 				  */
 				bool pfAuxFilterOptimal_MLE;
+
+				/** (Default=false) If set to true, the observation likelihoods of the particles (and, in the auxiliary PF algorithms, of the Monte Carlo samples used to estimate the first stage weights)
+				  *  are evaluated in parallel with mrpt::system::parallel_for(). Use mrpt::system::setNumberOfParallelThreads() to set the number of threads.
+				  *  The Monte Carlo samples of each particle are drawn from its own random generator, seeded from mrpt::random::randomGenerator, so the results only depend on the seed of the latter and not on the number of threads.
+				  *  \note The metric maps must support concurrent calls to computeObservationLikelihood(). Lazily built caches shared by all the particles (e.g. the likelihood field of the map in Monte Carlo localization, or the points map of a scan) are safe, since the first particle is always evaluated alone.
+				  *   However, in Rao-Blackwellized filters each particle has its own maps, which build their caches concurrently (e.g. the likelihood field of each occupancy grid), so those maps must not share writable data with the maps of other particles.
+				  */
+				bool parallelizeLikelihoods;
 			};
 
 
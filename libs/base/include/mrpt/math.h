@@ -34,12 +34,14 @@
 
 #include <mrpt/math/CPolygon.h>
 #include <mrpt/math/geometry.h>
+#include <mrpt/math/transform_points.h>
 
 #include <mrpt/math/CSplineInterpolator1D.h>
 
 #include <mrpt/math/lightweight_geom_data.h>
 #include <mrpt/math/CSparseMatrixTemplate.h>
 #include <mrpt/math/CSparseMatrix.h>
+#include <mrpt/math/CIncrementalSparseCholesky.h>
 #include <mrpt/math/MatrixBlockSparseCols.h>
 
 #include <mrpt/math/CBinaryRelation.h>
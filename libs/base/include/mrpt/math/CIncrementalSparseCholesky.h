@@ -0,0 +1,111 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef CIncrementalSparseCholesky_H
+#define CIncrementalSparseCholesky_H
+
+#include <mrpt/math/CSparseMatrix.h>
+
+namespace mrpt
+{
+	namespace math
+	{
+		/** A sparse Cholesky decomposition A = L*L' which can be updated incrementally, by only recomputing the part of L affected by the changes in A.
+		  *
+		  *  The (upper triangular part of the) square, definite-positive matrix A is set by columns with setColumn(), and it can grow with resize().
+		  *   Since the row "k" of L only depends on the first "k" columns of A, the next call to factorize() keeps all the rows of L above the first modified column of A,
+		  *   and only computes the remaining ones (with an "up-looking" algorithm, as cs_chol() in CSparse). Therefore, adding new columns at the end of A, or
+		  *   modifying its last columns, is much cheaper than a full decomposition.
+		  *
+		  *  The order of the variables (rows and columns of A) is up to the user, who should use a fill-reducing ordering (see computeFillReducingOrdering())
+		  *   and, to take advantage of the incremental updates, place the variables which change more often at the end.
+		  *
+		  *  Example of usage:
+		  *  \code
+		  *    CIncrementalSparseCholesky  chol;
+		  *    chol.resize(N);
+		  *    for (size_t c=0;c<N;c++)
+		  *       chol.setColumn(c, column_entries[c]);  // (row,value) pairs, with row<=c
+		  *    chol.factorize();
+		  *    chol.solve(b,x);
+		  *    // Add one more variable and only refactor its row of L:
+		  *    chol.resize(N+1);
+		  *    chol.setColumn(N, new_entries);
+		  *    chol.factorize();
+		  *  \endcode
+		  *
+		  * \note Changes are not applied as rank-one updates/downdates of L (as cs_updown() in CSparse does), since these only work if the nonzero pattern of L
+		  *   (and its elimination tree) does not change. A new constraint between two existing variables (e.g. a loop closure) usually adds fill-in to L,
+		  *   and relinearizing a variable changes whole blocks of A, not just a few rank-one terms. Recomputing the rows of L from the first modified
+		  *   column handles all these cases, and it only costs the new rows when the modified variables are at the end.
+		  * \note This class is used by mrpt::graphslam::CIncrementalSpaOptimizer.
+		  * \sa CSparseMatrix::CholeskyDecomp
+		  * \ingroup mrpt_base_grp
+		  */
+		class BASE_IMPEXP CIncrementalSparseCholesky
+		{
+		public:
+			typedef std::vector<std::pair<size_t,double> > column_t; //!< A sparse column, as pairs (row,value)
+
+			CIncrementalSparseCholesky(); //!< Default constructor: an empty matrix
+
+			void clear(); //!< Empties the matrix and its decomposition
+
+			/** Changes the size of the matrix A: new columns are empty (they must be set with setColumn() before calling factorize()), and the entries of the
+			  *  remaining columns in the removed rows are also removed. */
+			void resize(const size_t N);
+
+			inline size_t getSize() const { return m_A.size(); } //!< The number of rows and columns of A
+
+			/** Sets all the entries of the upper triangular part of one column of A (repeated rows are added up).
+			  * \exception std::exception If any row is out of [0,col]
+			  */
+			void setColumn(const size_t col, const column_t &entries);
+
+			/** Marks all the columns of A as modified, so the next call to factorize() will recompute the entire decomposition */
+			inline void invalidate() { m_first_modified = 0; }
+
+			/** Updates the decomposition, from the first column of A modified since the last call.
+			  * \exception mrpt::math::CExceptionNotDefPos If the matrix is not definite positive. The decomposition will be resumed from the failing column in the next call.
+			  */
+			void factorize();
+
+			/** Whether the decomposition is up to date (i.e. factorize() has been called after the last change of A) */
+			inline bool isFactorized() const { return m_first_modified>=m_A.size(); }
+
+			/** Solves A*x=b, with A given by its last decomposition.
+			  * \exception std::exception If the decomposition is not up to date.
+			  */
+			void solve(const mrpt::vector_double &b, mrpt::vector_double &out_x) const;
+
+			size_t getMatrixNonZeros() const { return m_nnzA; } //!< The number of stored entries of A (its upper triangular part)
+			size_t getFactorNonZeros() const; //!< The number of (structurally) non-zero entries in L
+			size_t getLastRefactoredColumns() const { return m_last_refactored; } //!< The number of rows of L which were computed in the last call to factorize()
+
+			/** Computes a fill-reducing ordering (Approximate Minimum Degree, cs_amd() in CSparse) for the decomposition of a symmetric matrix of size N with the given
+			  *  pairs of non-zero off-diagonal entries (only one of (i,j) or (j,i) is needed).
+			  * \param[out] out_order The variable to place at each position, i.e. the new matrix is A(out_order,out_order).
+			  */
+			static void computeFillReducingOrdering(
+				const size_t N,
+				const std::vector<std::pair<size_t,size_t> > &nonzero_pairs,
+				std::vector<size_t> &out_order );
+
+		private:
+			std::vector<column_t>  m_A; //!< The upper triangular part of A, by columns
+			std::vector<column_t>  m_L; //!< L, by columns: the diagonal entry first, then the rest in ascending order of rows
+			std::vector<size_t>    m_parent; //!< The elimination tree: the first off-diagonal row in each column of L
+			size_t m_first_modified, m_last_refactored, m_nnzA;
+
+			std::vector<double>    m_work;  //!< Temporary vectors for factorize()
+			std::vector<size_t>    m_flag, m_stack;
+		};
+
+	} // End of namespace
+} // End of namespace
+#endif
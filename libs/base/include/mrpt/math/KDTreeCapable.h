@@ -23,6 +23,19 @@ namespace mrpt
 		  *  \ingroup mrpt_base_grp
 		  *  @{ */
 
+		namespace detail
+		{
+			/** Gives the type of a nanoflann metric class for a different data source (used by the sub-trees of the dynamic KD-tree index of KDTreeCapable) */
+			template <class METRIC, class NEW_DATASOURCE> struct kdtree_rebind_metric;
+
+			template <class T, class DS, typename DT, class NEW_DATASOURCE>
+			struct kdtree_rebind_metric<nanoflann::L1_Adaptor<T,DS,DT>,NEW_DATASOURCE> { typedef nanoflann::L1_Adaptor<T,NEW_DATASOURCE,DT> type; };
+			template <class T, class DS, typename DT, class NEW_DATASOURCE>
+			struct kdtree_rebind_metric<nanoflann::L2_Adaptor<T,DS,DT>,NEW_DATASOURCE> { typedef nanoflann::L2_Adaptor<T,NEW_DATASOURCE,DT> type; };
+			template <class T, class DS, typename DT, class NEW_DATASOURCE>
+			struct kdtree_rebind_metric<nanoflann::L2_Simple_Adaptor<T,DS,DT>,NEW_DATASOURCE> { typedef nanoflann::L2_Simple_Adaptor<T,NEW_DATASOURCE,DT> type; };
+		}
+
 
 		/** A generic adaptor class for providing Approximate Nearest Neighbors (ANN) (via the nanoflann library) to MRPT classses.
 		 *   This makes use of the CRTP design pattern.
@@ -60,6 +73,15 @@ namespace mrpt
 		 *  to group all the calls for a given dimensionality together or build different class instances for
 		 *  queries of each dimensionality, etc.
 		 *
+		 *  <b>Dynamic index:</b> If TKDTreeSearchParams::dynamic_index is set to true, the 2D and 3D indices are kept as a
+		 *  "forest" of static KD-trees, each one indexing a contiguous range of data points, with sizes decreasing
+		 *  geometrically (the "logarithmic method"). Then, derived classes which only append new points at the end
+		 *  may call kdtree_mark_as_appended() instead of kdtree_mark_as_outdated(), and only a new sub-tree is built for
+		 *  the new points (merged with the last sub-trees if these are not larger), with an amortized cost of O(log N) per point
+		 *  instead of rebuilding the whole tree. Removing points is signaled with kdtree_mark_as_removed(),
+		 *  and only the sub-trees which contained some removed point are rebuilt upon the next query. Queries search all the sub-trees and return exactly the same results
+		 *  than with a single KD-tree.
+		 *
 		 *  \sa See some of the derived classes for example implementations. See also the documentation of nanoflann
 		 * \ingroup mrpt_base_grp
 		 */
@@ -86,12 +108,14 @@ namespace mrpt
 			{
 				TKDTreeSearchParams() :
 					nChecks(32),
-					leaf_max_size(10)
+					leaf_max_size(10),
+					dynamic_index(false)
 				{
 				}
 
 				int nChecks; //!< The number of checks for ANN (default: 32) - corresponds to FLANN's SearchParams::check
 				size_t leaf_max_size; //!< Max points per leaf
+				bool dynamic_index; //!< (Default=false) Keep the 2D/3D indices as a forest of sub-trees which are updated, not rebuilt, when points are appended or removed. Useful for maps which continuously grow (see the class description).
 			};
 
 			TKDTreeSearchParams  kdtree_search_params; //!< Parameters to tune the ANN searches
@@ -131,9 +155,8 @@ namespace mrpt
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&ret_index, &out_dist_sqr );
 
-				m_kdtree2d_data.query_point[0] = x0;
-				m_kdtree2d_data.query_point[1] = y0;
-		        m_kdtree2d_data.index->findNeighbors(resultSet, &m_kdtree2d_data.query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
+				const num_t query_point[2] = { x0, y0 };
+		        m_kdtree2d_data.findNeighbors(resultSet, &query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
 
 				// Copy output to user vars:
 				out_x = derived().kdtree_get_pt(ret_index,0);
@@ -158,9 +181,8 @@ namespace mrpt
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&ret_index, &out_dist_sqr );
 
-				m_kdtree2d_data.query_point[0] = x0;
-				m_kdtree2d_data.query_point[1] = y0;
-		        m_kdtree2d_data.index->findNeighbors(resultSet, &m_kdtree2d_data.query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
+				const num_t query_point[2] = { x0, y0 };
+		        m_kdtree2d_data.findNeighbors(resultSet, &query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
 
 				return ret_index;
 				MRPT_END
@@ -227,9 +249,8 @@ namespace mrpt
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&ret_indexes[0], &ret_sqdist[0] );
 
-				m_kdtree2d_data.query_point[0] = x0;
-				m_kdtree2d_data.query_point[1] = y0;
-		        m_kdtree2d_data.index->findNeighbors(resultSet, &m_kdtree2d_data.query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
+				const num_t query_point[2] = { x0, y0 };
+		        m_kdtree2d_data.findNeighbors(resultSet, &query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
 
 				// Copy output to user vars:
 				out_x1 = derived().kdtree_get_pt(ret_indexes[0],0);
@@ -261,7 +282,7 @@ namespace mrpt
 			  *
 			  * \param x0  The X coordinate of the query.
 			  * \param y0  The Y coordinate of the query.
-			  * \param N The number of closest points to search.
+			  * \param N The number of closest points to search (if there are fewer points in the KD-tree, only those are returned and the output vectors resized accordingly).
 			  * \param out_x The vector containing the X coordinates of the correspondences.
 			  * \param out_y The vector containing the Y coordinates of the correspondences.
 			  * \param out_dist_sqr The vector containing the square distance between the query and the returned points.
@@ -282,6 +303,7 @@ namespace mrpt
 				MRPT_START
 				rebuild_kdTree_2D(); // First: Create the 2D KD-Tree if required
 				if ( !m_kdtree2d_data.m_num_points ) THROW_EXCEPTION("There are no points in the KD-tree.")
+				if (knn>m_kdtree2d_data.m_num_points) knn = m_kdtree2d_data.m_num_points; // There can't be more neighbors than points
 
 				std::vector<size_t> ret_indexes(knn);
 				out_x.resize(knn);
@@ -291,9 +313,8 @@ namespace mrpt
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&ret_indexes[0], &out_dist_sqr[0] );
 
-				m_kdtree2d_data.query_point[0] = x0;
-				m_kdtree2d_data.query_point[1] = y0;
-		        m_kdtree2d_data.index->findNeighbors(resultSet, &m_kdtree2d_data.query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
+				const num_t query_point[2] = { x0, y0 };
+		        m_kdtree2d_data.findNeighbors(resultSet, &query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
 
 				for (size_t i=0;i<knn;i++)
 				{
@@ -323,7 +344,7 @@ namespace mrpt
 			  *
 			  * \param x0  The X coordinate of the query.
 			  * \param y0  The Y coordinate of the query.
-			  * \param N The number of closest points to search.
+			  * \param N The number of closest points to search (if there are fewer points in the KD-tree, only those are returned and the output vectors resized accordingly).
 			  * \param out_idx The indexes of the found closest correspondence.
 			  * \param out_dist_sqr The square distance between the query and the returned point.
 			  *
@@ -339,15 +360,15 @@ namespace mrpt
 				MRPT_START
 				rebuild_kdTree_2D(); // First: Create the 2D KD-Tree if required
 				if ( !m_kdtree2d_data.m_num_points ) THROW_EXCEPTION("There are no points in the KD-tree.")
+				if (knn>m_kdtree2d_data.m_num_points) knn = m_kdtree2d_data.m_num_points; // There can't be more neighbors than points
 
 				out_idx.resize(knn);
 				out_dist_sqr.resize(knn);
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&out_idx[0], &out_dist_sqr[0] );
 
-				m_kdtree2d_data.query_point[0] = x0;
-				m_kdtree2d_data.query_point[1] = y0;
-		        m_kdtree2d_data.index->findNeighbors(resultSet, &m_kdtree2d_data.query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
+				const num_t query_point[2] = { x0, y0 };
+		        m_kdtree2d_data.findNeighbors(resultSet, &query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
 				MRPT_END
 			}
 
@@ -391,10 +412,8 @@ namespace mrpt
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&ret_index, &out_dist_sqr );
 
-				m_kdtree3d_data.query_point[0] = x0;
-				m_kdtree3d_data.query_point[1] = y0;
-				m_kdtree3d_data.query_point[2] = z0;
-		        m_kdtree3d_data.index->findNeighbors(resultSet, &m_kdtree3d_data.query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
+				const num_t query_point[3] = { x0, y0, z0 };
+		        m_kdtree3d_data.findNeighbors(resultSet, &query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
 
 				// Copy output to user vars:
 				out_x = derived().kdtree_get_pt(ret_index,0);
@@ -422,10 +441,8 @@ namespace mrpt
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&ret_index, &out_dist_sqr );
 
-				m_kdtree3d_data.query_point[0] = x0;
-				m_kdtree3d_data.query_point[1] = y0;
-				m_kdtree3d_data.query_point[2] = z0;
-		        m_kdtree3d_data.index->findNeighbors(resultSet, &m_kdtree3d_data.query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
+				const num_t query_point[3] = { x0, y0, z0 };
+		        m_kdtree3d_data.findNeighbors(resultSet, &query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
 
 				return ret_index;
 				MRPT_END
@@ -450,7 +467,7 @@ namespace mrpt
 			  * \param x0  The X coordinate of the query.
 			  * \param y0  The Y coordinate of the query.
 			  * \param z0  The Z coordinate of the query.
-			  * \param N The number of closest points to search.
+			  * \param N The number of closest points to search (if there are fewer points in the KD-tree, only those are returned and the output vectors resized accordingly).
 			  * \param out_x The vector containing the X coordinates of the correspondences.
 			  * \param out_y The vector containing the Y coordinates of the correspondences.
 			  * \param out_z The vector containing the Z coordinates of the correspondences.
@@ -471,6 +488,7 @@ namespace mrpt
 				MRPT_START
 				rebuild_kdTree_3D(); // First: Create the 3D KD-Tree if required
 				if ( !m_kdtree3d_data.m_num_points ) THROW_EXCEPTION("There are no points in the KD-tree.")
+				if (knn>m_kdtree3d_data.m_num_points) knn = m_kdtree3d_data.m_num_points; // There can't be more neighbors than points
 
 				std::vector<size_t> ret_indexes(knn);
 				out_x.resize(knn);
@@ -481,10 +499,8 @@ namespace mrpt
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&ret_indexes[0], &out_dist_sqr[0] );
 
-				m_kdtree3d_data.query_point[0] = x0;
-				m_kdtree3d_data.query_point[1] = y0;
-				m_kdtree3d_data.query_point[2] = z0;
-				m_kdtree3d_data.index->findNeighbors(resultSet, &m_kdtree3d_data.query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
+				const num_t query_point[3] = { x0, y0, z0 };
+				m_kdtree3d_data.findNeighbors(resultSet, &query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
 
 				for (size_t i=0;i<knn;i++)
 				{
@@ -504,7 +520,7 @@ namespace mrpt
 			  * \param x0  The X coordinate of the query.
 			  * \param y0  The Y coordinate of the query.
 			  * \param z0  The Z coordinate of the query.
-			  * \param N The number of closest points to search.
+			  * \param N The number of closest points to search (if there are fewer points in the KD-tree, only those are returned and the output vectors resized accordingly).
 			  * \param out_x The vector containing the X coordinates of the correspondences.
 			  * \param out_y The vector containing the Y coordinates of the correspondences.
 			  * \param out_z The vector containing the Z coordinates of the correspondences.
@@ -527,6 +543,7 @@ namespace mrpt
 				MRPT_START
 				rebuild_kdTree_3D(); // First: Create the 3D KD-Tree if required
 				if ( !m_kdtree3d_data.m_num_points ) THROW_EXCEPTION("There are no points in the KD-tree.")
+				if (knn>m_kdtree3d_data.m_num_points) knn = m_kdtree3d_data.m_num_points; // There can't be more neighbors than points
 
 				out_x.resize(knn);
 				out_y.resize(knn);
@@ -537,10 +554,8 @@ namespace mrpt
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&out_idx[0], &out_dist_sqr[0] );
 
-				m_kdtree3d_data.query_point[0] = x0;
-				m_kdtree3d_data.query_point[1] = y0;
-				m_kdtree3d_data.query_point[2] = z0;
-				m_kdtree3d_data.index->findNeighbors(resultSet, &m_kdtree3d_data.query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
+				const num_t query_point[3] = { x0, y0, z0 };
+				m_kdtree3d_data.findNeighbors(resultSet, &query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
 
 				for (size_t i=0;i<knn;i++)
 				{
@@ -588,7 +603,7 @@ namespace mrpt
 				if ( m_kdtree3d_data.m_num_points!=0 )
 				{
 					const float xyz[3] = {x0,y0,z0};
-					m_kdtree3d_data.index->radiusSearch(&xyz[0], maxRadius, out_indices_dist, nanoflann::SearchParams(kdtree_search_params.nChecks) );
+					m_kdtree3d_data.radiusSearch(&xyz[0], maxRadius, out_indices_dist, nanoflann::SearchParams(kdtree_search_params.nChecks) );
 				}
 				return out_indices_dist.size();
 				MRPT_END
@@ -619,7 +634,7 @@ namespace mrpt
 				if ( m_kdtree2d_data.m_num_points!=0 )
 				{
 					const float xyz[2] = {x0,y0};
-					m_kdtree2d_data.index->radiusSearch(&xyz[0], maxRadius, out_indices_dist, nanoflann::SearchParams(kdtree_search_params.nChecks) );
+					m_kdtree2d_data.radiusSearch(&xyz[0], maxRadius, out_indices_dist, nanoflann::SearchParams(kdtree_search_params.nChecks) );
 				}
 				return out_indices_dist.size();
 				MRPT_END
@@ -634,7 +649,7 @@ namespace mrpt
 			  * \param x0  The X coordinate of the query.
 			  * \param y0  The Y coordinate of the query.
 			  * \param z0  The Z coordinate of the query.
-			  * \param N The number of closest points to search.
+			  * \param N The number of closest points to search (if there are fewer points in the KD-tree, only those are returned and the output vectors resized accordingly).
 			  * \param out_idx The indexes of the found closest correspondence.
 			  * \param out_dist_sqr The square distance between the query and the returned point.
 			  *
@@ -651,16 +666,15 @@ namespace mrpt
 				MRPT_START
 				rebuild_kdTree_3D(); // First: Create the 3D KD-Tree if required
 				if ( !m_kdtree3d_data.m_num_points ) THROW_EXCEPTION("There are no points in the KD-tree.")
+				if (knn>m_kdtree3d_data.m_num_points) knn = m_kdtree3d_data.m_num_points; // There can't be more neighbors than points
 
 				out_idx.resize(knn);
 				out_dist_sqr.resize(knn);
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&out_idx[0], &out_dist_sqr[0] );
 
-				m_kdtree3d_data.query_point[0] = x0;
-				m_kdtree3d_data.query_point[1] = y0;
-				m_kdtree3d_data.query_point[2] = z0;
-				m_kdtree3d_data.index->findNeighbors(resultSet, &m_kdtree3d_data.query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
+				const num_t query_point[3] = { x0, y0, z0 };
+				m_kdtree3d_data.findNeighbors(resultSet, &query_point[0], nanoflann::SearchParams(kdtree_search_params.nChecks));
 				MRPT_END
 			}
 
@@ -668,13 +682,95 @@ namespace mrpt
 				kdTreeNClosestPoint3DIdx(static_cast<float>(p0.x),static_cast<float>(p0.y),static_cast<float>(p0.z),N,outIdx,outDistSqr);
 			}
 
+			/** Builds (or updates) the 2D KD-tree now, if needed. The query methods do it automatically, but this is not thread-safe:
+			  *  call this method before querying the same object from several threads at once (as long as the data points do not change).
+			  * \sa kdTreeBuildIndex3D */
+			inline void kdTreeBuildIndex2D() const { rebuild_kdTree_2D(); }
+
+			/** Builds (or updates) the 3D KD-tree now, if needed. \sa kdTreeBuildIndex2D */
+			inline void kdTreeBuildIndex3D() const { rebuild_kdTree_3D(); }
+
 			/* @} */
 
 		protected:
 			/** To be called by child classes when KD tree data changes. */
 			inline void kdtree_mark_as_outdated() const { m_kdtree_is_uptodate = false; }
 
+			/** To be called by child classes instead of kdtree_mark_as_outdated() when the only change is that new points have been
+			  *  (or are going to be) appended at the end, without modifying the existing ones. Equivalent to kdtree_mark_as_outdated() if
+			  *  TKDTreeSearchParams::dynamic_index is false. */
+			inline void kdtree_mark_as_appended() const
+			{
+				if (!kdtree_search_params.dynamic_index)
+					m_kdtree_is_uptodate = false;
+				else m_kdtreeNd_data.clear();  // New points are detected and indexed in the 2D/3D forests upon the next query.
+			}
+
+			/** To be called by child classes instead of kdtree_mark_as_outdated() when some points are removed and the remaining ones
+			  *  compacted (without changing their order). Equivalent to kdtree_mark_as_outdated() if TKDTreeSearchParams::dynamic_index is false.
+			  *  The data points are not accessed here, so this can be called before or after actually removing them.
+			  * \param removed_mask The removed points, in the indices they had before the removal (true=removed).
+			  */
+			void kdtree_mark_as_removed(const std::vector<bool> &removed_mask) const
+			{
+				if (!kdtree_search_params.dynamic_index || !m_kdtree_is_uptodate)
+				{
+					m_kdtree_is_uptodate = false;
+					return;
+				}
+				m_kdtreeNd_data.clear();
+				remove_from_dynamic_kdTree(m_kdtree2d_data, removed_mask);
+				remove_from_dynamic_kdTree(m_kdtree3d_data, removed_mask);
+			}
+
 		private:
+			/** The data source of one sub-tree of a dynamic index: a contiguous range of the points of the derived class */
+			struct TSubsetAdaptor
+			{
+				TSubsetAdaptor(const Derived &data, size_t first, size_t count) : m_data(data), m_first(first), m_count(count) { }
+
+				const Derived &m_data;
+				size_t         m_first, m_count;
+
+				inline size_t kdtree_get_point_count() const { return m_count; }
+				inline num_t kdtree_get_pt(const size_t idx, int dim) const { return m_data.kdtree_get_pt(m_first+idx,dim); }
+				inline num_t kdtree_distance(const num_t *p1, const size_t idx_p2,size_t size) const { return m_data.kdtree_distance(p1,m_first+idx_p2,size); }
+				template <class BBOX> bool kdtree_get_bbox(BBOX &bb) const { return false; }
+			};
+
+			/** One sub-tree of a dynamic index */
+			template <int _DIM>
+			struct TKDSubTree
+			{
+				typedef nanoflann::KDTreeSingleIndexAdaptor<typename detail::kdtree_rebind_metric<metric_t,TSubsetAdaptor>::type, TSubsetAdaptor, _DIM> kdtree_index_t;
+
+				TKDSubTree(const Derived &data, size_t first, size_t count) : dataset(data,first,count), index(NULL) { }
+				~TKDSubTree() { mrpt::utils::delete_safe(index); }
+
+				void build(const size_t nDims, const size_t leaf_max_size)
+				{
+					mrpt::utils::delete_safe(index);
+					index = new kdtree_index_t(nDims, dataset, nanoflann::KDTreeSingleIndexAdaptorParams(leaf_max_size, nDims) );
+					index->buildIndex();
+				}
+
+				TSubsetAdaptor  dataset;
+				kdtree_index_t *index;  //!< NULL if the sub-tree must be (re)built before the next query
+			};
+
+			/** Wrapper of a nanoflann result set which translates the indices of a sub-tree into indices of the derived class */
+			template <class RESULTSET>
+			struct TOffsetResultSet
+			{
+				TOffsetResultSet(RESULTSET &rs, size_t offset) : m_rs(rs), m_offset(offset) { }
+				RESULTSET    &m_rs;
+				const size_t  m_offset;
+
+				inline bool  full() const { return m_rs.full(); }
+				inline void  addPoint(num_t dist, size_t index) { m_rs.addPoint(dist,index+m_offset); }
+				inline num_t worstDist() const { return m_rs.worstDist(); }
+			};
+
 			/** Internal structure with the KD-tree representation (mainly used to avoid copying pointers with the = operator) */
 			template <int _DIM = -1>
 			struct TKDTreeDataHolder
@@ -695,15 +791,42 @@ namespace mrpt
 				inline ~TKDTreeDataHolder() { clear(); }
 
 				/** Free memory (if allocated)  */
-				inline void clear()	{ mrpt::utils::delete_safe( index ); }
+				inline void clear()
+				{
+					mrpt::utils::delete_safe( index );
+					for (size_t i=0;i<subtrees.size();i++) delete subtrees[i];
+					subtrees.clear();
+					m_num_points = 0;
+				}
+
+				/** Search in the static index or in all the sub-trees of the dynamic one */
+				template <class RESULTSET>
+				void findNeighbors(RESULTSET &result, const num_t *query, const nanoflann::SearchParams &params) const
+				{
+					if (index) index->findNeighbors(result,query,params);
+					for (size_t i=0;i<subtrees.size();i++)
+					{
+						TOffsetResultSet<RESULTSET> subtree_result(result, subtrees[i]->dataset.m_first);
+						subtrees[i]->index->findNeighbors(subtree_result,query,params);
+					}
+				}
+
+				size_t radiusSearch(const num_t *query, const num_t radius, std::vector<std::pair<size_t,num_t> > &out_indices_dist, const nanoflann::SearchParams &params) const
+				{
+					nanoflann::RadiusResultSet<num_t,size_t> result(radius,out_indices_dist);
+					findNeighbors(result,query,params);
+					if (params.sorted)
+						std::sort(out_indices_dist.begin(),out_indices_dist.end(), nanoflann::IndexDist_Sorter() );
+					return out_indices_dist.size();
+				}
 
 				typedef nanoflann::KDTreeSingleIndexAdaptor<metric_t,Derived, _DIM> kdtree_index_t;
 
 				kdtree_index_t *index;  //!< NULL or the up-to-date index
+				std::vector<TKDSubTree<_DIM>*> subtrees; //!< The sub-trees of the dynamic index (see TKDTreeSearchParams::dynamic_index), in ascending order of point indices
 
-				std::vector<num_t> query_point;
 				size_t           m_dim;         //!< Dimensionality. typ: 2,3
-				size_t           m_num_points;
+				size_t           m_num_points;  //!< The number of points in the index
 			};
 
 			mutable TKDTreeDataHolder<2>  m_kdtree2d_data;
@@ -711,6 +834,73 @@ namespace mrpt
 			mutable TKDTreeDataHolder<>   m_kdtreeNd_data;
 			mutable bool                  m_kdtree_is_uptodate; //!< whether the KD tree needs to be rebuilt or not.
 
+			/// Index the points appended since the last update of a dynamic index (see TKDTreeSearchParams::dynamic_index)
+			template <int _DIM>
+			void update_dynamic_kdTree(TKDTreeDataHolder<_DIM> &kd, const size_t nDims) const
+			{
+				// Note: Nothing is written if the index is up to date, so several threads can query it at once.
+				const size_t N = derived().kdtree_get_point_count();
+				if (kd.index || N<kd.m_num_points || kd.m_dim!=nDims)
+				{
+					kd.clear();
+					kd.m_dim = nDims;
+				}
+
+				// Rebuild the sub-trees affected by removals:
+				for (size_t i=0;i<kd.subtrees.size();i++)
+					if (!kd.subtrees[i]->index)
+						kd.subtrees[i]->build(nDims, kdtree_search_params.leaf_max_size);
+
+				if (N==kd.m_num_points) return;
+
+				// The new points go into a new sub-tree, merged with the last ones while they are not larger than it:
+				size_t first = kd.m_num_points;
+				while (!kd.subtrees.empty() && kd.subtrees.back()->dataset.m_count <= N-first)
+				{
+					first = kd.subtrees.back()->dataset.m_first;
+					delete kd.subtrees.back();
+					kd.subtrees.pop_back();
+				}
+				kd.subtrees.push_back( new TKDSubTree<_DIM>(derived(), first, N-first) );
+				kd.subtrees.back()->build(nDims, kdtree_search_params.leaf_max_size);
+				kd.m_num_points = N;
+			}
+
+			/// Update the ranges of a dynamic index after removing points: the sub-trees after the removed points are just shifted, and
+			/// those which contained any of them are marked to be rebuilt upon the next query.
+			template <int _DIM>
+			void remove_from_dynamic_kdTree(TKDTreeDataHolder<_DIM> &kd, const std::vector<bool> &removed_mask) const
+			{
+				if (kd.index || removed_mask.size()<kd.m_num_points) { kd.clear(); return; }
+
+				std::vector<TKDSubTree<_DIM>*> new_subtrees;
+				size_t nRemovedBefore = 0;
+				for (size_t i=0;i<kd.subtrees.size();i++)
+				{
+					TKDSubTree<_DIM> *st = kd.subtrees[i];
+					const size_t first = st->dataset.m_first, count = st->dataset.m_count;
+					size_t nRemoved = 0;
+					for (size_t k=first;k<first+count;k++)
+						if (removed_mask[k]) nRemoved++;
+
+					if (nRemoved==count)
+						delete st;
+					else
+					{
+						st->dataset.m_first = first - nRemovedBefore;
+						if (nRemoved)
+						{
+							st->dataset.m_count = count - nRemoved;
+							mrpt::utils::delete_safe(st->index);
+						}
+						new_subtrees.push_back(st);
+					}
+					nRemovedBefore+=nRemoved;
+				}
+				kd.subtrees.swap(new_subtrees);
+				kd.m_num_points -= nRemovedBefore;
+			}
+
 			/// Rebuild, if needed the KD-tree for 2D (nDims=2), 3D (nDims=3), ... asking the child class for the data points.
 			void rebuild_kdTree_2D() const
 			{
@@ -718,7 +908,12 @@ namespace mrpt
 
 				if (!m_kdtree_is_uptodate) { m_kdtree2d_data.clear(); m_kdtree3d_data.clear(); m_kdtreeNd_data.clear(); }
 
-				if (!m_kdtree2d_data.index)
+				if (kdtree_search_params.dynamic_index)
+				{
+					update_dynamic_kdTree(m_kdtree2d_data,2);
+					if (!m_kdtree_is_uptodate) m_kdtree_is_uptodate = true;
+				}
+				else if (!m_kdtree2d_data.index)
 				{
 					// Erase previous tree:
 					m_kdtree2d_data.clear();
@@ -726,7 +921,6 @@ namespace mrpt
 					const size_t N = derived().kdtree_get_point_count();
 					m_kdtree2d_data.m_num_points = N;
 					m_kdtree2d_data.m_dim        = 2;
-					m_kdtree2d_data.query_point.resize(2);
 					if (N)
 					{
 						m_kdtree2d_data.index = new tree2d_t(2, derived(),  nanoflann::KDTreeSingleIndexAdaptorParams(kdtree_search_params.leaf_max_size, 2 ) );
@@ -743,7 +937,12 @@ namespace mrpt
 
 				if (!m_kdtree_is_uptodate) { m_kdtree2d_data.clear(); m_kdtree3d_data.clear(); m_kdtreeNd_data.clear(); }
 
-				if (!m_kdtree3d_data.index)
+				if (kdtree_search_params.dynamic_index)
+				{
+					update_dynamic_kdTree(m_kdtree3d_data,3);
+					if (!m_kdtree_is_uptodate) m_kdtree_is_uptodate = true;
+				}
+				else if (!m_kdtree3d_data.index)
 				{
 					// Erase previous tree:
 					m_kdtree3d_data.clear();
@@ -751,7 +950,6 @@ namespace mrpt
 					const size_t N = derived().kdtree_get_point_count();
 					m_kdtree3d_data.m_num_points = N;
 					m_kdtree3d_data.m_dim        = 3;
-					m_kdtree3d_data.query_point.resize(3);
 					if (N)
 					{
 						m_kdtree3d_data.index = new tree3d_t(3, derived(),  nanoflann::KDTreeSingleIndexAdaptorParams(kdtree_search_params.leaf_max_size, 3 ) );
@@ -776,7 +974,6 @@ namespace mrpt
 					const size_t N = derived().kdtree_get_point_count();
 					m_kdtreeNd_data.m_num_points = N;
 					m_kdtreeNd_data.m_dim        = nDims;
-					m_kdtreeNd_data.query_point.resize(nDims);
 					if (N)
 					{
 						m_kdtreeNd_data.index = new treeNd_t(nDims, derived(),  nanoflann::KDTreeSingleIndexAdaptorParams(kdtree_search_params.leaf_max_size, nDims ) );
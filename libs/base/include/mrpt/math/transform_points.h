@@ -0,0 +1,52 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef  mrpt_math_transform_points_H
+#define  mrpt_math_transform_points_H
+
+#include <mrpt/utils/utils_defs.h>
+
+namespace mrpt
+{
+	namespace math
+	{
+		/** \addtogroup geometry_grp
+		  *  @{ */
+
+		/** @name Batch transformation of points stored as separate arrays of coordinates (SoA)
+		    These are the kernels behind mrpt::poses::CPose3D::composePoints() and the rest of batch methods of pose classes.
+		    Points are processed 8 (AVX2) or 4 (SSE2) at a time if MRPT is built with those extensions.
+		    The output arrays can be the same than the input ones, but they must not partially overlap.
+		    @{ */
+
+		/** Computes \f$ G_i = R L_i + t \f$ for N 3D points, in single precision.
+		  * \param R The 3x3 rotation matrix (or any other linear transformation), in row-major order.
+		  * \param t The translation.
+		  */
+		void BASE_IMPEXP transformPoints3D(const double R[9], const double t[3], const size_t N,
+			const float *lx, const float *ly, const float *lz, float *gx, float *gy, float *gz);
+
+		/** \overload For double precision arrays, processed 4 (AVX2) or 2 (SSE2) at a time. */
+		void BASE_IMPEXP transformPoints3D(const double R[9], const double t[3], const size_t N,
+			const double *lx, const double *ly, const double *lz, double *gx, double *gy, double *gz);
+
+		/** Computes \f$ G_i = R(\phi) L_i + t \f$ for N 2D points, in single precision, given \f$ \cos \phi \f$ and \f$ \sin \phi \f$. */
+		void BASE_IMPEXP transformPoints2D(const double ccos, const double csin, const double tx, const double ty, const size_t N,
+			const float *lx, const float *ly, float *gx, float *gy);
+
+		/** \overload For double precision arrays. */
+		void BASE_IMPEXP transformPoints2D(const double ccos, const double csin, const double tx, const double ty, const size_t N,
+			const double *lx, const double *ly, double *gx, double *gy);
+
+		/** @} */
+		/** @} */  // end of grouping
+
+	} // End of namespace
+} // End of namespace
+
+#endif
@@ -137,6 +137,18 @@ namespace poses
 		 /** \overload (the "z" coordinate remains unmodified) */
 		 void composePoint(double lx,double ly,double lz, double &gx, double &gy, double &gz) const;
 
+		 /** Computes \f$ G_i = P \oplus L_i \f$ for N 2D points given as separate arrays of coordinates, in single precision (see mrpt::math::transformPoints2D).
+		   *  The output arrays can be the same than the input ones. */
+		 void composePoints(const size_t N, const float *lx,const float *ly, float *gx,float *gy) const;
+		 /** \overload */
+		 void composePoints(const size_t N, const double *lx,const double *ly, double *gx,double *gy) const;
+
+		 /** Computes \f$ L_i = G_i \ominus P \f$ for N 2D points given as separate arrays of coordinates, in single precision (see mrpt::math::transformPoints2D).
+		   *  The output arrays can be the same than the input ones. */
+		 void inverseComposePoints(const size_t N, const float *gx,const float *gy, float *lx,float *ly) const;
+		 /** \overload */
+		 void inverseComposePoints(const size_t N, const double *gx,const double *gy, double *lx,double *ly) const;
+
 		 /** The operator \f$ u' = this \oplus u \f$ is the pose/point compounding operator. */
 		 CPoint3D operator + (const CPoint3D& u) const ;
 
@@ -257,6 +257,32 @@ namespace poses
 			ASSERT_BELOW_(std::abs(lz),eps)
 		}
 
+		/** @name Batch transformation of points
+		    Each method transforms N points given as separate arrays of coordinates (SoA), which is much faster than calling composePoint() for each one (see mrpt::math::transformPoints3D).
+		    The output arrays can be the same than the input ones.
+		    @{ */
+
+		/** Computes \f$ G_i = P \oplus L_i \f$ for N points, in single precision. */
+		void composePoints(const size_t N, const float *lx,const float *ly,const float *lz, float *gx,float *gy,float *gz) const;
+		/** \overload */
+		void composePoints(const size_t N, const double *lx,const double *ly,const double *lz, double *gx,double *gy,double *gz) const;
+
+		/** Computes \f$ G_i = P \oplus L_i \f$ for N points and the Jacobian of each one with respect to the pose, the same than "out_jacobian_df_dpose" and "out_jacobian_df_dse3" in composePoint().
+		  *  The Jacobian with respect to the point is getRotationMatrix() for all the points.
+		  * \param out_jacobians_df_dpose If not NULL, an array of N matrices to be filled with the Jacobians with respect to (x,y,z,yaw,pitch,roll).
+		  * \param out_jacobians_df_dse3 If not NULL, an array of N matrices to be filled with the Jacobians with respect to the 6D locally Euclidean vector in the tangent space of SE(3).
+		  */
+		void composePointsWithJacobians(const size_t N, const double *lx,const double *ly,const double *lz, double *gx,double *gy,double *gz,
+			mrpt::math::CMatrixFixedNumeric<double,3,6>  *out_jacobians_df_dpose,
+			mrpt::math::CMatrixFixedNumeric<double,3,6>  *out_jacobians_df_dse3 = NULL) const;
+
+		/** Computes \f$ L_i = G_i \ominus P \f$ for N points, in single precision. */
+		void inverseComposePoints(const size_t N, const float *gx,const float *gy,const float *gz, float *lx,float *ly,float *lz) const;
+		/** \overload */
+		void inverseComposePoints(const size_t N, const double *gx,const double *gy,const double *gz, double *lx,double *ly,double *lz) const;
+
+		/** @} */
+
 		/**  Makes "this = A (+) B"; this method is slightly more efficient than "this= A + B;" since it avoids the temporary object.
 		  *  \note A or B can be "this" without problems.
 		  */
@@ -15,6 +15,8 @@
 
 namespace mrpt
 {
+	namespace random { class CRandomGenerator; }
+
     namespace poses
     {
         using namespace mrpt::math;
@@ -47,8 +49,8 @@ namespace mrpt
 
             void clear(); //!< Clear internal pdf
 
-			void do_sample_2D( CPose2D &p ) const;	//!< Used internally: sample from m_pdf2D
-			void do_sample_3D( CPose3D &p ) const;	//!< Used internally: sample from m_pdf3D
+			void do_sample_2D( CPose2D &p, mrpt::random::CRandomGenerator &rng ) const;	//!< Used internally: sample from m_pdf2D
+			void do_sample_3D( CPose3D &p, mrpt::random::CRandomGenerator &rng ) const;	//!< Used internally: sample from m_pdf3D
 
         public:
             /** Default constructor */
@@ -99,6 +101,20 @@ namespace mrpt
               */
             CPose3D & drawSample( CPose3D &p ) const;
 
+            /** Generate a new sample from the selected PDF, using the given random generator instead of the global mrpt::random::randomGenerator.
+              *  This allows several threads to draw samples at once from the same sampler, each one with its own generator.
+              * \return A reference to the same object passed as argument.
+              * \sa setPosePDF
+              */
+            CPose2D & drawSample( CPose2D &p, mrpt::random::CRandomGenerator &rng ) const;
+
+            /** Generate a new sample from the selected PDF, using the given random generator instead of the global mrpt::random::randomGenerator.
+              *  This allows several threads to draw samples at once from the same sampler, each one with its own generator.
+              * \return A reference to the same object passed as argument.
+              * \sa setPosePDF
+              */
+            CPose3D & drawSample( CPose3D &p, mrpt::random::CRandomGenerator &rng ) const;
+
 			/** Return true if samples can be generated, which only requires a previous call to setPosePDF */
 			bool isPrepared() const;
 
@@ -28,6 +28,17 @@ namespace mrpt
 		  *
 		  * For real thread-safety, each thread must create and use its own instance of this class.
 		  *
+		  * Alternatively, the generator can be switched to the counter-based Philox4x32-10 algorithm (see randomizeStream()), where
+		  *  each (seed,stream) pair defines an independent sequence which is cheap to initialize and supports skip-ahead (see discard()).
+		  *  This is the recommended way of giving each thread (or each particle in a particle filter) its own reproducible generator:
+		  *  \code
+		  *    CRandomGenerator rng(seed, thread_index);
+		  *  \endcode
+		  *  Ref: J.K. Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC'11.
+		  *
+		  * For drawing many samples at once, the bulk methods (e.g. drawGaussian1DArray(), drawUniformArray()) avoid the overhead of
+		  *  one call per sample, while generating exactly the same sequence than the equivalent one-by-one calls.
+		  *
 		  * Single-thread programs can use the static object mrpt::random::randomGenerator
 		 * \ingroup mrpt_base_grp
 		  */
@@ -44,11 +55,25 @@ namespace mrpt
 				bool		seed_initialized;
 			} m_MT19937_data;
 
+			/** Data used internally by the Philox4x32-10 counter-based PRNG. */
+			struct  TPhilox_data
+			{
+				TPhilox_data() : index(4)
+				{}
+				uint32_t	key[2];     //!< The seed
+				uint32_t	counter[4]; //!< [0-1]: 64-bit block counter, [2-3]: 64-bit stream index
+				uint32_t	buf[4];     //!< The last generated block
+				uint32_t	index;      //!< Next number to return from "buf" (4: none left)
+			} m_Philox_data;
+
+			bool   m_counter_based; //!< Whether we are using Philox4x32-10 instead of MT19937
+
 			bool   m_std_gauss_set;
 			double m_std_gauss_next;
 
 			void MT19937_generateNumbers();
 			void MT19937_initializeGenerator(const uint32_t &seed);
+			void Philox_generateBlock(uint32_t out[4]); //!< Generates the block for the current counter, then increments it.
 
 		public:
 
@@ -56,23 +81,43 @@ namespace mrpt
 			 @{ */
 
 				/** Default constructor: initialize random seed based on current time */
-				CRandomGenerator() : m_MT19937_data(),m_std_gauss_set(false) { randomize(); }
+				CRandomGenerator() : m_MT19937_data(),m_counter_based(false),m_std_gauss_set(false) { randomize(); }
 
 				/** Constructor for providing a custom random seed to initialize the PRNG */
-				CRandomGenerator(const uint32_t seed) : m_MT19937_data() { randomize(seed); }
+				CRandomGenerator(const uint32_t seed) : m_MT19937_data(),m_counter_based(false),m_std_gauss_set(false) { randomize(seed); }
+
+				/** Constructor for a counter-based generator: see randomizeStream() */
+				CRandomGenerator(const uint64_t seed, const uint64_t stream) : m_MT19937_data(),m_counter_based(false),m_std_gauss_set(false) { randomizeStream(seed,stream); }
 
-				void randomize(const uint32_t seed);  //!< Initialize the PRNG from the given random seed
-				void randomize();	//!< Randomize the generators, based on current time
+				void randomize(const uint32_t seed);  //!< Initialize the PRNG from the given random seed (switches to MT19937 if it was counter-based)
+				void randomize();	//!< Randomize the generators, based on current time (switches to MT19937 if it was counter-based)
+
+				/** Switches to the counter-based Philox4x32-10 algorithm, positioned at the beginning of the given stream.
+				  *  Different streams of the same seed are independent sequences of 2^66 numbers each, so each thread or task can use
+				  *  the stream given by its index. Initialization is O(1), unlike MT19937 which must fill its 624-word state.
+				  * \sa discard */
+				void randomizeStream(const uint64_t seed, const uint64_t stream = 0);
+
+				/** Whether the generator is using the counter-based algorithm (see randomizeStream()) */
+				bool isCounterBased() const { return m_counter_based; }
+
+				/** Skips the next \a n 32-bit numbers (as returned by drawUniform32bit()), as if they were drawn and thrown away.
+				  *  It takes constant time in counter-based mode and O(n) with MT19937.
+				  *  The cached second deviate of Gaussian samples (if any) is not affected. */
+				void discard(const uint64_t n);
 
 			/** @} */
 
 			/** @name Uniform pdf
 			 @{ */
 
-				/** Generate a uniformly distributed pseudo-random number using the MT19937 algorithm, in the whole range of 32-bit integers.
+				/** Generate a uniformly distributed pseudo-random number using the MT19937 algorithm (or Philox4x32-10 in counter-based mode), in the whole range of 32-bit integers.
 				  *  See: http://en.wikipedia.org/wiki/Mersenne_twister */
 				uint32_t drawUniform32bit();
 
+				/** Fills an array with N numbers, the same than N calls to drawUniform32bit(). */
+				void drawUniform32bitArray(uint32_t *out, const size_t N);
+
 				/** Returns a uniformly distributed pseudo-random number by joining two 32bit numbers from \a drawUniform32bit() */
 				uint64_t drawUniform64bit();
 
@@ -95,6 +140,11 @@ namespace mrpt
 					return Min + (Max-Min)* drawUniform32bit() * 2.3283064370807973754314699618685e-10; // 0xFFFFFFFF ^ -1
 				}
 
+				/** Fills an array with N independent, uniformly distributed samples, the same than N calls to drawUniform(). */
+				void drawUniformArray(double *out, const size_t N, const double unif_min = 0, const double unif_max = 1);
+				/** \overload */
+				void drawUniformArray(float *out, const size_t N, const double unif_min = 0, const double unif_max = 1);
+
 				/** Fills the given matrix with independent, uniformly distributed samples.
 				  * Matrix classes can be CMatrixTemplateNumeric or CMatrixFixedNumeric
 				  * \sa drawUniform
@@ -123,6 +173,9 @@ namespace mrpt
 					for (size_t c=0;c<N;c++)
 						v[c] = static_cast<typename VEC::value_type>( drawUniform(unif_min,unif_max) );
 				}
+				/** \overload For contiguous vectors, uses drawUniformArray() */
+				void drawUniformVector(std::vector<double> &v, const double unif_min = 0, const double unif_max = 1) { if (!v.empty()) drawUniformArray(&v[0],v.size(),unif_min,unif_max); }
+				void drawUniformVector(std::vector<float> &v, const double unif_min = 0, const double unif_max = 1) { if (!v.empty()) drawUniformArray(&v[0],v.size(),unif_min,unif_max); }
 
 			/** @} */
 
@@ -142,6 +195,12 @@ namespace mrpt
 					return mean+std*drawGaussian1D_normalized();
 				}
 
+				/** Fills an array with N independent, normally distributed samples, the same than N calls to drawGaussian1D().
+				  * \sa drawGaussian1DVector */
+				void drawGaussian1DArray(double *out, const size_t N, const double mean = 0, const double std = 1);
+				/** \overload */
+				void drawGaussian1DArray(float *out, const size_t N, const double mean = 0, const double std = 1);
+
 				/** Fills the given matrix with independent, 1D-normally distributed samples.
 				  * Matrix classes can be CMatrixTemplateNumeric or CMatrixFixedNumeric
 				  * \sa drawGaussian1D
@@ -174,6 +233,9 @@ namespace mrpt
 					for (size_t c=0;c<N;c++)
 						v[c] = static_cast<typename VEC::value_type>( drawGaussian1D(mean,std) );
 				}
+				/** \overload For contiguous vectors, uses drawGaussian1DArray() */
+				void drawGaussian1DVector(std::vector<double> &v, const double mean = 0, const double std = 1) { if (!v.empty()) drawGaussian1DArray(&v[0],v.size(),mean,std); }
+				void drawGaussian1DVector(std::vector<float> &v, const double mean = 0, const double std = 1) { if (!v.empty()) drawGaussian1DArray(&v[0],v.size(),mean,std); }
 
 				/** Generate multidimensional random samples according to a given covariance matrix.
 				 *  Mean is assumed to be zero if mean==NULL.
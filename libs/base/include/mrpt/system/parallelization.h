@@ -10,10 +10,14 @@
 #define  __MRPT_PARALLELIZATION_H
 
 #include <mrpt/config.h>
+#include <mrpt/base/link_pragmas.h>  // DLL import/export definitions
+#include <vector>
+#include <algorithm>
 
 // This file declares helper structs for usage with TBB
 //  Refer to http://threadingbuildingblocks.org/
 // (The following code blocks are based on OpenCV code - BSD license)
+// If MRPT is built without TBB, the same API is implemented on top of a built-in pool of worker threads.
 
 #if MRPT_HAS_TBB
     #include <tbb/tbb_stddef.h>
@@ -29,11 +33,22 @@
 #endif
 
 
-// Define a common interface so if we don't have TBB it falls back to a good-old for loop:
+// Define a common interface so if we don't have TBB it falls back to the built-in thread pool:
 namespace mrpt
 {
 	namespace system
 	{
+		/** Changes the number of threads (including the calling one) used by parallel_for(), parallel_do() and parallel_reduce()
+		  *  when MRPT is built without TBB. Set to 0 (default) to use one per processor (see getNumberOfProcessors()), or to 1 to run all the jobs serially.
+		  * \note Ignored if MRPT is built with TBB.
+		  * \sa getNumberOfParallelThreads
+		  */
+		void BASE_IMPEXP setNumberOfParallelThreads(unsigned int nThreads);
+
+		/** Returns the number of threads that will be used in parallel_for(), parallel_do() and parallel_reduce() (only meaningful if MRPT is built without TBB).
+		  * \sa setNumberOfParallelThreads */
+		unsigned int BASE_IMPEXP getNumberOfParallelThreads();
+
 #if MRPT_HAS_TBB
         typedef tbb::blocked_range<int> BlockedRange;
 
@@ -59,7 +74,7 @@ namespace mrpt
 
         //typedef tbb::concurrent_vector<Rect> ConcurrentRectVector;
 #else
-		// Emulate TBB-like classes which fall back to an old "for"
+		// Emulate TBB-like classes with a built-in pool of worker threads:
         class BlockedRange
         {
         public:
@@ -72,26 +87,122 @@ namespace mrpt
             int _begin, _end, _grainsize;
         };
 
+        class Split {};
+
+		namespace detail
+		{
+			/** A job for the built-in thread pool: run_chunk() is invoked from several threads on disjoint sub-ranges of the job range.
+			  * \param thread_idx The index of the invoking thread, in the range [0,N), with N the number of threads given by CParallelPoolSession::threads(). 0 is always the calling thread. */
+			struct BASE_IMPEXP CParallelJob
+			{
+				virtual ~CParallelJob() {}
+				virtual void run_chunk(unsigned int thread_idx, int begin, int end) = 0;
+			};
+
+			/** Reserves the built-in thread pool during its lifetime.
+			  * Nested calls (from within a job) or concurrent calls from other threads while the pool is busy get threads()==1, meaning the job must run serially in the calling thread. */
+			class BASE_IMPEXP CParallelPoolSession
+			{
+			public:
+				CParallelPoolSession();
+				~CParallelPoolSession();
+				/** The number of threads (including the calling one) that will run the job. */
+				inline unsigned int threads() const { return m_threads; }
+				/** Runs the job, splitting [begin,end) into chunks of at least \a grainsize iterations which are distributed among the threads with work stealing.
+				  *  Returns when all the chunks have been processed. An exception thrown by the job in any thread is re-thrown here as a std::runtime_error. */
+				void run(CParallelJob &job, int begin, int end, int grainsize);
+			private:
+				unsigned int m_threads;
+			};
+
+			template<typename Body>
+			class CParallelForJob : public CParallelJob
+			{
+				const Body & m_body;
+				const int    m_grainsize;
+			public:
+				CParallelForJob(const Body &body, int grainsize) : m_body(body), m_grainsize(grainsize) {}
+				virtual void run_chunk(unsigned int, int begin, int end) { m_body(BlockedRange(begin,end,m_grainsize)); }
+			};
+
+			template<typename Iterator, typename Body>
+			class CParallelDoJob : public CParallelJob
+			{
+				const std::vector<Iterator> & m_items;
+				const Body & m_body;
+			public:
+				CParallelDoJob(const std::vector<Iterator> &items, const Body &body) : m_items(items), m_body(body) {}
+				virtual void run_chunk(unsigned int, int begin, int end) {
+					for (int i=begin;i<end;i++) m_body(*m_items[i]);
+				}
+			};
+
+			/** Each thread accumulates into its own copy of the body, built with the splitting constructor, which are joined into the original at the end. */
+			template<typename Body>
+			class CParallelReduceJob : public CParallelJob
+			{
+				Body & m_body;
+				const int m_grainsize;
+				std::vector<Body*> m_bodies;
+			public:
+				CParallelReduceJob(Body &body, int grainsize, unsigned int nThreads) : m_body(body), m_grainsize(grainsize), m_bodies(nThreads,static_cast<Body*>(NULL))
+				{
+					m_bodies[0] = &m_body;
+					for (unsigned int i=1;i<nThreads;i++) m_bodies[i] = new Body(m_body,Split());
+				}
+				virtual ~CParallelReduceJob() {
+					for (size_t i=1;i<m_bodies.size();i++) delete m_bodies[i];
+				}
+				virtual void run_chunk(unsigned int thread_idx, int begin, int end) { (*m_bodies[thread_idx])(BlockedRange(begin,end,m_grainsize)); }
+				/** Joins the results of all the threads into the original body, in thread order. */
+				void join_all() {
+					for (size_t i=1;i<m_bodies.size();i++) m_body.join(*m_bodies[i]);
+				}
+			};
+		} // end detail
+
         template<typename Body> static inline
         void parallel_for( const BlockedRange& range, const Body& body )
         {
-            body(range);
+			detail::CParallelPoolSession session;
+			if (session.threads()<2 || range.end()-range.begin()<=std::max(1,range.grainsize()))
+			{
+				body(range);
+				return;
+			}
+			detail::CParallelForJob<Body> job(body,range.grainsize());
+			session.run(job,range.begin(),range.end(),range.grainsize());
         }
-        typedef std::vector<Rect> ConcurrentRectVector;
 
         template<typename Iterator, typename Body> static inline
         void parallel_do( Iterator first, Iterator last, const Body& body )
         {
-            for( ; first != last; ++first )
-                body(*first);
+			detail::CParallelPoolSession session;
+			if (session.threads()<2)
+			{
+				for( ; first != last; ++first )
+					body(*first);
+				return;
+			}
+			std::vector<Iterator> items;
+			for( ; first != last; ++first )
+				items.push_back(first);
+			detail::CParallelDoJob<Iterator,Body> job(items,body);
+			session.run(job,0,static_cast<int>(items.size()),1);
         }
 
-        class Split {};
-
         template<typename Body> static inline
         void parallel_reduce( const BlockedRange& range, Body& body )
         {
-            body(range);
+			detail::CParallelPoolSession session;
+			if (session.threads()<2 || range.end()-range.begin()<=std::max(1,range.grainsize()))
+			{
+				body(range);
+				return;
+			}
+			detail::CParallelReduceJob<Body> job(body,range.grainsize(),session.threads());
+			session.run(job,range.begin(),range.end(),range.grainsize());
+			job.join_all();
         }
 
 #endif // MRPT_HAS_TBB
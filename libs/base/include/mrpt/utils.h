@@ -56,6 +56,7 @@
 #include <mrpt/utils/CThreadSafeQueue.h>
 #include <mrpt/utils/CMessageQueue.h>
 #include <mrpt/utils/CDynamicGrid.h>
+#include <mrpt/utils/CCopyOnWriteTiledBuffer.h>
 #include <mrpt/utils/CProbabilityDensityFunction.h>
 
 #include <mrpt/utils/CConsoleRedirector.h>
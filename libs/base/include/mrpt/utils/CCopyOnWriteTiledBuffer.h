@@ -0,0 +1,137 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef  CCopyOnWriteTiledBuffer_H
+#define  CCopyOnWriteTiledBuffer_H
+
+#include <mrpt/utils/utils_defs.h>
+
+namespace mrpt
+{
+	namespace utils
+	{
+		/** A 2D buffer of cells stored row by row in "tiles" of 2^TILE_ROWS_LOG2 full rows, which are shared (reference-counted)
+		  *  between copies of the buffer and only duplicated when one of the copies modifies them (copy-on-write).
+		  *
+		  * Copying the buffer is thus O(number of tiles), and the memory of a set of copies which only differ in a few
+		  *  regions (e.g. the maps in the particles of a Rao-Blackwellized particle filter) grows with the number of modified tiles.
+		  *  Upon resize() or fill(), all the tiles share one single block of memory.
+		  *
+		  * Each row is contiguous in memory, but consecutive rows are only contiguous within one tile.
+		  *  Read access is through the const methods; writing requires a pointer from getRowWritable() or cellWritable(),
+		  *  which first make the tile unique. Those pointers remain valid until the buffer is copied, resized or filled.
+		  *
+		  * \tparam T The type of each cell.
+		  * \tparam TILE_ROWS_LOG2 The number of rows per tile is 2^TILE_ROWS_LOG2.
+		  * \ingroup mrpt_base_grp
+		  * \sa CDynamicGrid
+		  */
+		template <typename T, unsigned int TILE_ROWS_LOG2 = 4>
+		class CCopyOnWriteTiledBuffer
+		{
+		public:
+			typedef T value_type;
+			typedef stlplus::smart_ptr< std::vector<T> > tile_ptr;
+
+			static const size_t TILE_ROWS = static_cast<size_t>(1) << TILE_ROWS_LOG2; //!< Number of rows in each tile
+
+			CCopyOnWriteTiledBuffer() : m_size_x(0), m_size_y(0) { }
+
+			/** Changes the size of the buffer, ERASING all previous contents: all the cells will have the value \a fill_value. */
+			void resize(const size_t size_x, const size_t size_y, const T &fill_value = T())
+			{
+				m_size_x = size_x;
+				m_size_y = size_y;
+				fill(fill_value);
+			}
+
+			/** Sets all the cells to the given value (all tiles will share the same memory block). */
+			void fill(const T &value)
+			{
+				m_tiles.clear();
+				if (!m_size_x || !m_size_y) return;
+				const tile_ptr tile( std::vector<T>(TILE_ROWS*m_size_x, value) );
+				m_tiles.assign( (m_size_y+TILE_ROWS-1)>>TILE_ROWS_LOG2, tile );
+			}
+
+			/** Frees all the memory and sets the size to 0x0 */
+			void clear()
+			{
+				m_tiles.clear();
+				m_size_x = m_size_y = 0;
+			}
+
+			inline size_t getSizeX() const { return m_size_x; }
+			inline size_t getSizeY() const { return m_size_y; }
+			inline size_t size() const { return m_size_x*m_size_y; } //!< Total number of cells
+			inline bool   empty() const { return m_tiles.empty(); }
+
+			inline void swap(CCopyOnWriteTiledBuffer<T,TILE_ROWS_LOG2> &o)
+			{
+				m_tiles.swap(o.m_tiles);
+				std::swap(m_size_x,o.m_size_x);
+				std::swap(m_size_y,o.m_size_y);
+			}
+
+			/** Read-only pointer to the first cell of the given row (no bounds checking) */
+			inline const T *getRow(const size_t y) const {
+				return &(*m_tiles[y>>TILE_ROWS_LOG2])[ (y & (TILE_ROWS-1))*m_size_x ];
+			}
+
+			/** Writable pointer to the first cell of the given row (no bounds checking). The tile of the row is duplicated first if it is shared with other buffers.
+			  * \note Different buffers sharing tiles can be written from different threads at once (e.g. the maps of the particles in a RBPF).
+			  *  A shared tile is copied while this buffer still holds its reference, which is only released afterwards: the (atomic) reference count
+			  *  never drops to 1, letting the last owner write into the tile in place, while other owners are still copying it.
+			  *  stlplus::smart_ptr::make_unique() can't be used here since it releases the reference before copying the data.
+			  */
+			inline T *getRowWritable(const size_t y) {
+				tile_ptr &tile = m_tiles[y>>TILE_ROWS_LOG2];
+				if (tile.alias_count()>1)
+				{
+					const tile_ptr unique_tile( *tile ); // Copy the data first...
+					tile = unique_tile;                  // ...then release the shared tile (deleted here if the other owners released it meanwhile)
+				}
+				return &(*tile)[ (y & (TILE_ROWS-1))*m_size_x ];
+			}
+
+			/** Read-only access to a cell (no bounds checking) */
+			inline const T &operator()(const size_t x, const size_t y) const { return getRow(y)[x]; }
+
+			/** Writable access to a cell (no bounds checking). The tile of the cell is duplicated first if it is shared with other buffers. */
+			inline T &cellWritable(const size_t x, const size_t y) { return getRowWritable(y)[x]; }
+
+			/** Read-only access to a cell by its index (x+y*size_x) */
+			inline const T &operator[](const size_t idx) const { return getRow(idx/m_size_x)[idx%m_size_x]; }
+
+			/** Copies all the cells, row by row, into a contiguous vector */
+			void getAsVector(std::vector<T> &out) const
+			{
+				out.resize(size());
+				for (size_t y=0;y<m_size_y;y++)
+					if (m_size_x) std::copy( getRow(y), getRow(y)+m_size_x, out.begin()+y*m_size_x );
+			}
+
+			/** Returns the number of tiles whose memory is shared with other buffers (for statistics) */
+			size_t getSharedTilesCount() const
+			{
+				size_t n=0;
+				for (size_t i=0;i<m_tiles.size();i++)
+					if (m_tiles[i].alias_count()>1) n++;
+				return n;
+			}
+
+			inline size_t getTilesCount() const { return m_tiles.size(); } //!< Total number of tiles
+
+		private:
+			std::vector<tile_ptr> m_tiles;
+			size_t m_size_x, m_size_y;
+		};
+
+	} // End of namespace
+} // End of namespace
+#endif
@@ -0,0 +1,67 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef  CMemoryMappedFile_H
+#define  CMemoryMappedFile_H
+
+#include <mrpt/utils/utils_defs.h>
+#include <mrpt/utils/CUncopiable.h>
+
+namespace mrpt
+{
+	namespace utils
+	{
+		/** A read-only view of a whole file mapped into the address space of the process (with mmap() or MapViewOfFile()).
+		  *  The operating system loads the pages of the file on demand and can drop them at any time, so this allows random access to
+		  *  files much larger than the available RAM (on 64bit systems). To deserialize objects from the mapped memory, wrap a part of it
+		  *  with CMemoryStream::assignMemoryNotOwn().
+		  *
+		  * \sa CFileInputStream, CMemoryStream
+		  * \ingroup mrpt_base_grp
+		  */
+		class BASE_IMPEXP CMemoryMappedFile : public CUncopiable
+		{
+		public:
+			/** Default constructor: use open() afterwards */
+			CMemoryMappedFile();
+
+			/** Constructor which maps a file
+			  * \exception std::exception On error opening or mapping the file.
+			  */
+			CMemoryMappedFile(const std::string &fileName);
+
+			/** Destructor: unmaps the file */
+			virtual ~CMemoryMappedFile();
+
+			/** Maps the given file (read-only). Any previous file is unmapped first.
+			  * \return false on any error (e.g. the file does not exist, or it does not fit into the address space).
+			  */
+			bool open(const std::string &fileName);
+
+			/** Unmaps the file (pointers from getData() become invalid) */
+			void close();
+
+			/** Says if a file is currently mapped */
+			inline bool isOpen() const { return m_is_open; }
+
+			/** The start of the mapped file (NULL if none, or if the file is empty) */
+			inline const unsigned char *getData() const { return m_data; }
+
+			/** The size of the mapped file, in bytes */
+			inline uint64_t getSize() const { return m_size; }
+
+		private:
+			const unsigned char *m_data;
+			uint64_t             m_size;
+			bool                 m_is_open;
+			void                *m_hFile, *m_hMapping; //!< Only used in Windows
+		}; // End of class def.
+
+	} // End of namespace
+} // End of namespace
+#endif
@@ -35,6 +35,11 @@
 	#include <smmintrin.h>
 #endif
 
+// AVX/AVX2 types:
+#if MRPT_HAS_AVX2
+	#include <immintrin.h>
+#endif
+
 
 #endif
 
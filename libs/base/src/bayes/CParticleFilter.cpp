@@ -109,7 +109,8 @@ CParticleFilter::TParticleFilterOptions::TParticleFilterOptions() :
 	max_loglikelihood_dyn_range ( 15 ),
 	pfAuxFilterStandard_FirstStageWeightsMonteCarlo ( false ),
 	verbose	(false),
-	pfAuxFilterOptimal_MLE(false)
+	pfAuxFilterOptimal_MLE(false),
+	parallelizeLikelihoods(false)
 {
 }
 
@@ -150,6 +151,7 @@ void  CParticleFilter::TParticleFilterOptions::dumpToTextStream(CStream	&out) co
 	out.printf("max_loglikelihood_dyn_range             = %f\n", max_loglikelihood_dyn_range);
 	out.printf("pfAuxFilterStandard_FirstStageWeightsMonteCarlo = %c\n", pfAuxFilterStandard_FirstStageWeightsMonteCarlo ? 'Y':'N');
 	out.printf("pfAuxFilterOptimal_MLE                  = %c\n", pfAuxFilterOptimal_MLE? 'Y':'N');
+	out.printf("parallelizeLikelihoods                  = %c\n", parallelizeLikelihoods? 'Y':'N');
 
 	out.printf("\n");
 }
@@ -186,6 +188,7 @@ void  CParticleFilter::TParticleFilterOptions::loadFromConfigFile(
 
 	MRPT_LOAD_CONFIG_VAR(pfAuxFilterStandard_FirstStageWeightsMonteCarlo,bool,	iniFile,section.c_str());
 	MRPT_LOAD_CONFIG_VAR(pfAuxFilterOptimal_MLE,bool,	iniFile,section.c_str());
+	MRPT_LOAD_CONFIG_VAR(parallelizeLikelihoods,bool,	iniFile,section.c_str());
 
 
 	MRPT_END
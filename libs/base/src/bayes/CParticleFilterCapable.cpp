@@ -19,6 +19,7 @@
 #include <mrpt/utils/utils_defs.h>
 #include <mrpt/math/ops_vectors.h>
 #include <mrpt/random.h>
+#include <mrpt/system/parallelization.h>
 
 #include <algorithm>
 
@@ -32,6 +33,55 @@ using namespace std;
 
 const unsigned CParticleFilterCapable::PARTICLE_FILTER_CAPABLE_FAST_DRAW_BINS = 20;
 
+namespace
+{
+	/** Body for mrpt::system::parallel_for(): evaluates a range of particles */
+	struct TParticleEvaluatorBody
+	{
+		const CParticleFilter::TParticleFilterOptions &PF_options;
+		CParticleFilterCapable::TParticleProbabilityEvaluator partEvaluator;
+		const CParticleFilterCapable *obj;
+		const void *action, *observation;
+		vector_double &out;
+
+		TParticleEvaluatorBody(
+			const CParticleFilter::TParticleFilterOptions &PF_options_,
+			CParticleFilterCapable::TParticleProbabilityEvaluator partEvaluator_,
+			const CParticleFilterCapable *obj_,
+			const void *action_, const void *observation_,
+			vector_double &out_) :
+				PF_options(PF_options_),partEvaluator(partEvaluator_),obj(obj_),
+				action(action_),observation(observation_),out(out_)
+		{ }
+
+		void operator()(const mrpt::system::BlockedRange &r) const
+		{
+			for (int i=r.begin();i<r.end();i++)
+				out[i] = partEvaluator(PF_options,obj,i,action,observation);
+		}
+	};
+
+	/** Evaluates all the particles into "out", in parallel if PF_options.parallelizeLikelihoods is set.
+	  *  The first particle is always evaluated alone, so any cache built upon demand by the evaluator is ready before the other threads start. */
+	void evaluateAllParticles(
+		const CParticleFilter::TParticleFilterOptions &PF_options,
+		CParticleFilterCapable::TParticleProbabilityEvaluator partEvaluator,
+		const CParticleFilterCapable *obj,
+		const void *action, const void *observation,
+		vector_double &out)
+	{
+		const size_t M = out.size();
+		if (!M) return;
+		TParticleEvaluatorBody body(PF_options,partEvaluator,obj,action,observation,out);
+		if (PF_options.parallelizeLikelihoods)
+		{
+			body( mrpt::system::BlockedRange(0,1) );
+			mrpt::system::parallel_for( mrpt::system::BlockedRange(1,M), body );
+		}
+		else body( mrpt::system::BlockedRange(0,M) );
+	}
+}
+
 /*---------------------------------------------------------------
 					performResampling
  ---------------------------------------------------------------*/
@@ -386,7 +436,7 @@ void  CParticleFilterCapable::prepareFastDrawSample(
 		// -------------------------------------------------------------------
 		double	SUM = 0;
 		// Save the log likelihoods:
-		for (i=0;i<M;i++)	m_fastDrawAuxiliary.PDF[i] = partEvaluator(PF_options, this,i,action,observation);
+		evaluateAllParticles(PF_options,partEvaluator,this,action,observation, m_fastDrawAuxiliary.PDF);
 		// "Normalize":
 		m_fastDrawAuxiliary.PDF.array() -= math::maximum( m_fastDrawAuxiliary.PDF );
 		for (i=0;i<M;i++)	SUM += m_fastDrawAuxiliary.PDF[i] = exp( m_fastDrawAuxiliary.PDF[i] );
@@ -434,10 +484,9 @@ void  CParticleFilterCapable::prepareFastDrawSample(
 		//  -> Use m_fastDrawAuxiliary.alreadyDrawnIndexes & alreadyDrawnNextOne
 		// ------------------------------------------------------------------------
 		// Generate the vector with the "probabilities" of each particle being selected:
-		size_t	i,M = particlesCount();
+		const size_t M = particlesCount();
 		vector_double		PDF(M,0);
-		for (i=0;i<M;i++)
-			PDF[i] = partEvaluator(PF_options,this,i,action,observation); // Default evaluator: takes current weight.
+		evaluateAllParticles(PF_options,partEvaluator,this,action,observation, PDF); // Default evaluator: takes current weight.
 
 		std::vector<size_t>		idxs;
 
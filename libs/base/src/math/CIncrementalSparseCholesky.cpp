@@ -0,0 +1,242 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/base.h>  // Precompiled headers
+
+#include <mrpt/math/CIncrementalSparseCholesky.h>
+
+// Read the note in CSparseMatrix.h: Use embedded headers even for compiling against
+//  a system library.
+extern "C"{
+#include <mrpt/otherlibs/CSparse/cs.h>
+}
+
+using namespace mrpt;
+using namespace mrpt::math;
+using namespace mrpt::utils;
+using namespace std;
+
+static const size_t NO_PARENT = static_cast<size_t>(-1);
+
+CIncrementalSparseCholesky::CIncrementalSparseCholesky() :
+	m_first_modified(0),
+	m_last_refactored(0),
+	m_nnzA(0)
+{
+}
+
+void CIncrementalSparseCholesky::clear()
+{
+	m_A.clear();
+	m_L.clear();
+	m_parent.clear();
+	m_first_modified = 0;
+	m_last_refactored = 0;
+	m_nnzA = 0;
+}
+
+void CIncrementalSparseCholesky::resize(const size_t N)
+{
+	const size_t old_N = m_A.size();
+	if (N<old_N)
+	{
+		// Remove the entries in the removed rows:
+		for (size_t c=0;c<N;c++)
+		{
+			column_t &col = m_A[c];
+			size_t nKeep = 0;
+			for (size_t p=0;p<col.size();p++)
+				if (col[p].first<N)
+					col[nKeep++] = col[p];
+			m_nnzA -= col.size()-nKeep;
+			col.resize(nKeep);
+		}
+		for (size_t c=N;c<old_N;c++)
+			m_nnzA -= m_A[c].size();
+
+		// The decomposition of the leading submatrix is the leading submatrix of L:
+		if (m_L.size()>N)
+		{
+			m_L.resize(N);
+			m_parent.resize(N);
+			for (size_t j=0;j<N;j++)
+			{
+				column_t &Lj = m_L[j];
+				while (Lj.size()>1 && Lj.back().first>=N)
+					Lj.pop_back();
+				m_parent[j] = Lj.size()>1 ? Lj[1].first : NO_PARENT;
+			}
+		}
+	}
+	m_A.resize(N);
+	mrpt::utils::keep_min(m_first_modified, std::min(N,old_N));
+}
+
+void CIncrementalSparseCholesky::setColumn(const size_t col, const column_t &entries)
+{
+	ASSERT_BELOW_(col,m_A.size())
+	for (size_t p=0;p<entries.size();p++)
+		ASSERTMSG_(entries[p].first<=col, "Only the upper triangular part of the matrix can be set")
+
+	m_nnzA -= m_A[col].size();
+	m_A[col] = entries;
+	m_nnzA += entries.size();
+	mrpt::utils::keep_min(m_first_modified, col);
+}
+
+void CIncrementalSparseCholesky::factorize()
+{
+	const size_t N = m_A.size();
+	const size_t k0 = m_first_modified;
+	m_last_refactored = 0;
+	if (k0>=N) return; // Nothing changed
+
+	m_L.resize(N);
+	m_parent.resize(N);
+
+	// The rows of L above k0 remain valid: remove the rest of rows, which are always at the end of each column.
+	for (size_t j=0;j<k0;j++)
+	{
+		column_t &Lj = m_L[j];
+		size_t nKeep = Lj.size();
+		while (nKeep>1 && Lj[nKeep-1].first>=k0)
+			nKeep--;
+		Lj.resize(nKeep);
+		m_parent[j] = nKeep>1 ? Lj[1].first : NO_PARENT;
+	}
+	for (size_t j=k0;j<N;j++)
+	{
+		m_L[j].clear();
+		m_parent[j] = NO_PARENT;
+	}
+
+	m_work.assign(N,0.0);
+	m_flag.assign(N,NO_PARENT);
+	m_stack.resize(N);
+	double *x = &m_work[0];
+
+	// "Up-looking" Cholesky: compute L(k,:), one row at a time.
+	for (size_t k=k0;k<N;k++)
+	{
+		// Scatter A(:,k) into "x" and find the pattern of L(k,:) as the reach of its
+		//  nonzeros in the elimination tree (in topological order, as cs_ereach()).
+		size_t top = N;
+		m_flag[k] = k;
+		const column_t &Ak = m_A[k];
+		for (size_t p=0;p<Ak.size();p++)
+		{
+			size_t i = Ak[p].first;
+			x[i] += Ak[p].second;
+
+			size_t len = 0;
+			for ( ;m_flag[i]!=k;i=m_parent[i])
+			{
+				m_stack[len++] = i;
+				m_flag[i] = k;
+				if (m_parent[i]==NO_PARENT)
+					m_parent[i] = k;  // L(k,i) will be the first off-diagonal entry in its column
+			}
+			while (len>0)
+				m_stack[--top] = m_stack[--len];
+		}
+
+		// Triangular solve for L(k,:):
+		double d = x[k];
+		x[k] = 0;
+		for ( ;top<N;top++)
+		{
+			const size_t j = m_stack[top];
+			column_t &Lj = m_L[j];
+			const double lki = x[j] / Lj[0].second;
+			x[j] = 0;
+			for (size_t p=1;p<Lj.size();p++)
+				x[Lj[p].first] -= Lj[p].second * lki;
+			d -= lki*lki;
+			Lj.push_back( std::make_pair(k,lki) );
+		}
+
+		if (d<=0)
+		{
+			m_first_modified = k;
+			m_last_refactored = k-k0;
+			throw CExceptionNotDefPos("CIncrementalSparseCholesky::factorize(): Matrix is not definite positive");
+		}
+		m_L[k].assign(1, std::make_pair(k,std::sqrt(d)) );
+	}
+
+	m_first_modified = N;
+	m_last_refactored = N-k0;
+}
+
+void CIncrementalSparseCholesky::solve(const mrpt::vector_double &b, mrpt::vector_double &out_x) const
+{
+	ASSERTMSG_(isFactorized(), "factorize() must be called after the last change of the matrix")
+	ASSERT_EQUAL_(static_cast<size_t>(b.size()),m_A.size())
+
+	const size_t N = m_A.size();
+	out_x = b;
+	if (!N) return;
+	double *x = &out_x[0];
+
+	// L*y=b
+	for (size_t j=0;j<N;j++)
+	{
+		const column_t &Lj = m_L[j];
+		x[j] /= Lj[0].second;
+		for (size_t p=1;p<Lj.size();p++)
+			x[Lj[p].first] -= Lj[p].second * x[j];
+	}
+	// L'*x=y
+	for (size_t j=N;j-->0;)
+	{
+		const column_t &Lj = m_L[j];
+		for (size_t p=1;p<Lj.size();p++)
+			x[j] -= Lj[p].second * x[Lj[p].first];
+		x[j] /= Lj[0].second;
+	}
+}
+
+size_t CIncrementalSparseCholesky::getFactorNonZeros() const
+{
+	size_t nnz = 0;
+	for (size_t j=0;j<m_L.size();j++)
+		nnz+=m_L[j].size();
+	return nnz;
+}
+
+void CIncrementalSparseCholesky::computeFillReducingOrdering(
+	const size_t N,
+	const std::vector<std::pair<size_t,size_t> > &nonzero_pairs,
+	std::vector<size_t> &out_order )
+{
+	out_order.resize(N);
+	if (!N) return;
+
+	// Build the (structure of the) matrix with a diagonal plus the given entries, since cs_amd() takes care of A+A':
+	cs *T = cs_spalloc(N,N, N+nonzero_pairs.size(), 1 /*values*/, 1 /*triplet*/);
+	ASSERT_(T!=NULL)
+	for (size_t i=0;i<N;i++)
+		cs_entry(T,i,i,1.0);
+	for (size_t k=0;k<nonzero_pairs.size();k++)
+	{
+		ASSERT_(nonzero_pairs[k].first<N && nonzero_pairs[k].second<N)
+		cs_entry(T,nonzero_pairs[k].first,nonzero_pairs[k].second,1.0);
+	}
+	cs *C = cs_compress(T);
+	cs_spfree(T);
+	ASSERT_(C!=NULL)
+
+	int *P = cs_amd(1 /* order for Cholesky */, C);
+	cs_spfree(C);
+	if (!P) THROW_EXCEPTION("cs_amd() failed")
+
+	for (size_t i=0;i<N;i++)
+		out_order[i] = P[i];
+	cs_free(P);
+}
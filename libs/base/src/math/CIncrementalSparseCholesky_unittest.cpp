@@ -0,0 +1,158 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+
+#include <mrpt/math.h>
+#include <mrpt/random.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::utils;
+using namespace mrpt::math;
+using namespace std;
+
+namespace
+{
+	// A random sparse, diagonally-dominant (so definite-positive) symmetric matrix:
+	void generateSparseDefPosMatrix(const size_t N, CMatrixDouble &A)
+	{
+		A.zeros(N,N);
+		for (size_t k=0;k<2*N;k++)
+		{
+			const size_t i = mrpt::random::randomGenerator.drawUniform32bit() % N;
+			const size_t j = mrpt::random::randomGenerator.drawUniform32bit() % N;
+			if (i==j) continue;
+			A(i,j) = A(j,i) = mrpt::random::randomGenerator.drawUniform(-1.0,1.0);
+		}
+		for (size_t i=0;i<N;i++)
+			A(i,i) = A.row(i).array().abs().sum() + 1.0;
+	}
+
+	void setColumnFromDense(CIncrementalSparseCholesky &chol, const CMatrixDouble &A, const size_t c)
+	{
+		CIncrementalSparseCholesky::column_t col;
+		for (size_t r=0;r<=c;r++)
+			if (A(r,c)!=0)
+				col.push_back(std::make_pair(r,A(r,c)));
+		chol.setColumn(c,col);
+	}
+
+	// Checks |A*x-b| for a random "b"
+	void checkSolve(const CIncrementalSparseCholesky &chol, const CMatrixDouble &A)
+	{
+		const size_t N = A.getColCount();
+		vector_double b(N), x;
+		for (size_t i=0;i<N;i++)
+			b[i] = mrpt::random::randomGenerator.drawGaussian1D_normalized();
+
+		chol.solve(b,x);
+		ASSERT_EQ(static_cast<size_t>(x.size()),N);
+
+		const vector_double r = A*x - b;
+		EXPECT_NEAR(0, r.array().abs().maxCoeff(), 1e-9);
+	}
+}
+
+TEST(CIncrementalSparseCholesky, FullDecomposition)
+{
+	mrpt::random::randomGenerator.randomize(1234);
+	const size_t N = 40;
+	CMatrixDouble A;
+	generateSparseDefPosMatrix(N,A);
+
+	CIncrementalSparseCholesky chol;
+	chol.resize(N);
+	for (size_t c=0;c<N;c++)
+		setColumnFromDense(chol,A,c);
+	EXPECT_FALSE(chol.isFactorized());
+	chol.factorize();
+	EXPECT_TRUE(chol.isFactorized());
+	EXPECT_EQ(chol.getLastRefactoredColumns(), N);
+
+	checkSolve(chol,A);
+}
+
+TEST(CIncrementalSparseCholesky, IncrementalUpdates)
+{
+	mrpt::random::randomGenerator.randomize(4321);
+	const size_t N = 50, N0 = 35;
+	CMatrixDouble A;
+	generateSparseDefPosMatrix(N,A);
+
+	// Decompose the leading submatrix first:
+	CIncrementalSparseCholesky chol;
+	chol.resize(N0);
+	for (size_t c=0;c<N0;c++)
+		setColumnFromDense(chol,A,c);
+	chol.factorize();
+	checkSolve(chol,CMatrixDouble(A.block(0,0,N0,N0)));
+
+	// Append the rest of columns: only those must be decomposed:
+	chol.resize(N);
+	for (size_t c=N0;c<N;c++)
+		setColumnFromDense(chol,A,c);
+	chol.factorize();
+	EXPECT_EQ(chol.getLastRefactoredColumns(), N-N0);
+	checkSolve(chol,A);
+
+	// Modify a few entries:
+	const size_t C = N-10;
+	A(C,C) += 2.0;
+	A(3,C) = A(C,3) = 0.5;
+	A(N-1,N-1) += 1.0;
+	setColumnFromDense(chol,A,C);
+	setColumnFromDense(chol,A,N-1);
+	chol.factorize();
+	EXPECT_EQ(chol.getLastRefactoredColumns(), N-C);
+	checkSolve(chol,A);
+
+	// And remove the last columns:
+	chol.resize(N0);
+	EXPECT_TRUE(chol.isFactorized());
+	checkSolve(chol,CMatrixDouble(A.block(0,0,N0,N0)));
+}
+
+TEST(CIncrementalSparseCholesky, NotDefPos)
+{
+	CMatrixDouble A(3,3);
+	A << 4,2,0,
+	     2,1,0,
+	     0,0,1;
+	CIncrementalSparseCholesky chol;
+	chol.resize(3);
+	for (size_t c=0;c<3;c++)
+		setColumnFromDense(chol,A,c);
+	EXPECT_THROW(chol.factorize(), CExceptionNotDefPos);
+	EXPECT_FALSE(chol.isFactorized());
+
+	// Fix it and resume:
+	A(1,1) = 2;
+	setColumnFromDense(chol,A,1);
+	chol.factorize();
+	checkSolve(chol,A);
+}
+
+TEST(CIncrementalSparseCholesky, FillReducingOrdering)
+{
+	// An "arrow" matrix: the variable #0 is linked to all the others, so it must be eliminated last to avoid fill-in:
+	const size_t N = 20;
+	std::vector<std::pair<size_t,size_t> > nz;
+	for (size_t i=1;i<N;i++)
+		nz.push_back(std::make_pair(size_t(0),i));
+
+	std::vector<size_t> order;
+	CIncrementalSparseCholesky::computeFillReducingOrdering(N,nz,order);
+	ASSERT_EQ(order.size(),N);
+	EXPECT_TRUE(order[N-1]==0 || order[N-2]==0);
+
+	std::vector<size_t> sorted = order;
+	std::sort(sorted.begin(),sorted.end());
+	for (size_t i=0;i<N;i++)
+		EXPECT_EQ(sorted[i],i);
+}
@@ -0,0 +1,182 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/base.h>  // Precompiled headers
+
+#include <mrpt/math/transform_points.h>
+#include <mrpt/utils/SSE_types.h>
+
+using namespace mrpt;
+using namespace mrpt::math;
+
+namespace
+{
+	/** Scalar version, also used for the last points which do not fill a SIMD register */
+	template <typename T>
+	inline void transformPoints3D_scalar(const T r[9], const T t[3], size_t i, const size_t N,
+		const T *lx, const T *ly, const T *lz, T *gx, T *gy, T *gz)
+	{
+		for ( ;i<N;i++)
+		{
+			const T x=lx[i], y=ly[i], z=lz[i];
+			gx[i] = r[0]*x + r[1]*y + r[2]*z + t[0];
+			gy[i] = r[3]*x + r[4]*y + r[5]*z + t[1];
+			gz[i] = r[6]*x + r[7]*y + r[8]*z + t[2];
+		}
+	}
+
+	template <typename T>
+	inline void transformPoints2D_scalar(const T c, const T s, const T tx, const T ty, size_t i, const size_t N,
+		const T *lx, const T *ly, T *gx, T *gy)
+	{
+		for ( ;i<N;i++)
+		{
+			const T x=lx[i], y=ly[i];
+			gx[i] = tx + x*c - y*s;
+			gy[i] = ty + x*s + y*c;
+		}
+	}
+}
+
+void mrpt::math::transformPoints3D(const double R[9], const double t[3], const size_t N,
+	const float *lx, const float *ly, const float *lz, float *gx, float *gy, float *gz)
+{
+	float r[9], tt[3];
+	for (int k=0;k<9;k++) r[k]=static_cast<float>(R[k]);
+	for (int k=0;k<3;k++) tt[k]=static_cast<float>(t[k]);
+	size_t i=0;
+
+#if MRPT_HAS_AVX2
+	{
+		__m256 vr[9], vt[3];
+		for (int k=0;k<9;k++) vr[k]=_mm256_set1_ps(r[k]);
+		for (int k=0;k<3;k++) vt[k]=_mm256_set1_ps(tt[k]);
+		for ( ;i+8<=N;i+=8)
+		{
+			const __m256 x = _mm256_loadu_ps(lx+i), y = _mm256_loadu_ps(ly+i), z = _mm256_loadu_ps(lz+i);
+			_mm256_storeu_ps(gx+i, _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vr[0],x),_mm256_mul_ps(vr[1],y)),_mm256_mul_ps(vr[2],z)),vt[0]) );
+			_mm256_storeu_ps(gy+i, _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vr[3],x),_mm256_mul_ps(vr[4],y)),_mm256_mul_ps(vr[5],z)),vt[1]) );
+			_mm256_storeu_ps(gz+i, _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vr[6],x),_mm256_mul_ps(vr[7],y)),_mm256_mul_ps(vr[8],z)),vt[2]) );
+		}
+	}
+#endif
+#if MRPT_HAS_SSE2
+	{
+		__m128 vr[9], vt[3];
+		for (int k=0;k<9;k++) vr[k]=_mm_set1_ps(r[k]);
+		for (int k=0;k<3;k++) vt[k]=_mm_set1_ps(tt[k]);
+		for ( ;i+4<=N;i+=4)
+		{
+			const __m128 x = _mm_loadu_ps(lx+i), y = _mm_loadu_ps(ly+i), z = _mm_loadu_ps(lz+i);
+			_mm_storeu_ps(gx+i, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vr[0],x),_mm_mul_ps(vr[1],y)),_mm_mul_ps(vr[2],z)),vt[0]) );
+			_mm_storeu_ps(gy+i, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vr[3],x),_mm_mul_ps(vr[4],y)),_mm_mul_ps(vr[5],z)),vt[1]) );
+			_mm_storeu_ps(gz+i, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vr[6],x),_mm_mul_ps(vr[7],y)),_mm_mul_ps(vr[8],z)),vt[2]) );
+		}
+	}
+#endif
+	transformPoints3D_scalar(r,tt,i,N,lx,ly,lz,gx,gy,gz);
+}
+
+void mrpt::math::transformPoints3D(const double R[9], const double t[3], const size_t N,
+	const double *lx, const double *ly, const double *lz, double *gx, double *gy, double *gz)
+{
+	size_t i=0;
+
+#if MRPT_HAS_AVX2
+	{
+		__m256d vr[9], vt[3];
+		for (int k=0;k<9;k++) vr[k]=_mm256_set1_pd(R[k]);
+		for (int k=0;k<3;k++) vt[k]=_mm256_set1_pd(t[k]);
+		for ( ;i+4<=N;i+=4)
+		{
+			const __m256d x = _mm256_loadu_pd(lx+i), y = _mm256_loadu_pd(ly+i), z = _mm256_loadu_pd(lz+i);
+			_mm256_storeu_pd(gx+i, _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vr[0],x),_mm256_mul_pd(vr[1],y)),_mm256_mul_pd(vr[2],z)),vt[0]) );
+			_mm256_storeu_pd(gy+i, _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vr[3],x),_mm256_mul_pd(vr[4],y)),_mm256_mul_pd(vr[5],z)),vt[1]) );
+			_mm256_storeu_pd(gz+i, _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vr[6],x),_mm256_mul_pd(vr[7],y)),_mm256_mul_pd(vr[8],z)),vt[2]) );
+		}
+	}
+#endif
+#if MRPT_HAS_SSE2
+	{
+		__m128d vr[9], vt[3];
+		for (int k=0;k<9;k++) vr[k]=_mm_set1_pd(R[k]);
+		for (int k=0;k<3;k++) vt[k]=_mm_set1_pd(t[k]);
+		for ( ;i+2<=N;i+=2)
+		{
+			const __m128d x = _mm_loadu_pd(lx+i), y = _mm_loadu_pd(ly+i), z = _mm_loadu_pd(lz+i);
+			_mm_storeu_pd(gx+i, _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(vr[0],x),_mm_mul_pd(vr[1],y)),_mm_mul_pd(vr[2],z)),vt[0]) );
+			_mm_storeu_pd(gy+i, _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(vr[3],x),_mm_mul_pd(vr[4],y)),_mm_mul_pd(vr[5],z)),vt[1]) );
+			_mm_storeu_pd(gz+i, _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(vr[6],x),_mm_mul_pd(vr[7],y)),_mm_mul_pd(vr[8],z)),vt[2]) );
+		}
+	}
+#endif
+	transformPoints3D_scalar(R,t,i,N,lx,ly,lz,gx,gy,gz);
+}
+
+void mrpt::math::transformPoints2D(const double ccos, const double csin, const double tx, const double ty, const size_t N,
+	const float *lx, const float *ly, float *gx, float *gy)
+{
+	const float c = static_cast<float>(ccos), s = static_cast<float>(csin);
+	const float ftx = static_cast<float>(tx), fty = static_cast<float>(ty);
+	size_t i=0;
+
+#if MRPT_HAS_AVX2
+	{
+		const __m256 vc = _mm256_set1_ps(c), vs = _mm256_set1_ps(s), vtx = _mm256_set1_ps(ftx), vty = _mm256_set1_ps(fty);
+		for ( ;i+8<=N;i+=8)
+		{
+			const __m256 x = _mm256_loadu_ps(lx+i), y = _mm256_loadu_ps(ly+i);
+			_mm256_storeu_ps(gx+i, _mm256_sub_ps(_mm256_add_ps(vtx,_mm256_mul_ps(x,vc)),_mm256_mul_ps(y,vs)) );
+			_mm256_storeu_ps(gy+i, _mm256_add_ps(_mm256_add_ps(vty,_mm256_mul_ps(x,vs)),_mm256_mul_ps(y,vc)) );
+		}
+	}
+#endif
+#if MRPT_HAS_SSE2
+	{
+		const __m128 vc = _mm_set1_ps(c), vs = _mm_set1_ps(s), vtx = _mm_set1_ps(ftx), vty = _mm_set1_ps(fty);
+		for ( ;i+4<=N;i+=4)
+		{
+			const __m128 x = _mm_loadu_ps(lx+i), y = _mm_loadu_ps(ly+i);
+			_mm_storeu_ps(gx+i, _mm_sub_ps(_mm_add_ps(vtx,_mm_mul_ps(x,vc)),_mm_mul_ps(y,vs)) );
+			_mm_storeu_ps(gy+i, _mm_add_ps(_mm_add_ps(vty,_mm_mul_ps(x,vs)),_mm_mul_ps(y,vc)) );
+		}
+	}
+#endif
+	transformPoints2D_scalar(c,s,ftx,fty,i,N,lx,ly,gx,gy);
+}
+
+void mrpt::math::transformPoints2D(const double ccos, const double csin, const double tx, const double ty, const size_t N,
+	const double *lx, const double *ly, double *gx, double *gy)
+{
+	size_t i=0;
+
+#if MRPT_HAS_AVX2
+	{
+		const __m256d vc = _mm256_set1_pd(ccos), vs = _mm256_set1_pd(csin), vtx = _mm256_set1_pd(tx), vty = _mm256_set1_pd(ty);
+		for ( ;i+4<=N;i+=4)
+		{
+			const __m256d x = _mm256_loadu_pd(lx+i), y = _mm256_loadu_pd(ly+i);
+			_mm256_storeu_pd(gx+i, _mm256_sub_pd(_mm256_add_pd(vtx,_mm256_mul_pd(x,vc)),_mm256_mul_pd(y,vs)) );
+			_mm256_storeu_pd(gy+i, _mm256_add_pd(_mm256_add_pd(vty,_mm256_mul_pd(x,vs)),_mm256_mul_pd(y,vc)) );
+		}
+	}
+#endif
+#if MRPT_HAS_SSE2
+	{
+		const __m128d vc = _mm_set1_pd(ccos), vs = _mm_set1_pd(csin), vtx = _mm_set1_pd(tx), vty = _mm_set1_pd(ty);
+		for ( ;i+2<=N;i+=2)
+		{
+			const __m128d x = _mm_loadu_pd(lx+i), y = _mm_loadu_pd(ly+i);
+			_mm_storeu_pd(gx+i, _mm_sub_pd(_mm_add_pd(vtx,_mm_mul_pd(x,vc)),_mm_mul_pd(y,vs)) );
+			_mm_storeu_pd(gy+i, _mm_add_pd(_mm_add_pd(vty,_mm_mul_pd(x,vs)),_mm_mul_pd(y,vc)) );
+		}
+	}
+#endif
+	transformPoints2D_scalar(ccos,csin,tx,ty,i,N,lx,ly,gx,gy);
+}
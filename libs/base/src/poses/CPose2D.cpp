@@ -15,6 +15,7 @@
 #include <mrpt/poses/CPose3D.h>
 #include <mrpt/poses/CPoint3D.h>
 #include <mrpt/math/utils.h>
+#include <mrpt/math/transform_points.h>
 
 using namespace mrpt;
 using namespace mrpt::math;
@@ -201,6 +202,36 @@ void CPose2D::composePoint(double lx,double ly,double lz, double &gx, double &gy
 	gz = lz;
 }
 
+void CPose2D::composePoints(const size_t N, const float *lx,const float *ly, float *gx,float *gy) const
+{
+	update_cached_cos_sin();
+	mrpt::math::transformPoints2D(m_cosphi,m_sinphi,m_coords[0],m_coords[1], N, lx,ly, gx,gy);
+}
+
+void CPose2D::composePoints(const size_t N, const double *lx,const double *ly, double *gx,double *gy) const
+{
+	update_cached_cos_sin();
+	mrpt::math::transformPoints2D(m_cosphi,m_sinphi,m_coords[0],m_coords[1], N, lx,ly, gx,gy);
+}
+
+void CPose2D::inverseComposePoints(const size_t N, const float *gx,const float *gy, float *lx,float *ly) const
+{
+	update_cached_cos_sin();
+	// L = R(-phi) * (G - t):
+	mrpt::math::transformPoints2D(m_cosphi,-m_sinphi,
+		-m_coords[0]*m_cosphi - m_coords[1]*m_sinphi,
+		 m_coords[0]*m_sinphi - m_coords[1]*m_cosphi, N, gx,gy, lx,ly);
+}
+
+void CPose2D::inverseComposePoints(const size_t N, const double *gx,const double *gy, double *lx,double *ly) const
+{
+	update_cached_cos_sin();
+	// L = R(-phi) * (G - t):
+	mrpt::math::transformPoints2D(m_cosphi,-m_sinphi,
+		-m_coords[0]*m_cosphi - m_coords[1]*m_sinphi,
+		 m_coords[0]*m_sinphi - m_coords[1]*m_cosphi, N, gx,gy, lx,ly);
+}
+
 
 /*---------------------------------------------------------------
 The operator u'="this"+u is the pose/point compounding operator.
@@ -19,6 +19,7 @@
 
 #include <mrpt/math/utils.h>
 #include <mrpt/math/geometry.h>
+#include <mrpt/math/transform_points.h>
 #include <mrpt/math/CMatrix.h>
 
 
@@ -760,6 +761,115 @@ void CPose3D::inverseComposePoint(const double gx,const double gy,const double g
 	}
 }
 
+/*---------------------------------------------------------------
+			Batch transformation of points
+  ---------------------------------------------------------------*/
+namespace
+{
+	inline void rotTransToArrays(const CMatrixDouble33 &R, const double tx,const double ty,const double tz, double r[9], double t[3])
+	{
+		for (int i=0;i<3;i++)
+			for (int j=0;j<3;j++)
+				r[3*i+j] = R(i,j);
+		t[0]=tx; t[1]=ty; t[2]=tz;
+	}
+}
+
+void CPose3D::composePoints(const size_t N, const float *lx,const float *ly,const float *lz, float *gx,float *gy,float *gz) const
+{
+	double r[9],t[3];
+	rotTransToArrays(m_ROT,m_coords[0],m_coords[1],m_coords[2], r,t);
+	mrpt::math::transformPoints3D(r,t,N, lx,ly,lz, gx,gy,gz);
+}
+
+void CPose3D::composePoints(const size_t N, const double *lx,const double *ly,const double *lz, double *gx,double *gy,double *gz) const
+{
+	double r[9],t[3];
+	rotTransToArrays(m_ROT,m_coords[0],m_coords[1],m_coords[2], r,t);
+	mrpt::math::transformPoints3D(r,t,N, lx,ly,lz, gx,gy,gz);
+}
+
+void CPose3D::inverseComposePoints(const size_t N, const float *gx,const float *gy,const float *gz, float *lx,float *ly,float *lz) const
+{
+	CMatrixDouble33  R_inv(UNINITIALIZED_MATRIX);
+	CArrayDouble<3>  t_inv;
+	mrpt::math::homogeneousMatrixInverse(m_ROT,m_coords,  R_inv,t_inv);
+
+	double r[9],t[3];
+	rotTransToArrays(R_inv,t_inv[0],t_inv[1],t_inv[2], r,t);
+	mrpt::math::transformPoints3D(r,t,N, gx,gy,gz, lx,ly,lz);
+}
+
+void CPose3D::inverseComposePoints(const size_t N, const double *gx,const double *gy,const double *gz, double *lx,double *ly,double *lz) const
+{
+	CMatrixDouble33  R_inv(UNINITIALIZED_MATRIX);
+	CArrayDouble<3>  t_inv;
+	mrpt::math::homogeneousMatrixInverse(m_ROT,m_coords,  R_inv,t_inv);
+
+	double r[9],t[3];
+	rotTransToArrays(R_inv,t_inv[0],t_inv[1],t_inv[2], r,t);
+	mrpt::math::transformPoints3D(r,t,N, gx,gy,gz, lx,ly,lz);
+}
+
+void CPose3D::composePointsWithJacobians(const size_t N, const double *lx,const double *ly,const double *lz, double *gx,double *gy,double *gz,
+	mrpt::math::CMatrixFixedNumeric<double,3,6>  *out_jacobians_df_dpose,
+	mrpt::math::CMatrixFixedNumeric<double,3,6>  *out_jacobians_df_dse3) const
+{
+	composePoints(N, lx,ly,lz, gx,gy,gz);
+
+	if (out_jacobians_df_dpose)
+	{
+		// The same than in composePoint(), but with the sin & cos computed only once:
+		updateYawPitchRoll();
+#	ifdef HAVE_SINCOS
+		double	cy,sy;
+		::sincos(m_yaw,&sy,&cy);
+		double	cp,sp;
+		::sincos(m_pitch,&sp,&cp);
+		double	cr,sr;
+		::sincos(m_roll,&sr,&cr);
+#	else
+		const double	cy = cos(m_yaw);
+		const double	sy = sin(m_yaw);
+		const double	cp = cos(m_pitch);
+		const double	sp = sin(m_pitch);
+		const double	cr = cos(m_roll);
+		const double	sr = sin(m_roll);
+#	endif
+		for (size_t i=0;i<N;i++)
+		{
+			const double x=lx[i], y=ly[i], z=lz[i];
+			EIGEN_ALIGN16 const double nums[3*6] = {
+				1, 0, 0,
+					-x*sy*cp+y*(-sy*sp*sr-cy*cr)+z*(-sy*sp*cr+cy*sr),   // d_x'/d_yaw
+					-x*cy*sp+y*(cy*cp*sr       )+z*(cy*cp*cr      ),   // d_x'/d_pitch
+							 y*(cy*sp*cr+sy*sr)+z*(-cy*sp*sr+sy*cr),   // d_x'/d_roll
+				0, 1, 0,
+					 x*cy*cp+y*(cy*sp*sr-sy*cr)+z*(cy*sp*cr+sy*sr),   // d_y'/d_yaw
+					-x*sy*sp+y*(sy*cp*sr)      +z*(sy*cp*cr      ),   // d_y'/d_pitch
+							 y*(sy*sp*cr-cy*sr)+z*(-sy*sp*sr-cy*cr),   // d_y'/d_roll
+				0, 0, 1,
+					0,  // d_z' / d_yaw
+					-x*cp-y*sp*sr-z*sp*cr,  // d_z' / d_pitch
+					y*cp*cr-z*cp*sr  // d_z' / d_roll
+				};
+			out_jacobians_df_dpose[i].loadFromArray(nums);
+		}
+	}
+
+	if (out_jacobians_df_dse3)
+	{
+		for (size_t i=0;i<N;i++)
+		{
+			EIGEN_ALIGN16 const double nums[3*6] = {
+				1, 0, 0,      0,  gz[i], -gy[i],
+				0, 1, 0, -gz[i],      0,  gx[i],
+				0, 0, 1,  gy[i], -gx[i],      0 };
+			out_jacobians_df_dse3[i].loadFromArray(nums);
+		}
+	}
+}
+
 /** Exponentiate a Vector in the SE3 Lie Algebra to generate a new CPose3D.
   * \note Method from TooN (C) Tom Drummond (GNU GPL)
   */
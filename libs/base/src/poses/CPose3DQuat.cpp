@@ -19,6 +19,7 @@
 #include <mrpt/poses/CPose3DQuat.h>
 
 #include <mrpt/math/utils.h>
+#include <mrpt/math/transform_points.h>
 #include <mrpt/math/CMatrix.h>
 
 using namespace std;
@@ -287,6 +288,64 @@ void CPose3DQuat::inverseComposePoint(const double gx,const double gy,const doub
 	m_quat.inverseRotatePoint(gx-m_coords[0],gy-m_coords[1],gz-m_coords[2],  lx,ly,lz);
 }
 
+/*---------------------------------------------------------------
+			Batch transformation of points
+  ---------------------------------------------------------------*/
+namespace
+{
+	/** Rotation matrix and translation of the pose (or of its inverse), as plain arrays for mrpt::math::transformPoints3D */
+	void quatPoseToArrays(const CPose3DQuat &p, const bool inverse, double r[9], double t[3])
+	{
+		CMatrixDouble33 R(UNINITIALIZED_MATRIX);
+		p.quat().rotationMatrixNoResize(R);
+		if (!inverse)
+		{
+			for (int i=0;i<3;i++)
+			{
+				for (int j=0;j<3;j++) r[3*i+j] = R(i,j);
+				t[i] = p[i];
+			}
+		}
+		else
+		{
+			// L = R^t * (G - t)
+			for (int i=0;i<3;i++)
+			{
+				for (int j=0;j<3;j++) r[3*i+j] = R(j,i);
+				t[i] = -(R(0,i)*p[0] + R(1,i)*p[1] + R(2,i)*p[2]);
+			}
+		}
+	}
+}
+
+void CPose3DQuat::composePoints(const size_t N, const float *lx,const float *ly,const float *lz, float *gx,float *gy,float *gz) const
+{
+	double r[9],t[3];
+	quatPoseToArrays(*this,false, r,t);
+	mrpt::math::transformPoints3D(r,t,N, lx,ly,lz, gx,gy,gz);
+}
+
+void CPose3DQuat::composePoints(const size_t N, const double *lx,const double *ly,const double *lz, double *gx,double *gy,double *gz) const
+{
+	double r[9],t[3];
+	quatPoseToArrays(*this,false, r,t);
+	mrpt::math::transformPoints3D(r,t,N, lx,ly,lz, gx,gy,gz);
+}
+
+void CPose3DQuat::inverseComposePoints(const size_t N, const float *gx,const float *gy,const float *gz, float *lx,float *ly,float *lz) const
+{
+	double r[9],t[3];
+	quatPoseToArrays(*this,true, r,t);
+	mrpt::math::transformPoints3D(r,t,N, gx,gy,gz, lx,ly,lz);
+}
+
+void CPose3DQuat::inverseComposePoints(const size_t N, const double *gx,const double *gy,const double *gz, double *lx,double *ly,double *lz) const
+{
+	double r[9],t[3];
+	quatPoseToArrays(*this,true, r,t);
+	mrpt::math::transformPoints3D(r,t,N, gx,gy,gz, lx,ly,lz);
+}
+
 /*---------------------------------------------------------------
 	*=
   ---------------------------------------------------------------*/
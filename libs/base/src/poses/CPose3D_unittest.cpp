@@ -469,6 +469,65 @@ protected:
 			<< "ERR:\n" << theor_jacob-numJacobs << endl;
 	}
 
+	// Batch methods vs. composePoint() & inverseComposePoint() point by point:
+	void test_composePoints(double x1,double y1,double z1, double yaw1,double pitch1,double roll1)
+	{
+		const CPose3D p(x1,y1,z1,yaw1,pitch1,roll1);
+
+		const size_t N = 19; // Not a multiple of the SIMD packet sizes
+		std::vector<double> lx(N),ly(N),lz(N), gx(N),gy(N),gz(N), ix(N),iy(N),iz(N);
+		std::vector<float> flx(N),fly(N),flz(N), fgx(N),fgy(N),fgz(N);
+		for (size_t i=0;i<N;i++)
+		{
+			lx[i] = -10.0+1.1*i; ly[i] = 5.0-0.7*i; lz[i] = 0.3*i*i-4.0;
+			flx[i] = lx[i]; fly[i] = ly[i]; flz[i] = lz[i];
+		}
+
+		std::vector<CMatrixFixedNumeric<double,3,6> > jacobs_pose(N), jacobs_se3(N);
+		p.composePointsWithJacobians(N, &lx[0],&ly[0],&lz[0], &gx[0],&gy[0],&gz[0], &jacobs_pose[0],&jacobs_se3[0]);
+		p.composePoints(N, &flx[0],&fly[0],&flz[0], &fgx[0],&fgy[0],&fgz[0]);
+		p.inverseComposePoints(N, &gx[0],&gy[0],&gz[0], &ix[0],&iy[0],&iz[0]);
+
+		for (size_t i=0;i<N;i++)
+		{
+			double x,y,z;
+			CMatrixFixedNumeric<double,3,3> df_dpoint;
+			CMatrixFixedNumeric<double,3,6> df_dpose, df_dse3;
+			p.composePoint(lx[i],ly[i],lz[i], x,y,z, &df_dpoint,&df_dpose,&df_dse3);
+
+			EXPECT_NEAR(x,gx[i],1e-9); EXPECT_NEAR(y,gy[i],1e-9); EXPECT_NEAR(z,gz[i],1e-9);
+			EXPECT_NEAR(x,fgx[i],1e-4); EXPECT_NEAR(y,fgy[i],1e-4); EXPECT_NEAR(z,fgz[i],1e-4);
+			EXPECT_NEAR((df_dpose-jacobs_pose[i]).Abs().sumAll(), 0, 1e-9) << "Pose: " << p << endl;
+			EXPECT_NEAR((df_dse3-jacobs_se3[i]).Abs().sumAll(), 0, 1e-9) << "Pose: " << p << endl;
+
+			EXPECT_NEAR(lx[i],ix[i],1e-9); EXPECT_NEAR(ly[i],iy[i],1e-9); EXPECT_NEAR(lz[i],iz[i],1e-9);
+		}
+
+		// The same for the equivalent quaternion pose:
+		const CPose3DQuat q(p);
+		std::vector<double> qgx(N),qgy(N),qgz(N);
+		q.composePoints(N, &lx[0],&ly[0],&lz[0], &qgx[0],&qgy[0],&qgz[0]);
+		q.inverseComposePoints(N, &qgx[0],&qgy[0],&qgz[0], &ix[0],&iy[0],&iz[0]);
+		for (size_t i=0;i<N;i++)
+		{
+			EXPECT_NEAR(gx[i],qgx[i],1e-9); EXPECT_NEAR(gy[i],qgy[i],1e-9); EXPECT_NEAR(gz[i],qgz[i],1e-9);
+			EXPECT_NEAR(lx[i],ix[i],1e-9); EXPECT_NEAR(ly[i],iy[i],1e-9); EXPECT_NEAR(lz[i],iz[i],1e-9);
+		}
+
+		// And for the 2D pose with the same (x,y,yaw):
+		const CPose2D p2(x1,y1,yaw1);
+		p2.composePoints(N, &lx[0],&ly[0], &gx[0],&gy[0]);
+		p2.composePoints(N, &flx[0],&fly[0], &fgx[0],&fgy[0]);
+		p2.inverseComposePoints(N, &gx[0],&gy[0], &ix[0],&iy[0]);
+		for (size_t i=0;i<N;i++)
+		{
+			double x,y;
+			p2.composePoint(lx[i],ly[i], x,y);
+			EXPECT_NEAR(x,gx[i],1e-9); EXPECT_NEAR(y,gy[i],1e-9);
+			EXPECT_NEAR(x,fgx[i],1e-4); EXPECT_NEAR(y,fgy[i],1e-4);
+			EXPECT_NEAR(lx[i],ix[i],1e-9); EXPECT_NEAR(ly[i],iy[i],1e-9);
+		}
+	}
 
 };
 
@@ -590,6 +649,14 @@ TEST_F(Pose3DTests,ComposeAndInvComposeWithPoint)
 	test_composePoint(1.0,2.0,3.0, DEG2RAD(10),DEG2RAD(-50),DEG2RAD(-40),  -5.0, -15.0, 8.0 );
 }
 
+TEST_F(Pose3DTests,ComposeAndInvComposePoints)
+{
+	test_composePoints(1.0,2.0,3.0, DEG2RAD(0),DEG2RAD(0),DEG2RAD(0) );
+	test_composePoints(1.0,2.0,3.0, DEG2RAD(10),DEG2RAD(0),DEG2RAD(0) );
+	test_composePoints(1.0,2.0,3.0, DEG2RAD(-30),DEG2RAD(10),DEG2RAD(60) );
+	test_composePoints(-4.0,0.5,1.0, DEG2RAD(10),DEG2RAD(-50),DEG2RAD(-40) );
+}
+
 TEST_F(Pose3DTests,ComposePointJacob)
 {
 	test_composePointJacob(1.0,2.0,3.0, DEG2RAD(0),DEG2RAD(0),DEG2RAD(0),   10,11,12 );
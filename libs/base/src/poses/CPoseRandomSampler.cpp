@@ -151,17 +151,22 @@ void CPoseRandomSampler::setPosePDF( const CPose3DPDF *pdf )
                     drawSample
   ---------------------------------------------------------------*/
 CPose2D & CPoseRandomSampler::drawSample( CPose2D &p ) const
+{
+	return drawSample(p,randomGenerator);
+}
+
+CPose2D & CPoseRandomSampler::drawSample( CPose2D &p, CRandomGenerator &rng ) const
 {
     MRPT_START
 
 	if (m_pdf2D)
 	{
-		do_sample_2D(p);
+		do_sample_2D(p,rng);
 	}
 	else if (m_pdf3D)
 	{
 		CPose3D  q;
-		do_sample_3D(q);
+		do_sample_3D(q,rng);
 		p.x(q.x());
 		p.y(q.y());
 		p.phi(q.yaw());
@@ -176,18 +181,23 @@ CPose2D & CPoseRandomSampler::drawSample( CPose2D &p ) const
                     drawSample
   ---------------------------------------------------------------*/
 CPose3D & CPoseRandomSampler::drawSample( CPose3D &p ) const
+{
+	return drawSample(p,randomGenerator);
+}
+
+CPose3D & CPoseRandomSampler::drawSample( CPose3D &p, CRandomGenerator &rng ) const
 {
     MRPT_START
 
 	if (m_pdf2D)
 	{
 		CPose2D q;
-		do_sample_2D(q);
+		do_sample_2D(q,rng);
 		p.setFromValues(q.x(),q.y(),0,q.phi(),0,0);
 	}
 	else if (m_pdf3D)
 	{
-		do_sample_3D(p);
+		do_sample_3D(p,rng);
 	}
 	else THROW_EXCEPTION("No associated pdf: setPosePDF must be called first.");
 
@@ -199,7 +209,7 @@ CPose3D & CPoseRandomSampler::drawSample( CPose3D &p ) const
 /*---------------------------------------------------------------
                   do_sample_2D: Sample from a 2D PDF
   ---------------------------------------------------------------*/
-void CPoseRandomSampler::do_sample_2D( CPose2D &p ) const
+void CPoseRandomSampler::do_sample_2D( CPose2D &p, CRandomGenerator &rng ) const
 {
 	MRPT_START
 	ASSERT_(m_pdf2D);
@@ -210,10 +220,12 @@ void CPoseRandomSampler::do_sample_2D( CPose2D &p ) const
 		// ------------------------------
 		//      A single gaussian:
 		// ------------------------------
+		double	rnds[3];
+		rng.drawGaussian1DArray(rnds,3);
 		vector_double	rndVector(3,0);
 		for (size_t i=0;i<3;i++)
 		{
-			double	rnd = randomGenerator.drawGaussian1D_normalized();
+			const double rnd = rnds[i];
 			for (size_t d=0;d<3;d++)
 				rndVector[d]+= ( m_fastdraw_gauss_Z3.get_unsafe(d,i)*rnd );
 		}
@@ -237,8 +249,19 @@ void CPoseRandomSampler::do_sample_2D( CPose2D &p ) const
 		// -------------------------------------
 		//      Particles: just sample as usual
 		// -------------------------------------
+		// (Same than CPosePDFParticles::drawSingleSample(), but with the given generator)
 		const CPosePDFParticles* pdf = static_cast<const CPosePDFParticles*>(m_pdf2D);
-		pdf->drawSingleSample(p);
+		ASSERT_(!pdf->m_particles.empty())
+		const double uni = rng.drawUniform(0.0,0.9999);
+		double cum = 0;
+		CPosePDFParticles::CParticleList::const_iterator it;
+		for (it=pdf->m_particles.begin();it!=pdf->m_particles.end();++it)
+		{
+			cum+= exp(it->log_w);
+			if ( uni<= cum ) break;
+		}
+		if (it==pdf->m_particles.end()) --it; // Might not come here normally
+		p = *it->d;
 	}
 	else
 		THROW_EXCEPTION_CUSTOM_MSG1("Unsoported class: %s", m_pdf2D->GetRuntimeClass()->className );
@@ -249,7 +272,7 @@ void CPoseRandomSampler::do_sample_2D( CPose2D &p ) const
 /*---------------------------------------------------------------
                   do_sample_3D: Sample from a 3D PDF
   ---------------------------------------------------------------*/
-void CPoseRandomSampler::do_sample_3D( CPose3D &p ) const
+void CPoseRandomSampler::do_sample_3D( CPose3D &p, CRandomGenerator &rng ) const
 {
 	MRPT_START
 	ASSERT_(m_pdf3D);
@@ -260,10 +283,12 @@ void CPoseRandomSampler::do_sample_3D( CPose3D &p ) const
 		// ------------------------------
 		//      A single gaussian:
 		// ------------------------------
+		double	rnds[6];
+		rng.drawGaussian1DArray(rnds,6);
 		vector_double	rndVector(6,0);
 		for (size_t i=0;i<6;i++)
 		{
-			double	rnd = randomGenerator.drawGaussian1D_normalized();
+			const double rnd = rnds[i];
 			for (size_t d=0;d<6;d++)
 				rndVector[d]+= ( m_fastdraw_gauss_Z6.get_unsafe(d,i)*rnd );
 		}
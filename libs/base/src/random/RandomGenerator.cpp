@@ -92,6 +92,73 @@ void CRandomGenerator::MT19937_generateNumbers()
 #endif
 }
 
+// Philox4x32-10 algorithm
+//  J.K. Salmon, M.A. Moraes, R.O. Dror, D.E. Shaw, "Parallel random numbers: as easy as 1, 2, 3", SC'11.
+// Each output block is a bijective function of the 128-bit counter, keyed with the 64-bit seed.
+namespace
+{
+	inline void philox4x32_10(const uint32_t ctr[4], const uint32_t key[2], uint32_t out[4])
+	{
+		uint32_t c0=ctr[0], c1=ctr[1], c2=ctr[2], c3=ctr[3];
+		uint32_t k0=key[0], k1=key[1];
+		for (int r=0;r<10;r++)
+		{
+			if (r) { k0+=0x9E3779B9; k1+=0xBB67AE85; } // Bump the key
+			const uint64_t p0 = static_cast<uint64_t>(0xD2511F53) * c0;
+			const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57) * c2;
+			c0 = static_cast<uint32_t>(p1>>32) ^ c1 ^ k0;
+			c1 = static_cast<uint32_t>(p1);
+			c2 = static_cast<uint32_t>(p0>>32) ^ c3 ^ k1;
+			c3 = static_cast<uint32_t>(p0);
+		}
+		out[0]=c0; out[1]=c1; out[2]=c2; out[3]=c3;
+	}
+
+	inline void philox_addToCounter(uint32_t ctr[4], const uint64_t n)
+	{
+		const uint64_t c = (static_cast<uint64_t>(ctr[1])<<32 | ctr[0]) + n;
+		ctr[0] = static_cast<uint32_t>(c);
+		ctr[1] = static_cast<uint32_t>(c>>32);
+	}
+}
+
+void CRandomGenerator::Philox_generateBlock(uint32_t out[4])
+{
+	philox4x32_10(m_Philox_data.counter,m_Philox_data.key,out);
+	philox_addToCounter(m_Philox_data.counter,1);
+}
+
+void CRandomGenerator::randomizeStream(const uint64_t seed, const uint64_t stream)
+{
+	m_counter_based = true;
+	m_Philox_data.key[0] = static_cast<uint32_t>(seed);
+	m_Philox_data.key[1] = static_cast<uint32_t>(seed>>32);
+	m_Philox_data.counter[0] = m_Philox_data.counter[1] = 0;
+	m_Philox_data.counter[2] = static_cast<uint32_t>(stream);
+	m_Philox_data.counter[3] = static_cast<uint32_t>(stream>>32);
+	m_Philox_data.index = 4;
+	m_std_gauss_set = false;
+}
+
+void CRandomGenerator::discard(uint64_t n)
+{
+	if (!m_counter_based)
+	{
+		while (n--) drawUniform32bit();
+		return;
+	}
+	// Numbers left in the current block:
+	while (n && m_Philox_data.index<4) { m_Philox_data.index++; n--; }
+	// Whole blocks:
+	philox_addToCounter(m_Philox_data.counter,n/4);
+	// And part of the next one:
+	if (n%4)
+	{
+		Philox_generateBlock(m_Philox_data.buf);
+		m_Philox_data.index = static_cast<uint32_t>(n%4);
+	}
+}
+
 uint64_t CRandomGenerator::drawUniform64bit()
 {
 	uint32_t n1 = drawUniform32bit();
@@ -103,6 +170,16 @@ uint64_t CRandomGenerator::drawUniform64bit()
 // http://en.wikipedia.org/wiki/Mersenne_twister
 uint32_t CRandomGenerator::drawUniform32bit()
 {
+	if (m_counter_based)
+	{
+		if (m_Philox_data.index>=4)
+		{
+			Philox_generateBlock(m_Philox_data.buf);
+			m_Philox_data.index = 0;
+		}
+		return m_Philox_data.buf[m_Philox_data.index++];
+	}
+
 	if (!m_MT19937_data.index)
 		MT19937_generateNumbers();
 
@@ -119,13 +196,63 @@ uint32_t CRandomGenerator::drawUniform32bit()
 	return y;
 }
 
+void CRandomGenerator::drawUniform32bitArray(uint32_t *out, const size_t N)
+{
+	if (!m_counter_based)
+	{
+		for (size_t i=0;i<N;i++) out[i] = drawUniform32bit();
+		return;
+	}
+	size_t i=0;
+	// Numbers left in the current block:
+	while (i<N && m_Philox_data.index<4)
+		out[i++] = m_Philox_data.buf[m_Philox_data.index++];
+	// Whole blocks, straight into the output:
+	for ( ;i+4<=N;i+=4)
+		Philox_generateBlock(out+i);
+	// And part of the next one:
+	while (i<N)
+		out[i++] = drawUniform32bit();
+}
+
+namespace
+{
+	template <typename T>
+	void drawUniformArrayImpl(CRandomGenerator &rng, T *out, const size_t N, const double unif_min, const double unif_max)
+	{
+		// By chunks, so the 32bit numbers are generated in bulk and the conversion loop can be vectorized:
+		const size_t CHUNK = 256;
+		uint32_t rnd[CHUNK];
+		const double range = unif_max-unif_min;
+		for (size_t i=0;i<N;i+=CHUNK)
+		{
+			const size_t n = std::min(CHUNK,N-i);
+			rng.drawUniform32bitArray(rnd,n);
+			for (size_t k=0;k<n;k++)
+				out[i+k] = static_cast<T>( unif_min + range*rnd[k]*2.3283064370807973754314699618685e-10 ); // Same operations than drawUniform(), for identical results
+		}
+	}
+}
+
+void CRandomGenerator::drawUniformArray(double *out, const size_t N, const double unif_min, const double unif_max)
+{
+	drawUniformArrayImpl(*this,out,N,unif_min,unif_max);
+}
+
+void CRandomGenerator::drawUniformArray(float *out, const size_t N, const double unif_min, const double unif_max)
+{
+	drawUniformArrayImpl(*this,out,N,unif_min,unif_max);
+}
+
 /*---------------------------------------------------------------
 						Randomize
   ---------------------------------------------------------------*/
 void CRandomGenerator::randomize(const uint32_t seed)
 {
+	m_counter_based = false;
 	MT19937_initializeGenerator(seed);
 	m_MT19937_data.index = 0;
+	m_std_gauss_set = false;
 }
 
 /*---------------------------------------------------------------
@@ -133,8 +260,10 @@ void CRandomGenerator::randomize(const uint32_t seed)
   ---------------------------------------------------------------*/
 void CRandomGenerator::randomize()
 {
+	m_counter_based = false;
 	MT19937_initializeGenerator( static_cast<uint32_t>(mrpt::system::getCurrentTime()) );
 	m_MT19937_data.index = 0;
+	m_std_gauss_set = false;
 }
 
 /*---------------------------------------------------------------
@@ -188,6 +317,51 @@ double CRandomGenerator::drawGaussian1D_normalized( double *likelihood  )
    }
 }
 
+namespace
+{
+	template <typename T>
+	void drawGaussian1DArrayImpl(CRandomGenerator &rng, T *out, const size_t N, const double mean, const double std, bool &std_gauss_set, double &std_gauss_next)
+	{
+		// The same sequence than drawGaussian1D_normalized(), without the per-sample overhead:
+		size_t i=0;
+		if (N && std_gauss_set)
+		{
+			out[i++] = static_cast<T>( mean+std*std_gauss_next );
+			std_gauss_set = false;
+		}
+		while (i<N)
+		{
+			double v1,v2,r;
+			do
+			{
+				v1 = rng.drawUniform(-1.0,1.0);
+				v2 = rng.drawUniform(-1.0,1.0);
+				r = v1 * v1 + v2 * v2;
+			} while (r >= 1.0 || r==0.0);
+			const double fac = std::sqrt(-2.0*log(r)/r);
+
+			out[i++] = static_cast<T>( mean+std*(v2*fac) );
+			if (i<N)
+				out[i++] = static_cast<T>( mean+std*(v1*fac) );
+			else
+			{	// Keep the second one for the next call:
+				std_gauss_next = v1*fac;
+				std_gauss_set = true;
+			}
+		}
+	}
+}
+
+void CRandomGenerator::drawGaussian1DArray(double *out, const size_t N, const double mean, const double std)
+{
+	drawGaussian1DArrayImpl(*this,out,N,mean,std, m_std_gauss_set,m_std_gauss_next);
+}
+
+void CRandomGenerator::drawGaussian1DArray(float *out, const size_t N, const double mean, const double std)
+{
+	drawGaussian1DArrayImpl(*this,out,N,mean,std, m_std_gauss_set,m_std_gauss_next);
+}
+
 /** Generates a random definite-positive matrix of the given size, using the formula C = v*v^t + epsilon*I, with "v" being a vector of gaussian random samples.
 */
 CMatrixDouble CRandomGenerator::drawDefinitePositiveMatrix(
@@ -0,0 +1,118 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/random.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::random;
+using namespace std;
+
+// Known-answer tests of Philox4x32-10 (from the Random123 distribution): the first block of stream 0 is the counter (0,0,0,0)
+TEST(RandomGenerator, PhiloxKnownAnswer)
+{
+	{
+		CRandomGenerator rng(uint64_t(0),uint64_t(0));
+		EXPECT_EQ(rng.drawUniform32bit(), 0x6627e8d5U);
+		EXPECT_EQ(rng.drawUniform32bit(), 0xe169c58dU);
+		EXPECT_EQ(rng.drawUniform32bit(), 0xbc57ac4cU);
+		EXPECT_EQ(rng.drawUniform32bit(), 0x9b00dbd8U);
+	}
+	{
+		// counter=(0x243f6a88,0x85a308d3,0x13198a2e,0x03707344), key=(0xa4093822,0x299f31d0)
+		CRandomGenerator rng( (uint64_t(0x299f31d0)<<32) | 0xa4093822, (uint64_t(0x03707344)<<32) | 0x13198a2e );
+		// Skip ahead to that block counter, in 4 steps to avoid overflowing the count of 32bit numbers (block is a multiple of 4):
+		const uint64_t block = (uint64_t(0x85a308d3)<<32) | 0x243f6a88;
+		for (int k=0;k<4;k++) rng.discard(block);
+		EXPECT_EQ(rng.drawUniform32bit(), 0xd16cfe09U);
+		EXPECT_EQ(rng.drawUniform32bit(), 0x94fdccebU);
+		EXPECT_EQ(rng.drawUniform32bit(), 0x5001e420U);
+		EXPECT_EQ(rng.drawUniform32bit(), 0x24126ea1U);
+	}
+}
+
+// Bulk methods must give the same sequence than one-by-one calls, with both algorithms:
+TEST(RandomGenerator, BulkEqualsSequential)
+{
+	for (int counter_based=0;counter_based<2;counter_based++)
+	{
+		CRandomGenerator rng1, rng2;
+		if (counter_based) { rng1.randomizeStream(1234,5); rng2.randomizeStream(1234,5); }
+		else               { rng1.randomize(1234); rng2.randomize(1234); }
+
+		// Odd sizes, to leave a cached Gaussian and partial Philox blocks in between:
+		const size_t sizes[] = { 1, 7, 13, 600, 3 };
+		for (size_t k=0;k<sizeof(sizes)/sizeof(sizes[0]);k++)
+		{
+			const size_t N = sizes[k];
+
+			std::vector<double> g(N);
+			rng1.drawGaussian1DVector(g, 1.0, 2.0);
+			for (size_t i=0;i<N;i++)
+				EXPECT_EQ(g[i], rng2.drawGaussian1D(1.0,2.0)) << "i=" << i << " N=" << N << " counter_based=" << counter_based;
+
+			std::vector<float> u(N);
+			rng1.drawUniformVector(u, -3.0, 5.0);
+			for (size_t i=0;i<N;i++)
+				EXPECT_EQ(u[i], static_cast<float>(rng2.drawUniform(-3.0,5.0))) << "i=" << i << " N=" << N << " counter_based=" << counter_based;
+
+			// A range which is not a power of two, where the rounding depends on the order of the operations:
+			std::vector<double> ud(N);
+			rng1.drawUniformVector(ud, 0.3, 2.0);
+			for (size_t i=0;i<N;i++)
+				EXPECT_EQ(ud[i], rng2.drawUniform(0.3,2.0)) << "i=" << i << " N=" << N << " counter_based=" << counter_based;
+
+			std::vector<uint32_t> w(N);
+			rng1.drawUniform32bitArray(&w[0],N);
+			for (size_t i=0;i<N;i++)
+				EXPECT_EQ(w[i], rng2.drawUniform32bit()) << "i=" << i << " N=" << N << " counter_based=" << counter_based;
+		}
+	}
+}
+
+TEST(RandomGenerator, StreamsAndDiscard)
+{
+	const size_t N = 1001;
+	std::vector<uint32_t> s0(N), s1(N);
+	CRandomGenerator(uint64_t(42),uint64_t(0)).drawUniform32bitArray(&s0[0],N);
+	CRandomGenerator(uint64_t(42),uint64_t(1)).drawUniform32bitArray(&s1[0],N);
+	EXPECT_NE(s0, s1);
+
+	// Skipping ahead from any position gives the same than drawing the numbers:
+	const size_t skips[] = { 0, 1, 3, 4, 5, 250, 997 };
+	for (size_t k=0;k<sizeof(skips)/sizeof(skips[0]);k++)
+	{
+		for (int counter_based=0;counter_based<2;counter_based++)
+		{
+			CRandomGenerator rng1, rng2;
+			if (counter_based) { rng1.randomizeStream(42,0); rng2.randomizeStream(42,0); }
+			else               { rng1.randomize(42); rng2.randomize(42); }
+
+			rng1.drawUniform32bit(); rng2.drawUniform32bit();  // Start in the middle of a block
+			rng1.discard(skips[k]);
+			for (size_t i=0;i<skips[k];i++) rng2.drawUniform32bit();
+			for (size_t i=0;i<10;i++)
+				EXPECT_EQ(rng1.drawUniform32bit(), rng2.drawUniform32bit()) << "skip=" << skips[k] << " counter_based=" << counter_based;
+		}
+	}
+}
+
+// A basic check of the Gaussian samples from the counter-based generator:
+TEST(RandomGenerator, PhiloxGaussianMoments)
+{
+	CRandomGenerator rng(uint64_t(7),uint64_t(3));
+	const size_t N = 200000;
+	std::vector<double> g(N);
+	rng.drawGaussian1DVector(g, 2.0, 3.0);
+	double m=0, m2=0;
+	for (size_t i=0;i<N;i++) { m+=g[i]; m2+=g[i]*g[i]; }
+	m/=N; m2/=N;
+	EXPECT_NEAR(m, 2.0, 0.05);
+	EXPECT_NEAR(std::sqrt(m2-m*m), 3.0, 0.05);
+}
@@ -0,0 +1,266 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/base.h>  // Precompiled headers
+
+#include <mrpt/system/parallelization.h>
+#include <mrpt/system/threads.h>
+#include <mrpt/synch/CCriticalSection.h>
+#include <mrpt/synch/CSemaphore.h>
+
+using namespace mrpt;
+using namespace mrpt::system;
+using namespace mrpt::synch;
+using namespace std;
+
+namespace
+{
+	/** Requested number of threads (0=one per processor) */
+	unsigned int parallel_requested_threads = 0;
+}
+
+#if !MRPT_HAS_TBB
+
+namespace
+{
+	/** The built-in pool of worker threads behind parallel_for() & co. when TBB is not available.
+	  *  Worker threads are launched on demand and kept alive until the program exits.
+	  *  Each job range is split into chunks, which are initially distributed in contiguous blocks among
+	  *  the threads; a thread that runs out of chunks steals half of the remaining ones from another thread.
+	  */
+	class CThreadPool
+	{
+	public:
+		CThreadPool() :
+			m_sem_done(0,10000),
+			m_busy(false),
+			m_quit(false),
+			m_job(NULL),
+			m_begin(0),m_end(0),m_chunk_size(1),
+			m_job_threads(0)
+		{
+		}
+
+		~CThreadPool()
+		{
+			m_quit = true;
+			for (size_t i=0;i<m_workers.size();i++)
+				m_workers[i]->sem_start.release();
+			for (size_t i=0;i<m_workers.size();i++)
+			{
+				joinThread(m_workers[i]->thread);
+				delete m_workers[i];
+			}
+			for (size_t i=0;i<m_queues.size();i++)
+				delete m_queues[i];
+		}
+
+		/** Reserves the pool for a new job. Returns the number of threads (including the caller), or 1 if the pool is busy. */
+		unsigned int acquire()
+		{
+			CCriticalSectionLocker lock(&m_cs);
+			if (m_busy) return 1;
+
+			unsigned int nThreads = parallel_requested_threads;
+			if (!nThreads) nThreads = getNumberOfProcessors();
+			if (nThreads<2) return 1;
+
+			// Launch the missing workers (thread #0 is the caller):
+			while (m_queues.size()<nThreads)
+				m_queues.push_back(new TChunkQueue());
+			while (m_workers.size()<nThreads-1)
+			{
+				TWorker *w = new TWorker();
+				w->idx = m_workers.size()+1;
+				m_workers.push_back(w);
+				w->thread = createThreadFromObjectMethod(this,&CThreadPool::workerThread,w);
+			}
+			m_busy = true;
+			return nThreads;
+		}
+
+		void release()
+		{
+			CCriticalSectionLocker lock(&m_cs);
+			m_busy = false;
+		}
+
+		void run(detail::CParallelJob &job, unsigned int nThreads, int begin, int end, int grainsize)
+		{
+			const int N = end-begin;
+			if (N<=0) return;
+
+			// Chunk size: at least "grainsize" iterations, and a few chunks per thread for load balancing:
+			const int nMinChunks = 8*nThreads;
+			m_chunk_size = std::max( std::max(1,grainsize), (N+nMinChunks-1)/nMinChunks );
+			const int nChunks = (N+m_chunk_size-1)/m_chunk_size;
+			nThreads = std::min(nThreads, static_cast<unsigned int>(nChunks));
+
+			m_job = &job;
+			m_begin = begin;
+			m_end = end;
+			m_job_threads = nThreads;
+			m_error.clear();
+
+			for (unsigned int i=0;i<nThreads;i++)
+			{
+				m_queues[i]->next = (nChunks*i)/nThreads;
+				m_queues[i]->end  = (nChunks*(i+1))/nThreads;
+			}
+
+			// Wake up the workers and also do our part of the job:
+			for (unsigned int i=1;i<nThreads;i++)
+				m_workers[i-1]->sem_start.release();
+
+			processChunks(0);
+
+			for (unsigned int i=1;i<nThreads;i++)
+				while (!m_sem_done.waitForSignal()) {}
+
+			m_job = NULL;
+			if (!m_error.empty())
+				throw std::runtime_error(m_error);
+		}
+
+	private:
+		struct TWorker
+		{
+			TWorker() : sem_start(0,10000), idx(0) {}
+			CSemaphore    sem_start;
+			TThreadHandle thread;
+			unsigned int  idx;
+		};
+
+		/** The chunks [next,end) pending for one thread */
+		struct TChunkQueue
+		{
+			TChunkQueue() : next(0),end(0) {}
+			CCriticalSection cs;
+			int next, end;
+		};
+
+		CCriticalSection        m_cs;
+		std::vector<TWorker*>   m_workers;
+		CSemaphore              m_sem_done;
+		bool                    m_busy;
+		volatile bool           m_quit;
+
+		// The job in progress:
+		detail::CParallelJob   *m_job;
+		int                     m_begin, m_end, m_chunk_size;
+		unsigned int            m_job_threads;
+		std::vector<TChunkQueue*> m_queues; //!< One per thread
+		CCriticalSection        m_cs_error;
+		std::string             m_error;
+
+		void workerThread(TWorker *w)
+		{
+			for (;;)
+			{
+				if (!w->sem_start.waitForSignal()) continue;
+				if (m_quit) return;
+				processChunks(w->idx);
+				m_sem_done.release();
+			}
+		}
+
+		bool popOwnChunk(unsigned int idx, int &chunk)
+		{
+			TChunkQueue &q = *m_queues[idx];
+			CCriticalSectionLocker lock(&q.cs);
+			if (q.next>=q.end) return false;
+			chunk = q.next++;
+			return true;
+		}
+
+		/** Steals half of the pending chunks of another thread: runs the first one and keeps the rest in our queue */
+		bool stealChunk(unsigned int idx, int &chunk)
+		{
+			for (unsigned int k=1;k<m_job_threads;k++)
+			{
+				TChunkQueue &victim = *m_queues[(idx+k)%m_job_threads];
+				int first,last;
+				{
+					CCriticalSectionLocker lock(&victim.cs);
+					const int pending = victim.end-victim.next;
+					if (pending<=0) continue;
+					last  = victim.end;
+					first = last - (pending+1)/2;
+					victim.end = first;
+				}
+				chunk = first;
+				TChunkQueue &q = *m_queues[idx];
+				CCriticalSectionLocker lock(&q.cs);
+				q.next = first+1;
+				q.end  = last;
+				return true;
+			}
+			return false;
+		}
+
+		void processChunks(unsigned int idx)
+		{
+			int chunk;
+			while (popOwnChunk(idx,chunk) || stealChunk(idx,chunk))
+			{
+				const int b = m_begin + chunk*m_chunk_size;
+				const int e = std::min(m_end, b+m_chunk_size);
+				try
+				{
+					m_job->run_chunk(idx,b,e);
+				}
+				catch (std::exception &ex)
+				{
+					CCriticalSectionLocker lock(&m_cs_error);
+					if (m_error.empty()) m_error = ex.what();
+				}
+				catch (...)
+				{
+					CCriticalSectionLocker lock(&m_cs_error);
+					if (m_error.empty()) m_error = "Unknown exception in parallel job";
+				}
+			}
+		}
+	};
+
+	CThreadPool & getThreadPool()
+	{
+		static CThreadPool pool;
+		return pool;
+	}
+}
+
+detail::CParallelPoolSession::CParallelPoolSession() : m_threads( getThreadPool().acquire() )
+{
+}
+
+detail::CParallelPoolSession::~CParallelPoolSession()
+{
+	if (m_threads>1)
+		getThreadPool().release();
+}
+
+void detail::CParallelPoolSession::run(CParallelJob &job, int begin, int end, int grainsize)
+{
+	if (m_threads>1)
+			getThreadPool().run(job,m_threads,begin,end,grainsize);
+	else	job.run_chunk(0,begin,end);
+}
+
+#endif // !MRPT_HAS_TBB
+
+void mrpt::system::setNumberOfParallelThreads(unsigned int nThreads)
+{
+	parallel_requested_threads = nThreads;
+}
+
+unsigned int mrpt::system::getNumberOfParallelThreads()
+{
+	return parallel_requested_threads ? parallel_requested_threads : getNumberOfProcessors();
+}
@@ -0,0 +1,89 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/base.h>
+#include <mrpt/system/parallelization.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::system;
+using namespace std;
+
+namespace
+{
+	struct TFillBody
+	{
+		std::vector<int> &out;
+		TFillBody(std::vector<int> &o) : out(o) {}
+		void operator()(const BlockedRange &r) const {
+			for (int i=r.begin();i<r.end();i++) out[i]=2*i;
+		}
+	};
+
+	struct TSumBody
+	{
+		const std::vector<int> &in;
+		int64_t sum;
+		TSumBody(const std::vector<int> &i) : in(i), sum(0) {}
+		TSumBody(TSumBody &o, Split) : in(o.in), sum(0) {}
+		void operator()(const BlockedRange &r) {
+			for (int i=r.begin();i<r.end();i++) sum+=in[i];
+		}
+		void join(const TSumBody &o) { sum+=o.sum; }
+	};
+
+	// Each row runs a nested parallel_for:
+	struct TNestedBody
+	{
+		std::vector<std::vector<int> > &out;
+		TNestedBody(std::vector<std::vector<int> > &o) : out(o) {}
+		void operator()(const BlockedRange &r) const {
+			for (int i=r.begin();i<r.end();i++)
+				parallel_for(BlockedRange(0,out[i].size()), TFillBody(out[i]) );
+		}
+	};
+
+	struct TThrowBody
+	{
+		void operator()(const BlockedRange &r) const {
+			for (int i=r.begin();i<r.end();i++)
+				if (i==777) throw std::runtime_error("error at 777");
+		}
+	};
+}
+
+TEST(parallelization, parallel_for_reduce)
+{
+	setNumberOfParallelThreads(4);
+
+	const int N = 100000;
+	std::vector<int> v(N,-1);
+	parallel_for(BlockedRange(0,N), TFillBody(v));
+	for (int i=0;i<N;i++)
+		EXPECT_EQ(2*i, v[i]);
+
+	TSumBody body(v);
+	parallel_reduce(BlockedRange(0,N,64), body);
+	EXPECT_EQ( int64_t(N)*(N-1), body.sum );
+
+	std::vector<std::vector<int> > vv(50, std::vector<int>(1000,-1));
+	parallel_for(BlockedRange(0,vv.size()), TNestedBody(vv));
+	for (size_t i=0;i<vv.size();i++)
+		for (int j=0;j<1000;j++)
+			EXPECT_EQ(2*j, vv[i][j]);
+
+	EXPECT_THROW( parallel_for(BlockedRange(0,N), TThrowBody()), std::exception );
+
+	// The pool must be usable again after an exception:
+	std::fill(v.begin(),v.end(),-1);
+	parallel_for(BlockedRange(0,N), TFillBody(v));
+	EXPECT_EQ(2*(N-1), v[N-1]);
+
+	setNumberOfParallelThreads(0);
+}
@@ -0,0 +1,120 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/base.h>  // Precompiled headers
+
+#include <mrpt/utils/CMemoryMappedFile.h>
+#include <mrpt/system/filesystem.h>
+
+#ifdef MRPT_OS_WINDOWS
+	#include <windows.h>
+#else
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+using namespace mrpt::utils;
+
+/*---------------------------------------------------------------
+					Constructors / destructor
+  ---------------------------------------------------------------*/
+CMemoryMappedFile::CMemoryMappedFile() :
+	m_data(NULL), m_size(0), m_is_open(false), m_hFile(NULL), m_hMapping(NULL)
+{
+}
+
+CMemoryMappedFile::CMemoryMappedFile(const std::string &fileName) :
+	m_data(NULL), m_size(0), m_is_open(false), m_hFile(NULL), m_hMapping(NULL)
+{
+	MRPT_START
+	if (!open(fileName))
+		THROW_EXCEPTION_CUSTOM_MSG1("Error mapping file: '%s'",fileName.c_str())
+	MRPT_END
+}
+
+CMemoryMappedFile::~CMemoryMappedFile()
+{
+	close();
+}
+
+/*---------------------------------------------------------------
+							open
+  ---------------------------------------------------------------*/
+bool CMemoryMappedFile::open(const std::string &fileName)
+{
+	close();
+
+	const uint64_t fileSize = mrpt::system::getFileSize(fileName);
+	if (fileSize==uint64_t(-1)) return false;
+	if (fileSize>static_cast<uint64_t>(std::numeric_limits<size_t>::max())) return false; // Doesn't fit into the address space
+
+	if (!fileSize)
+	{	// Nothing to map:
+		m_is_open = true;
+		return true;
+	}
+
+#ifdef MRPT_OS_WINDOWS
+	HANDLE hFile = CreateFileA(fileName.c_str(),GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL|FILE_FLAG_RANDOM_ACCESS,NULL);
+	if (hFile==INVALID_HANDLE_VALUE) return false;
+
+	HANDLE hMapping = CreateFileMappingA(hFile,NULL,PAGE_READONLY,0,0,NULL);
+	if (!hMapping)
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+
+	const void *ptr = MapViewOfFile(hMapping,FILE_MAP_READ,0,0,0);
+	if (!ptr)
+	{
+		CloseHandle(hMapping);
+		CloseHandle(hFile);
+		return false;
+	}
+	m_hFile    = hFile;
+	m_hMapping = hMapping;
+#else
+	const int fd = ::open(fileName.c_str(),O_RDONLY);
+	if (fd<0) return false;
+
+	void *ptr = ::mmap(NULL,static_cast<size_t>(fileSize),PROT_READ,MAP_SHARED,fd,0);
+	::close(fd); // The mapping keeps its own reference to the file
+	if (ptr==MAP_FAILED) return false;
+#endif
+
+	m_data    = static_cast<const unsigned char*>(ptr);
+	m_size    = fileSize;
+	m_is_open = true;
+	return true;
+}
+
+/*---------------------------------------------------------------
+							close
+  ---------------------------------------------------------------*/
+void CMemoryMappedFile::close()
+{
+	if (m_data)
+	{
+#ifdef MRPT_OS_WINDOWS
+		UnmapViewOfFile(m_data);
+		CloseHandle(static_cast<HANDLE>(m_hMapping));
+		CloseHandle(static_cast<HANDLE>(m_hFile));
+#else
+		::munmap(const_cast<unsigned char*>(m_data),static_cast<size_t>(m_size));
+#endif
+	}
+	m_data = NULL;
+	m_size = 0;
+	m_is_open = false;
+	m_hFile = m_hMapping = NULL;
+}
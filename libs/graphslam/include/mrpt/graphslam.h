@@ -12,5 +12,6 @@
 
 #include <mrpt/graphslam/types.h>
 #include <mrpt/graphslam/levmarq.h>
+#include <mrpt/graphslam/CIncrementalSpaOptimizer.h>
 
 #endif
@@ -0,0 +1,558 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef GRAPH_SLAM_CIncrementalSpaOptimizer_H
+#define GRAPH_SLAM_CIncrementalSpaOptimizer_H
+
+#include <mrpt/graphslam/types.h>
+#include <mrpt/graphslam/levmarq_impl.h> // detail::AuxErrorEval
+#include <mrpt/utils/TParameters.h>
+#include <mrpt/math/CIncrementalSparseCholesky.h>
+
+namespace mrpt
+{
+	namespace graphslam
+	{
+		/** \addtogroup mrpt_graphslam_grp
+		  *  @{ */
+
+		/** An incremental optimizer of graphs of pose constraints, for graphs which grow over time (e.g. during a SLAM session), based on the ideas of iSAM:
+		  *  - "iSAM: Incremental Smoothing and Mapping", M. Kaess, A. Ranganathan, F. Dellaert, 2008.
+		  *  - "iSAM2: Incremental Smoothing and Mapping Using the Bayes Tree", M. Kaess et al., 2012.
+		  *
+		  *  It uses the same sparse representation (SPA) than mrpt::graphslam::optimize_graph_spa_levmarq(), but keeps its state between calls to optimize(),
+		  *   so only the new parts of the problem are processed each time:
+		  *  - The Hessian blocks and gradients are kept, and only recomputed for the variables (nodes) affected by new edges or relinearized.
+		  *  - The sparse Cholesky decomposition of the Hessian is kept (see mrpt::math::CIncrementalSparseCholesky), with a fill-reducing (AMD) ordering of the variables. New nodes
+		  *    are placed at the end, so adding odometry-like edges only needs to decompose a few new rows. Loop closures refactor the rows from the oldest affected node.
+		  *    The ordering is recomputed (and the entire matrix decomposed) when the fill-in grows too much.
+		  *  - Each node keeps its linearization point, and it's only relinearized when its increment exceeds a threshold.
+		  *
+		  *  Each call to optimize() takes into account all the new edges in the graph since the last call (which may also introduce new nodes), and updates all the poses in graph.nodes.
+		  *  The initial guess for new nodes is taken from graph.nodes. The root node is fixed.
+		  *
+		  *  If edges are removed or modified, or node poses are changed by the user (apart from the initial guess of new nodes), call clear() to restart the optimization from scratch.
+		  *
+		  *  List of optional parameters by name in the "extra_params" of optimize():
+		  *		- "verbose": (default=0) If !=0, produce verbose ouput.
+		  *		- "max_iterations": (default=10) Maximum number of Gauss-Newton iterations per call (they stop when no variable needs relinearization).
+		  *		- "relinearize_threshold": (default=1e-2) Variables are relinearized when the infinity norm of their increment (in the SE(2)/SE(3) tangent space) is above this threshold.
+		  *		- "lambda": (default=1e-6) A small damping term added to the diagonal of the Hessian, to keep it definite positive. It's temporarily increased (as in Levenberg-Marquardt) if the decomposition fails or a step increases the total error.
+		  *		- "reorder_fill_factor": (default=2) The variables are reordered when the ratio of the number of non-zeros in the factor and in the Hessian grows above this factor times its value right after the last reordering.
+		  *		- "profiler": (default=0) If !=0, show times of each step at the end.
+		  *
+		  *  Example of usage:
+		  *  \code
+		  *    mrpt::graphslam::CIncrementalSpaOptimizer<CNetworkOfPoses2D> optimizer;
+		  *    for (...) // Each new keyframe:
+		  *    {
+		  *       graph.nodes[new_id] = ...;   // Initial guess
+		  *       graph.insertEdge(...);
+		  *       optimizer.optimize(graph, info);
+		  *    }
+		  *  \endcode
+		  *
+		  * \note The following graph types are supported: mrpt::graphs::CNetworkOfPoses2D, mrpt::graphs::CNetworkOfPoses3D, mrpt::graphs::CNetworkOfPoses2DInf, mrpt::graphs::CNetworkOfPoses3DInf
+		  * \tparam GRAPH_T Normally a mrpt::graphs::CNetworkOfPoses<EDGE_TYPE,MAPS_IMPLEMENTATION>.
+		  * \sa mrpt::graphslam::optimize_graph_spa_levmarq
+		  */
+		template <class GRAPH_T>
+		class CIncrementalSpaOptimizer
+		{
+		public:
+			typedef graphslam_traits<GRAPH_T> gst;
+			typedef typename gst::graph_t::constraint_t::type_value pose_t;
+
+			CIncrementalSpaOptimizer() :
+				m_root(0), m_lambda(0), m_lambda_param(-1),
+				m_reorder_pending(true), m_measure_fill_ratio(false), m_fill_ratio_at_reorder(0)
+			{
+			}
+
+			/** Forgets all the nodes and edges, so the next call to optimize() will start from scratch */
+			void clear()
+			{
+				m_factors.clear();
+				m_known_edges.clear();
+				m_node2var.clear();
+				m_var2node.clear();
+				m_lin_poses.clear();
+				m_var_factors.clear();
+				m_H_diag.clear();
+				m_grad.clear();
+				m_H_off.clear();
+				m_var2pos.clear();
+				m_pos2var.clear();
+				m_chol.clear();
+				m_pending_vars.clear();
+				m_lambda_param = -1;
+				m_reorder_pending = true;
+				m_measure_fill_ratio = false;
+			}
+
+			/** Incorporates the new edges (and nodes) of the graph and updates the estimation of all the poses in graph.nodes.
+			  * \param[in,out] graph The input edges and output poses.
+			  * \param[out] out_info Some basic output information on the process: the number of Gauss-Newton iterations, and the overall squared error of all the edges.
+			  * \param[in] extra_params Optional parameters, see CIncrementalSpaOptimizer.
+			  * \param[in] functor_feedback Optional: a pointer to a user function to be called on each iteration.
+			  */
+			void optimize(
+				GRAPH_T & graph,
+				TResultInfoSpaLevMarq  & out_info,
+				const mrpt::utils::TParametersDouble  & extra_params = mrpt::utils::TParametersDouble(),
+				typename gst::TFunctorFeedback  functor_feedback = NULL );
+
+			inline size_t getNumberOfVariables() const { return m_var2node.size(); } //!< The number of free nodes taken into account
+			inline size_t getNumberOfEdges() const { return m_factors.size(); } //!< The number of edges taken into account
+			inline const mrpt::math::CIncrementalSparseCholesky & getFactorization() const { return m_chol; } //!< The decomposition of the Hessian, for statistics
+
+		private:
+			/** One edge of the graph, with the indices of its nodes as free variables (or string::npos for the root) */
+			struct TFactor
+			{
+				typename gst::edge_const_iterator edge;
+				size_t var1, var2;
+			};
+			typedef typename mrpt::aligned_containers<size_t,typename gst::matrix_VxV_t>::map_t  map_var2matrix_VxV_t;
+
+			std::vector<TFactor>                m_factors;
+			std::set<const typename gst::graph_t::edge_t*> m_known_edges; //!< To find out the new edges
+			std::map<mrpt::utils::TNodeID,size_t> m_node2var;
+			std::vector<mrpt::utils::TNodeID>   m_var2node;
+			typename mrpt::aligned_containers<pose_t>::vector_t  m_lin_poses; //!< The linearization point of each variable
+			std::vector<std::vector<size_t> >   m_var_factors; //!< The factors of each variable
+			typename mrpt::aligned_containers<typename gst::matrix_VxV_t>::vector_t  m_H_diag; //!< The diagonal blocks of the Hessian (without lambda)
+			typename mrpt::aligned_containers<typename gst::Array_O>::vector_t  m_grad;
+			std::vector<map_var2matrix_VxV_t>   m_H_off; //!< m_H_off[i][j] is the off-diagonal block H(i,j) of the Hessian (both H(i,j) and H(j,i) are stored)
+			std::vector<size_t>                 m_var2pos, m_pos2var; //!< The ordering of the variables
+			mrpt::math::CIncrementalSparseCholesky  m_chol;
+			mrpt::vector_double                 m_delta;
+			std::set<size_t>                    m_pending_vars; //!< Variables to be relinearized in the next call, if the iterations were exhausted
+			mrpt::utils::TNodeID  m_root;
+			double  m_lambda, m_lambda_param;
+			bool    m_reorder_pending, m_measure_fill_ratio;
+			double  m_fill_ratio_at_reorder;
+
+			size_t getOrCreateVariable(const GRAPH_T &graph, const mrpt::utils::TNodeID id);
+			const pose_t & getLinearizationPoint(const GRAPH_T &graph, const size_t var) const;
+			void updateBlocks(const GRAPH_T &graph, const std::set<size_t> &vars, std::set<size_t> &out_columns);
+			void setBlockColumn(const size_t var);
+			void reorder();
+			double computeTotalSquareError(const GRAPH_T &graph) const;
+		};
+
+	/**  @} */  // end of grouping
+
+		template <class GRAPH_T>
+		size_t CIncrementalSpaOptimizer<GRAPH_T>::getOrCreateVariable(const GRAPH_T &graph, const mrpt::utils::TNodeID id)
+		{
+			if (id==graph.root) return std::string::npos;
+			std::map<mrpt::utils::TNodeID,size_t>::const_iterator it = m_node2var.find(id);
+			if (it!=m_node2var.end()) return it->second;
+
+			typename gst::graph_t::global_poses_t::const_iterator itP = graph.nodes.find(id);
+			ASSERTMSG_(itP!=graph.nodes.end(), mrpt::format("Node %u in an edge does not have a global pose in 'graph.nodes'.",static_cast<unsigned int>(id)) )
+
+			const size_t var = m_var2node.size();
+			m_node2var[id] = var;
+			m_var2node.push_back(id);
+			m_lin_poses.push_back(itP->second);
+			m_var_factors.resize(var+1);
+			m_H_diag.push_back(typename gst::matrix_VxV_t());
+			m_H_diag.back().zeros();
+			m_grad.push_back(typename gst::Array_O());
+			m_grad.back().fill(0);
+			m_H_off.resize(var+1);
+			m_var2pos.push_back(std::string::npos);
+			return var;
+		}
+
+		template <class GRAPH_T>
+		const typename CIncrementalSpaOptimizer<GRAPH_T>::pose_t & CIncrementalSpaOptimizer<GRAPH_T>::getLinearizationPoint(const GRAPH_T &graph, const size_t var) const
+		{
+			if (var!=std::string::npos) return m_lin_poses[var];
+			typename gst::graph_t::global_poses_t::const_iterator itP = graph.nodes.find(graph.root);
+			ASSERTMSG_(itP!=graph.nodes.end(), "The root node does not have a global pose in 'graph.nodes'.")
+			return itP->second;
+		}
+
+		// Recomputes, from all their factors at the current linearization points, the Hessian blocks and the gradient of the given variables.
+		//  Returns the variables whose block-column in the (upper triangular) Hessian changed.
+		template <class GRAPH_T>
+		void CIncrementalSpaOptimizer<GRAPH_T>::updateBlocks(const GRAPH_T &graph, const std::set<size_t> &vars, std::set<size_t> &out_columns)
+		{
+			typedef detail::AuxErrorEval<typename gst::edge_t,gst> aux_t;
+
+			for (std::set<size_t>::const_iterator itV=vars.begin();itV!=vars.end();++itV)
+			{
+				const size_t v = *itV;
+				m_H_diag[v].zeros();
+				m_grad[v].fill(0);
+				m_H_off[v].clear();
+				out_columns.insert(v);
+
+				const std::vector<size_t> &facts = m_var_factors[v];
+				for (size_t k=0;k<facts.size();k++)
+				{
+					const TFactor &f = m_factors[facts[k]];
+
+					// Residual and Jacobians at the linearization points: P1DP2inv = P1 * EDGE * inv(P2)
+					const pose_t &P1 = getLinearizationPoint(graph,f.var1);
+					const pose_t &P2 = getLinearizationPoint(graph,f.var2);
+					pose_t P1DP2inv(UNINITIALIZED_POSE);
+					{
+						pose_t P1D(UNINITIALIZED_POSE);
+						P1D.composeFrom(P1,f.edge->second.getPoseMean());
+						const pose_t P2inv = -P2; // Pose inverse (NOT just switching signs!)
+						P1DP2inv.composeFrom(P1D,P2inv);
+					}
+					typename gst::Array_O err;
+					aux_t::computePseudoLnError(P1DP2inv, err, f.edge);
+					typename gst::matrix_VxV_t J1(UNINITIALIZED_MATRIX), J2(UNINITIALIZED_MATRIX);
+					gst::SE_TYPE::jacobian_dP1DP2inv_depsilon(P1DP2inv, &J1,&J2);
+
+					const bool v_is_first = (f.var1==v);
+					const typename gst::matrix_VxV_t &Jv = v_is_first ? J1 : J2;
+					const typename gst::matrix_VxV_t &Jo = v_is_first ? J2 : J1;
+					const size_t other = v_is_first ? f.var2 : f.var1;
+
+					typename gst::matrix_VxV_t JtJ(UNINITIALIZED_MATRIX);
+					aux_t::multiplyJtLambdaJ(Jv,JtJ,f.edge);
+					m_H_diag[v] += JtJ;
+					aux_t::multiply_Jt_W_err(Jv,f.edge,err,m_grad[v]);
+
+					if (other!=std::string::npos)
+					{
+						aux_t::multiplyJ1tLambdaJ2(Jv,Jo,JtJ,f.edge);
+						typename map_var2matrix_VxV_t::iterator itH = m_H_off[v].find(other);
+						if (itH==m_H_off[v].end())
+							m_H_off[v][other] = JtJ;
+						else itH->second += JtJ;
+					}
+				}
+
+				// Keep the transposed blocks in the neighbors:
+				for (typename map_var2matrix_VxV_t::const_iterator itH=m_H_off[v].begin();itH!=m_H_off[v].end();++itH)
+				{
+					m_H_off[itH->first][v] = itH->second.transpose();
+					// The block H(v,other) lies in the column of the variable which comes later in the ordering:
+					if (m_var2pos[itH->first]>m_var2pos[v])
+						out_columns.insert(itH->first);
+				}
+			}
+		}
+
+		// Sends the block-column of one variable (its diagonal block plus the blocks of the neighbors which come before in the ordering) to the Cholesky decomposition.
+		template <class GRAPH_T>
+		void CIncrementalSpaOptimizer<GRAPH_T>::setBlockColumn(const size_t var)
+		{
+			const size_t D = gst::SE_TYPE::VECTOR_SIZE;
+			const size_t pos = m_var2pos[var];
+			const map_var2matrix_VxV_t &offs = m_H_off[var];
+
+			mrpt::math::CIncrementalSparseCholesky::column_t col;
+			for (size_t c=0;c<D;c++)
+			{
+				col.clear();
+				for (typename map_var2matrix_VxV_t::const_iterator itH=offs.begin();itH!=offs.end();++itH)
+				{
+					const size_t other_pos = m_var2pos[itH->first];
+					if (other_pos>pos) continue;
+					// H(other,var) = H(var,other)^t
+					for (size_t r=0;r<D;r++)
+						col.push_back( std::make_pair(other_pos*D+r, itH->second.get_unsafe(c,r)) );
+				}
+				for (size_t r=0;r<c;r++)
+					col.push_back( std::make_pair(pos*D+r, m_H_diag[var].get_unsafe(r,c)) );
+				col.push_back( std::make_pair(pos*D+c, m_H_diag[var].get_unsafe(c,c)+m_lambda) );
+
+				m_chol.setColumn(pos*D+c, col);
+			}
+		}
+
+		template <class GRAPH_T>
+		void CIncrementalSpaOptimizer<GRAPH_T>::reorder()
+		{
+			const size_t nVars = m_var2node.size();
+			std::vector<std::pair<size_t,size_t> > adjacency;
+			adjacency.reserve(m_factors.size());
+			for (size_t k=0;k<m_factors.size();k++)
+				if (m_factors[k].var1!=std::string::npos && m_factors[k].var2!=std::string::npos)
+					adjacency.push_back( std::make_pair(m_factors[k].var1,m_factors[k].var2) );
+
+			mrpt::math::CIncrementalSparseCholesky::computeFillReducingOrdering(nVars,adjacency,m_pos2var);
+			m_var2pos.resize(nVars);
+			for (size_t p=0;p<nVars;p++)
+				m_var2pos[m_pos2var[p]] = p;
+
+			m_chol.clear();
+			m_chol.resize(nVars*gst::SE_TYPE::VECTOR_SIZE);
+		}
+
+		template <class GRAPH_T>
+		double CIncrementalSpaOptimizer<GRAPH_T>::computeTotalSquareError(const GRAPH_T &graph) const
+		{
+			double total_sqr_err = 0;
+			for (size_t k=0;k<m_factors.size();k++)
+			{
+				const TFactor &f = m_factors[k];
+				const pose_t &P1 = graph.nodes.find(f.edge->first.first)->second;
+				const pose_t &P2 = graph.nodes.find(f.edge->first.second)->second;
+				pose_t P1D(UNINITIALIZED_POSE), P1DP2inv(UNINITIALIZED_POSE);
+				P1D.composeFrom(P1,f.edge->second.getPoseMean());
+				const pose_t P2inv = -P2;
+				P1DP2inv.composeFrom(P1D,P2inv);
+				typename gst::Array_O err;
+				detail::AuxErrorEval<typename gst::edge_t,gst>::computePseudoLnError(P1DP2inv, err, f.edge);
+				total_sqr_err += err.squaredNorm();
+			}
+			return total_sqr_err;
+		}
+
+		template <class GRAPH_T>
+		void CIncrementalSpaOptimizer<GRAPH_T>::optimize(
+			GRAPH_T & graph,
+			TResultInfoSpaLevMarq  & out_info,
+			const mrpt::utils::TParametersDouble  & extra_params,
+			typename gst::TFunctorFeedback  functor_feedback )
+		{
+			using namespace std;
+			using mrpt::utils::TNodeID;
+
+			MRPT_START
+
+			const size_t D = gst::SE_TYPE::VECTOR_SIZE;
+
+			// Read extra params:
+			const bool   verbose             = 0!=extra_params.getWithDefaultVal("verbose",0);
+			const size_t max_iters           = extra_params.getWithDefaultVal("max_iterations",10);
+			const double relin_threshold     = extra_params.getWithDefaultVal("relinearize_threshold",1e-2);
+			const double lambda_param        = extra_params.getWithDefaultVal("lambda",1e-6);
+			const double reorder_fill_factor = extra_params.getWithDefaultVal("reorder_fill_factor",2);
+			const bool   enable_profiler     = 0!=extra_params.getWithDefaultVal("profiler",0);
+
+			mrpt::utils::CTimeLogger  profiler(enable_profiler);
+			profiler.enter("CIncrementalSpaOptimizer.optimize (entire)");
+
+			// Removed edges or a new root: start from scratch
+			if (graph.root!=m_root || graph.edges.size()<m_known_edges.size())
+			{
+				if (verbose && !m_factors.empty()) cout << "["<<__CURRENT_FUNCTION_NAME__<<"] The graph changed: restarting from scratch.\n";
+				clear();
+				m_root = graph.root;
+			}
+
+			// Incorporate the new edges (and the new nodes they refer to).
+			//  Their variables, those affected by the new edges, need to recompute their Hessian blocks and gradients.
+			profiler.enter("CIncrementalSpaOptimizer.new_edges");
+			const size_t nOldVars = m_var2node.size();
+			std::set<size_t> affected;
+			affected.swap(m_pending_vars);
+			for (typename gst::edge_const_iterator it=graph.edges.begin();it!=graph.edges.end();++it)
+			{
+				if (!m_known_edges.insert(&it->second).second)
+					continue; // Not new
+				ASSERTMSG_(it->first.first!=it->first.second, "Edges from one node to itself are not supported")
+
+				TFactor f;
+				f.edge = it;
+				f.var1 = getOrCreateVariable(graph,it->first.first);
+				f.var2 = getOrCreateVariable(graph,it->first.second);
+				const size_t idx = m_factors.size();
+				m_factors.push_back(f);
+				if (f.var1!=string::npos) { m_var_factors[f.var1].push_back(idx); affected.insert(f.var1); }
+				if (f.var2!=string::npos) { m_var_factors[f.var2].push_back(idx); affected.insert(f.var2); }
+			}
+			const size_t nVars = m_var2node.size();
+			profiler.leave("CIncrementalSpaOptimizer.new_edges");
+
+			if (verbose)
+				cout << "["<<__CURRENT_FUNCTION_NAME__<<"] " << nVars-nOldVars << " new nodes, " << nVars << " nodes and " << m_factors.size() << " edges in total.\n";
+
+			out_info.num_iters = 0;
+			if (!nVars)
+			{
+				out_info.final_total_sq_error = 0;
+				profiler.leave("CIncrementalSpaOptimizer.optimize (entire)");
+				return;
+			}
+
+			// Ordering of the variables: the new ones go to the end, unless a full reordering is due.
+			bool rebuild_all = false;
+			if (lambda_param!=m_lambda_param)
+			{
+				m_lambda = m_lambda_param = lambda_param;
+				rebuild_all = true;
+			}
+			if (m_reorder_pending)
+			{
+				profiler.enter("CIncrementalSpaOptimizer.reorder");
+				reorder();
+				profiler.leave("CIncrementalSpaOptimizer.reorder");
+				m_reorder_pending = false;
+				m_measure_fill_ratio = true;
+				rebuild_all = true;
+			}
+			else
+			{
+				for (size_t v=nOldVars;v<nVars;v++)
+				{
+					m_var2pos[v] = m_pos2var.size();
+					m_pos2var.push_back(v);
+				}
+				m_chol.resize(nVars*D);
+			}
+
+			double total_sqr_err = computeTotalSquareError(graph);
+			typename mrpt::aligned_containers<pose_t>::vector_t  old_poses;
+			std::vector<double> delta_max;
+
+			size_t iter;
+			for (iter=0;iter<max_iters && (!affected.empty() || rebuild_all);iter++)
+			{
+				// Update the Hessian and the gradient:
+				profiler.enter("CIncrementalSpaOptimizer.update_H");
+				std::set<size_t> columns;
+				updateBlocks(graph,affected,columns);
+				if (rebuild_all)
+				{
+					for (size_t v=0;v<nVars;v++) setBlockColumn(v);
+					rebuild_all = false;
+				}
+				else
+				{
+					for (std::set<size_t>::const_iterator it=columns.begin();it!=columns.end();++it)
+						setBlockColumn(*it);
+				}
+				profiler.leave("CIncrementalSpaOptimizer.update_H");
+
+				// (Partial) Cholesky decomposition:
+				profiler.enter("CIncrementalSpaOptimizer.chol");
+				for (;;)
+				{
+					try
+					{
+						m_chol.factorize();
+						break;
+					}
+					catch (mrpt::math::CExceptionNotDefPos &)
+					{
+						m_lambda *= 10;
+						if (verbose) cout << "["<<__CURRENT_FUNCTION_NAME__<<"] Got non-definite positive matrix, retrying with lambda=" << m_lambda << endl;
+						ASSERTMSG_(m_lambda<1e9, "Could not decompose the Hessian: is the graph connected?")
+						for (size_t v=0;v<nVars;v++) setBlockColumn(v);
+					}
+				}
+				profiler.leave("CIncrementalSpaOptimizer.chol");
+
+				if (verbose)
+					cout << "["<<__CURRENT_FUNCTION_NAME__<<"] Iter: " << iter << ", refactored " << m_chol.getLastRefactoredColumns() << " of " << m_chol.getSize() << " rows, nnz(L)=" << m_chol.getFactorNonZeros() << endl;
+
+				// Measure the fill-in, and schedule a reordering for the next call if it grew too much:
+				{
+					const double fill_ratio = m_chol.getFactorNonZeros() / static_cast<double>(std::max<size_t>(1,m_chol.getMatrixNonZeros()));
+					if (m_measure_fill_ratio)
+					{
+						m_fill_ratio_at_reorder = fill_ratio;
+						m_measure_fill_ratio = false;
+					}
+					else if (fill_ratio > reorder_fill_factor*m_fill_ratio_at_reorder)
+						m_reorder_pending = true;
+				}
+
+				// Solve H * delta = grad
+				profiler.enter("CIncrementalSpaOptimizer.backsub");
+				mrpt::vector_double grad(nVars*D);
+				for (size_t v=0;v<nVars;v++)
+					for (size_t k=0;k<D;k++)
+						grad[m_var2pos[v]*D+k] = m_grad[v][k];
+				m_chol.solve(grad,m_delta);
+				profiler.leave("CIncrementalSpaOptimizer.backsub");
+
+				// New estimates: x_i = exp(-delta_i) (+) lin_i
+				profiler.enter("CIncrementalSpaOptimizer.update_x");
+				old_poses.resize(nVars);
+				delta_max.assign(nVars,0.0);
+				for (size_t v=0;v<nVars;v++)
+				{
+					typename gst::Array_O exp_delta;
+					for (size_t k=0;k<D;k++)
+					{
+						exp_delta[k] = -m_delta[m_var2pos[v]*D+k];
+						mrpt::utils::keep_max(delta_max[v], std::abs(exp_delta[k]));
+					}
+					pose_t exp_delta_pose(UNINITIALIZED_POSE);
+					gst::SE_TYPE::exp(exp_delta,exp_delta_pose);
+
+					pose_t &P = graph.nodes[m_var2node[v]];
+					old_poses[v] = P;
+					P.composeFrom(exp_delta_pose, m_lin_poses[v]);
+				}
+				profiler.leave("CIncrementalSpaOptimizer.update_x");
+
+				// Gauss-Newton may diverge after large changes (e.g. a long loop closure): if so, go back and increase the damping as in Lev-Marq.
+				profiler.enter("CIncrementalSpaOptimizer.error");
+				const double new_total_sqr_err = computeTotalSquareError(graph);
+				profiler.leave("CIncrementalSpaOptimizer.error");
+				if (new_total_sqr_err > total_sqr_err + 1e-9*(1+total_sqr_err) && m_lambda<1e9)
+				{
+					for (size_t v=0;v<nVars;v++)
+						graph.nodes[m_var2node[v]] = old_poses[v];
+					m_lambda *= 10;
+					if (verbose) cout << "["<<__CURRENT_FUNCTION_NAME__<<"] Iter: " << iter << ", got larger error=" << new_total_sqr_err << ", retrying with lambda=" << m_lambda << endl;
+					affected.clear(); // H and the gradient are up to date, except for lambda
+					rebuild_all = true;
+					continue;
+				}
+				total_sqr_err = new_total_sqr_err;
+				if (m_lambda>m_lambda_param)
+				{
+					// Recover the normal damping (the next decomposition will be a full one)
+					m_lambda = std::max(m_lambda_param, 0.1*m_lambda);
+					for (size_t v=0;v<nVars;v++) setBlockColumn(v);
+				}
+
+				// Relinearize the variables with large increments (which affects their neighbors as well):
+				affected.clear();
+				for (size_t v=0;v<nVars;v++)
+				{
+					if (delta_max[v]>relin_threshold)
+					{
+						m_lin_poses[v] = graph.nodes[m_var2node[v]];
+						const std::vector<size_t> &facts = m_var_factors[v];
+						for (size_t k=0;k<facts.size();k++)
+						{
+							if (m_factors[facts[k]].var1!=string::npos) affected.insert(m_factors[facts[k]].var1);
+							if (m_factors[facts[k]].var2!=string::npos) affected.insert(m_factors[facts[k]].var2);
+						}
+					}
+				}
+
+				if (verbose)
+					cout << "["<<__CURRENT_FUNCTION_NAME__<<"] Iter: " << iter << ", total sqr. err: " << total_sqr_err << ", " << affected.size() << " nodes to relinearize.\n";
+
+				if (functor_feedback)
+					(*functor_feedback)(graph,iter,max_iters,total_sqr_err);
+			}
+
+			// If the iterations were exhausted, the next call must update these variables:
+			m_pending_vars.swap(affected);
+
+			// Fill out basic output data:
+			out_info.num_iters = iter;
+			out_info.final_total_sq_error = total_sqr_err;
+
+			profiler.leave("CIncrementalSpaOptimizer.optimize (entire)");
+
+			MRPT_END
+		}
+
+	} // End of namespace
+} // End of namespace
+
+#endif
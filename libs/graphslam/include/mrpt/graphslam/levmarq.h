@@ -42,11 +42,13 @@ namespace mrpt
 		  *		- "tau": (default=1e-3) Initial tau value for the lev-marq algorithm.
 		  *		- "e1": (default=1e-6) Lev-marq algorithm iteration stopping criterion #1: |gradient| < e1
 		  *		- "e2": (default=1e-6) Lev-marq algorithm iteration stopping criterion #2: |delta_incr| < e2*(x_norm+e2)
+		  *		- "parallel_min_edges": (default=10000) Graphs with at least this number of edges evaluate the errors and Jacobians of the edges, and build the gradient and the Hessian,
+		  *		  in parallel (see mrpt::system::parallel_for). The results are the same than in the serial version, regardless of the number of threads. Set to 0 to always run serially.
 		  *
 		  * \note The following graph types are supported: mrpt::graphs::CNetworkOfPoses2D, mrpt::graphs::CNetworkOfPoses3D, mrpt::graphs::CNetworkOfPoses2DInf, mrpt::graphs::CNetworkOfPoses3DInf
 		  *
 		  * \tparam GRAPH_T Normally a mrpt::graphs::CNetworkOfPoses<EDGE_TYPE,MAPS_IMPLEMENTATION>. Users won't have to write this template argument by hand, since the compiler will auto-fit it depending on the type of the graph object.
-		  * \sa The example "graph_slam_demo"
+		  * \sa The example "graph_slam_demo", and mrpt::graphslam::CIncrementalSpaOptimizer for graphs which grow incrementally (e.g. during SLAM)
 		  * \ingroup mrpt_graphslam_grp
 		  * \note Implementation can be found in file \a levmarq_impl.h
 		  */
@@ -71,8 +73,6 @@ namespace mrpt
 			// Typedefs to make life easier:
 			typedef graphslam_traits<GRAPH_T> gst;
 
-			typename gst::Array_O array_O_zeros; array_O_zeros.fill(0); // Auxiliary var with all zeros
-
 			// The size of things here (because size matters...)
 			static const unsigned int DIMS_POSE = gst::SE_TYPE::VECTOR_SIZE;
 
@@ -88,6 +88,8 @@ namespace mrpt
 
 			const double SCALE_HESSIAN = extra_params.getWithDefaultVal("scale_hessian",1);
 
+			const size_t parallel_min_edges = extra_params.getWithDefaultVal("parallel_min_edges",10000);
+
 
 			mrpt::utils::CTimeLogger  profiler(enable_profiler);
 			profiler.enter("optimize_graph_spa_levmarq (entire)");
@@ -175,8 +177,8 @@ namespace mrpt
 			// The list of Jacobians: for each constraint i->j,
 			//  we need the pair of Jacobians: { dh(xi,xj)_dxi, dh(xi,xj)_dxj },
 			//  which are "first" and "second" in each pair.
-			// Index of the map are the node IDs {i,j} for each contraint.
-			typename gst::map_pairIDs_pairJacobs_t   lstJacobians;
+			// i \in [0,nObservations-1], in same order than lstObservationData
+			typename gst::vector_pairJacobs_t   lstJacobians;
 			// The vector of errors: err_k = SE(2/3)::pseudo_Ln( P_i * EDGE_ij * inv(P_j) )
 			typename mrpt::aligned_containers<typename gst::Array_O>::vector_t  errs; // Separated vectors for each edge. i \in [0,nObservations-1], in same order than lstObservationData
 
@@ -186,29 +188,43 @@ namespace mrpt
 			profiler.enter("optimize_graph_spa_levmarq.Jacobians&err");// ------------------------------\  .
 			double total_sqr_err = computeJacobiansAndErrors<GRAPH_T>(
 				graph, lstObservationData,
-				lstJacobians, errs);
+				lstJacobians, errs, parallel_min_edges);
 			profiler.leave("optimize_graph_spa_levmarq.Jacobians&err");  // ------------------------------/
 
 
 			// Only once (since this will be static along iterations), build a quick look-up table with the
-			//  indices of the free nodes associated to the (first_id,second_id) of each Jacobian pair:
+			//  indices of the free nodes associated to the (first_id,second_id) of each Jacobian pair,
+			//  and the reverse one, with the indices of the observations of each free node:
 			// -----------------------------------------------------------------------------------------------
+			profiler.enter("optimize_graph_spa_levmarq.list_obs_idxs"); // ---------------\  .
 			vector<pair<size_t,size_t> >  observationIndex_to_relatedFreeNodeIndex; // "relatedFreeNodeIndex" means into [0,nFreeNodes-1], or "-1" if that node is fixed, as ordered in "nodes_to_optimize"
-			observationIndex_to_relatedFreeNodeIndex.reserve(nObservations);
-			ASSERTDEB_(lstJacobians.size()==nObservations)
-			for (typename gst::map_pairIDs_pairJacobs_t::const_iterator itJ=lstJacobians.begin();itJ!=lstJacobians.end();++itJ)
+			vector<vector<size_t> >       freeNodeIndex_to_observationIndices(nFreeNodes); // In increasing order
 			{
-				const TNodeID id1 = itJ->first.first;
-				const TNodeID id2 = itJ->first.second;
-				observationIndex_to_relatedFreeNodeIndex.push_back(
-					std::make_pair(
-						mrpt::utils::find_in_vector(id1,*nodes_to_optimize),
-						mrpt::utils::find_in_vector(id2,*nodes_to_optimize) ));
+				std::map<TNodeID,size_t>  ID2freeNodeIndex;
+				for (set<TNodeID>::const_iterator it=nodes_to_optimize->begin();it!=nodes_to_optimize->end();++it)
+					ID2freeNodeIndex.insert(ID2freeNodeIndex.end(), std::make_pair(*it,ID2freeNodeIndex.size()) );
+
+				observationIndex_to_relatedFreeNodeIndex.reserve(nObservations);
+				ASSERTDEB_(lstJacobians.size()==nObservations)
+				for (size_t idx_obs=0;idx_obs<nObservations;idx_obs++)
+				{
+					const TPairNodeIDs &ids = lstObservationData[idx_obs].edge->first;
+					std::map<TNodeID,size_t>::const_iterator it1 = ID2freeNodeIndex.find(ids.first);
+					std::map<TNodeID,size_t>::const_iterator it2 = ID2freeNodeIndex.find(ids.second);
+					const size_t idx1 = it1!=ID2freeNodeIndex.end() ? it1->second : string::npos;
+					const size_t idx2 = it2!=ID2freeNodeIndex.end() ? it2->second : string::npos;
+					observationIndex_to_relatedFreeNodeIndex.push_back(std::make_pair(idx1,idx2));
+
+					if (idx1!=string::npos) freeNodeIndex_to_observationIndices[idx1].push_back(idx_obs);
+					if (idx2!=string::npos && idx2!=idx1) freeNodeIndex_to_observationIndices[idx2].push_back(idx_obs);
+				}
 			}
+			profiler.leave("optimize_graph_spa_levmarq.list_obs_idxs"); // ---------------/
 
 			// other important vars for the main loop:
 			vector_double grad(nFreeNodes*DIMS_POSE);
-			typedef typename mrpt::aligned_containers<TNodeID,typename gst::matrix_VxV_t>::map_t  map_ID2matrix_VxV_t;
+			typename mrpt::aligned_containers<typename gst::Array_O>::vector_t  grad_parts(nFreeNodes);
+			typedef typename detail::THessianAndGradientBuilder<GRAPH_T>::map_ID2matrix_VxV_t  map_ID2matrix_VxV_t;
 			vector<map_ID2matrix_VxV_t>  H_map(nFreeNodes);
 
 			double	lambda = initial_lambda; // Will be actually set on first iteration.
@@ -236,52 +252,34 @@ namespace mrpt
 					//  "grad" can be seen as composed of N independent arrays, each one being:
 					//   grad_i = \sum_k J^t_{k->i} errs_k
 					// that is: g_i is the "dot-product" of the i'th (transposed) block-column of J and the vector of errors "errs"
-					profiler.enter("optimize_graph_spa_levmarq.grad"); // ------------------------------\  .
-					typename mrpt::aligned_containers<typename gst::Array_O>::vector_t  grad_parts(nFreeNodes, array_O_zeros);
-
-					// "lstJacobians" is sorted in the same order than "lstObservationData":
-					ASSERT_EQUAL_(lstJacobians.size(),lstObservationData.size())
-
+					//
+					// ======================================================================
+					// Build sparse representation of the upper triangular part of
+					//  the Hessian matrix H = J^t * J
+					//
+					// Sparse memory structure is a vector of maps, such as:
+					//  - H_map[i]: corresponds to the i'th column of H.
+					//              Here "i" corresponds to [0,N-1] indices of appearance in the map "*nodes_to_optimize".
+					//  - H_map[i][j] is the entry for the j'th row, with "j" also in the range [0,N-1] as ordered in "*nodes_to_optimize".
+					// ======================================================================
+					// Both are built at once, in parallel for different free nodes if the graph is large enough:
+					profiler.enter("optimize_graph_spa_levmarq.grad&sp_H:build map"); // ------------------------------\  .
 					{
-						size_t idx_obs;
-						typename gst::map_pairIDs_pairJacobs_t::const_iterator itJ;
-
-						for (idx_obs=0, itJ=lstJacobians.begin();
-							itJ!=lstJacobians.end();
-							++itJ,++idx_obs)
-						{
-							ASSERTDEB_(itJ->first==lstObservationData[idx_obs].edge->first) // make sure they're in the expected order!
-
-							//  grad[k] += J^t_{i->k} * Inf.Matrix * errs_i
-							//    k: [0,nFreeNodes-1]     <-- IDs.first & IDs.second
-							//    i: [0,nObservations-1]  <--- idx_obs
-
-							// Get the corresponding indices in the vector of "free variables" being optimized:
-							const size_t idx1 = observationIndex_to_relatedFreeNodeIndex[idx_obs].first;
-							const size_t idx2 = observationIndex_to_relatedFreeNodeIndex[idx_obs].second;
-
-							if (idx1!=string::npos)
-								detail::AuxErrorEval<typename gst::edge_t,gst>::multiply_Jt_W_err(
-									itJ->second.first /* J */,
-									lstObservationData[idx_obs].edge /* W */,
-									errs[idx_obs] /* err */,
-									grad_parts[idx1] /* out */
-									);
-
-							if (idx2!=string::npos)
-								detail::AuxErrorEval<typename gst::edge_t,gst>::multiply_Jt_W_err(
-									itJ->second.second /* J */,
-									lstObservationData[idx_obs].edge /* W */,
-									errs[idx_obs] /* err */,
-									grad_parts[idx2] /* out */
-									);
-						}
+						ASSERT_EQUAL_(lstJacobians.size(),lstObservationData.size())
+
+						const detail::THessianAndGradientBuilder<GRAPH_T> builder(
+							lstObservationData, lstJacobians, errs,
+							observationIndex_to_relatedFreeNodeIndex, freeNodeIndex_to_observationIndices,
+							grad_parts, H_map);
+						if (parallel_min_edges && nObservations>=parallel_min_edges)
+								mrpt::system::parallel_for( mrpt::system::BlockedRange(0,static_cast<int>(nFreeNodes),64), builder );
+						else	builder( mrpt::system::BlockedRange(0,static_cast<int>(nFreeNodes)) );
 					}
 
 					// build the gradient as a single vector:
 					::memcpy(&grad[0],&grad_parts[0], nFreeNodes*DIMS_POSE*sizeof(grad[0]));  // Ohh yeahh!
 					grad /= SCALE_HESSIAN;
-					profiler.leave("optimize_graph_spa_levmarq.grad"); // ------------------------------/
+					profiler.leave("optimize_graph_spa_levmarq.grad&sp_H:build map"); // ------------------------------/
 
 					// End condition #1
 					const double grad_norm_inf = math::norm_inf(grad); // inf-norm (abs. maximum value) of the gradient
@@ -292,66 +290,6 @@ namespace mrpt
 						break;
 					}
 
-
-					profiler.enter("optimize_graph_spa_levmarq.sp_H:build map"); // ------------------------------\  .
-					// ======================================================================
-					// Build sparse representation of the upper triangular part of
-					//  the Hessian matrix H = J^t * J
-					//
-					// Sparse memory structure is a vector of maps, such as:
-					//  - H_map[i]: corresponds to the i'th column of H.
-					//              Here "i" corresponds to [0,N-1] indices of appearance in the map "*nodes_to_optimize".
-					//  - H_map[i][j] is the entry for the j'th row, with "j" also in the range [0,N-1] as ordered in "*nodes_to_optimize".
-					// ======================================================================
-					{
-						size_t idxObs;
-						typename gst::map_pairIDs_pairJacobs_t::const_iterator itJacobPair;
-
-						for (idxObs=0, itJacobPair=lstJacobians.begin();
-							 idxObs<nObservations;
-							 ++itJacobPair,++idxObs)
-						{
-							// We sort IDs such as "i" < "j" and we can build just the upper triangular part of the Hessian.
-							const bool edge_straight = itJacobPair->first.first < itJacobPair->first.second;
-
-							// Indices in the "H_map" vector:
-							const size_t idx_i = edge_straight ? observationIndex_to_relatedFreeNodeIndex[idxObs].first  : observationIndex_to_relatedFreeNodeIndex[idxObs].second;
-							const size_t idx_j = edge_straight ? observationIndex_to_relatedFreeNodeIndex[idxObs].second : observationIndex_to_relatedFreeNodeIndex[idxObs].first;
-
-							const bool is_i_free_node = idx_i!=string::npos;
-							const bool is_j_free_node = idx_j!=string::npos;
-
-							// Take references to both Jacobians (wrt pose "i" and pose "j"), taking into account the possible
-							// switch in their order:
-
-							const typename gst::matrix_VxV_t &J1 = edge_straight ? itJacobPair->second.first : itJacobPair->second.second;
-							const typename gst::matrix_VxV_t &J2 = edge_straight ? itJacobPair->second.second : itJacobPair->second.first;
-
-							// Is "i" a free (to be optimized) node? -> Ji^t * Inf *  Ji
-							if (is_i_free_node)
-							{
-								typename gst::matrix_VxV_t JtJ(UNINITIALIZED_MATRIX);
-								detail::AuxErrorEval<typename gst::edge_t,gst>::multiplyJtLambdaJ(J1,JtJ,lstObservationData[idxObs].edge);
-								H_map[idx_i][idx_i] += JtJ;
-							}
-							// Is "j" a free (to be optimized) node? -> Jj^t * Inf *  Jj
-							if (is_j_free_node)
-							{
-								typename gst::matrix_VxV_t JtJ(UNINITIALIZED_MATRIX);
-								detail::AuxErrorEval<typename gst::edge_t,gst>::multiplyJtLambdaJ(J2,JtJ,lstObservationData[idxObs].edge);
-								H_map[idx_j][idx_j] += JtJ;
-							}
-							// Are both "i" and "j" free nodes? -> Ji^t * Inf *  Jj
-							if (is_i_free_node && is_j_free_node)
-							{
-								typename gst::matrix_VxV_t JtJ(UNINITIALIZED_MATRIX);
-								detail::AuxErrorEval<typename gst::edge_t,gst>::multiplyJ1tLambdaJ2(J1,J2,JtJ,lstObservationData[idxObs].edge);
-								H_map[idx_j][idx_i] += JtJ;
-							}
-						}
-					}
-					profiler.leave("optimize_graph_spa_levmarq.sp_H:build map");  // ------------------------------/
-
 					// Just in the first iteration, we need to calculate an estimate for the first value of "lamdba":
 					if (lambda<=0 && iter==0)
 					{
@@ -517,13 +455,13 @@ namespace mrpt
 					// =============================================================
 					// Compute Jacobians & errors with the new "graph.nodes" info:
 					// =============================================================
-					typename gst::map_pairIDs_pairJacobs_t  new_lstJacobians;
+					typename gst::vector_pairJacobs_t  new_lstJacobians;
 					typename mrpt::aligned_containers<typename gst::Array_O>::vector_t   new_errs;
 
 					profiler.enter("optimize_graph_spa_levmarq.Jacobians&err");// ------------------------------\  .
 					double new_total_sqr_err = computeJacobiansAndErrors<GRAPH_T>(
 						graph, lstObservationData,
-						new_lstJacobians, new_errs);
+						new_lstJacobians, new_errs, parallel_min_edges);
 					profiler.leave("optimize_graph_spa_levmarq.Jacobians&err");// ------------------------------/
 
 					// Now, to decide whether to accept the change:
@@ -12,6 +12,7 @@
 #include <mrpt/graphs/CNetworkOfPoses.h>
 #include <mrpt/utils/CTimeLogger.h>
 #include <mrpt/math/CSparseMatrix.h>
+#include <mrpt/system/parallelization.h>
 
 #include <memory>
 
@@ -105,57 +106,168 @@ namespace mrpt
 				}
 			};
 
-		} // end NS detail
+			/** Body for mrpt::system::parallel_for(): computes the errors and the pair of Jacobians of a range of constraints. Used in computeJacobiansAndErrors() */
+			template <class GRAPH_T>
+			struct TJacobiansAndErrorsEvaluator
+			{
+				typedef graphslam_traits<GRAPH_T> gst;
+				typedef typename gst::graph_t::constraint_t::type_value pose_t;
 
-		// Compute, at once, jacobians and the error vectors for each constraint in "lstObservationData", returns the overall squared error.
-		template <class GRAPH_T>
-		double computeJacobiansAndErrors(
-			const GRAPH_T &graph,
-			const vector<typename graphslam_traits<GRAPH_T>::observation_info_t>  &lstObservationData,
-			typename graphslam_traits<GRAPH_T>::map_pairIDs_pairJacobs_t   &lstJacobians,
-			typename mrpt::aligned_containers<typename graphslam_traits<GRAPH_T>::Array_O>::vector_t &errs
-			)
-		{
-			typedef graphslam_traits<GRAPH_T> gst;
+				const vector<typename gst::observation_info_t>  &lstObservationData;
+				typename gst::vector_pairJacobs_t  &lstJacobians;
+				typename mrpt::aligned_containers<typename gst::Array_O>::vector_t &errs;
 
-			lstJacobians.clear();
-			errs.clear();
+				TJacobiansAndErrorsEvaluator(
+					const vector<typename gst::observation_info_t>  &lstObservationData_,
+					typename gst::vector_pairJacobs_t  &lstJacobians_,
+					typename mrpt::aligned_containers<typename gst::Array_O>::vector_t &errs_) :
+					lstObservationData(lstObservationData_), lstJacobians(lstJacobians_), errs(errs_)
+				{ }
 
-			const size_t nObservations = lstObservationData.size();
+				void operator()(const mrpt::system::BlockedRange &r) const
+				{
+					for (int i=r.begin();i<r.end();i++)
+					{
+						const typename gst::observation_info_t & obs = lstObservationData[i];
+
+						// Work on copies of the poses, since those in the graph are shared among threads and poses
+						//  update their internal caches (e.g. cos/sin, yaw/pitch/roll) even through const methods:
+						const pose_t P1 = *obs.P1, EDGE_POSE = *obs.edge_mean, P2 = *obs.P2;
+
+						// Compute the residual pose error of these pair of nodes + its constraint,
+						//  that is: P1DP2inv = P1 * EDGE * inv(P2)
+						pose_t P1DP2inv(UNINITIALIZED_POSE);
+						{
+							pose_t P1D(UNINITIALIZED_POSE);
+							P1D.composeFrom(P1,EDGE_POSE);
+							const pose_t P2inv = -P2; // Pose inverse (NOT just switching signs!)
+							P1DP2inv.composeFrom(P1D,P2inv);
+						}
+
+						AuxErrorEval<typename gst::edge_t,gst>::computePseudoLnError(P1DP2inv, errs[i], obs.edge->second);
+
+						// Compute the jacobians:
+						gst::SE_TYPE::jacobian_dP1DP2inv_depsilon(P1DP2inv, &lstJacobians[i].first,&lstJacobians[i].second);
+					}
+				}
+			};
 
-			for (size_t i=0;i<nObservations;i++)
+			/** Body for mrpt::system::parallel_for(): builds the parts of the gradient and the columns of the (upper triangular part of the) Hessian
+			  *  of a range of free nodes, from the constraints in which each of them takes part.
+			  *  Each free node is only written by the thread which owns it, so no locks nor reductions are needed and the results do not depend on the number of threads.
+			  *  Used in optimize_graph_spa_levmarq() */
+			template <class GRAPH_T>
+			struct THessianAndGradientBuilder
 			{
-				const typename gst::observation_info_t & obs = lstObservationData[i];
-				typename gst::edge_const_iterator it = obs.edge;
-				const typename gst::graph_t::constraint_t::type_value* EDGE_POSE = obs.edge_mean;
-				typename gst::graph_t::constraint_t::type_value* P1 = obs.P1;
-				typename gst::graph_t::constraint_t::type_value* P2 = obs.P2;
-
-				const TPairNodeIDs                   &ids  = it->first;
-				const typename gst::graph_t::edge_t  &edge = it->second;
-
-				// Compute the residual pose error of these pair of nodes + its constraint,
-				//  that is: P1DP2inv = P1 * EDGE * inv(P2)
-				typename gst::graph_t::constraint_t::type_value P1DP2inv(UNINITIALIZED_POSE);
+				typedef graphslam_traits<GRAPH_T> gst;
+				typedef typename mrpt::aligned_containers<TNodeID,typename gst::matrix_VxV_t>::map_t  map_ID2matrix_VxV_t;
+
+				const vector<typename gst::observation_info_t>  &lstObservationData;
+				const typename gst::vector_pairJacobs_t  &lstJacobians;
+				const typename mrpt::aligned_containers<typename gst::Array_O>::vector_t &errs;
+				const vector<pair<size_t,size_t> >  &observationIndex_to_relatedFreeNodeIndex;
+				const vector<vector<size_t> >  &freeNodeIndex_to_observationIndices; //!< For each free node, the indices of its constraints in increasing order
+				typename mrpt::aligned_containers<typename gst::Array_O>::vector_t  &grad_parts;
+				vector<map_ID2matrix_VxV_t>  &H_map;
+
+				THessianAndGradientBuilder(
+					const vector<typename gst::observation_info_t>  &lstObservationData_,
+					const typename gst::vector_pairJacobs_t  &lstJacobians_,
+					const typename mrpt::aligned_containers<typename gst::Array_O>::vector_t &errs_,
+					const vector<pair<size_t,size_t> >  &observationIndex_to_relatedFreeNodeIndex_,
+					const vector<vector<size_t> >  &freeNodeIndex_to_observationIndices_,
+					typename mrpt::aligned_containers<typename gst::Array_O>::vector_t  &grad_parts_,
+					vector<map_ID2matrix_VxV_t>  &H_map_) :
+					lstObservationData(lstObservationData_), lstJacobians(lstJacobians_), errs(errs_),
+					observationIndex_to_relatedFreeNodeIndex(observationIndex_to_relatedFreeNodeIndex_),
+					freeNodeIndex_to_observationIndices(freeNodeIndex_to_observationIndices_),
+					grad_parts(grad_parts_), H_map(H_map_)
+				{ }
+
+				void operator()(const mrpt::system::BlockedRange &r) const
 				{
-					typename gst::graph_t::constraint_t::type_value P1D(UNINITIALIZED_POSE);
-					P1D.composeFrom(*P1,*EDGE_POSE);
-					const typename gst::graph_t::constraint_t::type_value P2inv = -(*P2); // Pose inverse (NOT just switching signs!)
-					P1DP2inv.composeFrom(P1D,P2inv);
+					for (int n=r.begin();n<r.end();n++)
+					{
+						typename gst::Array_O &grad_n = grad_parts[n];
+						grad_n.fill(0);
+						map_ID2matrix_VxV_t &H_col = H_map[n];
+
+						const vector<size_t> &obs_idxs = freeNodeIndex_to_observationIndices[n];
+						for (size_t k=0;k<obs_idxs.size();k++)
+						{
+							const size_t idx_obs = obs_idxs[k];
+							const typename gst::edge_const_iterator &edge = lstObservationData[idx_obs].edge;
+							const typename gst::TPairJacobs &Js = lstJacobians[idx_obs];
+
+							// Get the corresponding indices in the vector of "free variables" being optimized:
+							const size_t idx1 = observationIndex_to_relatedFreeNodeIndex[idx_obs].first;
+							const size_t idx2 = observationIndex_to_relatedFreeNodeIndex[idx_obs].second;
+
+							//  grad[n] += J^t_{i->n} * Inf.Matrix * errs_i
+							if (idx1==static_cast<size_t>(n))
+								AuxErrorEval<typename gst::edge_t,gst>::multiply_Jt_W_err(Js.first /* J */, edge /* W */, errs[idx_obs] /* err */, grad_n /* out */);
+							if (idx2==static_cast<size_t>(n))
+								AuxErrorEval<typename gst::edge_t,gst>::multiply_Jt_W_err(Js.second /* J */, edge /* W */, errs[idx_obs] /* err */, grad_n /* out */);
+
+							// We sort IDs such as "i" < "j" and we can build just the upper triangular part of the Hessian.
+							const bool edge_straight = edge->first.first < edge->first.second;
+
+							// Indices in the "H_map" vector:
+							const size_t idx_i = edge_straight ? idx1 : idx2;
+							const size_t idx_j = edge_straight ? idx2 : idx1;
+
+							// Take references to both Jacobians (wrt pose "i" and pose "j"), taking into account the possible
+							// switch in their order:
+							const typename gst::matrix_VxV_t &J1 = edge_straight ? Js.first : Js.second;
+							const typename gst::matrix_VxV_t &J2 = edge_straight ? Js.second : Js.first;
+
+							typename gst::matrix_VxV_t JtJ(UNINITIALIZED_MATRIX);
+							// Is "n" the node "i"? -> Ji^t * Inf *  Ji
+							if (idx_i==static_cast<size_t>(n))
+							{
+								AuxErrorEval<typename gst::edge_t,gst>::multiplyJtLambdaJ(J1,JtJ,edge);
+								H_col[n] += JtJ;
+							}
+							// Is "n" the node "j"? -> Jj^t * Inf *  Jj
+							if (idx_j==static_cast<size_t>(n))
+							{
+								AuxErrorEval<typename gst::edge_t,gst>::multiplyJtLambdaJ(J2,JtJ,edge);
+								H_col[n] += JtJ;
+
+								// And "i" is also a free node? -> Ji^t * Inf *  Jj , in the column of "j"
+								if (idx_i!=string::npos)
+								{
+									AuxErrorEval<typename gst::edge_t,gst>::multiplyJ1tLambdaJ2(J1,J2,JtJ,edge);
+									H_col[idx_i] += JtJ;
+								}
+							}
+						}
+					}
 				}
+			};
 
-				// Add to vector of errors:
-				errs.resize(errs.size()+1);
-				detail::AuxErrorEval<typename gst::edge_t,gst>::computePseudoLnError(P1DP2inv, errs.back(),edge);
+		} // end NS detail
 
-				// Compute the jacobians:
-				EIGEN_ALIGN16 std::pair<TPairNodeIDs,typename gst::TPairJacobs> newMapEntry;
-				newMapEntry.first = ids;
-				gst::SE_TYPE::jacobian_dP1DP2inv_depsilon(P1DP2inv, &newMapEntry.second.first,&newMapEntry.second.second);
+		/** Compute, at once, jacobians and the error vectors for each constraint in "lstObservationData", returns the overall squared error.
+		  * \param[in] parallel_min_edges If !=0 and there are at least this number of constraints, they are evaluated in parallel (see mrpt::system::parallel_for)
+		  */
+		template <class GRAPH_T>
+		double computeJacobiansAndErrors(
+			const GRAPH_T &graph,
+			const vector<typename graphslam_traits<GRAPH_T>::observation_info_t>  &lstObservationData,
+			typename graphslam_traits<GRAPH_T>::vector_pairJacobs_t   &lstJacobians,
+			typename mrpt::aligned_containers<typename graphslam_traits<GRAPH_T>::Array_O>::vector_t &errs,
+			const size_t parallel_min_edges = 0
+			)
+		{
+			const size_t nObservations = lstObservationData.size();
+			lstJacobians.resize(nObservations);
+			errs.resize(nObservations);
 
-				// And insert into map of jacobians:
-				lstJacobians.insert(lstJacobians.end(),newMapEntry );
-			}
+			const detail::TJacobiansAndErrorsEvaluator<GRAPH_T> evaluator(lstObservationData,lstJacobians,errs);
+			if (parallel_min_edges && nObservations>=parallel_min_edges)
+					mrpt::system::parallel_for( mrpt::system::BlockedRange(0,static_cast<int>(nObservations),256), evaluator );
+			else	evaluator( mrpt::system::BlockedRange(0,static_cast<int>(nObservations)) );
 
 			// return overall square error:  (Was: std::accumulate(...,mrpt::math::squareNorm_accum<>), but led to GCC errors when enabling parallelization)
 			double ret_err = 0.0;
@@ -163,6 +275,23 @@ namespace mrpt
 			return ret_err;
 		}
 
+		/** \overload Returns the Jacobians in a map indexed by the node IDs of each constraint. */
+		template <class GRAPH_T>
+		double computeJacobiansAndErrors(
+			const GRAPH_T &graph,
+			const vector<typename graphslam_traits<GRAPH_T>::observation_info_t>  &lstObservationData,
+			typename graphslam_traits<GRAPH_T>::map_pairIDs_pairJacobs_t   &lstJacobians,
+			typename mrpt::aligned_containers<typename graphslam_traits<GRAPH_T>::Array_O>::vector_t &errs
+			)
+		{
+			typename graphslam_traits<GRAPH_T>::vector_pairJacobs_t  Js;
+			const double ret_err = computeJacobiansAndErrors<GRAPH_T>(graph,lstObservationData,Js,errs);
+			lstJacobians.clear();
+			for (size_t i=0;i<Js.size();i++)
+				lstJacobians.insert(lstJacobians.end(), std::make_pair(lstObservationData[i].edge->first,Js[i]) );
+			return ret_err;
+		}
+
 	} // end of NS
 } // end of NS
 
@@ -41,6 +41,7 @@ namespace mrpt
 				mrpt::utils::TPairNodeIDs,
 				TPairJacobs
 				>::map_t  map_pairIDs_pairJacobs_t;
+			typedef typename mrpt::aligned_containers<TPairJacobs>::vector_t  vector_pairJacobs_t; //!< The pairs of Jacobians of each constraint, in the same order than the constraints (see computeJacobiansAndErrors())
 
 			/** Auxiliary struct used in graph-slam implementation: It holds the relevant information for each of the constraints being taking into account. */
 			struct observation_info_t
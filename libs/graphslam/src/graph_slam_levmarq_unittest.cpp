@@ -12,6 +12,7 @@
 #include <mrpt/graphs.h>
 #include <mrpt/random.h>
 #include <mrpt/utils/CMemoryStream.h>
+#include <mrpt/system/parallelization.h>
 #include <gtest/gtest.h>
 
 using namespace mrpt;
@@ -148,6 +149,73 @@ protected:
 
 	} // end test_ring_path
 
+	void test_parallel_ring_path()
+	{
+		my_graph_t graph_serial;
+		create_ring_path(graph_serial);
+		my_graph_t graph_parallel = graph_serial;
+
+		TParametersDouble  params;
+		params["max_iterations"] = 100;
+		graphslam::TResultInfoSpaLevMarq  info_serial, info_parallel;
+
+		params["parallel_min_edges"] = 0;
+		graphslam::optimize_graph_spa_levmarq(graph_serial,info_serial,NULL,params);
+		params["parallel_min_edges"] = 1;
+		mrpt::system::setNumberOfParallelThreads(4); // Even on single-core machines
+		graphslam::optimize_graph_spa_levmarq(graph_parallel,info_parallel,NULL,params);
+		mrpt::system::setNumberOfParallelThreads(0);
+
+		// Each edge and node is processed by one thread in the same order, so results must be exactly the same:
+		EXPECT_EQ(info_serial.num_iters, info_parallel.num_iters);
+		EXPECT_EQ(info_serial.final_total_sq_error, info_parallel.final_total_sq_error);
+		for (typename my_graph_t::global_poses_t::const_iterator it=graph_serial.nodes.begin();it!=graph_serial.nodes.end();++it)
+			EXPECT_EQ(0, (it->second.getAsVectorVal()-graph_parallel.nodes[it->first].getAsVectorVal()).array().abs().maxCoeff() );
+	} // end test_parallel_ring_path
+
+	void test_incremental_ring_path()
+	{
+		my_graph_t full_graph;
+		create_ring_path(full_graph);
+		const TNodeID N = full_graph.nodes.size();
+
+		// Insert the nodes and edges in small chunks, as they would arrive during SLAM, optimizing after each one:
+		graphslam::CIncrementalSpaOptimizer<my_graph_t> optimizer;
+		graphslam::TResultInfoSpaLevMarq  info;
+		TParametersDouble  params;
+		params["max_iterations"] = 100;
+
+		my_graph_t graph;
+		graph.root = full_graph.root;
+		TNodeID prev_last = 0;
+		graph.nodes[0] = full_graph.nodes[0];
+		while (prev_last<N-1)
+		{
+			const TNodeID last = std::min<TNodeID>(prev_last+5, N-1);
+			for (TNodeID i=prev_last+1;i<=last;i++)
+				graph.nodes[i] = full_graph.nodes[i];
+
+			for (typename my_graph_t::edges_map_t::const_iterator it=full_graph.edges.begin();it!=full_graph.edges.end();++it)
+			{
+				const TNodeID max_id = std::max(it->first.first,it->first.second);
+				if (max_id>prev_last && max_id<=last)
+					graph.insertEdge(it->first.first,it->first.second,it->second);
+			}
+			optimizer.optimize(graph,info,params);
+			prev_last = last;
+
+			EXPECT_EQ(optimizer.getNumberOfVariables(), static_cast<size_t>(last));
+			EXPECT_LE(info.final_total_sq_error, 1e-2);
+		}
+		EXPECT_EQ(optimizer.getNumberOfEdges(), full_graph.edges.size());
+
+		// Nothing new: the solution must remain the same
+		const double last_err = info.final_total_sq_error;
+		optimizer.optimize(graph,info,params);
+		EXPECT_EQ(info.num_iters, 0U);
+		EXPECT_NEAR(info.final_total_sq_error, last_err, 1e-12);
+	} // end test_incremental_ring_path
+
 	void test_graph_bin_serialization()
 	{
 		my_graph_t graph;
@@ -189,6 +257,19 @@ TEST_F(GraphSlamLevMarqTester2D, OptimizeSampleRingPath)
 		test_ring_path();
 	}
 }
+TEST_F(GraphSlamLevMarqTester2D, OptimizeParallelRingPath)
+{
+	randomGenerator.randomize(321);
+	test_parallel_ring_path();
+}
+TEST_F(GraphSlamLevMarqTester2D, OptimizeIncrementalRingPath)
+{
+	for (int seed=1;seed<5;seed++)
+	{
+		randomGenerator.randomize(seed);
+		test_incremental_ring_path();
+	}
+}
 TEST_F(GraphSlamLevMarqTester2D, BinarySerialization)
 {
 	randomGenerator.randomize(123);
@@ -203,6 +284,19 @@ TEST_F(GraphSlamLevMarqTester3D, OptimizeSampleRingPath)
 		test_ring_path();
 	}
 }
+TEST_F(GraphSlamLevMarqTester3D, OptimizeParallelRingPath)
+{
+	randomGenerator.randomize(321);
+	test_parallel_ring_path();
+}
+TEST_F(GraphSlamLevMarqTester3D, OptimizeIncrementalRingPath)
+{
+	for (int seed=1;seed<5;seed++)
+	{
+		randomGenerator.randomize(seed);
+		test_incremental_ring_path();
+	}
+}
 TEST_F(GraphSlamLevMarqTester3D, BinarySerialization)
 {
 	randomGenerator.randomize(123);
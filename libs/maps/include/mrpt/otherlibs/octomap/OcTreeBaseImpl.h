@@ -202,6 +202,9 @@ namespace octomap {
     /// Traverses the tree to calculate the total number of nodes
     size_t calcNumNodes() const;
 
+    /// Updates size() (and the metric bounds) after the tree has been built directly through getRoot(), e.g. by a custom deserializer
+    void recalcNumNodes() { tree_size = calcNumNodes(); size_changed = true; }
+
     /// Traverses the tree to calculate the total number of leaf nodes
     size_t getNumLeafNodes() const;
 
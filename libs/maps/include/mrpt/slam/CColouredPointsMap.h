@@ -127,6 +127,8 @@ namespace mrpt
 			/** Auxiliary method called from within \a addFrom() automatically, to finish the copying of class-specific data  */
 			virtual void  addFrom_classSpecific(const CPointsMap &anotherMap, const size_t nPreviousPoints);
 
+			virtual void  resizeFast(size_t newLength);
+
 
 			// Friend methods:
 			template <class Derived> friend struct detail::loadFromRangeImpl;
@@ -171,7 +173,7 @@ namespace mrpt
 			/// \overload
 			inline void  insertPoint( const mrpt::math::TPoint3D &p ) { insertPoint(p.x,p.y,p.z); }
 			/// \overload
-			inline void  insertPoint( float x, float y, float z) { insertPointFast(x,y,z); mark_as_modified(); }
+			inline void  insertPoint( float x, float y, float z) { insertPointFast(x,y,z); mark_as_points_appended(); }
 
 			/** Changes just the color of a given point from the map. First index is 0.
 			 * \exception Throws std::exception on index out of bound.
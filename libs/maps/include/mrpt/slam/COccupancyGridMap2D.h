@@ -14,6 +14,7 @@
 #include <mrpt/utils/CLoadableOptions.h>
 #include <mrpt/utils/CImage.h>
 #include <mrpt/utils/CDynamicGrid.h>
+#include <mrpt/utils/CCopyOnWriteTiledBuffer.h>
 #include <mrpt/slam/CMetricMap.h>
 #include <mrpt/utils/TMatchingPair.h>
 #include <mrpt/slam/CLogOddsGridMap2D.h>
@@ -107,8 +108,10 @@ namespace slam
 		/** This is the buffer for storing the cells.In this dynamic
 		 *   size buffer are stored the cell values as
 		 *   "bytes", stored row by row, from left to right cells.
+		 *  Rows are grouped in tiles which are shared between copies of the map (e.g. the particles of a RBPF) until
+		 *   one of them modifies a tile (copy-on-write), so write access must go through map.getRowWritable() or map.cellWritable().
 		 */
-		std::vector<cellType>    map;
+		mrpt::utils::CCopyOnWriteTiledBuffer<cellType>    map;
 
 		/** The size of the grid in cells.
 		 */
@@ -124,9 +127,48 @@ namespace slam
 
 		/** These are auxiliary variables to speed up the computation of observation likelihood values for LF method among others, at a high cost in memory (see TLikelihoodOptions::enableLikelihoodCache).
 		  */
-		std::vector<double>		precomputedLikelihood;
+		mrpt::utils::CCopyOnWriteTiledBuffer<float>		precomputedLikelihood;
 		bool					precomputedLikelihoodToBeRecomputed;
 
+		/** Squared distance (in meters^2) from each cell to its closest occupied cell, saturated at TLikelihoodOptions::LF_maxCorrsDistance^2.
+		  *  Built with an exact Euclidean distance transform and used by the likelihood field methods. \sa updateLikelihoodField */
+		mrpt::utils::CCopyOnWriteTiledBuffer<float>		m_LF_closest_obstacle_sqdist;
+		float					m_LF_built_maxCorrsDistance;  //!< The value of LF_maxCorrsDistance used to build m_LF_closest_obstacle_sqdist
+		int						m_LF_dirty_x_min, m_LF_dirty_x_max, m_LF_dirty_y_min, m_LF_dirty_y_max; //!< Cell window modified since the last update of the likelihood field (empty if min>max)
+
+		/** Marks a window of cells (indices, inclusive) as modified, so only the affected region of the likelihood field gets updated in the next call to updateLikelihoodField() */
+		inline void  markLikelihoodFieldAsModified(int cx_min, int cx_max, int cy_min, int cy_max)
+		{
+			if (m_LF_dirty_x_min>m_LF_dirty_x_max || m_LF_dirty_y_min>m_LF_dirty_y_max)
+			{
+				m_LF_dirty_x_min = cx_min; m_LF_dirty_x_max = cx_max;
+				m_LF_dirty_y_min = cy_min; m_LF_dirty_y_max = cy_max;
+			}
+			else
+			{
+				mrpt::utils::keep_min(m_LF_dirty_x_min, cx_min); mrpt::utils::keep_max(m_LF_dirty_x_max, cx_max);
+				mrpt::utils::keep_min(m_LF_dirty_y_min, cy_min); mrpt::utils::keep_max(m_LF_dirty_y_max, cy_max);
+			}
+		}
+
+		/** Computes the exact squared distance transform in the window [x0,x1]x[y0,y1] and saves the results only within [wx0,wx1]x[wy0,wy1] */
+		void  computeLikelihoodFieldWindow(int x0, int x1, int y0, int y1, int wx0, int wx1, int wy0, int wy1);
+
+		/** Chessboard distance (in cells, saturated at 255) from each cell to the closest cell where a simulated ray would stop, used by laserScanSimulatorBatch().
+		  *  m_simul_dist_occ considers occupied cells and the outside of the grid, m_simul_dist_any also unknown cells. Cells are stored row by row.
+		  *  Copies of the grid share them, since they are never modified in place but replaced when rebuilt. \sa updateSimulatorDistanceFields */
+		mutable stlplus::smart_ptr< std::vector<uint8_t> >	m_simul_dist_occ, m_simul_dist_any;
+		mutable float			m_simul_dist_threshold_free; //!< The free-cells threshold used to build m_simul_dist_*
+		mutable bool			m_simul_dist_outdated; //!< Set whenever the cells change, to rebuild m_simul_dist_* on the next call to laserScanSimulatorBatch()
+
+		/** Rebuilds m_simul_dist_occ and m_simul_dist_any if the map has changed or a different threshold is requested */
+		void  updateSimulatorDistanceFields(const float threshold_free) const;
+
+		/** Whether m_simul_dist_occ and m_simul_dist_any are up to date for the given threshold, i.e. usable by simulateScanRayFast() */
+		inline bool simulatorDistanceFieldsUpToDate(const float threshold_free) const {
+			return !m_simul_dist_outdated && m_simul_dist_threshold_free==threshold_free && m_simul_dist_occ.present() && m_simul_dist_occ->size()==size_t(size_x)*size_y;
+		}
+
 		/** Used for Voronoi calculation.Same struct as "map", but contains a "0" if not a basis point. */
 		CDynamicGrid<uint8_t>	m_basis_map;
 
@@ -156,14 +198,16 @@ namespace slam
 		 */
 		inline void   setCell_nocheck(int x,int y,float value)
 		{
-				map[x+y*size_x]=p2l(value);
+				map.cellWritable(x,y)=p2l(value);
+				m_simul_dist_outdated = true;
+				markLikelihoodFieldAsModified(x,x,y,y);
 		}
 
 		/** Read the real valued [0,1] contents of a cell, given its index.
 		 */
 		inline float  getCell_nocheck(int x,int y) const
 		{
-				return l2p(map[x+y*size_x]);
+				return l2p(map(x,y));
 		}
 
 		/** Changes a cell by its absolute index (Do not use it normally)
@@ -172,7 +216,10 @@ namespace slam
 		{
 			if (cellIndex<size_x*size_y)
 			{
-				map[cellIndex] = b;
+				const int x = cellIndex % size_x, y = cellIndex / size_x;
+				map.cellWritable(x,y) = b;
+				m_simul_dist_outdated = true;
+				markLikelihoodFieldAsModified(x,x,y,y);
 			}
 		}
 
@@ -207,6 +254,9 @@ namespace slam
 					const CPose2D				&takenFrom );
 
 		/** One of the methods that can be selected for implementing "computeObservationLikelihood".
+		  *  The distance fields of laserScanSimulatorBatch() are only used if already up to date: they are not rebuilt here, since a single
+		  *  evaluation after each change of the map (e.g. one per particle and step in a RBPF) would cost much more than it saves.
+		  *  To evaluate many poses at once, use computeObservationLikelihood_rayTracingBatch() instead.
 		  */
 		double	 computeObservationLikelihood_rayTracing(
 					const CObservation		*obs,
@@ -392,7 +442,9 @@ namespace slam
 			// The x> comparison implicitly holds if x<0
 			if (static_cast<unsigned int>(x)>=size_x ||	static_cast<unsigned int>(y)>=size_y)
 					return;
-			else	map[x+y*size_x]=p2l(value);
+			map.cellWritable(x,y)=p2l(value);
+			m_simul_dist_outdated = true;
+			markLikelihoodFieldAsModified(x,x,y,y);
 		}
 
 		/** Read the real valued [0,1] contents of a cell, given its index.
@@ -402,16 +454,26 @@ namespace slam
 			// The x> comparison implicitly holds if x<0
 			if (static_cast<unsigned int>(x)>=size_x ||	static_cast<unsigned int>(y)>=size_y)
 					return 0.5f;
-			else	return l2p(map[x+y*size_x]);
+			else	return l2p(map(x,y));
 		}
 
 		/** Access to a "row": mainly used for drawing grid as a bitmap efficiently, do not use it normally.
+		  *  Only the cells of this row are contiguous in memory: rows are stored in copy-on-write tiles, see getSharedMemoryStats().
 		  */
-		inline  cellType *getRow( int cy ) { if (cy<0 || static_cast<unsigned int>(cy)>=size_y) return NULL; else return &map[0+cy*size_x]; }
+		inline  cellType *getRow( int cy ) { if (cy<0 || static_cast<unsigned int>(cy)>=size_y) return NULL; m_simul_dist_outdated = true; markLikelihoodFieldAsModified(0,size_x-1,cy,cy); return map.getRowWritable(cy); }
 
 		/** Access to a "row": mainly used for drawing grid as a bitmap efficiently, do not use it normally.
+		  *  Only the cells of this row are contiguous in memory: rows are stored in copy-on-write tiles, see getSharedMemoryStats().
 		  */
-		inline  const cellType *getRow( int cy ) const { if (cy<0 || static_cast<unsigned int>(cy)>=size_y) return NULL; else return &map[0+cy*size_x]; }
+		inline  const cellType *getRow( int cy ) const { if (cy<0 || static_cast<unsigned int>(cy)>=size_y) return NULL; else return map.getRow(cy); }
+
+		/** Returns the number of tiles of rows in which the cells are stored, and how many of them are still shared with other copies of this map.
+		  *  Copies of a grid map (e.g. in the particles of a Rao-Blackwellized particle filter) share all their tiles, which are only duplicated when a copy modifies them.
+		  */
+		inline void getSharedMemoryStats(size_t &out_tiles_count, size_t &out_shared_tiles_count) const {
+			out_tiles_count = map.getTilesCount();
+			out_shared_tiles_count = map.getSharedTilesCount();
+		}
 
 		/** Change the contents [0,1] of a cell, given its coordinates.
 		 */
@@ -831,6 +893,26 @@ namespace slam
 				float						rangeNoiseStd = 0,
 				float						angleNoiseStd = DEG2RAD(0) ) const;
 
+		/** Simulates one noiseless laser range scan of N rays from each of a set of robot poses, e.g. for all the particles of a ray-casting particle filter.
+		 *   The results are identical to those of laserScanSimulator() (with noiseStd=0, decimation=1), but rays jump over free space with the help of
+		 *    a distance transform of the grid (built on the first call and after any change in the map), and all the rays are simulated in parallel (see mrpt::system::parallel_for).
+		 * \param robotPoses [IN] The robot poses in this map coordinates.
+		 * \param scan_params [IN] Its sensorPose, aperture, maxRange and rightToLeft are used for all the scans; its ranges are not modified.
+		 * \param out_ranges [OUT] The simulated ranges, N consecutive values for each robot pose. Resized to N*robotPoses.size(), so it can be reused across calls without reallocations.
+		 * \param out_valid [OUT] The validity of each range, in the same order than out_ranges.
+		 * \param threshold [IN] The minimum occupancy threshold to consider a cell to be occupied, for example 0.5.
+		 * \param N [IN] The count of range scan "rays", by default to 361.
+		 * \note Do not call this method concurrently on the same map object from different threads, since it may update its internal cache.
+		 * \sa laserScanSimulator
+		 */
+		void  laserScanSimulatorBatch(
+				const std::vector<mrpt::math::TPose2D>	&robotPoses,
+				const CObservation2DRangeScan	&scan_params,
+				std::vector<float>				&out_ranges,
+				std::vector<char>				&out_valid,
+				float							threshold = 0.5f,
+				size_t							N = 361 ) const;
+
 		/** Simulate just one "ray" in the grid map. This method is used internally to sonarSimulator and laserScanSimulator.
 		  */
 		inline void simulateScanRay(
@@ -840,6 +922,16 @@ namespace slam
 			const float threshold_free=0.5f,
 			const double noiseStd=0, const double angleNoiseStd=0 ) const;
 
+		/** Noiseless version of simulateScanRay() which skips free cells with the distance fields built by updateSimulatorDistanceFields(). Used internally in laserScanSimulatorBatch() and computeObservationLikelihood_rayTracingBatch().
+		  * \param use_dist_fields If false, the distance fields (which may be outdated) are not used and all the cells along the ray are checked, with identical results.
+		  */
+		void simulateScanRayFast(
+			const double x,const double y,const double angle_direction,
+			float &out_range,bool &out_valid,
+			const unsigned int max_ray_len,
+			const float threshold_free,
+			const bool use_dist_fields = true ) const;
+
 
 		/** @} */
 
@@ -859,6 +951,27 @@ namespace slam
 		  */
 		double	 computeLikelihoodField_Thrun( const CPointsMap	*pm, const CPose2D *relativePose = NULL);
 
+		/** Builds (or updates) the table of distances to the closest obstacle used by the likelihood field method (lmLikelihoodField_Thrun).
+		  *  It is invoked automatically when needed, but can be called explicitly after loading or modifying a map to avoid the delay on the first likelihood evaluation.
+		  *  The whole table is built in linear time with the exact Euclidean distance transform of Felzenszwalb & Huttenlocher, while
+		  *  after the insertion of new observations only the windows of cells affected by the change are recomputed.
+		  *  The cost of evaluating the likelihood of each point becomes independent of TLikelihoodOptions::LF_maxCorrsDistance.
+		  */
+		void  updateLikelihoodField();
+
+		/** Computes the log-likelihood of one laser scan with the ray tracing (beam) model (lmRayTracing) for each of a set of robot poses, e.g. all the particles of a Monte Carlo localization filter.
+		  *  Each value is the same that computeObservationLikelihood() would return with likelihoodOptions.likelihoodMethod=lmRayTracing, but all poses are evaluated in parallel
+		  *   (see mrpt::system::parallel_for), the expected ranges are simulated as in laserScanSimulatorBatch(), and only the rays with a valid measured range are simulated.
+		  * \param obs [IN] The observed scan. See likelihoodOptions for the rayTracing_* parameters.
+		  * \param robotPoses [IN] The robot poses in this map coordinates.
+		  * \param out_log_liks [OUT] The log-likelihood for each pose. Resized to robotPoses.size().
+		  * \note Do not call this method concurrently on the same map object from different threads, since it may update its internal cache.
+		  */
+		void  computeObservationLikelihood_rayTracingBatch(
+			const CObservation2DRangeScan			&obs,
+			const std::vector<mrpt::math::TPose2D>	&robotPoses,
+			std::vector<double>						&out_log_liks ) const;
+
 		/** Computes the likelihood [0,1] of a set of points, given the current grid map as reference.
 		  * \param pm The points map
 		  * \param relativePose The relative pose of the points map in this map's coordinates, or NULL for (0,0,0).
@@ -52,7 +52,7 @@ namespace mrpt
 
 
 			/** Constructor, defines the resolution of the octomap (length of each voxel side) */
-			COctoMapBase(const double resolution=0.10) : insertionOptions(*this), m_octomap(resolution) { }
+			COctoMapBase(const double resolution=0.10) : insertionOptions(*this), m_octomap(resolution), m_nodes_after_pruning(0) { }
 			virtual ~COctoMapBase() { }
 
 			/** Get a reference to the internal octomap object. Example:
@@ -80,6 +80,9 @@ namespace mrpt
 					// Copy all but the m_parent pointer!
 					maxrange = o.maxrange;
 					pruning  = o.pruning;
+					pruningMaxMemoryMB = o.pruningMaxMemoryMB;
+					fastInsertion = o.fastInsertion;
+					fastInsertionParallelMinRays = o.fastInsertionParallelMinRays;
 					const bool o_has_parent = o.m_parent.get()!=NULL;
 					setOccupancyThres( o_has_parent ? o.getOccupancyThres() : o.occupancyThres );
 					setProbHit( o_has_parent ? o.getProbHit() : o.probHit );
@@ -97,6 +100,17 @@ namespace mrpt
 				double maxrange;  //!< maximum range for how long individual beams are inserted (default -1: complete beam)
 				bool pruning;     //!< whether the tree is (losslessly) pruned after insertion (default: true)
 
+				/** (Default: 0) If >0 (and \a pruning is true), pruning after each insertion is deferred until the estimated memory of the octree
+				  *  (see getMemoryUsageEstimate()) exceeds this number of megabytes and the tree has grown by 25% since the last pruning, since
+				  *  pruning traverses the whole tree. Call prune() when done inserting observations. */
+				double pruningMaxMemoryMB;
+
+				/** (Default: false) Insert scans with computeUpdateFast() instead of octomap's insertScan(): only one ray is cast for all the points
+				  *  falling into the same voxel (towards the voxel center), and rays are cast in parallel. Much faster for dense point clouds (e.g. RGB-D cameras),
+				  *  at the cost of slightly different free space near the ends of the rays. Ignored if the octree has a bounding box limit (see octomap::OccupancyOcTreeBase::useBBXLimit). */
+				bool fastInsertion;
+				int  fastInsertionParallelMinRays; //!< (Default: 2000) With fastInsertion, rays are cast in parallel if there are at least this number of them (0: never)
+
 				/// (key name in .ini files: "occupancyThres") sets the threshold for occupancy (sensor model) (Default=0.5)
 				void setOccupancyThres(double prob) { if(m_parent.get()) m_parent->m_octomap.setOccupancyThres(prob); }
 				/// (key name in .ini files: "probHit")sets the probablility for a "hit" (will be converted to logodds) - sensor model (Default=0.7)
@@ -242,10 +256,27 @@ namespace mrpt
 			  */
 			void insertPointCloud(const CPointsMap &ptMap, const float sensor_x,const float sensor_y,const float sensor_z);
 
-			/** Just like insertPointCloud but with a single ray. */
+			/** Computes the keys of the voxels to be updated as free and occupied by a scan, like octomap::OccupancyOcTreeBase::computeUpdate(), but casting only one ray
+			  *  to the center of each voxel with scan points (the cloud is thus downsampled to the voxel resolution), and in parallel (see TInsertionOptions::fastInsertion).
+			  *  Both sets are disjoint: voxels with points are never marked as free.
+			  * \param[in] scan The points, in this map's frame of reference.
+			  * \param[in] sensorPt The origin of the rays.
+			  * \param[out] free_cells The voxels traversed by any ray.
+			  * \param[out] occupied_cells The voxels with some point within \a insertionOptions.maxrange.
+			  */
+			void computeUpdateFast(const octomap::Pointcloud &scan, const octomap::point3d &sensorPt, octomap::KeySet &free_cells, octomap::KeySet &occupied_cells);
+
+			/** Just like insertPointCloud but with a single ray. The tree is not pruned: see prune(). */
 			void insertRay(const float end_x,const float end_y,const float end_z,const float sensor_x,const float sensor_y,const float sensor_z)
 			{
-				m_octomap.insertRay( octomap::point3d(sensor_x,sensor_y,sensor_z), octomap::point3d(end_x,end_y,end_z), insertionOptions.maxrange,insertionOptions.pruning);
+				m_octomap.insertRay( octomap::point3d(sensor_x,sensor_y,sensor_z), octomap::point3d(end_x,end_y,end_z), insertionOptions.maxrange);
+			}
+
+			/** Losslessly prunes the tree right now (see TInsertionOptions::pruningMaxMemoryMB for deferred pruning) */
+			void prune()
+			{
+				m_octomap.prune();
+				m_nodes_after_pruning = m_octomap.size();
 			}
 
 			/** Performs raycasting in 3d, similar to computeRay().
@@ -279,6 +310,11 @@ namespace mrpt
 			size_t memoryUsage() const { return  m_octomap.memoryUsage(); }
 			/// \return Memory usage of the a single octree node
 			size_t memoryUsageNode() const { return  m_octomap.memoryUsageNode(); }
+			/// \return An estimate of memoryUsage(), from the number of nodes only (without traversing the tree). Used for deferred pruning.
+			size_t getMemoryUsageEstimate() const {
+				// Inner nodes, roughly 1/8 of all nodes, also hold an array of 8 pointers to their children:
+				return m_octomap.size() * (m_octomap.memoryUsageNode() + sizeof(void*));
+			}
 			/// \return Memory usage of a full grid of the same size as the OcTree in bytes (for comparison)
 			size_t memoryFullGrid() const { return  m_octomap.memoryFullGrid(); }
 			double volume() const { return m_octomap.volume(); }
@@ -305,7 +341,7 @@ namespace mrpt
 
 
 		protected:
-			virtual void  internal_clear() {  m_octomap.clear(); }
+			virtual void  internal_clear() {  m_octomap.clear(); m_nodes_after_pruning=0; }
 
 			/**  Builds the list of 3D points in global coordinates for a generic observation. Used for both, insertObservation() and computeLikelihood().
 			  * \param[out] point3d_sensorPt Is a pointer to a "point3D".
@@ -314,7 +350,22 @@ namespace mrpt
 			  */
 			bool internal_build_PointCloud_for_observation(const CObservation *obs,const CPose3D *robotPose, octomap::point3d &point3d_sensorPt, octomap::Pointcloud &ptr_scan) const;
 
+			/** Inserts a point cloud (in this map's frame of reference) with octomap's insertScan() or, if insertionOptions.fastInsertion is set, with computeUpdateFast() */
+			void internal_insertScan(const octomap::Pointcloud &scan, const octomap::point3d &sensorPt);
+
+			/** Prunes the tree after inserting an observation, if enabled and according to the deferred pruning policy (see TInsertionOptions::pruningMaxMemoryMB) */
+			void internal_pruneAfterInsertion();
+
+			/** Writes the tree in the compact format used since serialization version 2 of COctoMap and CColouredOctoMap:
+			  *  the tree is pruned, then its structure (one byte with the existing children of each inner node), the occupancy of
+			  *  the leaves (quantized to 8 bits) and, if applicable, their colors are written as three run-length compressed streams.
+			  *  Inner nodes are not stored, but recomputed from the leaves while loading. */
+			void internal_writeCompactTree(mrpt::utils::CStream &out) const;
+			/** Reads a tree written by internal_writeCompactTree(), building its nodes as the stream is decoded (without intermediary buffers nor temporary files) */
+			void internal_readCompactTree(mrpt::utils::CStream &in);
+
 			OCTREE m_octomap; //!< The actual octo-map object.
+			size_t m_nodes_after_pruning; //!< Number of nodes after the last pruning, for deferred pruning
 
 		}; // End of class def.
 	} // End of namespace
@@ -12,11 +12,236 @@
 #include <mrpt/slam/CObservation2DRangeScan.h>
 #include <mrpt/slam/CObservation3DRangeScan.h>
 #include <mrpt/slam/CPointsMap.h>
+#include <mrpt/slam/CSimplePointsMap.h>
+#include <mrpt/system/parallelization.h>
+#include <mrpt/otherlibs/octomap/ColorOcTree.h>
 
 namespace mrpt
 {
 	namespace slam
 	{
+		namespace detail
+		{
+			/** Body for mrpt::system::parallel_reduce in COctoMapBase::computeUpdateFast(): casts the rays from the sensor to a range of end points,
+			  *  collecting the traversed voxels into its own set (each thread also needs its own octomap::KeyRay). */
+			template <class OCTREE>
+			struct TOctoMapRayCastingBody
+			{
+				const OCTREE                        &m_tree;
+				const octomap::point3d              &m_origin;
+				const std::vector<octomap::point3d> &m_ends;
+				octomap::KeyRay  m_ray;
+				octomap::KeySet  free_cells;
+
+				TOctoMapRayCastingBody(const OCTREE &tree, const octomap::point3d &origin, const std::vector<octomap::point3d> &ends) :
+					m_tree(tree),m_origin(origin),m_ends(ends) { }
+				TOctoMapRayCastingBody(TOctoMapRayCastingBody &o, mrpt::system::Split) :
+					m_tree(o.m_tree),m_origin(o.m_origin),m_ends(o.m_ends) { }
+
+				void operator()(const mrpt::system::BlockedRange &r)
+				{
+					for (int i=r.begin();i<r.end();i++)
+						if (m_tree.computeRayKeys(m_origin,m_ends[i],m_ray))
+							free_cells.insert(m_ray.begin(),m_ray.end());
+				}
+				void join(TOctoMapRayCastingBody &o)
+				{
+					free_cells.insert(o.free_cells.begin(),o.free_cells.end());
+				}
+			};
+
+			/** Writes a stream of bytes to a CStream with PackBits run-length compression: each packet starts with a byte N,
+			  *  followed by N+1 literal bytes if N<128, or by one byte to be repeated 257-N times if N>128. */
+			class CRunLengthEncoder
+			{
+			public:
+				CRunLengthEncoder(mrpt::utils::CStream &out) : m_out(out),m_run_byte(0),m_run_len(0) { m_buf.reserve(4096); }
+
+				inline void put(const uint8_t b)
+				{
+					if (m_run_len && b==m_run_byte && m_run_len<128) { m_run_len++; return; }
+					flushRun();
+					m_run_byte = b;
+					m_run_len  = 1;
+				}
+				/** Must be called after the last byte */
+				void finish()
+				{
+					flushRun();
+					flushLiterals();
+					if (!m_buf.empty()) m_out.WriteBuffer(&m_buf[0],m_buf.size());
+					m_buf.clear();
+				}
+
+			private:
+				mrpt::utils::CStream &m_out;
+				std::vector<uint8_t>  m_buf;  //!< Output packets not written yet
+				std::vector<uint8_t>  m_lit;  //!< Pending literal bytes
+				uint8_t  m_run_byte;
+				unsigned int m_run_len;
+
+				void flushRun()
+				{
+					if (m_run_len>=3)
+					{
+						flushLiterals();
+						m_buf.push_back( static_cast<uint8_t>(257-m_run_len) );
+						m_buf.push_back( m_run_byte );
+					}
+					else
+					{
+						for (unsigned int i=0;i<m_run_len;i++)
+						{
+							m_lit.push_back(m_run_byte);
+							if (m_lit.size()==128) flushLiterals();
+						}
+					}
+					m_run_len = 0;
+					if (m_buf.size()>=4096-130)
+					{
+						m_out.WriteBuffer(&m_buf[0],m_buf.size());
+						m_buf.clear();
+					}
+				}
+				void flushLiterals()
+				{
+					if (m_lit.empty()) return;
+					m_buf.push_back( static_cast<uint8_t>(m_lit.size()-1) );
+					m_buf.insert(m_buf.end(),m_lit.begin(),m_lit.end());
+					m_lit.clear();
+				}
+			};
+
+			/** Reads the bytes written by CRunLengthEncoder, one packet at a time (it never reads beyond the last byte requested). */
+			class CRunLengthDecoder
+			{
+			public:
+				CRunLengthDecoder(mrpt::utils::CStream &in) : m_in(in),m_left(0),m_pos(0),m_is_run(false) { }
+
+				inline uint8_t get()
+				{
+					if (!m_left) readPacket();
+					m_left--;
+					return m_is_run ? m_lit[0] : m_lit[m_pos++];
+				}
+				/** Checks that the whole stream was read */
+				void finish() const
+				{
+					ASSERTMSG_(m_left==0, "Corrupted run-length compressed stream")
+				}
+
+			private:
+				mrpt::utils::CStream &m_in;
+				uint8_t      m_lit[128];
+				unsigned int m_left, m_pos;
+				bool         m_is_run;
+
+				void readPacket()
+				{
+					uint8_t n;
+					m_in >> n;
+					ASSERTMSG_(n!=128, "Corrupted run-length compressed stream")
+					m_is_run = (n>128);
+					m_left = m_is_run ? 257-n : n+1;
+					if (m_is_run)
+							m_in >> m_lit[0];
+					else if (m_in.ReadBuffer(m_lit,m_left)!=m_left)
+						THROW_EXCEPTION("Unexpected end of run-length compressed stream")
+					m_pos = 0;
+				}
+			};
+
+			/** Quantizes log-odds to 8 bits, linearly in [lmin,0] (0-127) and in (0,lmax] (128-255), so the sign (free/occupied) is kept */
+			inline uint8_t octomap_quantizeLogOdds(const float l, const float lmin, const float lmax)
+			{
+				if (l<=0)
+				{
+					if (lmin>=0) return 127;
+					const float q = 127*(1-l/lmin);
+					return q<=0 ? 0 : static_cast<uint8_t>(q+0.5f);
+				}
+				else
+				{
+					if (lmax<=0) return 255;
+					const int q = 127 + static_cast<int>(l/lmax*128+0.5f);
+					return static_cast<uint8_t>( q<128 ? 128 : (q>255 ? 255 : q) );
+				}
+			}
+			inline float octomap_dequantizeLogOdds(const uint8_t q, const float lmin, const float lmax)
+			{
+				return q<=127 ? lmin*(1-q/127.f) : lmax*(q-127)/128.f;
+			}
+
+			/** Extra data of the leaves in the compact serialization format: none for occupancy-only nodes, the color for ColorOcTreeNode */
+			inline bool octomap_hasLeafExtra(const octomap::OcTreeNode *) { return false; }
+			inline bool octomap_hasLeafExtra(const octomap::ColorOcTreeNode *) { return true; }
+			inline void octomap_writeLeafExtra(CRunLengthEncoder &, const octomap::OcTreeNode *) { }
+			inline void octomap_writeLeafExtra(CRunLengthEncoder &enc, const octomap::ColorOcTreeNode *node)
+			{
+				const octomap::ColorOcTreeNode::Color c = node->getColor();
+				enc.put(c.r); enc.put(c.g); enc.put(c.b);
+			}
+			inline void octomap_readLeafExtra(CRunLengthDecoder &, octomap::OcTreeNode *) { }
+			inline void octomap_readLeafExtra(CRunLengthDecoder &dec, octomap::ColorOcTreeNode *node)
+			{
+				const uint8_t r = dec.get(), g = dec.get(), b = dec.get();
+				node->setColor(r,g,b);
+			}
+
+			template <class NODE>
+			void octomap_writeStructure(CRunLengthEncoder &enc, const NODE *node, const unsigned int depth, const unsigned int max_depth)
+			{
+				if (depth>=max_depth) return;
+				uint8_t mask = 0;
+				for (unsigned int i=0;i<8;i++)
+					if (node->childExists(i)) mask |= (1<<i);
+				enc.put(mask);
+				for (unsigned int i=0;i<8;i++)
+					if (mask & (1<<i))
+						octomap_writeStructure(enc,node->getChild(i),depth+1,max_depth);
+			}
+			template <class NODE>
+			void octomap_readStructure(CRunLengthDecoder &dec, NODE *node, const unsigned int depth, const unsigned int max_depth)
+			{
+				if (depth>=max_depth) return;
+				const uint8_t mask = dec.get();
+				for (unsigned int i=0;i<8;i++)
+					if (mask & (1<<i))
+					{
+						node->createChild(i);
+						octomap_readStructure(dec,node->getChild(i),depth+1,max_depth);
+					}
+			}
+			template <class NODE>
+			void octomap_writeLeaves(CRunLengthEncoder &enc, const NODE *node, const bool extra, const float lmin, const float lmax)
+			{
+				if (!node->hasChildren())
+				{
+					if (extra)
+							octomap_writeLeafExtra(enc,node);
+					else	enc.put( octomap_quantizeLogOdds(node->getLogOdds(),lmin,lmax) );
+					return;
+				}
+				for (unsigned int i=0;i<8;i++)
+					if (node->childExists(i))
+						octomap_writeLeaves(enc,node->getChild(i),extra,lmin,lmax);
+			}
+			template <class NODE>
+			void octomap_readLeaves(CRunLengthDecoder &dec, NODE *node, const bool extra, const float lmin, const float lmax)
+			{
+				if (!node->hasChildren())
+				{
+					if (extra)
+							octomap_readLeafExtra(dec,node);
+					else	node->setLogOdds( octomap_dequantizeLogOdds(dec.get(),lmin,lmax) );
+					return;
+				}
+				for (unsigned int i=0;i<8;i++)
+					if (node->childExists(i))
+						octomap_readLeaves(dec,node->getChild(i),extra,lmin,lmax);
+			}
+		} // end detail
+
 		template <class OCTREE,class OCTREE_NODE>
 		bool COctoMapBase<OCTREE,OCTREE_NODE>::internal_build_PointCloud_for_observation(const CObservation *obs,const mrpt::poses::CPose3D *robotPose, octomap::point3d &sensorPt, octomap::Pointcloud &scan) const
 		{
@@ -71,7 +296,7 @@ namespace mrpt
 				const CObservation3DRangeScan	*o = static_cast<const CObservation3DRangeScan*>( obs );
 
 				// Build a points-map representation of the points from the scan (coordinates are wrt the robot base)
-				if (!o->hasPoints3D)
+				if (!o->hasPoints3D && !o->hasRangeImage)
 					return false;
 
 				// Sensor_pose = robot_pose (+) sensor_pose_on_robot
@@ -80,6 +305,26 @@ namespace mrpt
 				sensorPt = octomap::point3d(sensorPose.x(),sensorPose.y(),sensorPose.z());
 
 				o->load(); // Just to make sure the points are loaded from an external source, if that's the case...
+
+				if (!o->hasPoints3D)
+				{
+					// Only a depth image (e.g. RGB-D cameras): project it straight into the map frame of reference, skipping invalid pixels:
+					T3DPointsProjectionParams pp;
+					pp.takeIntoAccountSensorPoseOnRobot = true;
+					pp.robotPoseInTheWorld = &robotPose3D;
+					pp.rangeMin = std::numeric_limits<float>::epsilon();
+
+					CSimplePointsMap pts;
+					const_cast<CObservation3DRangeScan*>(o)->project3DPointsFromDepthImageInto(pts,pp);
+
+					size_t N;
+					const float *xs,*ys,*zs;
+					pts.getPointsBuffer(N,xs,ys,zs);
+					scan.reserve(N);
+					for (size_t i=0;i<N;i++)
+						scan.push_back(xs[i],ys[i],zs[i]);
+					return true;
+				}
 				const size_t sizeRangeScan = o->points3D_x.size();
 
 				// Transform 3D point cloud:
@@ -208,8 +453,192 @@ namespace mrpt
 			size_t N;
 			const float *xs,*ys,*zs;
 			ptMap.getPointsBuffer(N,xs,ys,zs);
-			for (size_t i=0;i<N;i++)
-				m_octomap.insertRay(sensorPt, octomap::point3d(xs[i],ys[i],zs[i]), insertionOptions.maxrange,insertionOptions.pruning);
+			if (insertionOptions.fastInsertion)
+			{
+				octomap::Pointcloud scan;
+				scan.reserve(N);
+				for (size_t i=0;i<N;i++)
+					scan.push_back(xs[i],ys[i],zs[i]);
+				internal_insertScan(scan,sensorPt);
+			}
+			else
+			{
+				for (size_t i=0;i<N;i++)
+					m_octomap.insertRay(sensorPt, octomap::point3d(xs[i],ys[i],zs[i]), insertionOptions.maxrange);
+				internal_pruneAfterInsertion();
+			}
+			MRPT_END
+		}
+
+		template <class OCTREE,class OCTREE_NODE>
+		void COctoMapBase<OCTREE,OCTREE_NODE>::computeUpdateFast(const octomap::Pointcloud &scan, const octomap::point3d &sensorPt, octomap::KeySet &free_cells, octomap::KeySet &occupied_cells)
+		{
+			MRPT_START
+
+			// Free space must be clipped to the bounding box ray by ray: leave it to octomap.
+			if (m_octomap.bbxSet())
+			{
+				m_octomap.computeUpdate(scan, sensorPt, free_cells, occupied_cells, insertionOptions.maxrange);
+				return;
+			}
+
+			// 1) Downsample the end points to the voxels they fall into. Beams longer than maxrange only clear space up to that distance:
+			const double maxrange = insertionOptions.maxrange;
+			octomap::KeySet  maxrange_cells;
+			octomap::OcTreeKey key;
+			for (octomap::Pointcloud::const_iterator it=scan.begin();it!=scan.end();++it)
+			{
+				const octomap::point3d &p = *it;
+				if (maxrange<0 || (p-sensorPt).norm()<=maxrange)
+				{
+					if (m_octomap.coordToKeyChecked(p,key))
+						occupied_cells.insert(key);
+				}
+				else
+				{
+					const octomap::point3d new_end = sensorPt + (p-sensorPt).normalized() * (float)maxrange;
+					if (m_octomap.coordToKeyChecked(new_end,key))
+						maxrange_cells.insert(key);
+				}
+			}
+
+			// 2) One ray per distinct end voxel, towards its center:
+			std::vector<octomap::point3d> ends;
+			ends.reserve(occupied_cells.size()+maxrange_cells.size());
+			for (octomap::KeySet::const_iterator it=occupied_cells.begin();it!=occupied_cells.end();++it)
+				ends.push_back(m_octomap.keyToCoord(*it));
+			for (octomap::KeySet::const_iterator it=maxrange_cells.begin();it!=maxrange_cells.end();++it)
+				if (occupied_cells.find(*it)==occupied_cells.end())
+					ends.push_back(m_octomap.keyToCoord(*it));
+
+			const int nRays = static_cast<int>(ends.size());
+			detail::TOctoMapRayCastingBody<OCTREE> body(m_octomap,sensorPt,ends);
+			if (insertionOptions.fastInsertionParallelMinRays>0 && nRays>=insertionOptions.fastInsertionParallelMinRays)
+					mrpt::system::parallel_reduce( mrpt::system::BlockedRange(0,nRays,256), body );
+			else	body( mrpt::system::BlockedRange(0,nRays) );
+
+			if (free_cells.empty())
+					free_cells.swap(body.free_cells);
+			else	free_cells.insert(body.free_cells.begin(),body.free_cells.end());
+
+			// 3) Prefer occupied cells over free ones (and make sets disjoint):
+			for (octomap::KeySet::iterator it=free_cells.begin();it!=free_cells.end(); )
+			{
+				if (occupied_cells.find(*it)!=occupied_cells.end())
+						it = free_cells.erase(it);
+				else	++it;
+			}
+
+			MRPT_END
+		}
+
+		template <class OCTREE,class OCTREE_NODE>
+		void COctoMapBase<OCTREE,OCTREE_NODE>::internal_insertScan(const octomap::Pointcloud &scan, const octomap::point3d &sensorPt)
+		{
+			if (!insertionOptions.fastInsertion)
+			{
+				m_octomap.insertScan(scan, sensorPt, insertionOptions.maxrange, false /* pruning */);
+				internal_pruneAfterInsertion();
+				return;
+			}
+
+			octomap::KeySet free_cells, occupied_cells;
+			computeUpdateFast(scan, sensorPt, free_cells, occupied_cells);
+
+			for (octomap::KeySet::iterator it=free_cells.begin();it!=free_cells.end();++it)
+				m_octomap.updateNode(*it, false, false);
+			for (octomap::KeySet::iterator it=occupied_cells.begin();it!=occupied_cells.end();++it)
+				m_octomap.updateNode(*it, true, false);
+
+			internal_pruneAfterInsertion();
+		}
+
+		template <class OCTREE,class OCTREE_NODE>
+		void COctoMapBase<OCTREE,OCTREE_NODE>::internal_pruneAfterInsertion()
+		{
+			if (!insertionOptions.pruning) return;
+
+			if (insertionOptions.pruningMaxMemoryMB>0)
+			{
+				// Deferred pruning: wait for the tree to exceed the memory budget, but not to prune over and over again
+				// if it can't get below the budget anymore:
+				const size_t nNodes = m_octomap.size();
+				if (getMemoryUsageEstimate() <= insertionOptions.pruningMaxMemoryMB*1024.0*1024.0 ||
+					nNodes < m_nodes_after_pruning + m_nodes_after_pruning/4)
+					return;
+			}
+			this->prune();
+		}
+
+		template <class OCTREE,class OCTREE_NODE>
+		void COctoMapBase<OCTREE,OCTREE_NODE>::internal_writeCompactTree(mrpt::utils::CStream &out) const
+		{
+			MRPT_START
+			// Inner nodes with identical children are not worth storing:
+			const_cast<OCTREE*>(&m_octomap)->prune();
+
+			const float lmin = m_octomap.getClampingThresMinLog();
+			const float lmax = m_octomap.getClampingThresMaxLog();
+			const double res = m_octomap.getResolution();
+			const OCTREE_NODE *root = m_octomap.getRoot();
+			const bool has_extra = detail::octomap_hasLeafExtra(root);
+			out << res << lmin << lmax << has_extra;
+
+			const unsigned int max_depth = m_octomap.getTreeDepth();
+			{
+				detail::CRunLengthEncoder enc(out);
+				detail::octomap_writeStructure(enc,root,0,max_depth);
+				enc.finish();
+			}
+			{
+				detail::CRunLengthEncoder enc(out);
+				detail::octomap_writeLeaves(enc,root,false,lmin,lmax);
+				enc.finish();
+			}
+			if (has_extra)
+			{
+				detail::CRunLengthEncoder enc(out);
+				detail::octomap_writeLeaves(enc,root,true,lmin,lmax);
+				enc.finish();
+			}
+			MRPT_END
+		}
+
+		template <class OCTREE,class OCTREE_NODE>
+		void COctoMapBase<OCTREE,OCTREE_NODE>::internal_readCompactTree(mrpt::utils::CStream &in)
+		{
+			MRPT_START
+			double res;
+			float  lmin,lmax;
+			bool   has_extra;
+			in >> res >> lmin >> lmax >> has_extra;
+
+			m_octomap.clear();
+			m_octomap.setResolution(res);
+
+			OCTREE_NODE *root = m_octomap.getRoot();
+			ASSERTMSG_(has_extra==detail::octomap_hasLeafExtra(root), "The stream contains an octomap of a different kind")
+			const unsigned int max_depth = m_octomap.getTreeDepth();
+			{
+				detail::CRunLengthDecoder dec(in);
+				detail::octomap_readStructure(dec,root,0,max_depth);
+				dec.finish();
+			}
+			{
+				detail::CRunLengthDecoder dec(in);
+				detail::octomap_readLeaves(dec,root,false,lmin,lmax);
+				dec.finish();
+			}
+			if (has_extra)
+			{
+				detail::CRunLengthDecoder dec(in);
+				detail::octomap_readLeaves(dec,root,true,lmin,lmax);
+				dec.finish();
+			}
+
+			m_octomap.updateInnerOccupancy();
+			m_octomap.recalcNumNodes();
+			m_nodes_after_pruning = m_octomap.size();
 			MRPT_END
 		}
 
@@ -238,6 +667,9 @@ namespace mrpt
 		COctoMapBase<OCTREE,OCTREE_NODE>::TInsertionOptions::TInsertionOptions(COctoMapBase<OCTREE,OCTREE_NODE> &parent) :
 			maxrange (-1.),
 			pruning  (true),
+			pruningMaxMemoryMB (0),
+			fastInsertion (false),
+			fastInsertionParallelMinRays (2000),
 			m_parent (&parent),
 			// Default values from octomap:
 			occupancyThres (0.5),
@@ -252,6 +684,9 @@ namespace mrpt
 		COctoMapBase<OCTREE,OCTREE_NODE>::TInsertionOptions::TInsertionOptions() :
 			maxrange (-1.),
 			pruning  (true),
+			pruningMaxMemoryMB (0),
+			fastInsertion (false),
+			fastInsertionParallelMinRays (2000),
 			m_parent (NULL),
 			// Default values from octomap:
 			occupancyThres (0.5),
@@ -303,6 +738,9 @@ namespace mrpt
 
 			LOADABLEOPTS_DUMP_VAR(maxrange,double);
 			LOADABLEOPTS_DUMP_VAR(pruning,bool);
+			LOADABLEOPTS_DUMP_VAR(pruningMaxMemoryMB,double);
+			LOADABLEOPTS_DUMP_VAR(fastInsertion,bool);
+			LOADABLEOPTS_DUMP_VAR(fastInsertionParallelMinRays,int);
 
 			LOADABLEOPTS_DUMP_VAR(getOccupancyThres(),double);
 			LOADABLEOPTS_DUMP_VAR(getProbHit(),double);
@@ -331,6 +769,9 @@ namespace mrpt
 		{
 			MRPT_LOAD_CONFIG_VAR(maxrange,double, iniFile,section);
 			MRPT_LOAD_CONFIG_VAR(pruning,bool, iniFile,section);
+			MRPT_LOAD_CONFIG_VAR(pruningMaxMemoryMB,double, iniFile,section);
+			MRPT_LOAD_CONFIG_VAR(fastInsertion,bool, iniFile,section);
+			MRPT_LOAD_CONFIG_VAR(fastInsertionParallelMinRays,int, iniFile,section);
 
 			MRPT_LOAD_CONFIG_VAR(occupancyThres,double, iniFile,section);
 			MRPT_LOAD_CONFIG_VAR(probHit,double, iniFile,section);
@@ -144,6 +144,10 @@ namespace slam
 		/** Auxiliary method called from within \a addFrom() automatically, to finish the copying of class-specific data  */
 		virtual void  addFrom_classSpecific(const CPointsMap &anotherMap, const size_t nPreviousPoints) = 0;
 
+		/** Like resize(), but *without* calling mark_as_modified(), so the caller can signal a finer-grained change
+		  *  (e.g. mark_as_points_appended()) \sa resize */
+		virtual void  resizeFast(size_t newLength) = 0;
+
 	public:
 
 		/** @} */
@@ -459,7 +463,7 @@ namespace slam
 		/** Provides a way to insert (append) individual points into the map: the missing fields of child
 		  * classes (color, weight, etc) are left to their default values
 		  */
-		inline void  insertPoint( float x, float y, float z=0 ) { insertPointFast(x,y,z); mark_as_modified(); }
+		inline void  insertPoint( float x, float y, float z=0 ) { insertPointFast(x,y,z); mark_as_points_appended(); }
 		/// \overload of \a insertPoint()
 		inline void  insertPoint( const CPoint3D &p ) { insertPoint(p.x(),p.y(),p.z()); }
 		/// \overload
@@ -679,6 +683,13 @@ namespace slam
 		  */
         void extractPoints( const TPoint3D &corner1, const TPoint3D &corner2, CPointsMap *outMap, const double &R = 1, const double &G = 1, const double &B = 1 );
 
+		/** Returns this map downsampled with a voxel grid: one point, the centroid of the points inside, for each occupied cubic voxel of side \a voxel_size.
+		  *  The result (and the KD-trees built on it) is cached until this map is modified, like the KD-tree of this map, so it is not thread-safe either.
+		  *  The results for a few different voxel sizes are kept at once, e.g. for the levels of a multi-resolution ICP.
+		  * \sa mrpt::slam::CICP::TConfigParams::multiresolution_levels
+		  */
+		const CSimplePointsMap * getVoxelDownsampled(const float voxel_size) const;
+
 		/** @name Filter-by-height stuff
 			@{ */
 
@@ -824,15 +835,39 @@ namespace slam
 		mutable bool	m_boundingBoxIsUpdated;
 		mutable float   m_bb_min_x,m_bb_max_x, m_bb_min_y,m_bb_max_y, m_bb_min_z,m_bb_max_z;
 
+		/** The cached results of getVoxelDownsampled(), with their voxel sizes */
+		mutable std::vector<std::pair<float,CPointsMapPtr> > m_voxel_downsampled_cache;
+
 
 		/** Called only by this class or children classes, set m_largestDistanceFromOriginIsUpdated=false and such. */
 		inline void mark_as_modified() const
 		{
 			m_largestDistanceFromOriginIsUpdated=false;
 			m_boundingBoxIsUpdated = false;
+			m_voxel_downsampled_cache.clear();
 			kdtree_mark_as_outdated();
 		}
 
+		/** Like mark_as_modified(), for changes which only append new points at the end of the map, so a dynamic KD-tree index
+		  *  (see KDTreeCapable::TKDTreeSearchParams::dynamic_index) can be updated instead of rebuilt. */
+		inline void mark_as_points_appended() const
+		{
+			m_largestDistanceFromOriginIsUpdated=false;
+			m_boundingBoxIsUpdated = false;
+			m_voxel_downsampled_cache.clear();
+			kdtree_mark_as_appended();
+		}
+
+		/** Like mark_as_modified(), for changes which only remove the points flagged in \a removed_mask (one entry per point
+		  *  before the removal) and keep the rest in their order. */
+		inline void mark_as_points_removed(const std::vector<bool> &removed_mask) const
+		{
+			m_largestDistanceFromOriginIsUpdated=false;
+			m_boundingBoxIsUpdated = false;
+			m_voxel_downsampled_cache.clear();
+			kdtree_mark_as_removed(removed_mask);
+		}
+
 		/** This is a common version of CMetricMap::insertObservation() for point maps (actually, CMetricMap::internal_insertObservation),
 		  *   so derived classes don't need to worry implementing that method unless something special is really necesary.
 		  * See mrpt::slam::CPointsMap for the enumeration of types of observations which are accepted.
@@ -113,6 +113,8 @@ namespace mrpt
 				// No extra data.
 			}
 
+			virtual void  resizeFast(size_t newLength);
+
 			// Friend methods:
 			template <class Derived> friend struct detail::loadFromRangeImpl;
 			template <class Derived> friend struct detail::pointmap_traits;
@@ -109,6 +109,8 @@ namespace mrpt
 			/** Auxiliary method called from within \a addFrom() automatically, to finish the copying of class-specific data  */
 			virtual void  addFrom_classSpecific(const CPointsMap &anotherMap, const size_t nPreviousPoints);
 
+			virtual void  resizeFast(size_t newLength);
+
 			// Friend methods:
 			template <class Derived> friend struct detail::loadFromRangeImpl;
 			template <class Derived> friend struct detail::pointmap_traits;
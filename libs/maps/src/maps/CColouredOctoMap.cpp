@@ -56,19 +56,13 @@ CColouredOctoMap::~CColouredOctoMap()
 void  CColouredOctoMap::writeToStream(CStream &out, int *version) const
 {
 	if (version)
-		*version = 1;
+		*version = 2;
 	else
 	{
 		this->likelihoodOptions.writeToStream(out);
 		this->renderingOptions.writeToStream(out);  // Added in v1
 
-		CMemoryChunk chunk;
-		const string	tmpFil = mrpt::system::getTempFileName();
-		const_cast<octomap::ColorOcTree*>(&m_octomap)->writeBinary(tmpFil);
-		chunk.loadBufferFromFile(tmpFil);
-		mrpt::system::deleteFile(tmpFil);
-		out << chunk;
-
+		this->internal_writeCompactTree(out);  // Compact format since v2
 	}
 }
 
@@ -83,21 +77,29 @@ void  CColouredOctoMap::readFromStream(CStream &in, int version)
 	{
 	case 0:
 	case 1:
+	case 2:
 		{
 			this->likelihoodOptions.readFromStream(in);
 			if (version>=1) this->renderingOptions.readFromStream(in);
 
 			this->clear();
 
-			CMemoryChunk chunk;
-			in >> chunk;
-
-			if (chunk.getTotalBytesCount())
+			if (version>=2)
+			{
+				this->internal_readCompactTree(in);
+			}
+			else
 			{
-				const string	tmpFil = mrpt::system::getTempFileName();
-				if (!chunk.saveBufferToFile( tmpFil ) ) THROW_EXCEPTION("Error saving temporary file");
-				m_octomap.readBinary(tmpFil);
-				mrpt::system::deleteFile( tmpFil );
+				CMemoryChunk chunk;
+				in >> chunk;
+
+				if (chunk.getTotalBytesCount())
+				{
+					const string	tmpFil = mrpt::system::getTempFileName();
+					if (!chunk.saveBufferToFile( tmpFil ) ) THROW_EXCEPTION("Error saving temporary file");
+					m_octomap.readBinary(tmpFil);
+					mrpt::system::deleteFile( tmpFil );
+				}
 			}
 
 		} break;
@@ -154,7 +156,7 @@ bool CColouredOctoMap::internal_insertObservation(const CObservation *obs,const
 		}
 
 		// Insert rays:
-		m_octomap.insertScan(scan, sensorPt, insertionOptions.maxrange, insertionOptions.pruning);
+		internal_insertScan(scan, sensorPt);
 		return true;
 	}
 	else if ( IS_CLASS(obs,CObservation3DRangeScan) )
@@ -189,7 +191,9 @@ bool CColouredOctoMap::internal_insertObservation(const CObservation *obs,const
 
 		// Insert rays:
 		octomap::KeySet free_cells, occupied_cells;
-		m_octomap.computeUpdate(scan, sensorPt, free_cells, occupied_cells, insertionOptions.maxrange);    
+		if (insertionOptions.fastInsertion)
+				computeUpdateFast(scan, sensorPt, free_cells, occupied_cells);
+		else	m_octomap.computeUpdate(scan, sensorPt, free_cells, occupied_cells, insertionOptions.maxrange);
 		
 		// insert data into tree  -----------------------
 		for (octomap::KeySet::iterator it = free_cells.begin(); it != free_cells.end(); ++it) {
@@ -210,8 +214,7 @@ bool CColouredOctoMap::internal_insertObservation(const CObservation *obs,const
 				this->updateVoxelColour(pt.x,pt.y,pt.z, uint8_t(pt.R*colF2B),uint8_t(pt.G*colF2B),uint8_t(pt.B*colF2B) );
 		}
 
-		// TODO: does pruning make sense if we used "lazy_eval"?
-		if (insertionOptions.pruning) m_octomap.prune();
+		internal_pruneAfterInsertion();
 
 		return true;
 	}
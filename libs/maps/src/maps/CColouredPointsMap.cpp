@@ -66,6 +66,12 @@ void CColouredPointsMap::reserve(size_t newLength)
 // Resizes all point buffers so they can hold the given number of points: newly created points are set to default values,
 //  and old contents are not changed.
 void CColouredPointsMap::resize(size_t newLength)
+{
+	resizeFast(newLength);
+	mark_as_modified();
+}
+
+void CColouredPointsMap::resizeFast(size_t newLength)
 {
 	x.resize( newLength, 0 );
 	y.resize( newLength, 0 );
@@ -73,7 +79,7 @@ void CColouredPointsMap::resize(size_t newLength)
 	m_color_R.resize( newLength, 1 );
 	m_color_G.resize( newLength, 1 );
 	m_color_B.resize( newLength, 1 );
-	mark_as_modified();
+	// mark_as_modified(); -> Fast
 }
 
 // Resizes all point buffers so they can hold the given number of points, *erasing* all previous contents
@@ -346,7 +352,7 @@ void  CColouredPointsMap::insertPoint( float x, float y, float z, float R, float
 	m_color_G.push_back(G);
 	m_color_B.push_back(B);
 
-	mark_as_modified();
+	mark_as_points_appended();
 }
 
 /*---------------------------------------------------------------
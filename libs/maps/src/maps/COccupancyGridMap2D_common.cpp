@@ -45,6 +45,12 @@ COccupancyGridMap2D::COccupancyGridMap2D(
 		x_min(),x_max(),y_min(),y_max(), resolution(),
 		precomputedLikelihood(),
 		precomputedLikelihoodToBeRecomputed(true),
+		m_LF_closest_obstacle_sqdist(),
+		m_LF_built_maxCorrsDistance(0),
+		m_LF_dirty_x_min(0),m_LF_dirty_x_max(-1),m_LF_dirty_y_min(0),m_LF_dirty_y_max(-1),
+		m_simul_dist_occ(),m_simul_dist_any(),
+		m_simul_dist_threshold_free(0),
+		m_simul_dist_outdated(true),
 		m_basis_map(),
 		m_voronoi_diagram(),
 		m_is_empty(true),
@@ -92,6 +98,7 @@ void  COccupancyGridMap2D::setSize(
 
 	// For the precomputed likelihood trick:
 	precomputedLikelihoodToBeRecomputed = true;
+	m_simul_dist_outdated = true;
 
 	// Adjust sizes to adapt them to full sized cells acording to the resolution:
 	x_min = resolution*round(x_min/resolution);
@@ -122,7 +129,7 @@ void  COccupancyGridMap2D::setSize(
 #endif
 
     // Cells memory:
-    map.resize(size_x*size_y,p2l(default_value));
+    map.resize(size_x,size_y,p2l(default_value));
 
 	// Free these buffers also:
 	m_basis_map.clear();
@@ -139,7 +146,7 @@ void  COccupancyGridMap2D::setSize(
 void  COccupancyGridMap2D::resizeGrid(float new_x_min,float new_x_max,float new_y_min,float new_y_max,float new_cells_default_value, bool additionalMargin) MRPT_NO_THROWS
 {
 	unsigned int			extra_x_izq=0,extra_y_arr=0,new_size_x=0,new_size_y=0;
-	std::vector<cellType>	new_map;
+	CCopyOnWriteTiledBuffer<cellType>	new_map;
 
 	if( new_x_min > new_x_max )
 	{
@@ -160,6 +167,7 @@ void  COccupancyGridMap2D::resizeGrid(float new_x_min,float new_x_max,float new_
 
 	// For the precomputed likelihood trick:
 	precomputedLikelihoodToBeRecomputed = true;
+	m_simul_dist_outdated = true;
 
 	// Add an additional margin:
 	if (additionalMargin)
@@ -209,24 +217,19 @@ void  COccupancyGridMap2D::resizeGrid(float new_x_min,float new_x_max,float new_
 	assert(0==(new_size_x % 16));
 #endif
 
-	// Reserve new mem block
-	new_map.resize(new_size_x*new_size_y, p2l(new_cells_default_value));
+	// Reserve new mem block (the new rows share one tile until they are modified)
+	new_map.resize(new_size_x,new_size_y, p2l(new_cells_default_value));
 
 	// Copy all the old map rows into the new map:
 	{
-		cellType  	*dest_ptr = &new_map[extra_x_izq + extra_y_arr*new_size_x];
-		cellType  	*src_ptr  = &map[0];
 		size_t 		row_size = size_x*sizeof(cellType);
 
 		for (size_t y = 0;y<size_y;y++)
 		{
 #if defined(_DEBUG) || (MRPT_ALWAYS_CHECKS_DEBUG)
-			assert( dest_ptr+row_size-1 <= &new_map[new_map.size()-1] );
-			assert( src_ptr+row_size-1 <= &map[map.size()-1] );
+			assert( y+extra_y_arr<new_size_y && extra_x_izq+size_x<=new_size_x );
 #endif
-			memcpy( dest_ptr, src_ptr, row_size );
-			dest_ptr += new_size_x;
-			src_ptr  += size_x;
+			memcpy( new_map.getRowWritable(y+extra_y_arr)+extra_x_izq, map.getRow(y), row_size );
 		}
 	}
 
@@ -264,6 +267,7 @@ void COccupancyGridMap2D::freeMap()
 
 	// For the precomputed likelihood trick:
 	precomputedLikelihoodToBeRecomputed = true;
+	m_simul_dist_outdated = true;
 
 	m_is_empty=true;
 
@@ -317,15 +321,19 @@ void  COccupancyGridMap2D::computeEntropy( TEntropyInfo &info ) const
 
 	info.H = info.I = 0;
 	info.effectiveMappedCells = 0;
-	for ( std::vector<cellType>::const_iterator it=map.begin();it!=map.end();++it)
+	for (unsigned int y=0;y<size_y;y++)
 	{
-		cellTypeUnsigned  i = static_cast<cellTypeUnsigned>(*it);
-		h = entropyTable[ i ];
-		info.H+= h;
-		if (h<(MAX_H-0.001f))
+		const cellType *row = map.getRow(y);
+		for (unsigned int x=0;x<size_x;x++)
 		{
-			info.effectiveMappedCells++;
-			info.I-=h;
+			cellTypeUnsigned  i = static_cast<cellTypeUnsigned>(row[x]);
+			h = entropyTable[ i ];
+			info.H+= h;
+			if (h<(MAX_H-0.001f))
+			{
+				info.effectiveMappedCells++;
+				info.I-=h;
+			}
 		}
 	}
 
@@ -367,6 +375,7 @@ void  COccupancyGridMap2D::internal_clear()
 	//resetFeaturesCache();
 	// For the precomputed likelihood trick:
 	precomputedLikelihoodToBeRecomputed = true;
+	m_simul_dist_outdated = true;
 }
 
 /*---------------------------------------------------------------
@@ -375,10 +384,10 @@ void  COccupancyGridMap2D::internal_clear()
 void  COccupancyGridMap2D::fill(float default_value)
 {
 	cellType		defValue = p2l( default_value );
-	for (std::vector<cellType>::iterator	it=map.begin();it<map.end();++it)
-		*it = defValue;
+	map.fill(defValue);
 	// For the precomputed likelihood trick:
 	precomputedLikelihoodToBeRecomputed = true;
+	m_simul_dist_outdated = true;
 	//resetFeaturesCache();
 }
 
@@ -391,19 +400,21 @@ void  COccupancyGridMap2D::updateCell(int x,int y, float v)
 	if (static_cast<unsigned int>(x)>=size_x || static_cast<unsigned int>(y)>=size_y)
 		return;
 
-	// Get the current contents of the cell:
-	cellType	&theCell = map[x+y*size_x];
-
 	// Compute the new Bayesian-fused value of the cell:
 	if ( updateInfoChangeOnly.enabled )
 	{
-		float	old	= l2p(theCell);
+		float	old	= l2p(map(x,y));
 		float		new_v	= 1 / ( 1 + (1-v)*(1-old)/(old*v) );
 		updateInfoChangeOnly.cellsUpdated++;
 		updateInfoChangeOnly.I_change+= 1-(H(new_v)+H(1-new_v))/MAX_H;
 	}
 	else
 	{
+		// Get the current contents of the cell:
+		cellType	&theCell = map.cellWritable(x,y);
+		m_simul_dist_outdated = true;
+		markLikelihoodFieldAsModified(x,x,y,y);
+
 		cellType obs = p2l(v);  // The observation: will be >0 for free, <0 for occupied.
 		if (obs>0)
 		{
@@ -426,7 +437,7 @@ void  COccupancyGridMap2D::updateCell(int x,int y, float v)
  ---------------------------------------------------------------*/
 void  COccupancyGridMap2D::subSample( int downRatio )
 {
-	std::vector<cellType>		newMap;
+	CCopyOnWriteTiledBuffer<cellType>		newMap;
 
 	ASSERT_(downRatio>0);
 
@@ -435,7 +446,7 @@ void  COccupancyGridMap2D::subSample( int downRatio )
 	int		newSizeX = round((x_max-x_min)/resolution);
 	int		newSizeY = round((y_max-y_min)/resolution);
 
-	newMap.resize(newSizeX*newSizeY);
+	newMap.resize(newSizeX,newSizeY);
 
 	for (int x=0;x<newSizeX;x++)
 	{
@@ -449,7 +460,7 @@ void  COccupancyGridMap2D::subSample( int downRatio )
 
 			newCell /= (downRatio*downRatio);
 
-			newMap[ x + y*newSizeX ] = p2l(newCell);
+			newMap.cellWritable(x,y) = p2l(newCell);
 		}
 	}
 
@@ -575,7 +586,7 @@ void COccupancyGridMap2D::determineMatching2D(
 			for (int cy=cy_min;cy<=cy_max;cy++)
 			{
 				// Is an occupied cell?
-				if ( map[cx+cy*size_x] < thresholdCellValue )//  getCell(cx,cy)<0.49)
+				if ( map(cx,cy) < thresholdCellValue )//  getCell(cx,cy)<0.49)
 				{
 					const float residual_x = idx2x(cx)- x_local;
 					const float residual_y = idx2y(cy)- y_local;
@@ -35,10 +35,11 @@ void  COccupancyGridMap2D::getAsImage(
 		if (!forceRGB)
 		{	// 8bit gray-scale
 			img.resize(size_x,size_y,1,true); //verticalFlip);
-			const cellType	*srcPtr = &map[0];
+			const cellType	*srcPtr;
 			unsigned char	*destPtr;
 			for (unsigned int y=0;y<size_y;y++)
 			{
+				srcPtr = map.getRow(y);
 				if (!verticalFlip)
 						destPtr = img(0,size_y-1-y);
 				else 	destPtr = img(0,y);
@@ -51,10 +52,11 @@ void  COccupancyGridMap2D::getAsImage(
 		else
 		{	// 24bit RGB:
 			img.resize(size_x,size_y,3,true); //verticalFlip);
-			const cellType	*srcPtr = &map[0];
+			const cellType	*srcPtr;
 			unsigned char	*destPtr;
 			for (unsigned int y=0;y<size_y;y++)
 			{
+				srcPtr = map.getRow(y);
 				if (!verticalFlip)
 						destPtr = img(0,size_y-1-y);
 				else 	destPtr = img(0,y);
@@ -74,10 +76,11 @@ void  COccupancyGridMap2D::getAsImage(
 		if (!forceRGB)
 		{	// 8bit gray-scale
 			img.resize(size_x,size_y,1,true); //verticalFlip);
-			const cellType	*srcPtr = &map[0];
+			const cellType	*srcPtr;
 			unsigned char	*destPtr;
 			for (unsigned int y=0;y<size_y;y++)
 			{
+				srcPtr = map.getRow(y);
 				if (!verticalFlip)
 						destPtr = img(0,size_y-1-y);
 				else 	destPtr = img(0,y);
@@ -96,10 +99,11 @@ void  COccupancyGridMap2D::getAsImage(
 		else
 		{	// 24bit RGB:
 			img.resize(size_x,size_y,3,true); //verticalFlip);
-			const cellType	*srcPtr = &map[0];
+			const cellType	*srcPtr;
 			unsigned char	*destPtr;
 			for (unsigned int y=0;y<size_y;y++)
 			{
+				srcPtr = map.getRow(y);
 				if (!verticalFlip)
 						destPtr = img(0,size_y-1-y);
 				else 	destPtr = img(0,y);
@@ -166,10 +170,11 @@ void  COccupancyGridMap2D::getAs3DObject(mrpt::opengl::CSetOfObjectsPtr	&outSetO
 	CImage			imgTrans(size_x,size_y,1);
 
 
-	const cellType		*srcPtr = &map[0];
+	const cellType		*srcPtr;
 	
 	for (unsigned int y=0;y<size_y;y++)
 	{
+		srcPtr = map.getRow(y);
 		unsigned char *destPtr_color = imgColor(0,y);
 		unsigned char *destPtr_trans = imgTrans(0,y);
 		for (unsigned int x=0;x<size_x;x++)
@@ -25,6 +25,24 @@ struct TLocalPoint
 	float x,y; int cx, cy;
 };
 
+/** Writable pointers to the rows of a grid map, obtained upon the first modification of each row, so only
+  *  the tiles of rows actually modified are unshared from other copies of the map (copy-on-write). */
+class TWritableRows
+{
+public:
+	TWritableRows(CCopyOnWriteTiledBuffer<COccupancyGridMap2D::cellType> &m) : m_map(m), m_rows(m.getSizeY(),static_cast<COccupancyGridMap2D::cellType*>(NULL)) { }
+
+	inline COccupancyGridMap2D::cellType * operator[](const int cy)
+	{
+		COccupancyGridMap2D::cellType *&row = m_rows[cy];
+		if (!row) row = m_map.getRowWritable(cy);
+		return row;
+	}
+private:
+	CCopyOnWriteTiledBuffer<COccupancyGridMap2D::cellType> &m_map;
+	std::vector<COccupancyGridMap2D::cellType*> m_rows;
+};
+
 /*---------------------------------------------------------------
 					insertObservation
 
@@ -43,8 +61,8 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 
 	// This is required to indicate the grid map has changed!
 	//resetFeaturesCache();
-	// For the precomputed likelihood trick:
-	precomputedLikelihoodToBeRecomputed = true;
+	// The precomputed likelihood field is updated incrementally: each observation below marks the window of
+	//  cells it may have modified (any actual grid resize triggers the rebuild of the whole field).
 
 	if (robotPose)
 	{
@@ -97,6 +115,8 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 			const bool		invalidAsFree			= insertionOptions.considerInvalidRangesAsFreeSpace;
 			float		new_x_max, new_x_min;
 			float		new_y_max, new_y_min;
+			float		scan_x_max=0, scan_x_min=0;  // Area covered by the scan, without margins
+			float		scan_y_max=0, scan_y_min=0;
 			float		last_valid_range	= maxDistanceInsertion;
 
 			float		maxCertainty		= insertionOptions.maxOccupancyUpdateCertainty;
@@ -190,6 +210,9 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 					new_y_min = min( new_y_min, *scanPoint_y );
 				}
 
+				scan_x_max = max(new_x_max,px); scan_x_min = min(new_x_min,px);
+				scan_y_max = max(new_y_max,py); scan_y_min = min(new_y_min,py);
+
 				// Add an extra margin:
 				float securMargen = 15*resolution;
 
@@ -213,7 +236,7 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 				resizeGrid(new_x_min,new_x_max, new_y_min,new_y_max,0.5);
 
 				// For updateCell_fast methods:
-				cellType  *theMapArray = &map[0];
+				TWritableRows  theMapRows(map);
 				unsigned  theMapSize_x = size_x;
 
 				int  cx0 = x2idx(px);		// Remember: This must be after the resizeGrid!!
@@ -261,7 +284,7 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 
 					for (int nStep = 0;nStep<nStepsRay;nStep++)
 					{
-						updateCell_fast_free(cx,cy, logodd_observation, logodd_thres_free, theMapArray, theMapSize_x );
+						updateCell_fast_free(cx,0, logodd_observation, logodd_thres_free, theMapRows[cy], theMapSize_x );
 
 						frCX += frAcx;
 						frCY += frAcy;
@@ -275,7 +298,7 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 					//  - It was a valid ray, and
 					//  - The ray was not truncated
 					if ( o->validRange[idx] && o->scan[idx]<maxDistanceInsertion )
-						updateCell_fast_occupied(trg_cx,trg_cy, logodd_observation_occupied, logodd_thres_occupied, theMapArray, theMapSize_x );
+						updateCell_fast_occupied(trg_cx,0, logodd_observation_occupied, logodd_thres_occupied, theMapRows[trg_cy], theMapSize_x );
 
 				}  // End of each range
 
@@ -342,6 +365,9 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 					new_y_min = min( new_y_min, scanPoint_y );
 				}
 
+				scan_x_max = max(new_x_max,px); scan_x_min = min(new_x_min,px);
+				scan_y_max = max(new_y_max,py); scan_y_min = min(new_y_min,py);
+
 				// Add an extra margin:
 				float securMargen = 15*resolution;
 
@@ -365,7 +391,7 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 				resizeGrid(new_x_min,new_x_max, new_y_min,new_y_max,0.5);
 
 				// For updateCell_fast methods:
-				cellType  *theMapArray = &map[0];
+				TWritableRows  theMapRows(map);
 				unsigned  theMapSize_x = size_x;
 
 				//int  cx0 = x2idx(px);		// Remember: This must be after the resizeGrid!!
@@ -454,7 +480,7 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 						int max_cx = max3(P0.cx,P1.cx,P2.cx);
 
 						for (int ccx=min_cx;ccx<=max_cx;ccx++)
-							updateCell_fast_free(ccx,P0.cy, logodd_observation, logodd_thres_free, theMapArray, theMapSize_x );
+							updateCell_fast_free(ccx,0, logodd_observation, logodd_thres_free, theMapRows[P0.cy], theMapSize_x );
 					}
 					else
 					{
@@ -526,7 +552,7 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 							//	last_insert_cx = R1.cx;
 
 								for (int ccx=R1.cx;ccx<=R2.cx;ccx++)
-									updateCell_fast_free(ccx,R1.cy, logodd_observation, logodd_thres_free, theMapArray, theMapSize_x );
+									updateCell_fast_free(ccx,0, logodd_observation, logodd_thres_free, theMapRows[R1.cy], theMapSize_x );
 							}
 
 							R1.frX += frAx_R1;    R1.frY += frAy_R1;
@@ -597,7 +623,7 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 							//	last_insert_cx = R1.cx;
 								last_insert_cy = R1.cy;
 								for (int ccx=R1.cx;ccx<=R2.cx;ccx++)
-									updateCell_fast_free(ccx,R1.cy, logodd_observation, logodd_thres_free, theMapArray, theMapSize_x );
+									updateCell_fast_free(ccx,0, logodd_observation, logodd_thres_free, theMapRows[R1.cy], theMapSize_x );
 							}
 
 							R1.frX += frAx_R1;    R1.frY += frAy_R1;
@@ -638,7 +664,7 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 						// Special case: Only one cell:
 						if (P2.cx==P1.cx && P2.cy==P1.cy)
 						{
-							updateCell_fast_occupied(P1.cx,P1.cy, logodd_observation_occupied, logodd_thres_occupied, theMapArray, theMapSize_x );
+							updateCell_fast_occupied(P1.cx,0, logodd_observation_occupied, logodd_thres_occupied, theMapRows[P1.cy], theMapSize_x );
 						}
 						else
 						{
@@ -660,7 +686,7 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 
 							for (int nStep=0;nStep<=nSteps;nStep++)
 							{
-								updateCell_fast_occupied(R1.cx,R1.cy, logodd_observation_occupied, logodd_thres_occupied, theMapArray, theMapSize_x );
+								updateCell_fast_occupied(R1.cx,0, logodd_observation_occupied, logodd_thres_occupied, theMapRows[R1.cy], theMapSize_x );
 
 								R1.frX += frAcxE;
 								R1.frY += frAcyE;
@@ -676,6 +702,12 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 
 			}  // end insert with beam widening
 
+			// Mark the modified area for updating the likelihood field (the margin accounts for the width of widened beams):
+			{
+				const int margin = 1 + (insertionOptions.wideningBeamsWithDistance ? (int)ceil(maxDistanceInsertion*fabs(dAK)/resolution) : 0);
+				markLikelihoodFieldAsModified( x2idx(scan_x_min)-margin, x2idx(scan_x_max)+margin, y2idx(scan_y_min)-margin, y2idx(scan_y_max)+margin );
+			}
+
 			// Finished:
 			return true;
 		}
@@ -819,7 +851,7 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 			resizeGrid(new_x_min,new_x_max, new_y_min,new_y_max,0.5);
 
 			// For updateCell_fast methods:
-			cellType  *theMapArray = &map[0];
+			TWritableRows  theMapRows(map);
 			unsigned  theMapSize_x = size_x;
 
 			//int  cx0 = x2idx(px);		// Remember: This must be after the resizeGrid!!
@@ -900,7 +932,7 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 					int max_cx = max3(P0.cx,P1.cx,P2.cx);
 
 					for (int ccx=min_cx;ccx<=max_cx;ccx++)
-						updateCell_fast_free(ccx,P0.cy, logodd_observation, logodd_thres_free, theMapArray, theMapSize_x );
+						updateCell_fast_free(ccx,0, logodd_observation, logodd_thres_free, theMapRows[P0.cy], theMapSize_x );
 				}
 				else
 				{
@@ -971,7 +1003,7 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 						//	last_insert_cx = R1.cx;
 
 							for (int ccx=R1.cx;ccx<=R2.cx;ccx++)
-								updateCell_fast_free(ccx,R1.cy, logodd_observation, logodd_thres_free, theMapArray, theMapSize_x );
+								updateCell_fast_free(ccx,0, logodd_observation, logodd_thres_free, theMapRows[R1.cy], theMapSize_x );
 						}
 
 						R1.frX += frAx_R1;    R1.frY += frAy_R1;
@@ -1041,7 +1073,7 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 						//	last_insert_cx = R1.cx;
 							last_insert_cy = R1.cy;
 							for (int ccx=R1.cx;ccx<=R2.cx;ccx++)
-								updateCell_fast_free(ccx,R1.cy, logodd_observation, logodd_thres_free, theMapArray, theMapSize_x );
+								updateCell_fast_free(ccx,0, logodd_observation, logodd_thres_free, theMapRows[R1.cy], theMapSize_x );
 						}
 
 						R1.frX += frAx_R1;    R1.frY += frAy_R1;
@@ -1082,7 +1114,7 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 					// Special case: Only one cell:
 					if (P2.cx==P1.cx && P2.cy==P1.cy)
 					{
-						updateCell_fast_occupied(P1.cx,P1.cy, logodd_observation_occupied, logodd_thres_occupied, theMapArray, theMapSize_x );
+						updateCell_fast_occupied(P1.cx,0, logodd_observation_occupied, logodd_thres_occupied, theMapRows[P1.cy], theMapSize_x );
 					}
 					else
 					{
@@ -1104,7 +1136,7 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 
 						for (int nStep=0;nStep<=nSteps;nStep++)
 						{
-							updateCell_fast_occupied(R1.cx,R1.cy, logodd_observation_occupied, logodd_thres_occupied, theMapArray, theMapSize_x );
+							updateCell_fast_occupied(R1.cx,0, logodd_observation_occupied, logodd_thres_occupied, theMapRows[R1.cy], theMapSize_x );
 
 							R1.frX += frAcxE;
 							R1.frY += frAcyE;
@@ -1118,6 +1150,12 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 
 			}  // End of each range
 
+			// Mark the modified area for updating the likelihood field (the cones may cover the whole disk of radius maxDistanceInsertion):
+			{
+				const int R = 1+(int)ceil(maxDistanceInsertion/resolution);
+				markLikelihoodFieldAsModified( x2idx(px)-R, x2idx(px)+R, y2idx(py)-R, y2idx(py)+R );
+			}
+
 			return true;
 		} // end reallyInsert
 		else
@@ -1199,4 +1237,5 @@ void  COccupancyGridMap2D::TInsertionOptions::dumpToTextStream(CStream	&out) con
 void COccupancyGridMap2D::OnPostSuccesfulInsertObs(const CObservation *)
 {
 	m_is_empty = false;
+	m_simul_dist_outdated = true;
 }
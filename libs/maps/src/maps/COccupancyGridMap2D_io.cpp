@@ -63,11 +63,15 @@ void  COccupancyGridMap2D::writeToStream(CStream &out, int *version) const
 		out << size_x << size_y << x_min << x_max << y_min << y_max << resolution;
 		ASSERT_(size_x*size_y==map.size());
 
+		// The cells, row by row:
+		for (uint32_t y=0;y<size_y;y++)
+		{
 #ifdef OCCUPANCY_GRIDMAP_CELL_SIZE_8BITS
-		out.WriteBuffer(&map[0], sizeof(map[0])*size_x*size_y);
+			out.WriteBuffer(map.getRow(y), sizeof(cellType)*size_x);
 #else
-		out.WriteBufferFixEndianness(&map[0], size_x*size_y);
+			out.WriteBufferFixEndianness(map.getRow(y), size_x);
 #endif
+		}
 
 		// insertionOptions:
 		out <<	insertionOptions.mapAltitude
@@ -155,11 +159,14 @@ void  COccupancyGridMap2D::readFromStream(CStream &in, int version)
 			if (bitsPerCellStream==MyBitsPerCell)
 			{
 				// Perfect:
+				for (uint32_t y=0;y<size_y;y++)
+				{
 			#ifdef OCCUPANCY_GRIDMAP_CELL_SIZE_8BITS
-				in.ReadBuffer(&map[0], sizeof(map[0])*map.size());
+					in.ReadBuffer(map.getRowWritable(y), sizeof(cellType)*size_x);
 			#else
-				in.ReadBufferFixEndianness(&map[0], map.size());
+					in.ReadBufferFixEndianness(map.getRowWritable(y), size_x);
 			#endif
+				}
 			}
 			else
 			{
@@ -170,43 +177,50 @@ void  COccupancyGridMap2D::readFromStream(CStream &in, int version)
 				std::vector<uint16_t>    auxMap( map.size() );
 				in.ReadBuffer(&auxMap[0], sizeof(auxMap[0])*auxMap.size());
 
-				size_t  i, N = map.size();
-				uint8_t         *ptrTrg = (uint8_t*)&map[0];
 				const uint16_t  *ptrSrc = (const uint16_t*)&auxMap[0];
-				for (i=0;i<N;i++)
-					*ptrTrg++ = (*ptrSrc++) >> 8;
+				for (uint32_t y=0;y<size_y;y++)
+				{
+					uint8_t         *ptrTrg = (uint8_t*)map.getRowWritable(y);
+					for (uint32_t x=0;x<size_x;x++)
+						*ptrTrg++ = (*ptrSrc++) >> 8;
+				}
 #			else
 				// We are 16-bit, stream is 8-bit
 				ASSERT_(bitsPerCellStream==8);
 				std::vector<uint8_t>    auxMap( map.size() );
 				in.ReadBuffer(&auxMap[0], sizeof(auxMap[0])*auxMap.size());
 
-				size_t  i, N = map.size();
-				uint16_t       *ptrTrg = (uint16_t*)&map[0];
 				const uint8_t  *ptrSrc = (const uint8_t*)&auxMap[0];
-				for (i=0;i<N;i++)
-					*ptrTrg++ = (*ptrSrc++) << 8;
+				for (uint32_t y=0;y<size_y;y++)
+				{
+					uint16_t       *ptrTrg = (uint16_t*)map.getRowWritable(y);
+					for (uint32_t x=0;x<size_x;x++)
+						*ptrTrg++ = (*ptrSrc++) << 8;
+				}
 #			endif
 			}
 
 			// If we are converting an old dump, convert from probabilities to log-odds:
 			if (version<3)
 			{
-				size_t  i, N = map.size();
-				cellType  *ptr = &map[0];
-				for (i=0;i<N;i++)
+				for (uint32_t y=0;y<size_y;y++)
 				{
-					double p = cellTypeUnsigned(*ptr) * (1.0f/0xFF);
-					if (p<0)
-						p=0;
-					if (p>1)
-						p=1;
-					*ptr++ = p2l( p );
+					cellType  *ptr = map.getRowWritable(y);
+					for (uint32_t x=0;x<size_x;x++)
+					{
+						double p = cellTypeUnsigned(*ptr) * (1.0f/0xFF);
+						if (p<0)
+							p=0;
+						if (p>1)
+							p=1;
+						*ptr++ = p2l( p );
+					}
 				}
 			}
 
 			// For the precomputed likelihood trick:
 			precomputedLikelihoodToBeRecomputed = true;
+			m_simul_dist_outdated = true;
 
 			if (version>=1)
 			{
@@ -296,6 +310,7 @@ bool  COccupancyGridMap2D::loadFromBitmap(const mrpt::utils::CImage &imgFl, floa
 
 	// For the precomputed likelihood trick:
 	precomputedLikelihoodToBeRecomputed = true;
+	m_simul_dist_outdated = true;
 
 	size_t bmpWidth = imgFl.getWidth();
 	size_t bmpHeight = imgFl.getHeight();
@@ -13,6 +13,7 @@
 #include <mrpt/slam/CObservation2DRangeScan.h>
 #include <mrpt/slam/CObservationRange.h>
 #include <mrpt/slam/CSimplePointsMap.h>
+#include <mrpt/system/parallelization.h>
 
 
 using namespace mrpt;
@@ -350,105 +351,141 @@ double	 COccupancyGridMap2D::computeObservationLikelihood_MI(
 	MRPT_END
  }
 
+namespace
+{
+	/** Computes the log-likelihood of a range scan with the rayTracing method for a set of sensor poses (see mrpt::system::parallel_for).
+	  *  Rays are simulated exactly as in COccupancyGridMap2D::laserScanSimulator() with decimation, but only those with a valid measured range. */
+	struct TRayTracingLikelihoodBody
+	{
+		const COccupancyGridMap2D *grid;
+		const CObservation2DRangeScan *obs;
+		const mrpt::math::TPose2D *sensorPoses; //!< Sensor poses, with the direction of the first ray as "phi"
+		unsigned int decimation;
+		double Aang; //!< Angular increment between simulated rays
+		unsigned int max_ray_len;
+		float free_thres;
+		bool use_dist_fields; //!< Whether to skip free cells with the grid distance fields (see COccupancyGridMap2D::simulateScanRayFast)
+		double stdSqrt2;
+		double *out_log_liks;
+
+		TRayTracingLikelihoodBody(const COccupancyGridMap2D *grid_, const CObservation2DRangeScan *obs_, const float threshold, const int decimation_, const float stdHit) :
+			grid(grid_), obs(obs_), sensorPoses(NULL), decimation(decimation_), max_ray_len(0), use_dist_fields(true), out_log_liks(NULL)
+		{
+			ASSERT_(decimation_>=1)
+			const size_t N = obs->scan.size();
+			const double AA = obs->rightToLeft ? (obs->aperture / N) : -(obs->aperture / N);
+			Aang = AA*decimation;
+			max_ray_len = round(obs->maxRange / grid->getResolution());
+			free_thres = 1.0f - threshold;
+			double stdLaser = stdHit;
+			stdSqrt2 = sqrt(2.0f) * stdLaser;
+		}
+
+		/** The sensor pose for a given robot pose, with the direction of the first ray as "phi" */
+		mrpt::math::TPose2D getFirstRayPose(const CPose2D &robotPose) const
+		{
+			// Aproximation: grid is 2D !!!
+			const CPose2D sensorPose( CPose3D(robotPose) + obs->sensorPose );
+			return mrpt::math::TPose2D( sensorPose.x(),sensorPose.y(),
+				obs->rightToLeft ? sensorPose.phi() - 0.5*obs->aperture : sensorPose.phi() + 0.5*obs->aperture );
+		}
+
+		double evaluate(const mrpt::math::TPose2D &sp) const
+		{
+			const size_t nRays = obs->scan.size();
+			double ret = 1;
+			double A = sp.phi;
+			for (size_t j=0;j<nRays;j+=decimation,A+=Aang)
+			{
+				// Only valid measured ranges are compared:
+				if (!obs->validRange[j]) continue;
+
+				float r_sim;
+				bool  valid;
+				grid->simulateScanRayFast(sp.x,sp.y,A, r_sim,valid, max_ray_len,free_thres, use_dist_fields);
+
+				const float r_obs = obs->scan[j];
+				const double likelihood = 0.1/obs->maxRange + 0.9*exp( -square( min((float)fabs(r_sim-r_obs),2.0f)/stdSqrt2) );
+				ret += log(likelihood);
+			}
+			return ret;
+		}
+
+		void operator()(const mrpt::system::BlockedRange &r) const
+		{
+			for (int k=r.begin();k<r.end();k++)
+				out_log_liks[k] = evaluate(sensorPoses[k]);
+		}
+	};
+
+	const float RAYTRACING_OCCUPIED_THRESHOLD = 0.45f; //!< The cells threshold used to simulate the rays in the rayTracing method
+}
+
+/*---------------------------------------------------------------
+			computeObservationLikelihood_rayTracing
+---------------------------------------------------------------*/
 double	 COccupancyGridMap2D::computeObservationLikelihood_rayTracing(
 			const CObservation		*obs,
 			const CPose2D				&takenFrom )
 {
-	 double		ret=0;
+	// This function depends on the observation type:
+	// -----------------------------------------------------
+	if ( obs->GetRuntimeClass() != CLASS_ID(CObservation2DRangeScan) )
+		return 0;
 
-	 // This function depends on the observation type:
-	 // -----------------------------------------------------
-	if ( obs->GetRuntimeClass() == CLASS_ID(CObservation2DRangeScan) )
-	 {
-		 // Observation is a laser range scan:
-		 // -------------------------------------------
-		const CObservation2DRangeScan		*o = static_cast<const CObservation2DRangeScan*>( obs );
-		 CObservation2DRangeScan		simulatedObs;
+	// Observation is a laser range scan:
+	// -------------------------------------------
+	const CObservation2DRangeScan		*o = static_cast<const CObservation2DRangeScan*>( obs );
 
-		// Insert only HORIZONTAL scans, since the grid is supposed to
-		//  be a horizontal representation of space.
-		if (!o->isPlanarScan(insertionOptions.horizontalTolerance)) return 0.5;	// NO WAY TO ESTIMATE NON HORIZONTAL SCANS!!
+	// Insert only HORIZONTAL scans, since the grid is supposed to
+	//  be a horizontal representation of space.
+	if (!o->isPlanarScan(insertionOptions.horizontalTolerance)) return 0.5;	// NO WAY TO ESTIMATE NON HORIZONTAL SCANS!!
 
-		 // The number of simulated rays will be original range scan rays / DOWNRATIO
-		 int		decimation = likelihoodOptions.rayTracing_decimation;
-		 int		nRays     = o->scan.size();
-
-		 // Perform simulation using same parameters than real observation:
-		 simulatedObs.aperture = o->aperture;
-		 simulatedObs.maxRange = o->maxRange;
-		 simulatedObs.rightToLeft = o->rightToLeft;
-		 simulatedObs.sensorPose = o->sensorPose;
-
-		 // Performs the scan simulation:
-		 laserScanSimulator(
-			simulatedObs,		// The in/out observation
-			takenFrom,			// robot pose
-			0.45f,				// Cells threshold
-			nRays,				// Scan length
-			0,
-			decimation	);
-
-		 /** /
-		 {
-			FILE	*f;
-
-			f=os::fopen("scan_sim.txt","wt");
-			for (int i=0;i<nRays;i++) os::fprintf(f,"%f ",simulatedObs.validRange[i] ? simulatedObs.scan[i]:0);
-			os::fclose(f);
-			f=os::fopen("scan_meas.txt","wt");
-			for (i=0;i<nRays;i++) os::fprintf(f,"%f ",o->validRange[i] ? o->scan[i]:0);
-			os::fclose(f);
-		 }
-		 / **/
-
-		 double		stdLaser   = likelihoodOptions.rayTracing_stdHit;
-		 double		stdSqrt2 = sqrt(2.0f) * stdLaser;
-
-		 // Compute likelihoods:
-		 ret = 1;
-		 //bool		useDF = likelihoodOptions.rayTracing_useDistanceFilter;
-		 float		r_sim,r_obs;
-		 double		likelihood;
-
-		 for (int j=0;j<nRays;j+=decimation)
-		 {
-			// Simulated and measured ranges:
-			r_sim = simulatedObs.scan[j];
-			r_obs = o->scan[ j ];
-
-			// Is a valid range?
-			if ( o->validRange[j] )
-			{
-				likelihood = 0.1/o->maxRange + 0.9*exp( -square( min((float)fabs(r_sim-r_obs),2.0f)/stdSqrt2) );
-				ret += log(likelihood);
-				//printf("Sim=%f\tReal=%f\tlik=%f\n",r_sim,r_obs,likelihood);
-			}
+	// Compare the valid ranges with those simulated with the same parameters than the real observation,
+	//  one out of "rayTracing_decimation":
+	TRayTracingLikelihoodBody body(this,o, RAYTRACING_OCCUPIED_THRESHOLD, likelihoodOptions.rayTracing_decimation, likelihoodOptions.rayTracing_stdHit);
+	// Don't rebuild the distance fields for just one pose (e.g. between insertions of observations), only use them if available:
+	body.use_dist_fields = simulatorDistanceFieldsUpToDate(body.free_thres);
 
-			//if ( r_sim>0 &&
-			//	simulatedObs.validRange[j] &&
-			//	o->validRange[j] )
-			//{
-			//	// Consider this measurement?
-			//	if (!useDF || r_obs>=r_sim)
-			//	{
-			//		// UPDATE ----------------------
-			//		likelihood = 0.1 + 0.9*exp( -square((r_sim-r_obs)/stdSqrt2) );
-			//		ret *= likelihood;
-			//		//printf("Sim=%f\tReal=%f\tlik=%f\n",r_sim,r_obs,likelihood);
-			//		// -----------------------------
-			//	}
-			//}
-			//else
-			//{
-			//	// Likelihood of unknown range:
-			//	ret *= 1/o->maxRange;
-			//}
-		 }
-	 }
+	return body.evaluate( body.getFirstRayPose(takenFrom) );
+}
 
-	//printf("\t\t\t\tLIKELIHOOD=%e\n",ret);
+/*---------------------------------------------------------------
+			computeObservationLikelihood_rayTracingBatch
+---------------------------------------------------------------*/
+void  COccupancyGridMap2D::computeObservationLikelihood_rayTracingBatch(
+	const CObservation2DRangeScan			&obs,
+	const std::vector<mrpt::math::TPose2D>	&robotPoses,
+	std::vector<double>						&out_log_liks ) const
+{
+	MRPT_START
+
+	const size_t nPoses = robotPoses.size();
+	out_log_liks.resize(nPoses);
+	if (!nPoses) return;
+
+	// The same checks than in computeObservationLikelihood():
+	if (!obs.isPlanarScan(insertionOptions.horizontalTolerance) ||
+		(insertionOptions.useMapAltitude && fabs(insertionOptions.mapAltitude - obs.sensorPose.z() ) > 0.01) )
+	{
+		out_log_liks.assign(nPoses, -10);
+		return;
+	}
+
+	TRayTracingLikelihoodBody body(this,&obs, RAYTRACING_OCCUPIED_THRESHOLD, likelihoodOptions.rayTracing_decimation, likelihoodOptions.rayTracing_stdHit);
+
+	// Must be done here, before entering the parallel section:
+	updateSimulatorDistanceFields(body.free_thres);
+
+	std::vector<mrpt::math::TPose2D> sensorPoses(nPoses);
+	for (size_t k=0;k<nPoses;k++)
+		sensorPoses[k] = body.getFirstRayPose( CPose2D(robotPoses[k]) );
 
-	 return ret;
+	body.sensorPoses = &sensorPoses[0];
+	body.out_log_liks = &out_log_liks[0];
+	mrpt::system::parallel_for( mrpt::system::BlockedRange(0,static_cast<int>(nPoses),4), body );
+
+	MRPT_END
 }
 /**/
 
@@ -552,82 +589,59 @@ double	 COccupancyGridMap2D::computeLikelihoodField_Thrun( const CPointsMap	*pm,
 
 	double		ret;
 	size_t		N = pm->getPointsCount();
-	int		K = (int)ceil(likelihoodOptions.LF_maxCorrsDistance/*m*/ / resolution);	// The size of the checking area for matchings:
 
 	bool		Product_T_OrSum_F = !likelihoodOptions.LF_alternateAverageMethod;
 
 	if (!N)
 	{
-		//printf("[COccupancyGridMap2D::computeLikelihoodField_Thrun] There are no points in the map!!!");
-		//mrpt::system::pause();
 		return -100; // No way to estimate this likelihood!!
 	}
 
-	// Compute the likelihoods for each point:
-	ret = 0; //Product_T_OrSum_F ? 1e300:0;
-
-	float		stdHit	= likelihoodOptions.LF_stdHit;
-	float		zHit	= likelihoodOptions.LF_zHit;
-	float		zRandom	= likelihoodOptions.LF_zRandom;
-	float		zRandomMaxRange	= likelihoodOptions.LF_maxRange;
-	float		zRandomTerm = zRandom / zRandomMaxRange;
-	float		Q = -0.5f / square(stdHit);
-	int			M = 0;
-
-	unsigned int	size_x_1 = size_x-1;
-	unsigned int	size_y_1 = size_y-1;
+	// Make sure the table of distances to the closest obstacles is up to date:
+	updateLikelihoodField();
 
-	// Aux. variables for the "for j" loop:
-	double		thisLik;
-	double		maxCorrDist_sq = square(likelihoodOptions.LF_maxCorrsDistance);
-	double		minimumLik = zRandomTerm  + zHit * exp( Q * maxCorrDist_sq );
-	double		ccos,ssin;
-	float		occupiedMinDist;
+	// Compute the likelihoods for each point:
+	ret = 0;
 
-#define LIK_LF_CACHE_INVALID    (66)
+	const float	stdHit	= likelihoodOptions.LF_stdHit;
+	const float	zHit	= likelihoodOptions.LF_zHit;
+	const float	zRandom	= likelihoodOptions.LF_zRandom;
+	const float	zRandomMaxRange	= likelihoodOptions.LF_maxRange;
+	const float	zRandomTerm = zRandom / zRandomMaxRange;
+	const float	Q = -0.5f / square(stdHit);
+	int			M = 0;
 
-    if (likelihoodOptions.enableLikelihoodCache)
-    {
-        // Reset the precomputed likelihood values map
-        if (precomputedLikelihoodToBeRecomputed)
-        {
-			if (map.size())
-					precomputedLikelihood.assign( map.size(),LIK_LF_CACHE_INVALID);
-			else	precomputedLikelihood.clear();
+	const unsigned int	size_x_1 = size_x-1;
+	const unsigned int	size_y_1 = size_y-1;
 
-			precomputedLikelihoodToBeRecomputed = false;
-        }
-    }
+	const double	maxCorrDist_sq = square(likelihoodOptions.LF_maxCorrsDistance);
+	const double	minimumLik = zRandomTerm  + zHit * exp( Q * maxCorrDist_sq );
+	const bool		useCache = likelihoodOptions.enableLikelihoodCache;
+	double			thisLik;
 
-	cellType	thresholdCellValue = p2l(0.5f);
 	int			decimation = likelihoodOptions.LF_decimation;
-
-	const double _resolution = this->resolution;
-	const double constDist2DiscrUnits = 100 / (_resolution * _resolution);
-	const double constDist2DiscrUnits_INV = 1.0 / constDist2DiscrUnits;
-
-
 	if (N<10) decimation = 1;
 
+	double		ccos=1,ssin=0;
+	if (relativePose)
+	{
+#ifdef HAVE_SINCOS
+		::sincos(relativePose->phi(), &ssin,&ccos);
+#else
+		ccos = cos(relativePose->phi());
+		ssin = sin(relativePose->phi());
+#endif
+	}
+
 	TPoint2D	pointLocal;
 	TPoint2D	pointGlobal;
 
 	for (size_t j=0;j<N;j+= decimation)
 	{
-
-		occupiedMinDist = maxCorrDist_sq; // The max.distance
-
 		// Get the point and pass it to global coordinates:
 		if (relativePose)
 		{
 			pm->getPoint(j,pointLocal);
-			//pointGlobal = *relativePose + pointLocal;
-#ifdef HAVE_SINCOS
-			::sincos(relativePose->phi(), &ssin,&ccos);
-#else
-			ccos = cos(relativePose->phi());
-			ssin = sin(relativePose->phi());
-#endif
 			pointGlobal.x = relativePose->x() + pointLocal.x * ccos - pointLocal.y * ssin;
 			pointGlobal.y = relativePose->y() + pointLocal.x * ssin + pointLocal.y * ccos;
 		}
@@ -637,10 +651,9 @@ double	 COccupancyGridMap2D::computeLikelihoodField_Thrun( const CPointsMap	*pm,
 		}
 
 		// Point to cell indixes
-		int cx = x2idx( pointGlobal.x );
-		int cy = y2idx( pointGlobal.y );
+		const int cx = x2idx( pointGlobal.x );
+		const int cy = y2idx( pointGlobal.y );
 
-		// Precomputed table:
 		// Tip: Comparison cx<0 is implicit in (unsigned)(x)>size...
 		if ( static_cast<unsigned>(cx)>=size_x_1 || static_cast<unsigned>(cy)>=size_y_1 )
 		{
@@ -649,68 +662,10 @@ double	 COccupancyGridMap2D::computeLikelihoodField_Thrun( const CPointsMap	*pm,
 		}
 		else
 		{
-			// We are into the map limits:
-            if (likelihoodOptions.enableLikelihoodCache)
-            {
-                thisLik = precomputedLikelihood[ cx+cy*size_x ];
-            }
-
-			if (!likelihoodOptions.enableLikelihoodCache || thisLik==LIK_LF_CACHE_INVALID )
-			{
-				// Compute now:
-				// -------------
-				// Find the closest occupied cell in a certain range, given by K:
-				int xx1 = max(0,cx-K);
-				int xx2 = min(size_x_1,(unsigned)(cx+K));
-				int yy1 = max(0,cy-K);
-				int yy2 = min(size_y_1,(unsigned)(cy+K));
-
-				/** /
-				for (yy=yy1;yy<=yy2;yy++)
-					for (xx=xx1;xx<=xx2;xx++)
-						if ( map[xx+yy*size_x] < thresholdCellValue )
-							occupiedMinDist = min( occupiedMinDist, square(idx2x(xx)-pointGlobal_x)+square(idx2y(yy)-pointGlobal_y) );
-				*/
-
-				// Optimized code: this part will be invoked a *lot* of times:
-				{
-					cellType  *mapPtr  = &map[xx1+yy1*size_x]; // Initial pointer position
-					unsigned   incrAfterRow = size_x - ((xx2-xx1)+1);
-
-					signed int Ax0 = 10*(xx1-cx);
-					signed int Ay  = 10*(yy1-cy);
-
-					unsigned int occupiedMinDistInt = mrpt::utils::round( maxCorrDist_sq * constDist2DiscrUnits );
-
-					for (int yy=yy1;yy<=yy2;yy++)
-					{
-						unsigned int Ay2 = square((unsigned int)(Ay)); // Square is faster with unsigned.
-						signed short Ax=Ax0;
-						cellType  cell;
-
-						for (int xx=xx1;xx<=xx2;xx++)
-						{
-							if ( (cell =*mapPtr++) < thresholdCellValue )
-							{
-								unsigned int d = square((unsigned int)(Ax)) + Ay2;
-								keep_min(occupiedMinDistInt, d);
-							}
-							Ax += 10;
-						}
-						// Go to (xx1,yy++)
-						mapPtr += incrAfterRow;
-						Ay += 10;
-					}
-
-					occupiedMinDist = occupiedMinDistInt * constDist2DiscrUnits_INV ;
-				}
-
-				thisLik = zRandomTerm  + zHit * exp( Q * occupiedMinDist );
-
-                if (likelihoodOptions.enableLikelihoodCache)
-                    // And save it into the table and into "thisLik":
-                    precomputedLikelihood[ cx+cy*size_x ] = thisLik;
-			}
+			// We are into the map limits: just look up the distance to the closest obstacle.
+			if (useCache)
+					thisLik = precomputedLikelihood(cx,cy);
+			else	thisLik = zRandomTerm  + zHit * exp( Q * m_LF_closest_obstacle_sqdist(cx,cy) );
 		}
 
 		// Update the likelihood:
@@ -733,6 +688,139 @@ double	 COccupancyGridMap2D::computeLikelihoodField_Thrun( const CPointsMap	*pm,
 	MRPT_END
 }
 
+/*---------------------------------------------------------------
+					updateLikelihoodField
+ ---------------------------------------------------------------*/
+void  COccupancyGridMap2D::updateLikelihoodField()
+{
+	MRPT_START
+
+	const float maxCorrDist = likelihoodOptions.LF_maxCorrsDistance;
+	const bool  useCache = likelihoodOptions.enableLikelihoodCache;
+
+	if (precomputedLikelihoodToBeRecomputed ||
+		m_LF_closest_obstacle_sqdist.getSizeX()!=size_x || m_LF_closest_obstacle_sqdist.getSizeY()!=size_y ||
+		m_LF_built_maxCorrsDistance!=maxCorrDist ||
+		(useCache && (precomputedLikelihood.getSizeX()!=size_x || precomputedLikelihood.getSizeY()!=size_y)) )
+	{
+		// Rebuild the whole table:
+		m_LF_closest_obstacle_sqdist.resize(size_x,size_y);
+		if (useCache)
+				precomputedLikelihood.resize(size_x,size_y);
+		else	precomputedLikelihood.clear();
+
+		if (!map.empty())
+			computeLikelihoodFieldWindow(0,size_x-1,0,size_y-1, 0,size_x-1,0,size_y-1);
+
+		m_LF_built_maxCorrsDistance = maxCorrDist;
+		precomputedLikelihoodToBeRecomputed = false;
+	}
+	else if (m_LF_dirty_x_min<=m_LF_dirty_x_max && m_LF_dirty_y_min<=m_LF_dirty_y_max)
+	{
+		// Only the cells closer than LF_maxCorrsDistance to a modified cell may change their (saturated)
+		//  distance, and those only depend on the obstacles closer than twice that distance:
+		const int K = (int)ceil(maxCorrDist/resolution);
+		const int last_x = size_x-1, last_y = size_y-1;
+		if (!useCache)
+			precomputedLikelihood.clear(); // It would become outdated: force rebuilding it if the cache is enabled again
+		computeLikelihoodFieldWindow(
+			std::max(0,m_LF_dirty_x_min-2*K), std::min(last_x,m_LF_dirty_x_max+2*K),
+			std::max(0,m_LF_dirty_y_min-2*K), std::min(last_y,m_LF_dirty_y_max+2*K),
+			std::max(0,m_LF_dirty_x_min-K), std::min(last_x,m_LF_dirty_x_max+K),
+			std::max(0,m_LF_dirty_y_min-K), std::min(last_y,m_LF_dirty_y_max+K) );
+	}
+	else return; // Up to date: do not write anything, so concurrent likelihood evaluations are safe.
+
+	// Nothing pending now:
+	m_LF_dirty_x_min = m_LF_dirty_y_min = 0;
+	m_LF_dirty_x_max = m_LF_dirty_y_max = -1;
+
+	MRPT_END
+}
+
+namespace
+{
+	/** 1D squared distance transform of a sampled function (Felzenszwalb & Huttenlocher, 2004).
+	  * \param f Input values (size n)  \param d Output (size n)  \param v,z Aux. buffers of sizes n and n+1 */
+	void sqdistanceTransform1D(const float *f, const int n, float *d, int *v, double *z)
+	{
+		int k = 0;
+		v[0] = 0;
+		z[0] = -std::numeric_limits<double>::max();
+		z[1] =  std::numeric_limits<double>::max();
+		for (int q=1;q<n;q++)
+		{
+			double s = ((f[q]+double(q)*q)-(f[v[k]]+double(v[k])*v[k]))/(2.0*(q-v[k]));
+			while (s <= z[k])
+			{
+				k--;
+				s = ((f[q]+double(q)*q)-(f[v[k]]+double(v[k])*v[k]))/(2.0*(q-v[k]));
+			}
+			k++;
+			v[k] = q;
+			z[k] = s;
+			z[k+1] = std::numeric_limits<double>::max();
+		}
+		k = 0;
+		for (int q=0;q<n;q++)
+		{
+			while (z[k+1]<q) k++;
+			d[q] = square(q-v[k]) + f[v[k]];
+		}
+	}
+}
+
+/*---------------------------------------------------------------
+					computeLikelihoodFieldWindow
+ ---------------------------------------------------------------*/
+void  COccupancyGridMap2D::computeLikelihoodFieldWindow(int x0, int x1, int y0, int y1, int wx0, int wx1, int wy0, int wy1)
+{
+	const int w = x1-x0+1, h = y1-y0+1;
+	if (w<=0 || h<=0) return;
+
+	const cellType thresholdCellValue = p2l(0.5f);
+	// Any value larger than the largest squared distance within the window:
+	const float INF_DIST = float(square(w)+square(h));
+
+	const int nMax = std::max(w,h);
+	std::vector<float>  buf(w*h), f(nMax), d(nMax);
+	std::vector<int>    v(nMax);
+	std::vector<double> z(nMax+1);
+
+	// 1st pass: distance along each column to the closest occupied cell:
+	for (int x=0;x<w;x++)
+	{
+		for (int y=0;y<h;y++)
+			f[y] = (map(x0+x,y0+y) < thresholdCellValue) ? 0 : INF_DIST;
+
+		sqdistanceTransform1D(&f[0],h,&d[0],&v[0],&z[0]);
+		for (int y=0;y<h;y++)
+			buf[x+y*w] = d[y];
+	}
+
+	// 2nd pass: along rows, and save results within the output window:
+	const float	res2 = square(resolution);
+	const float	maxCorrDist_sq = square(likelihoodOptions.LF_maxCorrsDistance);
+	const bool	useCache = likelihoodOptions.enableLikelihoodCache;
+	const float	zRandomTerm = likelihoodOptions.LF_zRandom / likelihoodOptions.LF_maxRange;
+	const float	zHit = likelihoodOptions.LF_zHit;
+	const float	Q = -0.5f / square(likelihoodOptions.LF_stdHit);
+
+	for (int cy=wy0;cy<=wy1;cy++)
+	{
+		sqdistanceTransform1D(&buf[(cy-y0)*w],w,&d[0],&v[0],&z[0]);
+		float *sqdistRow = m_LF_closest_obstacle_sqdist.getRowWritable(cy);
+		float *likRow    = useCache ? precomputedLikelihood.getRowWritable(cy) : NULL;
+		for (int cx=wx0;cx<=wx1;cx++)
+		{
+			const float dist2 = std::min( d[cx-x0]*res2, maxCorrDist_sq );
+			sqdistRow[cx] = dist2;
+			if (useCache)
+				likRow[cx] = zRandomTerm + zHit * exp( Q * dist2 );
+		}
+	}
+}
+
 /*---------------------------------------------------------------
 					computeLikelihoodField_II
  ---------------------------------------------------------------*/
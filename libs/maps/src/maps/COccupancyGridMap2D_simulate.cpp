@@ -14,6 +14,7 @@
 #include <mrpt/slam/CObservationRange.h>
 
 #include <mrpt/random.h>
+#include <mrpt/system/parallelization.h>
 
 using namespace mrpt;
 using namespace mrpt::slam;
@@ -186,3 +187,257 @@ inline void COccupancyGridMap2D::simulateScanRay(
 			out_range+=  noiseStd*randomGenerator.drawGaussian1D_normalized();
 	}
 }
+
+void COccupancyGridMap2D::simulateScanRayFast(
+	const double start_x,const double start_y,const double angle_direction,
+	float &out_range,bool &out_valid,
+	const unsigned int max_ray_len,
+	const float threshold_free,
+	const bool use_dist_fields ) const
+{
+	// Unit vector in the directorion of the ray:
+#ifdef HAVE_SINCOS
+	double Arx,Ary;
+	::sincos(angle_direction, &Ary,&Arx);
+	Arx*=resolution;
+	Ary*=resolution;
+#else
+	const double Arx =  cos(angle_direction)*resolution;
+	const double Ary =  sin(angle_direction)*resolution;
+#endif
+
+	// The ray is traced exactly as in simulateScanRay(), but from a cell at a chessboard distance D
+	//  from the closest stop cell, the next D-2 cells are safely free, so they are not checked.
+	//  The ray coordinates are still accumulated step by step, so all results are identical.
+	unsigned int ray_len=0;
+	double rx=start_x;
+	double ry=start_y;
+	float hitCellOcc = 0.5f;
+	int x,y;
+	bool out_of_grid = false;
+	const uint8_t *dist_occ = use_dist_fields ? &(*m_simul_dist_occ)[0] : NULL;
+	for (;;)
+	{
+		x=x2idx(rx); y=y2idx(ry);
+		// Tip: if x<0, (unsigned)(x) will also be >>> size_x ;-)
+		if (static_cast<unsigned>(x)>=size_x || static_cast<unsigned>(y)>=size_y) { out_of_grid=true; break; }
+		if ( (hitCellOcc=l2p(map(x,y)))<=threshold_free || ray_len>=max_ray_len )
+			break;
+
+		unsigned int nSteps = dist_occ ? dist_occ[x+y*size_x] : 1;
+		nSteps = nSteps>1 ? nSteps-1 : 1;
+		mrpt::utils::keep_min(nSteps, max_ray_len-ray_len);
+		ray_len+=nSteps;
+		for ( ;nSteps>0;nSteps--) { rx+=Arx; ry+=Ary; }
+	}
+
+	if (!out_of_grid && !(fabs(hitCellOcc-0.5)<0.01f))
+	{ 	// The normal case:
+		out_range = ray_len*resolution;
+		out_valid = ray_len<max_ray_len;
+		return;
+	}
+
+	// Invalid range: look for the first unknown cell along the ray, skipping cells far from unknown ones:
+	out_valid = false;
+	unsigned int firstUnknownCellDist=max_ray_len+1;
+	const uint8_t *dist_any = use_dist_fields ? &(*m_simul_dist_any)[0] : NULL;
+	rx=start_x;
+	ry=start_y;
+	for (unsigned int i=0;i<ray_len; )
+	{
+		x=x2idx(rx); y=y2idx(ry);
+		if (static_cast<unsigned>(x)>=size_x || static_cast<unsigned>(y)>=size_y) break;
+		if ( fabs(l2p(map(x,y))-0.5)<0.01f ) { firstUnknownCellDist=i; break; }
+
+		unsigned int nSteps = dist_any ? dist_any[x+y*size_x] : 1;
+		nSteps = nSteps>1 ? nSteps-1 : 1;
+		mrpt::utils::keep_min(nSteps, ray_len-i);
+		i+=nSteps;
+		for ( ;nSteps>0;nSteps--) { rx+=Arx; ry+=Ary; }
+	}
+
+	if (firstUnknownCellDist<ray_len)
+			out_range = firstUnknownCellDist*resolution;
+	else	out_range = ray_len*resolution;
+}
+
+namespace
+{
+	/** Computes in-place the exact chessboard distance transform of a grid with "0" at the seed cells and 255 elsewhere,
+	  *  taking the outside of the grid as seeds too. Distances are saturated at 255. */
+	void chessboardDistanceTransform(uint8_t *d, const int sx, const int sy)
+	{
+		// Distance to the outside of the grid:
+		for (int y=0;y<sy;y++)
+			for (int x=0;x<sx;x++)
+			{
+				uint8_t &v = d[x+y*sx];
+				const int db = std::min( std::min(x+1,sx-x), std::min(y+1,sy-y) );
+				if (db<v) v=db;
+			}
+		// Forward pass:
+		for (int y=0;y<sy;y++)
+		{
+			uint8_t *row = d+y*sx, *prev = row-sx;
+			for (int x=0;x<sx;x++)
+			{
+				unsigned int v = row[x];
+				if (!v) continue;
+				if (x>0) v = std::min(v, row[x-1]+1u);
+				if (y>0)
+				{
+					v = std::min(v, prev[x]+1u);
+					if (x>0)    v = std::min(v, prev[x-1]+1u);
+					if (x<sx-1) v = std::min(v, prev[x+1]+1u);
+				}
+				row[x] = static_cast<uint8_t>(v);
+			}
+		}
+		// Backward pass:
+		for (int y=sy-1;y>=0;y--)
+		{
+			uint8_t *row = d+y*sx, *next = row+sx;
+			for (int x=sx-1;x>=0;x--)
+			{
+				unsigned int v = row[x];
+				if (!v) continue;
+				if (x<sx-1) v = std::min(v, row[x+1]+1u);
+				if (y<sy-1)
+				{
+					v = std::min(v, next[x]+1u);
+					if (x>0)    v = std::min(v, next[x-1]+1u);
+					if (x<sx-1) v = std::min(v, next[x+1]+1u);
+				}
+				row[x] = static_cast<uint8_t>(v);
+			}
+		}
+	}
+}
+
+/*---------------------------------------------------------------
+					updateSimulatorDistanceFields
+  ---------------------------------------------------------------*/
+void  COccupancyGridMap2D::updateSimulatorDistanceFields(const float threshold_free) const
+{
+	if (simulatorDistanceFieldsUpToDate(threshold_free))
+		return;
+
+	// Build new fields instead of overwriting the current ones, which may be shared with copies of this grid:
+	const size_t nCells = size_t(size_x)*size_y;
+	m_simul_dist_occ = stlplus::smart_ptr< std::vector<uint8_t> >( new std::vector<uint8_t>(nCells,255) );
+	m_simul_dist_any = stlplus::smart_ptr< std::vector<uint8_t> >( new std::vector<uint8_t>(nCells,255) );
+	if (nCells)
+	{
+		// Seeds: the cells where simulateScanRay() stops (occupied), and those which must be checked (unknown):
+		for (unsigned int y=0;y<size_y;y++)
+		{
+			const cellType *row = map.getRow(y);
+			uint8_t *occ = &(*m_simul_dist_occ)[y*size_x], *any = &(*m_simul_dist_any)[y*size_x];
+			for (unsigned int x=0;x<size_x;x++)
+			{
+				const float p = l2p(row[x]);
+				if (p<=threshold_free)
+					occ[x] = any[x] = 0;
+				else if (fabs(p-0.5)<0.01f)
+					any[x] = 0;
+			}
+		}
+		chessboardDistanceTransform(&(*m_simul_dist_occ)[0],size_x,size_y);
+		chessboardDistanceTransform(&(*m_simul_dist_any)[0],size_x,size_y);
+	}
+
+	m_simul_dist_threshold_free = threshold_free;
+	m_simul_dist_outdated = false;
+}
+
+namespace
+{
+	/** Body for mrpt::system::parallel_for(): simulates a range of rays of COccupancyGridMap2D::laserScanSimulatorBatch(), indexed as pose*N+ray */
+	struct TLaserSimulBatchBody
+	{
+		const COccupancyGridMap2D *grid;
+		const std::vector<mrpt::math::TPose2D> *sensorPoses; //!< Sensor poses, with the direction of the first ray as "phi"
+		size_t N;
+		double Aang; //!< Angular increment between rays
+		unsigned int max_ray_len;
+		float free_thres;
+		float *out_ranges;
+		char  *out_valid;
+
+		void operator()(const mrpt::system::BlockedRange &r) const
+		{
+			for (size_t k=r.begin();k<size_t(r.end()); )
+			{
+				const size_t idxPose = k/N;
+				size_t i = k%N;
+				const size_t i_end = std::min(N, i+size_t(r.end())-k);
+				const mrpt::math::TPose2D &sp = (*sensorPoses)[idxPose];
+
+				// Accumulate the angle just like laserScanSimulator() does:
+				double A = sp.phi;
+				for (size_t j=0;j<i;j++) A+=Aang;
+
+				for ( ;i<i_end;i++,k++,A+=Aang)
+				{
+					bool valid;
+					grid->simulateScanRayFast(sp.x,sp.y,A, out_ranges[k],valid, max_ray_len,free_thres);
+					out_valid[k] = valid ? 1:0;
+				}
+			}
+		}
+	};
+}
+
+/*---------------------------------------------------------------
+					laserScanSimulatorBatch
+  ---------------------------------------------------------------*/
+void  COccupancyGridMap2D::laserScanSimulatorBatch(
+		const std::vector<mrpt::math::TPose2D>	&robotPoses,
+		const CObservation2DRangeScan	&scan_params,
+		std::vector<float>				&out_ranges,
+		std::vector<char>				&out_valid,
+		float							threshold,
+		size_t							N ) const
+{
+	MRPT_START
+
+	const size_t nRays = robotPoses.size()*N;
+	out_ranges.resize(nRays);
+	out_valid.resize(nRays);
+	if (!nRays) return;
+
+	const float free_thres = 1.0f - threshold;
+	const unsigned int max_ray_len = round(scan_params.maxRange / resolution);
+
+	// Must be done here, before entering the parallel section:
+	updateSimulatorDistanceFields(free_thres);
+
+	// Sensor poses in global coordinates, and the direction of their first ray:
+	const double AA = scan_params.rightToLeft ? (scan_params.aperture / N) : -(scan_params.aperture / N);
+	std::vector<mrpt::math::TPose2D> sensorPoses(robotPoses.size());
+	for (size_t k=0;k<robotPoses.size();k++)
+	{
+		// Aproximation: grid is 2D !!!
+		const CPose2D sensorPose( CPose3D(CPose2D(robotPoses[k])) + scan_params.sensorPose );
+		sensorPoses[k].x = sensorPose.x();
+		sensorPoses[k].y = sensorPose.y();
+		sensorPoses[k].phi = scan_params.rightToLeft ?
+			sensorPose.phi() - 0.5*scan_params.aperture :
+			sensorPose.phi() + 0.5*scan_params.aperture;
+	}
+
+	TLaserSimulBatchBody body;
+	body.grid = this;
+	body.sensorPoses = &sensorPoses;
+	body.N = N;
+	body.Aang = AA;
+	body.max_ray_len = max_ray_len;
+	body.free_thres = free_thres;
+	body.out_ranges = &out_ranges[0];
+	body.out_valid = &out_valid[0];
+
+	mrpt::system::parallel_for( mrpt::system::BlockedRange(0,static_cast<int>(nRays),64), body );
+
+	MRPT_END
+}
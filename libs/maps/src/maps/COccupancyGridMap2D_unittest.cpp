@@ -9,6 +9,8 @@
 
 
 #include <mrpt/maps.h>
+#include <mrpt/random.h>
+#include <mrpt/system/parallelization.h>
 #include <gtest/gtest.h>
 
 using namespace mrpt;
@@ -47,3 +49,327 @@ TEST(COccupancyGridMap2DTests, insert2DScan)
 
 }
 
+
+// Reference implementation of the likelihood field: exhaustive search of the closest occupied cell.
+static double bruteForceLikelihoodField(const COccupancyGridMap2D &grid, const CPointsMap &pts, const CPose2D &pose)
+{
+	const COccupancyGridMap2D::TLikelihoodOptions &opts = grid.likelihoodOptions;
+	const double zRandomTerm = opts.LF_zRandom / opts.LF_maxRange;
+	const double Q = -0.5 / square(opts.LF_stdHit);
+	const double maxCorrDist_sq = square(opts.LF_maxCorrsDistance);
+	const COccupancyGridMap2D::cellType thres = COccupancyGridMap2D::p2l(0.5f);
+
+	double ret = 0;
+	for (size_t i=0;i<pts.size();i++)
+	{
+		TPoint2D pl,pg;
+		pts.getPoint(i,pl);
+		pose.composePoint(pl,pg);
+		const int cx = grid.x2idx(pg.x), cy = grid.y2idx(pg.y);
+
+		double d2 = maxCorrDist_sq;
+		if (cx>=0 && cy>=0 && cx<int(grid.getSizeX())-1 && cy<int(grid.getSizeY())-1)
+		{
+			for (unsigned int yy=0;yy<grid.getSizeY();yy++)
+				for (unsigned int xx=0;xx<grid.getSizeX();xx++)
+					if (grid.getRow(yy)[xx]<thres)
+						keep_min(d2, (square(int(xx)-cx)+square(int(yy)-cy))*square(grid.getResolution()) );
+		}
+		ret += log( zRandomTerm + opts.LF_zHit * exp(Q*d2) );
+	}
+	return ret;
+}
+
+TEST(COccupancyGridMap2DTests, likelihoodFieldDistanceTransform)
+{
+	// A synthetic scan:
+	CObservation2DRangeScan	scan;
+	scan.aperture = M_PIf;
+	scan.rightToLeft = true;
+	const size_t N = 181;
+	scan.scan.resize(N);
+	scan.validRange.resize(N, 1);
+	for (size_t i=0;i<N;i++)
+		scan.scan[i] = 3.0f + 1.5f*sin(i*0.1f);
+
+	COccupancyGridMap2D  grid(-10,10, -10,10, 0.10f);
+	grid.likelihoodOptions.LF_decimation = 1;
+	grid.likelihoodOptions.LF_maxCorrsDistance = 0.5f;
+	grid.likelihoodOptions.enableLikelihoodCache = false;  // Use the distance field directly
+	grid.insertObservation( &scan );
+
+	// Random points around:
+	mrpt::random::CRandomGenerator rnd(1234);
+	CSimplePointsMap pts;
+	for (int i=0;i<300;i++)
+		pts.insertPoint( rnd.drawUniform(-6,6), rnd.drawUniform(-6,6) );
+
+	const CPose2D pose(0.3,-0.2,DEG2RAD(10));
+
+	{
+		const double ref = bruteForceLikelihoodField(grid,pts,pose);
+		EXPECT_NEAR( ref, grid.computeLikelihoodField_Thrun(&pts,&pose), 1e-5*std::abs(ref) );
+	}
+
+	// Incremental update of the field after inserting a new observation:
+	const CPose3D pose2(1.0,0.5,0, DEG2RAD(30),0,0);
+	grid.insertObservation( &scan, &pose2 );
+	{
+		const double ref = bruteForceLikelihoodField(grid,pts,pose);
+		EXPECT_NEAR( ref, grid.computeLikelihoodField_Thrun(&pts,&pose), 1e-5*std::abs(ref) );
+
+		grid.likelihoodOptions.enableLikelihoodCache = true;
+		EXPECT_NEAR( ref, grid.computeLikelihoodField_Thrun(&pts,&pose), 1e-5*std::abs(ref) );
+	}
+
+	// Direct modification of cells, with and without the cache of likelihood values:
+	for (int useCache=0;useCache<2;useCache++)
+	{
+		grid.likelihoodOptions.enableLikelihoodCache = (useCache!=0);
+		for (int i=0;i<30;i++)
+		{
+			const int cx = grid.x2idx(rnd.drawUniform(-6,6)), cy = grid.y2idx(rnd.drawUniform(-6,6));
+			grid.setCell(cx,cy, 0.05f);  // New obstacles
+			grid.setCell(cx+2,cy, 0.95f);  // Free space, which may remove an obstacle
+		}
+		const double ref = bruteForceLikelihoodField(grid,pts,pose);
+		EXPECT_NEAR( ref, grid.computeLikelihoodField_Thrun(&pts,&pose), 1e-5*std::abs(ref) ) << "useCache=" << useCache;
+	}
+}
+
+TEST(COccupancyGridMap2DTests, copyOnWriteTiles)
+{
+	CObservation2DRangeScan	scan;
+	scan.aperture = M_PIf;
+	scan.rightToLeft = true;
+	scan.scan.assign(181, 2.0f);
+	scan.validRange.assign(181, 1);
+
+	COccupancyGridMap2D  grid(-20,20, -20,20, 0.10f);
+	grid.insertObservation( &scan );
+
+	// A copy shares all the tiles:
+	size_t nTiles, nShared;
+	COccupancyGridMap2D  grid2 = grid;
+	grid2.getSharedMemoryStats(nTiles,nShared);
+	EXPECT_EQ(nTiles, nShared);
+
+	// Inserting a scan far away only duplicates the affected tiles:
+	const CPose3D pose2(15.0,15.0,0, 0,0,0);
+	grid2.insertObservation( &scan, &pose2 );
+	grid2.getSharedMemoryStats(nTiles,nShared);
+	EXPECT_GT(nShared, 0u);
+	EXPECT_LT(nShared, nTiles);
+
+	// The original map is unchanged:
+	EXPECT_NEAR( 0.5f, grid.getPos(15.0f,15.0f), 0.01f );
+	EXPECT_GT( grid2.getPos(15.0f,15.0f), 0.5f );
+	for (unsigned int y=0;y<grid.getSizeY();y+=7)
+		for (unsigned int x=0;x<grid.getSizeX();x+=7)
+			if (std::abs(grid.idx2x(x)-15.0f)>3 || std::abs(grid.idx2y(y)-15.0f)>3)
+				EXPECT_EQ( grid.getCell(x,y), grid2.getCell(x,y) );
+}
+
+namespace
+{
+	// Evaluates the likelihood field in each grid, as a RBPF does with the maps of its particles:
+	struct TLikelihoodFieldBody
+	{
+		std::vector<COccupancyGridMap2D> &grids;
+		const CPointsMap &pts;
+		const CPose2D &pose;
+		std::vector<double> &out;
+		TLikelihoodFieldBody(std::vector<COccupancyGridMap2D> &g, const CPointsMap &p, const CPose2D &ps, std::vector<double> &o) : grids(g), pts(p), pose(ps), out(o) {}
+		void operator()(const mrpt::system::BlockedRange &r) const {
+			for (int i=r.begin();i<r.end();i++) out[i] = grids[i].computeLikelihoodField_Thrun(&pts,&pose);
+		}
+	};
+}
+
+TEST(COccupancyGridMap2DTests, copyOnWriteTilesConcurrentLikelihoodField)
+{
+	CObservation2DRangeScan	scan;
+	scan.aperture = M_PIf;
+	scan.rightToLeft = true;
+	scan.scan.assign(181, 3.0f);
+	scan.validRange.assign(181, 1);
+
+	COccupancyGridMap2D  grid(-10,10, -10,10, 0.10f);
+	grid.likelihoodOptions.LF_decimation = 1;
+	grid.likelihoodOptions.LF_maxCorrsDistance = 0.5f;
+	grid.insertObservation( &scan );
+
+	mrpt::random::CRandomGenerator rnd(4321);
+	CSimplePointsMap pts;
+	for (int i=0;i<100;i++)
+		pts.insertPoint( rnd.drawUniform(-5,5), rnd.drawUniform(-5,5) );
+	const CPose2D pose(0.3,-0.2,DEG2RAD(10));
+	const double lik0 = grid.computeLikelihoodField_Thrun(&pts,&pose);
+
+	// Copies which share all their tiles (cells and likelihood field), each with a few different obstacles:
+	const size_t N = 8;
+	std::vector<COccupancyGridMap2D> grids(N, grid);
+	for (size_t i=0;i<N;i++)
+		for (int k=0;k<10;k++)
+			grids[i].setCell( grid.x2idx(rnd.drawUniform(-5,5)), grid.y2idx(rnd.drawUniform(-5,5)), 0.05f );
+
+	// All of them unshare and update the same tiles of their likelihood fields at once:
+	std::vector<double> liks(N);
+	mrpt::system::setNumberOfParallelThreads(4); // Even on single-core machines
+	mrpt::system::parallel_for( mrpt::system::BlockedRange(0,N), TLikelihoodFieldBody(grids,pts,pose,liks) );
+	mrpt::system::setNumberOfParallelThreads(0);
+
+	for (size_t i=0;i<N;i++)
+	{
+		const double ref = bruteForceLikelihoodField(grids[i],pts,pose);
+		EXPECT_NEAR( ref, liks[i], 1e-5*std::abs(ref) ) << "grid #" << i;
+	}
+	// The original map is unchanged:
+	EXPECT_EQ( lik0, grid.computeLikelihoodField_Thrun(&pts,&pose) );
+}
+
+TEST(COccupancyGridMap2DTests, laserScanSimulatorBatch)
+{
+	// A map with free space, walls, obstacles and unknown regions:
+	COccupancyGridMap2D  grid(-10,10, -10,10, 0.05f);
+	grid.fill(0.5f);
+	for (unsigned int y=0;y<grid.getSizeY();y++)
+		for (unsigned int x=0;x<grid.getSizeX();x++)
+		{
+			const float px = grid.idx2x(x), py = grid.idx2y(y);
+			if (std::abs(px)<7 && std::abs(py)<6)
+				grid.setCell(x,y, (std::abs(px)>6.8f || std::abs(py)>5.8f) ? 0.1f : 0.9f);
+		}
+	mrpt::random::CRandomGenerator rnd(4321);
+	for (int i=0;i<40;i++)
+	{
+		const float ox = rnd.drawUniform(-6,6), oy = rnd.drawUniform(-5,5), r = rnd.drawUniform(0.05,0.5);
+		for (float dx=-r;dx<=r;dx+=0.02f)
+			for (float dy=-r;dy<=r;dy+=0.02f)
+				grid.setPos(ox+dx,oy+dy, (i%4) ? 0.05f : 0.5f);
+	}
+	// A door to the unknown:
+	for (float y=-1;y<1;y+=0.02f)
+		for (float x=6.7f;x<7.0f;x+=0.02f)
+			grid.setPos(x,y,0.9f);
+
+	CObservation2DRangeScan	scan;
+	scan.aperture = M_PIf;
+	scan.rightToLeft = true;
+	scan.maxRange = 8.0f;
+	scan.sensorPose = CPose3D(0.2,0.1,0, DEG2RAD(5),0,0);
+	const size_t N = 181;
+
+	std::vector<TPose2D> poses;
+	for (int i=0;i<50;i++)
+		poses.push_back( TPose2D( rnd.drawUniform(-11,11), rnd.drawUniform(-11,11), rnd.drawUniform(-M_PI,M_PI) ) );
+
+	std::vector<float> ranges;
+	std::vector<char>  valids;
+	mrpt::system::setNumberOfParallelThreads(4);
+	for (int pass=0;pass<2;pass++)
+	{
+		grid.laserScanSimulatorBatch(poses, scan, ranges, valids, 0.5f, N);
+		ASSERT_EQ(ranges.size(), N*poses.size());
+		ASSERT_EQ(valids.size(), N*poses.size());
+
+		for (size_t k=0;k<poses.size();k++)
+		{
+			grid.laserScanSimulator(scan, CPose2D(poses[k]), 0.5f, N);
+			for (size_t i=0;i<N;i++)
+			{
+				EXPECT_EQ(scan.scan[i], ranges[k*N+i]) << "pose #" << k << " ray #" << i;
+				EXPECT_EQ(scan.validRange[i], valids[k*N+i]) << "pose #" << k << " ray #" << i;
+			}
+		}
+
+		// Modify the map: the results must follow the changes
+		for (float x=-3;x<3;x+=0.02f)
+			grid.setPos(x,0.3f, 0.05f);
+	}
+	mrpt::system::setNumberOfParallelThreads(0);
+}
+
+// Reference implementation of the ray tracing likelihood: simulates the whole scan for the given pose.
+static double bruteForceRayTracingLikelihood(const COccupancyGridMap2D &grid, const CObservation2DRangeScan &obs, const CPose2D &pose)
+{
+	const int decimation = grid.likelihoodOptions.rayTracing_decimation;
+	CObservation2DRangeScan sim;
+	sim.aperture = obs.aperture;
+	sim.maxRange = obs.maxRange;
+	sim.rightToLeft = obs.rightToLeft;
+	sim.sensorPose = obs.sensorPose;
+	grid.laserScanSimulator(sim, pose, 0.45f, obs.scan.size(), 0, decimation);
+
+	const double stdSqrt2 = sqrt(2.0) * grid.likelihoodOptions.rayTracing_stdHit;
+	double ret = 1;
+	for (size_t j=0;j<obs.scan.size();j+=decimation)
+		if (obs.validRange[j])
+			ret += log( 0.1/obs.maxRange + 0.9*exp( -square( std::min(std::abs(sim.scan[j]-obs.scan[j]),2.0f)/stdSqrt2) ) );
+	return ret;
+}
+
+TEST(COccupancyGridMap2DTests, rayTracingLikelihoodBatch)
+{
+	CObservation2DRangeScan	scan;
+	scan.aperture = M_PIf;
+	scan.rightToLeft = true;
+	scan.maxRange = 6.0f;
+	const size_t N = 181;
+	scan.scan.resize(N);
+	scan.validRange.resize(N);
+	for (size_t i=0;i<N;i++)
+	{
+		scan.scan[i] = 3.0f + 1.5f*sin(i*0.1f);
+		scan.validRange[i] = (i%17)!=5;
+	}
+
+	COccupancyGridMap2D  grid(-10,10, -10,10, 0.05f);
+	grid.insertObservation( &scan );
+	grid.likelihoodOptions.likelihoodMethod = COccupancyGridMap2D::lmRayTracing;
+	grid.likelihoodOptions.rayTracing_decimation = 2;
+
+	mrpt::random::CRandomGenerator rnd(1111);
+	std::vector<TPose2D> poses;
+	for (int i=0;i<60;i++)
+		poses.push_back( TPose2D( rnd.drawUniform(-1,1), rnd.drawUniform(-1,1), rnd.drawUniform(-0.3,0.3) ) );
+
+	std::vector<double> logliks;
+	mrpt::system::setNumberOfParallelThreads(4);
+	grid.computeObservationLikelihood_rayTracingBatch(scan, poses, logliks);
+	mrpt::system::setNumberOfParallelThreads(0);
+	ASSERT_EQ(logliks.size(), poses.size());
+
+	for (size_t k=0;k<poses.size();k++)
+	{
+		const CPose2D p(poses[k]);
+		const double ref = bruteForceRayTracingLikelihood(grid,scan,p);
+		EXPECT_NEAR(ref, logliks[k], 1e-6*std::abs(ref)) << "pose #" << k;
+		EXPECT_NEAR(ref, grid.computeObservationLikelihood(&scan, CPose3D(p)), 1e-6*std::abs(ref)) << "pose #" << k;
+	}
+
+	// A copy shares the distance fields, which must not change when the original is modified:
+	const COccupancyGridMap2D gridCopy(grid);
+
+	// After modifying the map, single poses are evaluated without the (now outdated) distance fields:
+	const CPose3D newScanPose(0.5,-0.3,0, 0.2,0,0);
+	grid.insertObservation( &scan, &newScanPose );
+	for (size_t k=0;k<poses.size();k+=7)
+	{
+		const CPose2D p(poses[k]);
+		const double ref = bruteForceRayTracingLikelihood(grid,scan,p);
+		EXPECT_NEAR(ref, grid.computeObservationLikelihood(&scan, CPose3D(p)), 1e-6*std::abs(ref)) << "pose #" << k;
+	}
+	grid.computeObservationLikelihood_rayTracingBatch(scan, poses, logliks);
+	for (size_t k=0;k<poses.size();k+=7)
+	{
+		const double ref = bruteForceRayTracingLikelihood(grid,scan,CPose2D(poses[k]));
+		EXPECT_NEAR(ref, logliks[k], 1e-6*std::abs(ref)) << "pose #" << k;
+	}
+	gridCopy.computeObservationLikelihood_rayTracingBatch(scan, poses, logliks);
+	for (size_t k=0;k<poses.size();k+=7)
+	{
+		const double ref = bruteForceRayTracingLikelihood(gridCopy,scan,CPose2D(poses[k]));
+		EXPECT_NEAR(ref, logliks[k], 1e-6*std::abs(ref)) << "pose #" << k;
+	}
+}
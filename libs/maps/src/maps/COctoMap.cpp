@@ -52,19 +52,13 @@ COctoMap::~COctoMap()
 void  COctoMap::writeToStream(CStream &out, int *version) const
 {
 	if (version)
-		*version = 1;
+		*version = 2;
 	else
 	{
 		this->likelihoodOptions.writeToStream(out);
 		this->renderingOptions.writeToStream(out);  // Added in v1
 
-		CMemoryChunk chunk;
-		const string	tmpFil = mrpt::system::getTempFileName();
-		const_cast<octomap::OcTree*>(&m_octomap)->writeBinary(tmpFil);
-		chunk.loadBufferFromFile(tmpFil);
-		mrpt::system::deleteFile(tmpFil);
-
-		out << chunk;
+		this->internal_writeCompactTree(out);  // Compact format since v2
 	}
 }
 
@@ -79,21 +73,29 @@ void  COctoMap::readFromStream(CStream &in, int version)
 	{
 	case 0:
 	case 1:
+	case 2:
 		{
 			this->likelihoodOptions.readFromStream(in);
 			if (version>=1) this->renderingOptions.readFromStream(in);
 
 			this->clear();
 
-			CMemoryChunk chunk;
-			in >> chunk;
-
-			if (chunk.getTotalBytesCount())
+			if (version>=2)
 			{
-				const string	tmpFil = mrpt::system::getTempFileName();
-				if (!chunk.saveBufferToFile( tmpFil ) ) THROW_EXCEPTION("Error saving temporary file");
-				m_octomap.readBinary(tmpFil);
-				mrpt::system::deleteFile( tmpFil );
+				this->internal_readCompactTree(in);
+			}
+			else
+			{
+				CMemoryChunk chunk;
+				in >> chunk;
+
+				if (chunk.getTotalBytesCount())
+				{
+					const string	tmpFil = mrpt::system::getTempFileName();
+					if (!chunk.saveBufferToFile( tmpFil ) ) THROW_EXCEPTION("Error saving temporary file");
+					m_octomap.readBinary(tmpFil);
+					mrpt::system::deleteFile( tmpFil );
+				}
 			}
 
 		} break;
@@ -111,7 +113,7 @@ bool COctoMap::internal_insertObservation(const CObservation *obs,const CPose3D
 	if (!internal_build_PointCloud_for_observation(obs,robotPose, sensorPt, scan))
 		return false; // Nothing to do.
 	// Insert rays:
-	m_octomap.insertScan(scan, sensorPt, insertionOptions.maxrange, insertionOptions.pruning);
+	internal_insertScan(scan, sensorPt);
 	return true;
 }
 
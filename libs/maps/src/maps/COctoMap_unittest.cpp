@@ -9,6 +9,7 @@
 
 
 #include <mrpt/maps.h>
+#include <mrpt/utils/CMemoryStream.h>
 #include <gtest/gtest.h>
 
 using namespace mrpt;
@@ -75,3 +76,141 @@ TEST(COctoMapTests, insert2DScan)
 
 }
 
+
+namespace
+{
+	// A depth camera (without 3D points) in front of a wall 2m ahead:
+	void createDepthObs(CObservation3DRangeScan &obs)
+	{
+		const int W = 40, H = 30;
+		obs.hasRangeImage  = true;
+		obs.range_is_depth = true;
+		obs.rangeImage.setSize(H,W);
+		obs.rangeImage.fill(2.0f);
+		obs.rangeImage(0,0) = 0; // An invalid pixel
+		obs.cameraParams.ncols = W;
+		obs.cameraParams.nrows = H;
+		obs.cameraParams.setIntrinsicParamsFromValues(40,40,19.5,14.5);
+	}
+}
+
+TEST(COctoMapTests, insertDepthImage)
+{
+	CObservation3DRangeScan obs;
+	createDepthObs(obs);
+
+	for (int fast=0;fast<2;fast++)
+	{
+		COctoMap  map(0.1);
+		map.insertionOptions.fastInsertion = (fast!=0);
+		map.insertionOptions.fastInsertionParallelMinRays = 1;
+		EXPECT_TRUE( map.insertObservation(&obs) );
+
+		double occup;
+		EXPECT_TRUE( map.getPointOccupancy(2.02,0.02,0.02, occup) );
+		EXPECT_GT(occup,0.5);
+		EXPECT_TRUE( map.getPointOccupancy(1.02,0.02,0.02, occup) );
+		EXPECT_LT(occup,0.5);
+	}
+}
+
+TEST(COctoMapTests, computeUpdateFast)
+{
+	CObservation3DRangeScan obs;
+	createDepthObs(obs);
+
+	CSimplePointsMap pts;
+	obs.project3DPointsFromDepthImageInto(pts,false);
+	size_t N;
+	const float *xs,*ys,*zs;
+	pts.getPointsBuffer(N,xs,ys,zs);
+	octomap::Pointcloud scan;
+	for (size_t i=0;i<N;i++)
+		if (xs[i]!=0) scan.push_back(xs[i],ys[i],zs[i]);
+	const octomap::point3d sensorPt(0,0,0);
+
+	COctoMap  map(0.1);
+	map.insertionOptions.fastInsertionParallelMinRays = 1;
+
+	octomap::KeySet free_ref, occ_ref, free_fast, occ_fast;
+	map.getOctomap().computeUpdate(scan, sensorPt, free_ref, occ_ref, -1);
+	map.computeUpdateFast(scan, sensorPt, free_fast, occ_fast);
+
+	// Same end points, and (approximately) the same free space:
+	EXPECT_EQ( occ_ref.size(), occ_fast.size() );
+	for (octomap::KeySet::const_iterator it=occ_ref.begin();it!=occ_ref.end();++it)
+		EXPECT_TRUE( occ_fast.find(*it)!=occ_fast.end() );
+	for (octomap::KeySet::const_iterator it=free_fast.begin();it!=free_fast.end();++it)
+		EXPECT_TRUE( occ_fast.find(*it)==occ_fast.end() );
+	EXPECT_NEAR( double(free_fast.size()), double(free_ref.size()), 0.1*free_ref.size() );
+}
+
+TEST(COctoMapTests, compactSerialization)
+{
+	CObservation3DRangeScan obs;
+	createDepthObs(obs);
+
+	COctoMap  map(0.1);
+	map.insertObservation(&obs);
+
+	CMemoryStream buf;
+	buf << map;
+	buf.Seek(0);
+	COctoMap  map2;
+	buf >> map2;
+
+	EXPECT_EQ(map.getResolution(), map2.getResolution());
+	EXPECT_EQ(map.size(), map2.size());
+
+	// Leaves keep their occupancy class, and their probability up to quantization:
+	octomap::OcTree &om = map.getOctomap(), &om2 = map2.getOctomap();
+	for (octomap::OcTree::leaf_iterator it=om.begin_leafs();it!=om.end_leafs();++it)
+	{
+		const octomap::OcTreeNode *node2 = om2.search(it.getKey(), it.getDepth());
+		ASSERT_TRUE(node2!=NULL);
+		EXPECT_EQ( om.isNodeOccupied(*it), om2.isNodeOccupied(node2) );
+		EXPECT_NEAR( it->getLogOdds(), node2->getLogOdds(), 0.03 );
+	}
+}
+
+TEST(COctoMapTests, compactSerializationColoured)
+{
+	CColouredOctoMap  map(0.1);
+	map.insertRay(2,0,0, 0,0,0);
+	map.insertRay(2,1,0, 0,0,0);
+	map.updateVoxelColour(2,0,0, 10,20,30);
+	map.updateVoxelColour(2,1,0, 200,100,50);
+
+	CMemoryStream buf;
+	buf << map;
+	buf.Seek(0);
+	CColouredOctoMap  map2;
+	buf >> map2;
+
+	uint8_t r,g,b;
+	ASSERT_TRUE( map2.getPointColour(2,0,0, r,g,b) );
+	EXPECT_EQ(10,r); EXPECT_EQ(20,g); EXPECT_EQ(30,b);
+	ASSERT_TRUE( map2.getPointColour(2,1,0, r,g,b) );
+	EXPECT_EQ(200,r); EXPECT_EQ(100,g); EXPECT_EQ(50,b);
+
+	double occup;
+	ASSERT_TRUE( map2.getPointOccupancy(2,1,0, occup) );
+	EXPECT_GT(occup,0.5);
+	ASSERT_TRUE( map2.getPointOccupancy(1,0,0, occup) );
+	EXPECT_LT(occup,0.5);
+}
+
+TEST(COctoMapTests, deferredPruning)
+{
+	CObservation3DRangeScan obs;
+	createDepthObs(obs);
+
+	COctoMap  map(0.05);
+	map.insertionOptions.pruningMaxMemoryMB = 1000;
+	map.insertObservation(&obs);
+
+	const size_t nUnpruned = map.size();
+	map.prune();
+	EXPECT_LT(map.size(), nUnpruned);
+	EXPECT_EQ(map.size(), map.calcNumNodes());
+}
@@ -37,6 +37,8 @@
 #	include <mrpt/utils/SSE_macros.h>
 #endif
 
+#include <mrpt/system/parallelization.h>
+
 using namespace mrpt::poses;
 using namespace mrpt::slam;
 using namespace std;
@@ -55,6 +57,129 @@ float CPointsMap::COLOR_3DSCENE_B = 1;
 extern CStartUpClassesRegister  mrpt_maps_class_reg;
 const int dumm = mrpt_maps_class_reg.do_nothing(); // Avoid compiler removing this class in static linking
 
+namespace
+{
+	/** Nearest neighbour search of CPointsMap::determineMatching2D() and determineMatching3D(), for blocks of the (decimated) points
+	  *  of the other map. Each block fills its own list of pairs, so blocks can run in parallel. */
+	struct TMatchingSearchBody
+	{
+		TMatchingSearchBody(
+			const CPointsMap &_thisMap, const CPointsMap &_otherMap,
+			const float *_x_locals, const float *_y_locals, const float *_z_locals,
+			const TMatchingParams &_params, const size_t _block_len,
+			std::vector<TMatchingPairList> &_blocks ) :
+				thisMap(_thisMap), otherMap(_otherMap),
+				x_locals(_x_locals), y_locals(_y_locals), z_locals(_z_locals),
+				params(_params), block_len(_block_len), blocks(_blocks)
+		{ }
+
+		const CPointsMap &thisMap, &otherMap;
+		const float *x_locals, *y_locals, *z_locals; //!< The points of the other map, transformed (z_locals=NULL for a 2D matching)
+		const TMatchingParams &params;
+		const size_t block_len; //!< Number of points of the other map in each block
+		std::vector<TMatchingPairList> &blocks;
+
+		void operator()(const mrpt::system::BlockedRange &r) const
+		{
+			const size_t nLocalPoints = otherMap.size();
+			const size_t decim = params.decimation_other_map_points;
+
+			for (int b=r.begin();b<r.end();b++)
+			{
+				TMatchingPairList &corrs = blocks[b];
+
+				size_t localIdx = params.offset_other_map_points + b*block_len*decim;
+				for (size_t k=0;k<block_len && localIdx<nLocalPoints;k++, localIdx+=decim)
+				{
+					const float x_local = x_locals[localIdx];
+					const float y_local = y_locals[localIdx];
+
+					// Use a KD-tree to look for the nearnest neighbor of the local point in "this" (global/reference) points map,
+					//  and compute the max. allowed distance:
+					float tentativ_err_sq;
+					unsigned int tentativ_this_idx;
+					double maxDistForCorrespondenceSquared;
+					if (z_locals)
+					{
+						const float z_local = z_locals[localIdx];
+						tentativ_this_idx = thisMap.kdTreeClosestPoint3D(x_local,y_local,z_local, tentativ_err_sq);
+						maxDistForCorrespondenceSquared = square(
+							params.maxAngularDistForCorrespondence * params.angularDistPivotPoint.distanceTo(TPoint3D(x_local,y_local,z_local)) +
+							params.maxDistForCorrespondence );
+					}
+					else
+					{
+						tentativ_this_idx = thisMap.kdTreeClosestPoint2D(x_local,y_local, tentativ_err_sq);
+						maxDistForCorrespondenceSquared = square(
+							params.maxAngularDistForCorrespondence * std::sqrt( square(params.angularDistPivotPoint.x-x_local) + square(params.angularDistPivotPoint.y-y_local) ) +
+							params.maxDistForCorrespondence );
+					}
+
+					// Distance below the threshold??
+					if ( tentativ_err_sq < maxDistForCorrespondenceSquared )
+					{
+						corrs.resize(corrs.size()+1);
+						TMatchingPair & p = corrs.back();
+
+						p.this_idx = tentativ_this_idx;
+						thisMap.getPointFast(tentativ_this_idx, p.this_x,p.this_y,p.this_z);
+
+						p.other_idx = localIdx;
+						otherMap.getPointFast(localIdx, p.other_x,p.other_y,p.other_z);
+
+						p.errorSquareAfterTransformation  = tentativ_err_sq;
+					}
+				}
+			}
+		}
+	};
+
+	/** Finds the closest point in "thisMap" to each (decimated) point of "otherMap", already transformed into x_locals,y_locals,z_locals (NULL for 2D),
+	  *  and keeps those within the distance thresholds in \a correspondences, in ascending order of other_idx.
+	  * Large sets of points are split in blocks which are searched in parallel, with exactly the same result than a serial search.
+	  * \return The sum of the squared distances of the correspondences.
+	  */
+	float searchMatchingCorrespondences(
+		const CPointsMap &thisMap, const CPointsMap &otherMap,
+		const float *x_locals, const float *y_locals, const float *z_locals,
+		const TMatchingParams &params,
+		TMatchingPairList &correspondences )
+	{
+		const size_t BLOCK_LEN = 512;  // Number of points in each parallel job
+
+		const size_t nLocalPoints = otherMap.size();
+		const size_t nQueries = (nLocalPoints - params.offset_other_map_points + params.decimation_other_map_points - 1) / params.decimation_other_map_points;
+		const size_t nBlocks = (nQueries + BLOCK_LEN - 1) / BLOCK_LEN;
+
+		std::vector<TMatchingPairList> blocks(nBlocks);
+		TMatchingSearchBody body(thisMap,otherMap, x_locals,y_locals,z_locals, params, BLOCK_LEN, blocks);
+
+		if (nBlocks>1)
+		{
+			// The KD-tree must be built before querying it from several threads:
+			if (z_locals)
+			     thisMap.kdTreeBuildIndex3D();
+			else thisMap.kdTreeBuildIndex2D();
+			mrpt::system::parallel_for( mrpt::system::BlockedRange(0,nBlocks), body );
+		}
+		else body( mrpt::system::BlockedRange(0,nBlocks) );
+
+		// Join the blocks, in order:
+		if (nBlocks==1)
+			correspondences.swap(blocks[0]);
+		else
+		{
+			for (size_t b=0;b<nBlocks;b++)
+				correspondences.insert(correspondences.end(), blocks[b].begin(), blocks[b].end() );
+		}
+
+		float sumSqrDist = 0;
+		for (TMatchingPairList::const_iterator it=correspondences.begin();it!=correspondences.end();++it)
+			sumSqrDist+=it->errorSquareAfterTransformation;
+		return sumSqrDist;
+	}
+}
+
 /*---------------------------------------------------------------
 						Constructor
   ---------------------------------------------------------------*/
@@ -250,10 +375,8 @@ void  CPointsMap::clipOutOfRangeInZ(float zMin, float zMax)
 	for (size_t i=0;i<n;i++)
 		deletionMask[i] = ( z[i]<zMin || z[i]>zMax );
 
-	// Perform deletion:
+	// Perform deletion (this also marks the map as modified):
 	applyDeletionMask(deletionMask);
-
-	mark_as_modified();
 }
 
 
@@ -272,15 +395,13 @@ void  CPointsMap::clipOutOfRange(const CPoint2D	&point, float maxRange)
 	for (i=0;i<n;i++)
 		deletionMask[i] = point.distance2DTo( x[i],y[i] ) > maxRange;
 
-	// Perform deletion:
+	// Perform deletion (this also marks the map as modified):
 	applyDeletionMask(deletionMask);
-
-	mark_as_modified();
 }
 
 void CPointsMap::determineMatching2D(
 	const CMetricMap      * otherMap2,
-	const CPose2D         & otherMapPose_,
+	const CPose2D         & otherMapPose,
 	TMatchingPairList     & correspondences,
 	const TMatchingParams & params,
 	TMatchingExtraResults & extraResults ) const
@@ -294,8 +415,6 @@ void CPointsMap::determineMatching2D(
 	ASSERT_(otherMap2->GetRuntimeClass()->derivedFrom( CLASS_ID(CPointsMap) ));
 	const CPointsMap		*otherMap = static_cast<const CPointsMap*>( otherMap2 );
 
-	const TPose2D otherMapPose(otherMapPose_.x(),otherMapPose_.y(),otherMapPose_.phi());
-
 	const size_t nLocalPoints = otherMap->size();
 	const size_t nGlobalPoints = this->size();
 	float _sumSqrDist=0;
@@ -307,11 +426,6 @@ void CPointsMap::determineMatching2D(
 	float local_y_min= std::numeric_limits<float>::max(), local_y_max= -std::numeric_limits<float>::max();
 	float global_y_min=std::numeric_limits<float>::max(), global_y_max= -std::numeric_limits<float>::max();
 
-	double       maxDistForCorrespondenceSquared;
-	float        x_local, y_local;
-	unsigned int localIdx;
-	
-	const float *x_other_it,*y_other_it,*z_other_it; // *x_global_it,*y_global_it; //,*z_global_it;
 
 	// Prepare output: no correspondences initially:
 	correspondences.clear();
@@ -327,102 +441,21 @@ void CPointsMap::determineMatching2D(
 	// Hay mapa local?
 	if (!nLocalPoints)  return;  // No
 
-	const double	sin_phi = sin(otherMapPose.phi);
-	const double	cos_phi = cos(otherMapPose.phi);
-
 	// Do matching only there is any chance of the two maps to overlap:
 	// -----------------------------------------------------------
 
-	// Translate and rotate all local points:
-
-#if MRPT_HAS_SSE2
-	// Number of 4-floats:
-	size_t nPackets = nLocalPoints/4;
-	if ( (nLocalPoints & 0x03)!=0) nPackets++;
-
-	// Pad with zeros to make sure we have a number of points multiple of 4
-	size_t nLocalPoints_4align = nLocalPoints;
-	size_t nExtraPad = 0;
-	if (0!=(nLocalPoints & 0x03))
-	{
-		nExtraPad = 4 - (nLocalPoints & 0x03);
-		nLocalPoints_4align+=nExtraPad;
-	}
-
-	Eigen::Array<float,Eigen::Dynamic,1>  x_locals(nLocalPoints_4align), y_locals(nLocalPoints_4align);
+	// Transform all the local points at once (SIMD), then find their bounding box:
+	vector<float> x_locals(nLocalPoints), y_locals(nLocalPoints);
+	otherMapPose.composePoints(nLocalPoints, &otherMap->x[0],&otherMap->y[0], &x_locals[0],&y_locals[0]);
 
-	// We'll assume that the real allocated memory in the source buffers at least have room for a maximum
-	//  of 3 more floats, and pad with zeroes there (yeah, fuck correct-constness....)
-	if ( otherMap->x.capacity()<nLocalPoints_4align ||
-		 otherMap->y.capacity()<nLocalPoints_4align )
+	for (size_t localIdx=0;localIdx<nLocalPoints;localIdx++)
 	{
-		// This will happen perhaps...once in a lifetime? Anyway:
-		const_cast<vector<float>*>(&otherMap->x)->reserve(nLocalPoints_4align+16);
-		const_cast<vector<float>*>(&otherMap->y)->reserve(nLocalPoints_4align+16);
+		local_x_min = min(local_x_min,x_locals[localIdx]);
+		local_x_max = max(local_x_max,x_locals[localIdx]);
+		local_y_min = min(local_y_min,y_locals[localIdx]);
+		local_y_max = max(local_y_max,y_locals[localIdx]);
 	}
 
-	if (nExtraPad)
-	{
-		float *ptr_in_x = const_cast<float*>(&otherMap->x[0]);
-		float *ptr_in_y = const_cast<float*>(&otherMap->y[0]);
-		for (size_t k=nExtraPad;k; k--) {
-			ptr_in_x[nLocalPoints+k]=0;
-			ptr_in_y[nLocalPoints+k]=0;
-		}
-	}
-
-	const __m128 cos_4val = _mm_set1_ps(cos_phi); // load 4 copies of the same value
-	const __m128 sin_4val = _mm_set1_ps(sin_phi);
-	const __m128 x0_4val = _mm_set1_ps(otherMapPose.x);
-	const __m128 y0_4val = _mm_set1_ps(otherMapPose.y);
-
-	// For the bounding box:
-	__m128 x_mins = _mm_set1_ps( std::numeric_limits<float>::max() );
-	__m128 x_maxs = _mm_set1_ps( std::numeric_limits<float>::min() );
-	__m128 y_mins = x_mins;
-	__m128 y_maxs = x_maxs;
-
-	const float *ptr_in_x = &otherMap->x[0];
-	const float *ptr_in_y = &otherMap->y[0];
-	float *ptr_out_x    = &x_locals[0];
-	float *ptr_out_y    = &y_locals[0];
-
-	for( ; nPackets; nPackets--, ptr_in_x+=4, ptr_in_y+=4, ptr_out_x+=4, ptr_out_y+=4 )
-	{
-		const __m128 xs = _mm_loadu_ps(ptr_in_x); // *Unaligned* load
-		const __m128 ys = _mm_loadu_ps(ptr_in_y);
-
-		const __m128 lxs = _mm_add_ps(x0_4val, _mm_sub_ps( _mm_mul_ps(xs,cos_4val), _mm_mul_ps(ys,sin_4val) ) );
-		const __m128 lys = _mm_add_ps(y0_4val, _mm_add_ps( _mm_mul_ps(xs,sin_4val), _mm_mul_ps(ys,cos_4val) ) );
-		_mm_store_ps(ptr_out_x, lxs );
-		_mm_store_ps(ptr_out_y, lys );
-
-		x_mins = _mm_min_ps(x_mins,lxs);
-		x_maxs = _mm_max_ps(x_maxs,lxs);
-		y_mins = _mm_min_ps(y_mins,lys);
-		y_maxs = _mm_max_ps(y_maxs,lys);
-	}
-
-	// Recover the min/max:
-	EIGEN_ALIGN16 float temp_nums[4];
-
-	_mm_store_ps(temp_nums, x_mins); local_x_min=min(min(temp_nums[0],temp_nums[1]),min(temp_nums[2],temp_nums[3]));
-	_mm_store_ps(temp_nums, y_mins); local_y_min=min(min(temp_nums[0],temp_nums[1]),min(temp_nums[2],temp_nums[3]));
-	_mm_store_ps(temp_nums, x_maxs); local_x_max=max(max(temp_nums[0],temp_nums[1]),max(temp_nums[2],temp_nums[3]));
-	_mm_store_ps(temp_nums, y_maxs); local_y_max=max(max(temp_nums[0],temp_nums[1]),max(temp_nums[2],temp_nums[3]));
-
-#else
-	// Non SSE2 version:
-	mrpt::vector_float  x_org(otherMap->x), y_org(otherMap->y);
-	Eigen::Array<float,Eigen::Dynamic,1>  x_locals = otherMapPose.x + cos_phi * x_org.array() - sin_phi *  y_org.array() ;
-	Eigen::Array<float,Eigen::Dynamic,1>  y_locals = otherMapPose.y + sin_phi * x_org.array() + cos_phi *  y_org.array() ;
-
-	local_x_min=x_locals.minCoeff();
-	local_y_min=y_locals.minCoeff();
-	local_x_max=x_locals.maxCoeff();
-	local_y_max=y_locals.maxCoeff();
-#endif
-
 	// Find the bounding box:
 	float global_z_min,global_z_max;
 	this->boundingBox(
@@ -437,66 +470,11 @@ void CPointsMap::determineMatching2D(
 		local_y_max<global_y_min) return;	// We know for sure there is no matching at all
 
 
-	// Loop for each point in local map:
+	// Search the closest point to each point in local map:
 	// --------------------------------------------------
-	for ( localIdx=params.offset_other_map_points,
-			x_other_it=&otherMap->x[params.offset_other_map_points],
-			y_other_it=&otherMap->y[params.offset_other_map_points],
-			z_other_it=&otherMap->z[params.offset_other_map_points];
-			localIdx<nLocalPoints;
-			x_other_it+=params.decimation_other_map_points,y_other_it+=params.decimation_other_map_points,z_other_it+=params.decimation_other_map_points,localIdx+=params.decimation_other_map_points )
-	{
-		// For speed-up:
-		x_local = x_locals[localIdx]; // *x_locals_it;
-		y_local = y_locals[localIdx]; // *y_locals_it;
-
-		// Find all the matchings in the requested distance:
-
-		// KD-TREE implementation =================================
-		// Use a KD-tree to look for the nearnest neighbor of:
-		//   (x_local, y_local, z_local)
-		// In "this" (global/reference) points map.
-
-		float tentativ_err_sq;
-		unsigned int tentativ_this_idx = kdTreeClosestPoint2D(
-			x_local,  y_local,  // Look closest to this guy
-			tentativ_err_sq // save here the min. distance squared
-			);
-
-		// Compute max. allowed distance:
-		maxDistForCorrespondenceSquared = square(
-			params.maxAngularDistForCorrespondence * std::sqrt( square(params.angularDistPivotPoint.x-x_local) + square(params.angularDistPivotPoint.y-y_local) ) +
-					params.maxDistForCorrespondence );
-
-		// Distance below the threshold??
-		if ( tentativ_err_sq < maxDistForCorrespondenceSquared )
-		{
-			// Save all the correspondences:
-			_correspondences.resize(_correspondences.size()+1);
-
-			TMatchingPair & p = _correspondences.back();
-
-			p.this_idx = tentativ_this_idx;
-			p.this_x = x[tentativ_this_idx];
-			p.this_y = y[tentativ_this_idx];
-			p.this_z = z[tentativ_this_idx];
-
-			p.other_idx = localIdx;
-			p.other_x = *x_other_it;
-			p.other_y = *y_other_it;
-			p.other_z = *z_other_it;
-
-			p.errorSquareAfterTransformation  = tentativ_err_sq;
-
-			// At least one:
-			nOtherMapPointsWithCorrespondence++;
-
-			// Accumulate the MSE:
-			_sumSqrDist+= p.errorSquareAfterTransformation;
-			_sumSqrCount++;
-		}
-
-	} // For each local point
+	_sumSqrDist = searchMatchingCorrespondences(*this,*otherMap, &x_locals[0],&y_locals[0],NULL, params, _correspondences);
+	_sumSqrCount = _correspondences.size();
+	nOtherMapPointsWithCorrespondence = _correspondences.size();  // At most one correspondence for each local point
 
 	// Additional consistency filter: "onlyKeepTheClosest" up to now
 	//  led to just one correspondence for each "local map" point, but
@@ -558,11 +536,8 @@ void  CPointsMap::changeCoordinatesReference(const CPose2D	&newBase)
 
 	const CPose3D	newBase3D(newBase);
 
-	for (size_t i=0;i<N;i++)
-		newBase3D.composePoint(
-			x[i],y[i],z[i],  // In
-			x[i],y[i],z[i]   // Out
-		);
+	if (N)
+		newBase3D.composePoints(N, &x[0],&y[0],&z[0],  &x[0],&y[0],&z[0]);
 
 	mark_as_modified();
 }
@@ -574,11 +549,8 @@ void  CPointsMap::changeCoordinatesReference(const CPose3D	&newBase)
 {
 	const size_t N = x.size();
 
-	for (size_t i=0;i<N;i++)
-		newBase.composePoint(
-			x[i],y[i],z[i],  // In
-			x[i],y[i],z[i]   // Out
-		);
+	if (N)
+		newBase.composePoints(N, &x[0],&y[0],&z[0],  &x[0],&y[0],&z[0]);
 
 	mark_as_modified();
 }
@@ -1013,8 +985,6 @@ void  CPointsMap::determineMatching3D(
 	float local_y_min= std::numeric_limits<float>::max(), local_y_max= -std::numeric_limits<float>::max();
 	float local_z_min= std::numeric_limits<float>::max(), local_z_max= -std::numeric_limits<float>::max();
 
-	double					maxDistForCorrespondenceSquared;
-
 
 	// Prepare output: no correspondences initially:
 	correspondences.clear();
@@ -1036,24 +1006,42 @@ void  CPointsMap::determineMatching3D(
 	// Transladar y rotar ya todos los puntos locales
 	vector<float> x_locals(nLocalPoints), y_locals(nLocalPoints), z_locals(nLocalPoints);
 
-	for (unsigned int localIdx=params.offset_other_map_points;localIdx<nLocalPoints;localIdx+=params.decimation_other_map_points)
+	if (params.decimation_other_map_points==1)
+	{
+		// Transform all the points at once (SIMD), then find the bounding box:
+		otherMapPose.composePoints(nLocalPoints, &otherMap->x[0],&otherMap->y[0],&otherMap->z[0], &x_locals[0],&y_locals[0],&z_locals[0]);
+
+		for (size_t localIdx=0;localIdx<nLocalPoints;localIdx++)
+		{
+			local_x_min = min(local_x_min,x_locals[localIdx]);
+			local_x_max = max(local_x_max,x_locals[localIdx]);
+			local_y_min = min(local_y_min,y_locals[localIdx]);
+			local_y_max = max(local_y_max,y_locals[localIdx]);
+			local_z_min = min(local_z_min,z_locals[localIdx]);
+			local_z_max = max(local_z_max,z_locals[localIdx]);
+		}
+	}
+	else
 	{
-		float x_local,y_local,z_local;
-		otherMapPose.composePoint(
-			otherMap->x[localIdx], otherMap->y[localIdx], otherMap->z[localIdx],
-			x_local,y_local,z_local );
-
-		x_locals[localIdx] = x_local;
-		y_locals[localIdx] = y_local;
-		z_locals[localIdx] = z_local;
-
-		// Find the bounding box:
-		local_x_min = min(local_x_min,x_local);
-		local_x_max = max(local_x_max,x_local);
-		local_y_min = min(local_y_min,y_local);
-		local_y_max = max(local_y_max,y_local);
-		local_z_min = min(local_z_min,z_local);
-		local_z_max = max(local_z_max,z_local);
+		for (size_t localIdx=params.offset_other_map_points;localIdx<nLocalPoints;localIdx+=params.decimation_other_map_points)
+		{
+			float x_local,y_local,z_local;
+			otherMapPose.composePoint(
+				otherMap->x[localIdx], otherMap->y[localIdx], otherMap->z[localIdx],
+				x_local,y_local,z_local );
+
+			x_locals[localIdx] = x_local;
+			y_locals[localIdx] = y_local;
+			z_locals[localIdx] = z_local;
+
+			// Find the bounding box:
+			local_x_min = min(local_x_min,x_local);
+			local_x_max = max(local_x_max,x_local);
+			local_y_min = min(local_y_min,y_local);
+			local_y_max = max(local_y_max,y_local);
+			local_z_min = min(local_z_min,z_local);
+			local_z_max = max(local_z_max,z_local);
+		}
 	}
 
 	// Find the bounding box:
@@ -1071,63 +1059,11 @@ void  CPointsMap::determineMatching3D(
 		local_y_max<global_y_min) return;	// No hace falta hacer matching,
 											//   porque es de CERO.
 
-	// Loop for each point in local map:
+	// Search the closest point to each point in local map:
 	// --------------------------------------------------
-	for (unsigned int localIdx=params.offset_other_map_points; localIdx<nLocalPoints; localIdx+=params.decimation_other_map_points)
-	{
-		// For speed-up:
-		const float x_local = x_locals[localIdx];
-		const float y_local = y_locals[localIdx];
-		const float z_local = z_locals[localIdx];
-
-		{
-			// KD-TREE implementation
-			// Use a KD-tree to look for the nearnest neighbor of:
-			//   (x_local, y_local, z_local)
-			// In "this" (global/reference) points map.
-
-			float tentativ_err_sq;
-			const unsigned int tentativ_this_idx = kdTreeClosestPoint3D(
-				x_local,  y_local, z_local,  // Look closest to this guy
-				tentativ_err_sq // save here the min. distance squared
-				);
-
-			// Compute max. allowed distance:
-			maxDistForCorrespondenceSquared = square(
-						params.maxAngularDistForCorrespondence * params.angularDistPivotPoint.distanceTo(TPoint3D(x_local,y_local,z_local)) +
-						params.maxDistForCorrespondence );
-
-			// Distance below the threshold??
-			if ( tentativ_err_sq < maxDistForCorrespondenceSquared )
-			{
-				// Save all the correspondences:
-				_correspondences.resize(_correspondences.size()+1);
-
-				TMatchingPair & p = _correspondences.back();
-
-				p.this_idx = tentativ_this_idx;
-				p.this_x = x[tentativ_this_idx];
-				p.this_y = y[tentativ_this_idx];
-				p.this_z = z[tentativ_this_idx];
-
-				p.other_idx = localIdx;
-				p.other_x = otherMap->x[localIdx];
-				p.other_y = otherMap->y[localIdx];
-				p.other_z = otherMap->z[localIdx];
-
-				p.errorSquareAfterTransformation  = tentativ_err_sq;
-
-				// At least one:
-				nOtherMapPointsWithCorrespondence++;
-
-				// Accumulate the MSE:
-				_sumSqrDist+= p.errorSquareAfterTransformation;
-				_sumSqrCount++;
-			}
-
-
-		} // End of test_match
-	} // For each local point
+	_sumSqrDist = searchMatchingCorrespondences(*this,*otherMap, &x_locals[0],&y_locals[0],&z_locals[0], params, _correspondences);
+	_sumSqrCount = _correspondences.size();
+	nOtherMapPointsWithCorrespondence = _correspondences.size();  // At most one correspondence for each local point
 
 	// Additional consistency filter: "onlyKeepTheClosest" up to now
 	//  led to just one correspondence for each "local map" point, but
@@ -1208,6 +1144,74 @@ void CPointsMap::extractPoints( const TPoint3D &corner1, const TPoint3D &corner2
 	}
 }
 
+/*---------------------------------------------------------------
+				getVoxelDownsampled
+---------------------------------------------------------------*/
+const CSimplePointsMap * CPointsMap::getVoxelDownsampled(const float voxel_size) const
+{
+	MRPT_START
+	ASSERT_(voxel_size>0)
+
+	for (size_t i=0;i<m_voxel_downsampled_cache.size();i++)
+		if (m_voxel_downsampled_cache[i].first==voxel_size)
+			return static_cast<const CSimplePointsMap*>(m_voxel_downsampled_cache[i].second.pointer());
+
+	CSimplePointsMapPtr out = CSimplePointsMap::Create();
+	const size_t N = x.size();
+	if (N)
+	{
+		float min_x,max_x, min_y,max_y, min_z,max_z;
+		boundingBox(min_x,max_x, min_y,max_y, min_z,max_z);
+
+		const double inv_size = 1.0/voxel_size;
+		const uint64_t nx = static_cast<uint64_t>((max_x-min_x)*inv_size)+1;
+		const uint64_t ny = static_cast<uint64_t>((max_y-min_y)*inv_size)+1;
+		const uint64_t nz = static_cast<uint64_t>((max_z-min_z)*inv_size)+1;
+		ASSERTMSG_( double(nx)*double(ny)*double(nz) < 1e19, "Voxel size too small for the extension of the map")
+
+		// Sort the points by voxel, then average each run of points in the same voxel:
+		std::vector<std::pair<uint64_t,size_t> > voxel_pts(N);
+		for (size_t i=0;i<N;i++)
+		{
+			const uint64_t ix = std::min(nx-1, static_cast<uint64_t>((x[i]-min_x)*inv_size));
+			const uint64_t iy = std::min(ny-1, static_cast<uint64_t>((y[i]-min_y)*inv_size));
+			const uint64_t iz = std::min(nz-1, static_cast<uint64_t>((z[i]-min_z)*inv_size));
+			voxel_pts[i].first  = ix + nx*(iy + ny*iz);
+			voxel_pts[i].second = i;
+		}
+		std::sort(voxel_pts.begin(),voxel_pts.end());
+
+		size_t nVoxels = 1;
+		for (size_t i=1;i<N;i++)
+			if (voxel_pts[i].first!=voxel_pts[i-1].first) nVoxels++;
+		out->resize(nVoxels);
+
+		size_t run_start = 0, idx = 0;
+		for (size_t i=1;i<=N;i++)
+		{
+			if (i<N && voxel_pts[i].first==voxel_pts[run_start].first) continue;
+
+			double sx=0,sy=0,sz=0;
+			for (size_t k=run_start;k<i;k++)
+			{
+				const size_t j = voxel_pts[k].second;
+				sx+=x[j]; sy+=y[j]; sz+=z[j];
+			}
+			const double inv_n = 1.0/(i-run_start);
+			out->setPointFast(idx++, sx*inv_n, sy*inv_n, sz*inv_n);
+			run_start = i;
+		}
+	}
+
+	// Keep only the latest few voxel sizes:
+	if (m_voxel_downsampled_cache.size()>=8)
+		m_voxel_downsampled_cache.erase(m_voxel_downsampled_cache.begin());
+	m_voxel_downsampled_cache.push_back( std::make_pair(voxel_size, CPointsMapPtr(out)) );
+
+	return out.pointer();
+	MRPT_END
+}
+
 /*---------------------------------------------------------------
 				compute3DDistanceToMesh
 ---------------------------------------------------------------*/
@@ -1614,9 +1618,9 @@ void  CPointsMap::applyDeletionMask( const std::vector<bool> &mask )
 	}
 
 	// Set new correct size:
-	this->resize(j);
+	this->resizeFast(j);
 
-	mark_as_modified();
+	mark_as_points_removed(mask);
 }
 
 /*---------------------------------------------------------------
@@ -1629,28 +1633,19 @@ void  CPointsMap::insertAnotherMap(
 	const size_t N_this = size();
 	const size_t N_other = otherMap->size();
 
-	// Set the new size:
-	this->resize( N_this + N_other );
-
-	mrpt::math::TPoint3Df pt;
-	size_t src,dst;
-	for (src=0, dst=N_this; src<N_other; src++, dst++)
-	{
-		// Load the next point:
-		otherMap->getPointFast(src,pt.x,pt.y,pt.z);
+	// Set the new size (only appends points, signaled below):
+	this->resizeFast( N_this + N_other );
 
-		// Translation:
-		double gx,gy,gz;
-		otherPose.composePoint(pt.x,pt.y,pt.z,  gx,gy,gz);
-
-		// Add to this map:
-		this->setPointFast(dst,gx,gy,gz);
-	}
+	// Transform all the points at once, straight into their new place:
+	if (N_other)
+		otherPose.composePoints(N_other,
+			&otherMap->x[0],&otherMap->y[0],&otherMap->z[0],
+			&x[N_this],&y[N_this],&z[N_this]);
 
 	// Also copy other data fields (color, ...)
 	addFrom_classSpecific(*otherMap, N_this);
 
-	mark_as_modified();
+	mark_as_points_appended();
 }
 
 
@@ -1672,6 +1667,7 @@ void  CPointsMap::base_copyFrom(const CPointsMap &obj)
 	// Fill missing fields (R,G,B,min_dist) with default values.
 	this->resize(x.size());
 
+	m_voxel_downsampled_cache.clear();
 	kdtree_mark_as_outdated();
 
 	MRPT_END
@@ -1707,7 +1703,7 @@ bool  CPointsMap::internal_insertObservation(
 		/********************************************************************
 					OBSERVATION TYPE: CObservation2DRangeScan
 		 ********************************************************************/
-		mark_as_modified();
+		mark_as_points_appended();  // If fusing, fuseWith() marks the map as modified; applyDeletionMask() signals the removed points.
 
 		const CObservation2DRangeScan *o = static_cast<const CObservation2DRangeScan *>(obs);
 		// Insert only HORIZONTAL scans??
@@ -1800,7 +1796,7 @@ bool  CPointsMap::internal_insertObservation(
 		/********************************************************************
 					OBSERVATION TYPE: CObservation3DRangeScan
 		 ********************************************************************/
-		mark_as_modified();
+		mark_as_points_appended();  // If fusing, fuseWith() marks the map as modified.
 
 		const CObservation3DRangeScan *o = static_cast<const CObservation3DRangeScan *>(obs);
 		// Insert only HORIZONTAL scans??
@@ -1859,7 +1855,7 @@ bool  CPointsMap::internal_insertObservation(
 		/********************************************************************
 					OBSERVATION TYPE: CObservationRange  (IRs, Sonars, etc.)
 		 ********************************************************************/
-		mark_as_modified();
+		mark_as_points_appended();
 
 		const CObservationRange* o = static_cast<const CObservationRange*>(obs);
 
@@ -1921,8 +1917,6 @@ void  CPointsMap::fuseWith(
 	TPoint3D			a,b;
 	const CPose2D		nullPose(0,0,0);
 
-	mark_as_modified();
-
 	//const size_t nThis  =     this->getPointsCount();
 	const size_t nOther = otherMap->getPointsCount();
 
@@ -2002,4 +1996,6 @@ void  CPointsMap::fuseWith(
 		}
 	}
 
+	// Fused points have been moved in place, so the KD-tree built by determineMatching2D() above is no longer valid:
+	mark_as_modified();
 }
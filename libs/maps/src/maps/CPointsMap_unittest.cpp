@@ -9,6 +9,8 @@
 
 
 #include <mrpt/maps.h>
+#include <mrpt/random.h>
+#include <mrpt/system/parallelization.h>
 #include <gtest/gtest.h>
 
 using namespace mrpt;
@@ -189,3 +191,220 @@ TEST(CColouredPointsMapTests, clipOutOfRange)
 	do_test_clipOutOfRange<CColouredPointsMap>();
 }
 
+
+// Compare the queries of a dynamic KD-tree index against a brute-force search:
+void check_kdtree_queries(const CSimplePointsMap &pts, mrpt::random::CRandomGenerator &rnd)
+{
+	const size_t N = pts.size();
+	for (int q=0;q<20;q++)
+	{
+		const float qx = rnd.drawUniform(-12,12), qy = rnd.drawUniform(-12,12), qz = rnd.drawUniform(-2,2);
+
+		std::vector<float> d2(N), d3(N);
+		for (size_t i=0;i<N;i++)
+		{
+			float x,y,z;
+			pts.getPoint(i,x,y,z);
+			d2[i] = square(x-qx)+square(y-qy);
+			d3[i] = d2[i]+square(z-qz);
+		}
+		std::vector<float> sd3 = d3;
+		std::sort(sd3.begin(),sd3.end());
+
+		float cx,cy,dist2;
+		const size_t idx = pts.kdTreeClosestPoint2D(qx,qy,cx,cy,dist2);
+		EXPECT_FLOAT_EQ( *std::min_element(d2.begin(),d2.end()), dist2 );
+		EXPECT_FLOAT_EQ( d2[idx], dist2 );
+
+		// (Asking for more neighbors than points only returns the existing ones)
+		const size_t K = std::min<size_t>(5,N);
+		std::vector<size_t> idxs;
+		std::vector<float>  dists;
+		pts.kdTreeNClosestPoint3DIdx(qx,qy,qz,5,idxs,dists);
+		ASSERT_EQ(K, idxs.size());
+		ASSERT_EQ(K, dists.size());
+		for (size_t k=0;k<K;k++)
+		{
+			EXPECT_FLOAT_EQ( sd3[k], dists[k] );
+			EXPECT_FLOAT_EQ( d3[idxs[k]], dists[k] );
+		}
+
+		const float R2 = 4;
+		std::vector<std::pair<size_t,float> > found;
+		pts.kdTreeRadiusSearch2D(qx,qy,R2,found);
+		size_t nInside = 0;
+		for (size_t i=0;i<N;i++) if (d2[i]<R2) nInside++;
+		EXPECT_EQ(nInside, found.size());
+		for (size_t i=0;i<found.size();i++)
+			EXPECT_LT( d2[found[i].first], R2 );
+	}
+}
+
+TEST(CSimplePointsMapTests, dynamicKDTree)
+{
+	mrpt::random::CRandomGenerator rnd(123);
+
+	CSimplePointsMap pts;
+	pts.kdtree_search_params.dynamic_index = true;
+
+	// Append points in batches of different sizes, querying after each one:
+	for (int batch=0;batch<12;batch++)
+	{
+		const size_t n = 1 + (batch*37)%150;
+		for (size_t i=0;i<n;i++)
+			pts.insertPoint( rnd.drawUniform(-10,10), rnd.drawUniform(-10,10), rnd.drawUniform(-1,1) );
+		check_kdtree_queries(pts,rnd);
+	}
+
+	// Remove points from the middle of the map:
+	pts.clipOutOfRange(CPoint2D(0,0), 6.0f);
+	check_kdtree_queries(pts,rnd);
+
+	// More points, then remove the last ones:
+	for (size_t i=0;i<100;i++)
+		pts.insertPoint( rnd.drawUniform(-5,5), rnd.drawUniform(-5,5), rnd.drawUniform(-1,1) );
+	check_kdtree_queries(pts,rnd);
+	pts.resize( pts.size()-70 );
+	check_kdtree_queries(pts,rnd);
+
+	// A modification of existing points:
+	pts.setPoint(0, 0.5f,0.5f,0.0f);
+	check_kdtree_queries(pts,rnd);
+
+	// resize() followed by overwriting the existing points, as done by the 3D range scan projection:
+	pts.resize( pts.size()+10 );
+	for (size_t i=0;i<pts.size();i++)
+		pts.setPointFast(i, rnd.drawUniform(-10,10), rnd.drawUniform(-10,10), rnd.drawUniform(-1,1) );
+	check_kdtree_queries(pts,rnd);
+
+	// Fusing moves existing points in place:
+	CSimplePointsMap other;
+	for (size_t i=0;i<50;i++)
+	{
+		float x,y,z;
+		pts.getPoint(i,x,y,z);
+		other.insertPoint(x+0.05f,y-0.05f,z);
+	}
+	pts.fuseWith(&other, 0.5f);
+	check_kdtree_queries(pts,rnd);
+
+	// Appending a whole map, then removing scattered points:
+	pts.insertAnotherMap(&other, CPose3D(1.0,-2.0,0.0, DEG2RAD(30.0),0,0));
+	check_kdtree_queries(pts,rnd);
+	std::vector<bool> mask(pts.size());
+	for (size_t i=0;i<mask.size();i++)
+		mask[i] = (i%3)==1;
+	pts.applyDeletionMask(mask);
+	check_kdtree_queries(pts,rnd);
+
+	// Remove points which were appended after the last query, not indexed yet:
+	for (size_t i=0;i<40;i++)
+		pts.insertPoint( rnd.drawUniform(-10,10), rnd.drawUniform(-10,10), rnd.drawUniform(-1,1) );
+	mask.assign(pts.size(),false);
+	for (size_t i=0;i<20;i++)
+		mask[pts.size()-1-2*i] = mask[5*i] = true;
+	pts.applyDeletionMask(mask);
+	check_kdtree_queries(pts,rnd);
+
+	// Down to fewer points than the requested neighbors:
+	mask.assign(pts.size(),true);
+	mask[3] = mask[17] = false;
+	pts.applyDeletionMask(mask);
+	ASSERT_EQ(2u, pts.size());
+	check_kdtree_queries(pts,rnd);
+}
+
+// The parallel matching must give exactly the same correspondences than a single thread:
+TEST(CSimplePointsMapTests, determineMatchingParallel)
+{
+	mrpt::random::CRandomGenerator rnd(321);
+
+	CSimplePointsMap map1, map2;
+	for (int i=0;i<20000;i++)
+	{
+		const float x = rnd.drawUniform(-10,10), y = rnd.drawUniform(-10,10), z = rnd.drawUniform(-1,1);
+		map1.insertPoint(x,y,z);
+		map2.insertPoint(x+rnd.drawGaussian1D(0,0.05),y+rnd.drawGaussian1D(0,0.05),z+rnd.drawGaussian1D(0,0.05));
+	}
+
+	TMatchingParams params;
+	params.maxDistForCorrespondence = 0.10f;
+	params.maxAngularDistForCorrespondence = 0;
+	params.onlyKeepTheClosest = true;
+
+	const CPose3D pose3D(0.05,-0.02,0.01, DEG2RAD(1.0),0,0);
+	const CPose2D pose2D(0.05,-0.02, DEG2RAD(1.0));
+
+	for (int decim=1;decim<=3;decim+=2)
+	{
+		params.decimation_other_map_points = decim;
+
+		TMatchingPairList corrs_ser2D, corrs_par2D, corrs_ser3D, corrs_par3D;
+		TMatchingExtraResults res_ser2D, res_par2D, res_ser3D, res_par3D;
+
+		mrpt::system::setNumberOfParallelThreads(1);
+		map1.determineMatching2D(&map2,pose2D,corrs_ser2D,params,res_ser2D);
+		map1.determineMatching3D(&map2,pose3D,corrs_ser3D,params,res_ser3D);
+
+		mrpt::system::setNumberOfParallelThreads(4);
+		map1.determineMatching2D(&map2,pose2D,corrs_par2D,params,res_par2D);
+		map1.determineMatching3D(&map2,pose3D,corrs_par3D,params,res_par3D);
+
+		EXPECT_GT(corrs_ser2D.size(), 1000u);
+		EXPECT_GT(corrs_ser3D.size(), 1000u);
+		EXPECT_TRUE(corrs_ser2D==corrs_par2D);
+		EXPECT_TRUE(corrs_ser3D==corrs_par3D);
+		EXPECT_EQ(res_ser2D.sumSqrDist, res_par2D.sumSqrDist);
+		EXPECT_EQ(res_ser3D.sumSqrDist, res_par3D.sumSqrDist);
+		EXPECT_EQ(res_ser3D.correspondencesRatio, res_par3D.correspondencesRatio);
+	}
+	mrpt::system::setNumberOfParallelThreads(0);
+
+	// No overlap at all between the bounding boxes:
+	TMatchingPairList corrs;
+	TMatchingExtraResults res;
+	map1.determineMatching2D(&map2,CPose2D(25.0,0,0),corrs,params,res);
+	EXPECT_TRUE(corrs.empty());
+	map1.determineMatching3D(&map2,CPose3D(0,-25.0,0),corrs,params,res);
+	EXPECT_TRUE(corrs.empty());
+}
+
+TEST(CSimplePointsMapTests, voxelDownsampled)
+{
+	// One point at the origin, then 4 points in each voxel of 0.5m of a 4x4x2 grid of voxels:
+	CSimplePointsMap map;
+	map.insertPoint(0,0,0);
+	for (int ix=1;ix<=4;ix++)
+		for (int iy=1;iy<=4;iy++)
+			for (int iz=1;iz<=2;iz++)
+			{
+				map.insertPoint(0.5f*ix+0.1f, 0.5f*iy+0.1f, 0.5f*iz+0.1f);
+				map.insertPoint(0.5f*ix+0.3f, 0.5f*iy+0.1f, 0.5f*iz+0.1f);
+				map.insertPoint(0.5f*ix+0.1f, 0.5f*iy+0.3f, 0.5f*iz+0.1f);
+				map.insertPoint(0.5f*ix+0.3f, 0.5f*iy+0.3f, 0.5f*iz+0.4f);
+			}
+
+	const CSimplePointsMap *vox = map.getVoxelDownsampled(0.5f);
+	ASSERT_TRUE(vox!=NULL);
+	ASSERT_EQ(33u, vox->size());
+	for (size_t i=0;i<vox->size();i++)
+	{
+		float x,y,z;
+		vox->getPoint(i,x,y,z);
+		if (x==0 && y==0 && z==0) continue;
+		// The centroid of each voxel, relative to its corner:
+		EXPECT_NEAR(0.2f, fmod(x,0.5f), 1e-4);
+		EXPECT_NEAR(0.2f, fmod(y,0.5f), 1e-4);
+		EXPECT_NEAR(0.175f, fmod(z,0.5f), 1e-4);
+	}
+
+	// Cached until the map changes:
+	EXPECT_TRUE(vox==map.getVoxelDownsampled(0.5f));
+	EXPECT_EQ(1u, map.getVoxelDownsampled(10.0f)->size());
+
+	map.insertPoint(10,10,10);
+	EXPECT_EQ(34u, map.getVoxelDownsampled(0.5f)->size());
+
+	map.clipOutOfRange(CPoint2D(0,0), 5.0f);
+	EXPECT_EQ(33u, map.getVoxelDownsampled(0.5f)->size());
+}
@@ -50,11 +50,17 @@ void CSimplePointsMap::reserve(size_t newLength)
 // Resizes all point buffers so they can hold the given number of points: newly created points are set to default values,
 //  and old contents are not changed.
 void CSimplePointsMap::resize(size_t newLength)
+{
+	resizeFast(newLength);
+	mark_as_modified();
+}
+
+void CSimplePointsMap::resizeFast(size_t newLength)
 {
 	x.resize( newLength, 0 );
 	y.resize( newLength, 0 );
 	z.resize( newLength, 0 );
-	mark_as_modified();
+	// mark_as_modified(); -> Fast
 }
 
 // Resizes all point buffers so they can hold the given number of points, *erasing* all previous contents
@@ -52,11 +52,18 @@ void CWeightedPointsMap::reserve(size_t newLength)
 // Resizes all point buffers so they can hold the given number of points: newly created points are set to default values,
 //  and old contents are not changed.
 void CWeightedPointsMap::resize(size_t newLength)
+{
+	resizeFast(newLength);
+	mark_as_modified();
+}
+
+void CWeightedPointsMap::resizeFast(size_t newLength)
 {
 	x.resize( newLength, 0 );
 	y.resize( newLength, 0 );
 	z.resize( newLength, 0 );
 	pointWeight.resize(newLength, 1);
+	// mark_as_modified(); -> Fast
 }
 
 // Resizes all point buffers so they can hold the given number of points, *erasing* all previous contents
@@ -32,7 +32,8 @@ TEST(SerializeTestMaps, WriteReadToMem)
 		CLASS_ID( COccupancyGridMap2D),
 		CLASS_ID( CSimplePointsMap),
 		CLASS_ID( CWeightedPointsMap),
-		CLASS_ID( COctoMap)
+		CLASS_ID( COctoMap),
+		CLASS_ID( CColouredOctoMap)
 		};
 
 	for (size_t i=0;i<sizeof(lstClasses)/sizeof(lstClasses[0]);i++)
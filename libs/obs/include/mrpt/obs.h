@@ -50,6 +50,8 @@
 
 // Others:
 #include <mrpt/slam/CRawlog.h>
+#include <mrpt/slam/CChunkedRawlogReader.h>
+#include <mrpt/slam/CChunkedRawlogWriter.h>
 #include <mrpt/slam/carmen_log_tools.h>
 
 // Very basic classes for maps:
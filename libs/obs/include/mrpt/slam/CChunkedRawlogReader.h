@@ -0,0 +1,161 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef CChunkedRawlogReader_H
+#define CChunkedRawlogReader_H
+
+#include <mrpt/utils/CSerializable.h>
+#include <mrpt/utils/CStream.h>
+#include <mrpt/utils/CFileInputStream.h>
+#include <mrpt/system/datetime.h>
+#include <mrpt/obs/link_pragmas.h>
+
+namespace mrpt
+{
+	namespace slam
+	{
+		/** The information kept in the index of a chunked rawlog file for each of its entries.
+		  * \sa CChunkedRawlogReader, CChunkedRawlogWriter
+		  * \ingroup mrpt_obs_grp
+		  */
+		struct OBS_IMPEXP TChunkedRawlogEntry
+		{
+			TChunkedRawlogEntry() : timestamp(INVALID_TIMESTAMP), chunk(0), offset(0), size(0) { }
+
+			mrpt::system::TTimeStamp timestamp; //!< The timestamp of the observation, or of the first observation/action of a sensory frame/action collection (INVALID_TIMESTAMP if unknown)
+			uint32_t    chunk;       //!< The index of the chunk which contains the entry
+			uint32_t    offset;      //!< The offset of the serialized entry within its chunk (once uncompressed)
+			uint32_t    size;        //!< The length of the serialized entry (in bytes)
+			std::string sensorLabel; //!< The sensor label of observations (empty for sensory frames and action collections)
+			std::string className;   //!< The class of the entry (e.g. "CObservation2DRangeScan", "CSensoryFrame")
+		};
+
+		/** Reads a rawlog file in the chunked & indexed format written by CChunkedRawlogWriter.
+		  *
+		  *  Through the CStream interface, this class gives the entries of the rawlog exactly as in a plain rawlog file (the objects
+		  *   serialized one after another), so it can be passed as input stream to CRawlog::readActionObservationPair(),
+		  *   CRawlog::getActionObservationPairOrObservation() or the ">>" operator. However, only one chunk is decompressed at a time,
+		  *   and thanks to the index at the end of the file any entry can be reached directly with seekToEntry() or seekToTimestamp().
+		  *
+		  *  Note that positions (getPosition, Seek, getTotalBytesCount) refer to the stream of uncompressed data.
+		  *
+		  * \code
+		  *  CChunkedRawlogReader  f("dataset.rawlog");
+		  *  f.seekToTimestamp( t );  // Jump to the first entry at or after "t"
+		  *  CActionCollectionPtr acts; CSensoryFramePtr SF; CObservationPtr obs;
+		  *  size_t idx = 0;
+		  *  while (CRawlog::getActionObservationPairOrObservation(f,acts,SF,obs,idx)) { ... }
+		  * \endcode
+		  *
+		  * \sa CChunkedRawlogWriter, CRawlog::loadFromRawLogFile
+		  * \ingroup mrpt_obs_grp
+		  */
+		class OBS_IMPEXP CChunkedRawlogReader : public mrpt::utils::CStream, public mrpt::utils::CUncopiable
+		{
+		protected:
+			/** Reads from the uncompressed stream of entries, decompressing the chunks as needed. Returns 0 at the end of the stream. */
+			size_t  Read(void *Buffer, size_t Count);
+
+			/** This stream is read-only: this method always throws an exception. */
+			size_t  Write(const void *Buffer, size_t Count);
+
+		public:
+			/** The first bytes of every chunked rawlog file */
+			static const char FILE_MAGIC[9];
+
+			/** The version of the file format written by CChunkedRawlogWriter */
+			static const uint32_t FILE_FORMAT_VERSION = 1;
+
+			/** Default constructor: use open() afterwards */
+			CChunkedRawlogReader();
+
+			/** Constructor which opens a file
+			  * \exception std::exception On error opening the file, or if it is not a valid chunked rawlog.
+			  */
+			CChunkedRawlogReader(const std::string &fileName);
+
+			virtual ~CChunkedRawlogReader();
+
+			/** Opens a chunked rawlog file and loads its index. The read position is left at the first entry.
+			  * \return false if the file does not exist or it is not a valid chunked rawlog.
+			  */
+			bool open(const std::string &fileName);
+
+			/** Closes the file and frees the index and buffers */
+			void close();
+
+			/** Says if a file is open and its index was loaded correctly */
+			inline bool fileOpenCorrectly() const { return m_is_open; }
+
+			/** Returns true if the given file exists and starts with the header of a chunked rawlog (it only reads the first bytes of the file) */
+			static bool isChunkedRawlog(const std::string &fileName);
+
+			/** @name Index-based access
+			    @{ */
+
+			/** The number of entries (objects) in the rawlog */
+			inline size_t getEntryCount() const { return m_entries.size(); }
+
+			/** The information in the index for the given entry \exception std::exception On index out of bounds */
+			const TChunkedRawlogEntry & getEntry(const size_t index) const;
+
+			/** The whole index, in the order of the entries in the file */
+			inline const std::vector<TChunkedRawlogEntry> & getIndex() const { return m_entries; }
+
+			/** Moves the read position to the beginning of the given entry (an index equal to getEntryCount() moves to the end of the stream).
+			  * \exception std::exception On index out of bounds */
+			void seekToEntry(const size_t index);
+
+			/** Moves the read position to the first entry (in file order) with the lowest timestamp equal or greater than \a t, and returns its index.
+			  *  Entries without a valid timestamp are ignored. If all timestamps are lower than \a t, moves to the end of the stream and returns getEntryCount().
+			  */
+			size_t seekToTimestamp(const mrpt::system::TTimeStamp t);
+
+			/** Deserializes one entry, decompressing just its chunk (if it was not the last chunk read). The read position is left after that entry.
+			  * \exception std::exception On index out of bounds or corrupted data */
+			mrpt::utils::CSerializablePtr readEntry(const size_t index);
+
+			/** @} */
+
+			/** Moves the read position within the uncompressed stream of entries. See CStream::Seek */
+			uint64_t Seek(uint64_t Offset, CStream::TSeekOrigin Origin = sFromBeginning);
+
+			/** The total length of the uncompressed stream of entries */
+			uint64_t getTotalBytesCount();
+
+			/** The current read position within the uncompressed stream of entries */
+			uint64_t getPosition();
+
+		private:
+			struct TChunk
+			{
+				uint64_t file_offset;       //!< Where the compressed data starts in the file
+				uint32_t compressed_size;
+				uint32_t uncompressed_size;
+				uint64_t stream_offset;     //!< Where the chunk starts in the uncompressed stream
+			};
+
+			mrpt::utils::CFileInputStream  m_file;
+			bool                           m_is_open;
+			std::vector<TChunk>            m_chunks;
+			std::vector<TChunkedRawlogEntry> m_entries;
+			std::vector<std::pair<mrpt::system::TTimeStamp,size_t> > m_sorted_timestamps; //!< (timestamp,entry index), sorted, for seekToTimestamp()
+			uint64_t                       m_total_size;   //!< Length of the uncompressed stream
+			uint64_t                       m_position;     //!< Read position in the uncompressed stream
+			size_t                         m_loaded_chunk; //!< The chunk in m_chunk_data, or std::string::npos if none
+			std::vector<unsigned char>     m_chunk_data, m_compressed_data;
+
+			bool loadIndex();
+			void loadChunk(const size_t idx); //!< Decompresses a chunk into m_chunk_data, if not already there
+			size_t findChunk(const uint64_t stream_pos) const; //!< The chunk which contains a position of the uncompressed stream
+		}; // End of class def.
+
+	} // End of namespace
+} // End of namespace
+
+#endif
@@ -0,0 +1,101 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef CChunkedRawlogWriter_H
+#define CChunkedRawlogWriter_H
+
+#include <mrpt/slam/CChunkedRawlogReader.h>
+#include <mrpt/utils/CFileOutputStream.h>
+#include <mrpt/utils/CMemoryStream.h>
+
+namespace mrpt
+{
+	namespace slam
+	{
+		/** Writes a rawlog file in a chunked & indexed format, which allows random access to its entries without reading
+		  *  (and decompressing) the whole file. Read it with CChunkedRawlogReader, or with CRawlog::loadFromRawLogFile(), which detects the format.
+		  *
+		  *  The entries (CSensoryFrame, CActionCollection or CObservation objects, as in a plain rawlog file) are serialized one after
+		  *   another into chunks of about \a chunkSize bytes, and each chunk is compressed independently with zlib (an entry never spans two chunks).
+		  *   The file ends with an index of all the chunks (their file offsets and sizes) and of all the entries (their chunk, offset within
+		  *   the chunk, timestamp, sensor label and class name), so a reader can go to any entry by decompressing a single chunk.
+		  *
+		  *  File layout (all integers in little endian):
+		  *   - Header: "MRPTRAWC" + uint32 format version.
+		  *   - The compressed chunks, one after another.
+		  *   - Index: uint32 number of chunks, and for each one: uint64 file offset, uint32 compressed size, uint32 uncompressed size.
+		  *     Then uint32 number of entries, and for each one: uint64 timestamp, uint32 chunk, uint32 offset, uint32 size, sensor label and class name (as strings in a CStream).
+		  *   - Footer: uint64 file offset of the index + "MRPTRAWC".
+		  *
+		  * \code
+		  *  CChunkedRawlogWriter  f("dataset.rawlog");
+		  *  f.write(*obs1);
+		  *  f.write(*obs2);
+		  *  f.close();  // Writes the index (also done by the destructor)
+		  * \endcode
+		  *
+		  * \sa CChunkedRawlogReader, CRawlog::saveToChunkedRawLogFile
+		  * \ingroup mrpt_obs_grp
+		  */
+		class OBS_IMPEXP CChunkedRawlogWriter : public mrpt::utils::CUncopiable
+		{
+		public:
+			/** The default (uncompressed) size of chunks: 1 MiB */
+			static const size_t DEFAULT_CHUNK_SIZE = 1<<20;
+
+			/** Default constructor: use open() afterwards */
+			CChunkedRawlogWriter();
+
+			/** Constructor which creates a file
+			  * \exception std::exception On error creating the file */
+			CChunkedRawlogWriter(const std::string &fileName, const size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+			/** Destructor: calls close() */
+			virtual ~CChunkedRawlogWriter();
+
+			/** Creates (or overwrites) a file and writes the header. Any previous file is closed first.
+			  * \param chunkSize The approximate size of chunks before compression: larger chunks compress better, smaller ones are faster to seek into.
+			  * \return false on error creating the file.
+			  */
+			bool open(const std::string &fileName, const size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+			/** Says if a file is open for writing */
+			inline bool isOpen() const { return m_is_open; }
+
+			/** Appends one entry to the rawlog: normally a CSensoryFrame, CActionCollection or CObservation object.
+			  * \exception std::exception If no file is open or on a write error */
+			void write(const mrpt::utils::CSerializable &obj);
+
+			/** Writes the last chunk and the index, and closes the file. Does nothing if no file is open. */
+			void close();
+
+			/** The number of entries written so far */
+			inline size_t getEntryCount() const { return m_entries.size(); }
+
+		private:
+			struct TChunk
+			{
+				uint64_t file_offset;
+				uint32_t compressed_size;
+				uint32_t uncompressed_size;
+			};
+
+			mrpt::utils::CFileOutputStream   m_file;
+			bool                             m_is_open;
+			size_t                           m_chunk_size;
+			mrpt::utils::CMemoryStream       m_chunk;   //!< The chunk being filled (uncompressed)
+			std::vector<TChunk>              m_chunks;
+			std::vector<TChunkedRawlogEntry> m_entries;
+
+			void flushChunk(); //!< Compresses and writes the current chunk, if not empty
+		}; // End of class def.
+
+	} // End of namespace
+} // End of namespace
+
+#endif
@@ -25,10 +25,29 @@ namespace slam
 {
 	DEFINE_SERIALIZABLE_PRE_CUSTOM_BASE_LINKAGE( CObservation3DRangeScan, CObservation,OBS_IMPEXP )
 
+	/** Used in CObservation3DRangeScan::project3DPointsFromDepthImageInto()
+	  * \ingroup mrpt_obs_grp */
+	struct T3DPointsProjectionParams
+	{
+		bool takeIntoAccountSensorPoseOnRobot;             //!< (Default: false) If false, local (sensor-centric) coordinates of points are generated. Otherwise, points are transformed with \a sensorPose. Furthermore, if provided, those coordinates are transformed with \a robotPoseInTheWorld
+		const mrpt::poses::CPose3D *robotPoseInTheWorld;   //!< (Default: NULL) Read takeIntoAccountSensorPoseOnRobot
+		bool PROJ3D_USE_LUT;     //!< (Default: true) [Only when range_is_depth=true] Whether to use a Look-up-table (LUT) to speed up the conversion. LUTs are cached for the last few camera parameters and image sizes, so several cameras can share it, even from different threads.
+		bool USE_SIMD;           //!< (Default: true) [Only with the LUT and decimation=1] Use SSE2, or AVX2 if MRPT is built with it (see MRPT_HAS_AVX2).
+		float rangeMin;          //!< (Default: 0) If >0, pixels whose value in \a rangeImage is below this value are not projected (this also discards invalid pixels, with zero range).
+		float rangeMax;          //!< (Default: 0) If >0, pixels whose value in \a rangeImage is above this value are not projected.
+		unsigned int decimation; //!< (Default: 1) Only one of every \a decimation rows and columns is projected.
+		size_t parallelMinPoints;//!< (Default: 50000) Images with at least this number of pixels are projected by blocks of rows in parallel (see mrpt::system::parallel_for). Set to 0 to always project serially.
+
+		T3DPointsProjectionParams() :
+			takeIntoAccountSensorPoseOnRobot(false), robotPoseInTheWorld(NULL), PROJ3D_USE_LUT(true), USE_SIMD(true),
+			rangeMin(0), rangeMax(0), decimation(1), parallelMinPoints(50000)
+		{ }
+	};
+
 	namespace detail {
 		// Implemented in CObservation3DRangeScan_project3D_impl.h
 		template <class POINTMAP>
-		void project3DPointsFromDepthImageInto(CObservation3DRangeScan    & src_obs,POINTMAP                   & dest_pointcloud,const bool                   takeIntoAccountSensorPoseOnRobot,const mrpt::poses::CPose3D * robotPoseInTheWorld,const bool                   PROJ3D_USE_LUT);
+		void project3DPointsFromDepthImageInto(CObservation3DRangeScan & src_obs, POINTMAP & dest_pointcloud, const T3DPointsProjectionParams & projectParams);
 	}
 
 	/** Declares a class derived from "CObservation" that
@@ -155,19 +174,35 @@ namespace slam
 		  *  By default the local coordinates of points are directly stored into the local map, but if indicated so in \a takeIntoAccountSensorPoseOnRobot
 		  *  the points are transformed with \a sensorPose. Furthermore, if provided, those coordinates are transformed with \a robotPoseInTheWorld
 		  *
-		  * \param[in] PROJ3D_USE_LUT (Only when range_is_depth=true) Whether to use a Look-up-table (LUT) to speed up the conversion. It's thread safe in all situations <b>except</b> when you call this method from different threads <b>and</b> with different camera parameter matrices. In all other cases, it's a good idea to left it enabled.
+		  *  The projection, coloring and transformation of each point are done in one pass over the range image, by blocks of rows in parallel for large images,
+		  *   writing each point directly into its final position of \a dest_pointcloud, which is resized only once (so a map reused for each frame is not reallocated).
+		  *   The range image can be filtered and decimated on the fly, see T3DPointsProjectionParams.
+		  *
 		  * \tparam POINTMAP Supported maps are all those covered by mrpt::utils::PointCloudAdapter (mrpt::slam::CPointsMap and derived, mrpt::opengl::CPointCloudColoured, PCL point clouds,...)
 		  *
 		  * \note In MRPT < 0.9.5, this method always assumes that ranges were in Kinect-like format.
 		  */
 		template <class POINTMAP>
+		inline void project3DPointsFromDepthImageInto(
+			POINTMAP                         & dest_pointcloud,
+			const T3DPointsProjectionParams  & projectParams )
+		{
+			detail::project3DPointsFromDepthImageInto<POINTMAP>(*this,dest_pointcloud,projectParams);
+		}
+
+		/** \overload With the default parameters (see T3DPointsProjectionParams) except the pose ones and the use of a LUT. */
+		template <class POINTMAP>
 		inline void project3DPointsFromDepthImageInto(
 			POINTMAP                   & dest_pointcloud,
 			const bool takeIntoAccountSensorPoseOnRobot,
 			const mrpt::poses::CPose3D *robotPoseInTheWorld=NULL,
 			const bool PROJ3D_USE_LUT=true)
 		{
-			detail::project3DPointsFromDepthImageInto<POINTMAP>(*this,dest_pointcloud,takeIntoAccountSensorPoseOnRobot,robotPoseInTheWorld,PROJ3D_USE_LUT);
+			T3DPointsProjectionParams pp;
+			pp.takeIntoAccountSensorPoseOnRobot = takeIntoAccountSensorPoseOnRobot;
+			pp.robotPoseInTheWorld = robotPoseInTheWorld;
+			pp.PROJ3D_USE_LUT = PROJ3D_USE_LUT;
+			detail::project3DPointsFromDepthImageInto<POINTMAP>(*this,dest_pointcloud,pp);
 		}
 
 		/** This method is equivalent to \c project3DPointsFromDepthImageInto() storing the projected 3D points (without color, in local coordinates) in this same class.
@@ -317,9 +352,15 @@ namespace slam
 		struct TCached3DProjTables
 		{
 			mrpt::vector_float Kzs,Kys;
-			TCamera  prev_camParams;
+			TCamera  camParams;
+			int      W,H;
 		};
-		static TCached3DProjTables m_3dproj_lut; //!< 3D point cloud projection look-up-table \sa project3DPointsFromDepthImage
+		typedef stlplus::smart_ptr<const TCached3DProjTables> TCached3DProjTablesPtr;
+
+		/** Returns the 3D point cloud projection look-up-table for the given depth camera parameters and range image size.
+		  *  The tables of the last few cameras are kept in a cache shared by all the observations, so this is thread-safe and cheap for a rig of several cameras.
+		  * \sa project3DPointsFromDepthImageInto */
+		static TCached3DProjTablesPtr get3DProjectionLUT(const TCamera &camParams, const int W, const int H);
 
 	}; // End of class def.
 
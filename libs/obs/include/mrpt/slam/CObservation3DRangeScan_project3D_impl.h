@@ -9,299 +9,415 @@
 #ifndef CObservation3DRangeScan_project3D_impl_H
 #define CObservation3DRangeScan_project3D_impl_H
 
+#include <mrpt/utils/SSE_types.h>
+#include <mrpt/system/parallelization.h>
+#include <limits>
+
 namespace mrpt {
 namespace slam {
 namespace detail {
-	// Auxiliary functions which implement SSE-optimized proyection of 3D point cloud:
-	template <class POINTMAP> void do_project_3d_pointcloud(const int H,const int W,const float *kys,const float *kzs,const mrpt::math::CMatrix &rangeImage, mrpt::utils::PointCloudAdapter<POINTMAP> &pca);
-	template <class POINTMAP> void do_project_3d_pointcloud_SSE2(const int H,const int W,const float *kys,const float *kzs,const mrpt::math::CMatrix &rangeImage, mrpt::utils::PointCloudAdapter<POINTMAP> &pca);
+	/** Everything needed to project any row of a range image, computed once per call to project3DPointsFromDepthImageInto() */
+	struct TProject3DContext
+	{
+		const mrpt::math::CMatrix *rangeImage;
+		int    W, H;        // Size of the range image
+		int    dec;         // Decimation
+		int    Wd;          // Number of projected columns of each row
+		const float *kys, *kzs;  // The LUT (NULL if not used)
+		float  r_cx, r_cy, r_fx_inv, r_fy_inv;  // Depth camera
+		bool   range_is_depth;
+		bool   use_simd;
+		bool   filter_min, filter_max;
+		float  rangeMin, rangeMax;
+
+		// Colors from the intensity image:
+		bool   do_color;
+		bool   isDirectCorresp;
+		bool   hasColorIntensityImg;
+		int    imgW, imgH;
+		const uint8_t *img_pixels;  // First pixel of the intensity image
+		size_t img_stride;          // Bytes per row
+		float  cx, cy, fx, fy;      // Intensity camera
+		float  T_inv[3][4];         // From the depth to the intensity camera
+
+		// Final 6D transformation:
+		bool   do_transf;
+		float  HM[3][4];
+
+		inline bool passFilter(const float D) const {
+			return (!filter_min || D>=rangeMin) && (!filter_max || D<=rangeMax);
+		}
+	};
 
+	/** Projects the point (x,y,z), in coordinates local to the depth camera, into the intensity image and sets its color */
 	template <class POINTMAP>
-	void project3DPointsFromDepthImageInto(
-			CObservation3DRangeScan    & src_obs,
-			POINTMAP                   & dest_pointcloud,
-			const bool                   takeIntoAccountSensorPoseOnRobot,
-			const mrpt::poses::CPose3D * robotPoseInTheWorld,
-			const bool                   PROJ3D_USE_LUT)
+	inline void project3D_setColor(const TProject3DContext &ctx, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, const size_t idx, const int r, const int c, const float x, const float y, const float z)
 	{
-		using namespace mrpt::math;
+		int img_idx_x=0, img_idx_y=0; // projected pixel coordinates, in the RGB image plane
+		bool pointWithinImage = false;
+		if (ctx.isDirectCorresp)
+		{
+			img_idx_x = c;
+			img_idx_y = r;
+			pointWithinImage = c<ctx.imgW && r<ctx.imgH;
+		}
+		else
+		{
+			const float px = ctx.T_inv[0][0]*x + ctx.T_inv[0][1]*y + ctx.T_inv[0][2]*z + ctx.T_inv[0][3];
+			const float py = ctx.T_inv[1][0]*x + ctx.T_inv[1][1]*y + ctx.T_inv[1][2]*z + ctx.T_inv[1][3];
+			const float pz = ctx.T_inv[2][0]*x + ctx.T_inv[2][1]*y + ctx.T_inv[2][2]*z + ctx.T_inv[2][3];
+
+			// Project to image plane:
+			if (pz) {
+				img_idx_x = mrpt::utils::round( ctx.cx + ctx.fx * px/pz );
+				img_idx_y = mrpt::utils::round( ctx.cy + ctx.fy * py/pz );
+				pointWithinImage=
+					img_idx_x>=0 && img_idx_x<ctx.imgW &&
+					img_idx_y>=0 && img_idx_y<ctx.imgH;
+			}
+		}
 
-		if (!src_obs.hasRangeImage) return;
+		if (pointWithinImage)
+		{
+			const uint8_t *p = ctx.img_pixels + img_idx_y*ctx.img_stride;
+			if (ctx.hasColorIntensityImg) {
+				p+= 3*img_idx_x;
+				pca.setPointRGBu8(idx,p[2],p[1],p[0]);
+			}
+			else {
+				p+= img_idx_x;
+				pca.setPointRGBu8(idx,p[0],p[0],p[0]);
+			}
+		}
+		else
+		{
+			pca.setPointRGBu8(idx,255,255,255);
+		}
+	}
 
-		mrpt::utils::PointCloudAdapter<POINTMAP> pca(dest_pointcloud);
+	/** Sets one point from its coordinates local to the depth camera, applying the color and the transformation, if needed */
+	template <class POINTMAP>
+	inline void project3D_setPoint(const TProject3DContext &ctx, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, const size_t idx, const int r, const int c, const float x, const float y, const float z)
+	{
+		if (ctx.do_transf)
+			pca.setPointXYZ(idx,
+				ctx.HM[0][0]*x + ctx.HM[0][1]*y + ctx.HM[0][2]*z + ctx.HM[0][3],
+				ctx.HM[1][0]*x + ctx.HM[1][1]*y + ctx.HM[1][2]*z + ctx.HM[1][3],
+				ctx.HM[2][0]*x + ctx.HM[2][1]*y + ctx.HM[2][2]*z + ctx.HM[2][3] );
+		else
+			pca.setPointXYZ(idx,x,y,z);
 
-		// ------------------------------------------------------------
-		// Stage 1/3: Create 3D point cloud local coordinates
-		// ------------------------------------------------------------
-		const int W = src_obs.rangeImage.cols();
-		const int H = src_obs.rangeImage.rows();
-		const size_t WH = W*H;
+		if (ctx.do_color)
+			project3D_setColor(ctx,pca,idx,r,c,x,y,z);
+	}
 
-		// Reserve memory for 3D points:
-		pca.resize(WH);
+#if MRPT_HAS_SSE2
+	/** Sets the points of a block of SIMD lanes which passed the range filter (those with their bit set in \a mask) */
+	template <class POINTMAP>
+	inline void project3D_setLanes(
+		const TProject3DContext &ctx, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, const int r, const int c0, const int nLanes, const int mask,
+		const float *xs,const float *ys,const float *zs, const float *txs,const float *tys,const float *tzs, size_t &idx)
+	{
+		for (int k=0;k<nLanes;k++)
+		{
+			if (!(mask & (1<<k))) continue;
+			if (ctx.do_transf)
+					pca.setPointXYZ(idx,txs[k],tys[k],tzs[k]);
+			else	pca.setPointXYZ(idx,xs[k],ys[k],zs[k]);
+			if (ctx.do_color)
+				project3D_setColor(ctx,pca,idx,r,c0+k,xs[k],ys[k],zs[k]);
+			idx++;
+		}
+	}
 
-		if (src_obs.range_is_depth)
+	/** Projects as many columns of row \a r as possible 8 (AVX2) or 4 (SSE2) at a time, using the LUT (range_is_depth=true, no decimation).
+	  * \return The number of processed columns. */
+	template <class POINTMAP>
+	int project3D_row_SIMD(const TProject3DContext &ctx, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, const int r, const float *D_ptr, size_t &idx)
+	{
+		const float *kys = ctx.kys + size_t(r)*ctx.W;
+		const float *kzs = ctx.kzs + size_t(r)*ctx.W;
+		const bool do_filter = ctx.filter_min || ctx.filter_max;
+		const float rmin = ctx.filter_min ? ctx.rangeMin : -std::numeric_limits<float>::max();
+		const float rmax = ctx.filter_max ? ctx.rangeMax :  std::numeric_limits<float>::max();
+
+		EIGEN_ALIGN16 float xs[8],ys[8],zs[8],txs[8],tys[8],tzs[8];
+		int c=0;
+
+	#if MRPT_HAS_AVX2
+		{
+			const __m256 RMIN = _mm256_set1_ps(rmin), RMAX = _mm256_set1_ps(rmax);
+			__m256 hm[3][4];
+			for (int i=0;i<3;i++)
+				for (int j=0;j<4;j++)
+					hm[i][j] = _mm256_set1_ps(ctx.HM[i][j]);
+
+			for ( ; c+8<=ctx.W; c+=8)
+			{
+				const __m256 D = _mm256_loadu_ps(D_ptr+c);
+				const int mask = do_filter ?
+					_mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(D,RMIN,_CMP_GE_OQ),_mm256_cmp_ps(D,RMAX,_CMP_LE_OQ))) : 0xFF;
+				if (!mask) continue;
+
+				const __m256 Y = _mm256_mul_ps(_mm256_loadu_ps(kys+c),D);
+				const __m256 Z = _mm256_mul_ps(_mm256_loadu_ps(kzs+c),D);
+				_mm256_storeu_ps(xs,D);
+				_mm256_storeu_ps(ys,Y);
+				_mm256_storeu_ps(zs,Z);
+				if (ctx.do_transf)
+				{
+					float *outs[3] = {txs,tys,tzs};
+					for (int i=0;i<3;i++)
+						_mm256_storeu_ps(outs[i], _mm256_add_ps(
+							_mm256_add_ps(_mm256_mul_ps(hm[i][0],D),_mm256_mul_ps(hm[i][1],Y)),
+							_mm256_add_ps(_mm256_mul_ps(hm[i][2],Z),hm[i][3]) ) );
+				}
+				project3D_setLanes(ctx,pca,r,c,8,mask,xs,ys,zs,txs,tys,tzs,idx);
+			}
+		}
+	#endif
 		{
-			// range_is_depth = true
+			const __m128 RMIN = _mm_set1_ps(rmin), RMAX = _mm_set1_ps(rmax);
+			__m128 hm[3][4];
+			for (int i=0;i<3;i++)
+				for (int j=0;j<4;j++)
+					hm[i][j] = _mm_set1_ps(ctx.HM[i][j]);
 
-			// Use cached tables?
-			if (PROJ3D_USE_LUT)
+			for ( ; c+4<=ctx.W; c+=4)
 			{
-				// Use LUT:
-				if (src_obs.m_3dproj_lut.prev_camParams!=src_obs.cameraParams || WH!=size_t(src_obs.m_3dproj_lut.Kys.size()))
+				const __m128 D = _mm_loadu_ps(D_ptr+c);
+				const int mask = do_filter ?
+					_mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(D,RMIN),_mm_cmple_ps(D,RMAX))) : 0x0F;
+				if (!mask) continue;
+
+				const __m128 Y = _mm_mul_ps(_mm_loadu_ps(kys+c),D);
+				const __m128 Z = _mm_mul_ps(_mm_loadu_ps(kzs+c),D);
+				_mm_storeu_ps(xs,D);
+				_mm_storeu_ps(ys,Y);
+				_mm_storeu_ps(zs,Z);
+				if (ctx.do_transf)
 				{
-					src_obs.m_3dproj_lut.prev_camParams = src_obs.cameraParams;
-					src_obs.m_3dproj_lut.Kys.resize(WH);
-					src_obs.m_3dproj_lut.Kzs.resize(WH);
-
-					const float r_cx = src_obs.cameraParams.cx();
-					const float r_cy = src_obs.cameraParams.cy();
-					const float r_fx_inv = 1.0f/src_obs.cameraParams.fx();
-					const float r_fy_inv = 1.0f/src_obs.cameraParams.fy();
-
-					float *kys = &src_obs.m_3dproj_lut.Kys[0];
-					float *kzs = &src_obs.m_3dproj_lut.Kzs[0];
-					for (int r=0;r<H;r++)
-						for (int c=0;c<W;c++)
-						{
-							*kys++ = (r_cx - c) * r_fx_inv;
-							*kzs++ = (r_cy - r) * r_fy_inv;
-						}
-				} // end update LUT.
-
-				ASSERT_EQUAL_(WH,size_t(src_obs.m_3dproj_lut.Kys.size()))
-				ASSERT_EQUAL_(WH,size_t(src_obs.m_3dproj_lut.Kzs.size()))
-				float *kys = &src_obs.m_3dproj_lut.Kys[0];
-				float *kzs = &src_obs.m_3dproj_lut.Kzs[0];
+					float *outs[3] = {txs,tys,tzs};
+					for (int i=0;i<3;i++)
+						_mm_storeu_ps(outs[i], _mm_add_ps(
+							_mm_add_ps(_mm_mul_ps(hm[i][0],D),_mm_mul_ps(hm[i][1],Y)),
+							_mm_add_ps(_mm_mul_ps(hm[i][2],Z),hm[i][3]) ) );
+				}
+				project3D_setLanes(ctx,pca,r,c,4,mask,xs,ys,zs,txs,tys,tzs,idx);
+			}
+		}
+		return c;
+	}
+#endif
+
+	/** Projects the (decimated) rows [rd_begin,rd_end) of the range image, the first point of each one into \a row_out_idx[rd] */
+	template <class POINTMAP>
+	void project3D_rows(const TProject3DContext &ctx, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, const int rd_begin, const int rd_end, const size_t *row_out_idx)
+	{
+		for (int rd=rd_begin;rd<rd_end;rd++)
+		{
+			const int r = rd*ctx.dec;
+			const float *D_ptr = ctx.rangeImage->data() + size_t(r)*ctx.W;  // Row-major matrix
+			size_t idx = row_out_idx[rd];
+			int c=0;
 
 	#if MRPT_HAS_SSE2
-				if ((W & 0x07)==0)
-						do_project_3d_pointcloud_SSE2(H,W,kys,kzs,src_obs.rangeImage,pca);
-				else	do_project_3d_pointcloud(H,W,kys,kzs,src_obs.rangeImage,pca);  // if image width is not 8*N, use standard method
-	#else
-				do_project_3d_pointcloud(H,W,kys,kzs,src_obs.rangeImage,pca);
+			if (ctx.use_simd)
+				c = project3D_row_SIMD(ctx,pca,r,D_ptr,idx);
 	#endif
+
+			if (ctx.kys)
+			{
+				// Use LUT (range_is_depth=true):
+				const float *kys = ctx.kys + size_t(r)*ctx.W;
+				const float *kzs = ctx.kzs + size_t(r)*ctx.W;
+				for ( ;c<ctx.W;c+=ctx.dec)
+				{
+					const float D = D_ptr[c];
+					if (!ctx.passFilter(D)) continue;
+					project3D_setPoint(ctx,pca,idx++,r,c, D, kys[c]*D, kzs[c]*D);
+				}
 			}
 			else
 			{
-				// Without LUT:
-				const float r_cx =  src_obs.cameraParams.cx();
-				const float r_cy = src_obs.cameraParams.cy();
-				const float r_fx_inv = 1.0f/src_obs.cameraParams.fx();
-				const float r_fy_inv = 1.0f/src_obs.cameraParams.fy();
-				size_t idx=0;
-				for (int r=0;r<H;r++)
-					for (int c=0;c<W;c++)
-					{
-						const float Kz = (r_cy - r) * r_fy_inv;
-						const float Ky = (r_cx - c) * r_fx_inv;
-						const float D = src_obs.rangeImage.coeff(r,c);
-						pca.setPointXYZ(idx++,
-							D,        // x
-							Ky * D,   // y
-							Kz * D    // z
-							);
-					}
+				const float Kz = (ctx.r_cy - r) * ctx.r_fy_inv;
+				for ( ;c<ctx.W;c+=ctx.dec)
+				{
+					const float D = D_ptr[c];
+					if (!ctx.passFilter(D)) continue;
+					const float Ky = (ctx.r_cx - c) * ctx.r_fx_inv;
+					if (ctx.range_is_depth)
+							project3D_setPoint(ctx,pca,idx++,r,c, D, Ky*D, Kz*D);
+					else	project3D_setPoint(ctx,pca,idx++,r,c, D/std::sqrt(1+Ky*Ky+Kz*Kz), Ky*D, Kz*D);
+				}
 			}
 		}
-		else
+	}
+
+	/** Body for mrpt::system::parallel_for: projects blocks of rows */
+	template <class POINTMAP>
+	struct TProject3DRowsBody
+	{
+		const TProject3DContext                  &m_ctx;
+		mrpt::utils::PointCloudAdapter<POINTMAP> &m_pca;
+		const size_t                             *m_row_out_idx;
+
+		TProject3DRowsBody(const TProject3DContext &ctx, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, const size_t *row_out_idx) :
+			m_ctx(ctx),m_pca(pca),m_row_out_idx(row_out_idx) { }
+
+		void operator()(const mrpt::system::BlockedRange &r) const {
+			project3D_rows(m_ctx,m_pca,r.begin(),r.end(),m_row_out_idx);
+		}
+	};
+
+	/** Body for mrpt::system::parallel_for: counts the pixels of each (decimated) row which pass the range filter, into \a row_counts[rd+1] */
+	struct TProject3DCountBody
+	{
+		const TProject3DContext &m_ctx;
+		size_t                  *m_row_counts;
+
+		TProject3DCountBody(const TProject3DContext &ctx, size_t *row_counts) : m_ctx(ctx),m_row_counts(row_counts) { }
+
+		void operator()(const mrpt::system::BlockedRange &r) const
 		{
-			/* range_is_depth = false :
-			  *   Ky = (r_cx - c)/r_fx
-			  *   Kz = (r_cy - r)/r_fy
-			  *
-			  *   x(i) = rangeImage(r,c) / sqrt( 1 + Ky^2 + Kz^2 )
-			  *   y(i) = Ky * x(i)
-			  *   z(i) = Kz * x(i)
-			  */
-			const float r_cx = src_obs.cameraParams.cx();
-			const float r_cy = src_obs.cameraParams.cy();
-			const float r_fx_inv = 1.0f/src_obs.cameraParams.fx();
-			const float r_fy_inv = 1.0f/src_obs.cameraParams.fy();
-			size_t idx=0;
-			for (int r=0;r<H;r++)
-				for (int c=0;c<W;c++)
-				{
-					const float Ky = (r_cx - c) * r_fx_inv;
-					const float Kz = (r_cy - r) * r_fy_inv;
-					const float D = src_obs.rangeImage.coeff(r,c);
-					pca.setPointXYZ(idx++,
-						D / std::sqrt(1+Ky*Ky+Kz*Kz), // x
-						Ky * D,   // y
-						Kz * D    // z
-						);
-				}
+			for (int rd=r.begin();rd<r.end();rd++)
+			{
+				const float *D_ptr = m_ctx.rangeImage->data() + size_t(rd*m_ctx.dec)*m_ctx.W;
+				size_t n=0;
+				for (int c=0;c<m_ctx.W;c+=m_ctx.dec)
+					if (m_ctx.passFilter(D_ptr[c])) n++;
+				m_row_counts[rd+1] = n;
+			}
 		}
+	};
+
+	template <class POINTMAP>
+	void project3DPointsFromDepthImageInto(
+			CObservation3DRangeScan         & src_obs,
+			POINTMAP                        & dest_pointcloud,
+			const T3DPointsProjectionParams & projectParams )
+	{
+		using namespace mrpt::math;
 
-		// -------------------------------------------------------------
-		// Stage 2/3: Project local points into RGB image to get colors
-		// -------------------------------------------------------------
-		if (src_obs.hasIntensityImage)
+		if (!src_obs.hasRangeImage) return;
+		ASSERT_ABOVE_(projectParams.decimation,0)
+
+		mrpt::utils::PointCloudAdapter<POINTMAP> pca(dest_pointcloud);
+
+		TProject3DContext ctx;
+		ctx.rangeImage = &src_obs.rangeImage;
+		ctx.W   = src_obs.rangeImage.cols();
+		ctx.H   = src_obs.rangeImage.rows();
+		ctx.dec = static_cast<int>(projectParams.decimation);
+		ctx.Wd  = (ctx.W+ctx.dec-1)/ctx.dec;
+		const int Hd = (ctx.H+ctx.dec-1)/ctx.dec;
+		const size_t WH = size_t(ctx.W)*ctx.H;
+
+		ctx.r_cx = src_obs.cameraParams.cx();
+		ctx.r_cy = src_obs.cameraParams.cy();
+		ctx.r_fx_inv = 1.0f/src_obs.cameraParams.fx();
+		ctx.r_fy_inv = 1.0f/src_obs.cameraParams.fy();
+		ctx.range_is_depth = src_obs.range_is_depth;
+
+		ctx.filter_min = projectParams.rangeMin>0;
+		ctx.filter_max = projectParams.rangeMax>0;
+		ctx.rangeMin = projectParams.rangeMin;
+		ctx.rangeMax = projectParams.rangeMax;
+
+		// Use cached tables? (Keep a reference to the LUT, which may leave the cache while in use)
+		CObservation3DRangeScan::TCached3DProjTablesPtr lut;
+		ctx.kys = ctx.kzs = NULL;
+		if (src_obs.range_is_depth && projectParams.PROJ3D_USE_LUT && WH)
+		{
+			lut = CObservation3DRangeScan::get3DProjectionLUT(src_obs.cameraParams,ctx.W,ctx.H);
+			ctx.kys = &lut->Kys[0];
+			ctx.kzs = &lut->Kzs[0];
+		}
+		ctx.use_simd = projectParams.USE_SIMD && ctx.kys && ctx.dec==1;
+
+		// Colors, only if the point cloud has them:
+		ctx.do_color = mrpt::utils::PointCloudAdapter<POINTMAP>::HAS_RGB && src_obs.hasIntensityImage;
+		if (ctx.do_color)
 		{
-			const int imgW = src_obs.intensityImage.getWidth();
-			const int imgH = src_obs.intensityImage.getHeight();
-			const bool hasColorIntensityImg = src_obs.intensityImage.isColor();
+			ctx.imgW = src_obs.intensityImage.getWidth();   // This also loads a delayed-load image, before going parallel
+			ctx.imgH = src_obs.intensityImage.getHeight();
+			ctx.hasColorIntensityImg = src_obs.intensityImage.isColor();
+			ctx.img_pixels = src_obs.intensityImage.get_unsafe(0,0,0);
+			ctx.img_stride = src_obs.intensityImage.getRowStride();
 
-			const float cx = src_obs.cameraParamsIntensity.cx();
-			const float cy = src_obs.cameraParamsIntensity.cy();
-			const float fx = src_obs.cameraParamsIntensity.fx();
-			const float fy = src_obs.cameraParamsIntensity.fy();
+			ctx.cx = src_obs.cameraParamsIntensity.cx();
+			ctx.cy = src_obs.cameraParamsIntensity.cy();
+			ctx.fx = src_obs.cameraParamsIntensity.fx();
+			ctx.fy = src_obs.cameraParamsIntensity.fy();
 
 			// Unless we are in a special case (both depth & RGB images coincide)...
-			const bool isDirectCorresp = src_obs.doDepthAndIntensityCamerasCoincide();
+			ctx.isDirectCorresp = src_obs.doDepthAndIntensityCamerasCoincide();
 
-			// ...precompute the inverse of the pose transformation out of the loop,
-			//  store as a 4x4 homogeneous matrix to exploit SSE optimizations below:
-			CMatrixFixedNumeric<float,4,4> T_inv;
-			if (!isDirectCorresp)
+			// ...precompute the inverse of the pose transformation out of the loop:
+			if (!ctx.isDirectCorresp)
 			{
 				CMatrixFixedNumeric<double,3,3> R_inv;
 				CMatrixFixedNumeric<double,3,1> t_inv;
 				mrpt::math::homogeneousMatrixInverse(
 					src_obs.relativePoseIntensityWRTDepth.getRotationMatrix(),src_obs.relativePoseIntensityWRTDepth.m_coords,
 					R_inv,t_inv);
-
-				T_inv(3,3)=1;
-				T_inv.block<3,3>(0,0)=R_inv.cast<float>();
-				T_inv.block<3,1>(0,3)=t_inv.cast<float>();
-			}
-
-			Eigen::Matrix<float,4,1>  pt_wrt_color, pt_wrt_depth;
-			pt_wrt_depth[3]=1;
-
-			int img_idx_x=0, img_idx_y=0; // projected pixel coordinates, in the RGB image plane
-			mrpt::utils::TColor pCol;
-
-			// For each local point:
-			for (size_t i=0;i<WH;i++)
-			{
-				bool pointWithinImage = false;
-				if (isDirectCorresp)
-				{
-					pointWithinImage=true;
-					img_idx_x++;
-					if (img_idx_x>=imgW) {
-						img_idx_x=0;
-						img_idx_y++;
-					}
-				}
-				else
-				{
-					// Project point, which is now in "pca" in local coordinates wrt the depth camera, into the intensity camera:
-					pca.getPointXYZ(i,pt_wrt_depth[0],pt_wrt_depth[1],pt_wrt_depth[2]);
-					pt_wrt_color.noalias() = T_inv*pt_wrt_depth;
-
-					// Project to image plane:
-					if (pt_wrt_color[2]) {
-						img_idx_x = mrpt::utils::round( cx + fx * pt_wrt_color[0]/pt_wrt_color[2] );
-						img_idx_y = mrpt::utils::round( cy + fy * pt_wrt_color[1]/pt_wrt_color[2] );
-						pointWithinImage=
-							img_idx_x>=0 && img_idx_x<imgW &&
-							img_idx_y>=0 && img_idx_y<imgH;
-					}
-				}
-
-				if (pointWithinImage)
-				{
-					if (hasColorIntensityImg)  {
-						const uint8_t *c= src_obs.intensityImage.get_unsafe(img_idx_x, img_idx_y, 0);
-						pCol.R = c[2];
-						pCol.G = c[1];
-						pCol.B = c[0];
-					}
-					else{
-						uint8_t c= *src_obs.intensityImage.get_unsafe(img_idx_x, img_idx_y, 0);
-						pCol.R = pCol.G = pCol.B = c;
-					}
-				}
-				else
+				for (int i=0;i<3;i++)
 				{
-					pCol.R = pCol.G = pCol.B = 255;
+					for (int j=0;j<3;j++) ctx.T_inv[i][j] = static_cast<float>(R_inv(i,j));
+					ctx.T_inv[i][3] = static_cast<float>(t_inv(i,0));
 				}
-				// Set color:
-				pca.setPointRGBu8(i,pCol.R,pCol.G,pCol.B);
-			} // end for each point
-		} // end if src_obs has intensity image
-
-		// ...
+			}
+		}
 
-		// ------------------------------------------------------------
-		// Stage 3/3: Apply 6D transformations
-		// ------------------------------------------------------------
-		if (takeIntoAccountSensorPoseOnRobot || robotPoseInTheWorld)
+		// 6D transformation to apply: either ROBOTPOSE or ROBOTPOSE(+)SENSORPOSE or SENSORPOSE
+		ctx.do_transf = projectParams.takeIntoAccountSensorPoseOnRobot || projectParams.robotPoseInTheWorld;
+		for (int i=0;i<3;i++)
+			for (int j=0;j<4;j++)
+				ctx.HM[i][j] = (i==j) ? 1.0f : 0.0f;
+		if (ctx.do_transf)
 		{
-			mrpt::poses::CPose3D  transf_to_apply; // Either ROBOTPOSE or ROBOTPOSE(+)SENSORPOSE or SENSORPOSE
-			if (takeIntoAccountSensorPoseOnRobot)
+			mrpt::poses::CPose3D  transf_to_apply;
+			if (projectParams.takeIntoAccountSensorPoseOnRobot)
 				transf_to_apply = src_obs.sensorPose;
-			if (robotPoseInTheWorld)
-				transf_to_apply.composeFrom(*robotPoseInTheWorld, CPose3D(transf_to_apply));
-
-			const CMatrixFixedNumeric<float,4,4> HM = transf_to_apply.getHomogeneousMatrixVal().cast<float>();
-			Eigen::Matrix<float,4,1>  pt, pt_transf;
-			pt[3]=1;
+			if (projectParams.robotPoseInTheWorld)
+				transf_to_apply.composeFrom(*projectParams.robotPoseInTheWorld, mrpt::poses::CPose3D(transf_to_apply));
 
-			for (size_t i=0;i<WH;i++)
-			{
-				pca.getPointXYZ(i,pt[0],pt[1],pt[2]);
-				pt_transf.noalias() = HM*pt;
-				pca.setPointXYZ(i,pt_transf[0],pt_transf[1],pt_transf[2]);
-			}
+			const CMatrixDouble44 HM = transf_to_apply.getHomogeneousMatrixVal();
+			for (int i=0;i<3;i++)
+				for (int j=0;j<4;j++)
+					ctx.HM[i][j] = static_cast<float>(HM(i,j));
 		}
-	} // end of project3DPointsFromDepthImageInto
 
-	// Auxiliary functions which implement proyection of 3D point clouds:
-	template <class POINTMAP>
-	inline void do_project_3d_pointcloud(const int H,const int W,const float *kys,const float *kzs,const mrpt::math::CMatrix &rangeImage, mrpt::utils::PointCloudAdapter<POINTMAP> &pca)
-	{
-		size_t idx=0;
-		for (int r=0;r<H;r++)
-			for (int c=0;c<W;c++)
-			{
-				const float D = rangeImage.coeff(r,c);
-				pca.setPointXYZ(idx++,
-					D,          // x
-					*kys++ * D, // y
-					*kzs++ * D  // z
-					);
-			}
-	}
+		// The index of the first point of each projected row, so each one can be written directly into its final place:
+		const bool run_parallel = projectParams.parallelMinPoints>0 && WH>=projectParams.parallelMinPoints;
+		const int  grain_rows = std::max(1, 16/ctx.dec);
+		std::vector<size_t> row_out_idx(Hd+1, 0);
+		if (ctx.filter_min || ctx.filter_max)
+		{
+			TProject3DCountBody count_body(ctx,&row_out_idx[0]);
+			if (run_parallel)
+					mrpt::system::parallel_for( mrpt::system::BlockedRange(0,Hd,grain_rows), count_body );
+			else	count_body( mrpt::system::BlockedRange(0,Hd) );
+			for (int rd=0;rd<Hd;rd++)
+				row_out_idx[rd+1] += row_out_idx[rd];
+		}
+		else
+		{
+			for (int rd=0;rd<=Hd;rd++)
+				row_out_idx[rd] = size_t(rd)*ctx.Wd;
+		}
 
-	// Auxiliary functions which implement proyection of 3D point clouds:
-	template <class POINTMAP>
-	inline void do_project_3d_pointcloud_SSE2(const int H,const int W,const float *kys,const float *kzs,const mrpt::math::CMatrix &rangeImage, mrpt::utils::PointCloudAdapter<POINTMAP> &pca)
-	{
-	#if MRPT_HAS_SSE2
-			// Use optimized version:
-			const int W_4 = W >> 2;  // /=4 , since we process 4 values at a time.
-			size_t idx=0;
-			EIGEN_ALIGN16 float xs[4],ys[4],zs[4];
-			for (int r=0;r<H;r++)
-			{
-				const float *D_ptr = &rangeImage.coeffRef(r,0);  // Matrices are 16-aligned
+		// Reserve memory for 3D points (only once):
+		pca.resize(row_out_idx[Hd]);
+		if (!row_out_idx[Hd]) return;
 
-				for (int c=0;c<W_4;c++)
-				{
-					const __m128 D = _mm_load_ps(D_ptr);
-
-					const __m128 KY = _mm_load_ps(kys);
-					const __m128 KZ = _mm_load_ps(kzs);
-
-					_mm_storeu_ps(xs , D);
-					_mm_storeu_ps(ys , _mm_mul_ps(KY,D));
-					_mm_storeu_ps(zs , _mm_mul_ps(KZ,D));
-
-					D_ptr+=4;
-					kys+=4;
-					kzs+=4;
-					pca.setPointXYZ(idx++,xs[0],ys[0],zs[0]);
-					pca.setPointXYZ(idx++,xs[1],ys[1],zs[1]);
-					pca.setPointXYZ(idx++,xs[2],ys[2],zs[2]);
-					pca.setPointXYZ(idx++,xs[3],ys[3],zs[3]);
-				}
-			}
-	#endif
-	}
+		// Project, color and transform all the points in one pass:
+		TProject3DRowsBody<POINTMAP> body(ctx,pca,&row_out_idx[0]);
+		if (run_parallel)
+				mrpt::system::parallel_for( mrpt::system::BlockedRange(0,Hd,grain_rows), body );
+		else	body( mrpt::system::BlockedRange(0,Hd) );
 
+	} // end of project3DPointsFromDepthImageInto
 
 } // End of namespace
 } // End of namespace
@@ -14,6 +14,8 @@
 #include <mrpt/slam/CActionCollection.h>
 #include <mrpt/slam/CObservationComment.h>
 #include <mrpt/utils/CConfigFileMemory.h>
+#include <mrpt/slam/CChunkedRawlogWriter.h>
+#include <mrpt/slam/CRawlogLazyLoader.h>
 
 
 namespace mrpt
@@ -40,6 +42,14 @@ namespace mrpt
 		 *
 		 *  This class also publishes a static helper method for loading rawlog files in format #1: see CRawlog::readActionObservationPair
 		 *
+		 *  Rawlog files can also be stored in a chunked & indexed format (see CChunkedRawlogWriter, CRawlog::saveToChunkedRawLogFile), which allows
+		 *   seeking to any entry or timestamp without decompressing the whole file. loadFromRawLogFile() detects that format automatically, and
+		 *   the static readers (readActionObservationPair, getActionObservationPairOrObservation) accept a CChunkedRawlogReader as input stream.
+		 *
+		 *  For datasets larger than the available memory, loadFromRawLogFileLazy() only keeps the position of each entry in the file, and
+		 *   deserializes entries on demand when accessed (through getAsObservation(), getAsObservations(), the iterators, etc.), keeping the
+		 *   most recently used ones in a cache of limited size. See CRawlogLazyLoader.
+		 *
 		 *  There is a field for comments and blocks of parameters (in ini-like format) accessible through getCommentText and setCommentText
 		 *   (introduced in MRPT 0.6.4). When serialized to a rawlog file, the commens are saved as an additional observation of the
 		 *   type CObservationComments at the beginning of the file, but this observation does not appear after loading for clarity.
@@ -62,6 +72,13 @@ namespace mrpt
 
 			CObservationComment		m_commentTexts;	//!< Comments of the rawlog.
 
+			mutable CRawlogLazyLoaderPtr m_lazy;   //!< Only in lazy-load mode: the entries in the file (see loadFromRawLogFileLazy)
+			std::vector<size_t>   m_lazy_index;    //!< Only in lazy-load mode: the index in m_lazy of each entry, or std::string::npos for those added afterwards (kept in m_seqOfActObs)
+
+			void readObjectsFromStream( CStream &fs ); //!< Appends all the objects read from a stream until EOF or an unknown class (used by loadFromRawLogFile)
+			void pushBackEntry( const CSerializablePtr &obj ); //!< Appends an object to m_seqOfActObs (and m_lazy_index in lazy-load mode)
+			CSerializablePtr getEntry( size_t index ) const; //!< Returns an entry, loading it in lazy-load mode (no bounds checking). This updates the (thread-safe) cache in m_lazy
+
 		public:
 			void getCommentText( std::string &t) const;	//!< Returns the block of comment text for the rawlog
 			std::string getCommentText() const;			//!< Returns the block of comment text for the rawlog
@@ -124,6 +141,7 @@ namespace mrpt
 			/** Load the contents from a file containing one of these possibilities:
 			  *		- A "CRawlog" object.
 			  *		- Directly the sequence of objects (pairs CSensoryFrame/CActionCollection or CObservation* objects). In this case the method stops reading on EOF of an unrecogniced class name.
+			  *		- A chunked & indexed rawlog, as saved by saveToChunkedRawLogFile() or CChunkedRawlogWriter (detected from the file header).
 			  * \returns It returns false if the file does not exists.
 			  */
 			bool  loadFromRawLogFile( const std::string &fileName );
@@ -134,6 +152,38 @@ namespace mrpt
 			  */
 			bool saveToRawLogFile( const std::string &fileName ) const;
 
+			/** Saves the contents to a chunked & indexed rawlog file, whose entries can be accessed randomly with CChunkedRawlogReader.
+			  * \param chunkSize The approximate size of each compressed chunk, before compression (see CChunkedRawlogWriter).
+			  * \returns It returns false if any error is found while writing/creating the target file.
+			  * \sa saveToRawLogFile, CChunkedRawlogWriter
+			  */
+			bool saveToChunkedRawLogFile( const std::string &fileName, const size_t chunkSize = CChunkedRawlogWriter::DEFAULT_CHUNK_SIZE ) const;
+
+			/** Loads a rawlog file in lazy-load mode: an indexing pass only records the position and type of each entry, which will be
+			  *  deserialized when accessed (by the get* methods or the iterators) and kept in a cache of at most \a cacheMaxBytes bytes
+			  *  (measured as the serialized size of the cached objects), releasing the least recently used entries first.
+			  *  This allows working with datasets much larger than the available memory. Plain rawlogs are memory-mapped, and
+			  *  chunked rawlogs (see saveToChunkedRawLogFile) use their own index, so they need no indexing pass.
+			  *
+			  *  gz-compressed rawlogs cannot be randomly accessed: in that case (or for files with a whole CRawlog object) a warning is shown
+			  *   and the file is loaded normally, as with loadFromRawLogFile().
+			  *  Entries can still be added or removed in lazy-load mode: new entries are kept in memory.
+			  *  Lazily loaded entries are read-only in practice: changes made to a returned object are lost once it is released from the cache
+			  *   (and no other smart pointer to it is alive), since the next access reads it again from the file. To edit entries, keep the
+			  *   returned pointers, or load the file with loadFromRawLogFile() instead.
+			  *  Entries can be read simultaneously from several threads, even through the const methods and iterators, since the
+			  *   shared cache is protected by a critical section (see CRawlogLazyLoader).
+			  * \returns It returns false if the file does not exists.
+			  * \sa isLazyLoaded, getLazyLoader, CRawlogLazyLoader
+			  */
+			bool loadFromRawLogFileLazy( const std::string &fileName, const uint64_t cacheMaxBytes = 256*1024*1024 );
+
+			/** Returns true if this rawlog was loaded with loadFromRawLogFileLazy() (and its entries are read from the file on demand) */
+			inline bool isLazyLoaded() const { return m_lazy.present(); }
+
+			/** In lazy-load mode, gives access to the file and cache with the entries (e.g. to change the cache size), or a NULL pointer otherwise. */
+			inline CRawlogLazyLoaderPtr getLazyLoader() const { return m_lazy; }
+
 			/** Returns the number of actions / observations object in the sequence. */
 			size_t  size() const;
 
@@ -186,18 +236,19 @@ namespace mrpt
 			{
 			protected:
 				TListObjects::iterator	m_it;
+				const CRawlog          *m_rawlog; //!< Needed for lazy-loaded entries
 
 			public:
-				iterator() : m_it() {  }
-				iterator(const TListObjects::iterator& it) : m_it(it)  {  }
+				iterator() : m_it(), m_rawlog(NULL) {  }
+				iterator(const TListObjects::iterator& it, const CRawlog *rawlog = NULL) : m_it(it), m_rawlog(rawlog)  {  }
 				virtual ~iterator() { }
 
-				iterator & operator = (const iterator& o) {  m_it = o.m_it; return *this; }
+				iterator & operator = (const iterator& o) {  m_it = o.m_it; m_rawlog = o.m_rawlog; return *this; }
 
 				bool operator == (const iterator& o) {  return m_it == o.m_it; }
 				bool operator != (const iterator& o) {  return m_it != o.m_it; }
 
-				CSerializablePtr operator *() { return *m_it; }
+				CSerializablePtr operator *() { return (m_rawlog && !m_it->present()) ? m_rawlog->getEntry(m_it-m_rawlog->m_seqOfActObs.begin()) : *m_it; }
 
 				inline iterator  operator ++(int) { iterator aux =*this; m_it++; return aux; }  // Post
 				inline iterator& operator ++()    { m_it++; return *this; }  // Pre
@@ -206,6 +257,8 @@ namespace mrpt
 
 				TEntryType getType() const
 				{
+					if (m_rawlog && !m_it->present())
+						return m_rawlog->getType(m_it-m_rawlog->m_seqOfActObs.begin());
 					if ( (*m_it)->GetRuntimeClass()->derivedFrom( CLASS_ID(CObservation) ) )
 						return etObservation;
 					else if ( (*m_it)->GetRuntimeClass()->derivedFrom( CLASS_ID(CSensoryFrame) ) )
@@ -214,6 +267,8 @@ namespace mrpt
 						return etActionCollection;
 				}
 
+				TListObjects::iterator getInternalIterator() const { return m_it; }
+
 				static iterator erase( TListObjects& lst, const iterator &it) { return lst.erase(it.m_it); }
 			};
 
@@ -222,16 +277,17 @@ namespace mrpt
 			{
 			protected:
 				TListObjects::const_iterator	m_it;
+				const CRawlog                  *m_rawlog; //!< Needed for lazy-loaded entries
 
 			public:
-				const_iterator() : m_it() {  }
-				const_iterator(const TListObjects::const_iterator& it) : m_it(it)  {  }
+				const_iterator() : m_it(), m_rawlog(NULL) {  }
+				const_iterator(const TListObjects::const_iterator& it, const CRawlog *rawlog = NULL) : m_it(it), m_rawlog(rawlog)  {  }
 				virtual ~const_iterator() { }
 
 				bool operator == (const const_iterator& o) {  return m_it == o.m_it; }
 				bool operator != (const const_iterator& o) {  return m_it != o.m_it; }
 
-				const CSerializablePtr operator *() const { return *m_it; }
+				const CSerializablePtr operator *() const { return (m_rawlog && !m_it->present()) ? m_rawlog->getEntry(m_it-m_rawlog->m_seqOfActObs.begin()) : *m_it; }
 
 				inline const_iterator  operator ++(int) { const_iterator aux =*this; m_it++; return aux; }  // Post
 				inline const_iterator& operator ++()    { m_it++; return *this; }  // Pre
@@ -240,6 +296,8 @@ namespace mrpt
 
 				TEntryType getType() const
 				{
+					if (m_rawlog && !m_it->present())
+						return m_rawlog->getType(m_it-m_rawlog->m_seqOfActObs.begin());
 					if ( (*m_it)->GetRuntimeClass()->derivedFrom( CLASS_ID(CObservation) ) )
 						return etObservation;
 					else if ( (*m_it)->GetRuntimeClass()->derivedFrom( CLASS_ID(CSensoryFrame) ) )
@@ -251,12 +309,16 @@ namespace mrpt
 			};
 
 
-			const_iterator begin() const { return m_seqOfActObs.begin(); }
-			iterator begin() { return m_seqOfActObs.begin(); }
-			const_iterator end() const { return m_seqOfActObs.end(); }
-			iterator end() { return m_seqOfActObs.end(); }
+			const_iterator begin() const { return const_iterator(m_seqOfActObs.begin(),this); }
+			iterator begin() { return iterator(m_seqOfActObs.begin(),this); }
+			const_iterator end() const { return const_iterator(m_seqOfActObs.end(),this); }
+			iterator end() { return iterator(m_seqOfActObs.end(),this); }
 
-			iterator erase(const iterator &it) { return iterator::erase(m_seqOfActObs, it); }
+			iterator erase(const iterator &it)
+			{
+				if (!m_lazy_index.empty()) m_lazy_index.erase( m_lazy_index.begin() + (it.getInternalIterator()-m_seqOfActObs.begin()) );
+				return iterator(m_seqOfActObs.erase(it.getInternalIterator()),this);
+			}
 
 			/** Returns the sub-set of observations of a given class whose time-stamp t fulfills  time_start <= t < time_end.
 			  *  This method requires the timestamps of the sensors to be in strict ascending order (which should be the normal situation).
@@ -283,6 +345,7 @@ namespace mrpt
 			  *   Previous contents of action and observations are discarded (using stlplus::smart_ptr::clear_unique), and
 			  *    at exit they contain the new objects read from the rawlog file.
 			  *  The input/output variable "rawlogEntry" is just a counter of the last rawlog entry read, for logging or monitoring purposes.
+			  *  The input stream can be a CChunkedRawlogReader, e.g. after CChunkedRawlogReader::seekToTimestamp() to start reading at some point of a long dataset.
 			  * \return false if there was some error, true otherwise.
 			  * \sa getActionObservationPair, getActionObservationPairOrObservation
 			  */
@@ -0,0 +1,104 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef CRawlogLazyLoader_H
+#define CRawlogLazyLoader_H
+
+#include <mrpt/slam/CChunkedRawlogReader.h>
+#include <mrpt/slam/CObservationComment.h>
+#include <mrpt/utils/CMemoryMappedFile.h>
+#include <mrpt/synch/CCriticalSection.h>
+#include <list>
+
+namespace mrpt
+{
+	namespace slam
+	{
+		class CRawlogLazyLoader;
+		typedef stlplus::smart_ptr<CRawlogLazyLoader> CRawlogLazyLoaderPtr; //!< Shared among the copies of a lazy-loaded CRawlog
+
+		/** The storage behind a lazy-loaded CRawlog (see CRawlog::loadFromRawLogFileLazy): it keeps just the position, size and class
+		  *  of each entry of a rawlog file, deserializes entries on demand and keeps the most recently used ones in a cache with a limited size.
+		  *
+		  *  Two kinds of rawlog files can be loaded:
+		  *   - Uncompressed rawlog files: the file is memory-mapped (see mrpt::utils::CMemoryMappedFile) and the index is built
+		  *      in a first pass through the whole file, which deserializes each object once (only one object is kept in memory at a time).
+		  *   - Chunked & indexed rawlogs (see CChunkedRawlogWriter): the index is read from the file, and entries are read through a CChunkedRawlogReader.
+		  *
+		  *  gz-compressed rawlogs cannot be accessed randomly: decompress them first or convert them with "rawlog-edit --to-chunked".
+		  *
+		  *  The cache size is measured as the sum of the serialized sizes of the cached objects, which is a fair estimation of the memory they take.
+		  *  When it grows over the limit, the least recently used objects are released (but they remain alive while the user holds a smart pointer to them).
+		  *  Changes made to an entry are therefore lost once it has been released and the user holds no pointer to it: the next access reads it again from the file.
+		  *
+		  *  The cache is protected by a critical section, so entries can be read simultaneously from several threads (open() and close() must not be called meanwhile).
+		  *
+		  * \sa CRawlog::loadFromRawLogFileLazy
+		  * \ingroup mrpt_obs_grp
+		  */
+		class OBS_IMPEXP CRawlogLazyLoader : public mrpt::utils::CUncopiable
+		{
+		public:
+			CRawlogLazyLoader();
+			virtual ~CRawlogLazyLoader();
+
+			/** Opens and indexes a rawlog file.
+			  *  Only CSensoryFrame, CActionCollection and CObservation entries are indexed; the first CObservationComment (if any) is
+			  *  returned in \a out_comments instead. As CRawlog::loadFromRawLogFile, reading stops at the first object of any other class.
+			  * \return false if the file does not exist or it cannot be loaded lazily (it is gz-compressed, it contains a whole CRawlog object or legacy CPose2D actions).
+			  */
+			bool open(const std::string &fileName, CObservationComment *out_comments = NULL);
+
+			/** Closes the file and frees the index and the cache */
+			void close();
+
+			/** The number of indexed entries */
+			inline size_t size() const { return m_entries.size(); }
+
+			/** The class of the given entry (no bounds checking) */
+			inline const mrpt::utils::TRuntimeClassId* getEntryClass(const size_t index) const { return m_entries[index].cls; }
+
+			/** Returns the given entry, deserializing it if it is not in the cache \exception std::exception On index out of bounds or a read error */
+			mrpt::utils::CSerializablePtr getEntry(const size_t index);
+
+			/** Changes the maximum size of the cache (in bytes), releasing objects if needed */
+			void setCacheMaxBytes(const uint64_t maxBytes);
+
+			inline uint64_t getCacheMaxBytes() const { mrpt::synch::CCriticalSectionLocker lock(&m_cache_cs); return m_cache_max_bytes; } //!< The maximum size of the cache (in bytes)
+			inline uint64_t getCacheBytes() const { mrpt::synch::CCriticalSectionLocker lock(&m_cache_cs); return m_cache_bytes; }        //!< The current size of the cache (in bytes)
+			inline size_t getCachedEntriesCount() const { mrpt::synch::CCriticalSectionLocker lock(&m_cache_cs); return m_lru.size(); }   //!< The number of entries in the cache
+
+			/** Releases all the objects in the cache */
+			void clearCache();
+
+		private:
+			struct TEntry
+			{
+				TEntry() : offset(0), size(0), cls(NULL) { }
+
+				uint64_t offset;  //!< Offset in the mapped file, or index in the chunked rawlog
+				uint32_t size;    //!< Serialized size
+				const mrpt::utils::TRuntimeClassId *cls;
+				mrpt::utils::CSerializablePtr obj; //!< Only if cached
+				std::list<size_t>::iterator   lru_it;
+			};
+
+			mrpt::utils::CMemoryMappedFile m_mmap;
+			CChunkedRawlogReader           m_chunked;
+			std::vector<TEntry>            m_entries;
+			std::list<size_t>              m_lru;   //!< Cached entries, the most recently used first
+			uint64_t                       m_cache_bytes, m_cache_max_bytes;
+			mutable mrpt::synch::CCriticalSection m_cache_cs; //!< Protects the cache (m_lru, the cached objects and the file readers) in getEntry(), etc.
+
+			void evictEntries(); //!< Releases the least recently used entries until the cache fits in its size limit (the caller must hold m_cache_cs)
+		}; // End of class def.
+
+	} // End of namespace
+} // End of namespace
+
+#endif
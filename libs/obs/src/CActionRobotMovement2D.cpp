@@ -480,17 +480,22 @@ void  CActionRobotMovement2D::computeFromOdometry_modelThrun(
 	float   Atrans	= odometryIncrement.norm();
 	float	Arot2	= math::wrapToPi( odometryIncrement.phi() - Arot1 );
 
+	// All the normalized Gaussian samples at once, in the same order they were drawn one by one:
+	std::vector<double> rnds(6*o.thrunModel.nParticlesCount);
+	randomGenerator.drawGaussian1DVector(rnds);
+
 	// Draw samples:
 	for (size_t i=0;i<o.thrunModel.nParticlesCount;i++)
 	{
-		float	Arot1_draw	= Arot1  - (o.thrunModel.alfa1_rot_rot*fabs(Arot1)+o.thrunModel.alfa2_rot_trans*Atrans) * randomGenerator.drawGaussian1D_normalized();
-		float	Atrans_draw = Atrans - (o.thrunModel.alfa3_trans_trans*Atrans+o.thrunModel.alfa4_trans_rot*(fabs(Arot1)+fabs(Arot2))) * randomGenerator.drawGaussian1D_normalized();
-		float	Arot2_draw	= Arot2  - (o.thrunModel.alfa1_rot_rot*fabs(Arot2)+o.thrunModel.alfa2_rot_trans*Atrans) * randomGenerator.drawGaussian1D_normalized();
+		const double *rnd = &rnds[6*i];
+		float	Arot1_draw	= Arot1  - (o.thrunModel.alfa1_rot_rot*fabs(Arot1)+o.thrunModel.alfa2_rot_trans*Atrans) * rnd[0];
+		float	Atrans_draw = Atrans - (o.thrunModel.alfa3_trans_trans*Atrans+o.thrunModel.alfa4_trans_rot*(fabs(Arot1)+fabs(Arot2))) * rnd[1];
+		float	Arot2_draw	= Arot2  - (o.thrunModel.alfa1_rot_rot*fabs(Arot2)+o.thrunModel.alfa2_rot_trans*Atrans) * rnd[2];
 
 		// Output:
-		aux->m_particles[i].d->x( Atrans_draw * cos( Arot1_draw ) + motionModelConfiguration.thrunModel.additional_std_XY * randomGenerator.drawGaussian1D_normalized() );
-		aux->m_particles[i].d->y( Atrans_draw * sin( Arot1_draw ) + motionModelConfiguration.thrunModel.additional_std_XY * randomGenerator.drawGaussian1D_normalized() );
-		aux->m_particles[i].d->phi( Arot1_draw + Arot2_draw + motionModelConfiguration.thrunModel.additional_std_phi * randomGenerator.drawGaussian1D_normalized() );
+		aux->m_particles[i].d->x( Atrans_draw * cos( Arot1_draw ) + motionModelConfiguration.thrunModel.additional_std_XY * rnd[3] );
+		aux->m_particles[i].d->y( Atrans_draw * sin( Arot1_draw ) + motionModelConfiguration.thrunModel.additional_std_XY * rnd[4] );
+		aux->m_particles[i].d->phi( Arot1_draw + Arot2_draw + motionModelConfiguration.thrunModel.additional_std_phi * rnd[5] );
 		aux->m_particles[i].d->normalizePhi();
 	}
 }
@@ -632,10 +637,12 @@ void  CActionRobotMovement2D::prepareFastDrawSingleSample_modelThrun() const
   ---------------------------------------------------------------*/
 void  CActionRobotMovement2D::fastDrawSingleSample_modelGaussian( CPose2D &outSample ) const
 {
+	float	rnds[3];
+	randomGenerator.drawGaussian1DArray(rnds,3);
 	vector_float	rndVector(3,0);
 	for (size_t i=0;i<3;i++)
 	{
-		float	rnd = randomGenerator.drawGaussian1D_normalized();
+		const float	rnd = rnds[i];
 		for (size_t d=0;d<3;d++)
 			rndVector[d]+= ( m_fastDrawGauss_Z.get_unsafe(d,i)*rnd );
 	}
@@ -0,0 +1,323 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/obs.h>   // Precompiled headers
+
+#include <mrpt/slam/CChunkedRawlogReader.h>
+#include <mrpt/compress/zip.h>
+#include <mrpt/system/filesystem.h>
+
+using namespace mrpt;
+using namespace mrpt::slam;
+using namespace mrpt::utils;
+using namespace mrpt::system;
+using namespace std;
+
+const char CChunkedRawlogReader::FILE_MAGIC[9] = "MRPTRAWC";
+const uint32_t CChunkedRawlogReader::FILE_FORMAT_VERSION;
+
+/*---------------------------------------------------------------
+					Constructors / destructor
+  ---------------------------------------------------------------*/
+CChunkedRawlogReader::CChunkedRawlogReader() :
+	m_is_open(false),
+	m_total_size(0),
+	m_position(0),
+	m_loaded_chunk(std::string::npos)
+{
+}
+
+CChunkedRawlogReader::CChunkedRawlogReader(const std::string &fileName) :
+	m_is_open(false),
+	m_total_size(0),
+	m_position(0),
+	m_loaded_chunk(std::string::npos)
+{
+	MRPT_START
+	if (!open(fileName))
+		THROW_EXCEPTION_CUSTOM_MSG1("Error opening chunked rawlog file: '%s'",fileName.c_str())
+	MRPT_END
+}
+
+CChunkedRawlogReader::~CChunkedRawlogReader()
+{
+	close();
+}
+
+/*---------------------------------------------------------------
+							open
+  ---------------------------------------------------------------*/
+bool CChunkedRawlogReader::open(const std::string &fileName)
+{
+	close();
+	if (!mrpt::system::fileExists(fileName) || !m_file.open(fileName))
+		return false;
+
+	try
+	{
+		m_is_open = loadIndex();
+	}
+	catch (std::exception &e)
+	{
+		std::cerr << "[CChunkedRawlogReader::open] Error reading the index of '" << fileName << "':\n" << e.what() << std::endl;
+		m_is_open = false;
+	}
+
+	if (!m_is_open)
+		close();
+	return m_is_open;
+}
+
+/*---------------------------------------------------------------
+							close
+  ---------------------------------------------------------------*/
+void CChunkedRawlogReader::close()
+{
+	m_file.close();
+	m_is_open = false;
+	m_chunks.clear();
+	m_entries.clear();
+	m_sorted_timestamps.clear();
+	m_total_size = 0;
+	m_position = 0;
+	m_loaded_chunk = std::string::npos;
+	m_chunk_data.clear();
+	m_compressed_data.clear();
+}
+
+/*---------------------------------------------------------------
+						isChunkedRawlog
+  ---------------------------------------------------------------*/
+bool CChunkedRawlogReader::isChunkedRawlog(const std::string &fileName)
+{
+	if (!mrpt::system::fileExists(fileName)) return false;
+	CFileInputStream f;
+	if (!f.open(fileName)) return false;
+	if (f.getTotalBytesCount()<sizeof(FILE_MAGIC)-1) return false;
+
+	char magic[sizeof(FILE_MAGIC)-1];
+	f.ReadBuffer(magic,sizeof(magic));
+	return 0==std::memcmp(magic,FILE_MAGIC,sizeof(magic));
+}
+
+/*---------------------------------------------------------------
+							loadIndex
+  ---------------------------------------------------------------*/
+bool CChunkedRawlogReader::loadIndex()
+{
+	const size_t MAGIC_LEN = sizeof(FILE_MAGIC)-1;
+	const uint64_t fileSize = m_file.getTotalBytesCount();
+	if (fileSize < 2*MAGIC_LEN+sizeof(uint32_t)+sizeof(uint64_t))
+		return false;
+
+	// Header:
+	char magic[sizeof(FILE_MAGIC)-1];
+	m_file.ReadBuffer(magic,MAGIC_LEN);
+	if (std::memcmp(magic,FILE_MAGIC,MAGIC_LEN)) return false;
+
+	uint32_t version;
+	m_file >> version;
+	if (version>FILE_FORMAT_VERSION)
+		THROW_EXCEPTION_CUSTOM_MSG1("Unsupported chunked rawlog format version: %u",static_cast<unsigned int>(version))
+
+	// Footer:
+	m_file.Seek(fileSize-MAGIC_LEN-sizeof(uint64_t));
+	uint64_t index_offset;
+	m_file >> index_offset;
+	m_file.ReadBuffer(magic,MAGIC_LEN);
+	if (std::memcmp(magic,FILE_MAGIC,MAGIC_LEN))
+		THROW_EXCEPTION("The file footer is missing: the file was not properly closed or it is truncated")
+	ASSERT_(index_offset<fileSize)
+
+	// Index:
+	m_file.Seek(index_offset);
+	uint32_t nChunks;
+	m_file >> nChunks;
+	m_chunks.resize(nChunks);
+	m_total_size = 0;
+	for (uint32_t i=0;i<nChunks;i++)
+	{
+		TChunk &c = m_chunks[i];
+		m_file >> c.file_offset >> c.compressed_size >> c.uncompressed_size;
+		ASSERT_(c.file_offset+c.compressed_size<=index_offset)
+		c.stream_offset = m_total_size;
+		m_total_size += c.uncompressed_size;
+	}
+
+	uint32_t nEntries;
+	m_file >> nEntries;
+	m_entries.resize(nEntries);
+	for (uint32_t i=0;i<nEntries;i++)
+	{
+		TChunkedRawlogEntry &e = m_entries[i];
+		m_file >> e.timestamp >> e.chunk >> e.offset >> e.size >> e.sensorLabel >> e.className;
+		ASSERT_(e.chunk<nChunks && e.offset+e.size<=m_chunks[e.chunk].uncompressed_size)
+		if (e.timestamp!=INVALID_TIMESTAMP)
+			m_sorted_timestamps.push_back( std::make_pair(e.timestamp,static_cast<size_t>(i)) );
+	}
+	std::sort(m_sorted_timestamps.begin(),m_sorted_timestamps.end());
+
+	m_position = 0;
+	return true;
+}
+
+/*---------------------------------------------------------------
+							getEntry
+  ---------------------------------------------------------------*/
+const TChunkedRawlogEntry & CChunkedRawlogReader::getEntry(const size_t index) const
+{
+	ASSERTMSG_(index<m_entries.size(),"Index out of bounds")
+	return m_entries[index];
+}
+
+/*---------------------------------------------------------------
+							seekToEntry
+  ---------------------------------------------------------------*/
+void CChunkedRawlogReader::seekToEntry(const size_t index)
+{
+	ASSERTMSG_(index<=m_entries.size(),"Index out of bounds")
+	if (index==m_entries.size())
+			m_position = m_total_size;
+	else	m_position = m_chunks[m_entries[index].chunk].stream_offset + m_entries[index].offset;
+}
+
+/*---------------------------------------------------------------
+							seekToTimestamp
+  ---------------------------------------------------------------*/
+size_t CChunkedRawlogReader::seekToTimestamp(const mrpt::system::TTimeStamp t)
+{
+	std::vector<std::pair<TTimeStamp,size_t> >::const_iterator it =
+		std::lower_bound(m_sorted_timestamps.begin(),m_sorted_timestamps.end(), std::make_pair(t,static_cast<size_t>(0)) );
+
+	const size_t idx = (it==m_sorted_timestamps.end()) ? m_entries.size() : it->second;
+	seekToEntry(idx);
+	return idx;
+}
+
+/*---------------------------------------------------------------
+							readEntry
+  ---------------------------------------------------------------*/
+CSerializablePtr CChunkedRawlogReader::readEntry(const size_t index)
+{
+	ASSERTMSG_(index<m_entries.size(),"Index out of bounds")
+	seekToEntry(index);
+	CSerializablePtr obj;
+	*this >> obj;
+	return obj;
+}
+
+/*---------------------------------------------------------------
+							findChunk
+  ---------------------------------------------------------------*/
+size_t CChunkedRawlogReader::findChunk(const uint64_t stream_pos) const
+{
+	// The last chunk whose stream_offset is <= stream_pos (chunks are never empty):
+	size_t lo=0, hi=m_chunks.size();
+	while (hi-lo>1)
+	{
+		const size_t mid = (lo+hi)/2;
+		if (m_chunks[mid].stream_offset<=stream_pos)
+				lo = mid;
+		else	hi = mid;
+	}
+	return lo;
+}
+
+/*---------------------------------------------------------------
+							loadChunk
+  ---------------------------------------------------------------*/
+void CChunkedRawlogReader::loadChunk(const size_t idx)
+{
+	if (idx==m_loaded_chunk) return;
+	m_loaded_chunk = std::string::npos;
+
+	const TChunk &c = m_chunks[idx];
+	m_compressed_data.resize(c.compressed_size);
+	m_chunk_data.resize(c.uncompressed_size);
+
+	m_file.Seek(c.file_offset);
+	if (c.compressed_size)
+		m_file.ReadBuffer(&m_compressed_data[0],c.compressed_size);
+
+	size_t actual_size = 0;
+	if (c.uncompressed_size)
+		mrpt::compress::zip::decompress(&m_compressed_data[0],c.compressed_size,&m_chunk_data[0],c.uncompressed_size,actual_size);
+	if (actual_size!=c.uncompressed_size)
+		THROW_EXCEPTION_CUSTOM_MSG1("Corrupted chunk #%u in chunked rawlog",static_cast<unsigned int>(idx))
+
+	m_loaded_chunk = idx;
+}
+
+/*---------------------------------------------------------------
+							Read
+  ---------------------------------------------------------------*/
+size_t CChunkedRawlogReader::Read(void *Buffer, size_t Count)
+{
+	if (!m_is_open) return 0;
+
+	unsigned char *out = static_cast<unsigned char*>(Buffer);
+	size_t nRead = 0;
+	while (nRead<Count && m_position<m_total_size)
+	{
+		const size_t idx = (m_loaded_chunk!=std::string::npos &&
+							m_position>=m_chunks[m_loaded_chunk].stream_offset &&
+							m_position<m_chunks[m_loaded_chunk].stream_offset+m_chunks[m_loaded_chunk].uncompressed_size) ?
+							m_loaded_chunk : findChunk(m_position);
+		loadChunk(idx);
+
+		const size_t offset = static_cast<size_t>(m_position-m_chunks[idx].stream_offset);
+		const size_t n = std::min(Count-nRead, m_chunk_data.size()-offset);
+		std::memcpy(out+nRead,&m_chunk_data[offset],n);
+		nRead+=n;
+		m_position+=n;
+	}
+	return nRead;
+}
+
+/*---------------------------------------------------------------
+							Write
+  ---------------------------------------------------------------*/
+size_t CChunkedRawlogReader::Write(const void *Buffer, size_t Count)
+{
+	THROW_EXCEPTION("Trying to write to a read-only chunked rawlog stream.");
+}
+
+/*---------------------------------------------------------------
+							Seek
+  ---------------------------------------------------------------*/
+uint64_t CChunkedRawlogReader::Seek(uint64_t Offset, CStream::TSeekOrigin Origin)
+{
+	int64_t newPos;
+	switch(Origin)
+	{
+	case sFromBeginning: newPos = static_cast<int64_t>(Offset); break;
+	case sFromCurrent:   newPos = static_cast<int64_t>(m_position) + static_cast<int64_t>(Offset); break;
+	case sFromEnd:       newPos = static_cast<int64_t>(m_total_size) + static_cast<int64_t>(Offset); break;
+	default: THROW_EXCEPTION("Invalid value for 'Origin'");
+	}
+	if (newPos<0) newPos=0;
+	m_position = std::min( static_cast<uint64_t>(newPos), m_total_size );
+	return m_position;
+}
+
+/*---------------------------------------------------------------
+						getTotalBytesCount
+  ---------------------------------------------------------------*/
+uint64_t CChunkedRawlogReader::getTotalBytesCount()
+{
+	return m_total_size;
+}
+
+/*---------------------------------------------------------------
+							getPosition
+  ---------------------------------------------------------------*/
+uint64_t CChunkedRawlogReader::getPosition()
+{
+	return m_position;
+}
@@ -0,0 +1,172 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/obs.h>   // Precompiled headers
+
+#include <mrpt/slam/CChunkedRawlogWriter.h>
+#include <mrpt/slam/CSensoryFrame.h>
+#include <mrpt/slam/CActionCollection.h>
+#include <mrpt/compress/zip.h>
+
+using namespace mrpt;
+using namespace mrpt::slam;
+using namespace mrpt::utils;
+using namespace mrpt::system;
+using namespace std;
+
+const size_t CChunkedRawlogWriter::DEFAULT_CHUNK_SIZE;
+
+/*---------------------------------------------------------------
+					Constructors / destructor
+  ---------------------------------------------------------------*/
+CChunkedRawlogWriter::CChunkedRawlogWriter() :
+	m_is_open(false),
+	m_chunk_size(DEFAULT_CHUNK_SIZE)
+{
+}
+
+CChunkedRawlogWriter::CChunkedRawlogWriter(const std::string &fileName, const size_t chunkSize) :
+	m_is_open(false),
+	m_chunk_size(DEFAULT_CHUNK_SIZE)
+{
+	MRPT_START
+	if (!open(fileName,chunkSize))
+		THROW_EXCEPTION_CUSTOM_MSG1("Error creating chunked rawlog file: '%s'",fileName.c_str())
+	MRPT_END
+}
+
+CChunkedRawlogWriter::~CChunkedRawlogWriter()
+{
+	try
+	{
+		close();
+	}
+	catch (std::exception &e)
+	{
+		std::cerr << "[~CChunkedRawlogWriter] Error closing the file:\n" << e.what() << std::endl;
+	}
+}
+
+/*---------------------------------------------------------------
+							open
+  ---------------------------------------------------------------*/
+bool CChunkedRawlogWriter::open(const std::string &fileName, const size_t chunkSize)
+{
+	close();
+
+	m_chunk_size = std::max(chunkSize,static_cast<size_t>(1));
+	m_chunk.Clear();
+	m_chunks.clear();
+	m_entries.clear();
+
+	if (!m_file.open(fileName))
+		return false;
+
+	m_file.WriteBuffer(CChunkedRawlogReader::FILE_MAGIC,sizeof(CChunkedRawlogReader::FILE_MAGIC)-1);
+	m_file << CChunkedRawlogReader::FILE_FORMAT_VERSION;
+	m_is_open = true;
+	return true;
+}
+
+/*---------------------------------------------------------------
+							write
+  ---------------------------------------------------------------*/
+void CChunkedRawlogWriter::write(const mrpt::utils::CSerializable &obj)
+{
+	MRPT_START
+	ASSERTMSG_(m_is_open,"No file is open")
+
+	TChunkedRawlogEntry e;
+	e.chunk  = m_chunks.size();
+	e.offset = m_chunk.getPosition();
+	e.className = obj.GetRuntimeClass()->className;
+
+	if (IS_DERIVED(&obj,CObservation))
+	{
+		const CObservation &o = static_cast<const CObservation&>(obj);
+		e.timestamp   = o.timestamp;
+		e.sensorLabel = o.sensorLabel;
+	}
+	else if (IS_CLASS(&obj,CSensoryFrame))
+	{
+		const CSensoryFrame &sf = static_cast<const CSensoryFrame&>(obj);
+		if (sf.begin()!=sf.end())
+			e.timestamp = (*sf.begin())->timestamp;
+	}
+	else if (IS_CLASS(&obj,CActionCollection))
+	{
+		const CActionCollection &acts = static_cast<const CActionCollection&>(obj);
+		if (acts.begin()!=acts.end())
+			e.timestamp = (*acts.begin())->timestamp;
+	}
+
+	m_chunk.WriteObject(&obj);
+	e.size = static_cast<uint32_t>(m_chunk.getPosition()-e.offset);
+	m_entries.push_back(e);
+
+	if (m_chunk.getPosition()>=m_chunk_size)
+		flushChunk();
+
+	MRPT_END
+}
+
+/*---------------------------------------------------------------
+							flushChunk
+  ---------------------------------------------------------------*/
+void CChunkedRawlogWriter::flushChunk()
+{
+	// The buffer of a CMemoryStream may be larger than what has been written:
+	const size_t len = static_cast<size_t>(m_chunk.getPosition());
+	if (!len) return;
+
+	std::vector<unsigned char> compressed;
+	mrpt::compress::zip::compress(m_chunk.getRawBufferData(),len,compressed);
+
+	TChunk c;
+	c.file_offset       = m_file.getPosition();
+	c.compressed_size   = static_cast<uint32_t>(compressed.size());
+	c.uncompressed_size = static_cast<uint32_t>(len);
+	m_chunks.push_back(c);
+
+	m_file.WriteBuffer(&compressed[0],compressed.size());
+	m_chunk.Clear();
+}
+
+/*---------------------------------------------------------------
+							close
+  ---------------------------------------------------------------*/
+void CChunkedRawlogWriter::close()
+{
+	if (!m_is_open) return;
+	m_is_open = false;
+
+	flushChunk();
+
+	// Index:
+	const uint64_t index_offset = m_file.getPosition();
+	m_file << static_cast<uint32_t>(m_chunks.size());
+	for (size_t i=0;i<m_chunks.size();i++)
+		m_file << m_chunks[i].file_offset << m_chunks[i].compressed_size << m_chunks[i].uncompressed_size;
+
+	m_file << static_cast<uint32_t>(m_entries.size());
+	for (size_t i=0;i<m_entries.size();i++)
+	{
+		const TChunkedRawlogEntry &e = m_entries[i];
+		m_file << e.timestamp << e.chunk << e.offset << e.size << e.sensorLabel << e.className;
+	}
+
+	// Footer:
+	m_file << index_offset;
+	m_file.WriteBuffer(CChunkedRawlogReader::FILE_MAGIC,sizeof(CChunkedRawlogReader::FILE_MAGIC)-1);
+	m_file.close();
+
+	m_chunk.Clear();
+	m_chunks.clear();
+	m_entries.clear();
+}
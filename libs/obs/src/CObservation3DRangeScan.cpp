@@ -16,6 +16,7 @@
 #include <mrpt/utils/CFileGZInputStream.h>
 #include <mrpt/utils/CFileGZOutputStream.h>
 #include <mrpt/utils/CTimeLogger.h>
+#include <mrpt/synch/CCriticalSection.h>
 
 using namespace std;
 using namespace mrpt::slam;
@@ -26,8 +27,58 @@ using namespace mrpt::math;
 // This must be added to any CSerializable class implementation file.
 IMPLEMENTS_SERIALIZABLE(CObservation3DRangeScan, CObservation,mrpt::slam)
 
-// Static LUT:
-CObservation3DRangeScan::TCached3DProjTables CObservation3DRangeScan::m_3dproj_lut;
+// Static LUTs, the most recently used first:
+namespace
+{
+	const size_t PROJ3D_LUT_CACHE_SIZE = 8;
+	std::list<CObservation3DRangeScan::TCached3DProjTablesPtr>  lut_cache;
+	mrpt::synch::CCriticalSection                               lut_cache_cs;
+}
+
+/*---------------------------------------------------------------
+					get3DProjectionLUT
+ ---------------------------------------------------------------*/
+CObservation3DRangeScan::TCached3DProjTablesPtr CObservation3DRangeScan::get3DProjectionLUT(const TCamera &camParams, const int W, const int H)
+{
+	mrpt::synch::CCriticalSectionLocker lock(&lut_cache_cs);
+
+	for (std::list<TCached3DProjTablesPtr>::iterator it=lut_cache.begin();it!=lut_cache.end();++it)
+	{
+		if ((*it)->W==W && (*it)->H==H && !((*it)->camParams!=camParams))
+		{
+			// Move to front:
+			if (it!=lut_cache.begin()) lut_cache.splice(lut_cache.begin(),lut_cache,it);
+			return lut_cache.front();
+		}
+	}
+
+	// Not found: build a new one. Tables in use by other threads stay alive (smart pointers) after leaving the cache.
+	TCached3DProjTables *lut = new TCached3DProjTables();
+	lut->camParams = camParams;
+	lut->W = W;
+	lut->H = H;
+	lut->Kys.resize(W*H);
+	lut->Kzs.resize(W*H);
+
+	const float r_cx = camParams.cx();
+	const float r_cy = camParams.cy();
+	const float r_fx_inv = 1.0f/camParams.fx();
+	const float r_fy_inv = 1.0f/camParams.fy();
+
+	float *kys = &lut->Kys[0];
+	float *kzs = &lut->Kzs[0];
+	for (int r=0;r<H;r++)
+		for (int c=0;c<W;c++)
+		{
+			*kys++ = (r_cx - c) * r_fx_inv;
+			*kzs++ = (r_cy - r) * r_fy_inv;
+		}
+
+	lut_cache.push_front( TCached3DProjTablesPtr(lut) );
+	if (lut_cache.size()>PROJ3D_LUT_CACHE_SIZE)
+		lut_cache.pop_back();
+	return lut_cache.front();
+}
 
 
 // Whether external files for 3D points & range are text or binary.
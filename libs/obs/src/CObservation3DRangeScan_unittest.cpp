@@ -0,0 +1,164 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/obs.h>
+#include <mrpt/base.h>
+#include <mrpt/opengl/CPointCloudColoured.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::slam;
+using namespace mrpt::utils;
+using namespace mrpt::poses;
+using namespace std;
+
+namespace
+{
+	// Odd sizes, so the SIMD code paths leave some columns for the scalar one:
+	const int W = 61, H = 37;
+
+	void createObs(CObservation3DRangeScan &obs)
+	{
+		obs.hasRangeImage  = true;
+		obs.range_is_depth = true;
+		obs.rangeImage.setSize(H,W);
+		for (int r=0;r<H;r++)
+			for (int c=0;c<W;c++)
+				obs.rangeImage(r,c) = ((r+c)%11==0) ? 0.0f : 0.5f + ((r*7+c*13)%50)*0.1f;
+
+		obs.cameraParams.ncols = W;
+		obs.cameraParams.nrows = H;
+		obs.cameraParams.setIntrinsicParamsFromValues(100,110,30.5,18.2);
+		obs.sensorPose = CPose3D(0.1,0.2,0.5, DEG2RAD(10),DEG2RAD(-5),DEG2RAD(2));
+	}
+
+	// The expected points, computed without the LUT, SIMD nor threads:
+	void referenceProjection(const CObservation3DRangeScan &obs, const T3DPointsProjectionParams &pp, vector<TPoint3D> &pts)
+	{
+		pts.clear();
+		for (int r=0;r<H;r+=pp.decimation)
+			for (int c=0;c<W;c+=pp.decimation)
+			{
+				const float D = obs.rangeImage(r,c);
+				if (pp.rangeMin>0 && D<pp.rangeMin) continue;
+				if (pp.rangeMax>0 && D>pp.rangeMax) continue;
+				TPoint3D pt( D, (obs.cameraParams.cx()-c)/obs.cameraParams.fx()*D, (obs.cameraParams.cy()-r)/obs.cameraParams.fy()*D );
+				if (pp.takeIntoAccountSensorPoseOnRobot)
+				{
+					TPoint3D g;
+					obs.sensorPose.composePoint(pt,g);
+					pt = g;
+				}
+				pts.push_back(pt);
+			}
+	}
+
+	void checkProjection(const T3DPointsProjectionParams &pp)
+	{
+		CObservation3DRangeScan obs;
+		createObs(obs);
+
+		vector<TPoint3D> expected;
+		referenceProjection(obs,pp,expected);
+
+		CObservation3DRangeScan out;
+		obs.project3DPointsFromDepthImageInto(out,pp);
+
+		ASSERT_EQ(expected.size(), out.points3D_x.size());
+		for (size_t i=0;i<expected.size();i++)
+		{
+			EXPECT_NEAR(expected[i].x, out.points3D_x[i], 1e-4);
+			EXPECT_NEAR(expected[i].y, out.points3D_y[i], 1e-4);
+			EXPECT_NEAR(expected[i].z, out.points3D_z[i], 1e-4);
+		}
+	}
+}
+
+TEST(CObservation3DRangeScan, Project3D_Default)
+{
+	checkProjection(T3DPointsProjectionParams());
+}
+
+TEST(CObservation3DRangeScan, Project3D_NoLUT)
+{
+	T3DPointsProjectionParams pp;
+	pp.PROJ3D_USE_LUT = false;
+	checkProjection(pp);
+}
+
+TEST(CObservation3DRangeScan, Project3D_ParallelWithPose)
+{
+	T3DPointsProjectionParams pp;
+	pp.parallelMinPoints = 1;
+	pp.takeIntoAccountSensorPoseOnRobot = true;
+	checkProjection(pp);
+	pp.USE_SIMD = false;
+	checkProjection(pp);
+}
+
+TEST(CObservation3DRangeScan, Project3D_FilterAndDecimation)
+{
+	T3DPointsProjectionParams pp;
+	pp.rangeMin = 1.0f;
+	pp.rangeMax = 4.0f;
+	checkProjection(pp);
+
+	pp.parallelMinPoints = 1;
+	pp.takeIntoAccountSensorPoseOnRobot = true;
+	checkProjection(pp);
+
+	pp.decimation = 3;
+	checkProjection(pp);
+	pp.PROJ3D_USE_LUT = false;
+	checkProjection(pp);
+}
+
+// CImage has no pixel storage without OpenCV
+#if MRPT_HAS_OPENCV
+// With coinciding depth and intensity cameras, each point takes the color of its own pixel:
+TEST(CObservation3DRangeScan, Project3D_ColorDirectCorresp)
+{
+	CObservation3DRangeScan obs;
+	createObs(obs);
+	obs.hasIntensityImage = true;
+	obs.intensityImage = CImage(W,H,CH_GRAY);
+	for (int r=0;r<H;r++)
+		for (int c=0;c<W;c++)
+			*obs.intensityImage.get_unsafe(c,r,0) = static_cast<uint8_t>( (r*W+c)%251 );
+	obs.cameraParamsIntensity = obs.cameraParams;
+	obs.relativePoseIntensityWRTDepth = CPose3D(0,0,0, DEG2RAD(-90),0,DEG2RAD(-90));
+	ASSERT_TRUE(obs.doDepthAndIntensityCamerasCoincide());
+
+	T3DPointsProjectionParams pp;
+	for (int test=0;test<3;test++)
+	{
+		if (test==1) { pp.parallelMinPoints = 1; pp.rangeMin = 1.0f; }
+		if (test==2) { pp.decimation = 3; pp.USE_SIMD = false; }
+
+		// The pixel of each expected point, in the same order than referenceProjection():
+		vector<int> expected;
+		for (int r=0;r<H;r+=pp.decimation)
+			for (int c=0;c<W;c+=pp.decimation)
+			{
+				const float D = obs.rangeImage(r,c);
+				if ((pp.rangeMin>0 && D<pp.rangeMin) || (pp.rangeMax>0 && D>pp.rangeMax)) continue;
+				expected.push_back( (r*W+c)%251 );
+			}
+
+		mrpt::opengl::CPointCloudColoured pts;
+		obs.project3DPointsFromDepthImageInto(pts,pp);
+		ASSERT_EQ(expected.size(), pts.size()) << "test=" << test;
+		for (size_t i=0;i<expected.size();i++)
+		{
+			EXPECT_NEAR(expected[i], 255*pts.getPoint(i).R, 1e-3) << "i=" << i << " test=" << test;
+			EXPECT_NEAR(expected[i], 255*pts.getPoint(i).B, 1e-3) << "i=" << i << " test=" << test;
+		}
+	}
+}
+#endif
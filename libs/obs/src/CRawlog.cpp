@@ -11,6 +11,9 @@
 
 #include <mrpt/system/filesystem.h>
 #include <mrpt/slam/CRawlog.h>
+#include <mrpt/slam/CChunkedRawlogReader.h>
+#include <mrpt/slam/CChunkedRawlogWriter.h>
+#include <mrpt/slam/CRawlogLazyLoader.h>
 #include <mrpt/utils/CFileInputStream.h>
 #include <mrpt/utils/CFileGZInputStream.h>
 #include <mrpt/utils/CFileGZOutputStream.h>
@@ -47,6 +50,8 @@ void  CRawlog::clear()
 	// Since we use smart pointers, there's no need to manually delete object...
 	// for_each(m_seqOfActObs.begin(), m_seqOfActObs.end(),  ObjectDelete() );
 	m_seqOfActObs.clear();
+	m_lazy.clear_unique();  // (The loader may be shared with copies of this rawlog)
+	m_lazy_index.clear();
 
 	m_commentTexts.text.clear();
 }
@@ -57,6 +62,8 @@ void  CRawlog::clear()
 void  CRawlog::clearWithoutDelete()
 {
 	m_seqOfActObs.clear();
+	m_lazy.clear_unique();
+	m_lazy_index.clear();
 	m_commentTexts.text.clear();
 }
 
@@ -67,7 +74,7 @@ void  CRawlog::clearWithoutDelete()
 void  CRawlog::addObservations(
 		CSensoryFrame		&observations )
 {
-	m_seqOfActObs.push_back( CSerializablePtr( observations.duplicateGetSmartPtr() ) );
+	pushBackEntry( CSerializablePtr( observations.duplicateGetSmartPtr() ) );
 }
 
 /*---------------------------------------------------------------
@@ -76,7 +83,7 @@ void  CRawlog::addObservations(
 void  CRawlog::addActions(
 		CActionCollection		&actions )
 {
-	m_seqOfActObs.push_back( CSerializablePtr( actions.duplicateGetSmartPtr() ) );
+	pushBackEntry( CSerializablePtr( actions.duplicateGetSmartPtr() ) );
 }
 
 /*---------------------------------------------------------------
@@ -84,7 +91,7 @@ void  CRawlog::addActions(
   ---------------------------------------------------------------*/
 void  CRawlog::addActionsMemoryReference( const CActionCollectionPtr &action )
 {
-	m_seqOfActObs.push_back( action );
+	pushBackEntry( action );
 }
 
 /*---------------------------------------------------------------
@@ -92,7 +99,7 @@ void  CRawlog::addActionsMemoryReference( const CActionCollectionPtr &action )
   ---------------------------------------------------------------*/
 void  CRawlog::addObservationsMemoryReference( const CSensoryFramePtr &observations )
 {
-	m_seqOfActObs.push_back( observations );
+	pushBackEntry( observations );
 }
 
 /*---------------------------------------------------------------
@@ -106,7 +113,7 @@ void  CRawlog::addObservationMemoryReference( const CObservationPtr &observation
 		m_commentTexts = *o;
 	}
 	else
-	m_seqOfActObs.push_back( observation );
+	pushBackEntry( observation );
 }
 
 /*---------------------------------------------------------------
@@ -116,7 +123,27 @@ void  CRawlog::addAction( CAction &action )
 {
 	CActionCollection	*temp = new CActionCollection();
 	temp->insert( action );
-	m_seqOfActObs.push_back( CSerializablePtr(temp) );
+	pushBackEntry( CSerializablePtr(temp) );
+}
+
+/*---------------------------------------------------------------
+						pushBackEntry
+  ---------------------------------------------------------------*/
+void CRawlog::pushBackEntry( const CSerializablePtr &obj )
+{
+	m_seqOfActObs.push_back( obj );
+	if (m_lazy.present())
+		m_lazy_index.push_back( std::string::npos );
+}
+
+/*---------------------------------------------------------------
+						getEntry
+  ---------------------------------------------------------------*/
+CSerializablePtr CRawlog::getEntry( size_t index ) const
+{
+	if (!m_lazy_index.empty() && m_lazy_index[index]!=std::string::npos)
+			return m_lazy->getEntry( m_lazy_index[index] );
+	else	return m_seqOfActObs[index];
 }
 
 /*---------------------------------------------------------------
@@ -137,7 +164,7 @@ CActionCollectionPtr  CRawlog::getAsAction( size_t index ) const
 	if (index >=m_seqOfActObs.size())
 		THROW_EXCEPTION("Index out of bounds")
 
-	CSerializablePtr obj = m_seqOfActObs[index];
+	CSerializablePtr obj = getEntry(index);
 
 	if ( obj->GetRuntimeClass() == CLASS_ID(CActionCollection) )
 			return CActionCollectionPtr( obj );
@@ -155,7 +182,7 @@ CObservationPtr  CRawlog::getAsObservation( size_t index ) const
 	if (index >=m_seqOfActObs.size())
 		THROW_EXCEPTION("Index out of bounds")
 
-	CSerializablePtr obj = m_seqOfActObs[index];
+	CSerializablePtr obj = getEntry(index);
 
 	if ( obj->GetRuntimeClass()->derivedFrom( CLASS_ID(CObservation) ) )
 			return CObservationPtr( obj );
@@ -173,7 +200,7 @@ CSerializablePtr CRawlog::getAsGeneric( size_t index ) const
 	if (index >=m_seqOfActObs.size())
 		THROW_EXCEPTION("Index out of bounds")
 
-	return m_seqOfActObs[index];
+	return getEntry(index);
 	MRPT_END
 }
 
@@ -186,15 +213,18 @@ CRawlog::TEntryType CRawlog::getType( size_t index ) const
 	if (index >=m_seqOfActObs.size())
 		THROW_EXCEPTION("Index out of bounds")
 
-	const CSerializablePtr &obj = m_seqOfActObs[index];
+	// In lazy-load mode, don't load the entry just to know its class:
+	const TRuntimeClassId *cls = (!m_lazy_index.empty() && m_lazy_index[index]!=std::string::npos) ?
+		m_lazy->getEntryClass( m_lazy_index[index] ) :
+		m_seqOfActObs[index]->GetRuntimeClass();
 
-	if( obj->GetRuntimeClass()->derivedFrom( CLASS_ID(CObservation) ) )
+	if( cls->derivedFrom( CLASS_ID(CObservation) ) )
 		return etObservation;
 
-	if( obj->GetRuntimeClass() == CLASS_ID(CActionCollection) )
+	if( cls == CLASS_ID(CActionCollection) )
 		return etActionCollection;
 
-	if( obj->GetRuntimeClass() == CLASS_ID(CSensoryFrame) )
+	if( cls == CLASS_ID(CSensoryFrame) )
 		return etSensoryFrame;
 
 	THROW_EXCEPTION("Object is not of any of the 3 allowed classes.");
@@ -211,7 +241,7 @@ CSensoryFramePtr  CRawlog::getAsObservations( size_t index ) const
 	if (index >=m_seqOfActObs.size())
 		THROW_EXCEPTION("Index out of bounds")
 
-	CSerializablePtr obj = m_seqOfActObs[index];
+	CSerializablePtr obj = getEntry(index);
 
 	if ( obj->GetRuntimeClass()->derivedFrom( CLASS_ID(CSensoryFrame) ))
 			return CSensoryFramePtr( obj );
@@ -234,7 +264,7 @@ void  CRawlog::writeToStream(CStream &out, int *version) const
 		n = static_cast<uint32_t>( m_seqOfActObs.size() );
 		out << n;
 		for (i=0;i<n;i++)
-			out << m_seqOfActObs[i];
+			out << getEntry(i);
 
 		out << m_commentTexts;
 	}
@@ -272,11 +302,21 @@ void  CRawlog::readFromStream(CStream &in,int version)
   ---------------------------------------------------------------*/
 bool  CRawlog::loadFromRawLogFile( const std::string &fileName )
 {
-	bool		keepReading = true;
 	// Open for read.
 
 	m_commentTexts.text.clear();
 
+	// Chunked & indexed rawlogs (see CChunkedRawlogWriter):
+	if (CChunkedRawlogReader::isChunkedRawlog(fileName))
+	{
+		CChunkedRawlogReader	fs;
+		if (!fs.open(fileName)) return false;
+
+		clear();
+		readObjectsFromStream(fs);
+		return true;
+	}
+
 	CFileGZInputStream		fs(fileName);
 
 	if (!fs.fileOpenCorrectly()) return false;
@@ -284,6 +324,44 @@ bool  CRawlog::loadFromRawLogFile( const std::string &fileName )
 	// Clear first:
 	clear();
 
+	readObjectsFromStream(fs);
+	return true;
+}
+
+/*---------------------------------------------------------------
+					loadFromRawLogFileLazy
+  ---------------------------------------------------------------*/
+bool  CRawlog::loadFromRawLogFileLazy( const std::string &fileName, const uint64_t cacheMaxBytes )
+{
+	if (!mrpt::system::fileExists(fileName)) return false;
+
+	clear();
+
+	CRawlogLazyLoaderPtr lazy = CRawlogLazyLoaderPtr( new CRawlogLazyLoader() );
+	if (!lazy->open(fileName,&m_commentTexts))
+	{
+		std::cerr << "[CRawlog::loadFromRawLogFileLazy] Warning: '" << fileName << "' cannot be loaded lazily, loading it entirely into memory.\n";
+		return loadFromRawLogFile(fileName);
+	}
+	lazy->setCacheMaxBytes(cacheMaxBytes);
+
+	const size_t N = lazy->size();
+	m_lazy = lazy;
+	m_seqOfActObs.assign(N, CSerializablePtr()); // Empty pointers: read from m_lazy on demand
+	m_lazy_index.resize(N);
+	for (size_t i=0;i<N;i++)
+		m_lazy_index[i] = i;
+
+	return true;
+}
+
+/*---------------------------------------------------------------
+					readObjectsFromStream
+  ---------------------------------------------------------------*/
+void CRawlog::readObjectsFromStream( CStream &fs )
+{
+	bool		keepReading = true;
+
 	// OK: read objects:
 	while (keepReading)
 	{
@@ -297,7 +375,7 @@ bool  CRawlog::loadFromRawLogFile( const std::string &fileName )
 				// It is an entire object: Copy and finish:
 				CRawlogPtr ao = CRawlogPtr( newObj );
 				this->swap(*ao);
-				return true;
+				return;
             }
             else if ( newObj->GetRuntimeClass()->derivedFrom( CLASS_ID(CObservation)) )
             {
@@ -307,15 +385,15 @@ bool  CRawlog::loadFromRawLogFile( const std::string &fileName )
 					m_commentTexts = *o;
             	}
             	else
-					m_seqOfActObs.push_back( newObj );
+					pushBackEntry( newObj );
             }
             else if ( newObj->GetRuntimeClass() == CLASS_ID(CSensoryFrame))
             {
-	        	m_seqOfActObs.push_back( newObj );
+	        	pushBackEntry( newObj );
             }
             else if ( newObj->GetRuntimeClass() == CLASS_ID(CActionCollection))
             {
-				m_seqOfActObs.push_back( newObj );
+				pushBackEntry( newObj );
             }
 			/** FOR BACKWARD COMPATIBILITY: CPose2D was used previously intead of an "ActionCollection" object
 																				26-JAN-2006	*/
@@ -327,7 +405,7 @@ bool  CRawlog::loadFromRawLogFile( const std::string &fileName )
 				CActionRobotMovement2D::TMotionModelOptions	options;
 				action.computeFromOdometry( *poseChange, options);
 				temp->insert( action );
-				m_seqOfActObs.push_back( temp );
+				pushBackEntry( temp );
             }
 			else
 			{       // Unknown class:
@@ -348,8 +426,6 @@ bool  CRawlog::loadFromRawLogFile( const std::string &fileName )
 			keepReading = false;
 		}
 	}
-
-	return true;
 }
 
 /*---------------------------------------------------------------
@@ -363,6 +439,8 @@ void  CRawlog::remove( size_t index )
 		THROW_EXCEPTION("Index out of bounds")
 
 	m_seqOfActObs.erase( m_seqOfActObs.begin()+index );
+	if (!m_lazy_index.empty())
+		m_lazy_index.erase( m_lazy_index.begin()+index );
 
 	MRPT_END
 }
@@ -378,6 +456,8 @@ void  CRawlog::remove( size_t first_index, size_t last_index )
 		THROW_EXCEPTION("Index out of bounds")
 
 	m_seqOfActObs.erase( m_seqOfActObs.begin()+first_index, m_seqOfActObs.begin()+last_index+1 );
+	if (!m_lazy_index.empty())
+		m_lazy_index.erase( m_lazy_index.begin()+first_index, m_lazy_index.begin()+last_index+1 );
 
 	MRPT_END
 }
@@ -396,7 +476,7 @@ bool  CRawlog::saveToRawLogFile( const std::string &fileName ) const
 			f << m_commentTexts;
 
 		for (size_t i=0;i<m_seqOfActObs.size();i++)
-			f << *m_seqOfActObs[i];
+			f << *getEntry(i);
 
 		return true;
 	}
@@ -408,6 +488,30 @@ bool  CRawlog::saveToRawLogFile( const std::string &fileName ) const
 
 
 
+/*---------------------------------------------------------------
+					saveToChunkedRawLogFile
+  ---------------------------------------------------------------*/
+bool  CRawlog::saveToChunkedRawLogFile( const std::string &fileName, const size_t chunkSize ) const
+{
+	try
+	{
+		CChunkedRawlogWriter	f(fileName,chunkSize);
+
+		if (!m_commentTexts.text.empty())
+			f.write(m_commentTexts);
+
+		for (size_t i=0;i<m_seqOfActObs.size();i++)
+			f.write(*getEntry(i));
+
+		f.close();
+		return true;
+	}
+	catch(...)
+	{
+		return false;
+	}
+}
+
 /*---------------------------------------------------------------
 					moveFrom
   ---------------------------------------------------------------*/
@@ -418,7 +522,11 @@ void CRawlog::moveFrom( CRawlog &obj)
 	clear();
 	m_commentTexts = obj.m_commentTexts;
 	m_seqOfActObs = obj.m_seqOfActObs;
+	m_lazy = obj.m_lazy;
+	m_lazy_index = obj.m_lazy_index;
 	obj.m_seqOfActObs.clear();
+	obj.m_lazy.clear_unique();
+	obj.m_lazy_index.clear();
 	obj.m_commentTexts.text.clear();
 	MRPT_END
 }
@@ -430,6 +538,8 @@ void CRawlog::swap( CRawlog &obj)
 {
 	if (this == &obj) return;
 	m_seqOfActObs.swap(obj.m_seqOfActObs);
+	std::swap(m_lazy, obj.m_lazy);
+	m_lazy_index.swap(obj.m_lazy_index);
 	std::swap(m_commentTexts, obj.m_commentTexts);
 }
 
@@ -581,23 +691,25 @@ void CRawlog::findObservationsByClassInRange(
 
 	// Find the first appearance of time_start:
 	// ---------------------------------------------------
-	TListObjects::const_iterator first = m_seqOfActObs.begin();
-	const TListObjects::const_iterator last  = m_seqOfActObs.end();
+	// (Use indices and getEntry() so that, in lazy-load mode, only the visited entries are loaded)
+	size_t first = 0;
+	const size_t last = m_seqOfActObs.size();
 	{
 		// The following is based on lower_bound:
 		size_t count, step;
-		count = std::distance(first,last);
+		count = last-first;
 		while (count>0)
 		{
-			TListObjects::const_iterator it = first;
+			size_t it = first;
 			step=count/2;
-			std::advance(it,step);
+			it+=step;
 
 			// The comparison function:
 			TTimeStamp this_timestamp;
-			if ( (*it)->GetRuntimeClass()->derivedFrom( CLASS_ID( CObservation ) ) )
+			const CSerializablePtr obj = getEntry(it);
+			if ( obj->GetRuntimeClass()->derivedFrom( CLASS_ID( CObservation ) ) )
 			{
-				CObservationPtr o = CObservationPtr (*it);
+				CObservationPtr o = CObservationPtr (obj);
 				this_timestamp = o->timestamp;
 				ASSERT_(this_timestamp!=INVALID_TIMESTAMP);
 			}
@@ -618,9 +730,10 @@ void CRawlog::findObservationsByClassInRange(
 	while (first!=last)
 	{
 		TTimeStamp this_timestamp;
-		if ((*first)->GetRuntimeClass()->derivedFrom( CLASS_ID(CObservation)))
+		const CSerializablePtr obj = getEntry(first);
+		if (obj->GetRuntimeClass()->derivedFrom( CLASS_ID(CObservation)))
 		{
-			CObservationPtr o = CObservationPtr (*first);
+			CObservationPtr o = CObservationPtr (obj);
 			this_timestamp = o->timestamp;
 			ASSERT_(this_timestamp!=INVALID_TIMESTAMP);
 
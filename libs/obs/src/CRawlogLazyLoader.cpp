@@ -0,0 +1,229 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/obs.h>   // Precompiled headers
+
+#include <mrpt/slam/CRawlogLazyLoader.h>
+#include <mrpt/slam/CSensoryFrame.h>
+#include <mrpt/slam/CActionCollection.h>
+#include <mrpt/slam/CRawlog.h>
+#include <mrpt/utils/CMemoryStream.h>
+
+using namespace mrpt;
+using namespace mrpt::slam;
+using namespace mrpt::utils;
+using namespace mrpt::poses;
+using namespace std;
+
+/*---------------------------------------------------------------
+					Constructor / destructor
+  ---------------------------------------------------------------*/
+CRawlogLazyLoader::CRawlogLazyLoader() :
+	m_cache_bytes(0),
+	m_cache_max_bytes(256*1024*1024)
+{
+}
+
+CRawlogLazyLoader::~CRawlogLazyLoader()
+{
+	close();
+}
+
+/*---------------------------------------------------------------
+							close
+  ---------------------------------------------------------------*/
+void CRawlogLazyLoader::close()
+{
+	mrpt::synch::CCriticalSectionLocker lock(&m_cache_cs);
+	m_entries.clear();
+	m_lru.clear();
+	m_cache_bytes = 0;
+	m_mmap.close();
+	m_chunked.close();
+}
+
+/*---------------------------------------------------------------
+							open
+  ---------------------------------------------------------------*/
+bool CRawlogLazyLoader::open(const std::string &fileName, CObservationComment *out_comments)
+{
+	close();
+
+	bool has_comments = false;
+
+	// Chunked rawlogs: just load their index
+	// ----------------------------------------
+	if (CChunkedRawlogReader::isChunkedRawlog(fileName))
+	{
+		if (!m_chunked.open(fileName)) return false;
+
+		const size_t N = m_chunked.getEntryCount();
+		m_entries.reserve(N);
+		for (size_t i=0;i<N;i++)
+		{
+			const TChunkedRawlogEntry &ce = m_chunked.getEntry(i);
+			const TRuntimeClassId *cls = mrpt::utils::findRegisteredClass(ce.className);
+			if (!cls) break; // Unknown class: stop here, as CRawlog::loadFromRawLogFile() does.
+
+			if (cls==CLASS_ID(CObservationComment))
+			{
+				if (out_comments && !has_comments)
+				{
+					*out_comments = *CObservationCommentPtr( m_chunked.readEntry(i) );
+					has_comments = true;
+				}
+				continue;
+			}
+			if (!cls->derivedFrom(CLASS_ID(CObservation)) && cls!=CLASS_ID(CSensoryFrame) && cls!=CLASS_ID(CActionCollection))
+			{
+				if (cls==CLASS_ID(CRawlog) || cls==CLASS_ID(CPose2D)) { close(); return false; }
+				break;
+			}
+
+			TEntry e;
+			e.offset = i;
+			e.size   = ce.size;
+			e.cls    = cls;
+			m_entries.push_back(e);
+		}
+		return true;
+	}
+
+	// Plain rawlogs: map the file and index it
+	// -----------------------------------------
+	if (!m_mmap.open(fileName)) return false;
+	const unsigned char *data = m_mmap.getData();
+	const uint64_t fileSize = m_mmap.getSize();
+
+	if (fileSize>=2 && data[0]==0x1F && data[1]==0x8B)
+	{
+		std::cerr << "[CRawlogLazyLoader::open] '" << fileName << "' is gz-compressed: decompress it or convert it with 'rawlog-edit --to-chunked' to load it lazily.\n";
+		close();
+		return false;
+	}
+
+	CMemoryStream ms;
+	if (fileSize)
+		ms.assignMemoryNotOwn(data,fileSize);
+
+	for (;;)
+	{
+		const uint64_t pos = ms.getPosition();
+		CSerializablePtr obj;
+		try
+		{
+			ms >> obj;
+		}
+		catch (CExceptionEOF &)
+		{
+			break;
+		}
+		catch (std::exception &e)
+		{
+			std::cerr << e.what() << std::endl;
+			break;
+		}
+
+		const TRuntimeClassId *cls = obj->GetRuntimeClass();
+		if (cls==CLASS_ID(CObservationComment))
+		{
+			if (out_comments && !has_comments)
+			{
+				*out_comments = *CObservationCommentPtr(obj);
+				has_comments = true;
+			}
+			continue;
+		}
+		if (!cls->derivedFrom(CLASS_ID(CObservation)) && cls!=CLASS_ID(CSensoryFrame) && cls!=CLASS_ID(CActionCollection))
+		{
+			if (cls==CLASS_ID(CRawlog) || cls==CLASS_ID(CPose2D)) { close(); return false; }
+			break;
+		}
+
+		TEntry e;
+		e.offset = pos;
+		e.size   = static_cast<uint32_t>(ms.getPosition()-pos);
+		e.cls    = cls;
+		m_entries.push_back(e);
+	}
+	return true;
+}
+
+/*---------------------------------------------------------------
+							getEntry
+  ---------------------------------------------------------------*/
+CSerializablePtr CRawlogLazyLoader::getEntry(const size_t index)
+{
+	MRPT_START
+	ASSERTMSG_(index<m_entries.size(),"Index out of bounds")
+
+	mrpt::synch::CCriticalSectionLocker lock(&m_cache_cs);
+	TEntry &e = m_entries[index];
+	if (e.obj.present())
+	{	// Cache hit: move to the front of the LRU list
+		m_lru.splice(m_lru.begin(),m_lru,e.lru_it);
+		return e.obj;
+	}
+
+	if (m_chunked.fileOpenCorrectly())
+	{
+		e.obj = m_chunked.readEntry(static_cast<size_t>(e.offset));
+	}
+	else
+	{
+		CMemoryStream ms;
+		ms.assignMemoryNotOwn(m_mmap.getData()+e.offset,e.size);
+		ms >> e.obj;
+	}
+
+	m_lru.push_front(index);
+	e.lru_it = m_lru.begin();
+	m_cache_bytes += e.size;
+	evictEntries();
+
+	return e.obj;
+	MRPT_END
+}
+
+/*---------------------------------------------------------------
+							evictEntries
+  ---------------------------------------------------------------*/
+void CRawlogLazyLoader::evictEntries()
+{
+	// Always keep at least the last entry read:
+	while (m_cache_bytes>m_cache_max_bytes && m_lru.size()>1)
+	{
+		TEntry &e = m_entries[m_lru.back()];
+		e.obj.clear_unique();  // (Not clear(), which would delete the object for the user pointers too)
+		m_cache_bytes -= e.size;
+		m_lru.pop_back();
+	}
+}
+
+/*---------------------------------------------------------------
+							setCacheMaxBytes
+  ---------------------------------------------------------------*/
+void CRawlogLazyLoader::setCacheMaxBytes(const uint64_t maxBytes)
+{
+	mrpt::synch::CCriticalSectionLocker lock(&m_cache_cs);
+	m_cache_max_bytes = maxBytes;
+	evictEntries();
+}
+
+/*---------------------------------------------------------------
+							clearCache
+  ---------------------------------------------------------------*/
+void CRawlogLazyLoader::clearCache()
+{
+	mrpt::synch::CCriticalSectionLocker lock(&m_cache_cs);
+	for (std::list<size_t>::const_iterator it=m_lru.begin();it!=m_lru.end();++it)
+		m_entries[*it].obj.clear_unique();
+	m_lru.clear();
+	m_cache_bytes = 0;
+}
@@ -0,0 +1,301 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/obs.h>
+#include <mrpt/base.h>
+#include <mrpt/system/parallelization.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::slam;
+using namespace mrpt::utils;
+using namespace mrpt::poses;
+using namespace mrpt::system;
+using namespace std;
+
+namespace
+{
+	const TTimeStamp t0 = mrpt::system::time_tToTimestamp(1.0e9);
+	const size_t     N  = 200;
+
+	// A rawlog in format #2 (only observations), one per second:
+	void createRawlogObs(CRawlog &rawlog)
+	{
+		rawlog.setCommentText("Test rawlog");
+		for (size_t i=0;i<N;i++)
+		{
+			CObservationOdometryPtr o = CObservationOdometry::Create();
+			o->timestamp   = t0 + i*10000000; // +1 sec
+			o->sensorLabel = (i%2) ? "ODO1":"ODO2";
+			o->odometry    = CPose2D(i,0,0);
+			rawlog.addObservationMemoryReference(o);
+		}
+	}
+}
+
+TEST(CRawlog, ChunkedFormatLoadSave)
+{
+	CRawlog rawlog;
+	createRawlogObs(rawlog);
+
+	const string fil_chunked = getTempFileName();
+	const string fil_plain   = getTempFileName();
+	ASSERT_TRUE( rawlog.saveToChunkedRawLogFile(fil_chunked, 256) );
+	ASSERT_TRUE( rawlog.saveToRawLogFile(fil_plain) );
+
+	EXPECT_TRUE ( CChunkedRawlogReader::isChunkedRawlog(fil_chunked) );
+	EXPECT_FALSE( CChunkedRawlogReader::isChunkedRawlog(fil_plain) );
+
+	// Load through CRawlog (format auto-detection):
+	CRawlog rawlog2;
+	ASSERT_TRUE( rawlog2.loadFromRawLogFile(fil_chunked) );
+	ASSERT_EQ( N, rawlog2.size() );
+	EXPECT_EQ( rawlog.getCommentText(), rawlog2.getCommentText() );
+	for (size_t i=0;i<N;i++)
+	{
+		CObservationOdometryPtr o = CObservationOdometryPtr( rawlog2.getAsObservation(i) );
+		EXPECT_EQ( t0 + i*10000000, o->timestamp );
+		EXPECT_EQ( rawlog.getAsObservation(i)->sensorLabel, o->sensorLabel );
+		EXPECT_EQ( double(i), o->odometry.x() );
+	}
+
+	deleteFile(fil_chunked);
+	deleteFile(fil_plain);
+}
+
+TEST(CRawlog, ChunkedFormatSeek)
+{
+	CRawlog rawlog;
+	createRawlogObs(rawlog);
+	const string fil = getTempFileName();
+	ASSERT_TRUE( rawlog.saveToChunkedRawLogFile(fil, 256) );
+
+	CChunkedRawlogReader f;
+	ASSERT_TRUE( f.open(fil) );
+
+	// The comment + the observations:
+	ASSERT_EQ( N+1, f.getEntryCount() );
+	EXPECT_EQ( string("CObservationComment"), f.getEntry(0).className );
+	EXPECT_EQ( string("CObservationOdometry"), f.getEntry(1).className );
+	EXPECT_EQ( string("ODO2"), f.getEntry(1).sensorLabel );
+	EXPECT_EQ( t0 + 5*10000000, f.getEntry(6).timestamp );
+	EXPECT_GT( f.getEntry(N).chunk, 0u );
+
+	// Random access:
+	CObservationOdometryPtr o = CObservationOdometryPtr( f.readEntry(120) );
+	EXPECT_EQ( 119.0, o->odometry.x() );
+	o = CObservationOdometryPtr( f.readEntry(3) );
+	EXPECT_EQ( 2.0, o->odometry.x() );
+
+	// Seek by time and go on reading sequentially from there:
+	EXPECT_EQ( 152u, f.seekToTimestamp(t0 + 150*10000000 + 5000000) );
+	CActionCollectionPtr acts;
+	CSensoryFramePtr     SF;
+	CObservationPtr      obs;
+	size_t idx = 0;
+	for (size_t i=151;i<N;i++)
+	{
+		ASSERT_TRUE( CRawlog::getActionObservationPairOrObservation(f,acts,SF,obs,idx) );
+		ASSERT_TRUE( obs.present() );
+		EXPECT_EQ( t0 + i*10000000, obs->timestamp );
+	}
+	EXPECT_FALSE( CRawlog::getActionObservationPairOrObservation(f,acts,SF,obs,idx) );
+
+	f.seekToEntry(f.getEntryCount());
+	EXPECT_EQ( f.getTotalBytesCount(), f.getPosition() );
+
+	f.close();
+	deleteFile(fil);
+}
+
+TEST(CRawlog, ChunkedFormatActionObservationPairs)
+{
+	// A rawlog in format #1 (actions & sensory frames):
+	CRawlog rawlog;
+	for (size_t i=0;i<50;i++)
+	{
+		CActionRobotMovement2D act;
+		act.timestamp = t0 + i*10000000;
+		act.computeFromOdometry(CPose2D(0.1,0,0), CActionRobotMovement2D::TMotionModelOptions());
+		CActionCollection acts;
+		acts.insert(act);
+		rawlog.addActions(acts);
+
+		CObservationOdometryPtr o = CObservationOdometry::Create();
+		o->timestamp = t0 + i*10000000 + 5000000;
+		o->odometry  = CPose2D(i,0,0);
+		CSensoryFrame sf;
+		sf.insert(o);
+		rawlog.addObservations(sf);
+	}
+
+	const string fil = getTempFileName();
+	ASSERT_TRUE( rawlog.saveToChunkedRawLogFile(fil, 512) );
+
+	CChunkedRawlogReader f(fil);
+	ASSERT_EQ( 100u, f.getEntryCount() );
+	EXPECT_EQ( string("CActionCollection"), f.getEntry(40).className );
+	EXPECT_EQ( string("CSensoryFrame"), f.getEntry(41).className );
+
+	// Jump to the 20th pair:
+	EXPECT_EQ( 40u, f.seekToTimestamp(t0 + 20*10000000) );
+	CActionCollectionPtr acts;
+	CSensoryFramePtr     SF;
+	size_t idx = 0;
+	for (size_t i=20;i<50;i++)
+	{
+		ASSERT_TRUE( CRawlog::readActionObservationPair(f,acts,SF,idx) );
+		ASSERT_EQ( 1u, SF->size() );
+		EXPECT_EQ( double(i), CObservationOdometryPtr(SF->getObservationByIndex(0))->odometry.x() );
+	}
+
+	f.close();
+	deleteFile(fil);
+}
+
+namespace
+{
+	// Body for mrpt::system::parallel_for(): reads entries of a lazy-loaded rawlog from several threads at once
+	struct TReadEntriesBody
+	{
+		const CRawlog      &rawlog;
+		std::vector<char>  &ok;
+
+		TReadEntriesBody(const CRawlog &rawlog_, std::vector<char> &ok_) : rawlog(rawlog_), ok(ok_) {}
+
+		void operator()(const mrpt::system::BlockedRange &r) const
+		{
+			for (int k=r.begin();k!=r.end();++k)
+			{
+				const size_t i = (k*37)%N;
+				CObservationOdometryPtr o = CObservationOdometryPtr( rawlog.getAsObservation(i) );
+				ok[k] = (o->odometry.x()==double(i) && o->timestamp==t0 + i*10000000);
+			}
+		}
+	};
+
+	void checkLazyRawlog(const std::string &fil)
+	{
+		CRawlog rawlog;
+		ASSERT_TRUE( rawlog.loadFromRawLogFileLazy(fil, 2000) );
+		ASSERT_TRUE( rawlog.isLazyLoaded() );
+		ASSERT_EQ( N, rawlog.size() );
+		EXPECT_EQ( string("Test rawlog"), rawlog.getCommentText() );
+
+		CRawlogLazyLoaderPtr lazy = rawlog.getLazyLoader();
+		EXPECT_EQ( 0u, lazy->getCachedEntriesCount() );
+
+		// Random access, much more data than the cache size:
+		for (size_t k=0;k<3*N;k++)
+		{
+			const size_t i = (k*37)%N;
+			CObservationOdometryPtr o = CObservationOdometryPtr( rawlog.getAsObservation(i) );
+			EXPECT_EQ( double(i), o->odometry.x() );
+			EXPECT_EQ( t0 + i*10000000, o->timestamp );
+			EXPECT_LE( lazy->getCacheBytes(), lazy->getCacheMaxBytes() );
+		}
+		EXPECT_LT( lazy->getCachedEntriesCount(), N/2 );
+
+		// Simultaneous reads from several threads (the const accessors share the cache):
+		std::vector<char> ok(10*N,0);
+		mrpt::system::parallel_for( mrpt::system::BlockedRange(0,static_cast<int>(ok.size()),1), TReadEntriesBody(rawlog,ok) );
+		EXPECT_EQ( ok.size(), static_cast<size_t>(std::count(ok.begin(),ok.end(),1)) );
+		EXPECT_LE( lazy->getCacheBytes(), lazy->getCacheMaxBytes() );
+
+		// Iterators:
+		size_t i=0;
+		for (CRawlog::iterator it=rawlog.begin();it!=rawlog.end();++it,++i)
+		{
+			EXPECT_EQ( CRawlog::etObservation, it.getType() );
+			EXPECT_EQ( double(i), CObservationOdometryPtr(*it)->odometry.x() );
+		}
+		EXPECT_EQ( N, i );
+
+		// A pointer held by the user remains valid after its entry is released from the cache:
+		{
+			CObservationOdometryPtr held = CObservationOdometryPtr( rawlog.getAsObservation(5) );
+			lazy->clearCache();
+			for (size_t k=0;k<N;k++)
+				rawlog.getAsObservation(k);  // Fill the cache again, evicting many entries
+			EXPECT_EQ( 5.0, held->odometry.x() );
+			EXPECT_EQ( 5.0, CObservationOdometryPtr(rawlog.getAsObservation(5))->odometry.x() );
+		}
+
+		TListTimeAndObservations found;
+		rawlog.findObservationsByClassInRange(t0+10*10000000, t0+20*10000000, CLASS_ID(CObservationOdometry), found);
+		EXPECT_EQ( 10u, found.size() );
+
+		// Modifications:
+		rawlog.remove(0);
+		EXPECT_EQ( 1.0, CObservationOdometryPtr(rawlog.getAsObservation(0))->odometry.x() );
+		CObservationOdometryPtr o = CObservationOdometry::Create();
+		o->odometry = CPose2D(1000,0,0);
+		rawlog.addObservationMemoryReference(o);
+		ASSERT_EQ( N, rawlog.size() );
+		EXPECT_EQ( 1000.0, CObservationOdometryPtr(rawlog.getAsObservation(N-1))->odometry.x() );
+		EXPECT_EQ( double(N-1), CObservationOdometryPtr(rawlog.getAsObservation(N-2))->odometry.x() );
+
+		// Copies share the loader: clearing one must not affect the others:
+		{
+			CRawlog copy(rawlog);
+			copy.clear();
+		}
+		EXPECT_EQ( 4.0, CObservationOdometryPtr(rawlog.getAsObservation(3))->odometry.x() );
+
+		CRawlog moved;
+		moved.moveFrom(rawlog);
+		EXPECT_EQ( 0u, rawlog.size() );
+		ASSERT_EQ( N, moved.size() );
+		EXPECT_EQ( CRawlog::etObservation, moved.getType(3) );
+		EXPECT_EQ( 4.0, CObservationOdometryPtr(moved.getAsObservation(3))->odometry.x() );
+	}
+}
+
+TEST(CRawlog, LazyLoadPlain)
+{
+	CRawlog rawlog;
+	createRawlogObs(rawlog);
+
+	// Write an uncompressed rawlog:
+	const string fil = getTempFileName();
+	{
+		CFileOutputStream f(fil);
+		CObservationComment comment;
+		comment.text = rawlog.getCommentText();
+		f << comment;
+		for (size_t i=0;i<rawlog.size();i++)
+			f << *rawlog.getAsObservation(i);
+	}
+	checkLazyRawlog(fil);
+	deleteFile(fil);
+}
+
+TEST(CRawlog, LazyLoadChunked)
+{
+	CRawlog rawlog;
+	createRawlogObs(rawlog);
+	const string fil = getTempFileName();
+	ASSERT_TRUE( rawlog.saveToChunkedRawLogFile(fil, 1024) );
+	checkLazyRawlog(fil);
+	deleteFile(fil);
+}
+
+TEST(CRawlog, LazyLoadGzFallback)
+{
+	CRawlog rawlog;
+	createRawlogObs(rawlog);
+	const string fil = getTempFileName();
+	ASSERT_TRUE( rawlog.saveToRawLogFile(fil) );
+
+	CRawlog rawlog2;
+	ASSERT_TRUE( rawlog2.loadFromRawLogFileLazy(fil) );
+	EXPECT_FALSE( rawlog2.isLazyLoaded() );
+	EXPECT_EQ( N, rawlog2.size() );
+	deleteFile(fil);
+}
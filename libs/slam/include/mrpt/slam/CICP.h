@@ -26,7 +26,9 @@ namespace mrpt
 		{
 			icpClassic = 0,
 			icpLevenbergMarquardt,
-			icpIKF
+			icpIKF,
+			icpPointToPlane, //!< Point-to-plane (point-to-line in 2D) metric, with normals estimated from the neighbourhood of each point in the reference map
+			icpGeneralized   //!< Generalized-ICP (plane-to-plane), with covariances estimated from the neighbourhoods of the points in both maps
 		};
 
 		/** Several implementations of ICP (Iterative closest point) algorithms for aligning two point maps or a point map wrt a grid map.
@@ -142,6 +144,25 @@ namespace mrpt
 				  */
 				uint32_t        corresponding_points_decimation;
 
+				/** @name Options for icpPointToPlane and icpGeneralized
+				    @{ */
+				/** The number of nearest neighbours (searched in the KD-tree of each map) used to estimate the normal or the covariance of the local surface around each point (default=8) */
+				uint32_t        normals_knn;
+				/** The variance, along the surface normal, of the regularized covariances of GICP, relative to the unit variance along the surface (default=1e-3) */
+				float           GICP_epsilon;
+				/** @} */
+
+				/** @name Multi-resolution (coarse-to-fine) ICP
+				    @{ */
+				/** The number of resolution levels (default=1, disabled). With N>1 levels, ICP first aligns the maps downsampled with a voxel grid
+				  *  of side multiresolution_voxel_size*2^(N-2), then with half that size, and so on down to multiresolution_voxel_size, and finally the original maps,
+				  *  each level starting from the result of the previous one. The downsampled maps are cached within each map (see CPointsMap::getVoxelDownsampled()),
+				  *  so a reference map is only downsampled once, as long as it is not modified. Only applies when both maps are points maps.
+				  */
+				uint32_t        multiresolution_levels;
+				float           multiresolution_voxel_size; //!< The voxel size (in meters) of the finest downsampled level (default=0.10)
+				/** @} */
+
 			};
 
 			TConfigParams  options; //!< The options employed by the ICP align.
@@ -180,6 +201,8 @@ namespace mrpt
 
 				/** A measure of the 'quality' of the local minimum of the sqr. error found by the method.
 				  * Higher values are better. Low values will be found in ill-conditioned situations (e.g. a corridor).
+				  * For icpPointToPlane and icpGeneralized (unless options.skip_quality_calculation is set) it is the ratio between the smallest
+				  *  and the largest eigenvalues of the translational part of the Gauss-Newton Hessian, in the range [0,1].
 				  */
 				float			quality;
 			};
@@ -243,6 +266,11 @@ namespace mrpt
 			  */
 			float kernel(const float &x2, const float &rho2);
 
+			/** Returns the options to use at each level of a multi-resolution ICP, from the coarsest to the original resolution (see TConfigParams::multiresolution_levels)
+			  * \param[out] voxel_sizes The voxel size of each level, or 0 for the original maps.
+			  */
+			void getMultiresolutionLevels( std::vector<TConfigParams> &level_options, std::vector<float> &voxel_sizes ) const;
+
 			/** The internal method implementing CICP::AlignPDF when options.ICP_algorithm is icpClassic.
 			  */
 			CPosePDFPtr ICP_Method_Classic(
@@ -267,6 +295,16 @@ namespace mrpt
 					const CPosePDFGaussian	&initialEstimationPDF,
 					TReturnInfo				&outInfo );
 
+			/** The internal method implementing CICP::AlignPDF when options.ICP_algorithm is icpPointToPlane or icpGeneralized.
+			  *  Each set of correspondences is used for several Gauss-Newton steps, so it needs far fewer correspondence searches than icpClassic.
+			  *  The covariance of the output is the inverse of the Gauss-Newton Hessian, scaled by options.covariance_varPoints.
+			  */
+			CPosePDFPtr ICP_Method_PointToPlane(
+					const CMetricMap		*m1,
+					const CMetricMap		*m2,
+					const CPosePDFGaussian	&initialEstimationPDF,
+					TReturnInfo				&outInfo );
+
 			/** The internal method implementing CICP::Align3DPDF when options.ICP_algorithm is icpClassic.
 			  */
 			CPose3DPDFPtr ICP3D_Method_Classic(
@@ -275,6 +313,15 @@ namespace mrpt
 					const CPose3DPDFGaussian &initialEstimationPDF,
 					TReturnInfo				&outInfo );
 
+			/** The internal method implementing CICP::Align3DPDF when options.ICP_algorithm is icpPointToPlane or icpGeneralized.
+			  * \sa ICP_Method_PointToPlane
+			  */
+			CPose3DPDFPtr ICP3D_Method_PointToPlane(
+					const CMetricMap		*m1,
+					const CMetricMap		*m2,
+					const CPose3DPDFGaussian &initialEstimationPDF,
+					TReturnInfo				&outInfo );
+
 
 		};
 
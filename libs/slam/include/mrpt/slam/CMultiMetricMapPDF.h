@@ -241,8 +241,8 @@ namespace slam
 			/** \name Virtual methods that the PF_implementations assume exist.
 			    @{ */
 
-			/** Return a pointer to the last robot pose in the i'th particle (or NULL if it's a path and it's empty). */
-			const TPose3D * getLastPose(const size_t i) const;
+			/** Return the last robot pose in the i'th particle (it is returned by value, so it can be called from several threads at once). */
+			TPose3D getLastPose(const size_t i) const;
 
 			void PF_SLAM_implementation_custom_update_particle_with_new_pose(
 				CParticleDataContent *particleData,
@@ -20,6 +20,7 @@
 #include <mrpt/slam/TKLDParams.h>
 
 #include <mrpt/math/distributions.h>  // chi2inv
+#include <mrpt/system/parallelization.h>
 
 #include <mrpt/slam/PF_implementations_data.h>
 
@@ -41,6 +42,34 @@ namespace mrpt
 		using namespace mrpt::bayes;
 		using namespace mrpt::math;
 
+		namespace detail
+		{
+			/** Body for mrpt::system::parallel_for(): updates the weights of a range of particles with their observation likelihood.
+			  *  Used internally in PF_implementation::PF_SLAM_implementation_pfStandardProposal() */
+			template <class PARTICLE_TYPE,class MYSELF>
+			struct TPFObservationLikelihoodUpdater
+			{
+				MYSELF *me;
+				const CParticleFilter::TParticleFilterOptions &PF_options;
+				const CSensoryFrame &sf;
+
+				TPFObservationLikelihoodUpdater(MYSELF *me_, const CParticleFilter::TParticleFilterOptions &PF_options_, const CSensoryFrame &sf_) :
+					me(me_), PF_options(PF_options_), sf(sf_)
+				{ }
+
+				void operator()(const mrpt::system::BlockedRange &r) const
+				{
+					const PF_implementation<PARTICLE_TYPE,MYSELF> *pf = me;
+					for (int i=r.begin();i<r.end();i++)
+					{
+						const CPose3D partPose( pf->getLastPose(i) ); // Take the particle data:
+						const double obs_log_likelihood = pf->PF_SLAM_computeObservationLikelihoodForParticle(PF_options,i,sf,partPose);
+						me->m_particles[i].log_w += obs_log_likelihood * PF_options.powFactor;
+					}
+				}
+			};
+		}
+
 		/** Auxiliary method called by PF implementations: return true if we have both action & observation,
 		  *   otherwise, return false AND accumulate the odometry so when we have an observation we didn't lose a thing.
 		  *   On return=true, the "m_movementDrawer" member is loaded and ready to draw samples of the increment of pose since last step.
@@ -204,7 +233,7 @@ namespace mrpt
 					{
 						// Generate gaussian-distributed 2D-pose increments according to mean-cov:
 						m_movementDrawer.drawSample( incrPose );
-						CPose3D finalPose = CPose3D(*getLastPose(i)) + incrPose;
+						CPose3D finalPose = CPose3D(getLastPose(i)) + incrPose;
 
 						// Update the particle with the new pose: this part is caller-dependant and must be implemented there:
 						PF_SLAM_implementation_custom_update_particle_with_new_pose( me->m_particles[i].d, TPose3D(finalPose) );
@@ -242,7 +271,7 @@ namespace mrpt
 
 						// generate the new particle:
 						const size_t drawn_idx = me->fastDrawSample(PF_options);
-						const CPose3D newPose = CPose3D(*getLastPose(drawn_idx)) + increment_i;
+						const CPose3D newPose = CPose3D(getLastPose(drawn_idx)) + increment_i;
 						const TPose3D newPose_s = newPose;
 
 						// Add to the new particles list:
@@ -292,13 +321,14 @@ namespace mrpt
 				//	UPDATE STAGE
 				// ----------------------------------------------------------------------
 				// Compute all the likelihood values & update particles weight:
-				for (size_t i=0;i<M;i++)
+				detail::TPFObservationLikelihoodUpdater<PARTICLE_TYPE,MYSELF> updater(me,PF_options,*sf);
+				if (PF_options.parallelizeLikelihoods && M>1)
 				{
-					const TPose3D  *partPose= getLastPose(i); // Take the particle data:
-					CPose3D  partPose2 = CPose3D(*partPose);
-					const double obs_log_likelihood = PF_SLAM_computeObservationLikelihoodForParticle(PF_options,i,*sf,partPose2);
-					me->m_particles[i].log_w += obs_log_likelihood * PF_options.powFactor;
-				} // for each particle "i"
+					// The first one alone, so the maps build their caches (if any) only once:
+					updater( mrpt::system::BlockedRange(0,1) );
+					mrpt::system::parallel_for( mrpt::system::BlockedRange(1,M), updater );
+				}
+				else updater( mrpt::system::BlockedRange(0,M) );
 
 				// Normalization of weights is done outside of this method automatically.
 			}
@@ -354,12 +384,17 @@ namespace mrpt
 			size_t  N = PF_options.pfAuxFilterOptimal_MaximumSearchSamples;
 			ASSERT_(N>1)
 
-			const CPose3D oldPose = *me->getLastPose(index);
+			const CPose3D oldPose = me->getLastPose(index);
 			vector_double   vectLiks(N,0);		// The vector with the individual log-likelihoods.
 			CPose3D			drawnSample;
+
+			// In parallel mode, each particle draws its samples from its own stream of a counter-based generator:
+			CRandomGenerator  particleRng( static_cast<uint64_t>(me->m_pfAuxiliaryPF_randomSeed), static_cast<uint64_t>(index) );
+			CRandomGenerator  &rng = PF_options.parallelizeLikelihoods ? particleRng : randomGenerator;
+
 			for (size_t q=0;q<N;q++)
 			{
-				me->m_movementDrawer.drawSample(drawnSample);
+				me->m_movementDrawer.drawSample(drawnSample,rng);
 				CPose3D	x_predict = oldPose + drawnSample;
 
 				// Estimate the mean...
@@ -420,7 +455,7 @@ namespace mrpt
 
 			// Take the previous particle weight:
 			const double cur_logweight = myObj->m_particles[index].log_w;
-			const CPose3D oldPose = *myObj->getLastPose(index);
+			const CPose3D oldPose = myObj->getLastPose(index);
 
 			if (!PF_options.pfAuxFilterStandard_FirstStageWeightsMonteCarlo)
 			{
@@ -452,9 +487,14 @@ namespace mrpt
 
 				vector_double   vectLiks(N,0);		// The vector with the individual log-likelihoods.
 				CPose3D		drawnSample;
+
+				// In parallel mode, each particle draws its samples from its own stream of a counter-based generator:
+				CRandomGenerator  particleRng( static_cast<uint64_t>(myObj->m_pfAuxiliaryPF_randomSeed), static_cast<uint64_t>(index) );
+				CRandomGenerator  &rng = PF_options.parallelizeLikelihoods ? particleRng : randomGenerator;
+
 				for (size_t q=0;q<N;q++)
 				{
-					myObj->m_movementDrawer.drawSample(drawnSample);
+					myObj->m_movementDrawer.drawSample(drawnSample,rng);
 					CPose3D	x_predict = oldPose + drawnSample;
 
 					// Estimate the mean...
@@ -541,6 +581,10 @@ namespace mrpt
 			CPose3D meanRobotMovement;
 			m_movementDrawer.getSamplingMean3D(meanRobotMovement);
 
+			// The seed of the per-particle random generators (only used in parallel mode, see PF_SLAM_particlesEvaluator_AuxPFOptimal):
+			if (PF_options.parallelizeLikelihoods)
+				m_pfAuxiliaryPF_randomSeed = randomGenerator.drawUniform32bit();
+
 			// Prepare data for executing "fastDrawSample"
 			typedef PF_implementation<PARTICLE_TYPE,MYSELF> TMyClass; // Use this longer declaration to avoid errors in old GCC.
 			CParticleFilterCapable::TParticleProbabilityEvaluator funcOpt = &TMyClass::template PF_SLAM_particlesEvaluator_AuxPFOptimal<BINTYPE>;
@@ -860,7 +904,7 @@ namespace mrpt
 				if (PF_options.verbose) cout << "[PF_implementation] Warning: Discarding very unlikely particle" << endl;
 			}
 
-			const CPose3D oldPose = *getLastPose(k);	// Get the current pose of the k'th particle
+			const CPose3D oldPose = getLastPose(k);	// Get the current pose of the k'th particle
 
 			//   (b) Rejection-sampling: Draw a new robot pose from x[k],
 			//       and accept it with probability p(zk|x) / maxLikelihood:
@@ -48,7 +48,8 @@ namespace mrpt
 		public:
 			PF_implementation() :
 				m_accumRobotMovement2DIsValid(false),
-				m_accumRobotMovement3DIsValid(false)
+				m_accumRobotMovement3DIsValid(false),
+				m_pfAuxiliaryPF_randomSeed(0)
 			{
 			}
 
@@ -74,6 +75,7 @@ namespace mrpt
 			mutable vector_double			m_pfAuxiliaryPFOptimal_maxLikelihood;						//!< Auxiliary variable used in the "pfAuxiliaryPFOptimal" algorithm.
 			mutable std::vector<TPose3D>	m_pfAuxiliaryPFOptimal_maxLikDrawnMovement;		//!< Auxiliary variable used in the "pfAuxiliaryPFOptimal" algorithm.
 			std::vector<bool>				m_pfAuxiliaryPFOptimal_maxLikMovementDrawHasBeenUsed;
+			uint32_t						m_pfAuxiliaryPF_randomSeed;	//!< Auxiliary variable used in the "pfAuxiliaryPF*" algorithms: base seed of the per-particle random generators, only used if TParticleFilterOptions::parallelizeLikelihoods is set.
 
 			/**  Compute w[i]p(z_t | mu_t^i), with mu_t^i being
 			  *    the mean of the new robot pose
@@ -159,8 +161,8 @@ namespace mrpt
 			/** \name Virtual methods that the PF_implementations assume exist.
 			    @{ */
 
-			/** Return a pointer to the last robot pose in the i'th particle (or NULL if it's a path and it's empty). */
-			virtual const TPose3D * getLastPose(const size_t i) const = 0;
+			/** Return the last robot pose in the i'th particle (it is returned by value, so it can be called from several threads at once). */
+			virtual TPose3D getLastPose(const size_t i) const = 0;
 
 			virtual void PF_SLAM_implementation_custom_update_particle_with_new_pose(
 				PARTICLE_TYPE *particleData,
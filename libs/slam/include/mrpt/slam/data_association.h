@@ -59,7 +59,8 @@ namespace mrpt
 				indiv_distances(0,0),
 				indiv_compatibility(0,0),
 				indiv_compatibility_counts(),
-				nNodesExploredInJCBB(0)
+				nNodesExploredInJCBB(0),
+				JCBB_timeout(false)
 			{}
 
 			void clear()
@@ -70,6 +71,7 @@ namespace mrpt
 				indiv_compatibility.setSize(0,0);
 				indiv_compatibility_counts.clear();
 				nNodesExploredInJCBB = 0;
+				JCBB_timeout = false;
 			}
 
 			/** For each observation (with row index IDX_obs in the input "Z_observations"), its association in the predictions, as the row index in the "Y_predictions_mean" input (or it's mapping to a custom ID, if it was provided).
@@ -89,6 +91,7 @@ namespace mrpt
 			vector_uint					indiv_compatibility_counts; //!< The sum of each column of indiv_compatibility, that is, the number of compatible pairings for each observation.
 
 			size_t		nNodesExploredInJCBB; //!< Only for the JCBB method,the number of recursive calls expent in the algorithm.
+			bool		JCBB_timeout; //!< Only for the JCBB method: true if the search was stopped by the time budget, so "associations" is the best hypothesis found until then.
 		};
 
 
@@ -108,6 +111,11 @@ namespace mrpt
 		  * \param chi2quantile [IN, optional] The threshold for considering a match between two close Gaussians for two landmarks, in the range [0,1]. It is used to call mrpt::math::chi2inv
 		  * \param use_kd_tree [IN, optional] Build a KD-tree to speed-up the evaluation of individual compatibility (IC). It's perhaps more efficient to disable it for a small number of features. (default=true).
 		  * \param predictions_IDs [IN, optional] (default:none) An N-vector. If provided, the resulting associations in "results.associations" will not contain prediction indices "i", but "predictions_IDs[i]".
+		  * \param JCBB_max_time [IN, optional] (default:0=no limit) A time budget for the JCBB search, in seconds. If exceeded, the best hypothesis found so far is returned and results.JCBB_timeout is set.
+		  *
+		  * The JCBB search runs the subtrees of its first levels in parallel (see mrpt::system::parallel_for). Among the hypotheses with the
+		  *  largest number of pairings it returns the one with the best joint distance, with the same result for any number of threads.
+		  *  The joint distance is only evaluated for those candidate hypotheses, extending the Cholesky factor of the covariance of the previous one.
 		  *
 		  * \sa data_association_independent_predictions, data_association_independent_2d_points, data_association_independent_3d_points
 		  */
@@ -122,7 +130,8 @@ namespace mrpt
 			const bool							DAT_ASOC_USE_KDTREE = true,
 			const std::vector<prediction_index_t>		&predictions_IDs = std::vector<prediction_index_t>(),
 			const TDataAssociationMetric		compatibilityTestMetric  = metricMaha,
-			const double						log_ML_compat_test_threshold = 0.0
+			const double						log_ML_compat_test_threshold = 0.0,
+			const double						JCBB_max_time = 0
 			);
 
 		/** Computes the data-association between the prediction of a set of landmarks and their observations, all of them with covariance matrices - Generic version with NO prediction cross-covariances.
@@ -141,6 +150,7 @@ namespace mrpt
 		  * \param chi2quantile [IN, optional] The threshold for considering a match between two close Gaussians for two landmarks, in the range [0,1]. It is used to call mrpt::math::chi2inv
 		  * \param use_kd_tree [IN, optional] Build a KD-tree to speed-up the evaluation of individual compatibility (IC). It's perhaps more efficient to disable it for a small number of features. (default=true).
 		  * \param predictions_IDs [IN, optional] (default:none) An N-vector. If provided, the resulting associations in "results.associations" will not contain prediction indices "i", but "predictions_IDs[i]".
+		  * \param JCBB_max_time [IN, optional] (default:0=no limit) A time budget for the JCBB search, in seconds (see data_association_full_covariance).
 		  *
 		  * \sa data_association_full_covariance, data_association_independent_2d_points, data_association_independent_3d_points
 		  */
@@ -155,7 +165,8 @@ namespace mrpt
 			const bool							DAT_ASOC_USE_KDTREE = true,
 			const std::vector<prediction_index_t>	&predictions_IDs = std::vector<prediction_index_t>(),
 			const TDataAssociationMetric		compatibilityTestMetric = metricMaha,
-			const double						log_ML_compat_test_threshold = 0.0
+			const double						log_ML_compat_test_threshold = 0.0,
+			const double						JCBB_max_time = 0
 			);
 
 
@@ -10,6 +10,7 @@
 #include <mrpt/slam.h>  // Precompiled header
 
 #include <mrpt/slam/CICP.h>
+#include <mrpt/slam/CSimplePointsMap.h>
 #include <mrpt/scanmatching.h>
 #include <mrpt/poses/CPosePDFSOG.h>
 #include <mrpt/utils/CTicTac.h>
@@ -22,6 +23,142 @@ using namespace mrpt::poses;
 using namespace mrpt::utils;
 using namespace std;
 
+namespace
+{
+	/** Lazily estimates, and caches, the shape of the surface around each point of a points map from its KD-tree neighbourhood:
+	  *  the unit normal of the best fitting line (DIM=2) or plane (DIM=3), and the covariance regularized as in GICP
+	  *  (variance \a eps along the normal and 1 along the surface). Only the points involved in correspondences are ever evaluated.
+	  */
+	template <int DIM>
+	class TLocalSurfaces
+	{
+	public:
+		typedef Eigen::Matrix<double,DIM,1>   vector_t;
+		typedef Eigen::Matrix<double,DIM,DIM> matrix_t;
+
+		TLocalSurfaces(const CPointsMap &m, const size_t knn, const double eps) :
+			m_map(m),
+			m_knn(std::min(knn,m.size())),
+			m_eps(eps),
+			m_state(m.size(),0),
+			m_normals(m.size()),
+			m_covs(m.size())
+		{
+		}
+
+		/** Returns false if the neighbourhood of the point does not define a line/plane */
+		inline bool get(const size_t idx, const vector_t *&normal, const matrix_t *&cov)
+		{
+			if (!m_state[idx]) compute(idx);
+			normal = &m_normals[idx];
+			cov    = &m_covs[idx];
+			return m_state[idx]==1;
+		}
+
+	private:
+		const CPointsMap &m_map;
+		const size_t      m_knn;
+		const double      m_eps;
+		std::vector<char> m_state; //!< 0: not evaluated yet, 1: valid, 2: degenerate neighbourhood
+		typename mrpt::aligned_containers<vector_t>::vector_t m_normals;
+		typename mrpt::aligned_containers<matrix_t>::vector_t m_covs;
+		std::vector<size_t> m_nn_idxs;
+		std::vector<float>  m_nn_dists;
+
+		void compute(const size_t idx)
+		{
+			m_state[idx] = 2;
+			if (m_knn<DIM+1) return;
+
+			float x0,y0,z0;
+			m_map.getPointFast(idx,x0,y0,z0);
+			if (DIM==2)
+					m_map.kdTreeNClosestPoint2DIdx(x0,y0,m_knn,m_nn_idxs,m_nn_dists);
+			else	m_map.kdTreeNClosestPoint3DIdx(x0,y0,z0,m_knn,m_nn_idxs,m_nn_dists);
+
+			// Moments of the neighbours, relative to the query point for numerical accuracy:
+			vector_t mean = vector_t::Zero();
+			matrix_t cov  = matrix_t::Zero();
+			for (size_t i=0;i<m_nn_idxs.size();i++)
+			{
+				float x,y,z;
+				m_map.getPointFast(m_nn_idxs[i],x,y,z);
+				const double d[3] = { x-x0, y-y0, z-z0 };
+				vector_t p;
+				for (int k=0;k<DIM;k++) p[k]=d[k];
+				mean.noalias() += p;
+				cov.noalias()  += p*p.transpose();
+			}
+			const double n = m_nn_idxs.size();
+			mean /= n;
+			cov = cov/n - mean*mean.transpose();
+
+			Eigen::SelfAdjointEigenSolver<matrix_t> es(cov);
+			const vector_t &ev = es.eigenvalues(); // In ascending order
+			if (!(ev[DIM-1]>0)) return;                   // All the neighbours at the same place
+			if (DIM==3 && ev[DIM-2]<1e-2*ev[DIM-1]) return; // A line in 3D: its normal is undefined
+
+			const matrix_t &V = es.eigenvectors();
+			vector_t s = vector_t::Ones();
+			s[0] = m_eps;
+			m_normals[idx] = V.col(0);
+			m_covs[idx]    = V * s.asDiagonal() * V.transpose();
+			m_state[idx]   = 1;
+		}
+	};
+
+	/** The information matrices and weights for a set of correspondences, in icpPointToPlane or icpGeneralized */
+	template <int DIM>
+	struct TPlanarPairs
+	{
+		typedef Eigen::Matrix<double,DIM,1>   vector_t;
+		typedef Eigen::Matrix<double,DIM,DIM> matrix_t;
+
+		typename mrpt::aligned_containers<vector_t>::vector_t local_pts;  //!< The points of the map to align, in its local frame
+		typename mrpt::aligned_containers<vector_t>::vector_t ref_pts;    //!< The corresponding points in the reference map
+		typename mrpt::aligned_containers<vector_t>::vector_t normals;    //!< The normals at ref_pts
+		typename mrpt::aligned_containers<matrix_t>::vector_t infos;      //!< The information matrix of each residual
+
+		/** Keeps the correspondences with a well-defined local surface and computes their information matrices, given the current rotation R */
+		void build(
+			const TMatchingPairList &corrs,
+			TLocalSurfaces<DIM> &surf_ref,
+			TLocalSurfaces<DIM> &surf_other,
+			const bool isGICP,
+			const matrix_t &R )
+		{
+			local_pts.clear(); ref_pts.clear(); normals.clear(); infos.clear();
+			for (TMatchingPairList::const_iterator it=corrs.begin();it!=corrs.end();++it)
+			{
+				const vector_t *n_ref, *n_other;
+				const matrix_t *C_ref, *C_other;
+				if (!surf_ref.get(it->this_idx,n_ref,C_ref)) continue;
+				if (isGICP && !surf_other.get(it->other_idx,n_other,C_other)) continue;
+
+				const double lp[3] = { it->other_x, it->other_y, it->other_z };
+				const double rp[3] = { it->this_x, it->this_y, it->this_z };
+				vector_t l,r;
+				for (int k=0;k<DIM;k++) { l[k]=lp[k]; r[k]=rp[k]; }
+				local_pts.push_back(l);
+				ref_pts.push_back(r);
+				normals.push_back(*n_ref);
+				if (isGICP)
+				{
+					const matrix_t C = *C_ref + R * (*C_other) * R.transpose();
+					infos.push_back( C.inverse() );
+				}
+				else infos.push_back( (*n_ref) * n_ref->transpose() );
+			}
+		}
+
+		/** Robust (Cauchy) weight of a residual, from its distance to the reference line/plane */
+		static inline double weight(const vector_t &res, const vector_t &normal, const bool use_kernel, const double rho2)
+		{
+			return use_kernel ? rho2/(rho2+square(normal.dot(res))) : 1.0;
+		}
+	};
+}
+
 
 
 /*---------------------------------------------------------------
@@ -56,20 +193,48 @@ CPosePDFPtr CICP::AlignPDF(
 
 	if (runningTime)  tictac.Tic();
 
-	switch( options.ICP_algorithm )
+	if (options.multiresolution_levels>1 && IS_DERIVED(m1,CPointsMap) && IS_DERIVED(mm2,CPointsMap))
+	{
+		// Coarse-to-fine: align the voxel-downsampled maps first:
+		std::vector<TConfigParams> level_options;
+		std::vector<float>         voxel_sizes;
+		getMultiresolutionLevels(level_options,voxel_sizes);
+
+		CPosePDFGaussian	levelInitialEstimation = initialEstimationPDF;
+		unsigned int		nIterations = 0;
+		for (size_t l=0;l<level_options.size();l++)
+		{
+			const CMetricMap *level_m1 = voxel_sizes[l]>0 ? static_cast<const CPointsMap*>(m1)->getVoxelDownsampled(voxel_sizes[l]) : m1;
+			const CMetricMap *level_m2 = voxel_sizes[l]>0 ? static_cast<const CPointsMap*>(mm2)->getVoxelDownsampled(voxel_sizes[l]) : mm2;
+
+			CICP	levelICP(level_options[l]);
+			resultPDF = levelICP.AlignPDF( level_m1, level_m2, levelInitialEstimation, NULL, &outInfo );
+			nIterations += outInfo.nIterations;
+			levelInitialEstimation.mean = resultPDF->getMeanVal();
+		}
+		outInfo.nIterations = nIterations;
+	}
+	else
 	{
-	case icpClassic:
-		resultPDF = ICP_Method_Classic( m1, mm2, initialEstimationPDF, outInfo );
-		break;
-	case icpLevenbergMarquardt:
-		resultPDF = ICP_Method_LM( m1, mm2, initialEstimationPDF, outInfo );
-		break;
-	case icpIKF:
-		resultPDF = ICP_Method_IKF( m1, mm2, initialEstimationPDF, outInfo );
-		break;
-	default:
-		THROW_EXCEPTION_CUSTOM_MSG1("Invalid value for ICP_algorithm: %i", static_cast<int>(options.ICP_algorithm));
-	} // end switch
+		switch( options.ICP_algorithm )
+		{
+		case icpClassic:
+			resultPDF = ICP_Method_Classic( m1, mm2, initialEstimationPDF, outInfo );
+			break;
+		case icpLevenbergMarquardt:
+			resultPDF = ICP_Method_LM( m1, mm2, initialEstimationPDF, outInfo );
+			break;
+		case icpIKF:
+			resultPDF = ICP_Method_IKF( m1, mm2, initialEstimationPDF, outInfo );
+			break;
+		case icpPointToPlane:
+		case icpGeneralized:
+			resultPDF = ICP_Method_PointToPlane( m1, mm2, initialEstimationPDF, outInfo );
+			break;
+		default:
+			THROW_EXCEPTION_CUSTOM_MSG1("Invalid value for ICP_algorithm: %i", static_cast<int>(options.ICP_algorithm));
+		} // end switch
+	}
 
 	if (runningTime)  *runningTime = tictac.Tac();
 
@@ -123,7 +288,13 @@ CICP::TConfigParams::TConfigParams() :
 	skip_cov_calculation		(false),
 	skip_quality_calculation	(true),
 
-	corresponding_points_decimation ( 5 )
+	corresponding_points_decimation ( 5 ),
+
+	normals_knn					( 8 ),
+	GICP_epsilon				( 1e-3f ),
+
+	multiresolution_levels		( 1 ),
+	multiresolution_voxel_size	( 0.10f )
 {
 }
 
@@ -169,6 +340,12 @@ void  CICP::TConfigParams::loadFromConfigFile(
 
 	MRPT_LOAD_CONFIG_VAR( corresponding_points_decimation, int, 				iniFile, section);
 
+	MRPT_LOAD_CONFIG_VAR( normals_knn, int, 				iniFile, section);
+	MRPT_LOAD_CONFIG_VAR( GICP_epsilon, float,				iniFile, section);
+
+	MRPT_LOAD_CONFIG_VAR( multiresolution_levels, int, 		iniFile, section);
+	MRPT_LOAD_CONFIG_VAR( multiresolution_voxel_size, float,	iniFile, section);
+
 }
 
 /*---------------------------------------------------------------
@@ -181,7 +358,9 @@ void  CICP::TConfigParams::dumpToTextStream(CStream	&out) const
 	out.printf("ICP_algorithm                           = %s\n",
 		ICP_algorithm==icpClassic ?  "icpClassic" :
 		ICP_algorithm==icpLevenbergMarquardt ? "icpLevenbergMarquardt" :
-		ICP_algorithm==icpIKF ? "icpIKF" : "(INVALID VALUE!)" );
+		ICP_algorithm==icpIKF ? "icpIKF" :
+		ICP_algorithm==icpPointToPlane ? "icpPointToPlane" :
+		ICP_algorithm==icpGeneralized ? "icpGeneralized" : "(INVALID VALUE!)" );
 
 	out.printf("maxIterations                           = %i\n",maxIterations);
 	out.printf("minAbsStep_trans                        = %f\n",minAbsStep_trans);
@@ -210,9 +389,46 @@ void  CICP::TConfigParams::dumpToTextStream(CStream	&out) const
 	out.printf("skip_cov_calculation                    = %c\n",skip_cov_calculation ? 'Y':'N');
 	out.printf("skip_quality_calculation                = %c\n",skip_quality_calculation ? 'Y':'N');
 	out.printf("corresponding_points_decimation         = %u\n",(unsigned int)corresponding_points_decimation);
+	out.printf("normals_knn                             = %u\n",(unsigned int)normals_knn);
+	out.printf("GICP_epsilon                            = %e\n",GICP_epsilon);
+	out.printf("multiresolution_levels                  = %u\n",(unsigned int)multiresolution_levels);
+	out.printf("multiresolution_voxel_size              = %f\n",multiresolution_voxel_size);
 	out.printf("\n");
 }
 
+/*---------------------------------------------------------------
+					getMultiresolutionLevels
+  ---------------------------------------------------------------*/
+void CICP::getMultiresolutionLevels( std::vector<TConfigParams> &level_options, std::vector<float> &voxel_sizes ) const
+{
+	const size_t nLevels = std::max(1u, static_cast<unsigned int>(options.multiresolution_levels));
+
+	level_options.assign(nLevels, options);
+	voxel_sizes.resize(nLevels);
+
+	for (size_t l=0;l<nLevels;l++)
+	{
+		const bool isOriginal = (l==nLevels-1); // The last level is the original maps
+		voxel_sizes[l] = isOriginal ? 0 : options.multiresolution_voxel_size * (1u << (nLevels-2-l));
+
+		TConfigParams &o = level_options[l];
+		o.multiresolution_levels = 1;
+
+		// The error left by the previous level is in the order of its voxel size:
+		if (l>0)
+			o.thresholdDist = std::min(options.thresholdDist, 2*voxel_sizes[l-1]);
+
+		if (!isOriginal)
+		{
+			o.smallestThresholdDist = std::max(options.smallestThresholdDist, voxel_sizes[l]);
+			o.corresponding_points_decimation = 1;  // The voxel grid already decimates the points
+			o.doRANSAC = false;
+			o.skip_cov_calculation = true;
+			o.skip_quality_calculation = true;
+		}
+	}
+}
+
 /*---------------------------------------------------------------
 					kernel
   ---------------------------------------------------------------*/
@@ -889,6 +1105,193 @@ CPosePDFPtr CICP::ICP_Method_IKF(
 	MRPT_END
 }
 
+/*---------------------------------------------------------------
+					ICP_Method_PointToPlane
+  ---------------------------------------------------------------*/
+CPosePDFPtr CICP::ICP_Method_PointToPlane(
+		const CMetricMap		*mm1,
+		const CMetricMap		*mm2,
+		const CPosePDFGaussian	&initialEstimationPDF,
+		TReturnInfo				&outInfo )
+{
+	MRPT_START
+
+	typedef TPlanarPairs<2>::vector_t vector_t;
+	typedef TPlanarPairs<2>::matrix_t matrix_t;
+
+	size_t									nCorrespondences=0;
+	bool									keepApproaching;
+	mrpt::utils::TMatchingPairList			correspondences;
+	CPose2D									lastMeanPose;
+	CPose2D									q = initialEstimationPDF.mean;
+	Eigen::Matrix3d							H = Eigen::Matrix3d::Zero(); // The Gauss-Newton Hessian of the last iteration
+
+	// Assure the class of the maps:
+	ASSERT_(mm1->GetRuntimeClass()->derivedFrom(CLASS_ID(CPointsMap)));
+	ASSERT_(mm2->GetRuntimeClass()->derivedFrom(CLASS_ID(CPointsMap)));
+	const CPointsMap	*m1 = static_cast<const CPointsMap*>(mm1);
+	const CPointsMap	*m2 = static_cast<const CPointsMap*>(mm2);
+
+	// Asserts:
+	// -----------------
+	ASSERT_( options.ALFA>0 && options.ALFA<1 );
+
+	// The algorithm output auxiliar info:
+	// -------------------------------------------------
+	outInfo.cbSize			= sizeof(TReturnInfo);
+	outInfo.nIterations		= 0;
+	outInfo.goodness		= 1;
+	outInfo.quality			= 0;
+
+	TMatchingParams matchParams;
+	TMatchingExtraResults matchExtraResults;
+
+	matchParams.maxDistForCorrespondence = options.thresholdDist;			// Distance threshold
+	matchParams.maxAngularDistForCorrespondence = options.thresholdAng;	// Angular threshold
+	matchParams.onlyKeepTheClosest = options.onlyClosestCorrespondences;
+	matchParams.onlyUniqueRobust = options.onlyUniqueRobust;
+	matchParams.decimation_other_map_points = options.corresponding_points_decimation;
+
+	const bool   isGICP = options.ICP_algorithm==icpGeneralized;
+	const double rho2   = square( options.kernel_rho );
+	const size_t maxGaussNewtonIters = 5; // Per set of correspondences
+
+	TLocalSurfaces<2>	surf_ref(*m1, options.normals_knn, options.GICP_epsilon);
+	TLocalSurfaces<2>	surf_other(*m2, options.normals_knn, options.GICP_epsilon);
+	TPlanarPairs<2>		pairs;
+
+	// Asure maps are not empty!
+	// ------------------------------------------------------
+	if ( !m2->isEmpty() )
+	{
+		matchParams.offset_other_map_points = 0;
+
+		// ------------------------------------------------------
+		//					The ICP loop
+		// ------------------------------------------------------
+		do
+		{
+			// ------------------------------------------------------
+			//		Find the matching (for a points map)
+			// ------------------------------------------------------
+			matchParams.angularDistPivotPoint = TPoint3D(q.x(),q.y(),0); // Pivot point for angular measurements
+
+			m1->determineMatching2D(
+				m2,						// The other map
+				q,						// The other map pose
+				correspondences,
+				matchParams, matchExtraResults);
+
+			nCorrespondences = correspondences.size();
+
+			if ( !nCorrespondences )
+			{
+				// Nothing we can do !!
+				keepApproaching = false;
+			}
+			else
+			{
+				matrix_t R;
+				R << cos(q.phi()), -sin(q.phi()),
+				     sin(q.phi()),  cos(q.phi());
+				pairs.build(correspondences, surf_ref, surf_other, isGICP, R);
+
+				// Minimize sum_i w_i * r_i^T * W_i * r_i, with r_i = q (+) p_i - ref_i,
+				//  by Gauss-Newton over (x,y,phi) with these correspondences:
+				// -----------------------------------------------------------------------
+				for (size_t gn=0;gn<maxGaussNewtonIters;gn++)
+				{
+					const double ccos = cos(q.phi()), csin = sin(q.phi());
+					Eigen::Vector3d g = Eigen::Vector3d::Zero();
+					H.setZero();
+
+					for (size_t i=0;i<pairs.local_pts.size();i++)
+					{
+						const vector_t &p = pairs.local_pts[i];
+						const vector_t  p_rot( ccos*p[0]-csin*p[1], csin*p[0]+ccos*p[1] );
+						const vector_t  res( q.x()+p_rot[0]-pairs.ref_pts[i][0], q.y()+p_rot[1]-pairs.ref_pts[i][1] );
+
+						Eigen::Matrix<double,2,3> J;
+						J << 1, 0, -p_rot[1],
+						     0, 1,  p_rot[0];
+
+						const Eigen::Matrix<double,3,2> JtW = TPlanarPairs<2>::weight(res,pairs.normals[i],options.use_kernel,rho2) * J.transpose() * pairs.infos[i];
+						H.noalias() += JtW * J;
+						g.noalias() += JtW * res;
+					}
+
+					const Eigen::LDLT<Eigen::Matrix3d> ldlt(H);
+					if (ldlt.info()!=Eigen::Success || !(ldlt.vectorD().minCoeff()>1e-9*ldlt.vectorD().maxCoeff()))
+						break; // Not enough constraints (e.g. all points on one single line)
+
+					const Eigen::Vector3d delta = -ldlt.solve(g);
+					q.x( q.x() + delta[0] );
+					q.y( q.y() + delta[1] );
+					q.phi( math::wrapToPi( q.phi() + delta[2] ) );
+
+					if (fabs(delta[0])<options.minAbsStep_trans && fabs(delta[1])<options.minAbsStep_trans && fabs(delta[2])<options.minAbsStep_rot)
+						break;
+				}
+
+				// If matching has not changed, decrease the thresholds:
+				// --------------------------------------------------------
+				keepApproaching = true;
+				if	(!(fabs(lastMeanPose.x()-q.x())>options.minAbsStep_trans ||
+					fabs(lastMeanPose.y()-q.y())>options.minAbsStep_trans ||
+					fabs(math::wrapToPi(lastMeanPose.phi()-q.phi()))>options.minAbsStep_rot))
+				{
+					matchParams.maxDistForCorrespondence		*= options.ALFA;
+					matchParams.maxAngularDistForCorrespondence		*= options.ALFA;
+					if (matchParams.maxDistForCorrespondence < options.smallestThresholdDist )
+						keepApproaching = false;
+
+					if (++matchParams.offset_other_map_points>=options.corresponding_points_decimation)
+						matchParams.offset_other_map_points=0;
+				}
+
+				lastMeanPose = q;
+
+			}	// end of "else, there are correspondences"
+
+			// Next iteration:
+			outInfo.nIterations++;
+
+			if (outInfo.nIterations >= options.maxIterations && matchParams.maxDistForCorrespondence>options.smallestThresholdDist)
+			{
+				matchParams.maxDistForCorrespondence		*= options.ALFA;
+			}
+
+		} while	( (keepApproaching && outInfo.nIterations<options.maxIterations) ||
+					(outInfo.nIterations >= options.maxIterations && matchParams.maxDistForCorrespondence>options.smallestThresholdDist) );
+
+		outInfo.goodness = matchExtraResults.correspondencesRatio;
+
+		if (options.skip_quality_calculation)
+		{
+			outInfo.quality = matchExtraResults.correspondencesRatio;
+		}
+		else
+		{
+			// Conditioning of the translation: low in corridors, where the point-to-line metric does not constrain the motion along the walls.
+			const Eigen::Vector2d ev = Eigen::SelfAdjointEigenSolver<Eigen::Matrix2d>( H.block<2,2>(0,0) ).eigenvalues();
+			outInfo.quality = ev[1]>0 ? ev[0]/ev[1] : 0;
+		}
+
+	} // end of "if m2 is not empty"
+
+	// The covariance, from the inverse of the Hessian:
+	CMatrixDouble33 cov;
+	if (!options.skip_cov_calculation && nCorrespondences)
+	{
+		for (int i=0;i<3;i++) H(i,i) += 1e-6;  // Just to make sure the matrix is not singular, while not changing its covariance significantly.
+		cov = static_cast<double>(options.covariance_varPoints) * H.inverse();
+	}
+
+	return CPosePDFGaussianPtr( new CPosePDFGaussian(q, cov) );
+
+	MRPT_END
+}
+
 
 /*---------------------------------------------------------------
 The method for aligning a pair of 2D points map.
@@ -922,20 +1325,48 @@ CPose3DPDFPtr CICP::Align3DPDF(
 
 	if (runningTime)  tictac.Tic();
 
-	switch( options.ICP_algorithm )
+	if (options.multiresolution_levels>1 && IS_DERIVED(m1,CPointsMap) && IS_DERIVED(mm2,CPointsMap))
 	{
-	case icpClassic:
-		resultPDF = ICP3D_Method_Classic( m1, mm2, initialEstimationPDF, outInfo );
-		break;
-	case icpLevenbergMarquardt:
-		THROW_EXCEPTION("Only icpClassic is implemented for ICP-3D")
-		break;
-	case icpIKF:
-		THROW_EXCEPTION("Only icpClassic is implemented for ICP-3D")
-		break;
-	default:
-		THROW_EXCEPTION_CUSTOM_MSG1("Invalid value for ICP_algorithm: %i", static_cast<int>(options.ICP_algorithm));
-	} // end switch
+		// Coarse-to-fine: align the voxel-downsampled maps first:
+		std::vector<TConfigParams> level_options;
+		std::vector<float>         voxel_sizes;
+		getMultiresolutionLevels(level_options,voxel_sizes);
+
+		CPose3DPDFGaussian	levelInitialEstimation = initialEstimationPDF;
+		unsigned int		nIterations = 0;
+		for (size_t l=0;l<level_options.size();l++)
+		{
+			const CMetricMap *level_m1 = voxel_sizes[l]>0 ? static_cast<const CPointsMap*>(m1)->getVoxelDownsampled(voxel_sizes[l]) : m1;
+			const CMetricMap *level_m2 = voxel_sizes[l]>0 ? static_cast<const CPointsMap*>(mm2)->getVoxelDownsampled(voxel_sizes[l]) : mm2;
+
+			CICP	levelICP(level_options[l]);
+			resultPDF = levelICP.Align3DPDF( level_m1, level_m2, levelInitialEstimation, NULL, &outInfo );
+			nIterations += outInfo.nIterations;
+			levelInitialEstimation.mean = resultPDF->getMeanVal();
+		}
+		outInfo.nIterations = nIterations;
+	}
+	else
+	{
+		switch( options.ICP_algorithm )
+		{
+		case icpClassic:
+			resultPDF = ICP3D_Method_Classic( m1, mm2, initialEstimationPDF, outInfo );
+			break;
+		case icpLevenbergMarquardt:
+			THROW_EXCEPTION("Only icpClassic, icpPointToPlane and icpGeneralized are implemented for ICP-3D")
+			break;
+		case icpIKF:
+			THROW_EXCEPTION("Only icpClassic, icpPointToPlane and icpGeneralized are implemented for ICP-3D")
+			break;
+		case icpPointToPlane:
+		case icpGeneralized:
+			resultPDF = ICP3D_Method_PointToPlane( m1, mm2, initialEstimationPDF, outInfo );
+			break;
+		default:
+			THROW_EXCEPTION_CUSTOM_MSG1("Invalid value for ICP_algorithm: %i", static_cast<int>(options.ICP_algorithm));
+		} // end switch
+	}
 
 	if (runningTime)  *runningTime = tictac.Tac();
 
@@ -1100,3 +1531,214 @@ CPose3DPDFPtr CICP::ICP3D_Method_Classic(
 
 
 
+
+
+/*---------------------------------------------------------------
+					ICP3D_Method_PointToPlane
+  ---------------------------------------------------------------*/
+CPose3DPDFPtr CICP::ICP3D_Method_PointToPlane(
+		const CMetricMap		*mm1,
+		const CMetricMap		*mm2,
+		const CPose3DPDFGaussian &initialEstimationPDF,
+		TReturnInfo				&outInfo )
+{
+	MRPT_START
+
+	typedef TPlanarPairs<3>::vector_t vector_t;
+	typedef TPlanarPairs<3>::matrix_t matrix_t;
+	typedef Eigen::Matrix<double,6,6> matrix66_t;
+
+	size_t									nCorrespondences=0;
+	bool									keepApproaching;
+	mrpt::utils::TMatchingPairList			correspondences;
+	CPose3D									lastMeanPose;
+	CPose3D									q = initialEstimationPDF.mean;
+	matrix66_t								H = matrix66_t::Zero(); // The Gauss-Newton Hessian of the last iteration
+
+	// Assure the class of the maps:
+	ASSERT_(mm1->GetRuntimeClass()->derivedFrom(CLASS_ID(CPointsMap)));
+	ASSERT_(mm2->GetRuntimeClass()->derivedFrom(CLASS_ID(CPointsMap)));
+	const CPointsMap	*m1 = static_cast<const CPointsMap*>(mm1);
+	const CPointsMap	*m2 = static_cast<const CPointsMap*>(mm2);
+
+	// Asserts:
+	// -----------------
+	ASSERT_( options.ALFA>0 && options.ALFA<1 );
+
+	// The algorithm output auxiliar info:
+	// -------------------------------------------------
+	outInfo.cbSize			= sizeof(TReturnInfo);
+	outInfo.nIterations		= 0;
+	outInfo.goodness		= 1;
+	outInfo.quality			= 0;
+
+	TMatchingParams matchParams;
+	TMatchingExtraResults matchExtraResults;
+
+	matchParams.maxDistForCorrespondence = options.thresholdDist;			// Distance threshold
+	matchParams.maxAngularDistForCorrespondence = options.thresholdAng;	// Angular threshold
+	matchParams.onlyKeepTheClosest = options.onlyClosestCorrespondences;
+	matchParams.onlyUniqueRobust = options.onlyUniqueRobust;
+	matchParams.decimation_other_map_points = options.corresponding_points_decimation;
+
+	const bool   isGICP = options.ICP_algorithm==icpGeneralized;
+	const double rho2   = square( options.kernel_rho );
+	const size_t maxGaussNewtonIters = 5; // Per set of correspondences
+
+	TLocalSurfaces<3>	surf_ref(*m1, options.normals_knn, options.GICP_epsilon);
+	TLocalSurfaces<3>	surf_other(*m2, options.normals_knn, options.GICP_epsilon);
+	TPlanarPairs<3>		pairs;
+
+	// Asure maps are not empty!
+	// ------------------------------------------------------
+	if ( !m2->isEmpty() )
+	{
+		matchParams.offset_other_map_points = 0;
+
+		// ------------------------------------------------------
+		//					The ICP loop
+		// ------------------------------------------------------
+		do
+		{
+			matchParams.angularDistPivotPoint = TPoint3D(q.x(),q.y(),q.z());
+
+			// ------------------------------------------------------
+			//		Find the matching (for a points map)
+			// ------------------------------------------------------
+			m1->determineMatching3D(
+				m2,						// The other map
+				q,						// The other map pose
+				correspondences,
+				matchParams, matchExtraResults);
+
+			nCorrespondences = correspondences.size();
+
+			if ( !nCorrespondences )
+			{
+				// Nothing we can do !!
+				keepApproaching = false;
+			}
+			else
+			{
+				pairs.build(correspondences, surf_ref, surf_other, isGICP, q.getRotationMatrix());
+
+				// Minimize sum_i w_i * r_i^T * W_i * r_i, with r_i = q (+) p_i - ref_i,
+				//  by Gauss-Newton with these correspondences. The increments (v,w) are in se(3): q <- exp(v,w) (+) q
+				// ---------------------------------------------------------------------------------------------------------
+				for (size_t gn=0;gn<maxGaussNewtonIters;gn++)
+				{
+					const CMatrixDouble33 R = q.getRotationMatrix();
+					const vector_t t( q.x(), q.y(), q.z() );
+					Eigen::Matrix<double,6,1> g = Eigen::Matrix<double,6,1>::Zero();
+					H.setZero();
+
+					for (size_t i=0;i<pairs.local_pts.size();i++)
+					{
+						const vector_t p   = R*pairs.local_pts[i] + t;
+						const vector_t res = p - pairs.ref_pts[i];
+
+						// d(res)/d(v,w) = [ I | -[p]_x ]
+						Eigen::Matrix<double,3,6> J;
+						J << 1, 0, 0,     0,  p[2], -p[1],
+						     0, 1, 0, -p[2],     0,  p[0],
+						     0, 0, 1,  p[1], -p[0],     0;
+
+						const Eigen::Matrix<double,6,3> JtW = TPlanarPairs<3>::weight(res,pairs.normals[i],options.use_kernel,rho2) * J.transpose() * pairs.infos[i];
+						H.noalias() += JtW * J;
+						g.noalias() += JtW * res;
+					}
+
+					const Eigen::LDLT<matrix66_t> ldlt(H);
+					if (ldlt.info()!=Eigen::Success || !(ldlt.vectorD().minCoeff()>1e-9*ldlt.vectorD().maxCoeff()))
+						break; // Not enough constraints (e.g. all points on one single plane)
+
+					const Eigen::Matrix<double,6,1> delta = -ldlt.solve(g);
+					CArrayDouble<6> mu;
+					for (int k=0;k<6;k++) mu[k]=delta[k];
+					q = CPose3D::exp(mu,true) + q;
+
+					if (delta.head<3>().cwiseAbs().maxCoeff()<options.minAbsStep_trans && delta.tail<3>().cwiseAbs().maxCoeff()<options.minAbsStep_rot)
+						break;
+				}
+
+				// If matching has not changed, decrease the thresholds:
+				// --------------------------------------------------------
+				keepApproaching = true;
+				if	(!(fabs(lastMeanPose.x()-q.x())>options.minAbsStep_trans ||
+					fabs(lastMeanPose.y()-q.y())>options.minAbsStep_trans ||
+					fabs(lastMeanPose.z()-q.z())>options.minAbsStep_trans ||
+					fabs(math::wrapToPi(lastMeanPose.yaw()-q.yaw()))>options.minAbsStep_rot ||
+					fabs(math::wrapToPi(lastMeanPose.pitch()-q.pitch()))>options.minAbsStep_rot ||
+					fabs(math::wrapToPi(lastMeanPose.roll()-q.roll()))>options.minAbsStep_rot ))
+				{
+					matchParams.maxDistForCorrespondence		*= options.ALFA;
+					matchParams.maxAngularDistForCorrespondence		*= options.ALFA;
+					if (matchParams.maxDistForCorrespondence < options.smallestThresholdDist )
+						keepApproaching = false;
+
+					if (++matchParams.offset_other_map_points>=options.corresponding_points_decimation)
+						matchParams.offset_other_map_points=0;
+				}
+
+				lastMeanPose = q;
+
+			}	// end of "else, there are correspondences"
+
+			// Next iteration:
+			outInfo.nIterations++;
+
+			if (outInfo.nIterations >= options.maxIterations && matchParams.maxDistForCorrespondence>options.smallestThresholdDist)
+			{
+				matchParams.maxDistForCorrespondence		*= options.ALFA;
+			}
+
+		} while	( (keepApproaching && outInfo.nIterations<options.maxIterations) ||
+					(outInfo.nIterations >= options.maxIterations && matchParams.maxDistForCorrespondence>options.smallestThresholdDist) );
+
+		outInfo.goodness = matchExtraResults.correspondencesRatio;
+
+		if (options.skip_quality_calculation)
+		{
+			outInfo.quality = matchExtraResults.correspondencesRatio;
+		}
+		else
+		{
+			const Eigen::Vector3d ev = Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d>( H.block<3,3>(0,0) ).eigenvalues();
+			outInfo.quality = ev[2]>0 ? ev[0]/ev[2] : 0;
+		}
+
+	} // end of "if m2 is not empty"
+
+	// The covariance, from the inverse of the Hessian in se(3), transformed into (x,y,z,yaw,pitch,roll)
+	//  through the numerical Jacobian of exp(v,w) (+) q:
+	CMatrixDouble66 cov;
+	if (!options.skip_cov_calculation && nCorrespondences)
+	{
+		for (int i=0;i<6;i++) H(i,i) += 1e-6;  // Just to make sure the matrix is not singular, while not changing its covariance significantly.
+		const matrix66_t cov_se3 = static_cast<double>(options.covariance_varPoints) * H.inverse();
+
+		const double h = 1e-6;
+		matrix66_t J;
+		for (int k=0;k<6;k++)
+		{
+			CArrayDouble<6> mu;
+			mu.setZero();
+			mu[k] = h;
+			const CPose3D qp = CPose3D::exp(mu,true) + q;
+			mu[k] = -h;
+			const CPose3D qm = CPose3D::exp(mu,true) + q;
+
+			J(0,k) = (qp.x()-qm.x())/(2*h);
+			J(1,k) = (qp.y()-qm.y())/(2*h);
+			J(2,k) = (qp.z()-qm.z())/(2*h);
+			J(3,k) = math::wrapToPi(qp.yaw()-qm.yaw())/(2*h);
+			J(4,k) = math::wrapToPi(qp.pitch()-qm.pitch())/(2*h);
+			J(5,k) = math::wrapToPi(qp.roll()-qm.roll())/(2*h);
+		}
+		cov = J * cov_se3 * J.transpose();
+	}
+
+	return CPose3DPDFGaussianPtr( new CPose3DPDFGaussian(q, cov) );
+
+	MRPT_END
+}
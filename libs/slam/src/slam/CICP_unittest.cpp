@@ -96,6 +96,49 @@ protected:
 		EXPECT_NEAR( good_pose.distanceTo( pdf->getMeanVal() ),0,  0.02);
 	}
 
+	/** Aligns a synthetic 3D corner (floor and two walls) to a displaced copy of itself */
+	void alignCorner3D( const TICPAlgorithm icp_method, const unsigned int multiresolution_levels = 1 )
+	{
+		CSimplePointsMap M1;
+		for (int i=0;i<40;i++)
+			for (int j=0;j<40;j++)
+			{
+				const float a = 0.05f*i, b = 0.05f*j;
+				M1.insertPoint(a,b,0);
+				M1.insertPoint(0,a,b+0.05f);
+				M1.insertPoint(a+0.05f,0,b+0.05f);
+			}
+
+		const CPose3D  SCAN2_POSE_ERROR(0.05,-0.03,0.04, DEG2RAD(3),DEG2RAD(-2),DEG2RAD(2));
+		CSimplePointsMap M2 = M1;
+		M2.changeCoordinatesReference( SCAN2_POSE_ERROR );
+
+		CICP	icp;
+		CICP::TReturnInfo	icp_info;
+		icp.options.ICP_algorithm = icp_method;
+		icp.options.thresholdDist = 0.40f;
+		icp.options.thresholdAng = 0;
+		icp.options.skip_quality_calculation = false;
+		icp.options.multiresolution_levels = multiresolution_levels;
+		icp.options.multiresolution_voxel_size = 0.10f;
+
+		CPose3DPDFPtr pdf= icp.Align3D( &M2, &M1, CPose3D(), NULL, &icp_info);
+		const CPose3D  mean = pdf->getMeanVal();
+
+		EXPECT_NEAR(0, (mean.getAsVectorVal()-SCAN2_POSE_ERROR.getAsVectorVal()).Abs().maxCoeff(), 1e-3)
+			<< "ICP output: mean= " << mean << endl
+			<< "Real displacement: " << SCAN2_POSE_ERROR  << endl;
+		if (icp_method!=icpClassic)
+		{
+			EXPECT_GT(icp_info.quality, 0.1f);
+
+			CMatrixDouble66 cov;
+			pdf->getCovariance(cov);
+			for (int i=0;i<6;i++)
+				EXPECT_GT(cov(i,i), 0);
+		}
+	}
+
 	static void generateObjects(CSetOfObjectsPtr &world)
 	{
 		CSpherePtr sph=CSphere::Create(0.5);
@@ -134,6 +177,32 @@ TEST_F(ICPTests, AlignScans_icpLevenbergMarquardt)
 	align2scans(icpLevenbergMarquardt);
 }
 
+TEST_F(ICPTests, AlignScans_icpPointToPlane)
+{
+	align2scans(icpPointToPlane);
+}
+
+TEST_F(ICPTests, AlignScans_icpGeneralized)
+{
+	align2scans(icpGeneralized);
+}
+
+TEST_F(ICPTests, AlignCorner3D_icpPointToPlane)
+{
+	alignCorner3D(icpPointToPlane);
+}
+
+TEST_F(ICPTests, AlignCorner3D_icpGeneralized)
+{
+	alignCorner3D(icpGeneralized);
+}
+
+TEST_F(ICPTests, AlignCorner3D_multiresolution)
+{
+	alignCorner3D(icpClassic, 3);
+	alignCorner3D(icpPointToPlane, 3);
+}
+
 TEST_F(ICPTests, RayTracingICP3D)
 {
 	//Increase this values to get more precision. It will also increase run time.
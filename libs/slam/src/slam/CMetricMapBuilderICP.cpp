@@ -429,6 +429,10 @@ void  CMetricMapBuilderICP::initialize(
 	// Create metric maps:
 	metricMap.setListOfMaps( &ICP_options.mapInitializers );
 
+	// The points maps only grow with each new observation: update their KD-trees incrementally instead of rebuilding them before each ICP.
+	for (size_t i=0;i<metricMap.m_pointsMaps.size();i++)
+		metricMap.m_pointsMaps[i]->kdtree_search_params.dynamic_index = true;
+
 	// copy map:
 	SF_Poses_seq = initialMap;
 
@@ -10,6 +10,7 @@
 
 #include <mrpt/base.h>
 #include <mrpt/slam.h>
+#include <mrpt/system/parallelization.h>
 #include <gtest/gtest.h>
 
 using namespace mrpt;
@@ -270,3 +271,86 @@ TEST(MonteCarlo2D, RunSampleDataset)
 	EXPECT_TRUE(final_pf_cov_trace < 0.01 )
 		<< "final_pf_cov_trace = " << final_pf_cov_trace << endl;
 }
+
+// Run one PF step in a synthetic room and return the resulting particles:
+static void runOneSyntheticStep(
+	const CParticleFilter::TParticleFilterAlgorithm algorithm,
+	const bool parallel,
+	const unsigned int nThreads,
+	vector<double> &out_logw,
+	vector<CPose2D> &out_poses )
+{
+	// A 10x10m room:
+	COccupancyGridMap2D  grid(-5,5,-5,5,0.10f);
+	for (int i=0;i<(int)grid.getSizeX();i++)
+	{
+		grid.setCell(i,0,0);  grid.setCell(i,grid.getSizeY()-1,0);
+	}
+	for (int j=0;j<(int)grid.getSizeY();j++)
+	{
+		grid.setCell(0,j,0);  grid.setCell(grid.getSizeX()-1,j,0);
+	}
+	for (int i=10;i<40;i++) grid.setCell(i,60,0);
+	grid.likelihoodOptions.likelihoodMethod = COccupancyGridMap2D::lmLikelihoodField_Thrun;
+
+	CObservation2DRangeScanPtr scan = CObservation2DRangeScan::Create();
+	scan->aperture = M_PIf;
+	scan->maxRange = 20;
+	grid.laserScanSimulator(*scan, CPose2D(1.1,0.5,0), 0.5f, 181);
+
+	CSensoryFrame sf;
+	sf.insert(scan);
+
+	CActionRobotMovement2D  odo;
+	odo.computeFromOdometry( CPose2D(0.1,0,0), CActionRobotMovement2D::TMotionModelOptions() );
+	CActionCollection acts;
+	acts.insert(odo);
+
+	mrpt::system::setNumberOfParallelThreads(nThreads);
+	randomGenerator.randomize(1234);
+
+	CMonteCarloLocalization2D  pdf(200);
+	pdf.options.metricMap = &grid;
+	pdf.resetUniform(0.5,1.5,0,1, -0.2,0.2);
+
+	CParticleFilter PF;
+	PF.m_options.PF_algorithm = algorithm;
+	PF.m_options.pfAuxFilterOptimal_MaximumSearchSamples = 20;
+	PF.m_options.parallelizeLikelihoods = parallel;
+	PF.executeOn(pdf,&acts,&sf);
+
+	out_logw.resize(pdf.size());
+	out_poses.resize(pdf.size());
+	for (size_t i=0;i<pdf.size();i++)
+	{
+		out_logw[i] = pdf.getW(i);
+		out_poses[i] = *pdf.m_particles[i].d;
+	}
+	mrpt::system::setNumberOfParallelThreads(0);
+}
+
+TEST(MonteCarlo2D, ParallelLikelihoodsAreDeterministic)
+{
+	vector<double>  w1,w2;
+	vector<CPose2D> p1,p2;
+
+	// Standard proposal: the parallel update gives the same result than the serial one:
+	runOneSyntheticStep(CParticleFilter::pfStandardProposal, false,1, w1,p1);
+	runOneSyntheticStep(CParticleFilter::pfStandardProposal, true, 4, w2,p2);
+	ASSERT_EQ(w1.size(),w2.size());
+	for (size_t i=0;i<w1.size();i++)
+	{
+		EXPECT_NEAR(w1[i],w2[i], 1e-9);
+		EXPECT_NEAR((p1[i]-p2[i]).norm(),0, 1e-9);
+	}
+
+	// Optimal auxiliary PF: the per-particle random streams make the result independent of the number of threads:
+	runOneSyntheticStep(CParticleFilter::pfAuxiliaryPFOptimal, true,1, w1,p1);
+	runOneSyntheticStep(CParticleFilter::pfAuxiliaryPFOptimal, true,4, w2,p2);
+	ASSERT_EQ(w1.size(),w2.size());
+	for (size_t i=0;i<w1.size();i++)
+	{
+		EXPECT_NEAR(w1[i],w2[i], 1e-9);
+		EXPECT_NEAR((p1[i]-p2[i]).norm(),0, 1e-9);
+	}
+}
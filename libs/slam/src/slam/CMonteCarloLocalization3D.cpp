@@ -85,13 +85,11 @@ CMonteCarloLocalization3D::~CMonteCarloLocalization3D()
 /*---------------------------------------------------------------
 						getLastPose
  ---------------------------------------------------------------*/
-const TPose3D* CMonteCarloLocalization3D::getLastPose(const size_t i) const
+TPose3D CMonteCarloLocalization3D::getLastPose(const size_t i) const
 {
 	if (i>=m_particles.size()) THROW_EXCEPTION("Particle index out of bounds!");
-	static TPose3D auxHolder;
 	ASSERTDEB_(m_particles[i].d!=NULL)
-	auxHolder = TPose3D(*m_particles[i].d);
-	return &auxHolder;
+	return TPose3D(*m_particles[i].d);
 }
 
 
@@ -292,15 +292,12 @@ void  CMultiMetricMapPDF::readFromStream(CStream &in, int version)
 /*---------------------------------------------------------------
 						getLastPose
  ---------------------------------------------------------------*/
-const TPose3D* CMultiMetricMapPDF::getLastPose(const size_t i) const
+TPose3D CMultiMetricMapPDF::getLastPose(const size_t i) const
 {
 	if (i>=m_particles.size()) THROW_EXCEPTION("Particle index out of bounds!");
+	if (m_particles[i].d->robotPath.empty()) THROW_EXCEPTION("The robot path of the particle is empty!");
 
-	size_t	n = m_particles[i].d->robotPath.size();
-
-	if (n)
-			return &m_particles[i].d->robotPath[n-1];
-	else	return NULL;
+	return m_particles[i].d->robotPath.back();
 }
 
 /*---------------------------------------------------------------
@@ -397,8 +394,7 @@ void  CMultiMetricMapPDF::rebuildAverageMap()
 		{
 			// The cells in the source map:
 			unsigned short*		srcCell;
-			unsigned short*		firstSrcCell = (unsigned short*)&(*part->d->mapTillNow.m_gridMaps[0]->map.begin());
-			unsigned short*		lastSrcCell = (unsigned short*)&(*part->d->mapTillNow.m_gridMaps[0]->map.end());
+			unsigned short*		lastSrcCell;
 
 			// Assure sizes:
 			ASSERT_(0==(part->d->mapTillNow.m_gridMaps[0]->size_x % 8));
@@ -407,7 +403,6 @@ void  CMultiMetricMapPDF::rebuildAverageMap()
 
 			// The destination cells:
 			unsigned short*		destCell;
-			unsigned short*		firstDestCell = (unsigned short*)&averageMap.m_gridMaps[0]->map[0];
 
 			// The weight of particle:
 			MRPT_ALIGN16 unsigned short weights_array[8];
@@ -415,11 +410,14 @@ void  CMultiMetricMapPDF::rebuildAverageMap()
 			weights_array[4] = weights_array[5] = weights_array[6] = weights_array[7] = (unsigned short)(exp(part->log_w) * 65535 / sumLinearWeights);
 			unsigned short*		weights_8 = weights_array;
 
-			srcCell = firstSrcCell;
-			destCell = firstDestCell;
-			//size_t	cellsCount = averageMap.gridMap->map.size();
+			// For each row in individual maps (only the cells within a row are contiguous):
+			for (unsigned int y=0;y<averageMap.m_gridMaps[0]->size_y;y++)
+			{
+			srcCell = (unsigned short*)part->d->mapTillNow.m_gridMaps[0]->map.getRow(y);
+			lastSrcCell = srcCell + part->d->mapTillNow.m_gridMaps[0]->size_x;
+			destCell = (unsigned short*)averageMap.m_gridMaps[0]->map.getRowWritable(y);
 
-			// For each cell in individual maps:
+			// For each cell in the row:
 			__asm
 			{
 				push	eax
@@ -464,6 +462,7 @@ void  CMultiMetricMapPDF::rebuildAverageMap()
 				pop		edx
 				pop		eax
 			}
+			} // end for each row
 
 			// Next particle:
 			part++;
@@ -483,6 +482,8 @@ void  CMultiMetricMapPDF::rebuildAverageMap()
 
 		// Reserve a float grid-map, add weight all maps
 		// -------------------------------------------------------------------------------------------
+		const unsigned int size_x = averageMap.m_gridMaps[0]->size_x;
+		const unsigned int size_y = averageMap.m_gridMaps[0]->size_y;
 		std::vector<float>	floatMap;
 		floatMap.resize(averageMap.m_gridMaps[0]->map.size(),0);
 
@@ -495,31 +496,33 @@ void  CMultiMetricMapPDF::rebuildAverageMap()
 
 		for (part=m_particles.begin();part!=m_particles.end();part++)
 		{
-			// Variables:
-			std::vector<COccupancyGridMap2D::cellType>::iterator	srcCell;
-			std::vector<COccupancyGridMap2D::cellType>::iterator	firstSrcCell = part->d->mapTillNow.m_gridMaps[0]->map.begin();
-			std::vector<COccupancyGridMap2D::cellType>::iterator	lastSrcCell = part->d->mapTillNow.m_gridMaps[0]->map.end();
-			std::vector<float>::iterator							destCell;
-
 			// The weight of particle:
 			float		w =  exp(part->log_w) / sumW;
 
 			ASSERT_( part->d->mapTillNow.m_gridMaps[0]->map.size() == floatMap.size() );
 
-			// For each cell in individual maps:
-			for (srcCell = firstSrcCell, destCell = floatMap.begin();srcCell!=lastSrcCell;srcCell++,destCell++)
-				(*destCell) += w * (*srcCell);
+			// For each cell in individual maps (stored row by row in tiles):
+			std::vector<float>::iterator	destCell = floatMap.begin();
+			for (unsigned int y=0;y<size_y;y++)
+			{
+				const COccupancyGridMap2D::cellType *srcCell = part->d->mapTillNow.m_gridMaps[0]->map.getRow(y);
+				for (unsigned int x=0;x<size_x;x++,destCell++)
+					(*destCell) += w * srcCell[x];
+			}
 
 		}
 
 		// Copy to fixed point map:
-		std::vector<float>::iterator							srcCell;
-		std::vector<COccupancyGridMap2D::cellType>::iterator	destCell = averageMap.m_gridMaps[0]->map.begin();
+		std::vector<float>::iterator	srcCell = floatMap.begin();
 
 		ASSERT_( averageMap.m_gridMaps[0]->map.size() == floatMap.size() );
 
-		for (srcCell=floatMap.begin();srcCell!=floatMap.end();srcCell++,destCell++)
-			*destCell = static_cast<COccupancyGridMap2D::cellType>( *srcCell );
+		for (unsigned int y=0;y<size_y;y++)
+		{
+			COccupancyGridMap2D::cellType *destCell = averageMap.m_gridMaps[0]->map.getRowWritable(y);
+			for (unsigned int x=0;x<size_x;x++,srcCell++)
+				destCell[x] = static_cast<COccupancyGridMap2D::cellType>( *srcCell );
+		}
 
 		MRPT_END
 	}	// End of SSE not supported
@@ -562,7 +565,7 @@ void  CMultiMetricMapPDF::insertObservation(CSensoryFrame	&sf)
 
 	for (size_t i=0;i<M;i++)
 	{
-		const CPose3D robotPose(*getLastPose(i));
+		const CPose3D robotPose(getLastPose(i));
 		sf.insertObservationsInto( &m_particles[i].d->mapTillNow, &robotPose );
 	}
 
@@ -27,8 +27,9 @@
 #include <mrpt/poses/CPointPDFGaussian.h>
 #include <mrpt/poses/CPoint2DPDFGaussian.h>
 
-#include <numeric>  // accumulate
 #include <memory>   // auto_ptr, unique_ptr
+#include <mrpt/system/parallelization.h>
+#include <mrpt/synch/CCriticalSection.h>
 
 #include <mrpt/otherlibs/nanoflann/nanoflann.hpp> // For kd-tree's
 #include <mrpt/math/KDTreeCapable.h>   // For kd-tree's
@@ -41,209 +42,412 @@ using namespace mrpt::slam;
 using namespace mrpt::utils;
 
 
-namespace mrpt
+namespace
 {
-namespace slam
-{
-	struct TAuxDataRecursiveJCBB
+	template<TDataAssociationMetric METRIC>
+	bool isCloser(const double v1, const double v2);
+
+	template<>
+	bool isCloser<metricMaha>(const double v1, const double v2) { return v1<v2; }
+
+	template<>
+	bool isCloser<metricML>(const double v1, const double v2) { return v1>v2; }
+
+	/** Data shared by all the JCBB searches (see TJCBBSearch) */
+	struct TJCBBShared
 	{
-		size_t nPredictions, nObservations, length_O; //!< Just to avoid recomputing them all the time.
-		std::map<size_t,size_t>	currentAssociation;
-	};
+		TJCBBShared() : deadline(INVALID_TIMESTAMP), best_count(0), timeout(false) {}
 
-/**  Computes the joint distance metric (mahalanobis or matching likelihood) between two  a set of associations
-  *
-  * On "currentAssociation":  maps "ID_obs" -> "ID_pred"
-  *  For each landmark ID in the observations (ID_obs), its association
-  *  in the predictions, that is: ID_pred = associations[ID_obs]
-  *
-  */
-template <typename T, TDataAssociationMetric METRIC>
-double joint_pdf_metric (
-	const CMatrixTemplateNumeric<T>		&Z_observations_mean,
-	const CMatrixTemplateNumeric<T>		&Y_predictions_mean,
-	const CMatrixTemplateNumeric<T>		&Y_predictions_cov,
-	const TAuxDataRecursiveJCBB			&info,
-	const TDataAssociationResults	&aux_data
-	)
-{
-	// Make a list of the indices of the predictions that appear in "currentAssociation":
-	const size_t  N = info.currentAssociation.size();
+		bool deadlineExceeded() const { return deadline!=INVALID_TIMESTAMP && mrpt::system::now()>deadline; }
+
+		const CMatrixDouble *Z_observations_mean, *Y_predictions_mean, *Y_predictions_cov;
+		size_t nPredictions, nObservations, length_O;
+		double initial_distance; //!< The distance of the empty hypothesis, before evaluating any leaf
+
+		std::vector<std::vector<prediction_index_t> > compat_preds; //!< For each observation, the indices of its individually compatible predictions, in ascending order
+		std::vector<size_t>  potentials;  //!< potentials[i]: Number of individually compatible pairings of the observations after the i'th one (Matlab: potentials = pairings(compatibility.AL(i+1:end)) )
+		mrpt::system::TTimeStamp deadline; //!< INVALID_TIMESTAMP if there is no time budget
 
-	vector_size_t  indices_pred(N);  // Appearance order indices in the std::maps
-	vector_size_t  indices_obs(N);
+		mrpt::synch::CCriticalSection  cs; //!< Protects "best_count" and "timeout"
+		size_t  best_count;  //!< The largest number of pairings found so far by any search
+		bool    timeout;     //!< Set when the deadline is exceeded, so all the searches stop
+	};
 
+	/** One JCBB search over the subtree of the hypotheses which start with a given prefix.
+	  *  The joint distance is only needed at the leaves which may become the best hypothesis, so it is computed there, from
+	  *  the Cholesky factor of the covariance of the innovations: that factor is kept while descending the tree and only the
+	  *  block of rows of the pairings added since the last evaluation must be computed, instead of inverting the whole matrix.
+	  */
+	template <TDataAssociationMetric METRIC>
+	struct TJCBBSearch
 	{
-		size_t i=0;
-		for (map<size_t,size_t>::const_iterator it=info.currentAssociation.begin();it!=info.currentAssociation.end();++it)
+		TJCBBSearch(TJCBBShared &shared, size_t &nodes_since_check) :
+			sh(shared),
+			pred_used(shared.nPredictions,false),
+			nFactored(0),
+			best_count(0),
+			best_distance(shared.initial_distance),
+			nNodes(0),
+			nNodesSinceCheck(nodes_since_check),
+			known_best_count(0),
+			stop(false)
 		{
-			indices_obs[i]  = it->first;
-			indices_pred[i] = it->second;
-			i++;
+			const size_t O = sh.length_O, maxDim = O*std::min(sh.nObservations,sh.nPredictions);
+			L.resize(maxDim,maxDim);
+			y.resize(maxDim);
+			B.resize(maxDim,O);
+			S.resize(O,O);
+			v.resize(O);
+			d2.push_back(0);
+			logdet.push_back(0);
+			valid.push_back(true);
 		}
-	}
-
-	// ----------------------------------------------------------------------
-	// Extract submatrix of the covariances involved here:
-	//  COV = PREDICTIONS_COV(INDX,INDX) + OBSERVATIONS_COV(INDX2,INDX2)
-	// ----------------------------------------------------------------------
-	Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic> COV;
-	Y_predictions_cov.extractSubmatrixSymmetricalBlocks(
-		info.length_O, // dims of cov. submatrices
-		indices_pred,
-		COV );
-
-	// ----------------------------------------------------------------------
-	// Mean:
-	// The same for the vector of "errors" or "innovation" between predictions and observations:
-	// ----------------------------------------------------------------------
-	mrpt::dynamicsize_vector<T> innovations(N * info.length_O);
-	T *dst_ptr= &innovations[0];
-	for (map<size_t,size_t>::const_iterator it=info.currentAssociation.begin();it!=info.currentAssociation.end();++it)
-	{
-		const T *pred_i_mean = Y_predictions_mean.get_unsafe_row( it->second );
-		const T *obs_i_mean  = Z_observations_mean.get_unsafe_row( it->first );
 
-		for (unsigned int k=0;k<info.length_O;k++)
-			*dst_ptr++ = pred_i_mean[k]-obs_i_mean[k];
-	}
+		TJCBBShared &sh;
+
+		// The current hypothesis:
+		std::vector<observation_index_t>  cur_obs;
+		std::vector<prediction_index_t>   cur_pred;
+		std::vector<bool>                 pred_used;
+
+		// The factorization of the first "nFactored" pairings of the current hypothesis:
+		size_t           nFactored;
+		Eigen::MatrixXd  L;   //!< Lower triangular: the Cholesky factor of the covariance of the innovations (top-left block)
+		Eigen::VectorXd  y;   //!< L^{-1} times the innovations
+		std::vector<double> d2, logdet; //!< Squared Mahalanobis distance and log(det(COV)) for 0,1,...,nFactored pairings
+		std::vector<bool>   valid;      //!< False if COV is not positive definite (numerically) at that depth
+		Eigen::MatrixXd  B, S;  // Workspace
+		Eigen::VectorXd  v;
+		Eigen::LLT<Eigen::MatrixXd> llt;
+
+		// The best hypothesis found by this search:
+		std::map<observation_index_t,prediction_index_t>  best;
+		size_t  best_count;
+		double  best_distance;
+
+		size_t  nNodes;
+		size_t &nNodesSinceCheck; //!< Nodes since the last checkSharedState(), kept by the caller across all the searches of a thread
+		size_t  known_best_count; //!< Our copy of "sh.best_count", refreshed from time to time
+		bool    stop;
+
+		void pushPairing(const observation_index_t obsIdx, const prediction_index_t predIdx)
+		{
+			cur_obs.push_back(obsIdx);
+			cur_pred.push_back(predIdx);
+			pred_used[predIdx] = true;
+		}
 
-	// Compute mahalanobis distance squared:
-	CMatrixTemplateNumeric<T>	COV_inv;
-	COV.inv_fast(COV_inv);
+		void popPairing()
+		{
+			pred_used[cur_pred.back()] = false;
+			cur_obs.pop_back();
+			cur_pred.pop_back();
+			if (nFactored>cur_pred.size())
+			{
+				nFactored = cur_pred.size();
+				d2.resize(nFactored+1);
+				logdet.resize(nFactored+1);
+				valid.resize(nFactored+1);
+			}
+		}
 
-	const double d2 = mrpt::math::multiply_HCHt_scalar(innovations, COV_inv);
+		/** Extends the factorization with the new block of rows [ L21 L22 ] of each pairing not factored yet,
+		  * with L21 = (L11^{-1} B)^t and L22 = chol(D - L21 L21^t) */
+		void factorize()
+		{
+			const size_t O = sh.length_O;
+			const CMatrixDouble &COV = *sh.Y_predictions_cov;
 
-	if (METRIC==metricMaha)
-		return d2;
+			for ( ;nFactored<cur_pred.size();nFactored++)
+			{
+				const size_t n = nFactored, m = n*O;
+				const prediction_index_t predIdx = cur_pred[n];
 
-	ASSERT_(METRIC==metricML);
+				bool ok = valid.back();
+				double new_d2 = std::numeric_limits<double>::max(), new_logdet = 0;
+				if (ok)
+				{
+					S = COV.block(predIdx*O,predIdx*O,O,O);
+					if (m)
+					{
+						for (size_t k=0;k<n;k++)
+							B.block(k*O,0,O,O) = COV.block(cur_pred[k]*O,predIdx*O,O,O);
+						L.topLeftCorner(m,m).triangularView<Eigen::Lower>().solveInPlace(B.topRows(m));
+						L.block(m,0,O,m) = B.topRows(m).transpose();
+						S.noalias() -= B.topRows(m).transpose()*B.topRows(m);
+					}
+					llt.compute(S);
+					ok = (llt.info()==Eigen::Success);
+					if (ok)
+					{
+						L.block(m,m,O,O) = llt.matrixL();
+
+						// The innovation of the new pairing:
+						const double *pred_i_mean = sh.Y_predictions_mean->get_unsafe_row(predIdx);
+						const double *obs_i_mean  = sh.Z_observations_mean->get_unsafe_row(cur_obs[n]);
+						for (size_t k=0;k<O;k++)
+							v[k] = pred_i_mean[k]-obs_i_mean[k];
+						if (m) v.noalias() -= L.block(m,0,O,m)*y.head(m);
+						L.block(m,m,O,O).triangularView<Eigen::Lower>().solveInPlace(v);
+						y.segment(m,O) = v;
+
+						new_d2 = d2.back() + v.squaredNorm();
+						new_logdet = logdet.back();
+						for (size_t k=0;k<O;k++)
+							new_logdet += 2*std::log(L(m+k,m+k));
+					}
+				}
+				d2.push_back(new_d2);
+				logdet.push_back(new_logdet);
+				valid.push_back(ok);
+			}
+		}
 
-	// Matching likelihood: The evaluation at 0 of the PDF of the difference between the two Gaussians:
-	const T cov_det = COV.det();
-	const double ml = exp(-0.5*d2) / ( std::pow(M_2PI, info.length_O * 0.5) * std::sqrt(cov_det) );
-	return ml;
-}
+		/** The joint distance metric (mahalanobis or matching likelihood) of the current hypothesis */
+		double jointDistance()
+		{
+			factorize();
+			if (METRIC==metricMaha)
+				return d2.back();
 
-template<TDataAssociationMetric METRIC>
-bool isCloser(const double v1, const double v2);
+			// Matching likelihood: The evaluation at 0 of the PDF of the difference between the two Gaussians:
+			if (!valid.back()) return 0;
+			return exp(-0.5*d2.back()) / ( std::pow(M_2PI, sh.length_O * 0.5) * exp(0.5*logdet.back()) );
+		}
 
-template<>
-bool isCloser<metricMaha>(const double v1, const double v2) { return v1<v2; }
+		size_t currentBound() const { return std::max(best_count,known_best_count); }
 
-template<>
-bool isCloser<metricML>(const double v1, const double v2) { return v1>v2; }
+		/** Every now and then: check the time budget and get the best number of pairings found by other searches */
+		void checkSharedState()
+		{
+			if (++nNodesSinceCheck<256) return;
+			nNodesSinceCheck = 0;
+			const bool timeout = sh.deadlineExceeded();
+
+			mrpt::synch::CCriticalSectionLocker lock(&sh.cs);
+			if (timeout) sh.timeout = true;
+			stop = sh.timeout;
+			known_best_count = sh.best_count;
+		}
 
+		void evaluateLeaf()
+		{
+			const size_t n = cur_pred.size();
+			if (n>best_count)
+			{
+				// It's a better choice since more features are matched.
+				storeBest(jointDistance());
+				mrpt::synch::CCriticalSectionLocker lock(&sh.cs);
+				sh.best_count = std::max(sh.best_count,n);
+				known_best_count = sh.best_count;
+			}
+			else if (n==best_count)
+			{
+				// The same # of features matched than the previous best one... decide by better distance:
+				const double d = jointDistance();
+				if (isCloser<METRIC>(d,best_distance))
+					storeBest(d);
+			}
+		}
 
-/* Based on MATLAB code by:
-  University of Zaragoza
-  Centro Politecnico Superior
-  Robotics and Real Time Group
-  Authors of the original MATLAB code:  J. Neira, J. Tardos
-  C++ version: J.L. Blanco Claraco
-*/
-template <typename T, TDataAssociationMetric METRIC>
-void JCBB_recursive(
-	const mrpt::math::CMatrixTemplateNumeric<T>		&Z_observations_mean,
-	const mrpt::math::CMatrixTemplateNumeric<T>		&Y_predictions_mean,
-	const mrpt::math::CMatrixTemplateNumeric<T>		&Y_predictions_cov,
-	TDataAssociationResults			&results,
-	const TAuxDataRecursiveJCBB		&info,
-	const observation_index_t		curObsIdx
-	)
-{
-	// End of iteration?
-	if (curObsIdx>=info.nObservations)
-	{
-		if (info.currentAssociation.size()>results.associations.size())
+		void storeBest(const double d)
 		{
-			// It's a better choice since more features are matched.
-			results.associations = info.currentAssociation;
-			results.distance = joint_pdf_metric<T,METRIC>(
-				Z_observations_mean,
-				Y_predictions_mean,  Y_predictions_cov,
-				info,
-				results);
+			best.clear();
+			for (size_t k=0;k<cur_obs.size();k++)
+				best[cur_obs[k]] = cur_pred[k];
+			best_count = cur_obs.size();
+			best_distance = d;
 		}
-		else if ( info.currentAssociation.size()==results.associations.size() )
+
+		/* Based on MATLAB code by:
+		  University of Zaragoza
+		  Centro Politecnico Superior
+		  Robotics and Real Time Group
+		  Authors of the original MATLAB code:  J. Neira, J. Tardos
+		  C++ version: J.L. Blanco Claraco
+		*/
+		void recursive(const observation_index_t curObsIdx)
 		{
-			// The same # of features matched than the previous best one... decide by better distance:
-			const double d2 = joint_pdf_metric<T,METRIC>(
-				Z_observations_mean,
-				Y_predictions_mean,  Y_predictions_cov,
-				info,
-				results);
-
-			if (isCloser<METRIC>(d2,results.distance))
+			if (stop) return;
+
+			// End of iteration?
+			if (curObsIdx>=sh.nObservations)
 			{
-				results.associations = info.currentAssociation;
-				results.distance = d2;
+				evaluateLeaf();
+				return;
+			}
+
+			// Iterate for all compatible landmarks of "curObsIdx"
+			const size_t n = cur_pred.size();
+			const size_t potentials = sh.potentials[curObsIdx];
+			const std::vector<prediction_index_t> &preds = sh.compat_preds[curObsIdx];
+
+			for (size_t k=0;k<preds.size() && !stop;k++)
+			{
+				// Can we do it better than the current best hypothesis?
+				// This can be checked by counting the potential new pairings (including this one) +the so-far established ones.
+				// Hypotheses which could tie with the best one are never pruned, so the result does not depend on the order
+				// the subtrees are searched in.
+				if (n + 1 + potentials < currentBound()) break;
+
+				// Only if predIdx is NOT already assigned:
+				const prediction_index_t predIdx = preds[k];
+				if (pred_used[predIdx]) continue;
+
+				// Launch a new recursive line for this hipothesis:
+				nNodes++;
+				checkSharedState();
+				pushPairing(curObsIdx,predIdx);
+				recursive(curObsIdx+1);
+				popPairing();
+			}
+
+			// Can we do it better than the current best hypothesis?
+			if (!stop && n + potentials >= currentBound())
+			{
+				// Yes we can </obama>
+
+				// star node: Ei not paired
+				nNodes++;
+				checkSharedState();
+				recursive(curObsIdx+1);
 			}
 		}
-	}
-	else // A normal iteration:
+	};
+
+	/** A subtree of the JCBB search: the pairings of the first observations (-1: not paired) */
+	typedef std::vector<int> TJCBBPrefix;
+
+	/** The outcome of the search of one subtree */
+	struct TJCBBSubtreeResult
 	{
-		// Iterate for all compatible landmarsk of "curObsIdx"
-		const observation_index_t obsIdx = curObsIdx;
+		TJCBBSubtreeResult() : best_count(0), best_distance(0), nNodes(0) {}
+
+		std::map<observation_index_t,prediction_index_t>  best;
+		size_t  best_count;
+		double  best_distance;
+		size_t  nNodes;
+	};
 
-		const size_t nPreds = results.indiv_compatibility.getRowCount();
+	/** Body for mrpt::system::parallel_for(): runs the JCBB search of a range of subtrees (see TJCBBPrefix) */
+	template <TDataAssociationMetric METRIC>
+	struct TJCBBParallelBody
+	{
+		TJCBBShared *sh;
+		const std::vector<TJCBBPrefix> *prefixes;
+		std::vector<TJCBBSubtreeResult> *out;
 
-		// Can we do it better than the current "results.associations"?
-		// This can be checked by counting the potential new pairings+the so-far established ones.
-		//    Matlab: potentials  = pairings(compatibility.AL(i+1:end))
-		// Moved up by Kasra Khosoussi
-		const size_t potentials = std::accumulate( results.indiv_compatibility_counts.begin()+(obsIdx+1), results.indiv_compatibility_counts.end(),0 );
-		for (prediction_index_t predIdx=0;predIdx<nPreds;predIdx++)
+		void operator()(const mrpt::system::BlockedRange &r) const
 		{
-			if ((info.currentAssociation.size() + potentials) >= results.associations.size())
+			size_t nNodesSinceCheck = 0;  // Shared by the subtrees of this chunk, all of them searched in this thread
+			for (int i=r.begin();i<r.end();i++)
 			{
-				// Only if predIdx is NOT already assigned:
-				if ( results.indiv_compatibility(predIdx,obsIdx) )
+				TJCBBSearch<METRIC> s(*sh,nNodesSinceCheck);
+				const TJCBBPrefix &prefix = (*prefixes)[i];
+				const size_t depth = prefix.size();
+
+				// Check the deadline before each subtree, since small ones may be searched entirely between two periodic checks:
+				const bool timeout = sh->deadlineExceeded();
 				{
-					// Only if predIdx is NOT already assigned:
-					bool already_asigned = false;
-					for (map<size_t,size_t>::const_iterator itS=info.currentAssociation.begin();itS!=info.currentAssociation.end();++itS)
-					{
-						if (itS->second==predIdx)
-						{
-							already_asigned = true;
-							break;
-						}
-					}
+					mrpt::synch::CCriticalSectionLocker lock(&sh->cs);
+					if (timeout) sh->timeout = true;
+					s.known_best_count = sh->best_count;
+					s.stop = sh->timeout;
+				}
+				if (!s.stop)
+				{
+					for (size_t k=0;k<depth;k++)
+						if (prefix[k]>=0)
+							s.pushPairing(k,static_cast<prediction_index_t>(prefix[k]));
 
-					if (!already_asigned)
-					{
-						// Launch a new recursive line for this hipothesis:
-						TAuxDataRecursiveJCBB new_info = info;
-						new_info.currentAssociation[ curObsIdx ] = predIdx;
+					// Skip the subtree if it cannot reach the best number of pairings found so far:
+					if (s.cur_pred.size() + sh->potentials[depth-1] >= s.currentBound())
+						s.recursive(depth);
+				}
 
-						results.nNodesExploredInJCBB++;
+				TJCBBSubtreeResult &res = (*out)[i];
+				res.best.swap(s.best);
+				res.best_count = s.best_count;
+				res.best_distance = s.best_distance;
+				res.nNodes = s.nNodes;
+			}
+		}
+	};
 
-						JCBB_recursive<T,METRIC>(
-							Z_observations_mean, Y_predictions_mean, Y_predictions_cov,
-							results, new_info, curObsIdx+1);
+	/** The JCBB algorithm: the subtrees of the first levels are searched in parallel, sharing the best number of pairings found
+	  *  so far (the bound). Their best hypotheses are merged in the order of the sequential search, so the result is the same.
+	  */
+	template <TDataAssociationMetric METRIC>
+	void JCBB(TJCBBShared &sh, TDataAssociationResults &results)
+	{
+		// Split the tree into subtrees, in the order of the sequential search, until there are enough for all the threads:
+		const unsigned int nThreads = mrpt::system::getNumberOfParallelThreads();
+		const size_t nMinSubtrees = 8*nThreads;
+
+		std::vector<TJCBBPrefix> prefixes(1);
+		size_t nPrefixNodes = 0;
+		if (nThreads>1)
+		{
+			while (prefixes.size()<nMinSubtrees && prefixes[0].size()<sh.nObservations)
+			{
+				const size_t obsIdx = prefixes[0].size();
+				std::vector<TJCBBPrefix> next;
+				for (size_t i=0;i<prefixes.size();i++)
+				{
+					const std::vector<prediction_index_t> &preds = sh.compat_preds[obsIdx];
+					for (size_t k=0;k<preds.size();k++)
+					{
+						if (std::find(prefixes[i].begin(),prefixes[i].end(),static_cast<int>(preds[k]))!=prefixes[i].end())
+							continue;
+						next.push_back(prefixes[i]);
+						next.back().push_back(static_cast<int>(preds[k]));
 					}
+					// star node:
+					next.push_back(prefixes[i]);
+					next.back().push_back(-1);
 				}
+				nPrefixNodes+=next.size();
+				prefixes.swap(next);
 			}
 		}
 
-		// Can we do it better than the current "results.associations"?
-		if ((info.currentAssociation.size() + potentials) >= results.associations.size() )
+		std::vector<TJCBBSubtreeResult> subtrees(prefixes.size());
+		if (prefixes.size()==1 && prefixes[0].empty())
+		{
+			// Just the sequential search:
+			size_t nNodesSinceCheck = 0;
+			TJCBBSearch<METRIC> s(sh,nNodesSinceCheck);
+			s.recursive(0);
+			subtrees[0].best.swap(s.best);
+			subtrees[0].best_count = s.best_count;
+			subtrees[0].best_distance = s.best_distance;
+			subtrees[0].nNodes = s.nNodes;
+		}
+		else
 		{
-			// Yes we can </obama>
+			TJCBBParallelBody<METRIC> body;
+			body.sh = &sh;
+			body.prefixes = &prefixes;
+			body.out = &subtrees;
+			mrpt::system::parallel_for( mrpt::system::BlockedRange(0,static_cast<int>(prefixes.size()),1), body );
+		}
 
-			// star node: Ei not paired
-			results.nNodesExploredInJCBB++;
-			JCBB_recursive<T,METRIC>(
-				Z_observations_mean,  Y_predictions_mean, Y_predictions_cov,
-				results, info, curObsIdx+1);
+		// Merge, in order:
+		results.nNodesExploredInJCBB = nPrefixNodes;
+		size_t best_count = 0;
+		for (size_t i=0;i<subtrees.size();i++)
+		{
+			TJCBBSubtreeResult &res = subtrees[i];
+			results.nNodesExploredInJCBB += res.nNodes;
+			if (res.best_count>best_count || (res.best_count==best_count && isCloser<METRIC>(res.best_distance,results.distance)))
+			{
+				results.associations.swap(res.best);
+				results.distance = res.best_distance;
+				best_count = res.best_count;
+			}
 		}
+		results.JCBB_timeout = sh.timeout;
 	}
-}
-
-
-
-} // end namespace
 } // end namespace
 
 
@@ -279,7 +483,8 @@ void mrpt::slam::data_association_full_covariance(
 	const bool							DAT_ASOC_USE_KDTREE,
 	const std::vector<prediction_index_t>		&predictions_IDs,
 	const TDataAssociationMetric		compatibilityTestMetric,
-	const double						log_ML_compat_test_threshold
+	const double						log_ML_compat_test_threshold,
+	const double						JCBB_max_time
 	)
 {
 	// For details on the theory, see the papers cited at the beginning of this file.
@@ -487,16 +692,31 @@ void mrpt::slam::data_association_full_covariance(
 		// ------------------------------------
 	case assocJCBB:
 		{
-			// Call to the recursive method:
-			TAuxDataRecursiveJCBB	info;
-			info.nPredictions	= nPredictions;
-			info.nObservations	= nObservations;
-			info.length_O		= length_O;
+			TJCBBShared  sh;
+			sh.Z_observations_mean = &Z_observations_mean;
+			sh.Y_predictions_mean  = &Y_predictions_mean;
+			sh.Y_predictions_cov   = &Y_predictions_cov;
+			sh.nPredictions	 = nPredictions;
+			sh.nObservations = nObservations;
+			sh.length_O      = length_O;
+			sh.initial_distance = results.distance;
+			if (JCBB_max_time>0)
+				sh.deadline = mrpt::system::now() + mrpt::system::secondsToTimestamp(JCBB_max_time);
+
+			// Sparse lists of the individually compatible pairings, and the number of them after each observation:
+			sh.compat_preds.resize(nObservations);
+			for (size_t i=0;i<nPredictions;++i)
+				for (size_t j=0;j<nObservations;++j)
+					if (results.indiv_compatibility.get_unsafe(i,j))
+						sh.compat_preds[j].push_back(i);
+			sh.potentials.assign(nObservations,0);
+			for (size_t j=nObservations-1;j>0;--j)
+				sh.potentials[j-1] = sh.potentials[j] + results.indiv_compatibility_counts[j];
 
 			if (metric==metricMaha)
-				JCBB_recursive<CMatrixDouble::Scalar,metricMaha>(Z_observations_mean,  Y_predictions_mean, Y_predictions_cov,results, info, 0 );
+				JCBB<metricMaha>(sh,results);
 			else
-				JCBB_recursive<CMatrixDouble::Scalar,metricML>(Z_observations_mean,  Y_predictions_mean, Y_predictions_cov,results, info, 0 );
+				JCBB<metricML>(sh,results);
 		}
 		break;
 
@@ -532,7 +752,8 @@ void mrpt::slam::data_association_independent_predictions(
 	const bool							DAT_ASOC_USE_KDTREE,
 	const std::vector<prediction_index_t>		&predictions_IDs,
 	const TDataAssociationMetric		compatibilityTestMetric,
-	const double						log_ML_compat_test_threshold
+	const double						log_ML_compat_test_threshold,
+	const double						JCBB_max_time
 	)
 {
 	MRPT_START
@@ -569,7 +790,8 @@ void mrpt::slam::data_association_independent_predictions(
 		Y_predictions_mean,Y_predictions_cov_full,
 		results, method, metric, chi2quantile,
 		DAT_ASOC_USE_KDTREE, predictions_IDs,
-		compatibilityTestMetric, log_ML_compat_test_threshold );
+		compatibilityTestMetric, log_ML_compat_test_threshold,
+		JCBB_max_time );
 
 	MRPT_END
 }
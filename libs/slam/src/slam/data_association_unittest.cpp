@@ -53,3 +53,97 @@ TEST(DataAssociation, TestNoICs)
 	}
 
 }
+
+// A cluttered problem: 2D landmarks with correlated predictions, most observations close to one of them plus some spurious ones
+static void generateClutteredProblem(const size_t N, const size_t M, CMatrixDouble &z, CMatrixDouble &y, CMatrixDouble &y_cov)
+{
+	mrpt::random::CRandomGenerator rng(static_cast<uint32_t>(123));
+	y.setSize(N,2);
+	z.setSize(M,2);
+	for (size_t i=0;i<N;i++)
+		for (size_t k=0;k<2;k++)
+			y(i,k) = rng.drawUniform(0,6);
+
+	CMatrixDouble A(2*N,2*N);
+	for (size_t i=0;i<2*N;i++)
+		for (size_t j=0;j<2*N;j++)
+			A(i,j) = rng.drawGaussian1D(0,0.05);
+	y_cov = A*A.transpose();
+	for (size_t i=0;i<2*N;i++)
+		y_cov(i,i)+=0.04;
+
+	for (size_t j=0;j<M;j++)
+	{
+		if (j%4==3)
+			for (size_t k=0;k<2;k++) z(j,k) = rng.drawUniform(0,6);
+		else
+		{
+			const size_t i = rng.drawUniform32bit() % N;
+			for (size_t k=0;k<2;k++) z(j,k) = y(i,k) + rng.drawGaussian1D(0,0.15);
+		}
+	}
+}
+
+TEST(DataAssociation, JCBBParallelEqualsSerial)
+{
+	CMatrixDouble y, y_cov, z;
+	generateClutteredProblem(18,12, z,y,y_cov);
+
+	const TDataAssociationMetric damets[2] = { metricMaha, metricML };
+	for (unsigned int da_metric=0;da_metric<sizeof(damets)/sizeof(damets[0]);++da_metric)
+	{
+		TDataAssociationResults	res_serial, res_parallel;
+
+		mrpt::system::setNumberOfParallelThreads(1);
+		data_association_full_covariance(z, y, y_cov, res_serial, assocJCBB, damets[da_metric], 0.99);
+		mrpt::system::setNumberOfParallelThreads(4);
+		data_association_full_covariance(z, y, y_cov, res_parallel, assocJCBB, damets[da_metric], 0.99);
+		mrpt::system::setNumberOfParallelThreads(0);
+
+		EXPECT_FALSE(res_serial.associations.empty());
+		EXPECT_TRUE(res_serial.associations==res_parallel.associations) << "da_metric=" << da_metric;
+		EXPECT_DOUBLE_EQ(res_serial.distance, res_parallel.distance) << "da_metric=" << da_metric;
+
+		if (damets[da_metric]==metricMaha)
+		{
+			// Check the incrementally computed joint distance against its direct evaluation:
+			const size_t n = res_serial.associations.size();
+			CMatrixDouble cov(2*n,2*n);
+			CVectorDouble innov(2*n);
+			size_t i=0;
+			for (std::map<observation_index_t,prediction_index_t>::const_iterator it=res_serial.associations.begin();it!=res_serial.associations.end();++it,++i)
+			{
+				size_t j=0;
+				for (std::map<observation_index_t,prediction_index_t>::const_iterator jt=res_serial.associations.begin();jt!=res_serial.associations.end();++jt,++j)
+					cov.block(2*i,2*j,2,2) = y_cov.block(2*it->second,2*jt->second,2,2);
+				for (size_t k=0;k<2;k++)
+					innov[2*i+k] = y(it->second,k)-z(it->first,k);
+			}
+			EXPECT_NEAR(res_serial.distance, innov.dot(cov.llt().solve(innov)), 1e-6);
+		}
+	}
+}
+
+TEST(DataAssociation, JCBBTimeBudget)
+{
+	CMatrixDouble y, y_cov, z;
+	generateClutteredProblem(24,15, z,y,y_cov);
+
+	for (unsigned int nThreads=1;nThreads<=4;nThreads+=3)
+	{
+		mrpt::system::setNumberOfParallelThreads(nThreads);
+
+		TDataAssociationResults	DAresults;
+		mrpt::utils::CTicTac tictac;
+		data_association_full_covariance(z, y, y_cov, DAresults, assocJCBB, metricMaha, 0.99, true, std::vector<prediction_index_t>(), metricMaha, 0.0, 1e-6 /* JCBB_max_time */);
+		const double T = tictac.Tac();
+
+		EXPECT_TRUE(DAresults.JCBB_timeout) << "nThreads=" << nThreads;
+		EXPECT_LT(T, 1.0) << "nThreads=" << nThreads;
+
+		// Whatever was found must be made of individually compatible pairings:
+		for (std::map<observation_index_t,prediction_index_t>::const_iterator it=DAresults.associations.begin();it!=DAresults.associations.end();++it)
+			EXPECT_TRUE(DAresults.indiv_compatibility(it->second,it->first)) << "nThreads=" << nThreads;
+	}
+	mrpt::system::setNumberOfParallelThreads(0);
+}
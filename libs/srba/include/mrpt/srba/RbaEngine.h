@@ -308,15 +308,17 @@ namespace srba
 		  *  Edge direction is ignored during the search, i.e. as if we had an undirected graph of Keyframes.
 		  *  If both source and target KF coincide, an empty path is returned.
 		  * \return true if a path was found.
+		  * \param[in] aux_ws Auxiliary working space: Set to an empty object (it'll automatically initialized) to reuse its memory between succesive calls, or to NULL to use a temporary one. Use one per thread if calling this method simultaneously from several threads.
 		  * \note Worst-case computational complexity is that of a BFS over the entire graph: O(V+E), V=number of nodes, E=number of edges.
 		  * \sa create_complete_spanning_tree
 		  */
 		bool find_path_bfs(
 			const TKeyFrameID           src_kf,
 			const TKeyFrameID           trg_kf,
-			std::vector<TKeyFrameID>    & found_path) const
+			std::vector<TKeyFrameID>    & found_path,
+			typename rba_problem_state_t::bfs_workspace_t * aux_ws = NULL) const
 		{
-			return rba_state.find_path_bfs(src_kf,trg_kf,&found_path);
+			return rba_state.find_path_bfs(src_kf,trg_kf,&found_path,NULL,aux_ws);
 		}
 
 		/** Visits all k2k & k2f edges following a BFS starting at a given starting node and up to a given maximum depth.
@@ -539,7 +541,7 @@ namespace srba
 	private:
 		rba_problem_state_t  rba_state;  //!< All the beef is here.
 
-		mutable std::vector<bool> m_complete_st_ws; //!< Temporary working space used in \a create_complete_spanning_tree()
+		mutable std::vector<bool> m_complete_st_ws; //!< Temporary working space used in \a create_complete_spanning_tree(): visited flags, indexed by keyframe ID
 
 		/** Profiler for all SRBA operations
 		  *  Enabled by default, can be disabled with \a enable_time_profiler(false)
@@ -586,17 +588,6 @@ namespace srba
 			std::vector<typename TSparseBlocksJacobians_dh_df::col_t*>  &lst_JacobCols_df,
 			std::vector<const pose_flag_t*>    * out_list_of_required_num_poses = NULL );
 
-		/** Private aux structure for BFS searches. */
-		struct TBFSEntryEdges
-		{
-			TBFSEntryEdges() : dist( numeric_limits<topo_dist_t>::max() ), edge(NULL)
-			{}
-
-			TKeyFrameID prev;
-			topo_dist_t dist;
-			const k2k_edge_t* edge;
-		};
-
 
 		/** ====================================================================
 		                         j,i                    lm_id,base_id
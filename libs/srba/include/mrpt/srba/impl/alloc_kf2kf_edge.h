@@ -39,7 +39,7 @@ size_t TRBA_Problem_state<KF2KF_POSE_TYPE,LM_TYPE,OBS_TYPE,RBA_OPTIONS>::alloc_k
 #ifdef _DEBUG
 	{
 		// Security consistency check for user introducing duplicated edges:
-		std::deque<k2k_edge_t*> &edges = keyframes[ids.first ].adjacent_k2k_edges;
+		std::vector<k2k_edge_t*> &edges = keyframes[ids.first ].adjacent_k2k_edges;
 		for (size_t i=0;i<edges.size();++i)
 		{
 			const k2k_edge_t &e = *edges[i];
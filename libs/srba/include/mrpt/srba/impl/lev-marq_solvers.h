@@ -264,7 +264,8 @@ namespace internal
 					HAp_,Hf_,HApf_, // The different symbolic/numeric Hessians
 					&minus_grad[0],  // minus gradient of the Ap part
 					// Handle case of no unknown features:
-					nUnknowns_k2f!=0 ? &minus_grad[POSE_DIMS*nUnknowns_k2k] : NULL   // minus gradient of the features part
+					nUnknowns_k2f!=0 ? &minus_grad[POSE_DIMS*nUnknowns_k2k] : NULL,   // minus gradient of the features part
+					RBA_ENGINE::rba_options_type::solver_t::PARALLEL
 					)
 		{
 		}
@@ -459,7 +460,8 @@ namespace internal
 					HAp_,Hf_,HApf_, // The different symbolic/numeric Hessians
 					&minus_grad[0],  // minus gradient of the Ap part
 					// Handle case of no unknown features:
-					nUnknowns_k2f!=0 ? &minus_grad[POSE_DIMS*nUnknowns_k2k] : NULL   // minus gradient of the features part
+					nUnknowns_k2f!=0 ? &minus_grad[POSE_DIMS*nUnknowns_k2k] : NULL,   // minus gradient of the features part
+					RBA_ENGINE::rba_options_type::solver_t::PARALLEL
 					),
 				denseChol_is_uptodate (false),
 				hessian_is_valid (false)
@@ -278,6 +278,10 @@ void RbaEngine<KF2KF_POSE_TYPE,LM_TYPE,OBS_TYPE,RBA_OPTIONS>::optimize_edges(
 	for (size_t i=0;i<list_of_required_num_poses.size();i++)
 		list_of_required_num_poses[i]->mark_outdated();
 
+	// These are the only spanning-tree poses to be updated in each LM iteration, so keep a list with them and their paths:
+	typename rba_problem_state_t::TSpanningTree::numeric_poses_to_update_t  num_poses_to_update;
+	rba_state.spanning_tree.get_outdated_numeric_poses(kfs_num_spantrees_to_update, num_poses_to_update);
+
 #if 0  // Save a sparse block representation of the Jacobian.
 	{
 		CMatrixDouble Jbin;
@@ -549,7 +553,7 @@ void RbaEngine<KF2KF_POSE_TYPE,LM_TYPE,OBS_TYPE,RBA_OPTIONS>::optimize_edges(
 			for (size_t i=0;i<list_of_required_num_poses.size();i++)
 				list_of_required_num_poses[i]->mark_outdated();
 
-			rba_state.spanning_tree.update_numeric(kfs_num_spantrees_to_update, true /* Only those marked as outdated above */);
+			rba_state.spanning_tree.update_numeric(num_poses_to_update);
 			DETAILED_PROFILING_LEAVE("opt.update_spanning_tree_num")
 
 			// Compute new reprojection errors:
@@ -127,7 +127,7 @@ bool TRBA_Problem_state<KF2KF_POSE_TYPE,LM_TYPE,OBS_TYPE,RBA_OPTIONS>::are_keyfr
 	ASSERT_BELOW_(id1, keyframes.size())
 	ASSERT_BELOW_(id2, keyframes.size())
 
-	const std::deque<k2k_edge_t*> & id1_adj = keyframes[id1].adjacent_k2k_edges;
+	const std::vector<k2k_edge_t*> & id1_adj = keyframes[id1].adjacent_k2k_edges;
 
 	for (size_t i=0;i<id1_adj.size();i++)
 		if ( id2== getTheOtherFromPair2(id1, *id1_adj[i]) )
@@ -9,9 +9,13 @@
 
 #pragma once
 
+#include <mrpt/system/parallelization.h>
+
 namespace mrpt { namespace srba {
 
 	/** A generic symbolic and numeric Schur-complement handler for builing reduced systems of equations.
+	  *  The numeric parts can be run in parallel (see mrpt::system::parallel_for): the contribution of each landmark block, and each block of the reduced
+	  *  system, are computed by one thread only, in the same order than in the serial version, so the results do not depend on the number of threads.
 	  */
 	template <class HESS_Ap, class HESS_f, class HESS_Apf>
 	class SchurComplement
@@ -21,15 +25,18 @@ namespace mrpt { namespace srba {
 		/** Constructor: builds the symbolic representations
 		  *  Note: HApf must be in row-compressed form; HAp & Hf in column-compressed form.
 		  * \param[in] _minus_grad_f Can be NULL if there're no observations of landmarks with unknown positions (may still be of LMs with known ones).
+		  * \param[in] _parallel Whether to run the numeric steps in parallel (see mrpt::srba::options::solver_parallel)
 		  */
-		SchurComplement(HESS_Ap  &_HAp, HESS_f & _Hf, HESS_Apf & _HApf, double * _minus_grad_Ap, double * _minus_grad_f)
+		SchurComplement(HESS_Ap  &_HAp, HESS_f & _Hf, HESS_Apf & _HApf, double * _minus_grad_Ap, double * _minus_grad_f, const bool _parallel = false)
 		: HAp(_HAp), Hf(_Hf), HApf(_HApf),
 		  minus_grad_Ap(_minus_grad_Ap),
 		  minus_grad_f(_minus_grad_f),
 		  // Problem dims:
 		  nUnknowns_Ap( HAp.getColCount() ),
 		  nUnknowns_f( Hf.getColCount() ),
-		  nHf_invertible_blocks(0)
+		  nHf_invertible_blocks(0),
+		  m_parallel(_parallel),
+		  m_lambda(0), m_deltas_Ap(NULL), m_deltas_feats(NULL)
 		{
 			if (!nUnknowns_f || !nUnknowns_Ap) return;
 
@@ -156,6 +163,15 @@ namespace mrpt { namespace srba {
 				} // end for j (row in HAp)
 			} // end for i (col in HAp)
 
+			// 3) The blocks of each landmark in HApf, to solve for them one by one:
+			// ----------------------------------------------------
+			for (size_t i=0;i<nUnknowns_Ap;i++)
+			{
+				const typename HESS_Apf::col_t  & row_i = HApf.getCol(i);
+				for (typename HESS_Apf::col_t::const_iterator itCol=row_i.begin();itCol!=row_i.end();++itCol)
+					m_Hf_blocks_info[itCol->first].sym_HApf_blocks.push_back( std::make_pair(i, &itCol->second.num) );
+			}
+
 		} // end of ctor.
 
 		/** Must be called after the numerical values of the Hessian HAp change, typically after an optimization update
@@ -189,30 +205,84 @@ namespace mrpt { namespace srba {
 
 			// 1) Invert diagonal blocks in Hf:
 			// ---------------------------------
+			m_lambda = lambda;
+			run_numeric_step(&SchurComplement::numeric_invert_Hf_blocks, nUnknowns_f, 16);
+
 			nHf_invertible_blocks=0;
 			for (size_t i=0;i<nUnknowns_f;i++)
+				if (m_Hf_blocks_info[i].num_Hf_diag_blocks_invertible)
+					nHf_invertible_blocks++;
+
+			// 2) H_Ap of the reduced system:
+			// ---------------------------------
+			run_numeric_step(&SchurComplement::numeric_reduce_HAp, m_sym_HAp_reduce.size(), 4);
+
+			// 3) g_Ap of the reduced system:
+			// ---------------------------------
+			run_numeric_step(&SchurComplement::numeric_reduce_grad_Ap, nUnknowns_Ap, 4);
+
+		} // end of numeric_build_reduced_system
+
+
+		void numeric_solve_for_features(
+			double *in_deltas_Ap,
+			double *out_deltas_feats
+			)
+		{
+			m_deltas_Ap    = in_deltas_Ap;
+			m_deltas_feats = out_deltas_feats;
+			run_numeric_step(&SchurComplement::numeric_solve_features, nUnknowns_f, 16);
+		} // end of numeric_solve_for_features
+
+
+		bool was_ith_feature_invertible(const size_t i) const { return m_Hf_blocks_info[i].num_Hf_diag_blocks_invertible; }
+
+	private:
+		/** Body for mrpt::system::parallel_for(): runs one of the numeric_*() steps over a range of indices */
+		struct TNumericStepBody
+		{
+			typedef void (SchurComplement::*step_t)(const size_t idx_first, const size_t idx_end);
+
+			SchurComplement * const me;
+			const step_t            step;
+
+			TNumericStepBody(SchurComplement *me_, step_t step_) : me(me_), step(step_) { }
+			void operator()(const mrpt::system::BlockedRange &r) const { (me->*step)(r.begin(),r.end()); }
+		};
+
+		void run_numeric_step(typename TNumericStepBody::step_t step, const size_t N, const int grainsize)
+		{
+			const TNumericStepBody body(this,step);
+			if (m_parallel)
+					mrpt::system::parallel_for( mrpt::system::BlockedRange(0,static_cast<int>(N),grainsize), body );
+			else	body( mrpt::system::BlockedRange(0,static_cast<int>(N)) );
+		}
+
+		/** Inverts the diagonal blocks [idx_first,idx_end) of Hf (plus lambda) */
+		void numeric_invert_Hf_blocks(const size_t idx_first, const size_t idx_end)
+		{
+			for (size_t i=idx_first;i<idx_end;i++)
 			{
 				// LU decomposition is rank-revealing (not like LLt)
 				typename HESS_f::matrix_t Hfi = *m_Hf_blocks_info[i].sym_Hf_diag_blocks;
 				for (int k=0;k<Hfi.cols();k++)
-					Hfi.coeffRef(k,k)+=lambda;
+					Hfi.coeffRef(k,k)+=m_lambda;
 
 				const Eigen::FullPivLU<typename HESS_f::matrix_t> lu( Hfi );
 
 				// Badly conditioned matrix?
 				if (true== (m_Hf_blocks_info[i].num_Hf_diag_blocks_invertible = lu.isInvertible() ))
-				{
-					nHf_invertible_blocks++;
 					m_Hf_blocks_info[i].num_Hf_diag_blocks_inverses = lu.inverse();
-				}
 			}
+		}
 
-			// 2) H_Ap of the reduced system:
-			// ---------------------------------
+		/** Updates the blocks [idx_first,idx_end) of m_sym_HAp_reduce (each one of a different block of HAp) */
+		void numeric_reduce_HAp(const size_t idx_first, const size_t idx_end)
+		{
 			typename HESS_Apf::matrix_t aux_Hpi_lk_times_inv_Hf_lk;
-			for (typename std::deque<THApSymbolicEntry>::const_iterator it=m_sym_HAp_reduce.begin();it!=m_sym_HAp_reduce.end();++it)
+			for (size_t idx=idx_first;idx<idx_end;idx++)
 			{
-				const THApSymbolicEntry &sym_entry = *it;
+				const THApSymbolicEntry &sym_entry = m_sym_HAp_reduce[idx];
 
 				typename HESS_Ap::matrix_t & HAp_ij = *sym_entry.HAp_ij;
 
@@ -242,13 +312,14 @@ namespace mrpt { namespace srba {
 				}
 				//std::cout << "after:\n" << HAp_ij<< std::endl;
 			}
+		}
 
-			// 3) g_Ap of the reduced system:
-			// ---------------------------------
-			double * modified_grad_Ap = minus_grad_Ap;
-			for (size_t i=0;i<nUnknowns_Ap;i++)
+		/** Updates the parts [idx_first,idx_end) of the gradient of Ap. Must be called after numeric_reduce_HAp() */
+		void numeric_reduce_grad_Ap(const size_t idx_first, const size_t idx_end)
+		{
+			for (size_t i=idx_first;i<idx_end;i++)
 			{
-				vector_Ap_t grad_Ap = vector_Ap_t(modified_grad_Ap); // A map which wraps the pointer
+				vector_Ap_t grad_Ap = vector_Ap_t(minus_grad_Ap + i*HESS_Ap::matrix_t::RowsAtCompileTime); // A map which wraps the pointer
 				for (typename TGradApSymbolicEntry::lst_terms_t::const_iterator it=m_sym_GradAp_reduce[i].lst_terms_to_subtract.begin();it!=m_sym_GradAp_reduce[i].lst_terms_to_subtract.end();++it)
 				{
 					if (m_Hf_blocks_info[it->feat_idx].num_Hf_diag_blocks_invertible)
@@ -259,62 +330,34 @@ namespace mrpt { namespace srba {
 						grad_Ap.noalias() -= it->Hpi_lk_times_inv_Hf_lk * vector_f_t(grad_df);
 					}
 				}
-
-				// Advance to next part of gradient:
-				modified_grad_Ap+= HESS_Ap::matrix_t::RowsAtCompileTime;
 			}
+		}
 
-
-		} // end of numeric_build_reduced_system
-
-
-		void numeric_solve_for_features(
-			double *in_deltas_Ap,
-			double *out_deltas_feats
-			)
+		/** Solves the increments of the features [idx_first,idx_end), given those of Ap (in m_deltas_Ap) */
+		void numeric_solve_features(const size_t idx_first, const size_t idx_end)
 		{
-			// 1/2: Go thru all the Hessian blocks of HApl and subtracts the corresponding term to
-			//       the grad_feats:
-			for (size_t idx_Ap=0;idx_Ap<nUnknowns_Ap;idx_Ap++)
-			{
-				// get Row i from HAp_f:
-				typename HESS_Apf::col_t  & row_i = HApf.getCol(idx_Ap);
-
-				const vector_Ap_t delta_idx_Ap = vector_Ap_t(in_deltas_Ap + idx_Ap * HESS_Ap::matrix_t::RowsAtCompileTime );
-
-				for (typename HESS_Apf::col_t::const_iterator itCol=row_i.begin();itCol!=row_i.end();++itCol)
-				{
-					const size_t idx_feat = itCol->first;
-					if (!was_ith_feature_invertible(idx_feat))
-						continue;
-
-					double *grad_df = this->minus_grad_f + idx_feat * HESS_f::matrix_t::RowsAtCompileTime;
-
-					// g_reduced = -g_l - \Sum H^t_pi_lk * delta_Ap_i
-					vector_f_t(grad_df).noalias() -= itCol->second.num.transpose() * delta_idx_Ap;
-				}
-			}
-
-			// 2/2: Solve each individual feature increment:
-			for (size_t idx_feat=0;idx_feat<nUnknowns_f;idx_feat++)
+			for (size_t idx_feat=idx_first;idx_feat<idx_end;idx_feat++)
 			{
 				if (!was_ith_feature_invertible(idx_feat))
 					continue;
 
-				vector_f_t delta_feat = vector_f_t(  out_deltas_feats + idx_feat * HESS_f::matrix_t::RowsAtCompileTime );
+				vector_f_t delta_feat = vector_f_t(  m_deltas_feats + idx_feat * HESS_f::matrix_t::RowsAtCompileTime );
 				vector_f_t grad_df    = vector_f_t(this->minus_grad_f + idx_feat * HESS_f::matrix_t::RowsAtCompileTime );
 
+				// g_reduced = -g_l - \Sum H^t_pi_lk * delta_Ap_i
+				const typename TInfoPerHfBlock::HApf_blocks_t &blocks = m_Hf_blocks_info[idx_feat].sym_HApf_blocks;
+				for (size_t k=0;k<blocks.size();k++)
+				{
+					const vector_Ap_t delta_idx_Ap = vector_Ap_t(m_deltas_Ap + blocks[k].first * HESS_Ap::matrix_t::RowsAtCompileTime );
+					grad_df.noalias() -= blocks[k].second->transpose() * delta_idx_Ap;
+				}
+
 				//std::cout  << grad_df.transpose() << std::endl << m_Hf_blocks_info[idx_feat].num_Hf_diag_blocks_inverses << std::endl << std::endl;
 
 				delta_feat = (m_Hf_blocks_info[idx_feat].num_Hf_diag_blocks_inverses * grad_df);
 			}
+		}
 
-		} // end of numeric_solve_for_features
-
-
-		bool was_ith_feature_invertible(const size_t i) const { return m_Hf_blocks_info[i].num_Hf_diag_blocks_invertible; }
-
-	private:
 		// ----------- Input data ------------------
 		HESS_Ap    HAp_original;  // (Copy of the numerical values of HAp)
 		HESS_Ap  & HAp;  // Column compressed
@@ -326,6 +369,11 @@ namespace mrpt { namespace srba {
 		const size_t nUnknowns_Ap;
 		const size_t nUnknowns_f;
 		size_t nHf_invertible_blocks; //!< for stats, the number of Hf diagonal blocks which are not rank-deficient.
+		const bool m_parallel;
+		// Arguments of the numeric step in progress:
+		double   m_lambda;
+		double * m_deltas_Ap;
+		double * m_deltas_feats;
 		// -----------------------------------------
 		typedef typename Eigen::Map<Eigen::Matrix<double,HESS_Ap::matrix_t::RowsAtCompileTime,1> > vector_Ap_t;
 		typedef typename Eigen::Map<Eigen::Matrix<double,HESS_f::matrix_t::RowsAtCompileTime,1> > vector_f_t;
@@ -336,6 +384,8 @@ namespace mrpt { namespace srba {
 			const typename HESS_f::matrix_t * sym_Hf_diag_blocks;
 			typename HESS_f::matrix_t         num_Hf_diag_blocks_inverses;
 			bool                              num_Hf_diag_blocks_invertible; //!< Whether \a num_Hf_diag_blocks_inverses could be generated
+			typedef std::vector<std::pair<size_t,const typename HESS_Apf::matrix_t*> > HApf_blocks_t;
+			HApf_blocks_t                     sym_HApf_blocks; //!< The blocks H_{p_i,l_k} of this feature (in HApf), with their "i" in ascending order
 
 			TInfoPerHfBlock() : sym_Hf_diag_blocks(NULL), num_Hf_diag_blocks_invertible(false) { }
 
@@ -26,28 +26,35 @@ void RbaEngine<KF2KF_POSE_TYPE,LM_TYPE,OBS_TYPE,RBA_OPTIONS>::create_complete_sp
 {
 	span_tree.clear();
 
-	set<TKeyFrameID>   visited;
-	queue<TKeyFrameID> pending;
-	map<TKeyFrameID,TBFSEntryEdges>    preceding;
+	// Visited flags, indexed by KF ID. All entries are "false" between calls.
+	std::vector<bool> & visited = aux_ws ? *aux_ws : m_complete_st_ws;
+	if (visited.size()<rba_state.keyframes.size())
+		visited.resize(rba_state.keyframes.size(), false);
+
+	// The BFS queue, which also keeps all visited KFs (and their depths) for resetting "visited" at the end:
+	std::vector<std::pair<TKeyFrameID,topo_dist_t> > pending;
 
 	// ----------------------------------------------------------------------------------------------------------------
-	// (1) Do a BFS to build a spanning tree, storing the shortest path and its depth for each KF within max_depth:
+	// Do a BFS to build a spanning tree with the shortest path to each KF within max_depth. Since KFs are visited
+	//  by increasing depth, the pose of each new KF can be composed right away from that of its parent.
 	// ----------------------------------------------------------------------------------------------------------------
 	// Insert:
-	pending.push(root_id);
-	visited.insert(root_id);
-	preceding[root_id].dist = 0;
+	ASSERT_BELOW_(root_id, rba_state.keyframes.size())
+	pending.push_back( std::make_pair(root_id, static_cast<topo_dist_t>(0)) );
+	visited[root_id] = true;
+	span_tree[ root_id ].pose = pose_t(); // Root: origin.
 
-	while (!pending.empty())
+	for (size_t q=0;q<pending.size();q++)
 	{
-		const TKeyFrameID next_kf = pending.front();
-		pending.pop();
-
-		const topo_dist_t cur_dist = preceding[next_kf].dist;
+		const TKeyFrameID next_kf  = pending[q].first;
+		const topo_dist_t cur_dist = pending[q].second;
 
 		if (cur_dist>=max_depth)
 			continue;
 
+		// The pose of the parent KF:
+		const pose_t & parent_pose = span_tree[ next_kf ].pose;
+
 		// Get all connections of this node:
 		ASSERTDEB_(next_kf < rba_state.keyframes.size())
 		const keyframe_info & kfi = rba_state.keyframes[next_kf];
@@ -56,74 +63,34 @@ void RbaEngine<KF2KF_POSE_TYPE,LM_TYPE,OBS_TYPE,RBA_OPTIONS>::create_complete_sp
 		{
 			const k2k_edge_t* ed = kfi.adjacent_k2k_edges[i];
 			const TKeyFrameID new_kf = getTheOtherFromPair2(next_kf, *ed);
-			if (!visited.count(new_kf))
+			if (!visited[new_kf])
 			{
-				pending.push(new_kf);
-				visited.insert(new_kf);
+				pending.push_back( std::make_pair(new_kf, cur_dist+1) );
+				visited[new_kf] = true;
 
-				TBFSEntryEdges & p = preceding[new_kf];
+				// A ref to the placeholder for its pose:
+				pose_t & new_pose = span_tree[ new_kf ].pose;
 
-				if (p.dist>cur_dist+1)
+				// Is the edge direct or inverted?
+				if (ed->to==new_kf)
 				{
-					p.dist = cur_dist+1;
-					p.prev = next_kf;
-					p.edge = ed;
+					// Edge: parent -> new
+					//  "inv_pose" in edge is really the inverse pose of new w.r.t. its parent:
+					new_pose.composeFrom(parent_pose,  -ed->inv_pose );
+				}
+				else
+				{
+					// Edge: new -> parent
+					//  "inv_pose" in edge is directly the pose of new w.r.t. its parent:
+					new_pose.composeFrom(parent_pose, ed->inv_pose );
 				}
 			}
 		}
 	}
 
-	// ----------------------------------------------------------------------------------------------------------------
-	// (2) Sort all KFs in range by hiearchy, i.e. by increasing depth:
-	// ----------------------------------------------------------------------------------------------------------------
-	multimap<topo_dist_t,pair<TKeyFrameID,TBFSEntryEdges> >  kfs_by_depth;
-
-	for (typename map<TKeyFrameID,TBFSEntryEdges>::const_iterator it=preceding.begin();it!=preceding.end();++it)
-		kfs_by_depth.insert( make_pair( it->second.dist, *it ) );
-
-
-	// ----------------------------------------------------------------------------------------------------------------
-	// (3) Construct the pose of each KF by composing the poses along the tree, from the root to the leaves:
-	// ----------------------------------------------------------------------------------------------------------------
-	for (typename multimap<topo_dist_t,pair<TKeyFrameID,TBFSEntryEdges> >::const_iterator it=kfs_by_depth.begin();it!=kfs_by_depth.end();++it)
-	{
-		const topo_dist_t  kf_depth = it->first;
-		const TKeyFrameID  kf_id    = it->second.first;
-		const TBFSEntryEdges  & bfs_data = it->second.second;
-
-
-		if (kf_depth==0)
-		{
-			// Root:
-			span_tree[ kf_id ].pose = pose_t(); // Default: origin.
-		}
-		else
-		{
-			// All leaves:
-			ASSERT_(bfs_data.edge!=NULL)
-
-			// The pose of my parent KF:
-			const pose_t & parent_pose = span_tree[ bfs_data.prev ].pose;
-
-			// A ref to the placeholder for my pose:
-			pose_t & my_pose = span_tree[ kf_id ].pose;
-
-			// Is the edge direct or inverted?
-			if (bfs_data.edge->to==kf_id)
-			{
-				// Edge: parent -> me
-				//  "inv_pose" in edge is really the inverse pose of me w.r.t. my parent:
-				my_pose.composeFrom(parent_pose,  -bfs_data.edge->inv_pose );
-			}
-			else
-			{
-				// Edge: me -> parent
-				//  "inv_pose" in edge is directly the pose of me w.r.t. my parent:
-				my_pose.composeFrom(parent_pose, bfs_data.edge->inv_pose );
-			}
-		}
-	}
-
+	// Leave the working space ready for the next call:
+	for (size_t q=0;q<pending.size();q++)
+		visited[ pending[q].first ] = false;
 }
 
 
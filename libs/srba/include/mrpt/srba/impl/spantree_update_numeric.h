@@ -37,34 +37,11 @@ size_t TRBA_Problem_state<KF2KF_POSE_TYPE,LM_TYPE,OBS_TYPE,RBA_OPTIONS>::TSpanni
 			continue;
 
 		// Go recompute this pose:
-		const k2k_edge_vector_t &ev = itE->second;
-
-		// Accumulate inverse poses in the order established by the path:
 		pose_t accum;
-		TKeyFrameID curKF = id_from;
-
 #if UPDATE_NUM_ST_VERBOSE
 		std::cout << "ST.NUM["<<id_from<<"]["<<id_to<<"] : ";
 #endif
-		for (size_t k=0;k<ev.size();k++)
-		{
-			if(ev[k]->to==curKF)  // Inverse poses means we should face all arcs by the "head" (arrow) side
-			{
-				accum.composeFrom(accum, ev[k]->inv_pose );
-				curKF = ev[k]->from;
-#if UPDATE_NUM_ST_VERBOSE
-				std::cout << "->"<<curKF;
-#endif
-			}
-			else
-			{
-				accum.composeFrom(accum, -ev[k]->inv_pose );  // unary "-" operator inverts SE(3) poses
-				curKF = ev[k]->to;
-#if UPDATE_NUM_ST_VERBOSE
-				std::cout << "<-"<<curKF;
-#endif
-			}
-		}
+		compose_path_poses(id_from, itE->second, accum);
 
 		// Save in map:
 		i2j.pose = accum;
@@ -82,6 +59,37 @@ size_t TRBA_Problem_state<KF2KF_POSE_TYPE,LM_TYPE,OBS_TYPE,RBA_OPTIONS>::TSpanni
 	return it->second.size();
 }
 
+/** Composes the inverse poses of the edges in a path starting at "id_from" */
+template <class KF2KF_POSE_TYPE,class LM_TYPE,class OBS_TYPE,class RBA_OPTIONS>
+void TRBA_Problem_state<KF2KF_POSE_TYPE,LM_TYPE,OBS_TYPE,RBA_OPTIONS>::TSpanningTree::compose_path_poses(
+	const TKeyFrameID id_from,
+	const k2k_edge_vector_t &ev,
+	pose_t &accum)
+{
+	// Accumulate inverse poses in the order established by the path:
+	TKeyFrameID curKF = id_from;
+
+	for (size_t k=0;k<ev.size();k++)
+	{
+		if(ev[k]->to==curKF)  // Inverse poses means we should face all arcs by the "head" (arrow) side
+		{
+			accum.composeFrom(accum, ev[k]->inv_pose );
+			curKF = ev[k]->from;
+#if UPDATE_NUM_ST_VERBOSE
+			std::cout << "->"<<curKF;
+#endif
+		}
+		else
+		{
+			accum.composeFrom(accum, -ev[k]->inv_pose );  // unary "-" operator inverts SE(3) poses
+			curKF = ev[k]->to;
+#if UPDATE_NUM_ST_VERBOSE
+			std::cout << "<-"<<curKF;
+#endif
+		}
+	}
+}
+
 template <class KF2KF_POSE_TYPE,class LM_TYPE,class OBS_TYPE,class RBA_OPTIONS>
 void setAllNumericToGarbage(typename TRBA_Problem_state<KF2KF_POSE_TYPE,LM_TYPE,OBS_TYPE,RBA_OPTIONS>::TSpanningTree &st)
 {
@@ -134,4 +142,54 @@ size_t TRBA_Problem_state<KF2KF_POSE_TYPE,LM_TYPE,OBS_TYPE,RBA_OPTIONS>::TSpanni
 	return pose_count;
 }
 
+template <class KF2KF_POSE_TYPE,class LM_TYPE,class OBS_TYPE,class RBA_OPTIONS>
+void TRBA_Problem_state<KF2KF_POSE_TYPE,LM_TYPE,OBS_TYPE,RBA_OPTIONS>::TSpanningTree::get_outdated_numeric_poses(
+	const std::set<TKeyFrameID> & kfs_to_update,
+	numeric_poses_to_update_t & out_poses)
+{
+	out_poses.clear();
+	for (std::set<TKeyFrameID>::const_iterator it=kfs_to_update.begin();it!=kfs_to_update.end();++it)
+	{
+		typename all_edges_maps_t::const_iterator it_edge=sym.all_edges.find( *it );
+		if (it_edge==sym.all_edges.end())
+			continue;
+
+		const TKeyFrameID id_from = it_edge->first;
+		frameid2pose_map_t &frameid2pose_map = num[id_from];   // O(1) with map_as_vector
+
+		for (typename std::map<TKeyFrameID, k2k_edge_vector_t >::const_iterator itE = it_edge->second.begin();itE != it_edge->second.end();++itE)
+		{
+			const TKeyFrameID id_to   = itE->first;
+
+			TNumericPoseToUpdate p;
+			p.id_from = id_from;
+			p.path    = &itE->second;
+			p.i2j     = &frameid2pose_map[id_to];
+			p.j2i     = &num[id_to][id_from];  // O(1) with map_as_vector
+
+			if (!p.i2j->updated || !p.j2i->updated)
+				out_poses.push_back(p);
+		}
+	}
+}
+
+template <class KF2KF_POSE_TYPE,class LM_TYPE,class OBS_TYPE,class RBA_OPTIONS>
+size_t TRBA_Problem_state<KF2KF_POSE_TYPE,LM_TYPE,OBS_TYPE,RBA_OPTIONS>::TSpanningTree::update_numeric(const numeric_poses_to_update_t & poses)
+{
+	for (size_t i=0;i<poses.size();i++)
+	{
+		const TNumericPoseToUpdate &p = poses[i];
+
+		pose_t accum;
+		compose_path_poses(p.id_from, *p.path, accum);
+
+		p.i2j->pose = accum;
+		p.i2j->updated = true;
+
+		p.j2i->pose = -accum;
+		p.j2i->updated = true;
+	}
+	return poses.size();
+}
+
 } } // end NS
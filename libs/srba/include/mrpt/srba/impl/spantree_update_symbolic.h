@@ -32,6 +32,9 @@ void TRBA_Problem_state<KF2KF_POSE_TYPE,LM_TYPE,OBS_TYPE,RBA_OPTIONS>::TSpanning
 	// can rebuild their "all_edges" lists.
 	std::set<TPairKeyFrameID> kfs_with_modified_next_edge;
 
+	// Working space reused by all the BFS searches below:
+	bfs_workspace_t bfs_ws;
+
 	// Generic algorithm for 1 or more new edges at once from the new_kf_id to the rest of the graph:
 	// -----------------------------------------------------------------------------------------------
 	// The first edge was already introduced in the STs above. Go on with the rest:
@@ -203,7 +206,9 @@ cout << "ST: New path ST["<<s<<"]["<<r<<"].N ="<<(ste_s2ik ? ste_s2ik->next : ne
 				bool found = m_parent->find_path_bfs(
 					ft.first, // from
 					ft.second, // target node
-					&found_path);
+					&found_path,
+					NULL,
+					&bfs_ws);
 
 				ASSERT_(found && !found_path.empty())
 
@@ -242,7 +247,9 @@ cout << "ST: New path ST["<<s<<"]["<<r<<"].N ="<<(ste_s2ik ? ste_s2ik->next : ne
 #endif
 
 	// Update "all_edges" --------------------------------------------
-	// Only for those who were really modified.
+	// Only for those who were really modified. Both (i,j) and (j,i) are usually marked, but they
+	// share the same entry all_edges[max(i,j)][min(i,j)], so build the list of unique paths first:
+	std::set<TPairKeyFrameID> paths_to_rebuild;
 	for (std::set<TPairKeyFrameID>::const_iterator it=kfs_with_modified_next_edge.begin();it!=kfs_with_modified_next_edge.end();++it)
 	{
 		const TKeyFrameID kf_id = it->first;
@@ -250,19 +257,22 @@ cout << "ST: New path ST["<<s<<"]["<<r<<"].N ="<<(ste_s2ik ? ste_s2ik->next : ne
 
 		std::map<TKeyFrameID,TSpanTreeEntry>::const_iterator it2=Ds.find(it->second);
 		ASSERT_(it2!=Ds.end())
-		
 
 		const TKeyFrameID dst_kf_id = it2->first;
 
-		const TKeyFrameID from = std::max(dst_kf_id, kf_id);
-		const TKeyFrameID to   = std::min(dst_kf_id, kf_id);
+		paths_to_rebuild.insert( TPairKeyFrameID( std::max(dst_kf_id, kf_id), std::min(dst_kf_id, kf_id) ) );
+	}
+
+	for (std::set<TPairKeyFrameID>::const_iterator it=paths_to_rebuild.begin();it!=paths_to_rebuild.end();++it)
+	{
+		const TKeyFrameID from = it->first;
+		const TKeyFrameID to   = it->second;
 
 		// find_path_bfs
 		typename kf2kf_pose_traits<KF2KF_POSE_TYPE>::k2k_edge_vector_t & path = sym.all_edges[from][to];  // O(1) in map_as_vector
-		path.clear();
-		bool path_found = m_parent->find_path_bfs(from,to, NULL, &path);
+		bool path_found = m_parent->find_path_bfs(from,to, NULL, &path, &bfs_ws);
 		ASSERT_(path_found)
-	} // end for each "kfs_with_modified_next_edge"
+	} // end for each "paths_to_rebuild"
 
 
 #if defined(SYM_ST_EXTRA_SECURITY_CHECKS)
@@ -285,17 +295,6 @@ cout << "ST: New path ST["<<s<<"]["<<r<<"].N ="<<(ste_s2ik ? ste_s2ik->next : ne
 #endif
 }
 
-template <class k2k_edge_t>
-struct TBFSEntry
-{
-	TBFSEntry() : prev_edge(NULL),dist( std::numeric_limits<topo_dist_t>::max() )
-	{}
-
-	TKeyFrameID prev;
-	k2k_edge_t *prev_edge;
-	topo_dist_t dist;
-};
-
 // Aux. function for "check_all_obs_are_connected":
 //  Breadth-first search (BFS) for "trg_node"
 //  Return: true: found
@@ -304,48 +303,53 @@ bool TRBA_Problem_state<KF2KF_POSE_TYPE,LM_TYPE,OBS_TYPE,RBA_OPTIONS>::find_path
 	const TKeyFrameID           cur_node,
 	const TKeyFrameID           trg_node,
 	std::vector<TKeyFrameID>  * out_path_IDs,
-	typename kf2kf_pose_traits<KF2KF_POSE_TYPE>::k2k_edge_vector_t * out_path_edges ) const
+	typename kf2kf_pose_traits<KF2KF_POSE_TYPE>::k2k_edge_vector_t * out_path_edges,
+	bfs_workspace_t           * aux_ws ) const
 {
 	if (out_path_IDs) out_path_IDs->clear();
 	if (out_path_edges) out_path_edges->clear();
 	if (cur_node==trg_node) return true; // No need to do any search...
 
-	std::set<TKeyFrameID>   visited;
-	std::queue<TKeyFrameID> pending;
-	std::map<TKeyFrameID,TBFSEntry<k2k_edge_t> >    preceding;
+	// The BFS data of each KF is kept in a flat vector indexed by KF IDs (instead of maps and sets), and
+	// "bfs_queue" holds all the visited KFs, in order, so only their entries have to be reset at the end.
+	bfs_workspace_t tmp_ws;
+	bfs_workspace_t & ws = aux_ws ? *aux_ws : tmp_ws;
+	std::vector<TBFSEntry<k2k_edge_t> > & bfs_ws    = ws.entries;
+	std::vector<TKeyFrameID>            & bfs_queue = ws.queue;
+
+	ASSERTDEB_(cur_node < keyframes.size())
+	if (bfs_ws.size()<keyframes.size())
+		bfs_ws.resize(keyframes.size());
+	bfs_queue.clear();
 
 	// Insert:
-	pending.push(cur_node);
-	visited.insert(cur_node);
-	preceding[cur_node].dist = 0;
+	bfs_queue.push_back(cur_node);
+	bfs_ws[cur_node].dist = 0;
 
-	while (!pending.empty())
+	bool found = false;
+	for (size_t q=0;q<bfs_queue.size();q++)
 	{
-		const TKeyFrameID next_kf = pending.front();
-		pending.pop();
-
-		TBFSEntry<k2k_edge_t> & bfs_data_next = preceding[next_kf];
-		const topo_dist_t cur_dist = bfs_data_next.dist;
+		const TKeyFrameID next_kf = bfs_queue[q];
+		const topo_dist_t cur_dist = bfs_ws[next_kf].dist;
 
 		if (next_kf==trg_node)
 		{
 			// Path found: go thru the path in inverse order:
-			topo_dist_t  dist = bfs_data_next.dist;
+			topo_dist_t  dist = cur_dist;
 			if (out_path_IDs) out_path_IDs->resize(dist);
 			if (out_path_edges) out_path_edges->resize(dist);
 			TKeyFrameID path_node = trg_node;
 			while (path_node != cur_node)
 			{
-				ASSERT_(dist>=0)
-				if (out_path_IDs) (*out_path_IDs)[--dist] = path_node;
-
-				typename std::map<TKeyFrameID,TBFSEntry<k2k_edge_t> >::const_iterator it_prec = preceding.find(path_node);
-				ASSERT_(it_prec != preceding.end())
-				path_node = it_prec->second.prev;
-
-				if (out_path_edges) (*out_path_edges)[--dist] = it_prec->second.prev_edge;
+				ASSERT_(dist>0)
+				--dist;
+				const TBFSEntry<k2k_edge_t> & prec = bfs_ws[path_node];
+				if (out_path_IDs) (*out_path_IDs)[dist] = path_node;
+				if (out_path_edges) (*out_path_edges)[dist] = prec.prev_edge;
+				path_node = prec.prev;
 			}
-			return true; // End of search
+			found = true; // End of search
+			break;
 		}
 
 		// Get all connections of this node:
@@ -356,23 +360,22 @@ bool TRBA_Problem_state<KF2KF_POSE_TYPE,LM_TYPE,OBS_TYPE,RBA_OPTIONS>::find_path
 		{
 			const k2k_edge_t* ed = kfi.adjacent_k2k_edges[i];
 			const TKeyFrameID new_kf = getTheOtherFromPair2(next_kf, *ed);
-			if (!visited.count(new_kf))
-			{
-				pending.push(new_kf);
-				visited.insert(new_kf);
-
-				TBFSEntry<k2k_edge_t> & p = preceding[new_kf];
-
-				if (p.dist>cur_dist+1)
-				{
-					p.dist = cur_dist+1;
-					p.prev = next_kf;
-					p.prev_edge = const_cast<k2k_edge_t*>(ed);
-				}
+			TBFSEntry<k2k_edge_t> & p = bfs_ws[new_kf];
+			if (p.dist==std::numeric_limits<topo_dist_t>::max())
+			{	// Not visited yet:
+				bfs_queue.push_back(new_kf);
+				p.dist = cur_dist+1;
+				p.prev = next_kf;
+				p.prev_edge = const_cast<k2k_edge_t*>(ed);
 			}
 		}
 	}
-	return false; // No path found.
+
+	// Leave the working space ready for the next call:
+	for (size_t q=0;q<bfs_queue.size();q++)
+		bfs_ws[ bfs_queue[q] ] = TBFSEntry<k2k_edge_t>();
+
+	return found;
 }
 
 } } // end NS
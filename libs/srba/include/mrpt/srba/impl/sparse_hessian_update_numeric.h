@@ -9,54 +9,85 @@
 
 #pragma once
 
+#include <mrpt/system/parallelization.h>
 
 namespace mrpt { namespace srba {
 
-/** Rebuild the Hessian symbolic information from the internal pointers to blocks of Jacobians.
-	*  Only the upper triangle is filled-in (all what is needed for Cholesky) for square Hessians, in whole for rectangular ones (it depends on the symbolic decomposition, done elsewhere).
-	* \tparam SPARSEBLOCKHESSIAN can be: TSparseBlocksHessian_6x6, TSparseBlocksHessian_3x3 or TSparseBlocksHessian_6x3
-	* \return The number of Jacobian multiplications skipped due to its observation being marked as "invalid"
-	*/
-template <class KF2KF_POSE_TYPE,class LM_TYPE,class OBS_TYPE,class RBA_OPTIONS>
-template <class SPARSEBLOCKHESSIAN>
-size_t RbaEngine<KF2KF_POSE_TYPE,LM_TYPE,OBS_TYPE,RBA_OPTIONS>::sparse_hessian_update_numeric( SPARSEBLOCKHESSIAN & H ) const
+namespace internal
 {
-	size_t nInvalid = 0;
-	const size_t nUnknowns = H.getColCount();
-	for (size_t i=0;i<nUnknowns;i++)
+	/** Body for mrpt::system::parallel_reduce(): updates the numeric values of a range of columns of a sparse Hessian, counting the skipped Jacobians.
+	  *  Used in RbaEngine::sparse_hessian_update_numeric() */
+	template <class RBA_OPTIONS,class SPARSEBLOCKHESSIAN>
+	struct THessianNumericUpdater
 	{
-		typename SPARSEBLOCKHESSIAN::col_t & col = H.getCol(i);
+		SPARSEBLOCKHESSIAN & H;
+		const typename RBA_OPTIONS::obs_noise_matrix_t::parameters_t & obs_noise;
+		size_t nInvalid;
 
-		for (typename SPARSEBLOCKHESSIAN::col_t::iterator it=col.begin();it!=col.end();++it)
-		{
-			typename SPARSEBLOCKHESSIAN::TEntry & entry = it->second;
-
-			// Compute: Hij = \Sum_k  J_{ki}^t * \Lambda_k *  J_{kj}
+		THessianNumericUpdater(SPARSEBLOCKHESSIAN & H_, const typename RBA_OPTIONS::obs_noise_matrix_t::parameters_t & obs_noise_) :
+			H(H_), obs_noise(obs_noise_), nInvalid(0)
+		{ }
+		THessianNumericUpdater(THessianNumericUpdater &o, mrpt::system::Split) :
+			H(o.H), obs_noise(o.obs_noise), nInvalid(0)
+		{ }
 
-			typename SPARSEBLOCKHESSIAN::matrix_t Hij;
-			Hij.setZero();
-			//const size_t nJacobs = entry.sym.lst_jacob_blocks.size();
-			//for (size_t k=0;k<nJacobs;k++)
-			const typename SPARSEBLOCKHESSIAN::symbolic_t::list_jacob_blocks_t::const_iterator itJ_end = entry.sym.lst_jacob_blocks.end();
-			for (typename SPARSEBLOCKHESSIAN::symbolic_t::list_jacob_blocks_t::const_iterator itJ = entry.sym.lst_jacob_blocks.begin(); itJ!=itJ_end; ++itJ)
+		void operator()(const mrpt::system::BlockedRange &r)
+		{
+			for (int i=r.begin();i<r.end();i++)
 			{
-				const typename SPARSEBLOCKHESSIAN::symbolic_t::THessianSymbolicInfoEntry & sym_k = *itJ;
+				typename SPARSEBLOCKHESSIAN::col_t & col = H.getCol(i);
 
-				if (*sym_k.J1_valid && *sym_k.J2_valid)
+				for (typename SPARSEBLOCKHESSIAN::col_t::iterator it=col.begin();it!=col.end();++it)
 				{
-					// Accumulate Hessian sub-blocks:
-					RBA_OPTIONS::obs_noise_matrix_t::template accum_JtJ(Hij, *sym_k.J1, *sym_k.J2, sym_k.obs_idx, this->parameters.obs_noise );
-				}
-				else nInvalid++;
-			}
+					typename SPARSEBLOCKHESSIAN::TEntry & entry = it->second;
+
+					// Compute: Hij = \Sum_k  J_{ki}^t * \Lambda_k *  J_{kj}
+
+					typename SPARSEBLOCKHESSIAN::matrix_t Hij;
+					Hij.setZero();
+					const typename SPARSEBLOCKHESSIAN::symbolic_t::list_jacob_blocks_t::const_iterator itJ_end = entry.sym.lst_jacob_blocks.end();
+					for (typename SPARSEBLOCKHESSIAN::symbolic_t::list_jacob_blocks_t::const_iterator itJ = entry.sym.lst_jacob_blocks.begin(); itJ!=itJ_end; ++itJ)
+					{
+						const typename SPARSEBLOCKHESSIAN::symbolic_t::THessianSymbolicInfoEntry & sym_k = *itJ;
 
-			// Do scaling (if applicable):
-			RBA_OPTIONS::obs_noise_matrix_t::template scale_H(Hij, this->parameters.obs_noise );
+						if (*sym_k.J1_valid && *sym_k.J2_valid)
+						{
+							// Accumulate Hessian sub-blocks:
+							RBA_OPTIONS::obs_noise_matrix_t::template accum_JtJ(Hij, *sym_k.J1, *sym_k.J2, sym_k.obs_idx, obs_noise );
+						}
+						else nInvalid++;
+					}
 
-			entry.num = Hij;
+					// Do scaling (if applicable):
+					RBA_OPTIONS::obs_noise_matrix_t::template scale_H(Hij, obs_noise );
+
+					entry.num = Hij;
+				}
+			}
+		}
+		void join(THessianNumericUpdater &o)
+		{
+			nInvalid += o.nInvalid;
 		}
-	}
-	return nInvalid;
+	};
+} // end NS internal
+
+/** Rebuild the Hessian symbolic information from the internal pointers to blocks of Jacobians.
+	*  Only the upper triangle is filled-in (all what is needed for Cholesky) for square Hessians, in whole for rectangular ones (it depends on the symbolic decomposition, done elsewhere).
+	*  Columns are updated in parallel if RBA_OPTIONS::solver_t::PARALLEL is true (see mrpt::srba::options::solver_parallel).
+	* \tparam SPARSEBLOCKHESSIAN can be: TSparseBlocksHessian_6x6, TSparseBlocksHessian_3x3 or TSparseBlocksHessian_6x3
+	* \return The number of Jacobian multiplications skipped due to its observation being marked as "invalid"
+	*/
+template <class KF2KF_POSE_TYPE,class LM_TYPE,class OBS_TYPE,class RBA_OPTIONS>
+template <class SPARSEBLOCKHESSIAN>
+size_t RbaEngine<KF2KF_POSE_TYPE,LM_TYPE,OBS_TYPE,RBA_OPTIONS>::sparse_hessian_update_numeric( SPARSEBLOCKHESSIAN & H ) const
+{
+	const int nUnknowns = static_cast<int>(H.getColCount());
+	internal::THessianNumericUpdater<RBA_OPTIONS,SPARSEBLOCKHESSIAN> updater(H, this->parameters.obs_noise);
+	if (RBA_OPTIONS::solver_t::PARALLEL)
+			mrpt::system::parallel_reduce( mrpt::system::BlockedRange(0,nUnknowns,8), updater );
+	else	updater( mrpt::system::BlockedRange(0,nUnknowns) );
+	return updater.nInvalid;
 } // end of sparse_hessian_update_numeric
 
 } } // end NS
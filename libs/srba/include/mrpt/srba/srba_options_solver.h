@@ -25,6 +25,7 @@ namespace options
 		{
 			static const bool USE_SCHUR      = true;
 			static const bool DENSE_CHOLESKY = true;
+			static const bool PARALLEL       = false; //!< See solver_parallel
 			/** Extra output information to be found in RbaEngine<>::TOptimizeExtraOutputInfo::extra_results */
 			struct extra_results_t
 			{
@@ -44,6 +45,7 @@ namespace options
 		{
 			static const bool USE_SCHUR      = true;
 			static const bool DENSE_CHOLESKY = false;
+			static const bool PARALLEL       = false; //!< See solver_parallel
 			/** Extra output information to be found in RbaEngine<>::TOptimizeExtraOutputInfo::extra_results */
 			struct extra_results_t
 			{
@@ -63,6 +65,7 @@ namespace options
 		{
 			static const bool USE_SCHUR      = false;
 			static const bool DENSE_CHOLESKY = false;
+			static const bool PARALLEL       = false; //!< See solver_parallel
 			/** Extra output information to be found in RbaEngine<>::TOptimizeExtraOutputInfo::extra_results */
 			struct extra_results_t
 			{
@@ -75,4 +78,14 @@ namespace options
 			};
 		};
 
+		/** Usage: A possible type for RBA_OPTIONS::solver_t, wrapping any of the other solvers (e.g. <code>solver_parallel<solver_LM_schur_dense_cholesky></code>).
+		  * Meaning: The same solver, but the numeric Hessian blocks (RbaEngine::sparse_hessian_update_numeric()) and the Schur complement (SchurComplement)
+		  *  are evaluated in parallel (see mrpt::system::parallel_for). Results are exactly the same than with the serial version.
+		  * \ingroup mrpt_srba_options_solver */
+		template <class SOLVER>
+		struct solver_parallel : public SOLVER
+		{
+			static const bool PARALLEL       = true;
+		};
+
 } } } // End of namespaces
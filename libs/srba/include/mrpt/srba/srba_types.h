@@ -87,7 +87,7 @@ namespace srba
 			EIGEN_MAKE_ALIGNED_OPERATOR_NEW    // Needed because we have fixed-length Eigen matrices (within CPose3D)
 		};
 
-		typedef std::deque<k2k_edge_t*>  k2k_edge_vector_t; //!< A sequence of edges (a "path")
+		typedef std::vector<k2k_edge_t*>  k2k_edge_vector_t; //!< A sequence of edges (a "path"). A plain vector, since there are lots of these short paths in the spanning trees
 	}; // end of kf2kf_pose_traits
 
 	/** The argument "LM_TRAITS" can be any of those defined in srba/models/landmarks.h (typically, either landmarks::Euclidean3D or landmarks::Euclidean2D).
@@ -447,8 +447,8 @@ namespace srba
 		/** Information per key-frame needed for RBA */
 		struct keyframe_info
 		{
-			std::deque<k2k_edge_t*>  adjacent_k2k_edges;
-			std::deque<k2f_edge_t*>  adjacent_k2f_edges;
+			std::vector<k2k_edge_t*>  adjacent_k2k_edges;
+			std::vector<k2f_edge_t*>  adjacent_k2f_edges;
 		};
 
 	}; // end of "rba_joint_parameterization_traits_t"
@@ -461,6 +461,26 @@ namespace srba
 		topo_dist_t distance; //!< Remaining distance until the given target from this point.
 	};
 
+	/** Used in TRBA_Problem_state::find_path_bfs() */
+	template <class k2k_edge_t>
+	struct TBFSEntry
+	{
+		TBFSEntry() : prev_edge(NULL),dist( std::numeric_limits<topo_dist_t>::max() )
+		{}
+
+		TKeyFrameID prev;
+		k2k_edge_t *prev_edge;
+		topo_dist_t dist;
+	};
+
+	/** Working space for TRBA_Problem_state::find_path_bfs(), reusable between succesive calls */
+	template <class k2k_edge_t>
+	struct TBFSWorkspace
+	{
+		std::vector<TBFSEntry<k2k_edge_t> > entries; //!< Indexed by keyframe ID (all entries are kept in their default state between calls)
+		std::vector<TKeyFrameID>            queue;   //!< The visited keyframes, in order
+	};
+
 	/** All the important data of a RBA problem at any given instant of time
 	  *  Operations on this structure are performed via the public API of srba::RbaEngine
 	  * \sa RbaEngine
@@ -577,6 +597,28 @@ namespace srba
 			  */
 			size_t update_numeric_only_all_from_node( const typename all_edges_maps_t::const_iterator & it,bool skip_marked_as_uptodate = false);
 
+			/** One pose in \a num (together with its inverse) and the path in \a sym.all_edges to recompute it from. \sa get_outdated_numeric_poses */
+			struct TNumericPoseToUpdate
+			{
+				TKeyFrameID               id_from;
+				const k2k_edge_vector_t * path;
+				pose_flag_t             * i2j;
+				pose_flag_t             * j2i;
+			};
+			typedef std::vector<TNumericPoseToUpdate> numeric_poses_to_update_t;
+
+			/** Makes a list with the poses (from any of the IDs in the passed set) which are now marked as outdated, so they can be later recomputed
+			  * many times with update_numeric(const numeric_poses_to_update_t&) without going again thru all the other poses. */
+			void get_outdated_numeric_poses(const std::set<TKeyFrameID> & kfs_to_update, numeric_poses_to_update_t & out_poses);
+
+			/** Updates the given numeric poses (see get_outdated_numeric_poses) and marks them as up-to-date.
+			  * \return The number of updated poses.
+			  */
+			size_t update_numeric(const numeric_poses_to_update_t & poses);
+
+			/** Composes the inverse poses of the edges in a path starting at "id_from", i.e. the pose of the other end of the path as seen from "id_from" */
+			static void compose_path_poses(const TKeyFrameID id_from, const k2k_edge_vector_t &ev, pose_t &accum);
+
 			/** @} */
 
 			/** @name Spanning tree misc. operations
@@ -650,6 +692,8 @@ namespace srba
 
 		/** @} */
 
+		typedef TBFSWorkspace<k2k_edge_t> bfs_workspace_t; //!< Working space for \a find_path_bfs()
+
 		/** Empties all members */
 		void clear() {
 			keyframes.clear();
@@ -672,13 +716,15 @@ namespace srba
 		  * Use only when the distance between nodes can be larger than the maximum depth of incrementally-built spanning trees
 		  * \param[in,out] out_path_IDs (Ignored if ==NULL) Just leave this vector uninitialized at input, it'll be automatically initialized to the right size and values.
 		  * \param[in,out] out_path_edges (Ignored if ==NULL) Just like out_path_IDs, but here you'll receive the list of traversed edges, instead of the IDs of the visited KFs.
+		  * \param[in,out] aux_ws Auxiliary working space: pass the same (initially empty) object to save memory allocations in succesive calls, or NULL to use a temporary one. Use one per thread if calling this method simultaneously from several threads.
 		  * \return false if no path was found.
 		  */
 		bool find_path_bfs(
 			const TKeyFrameID           from,
 			const TKeyFrameID           to,
 			std::vector<TKeyFrameID>  * out_path_IDs,
-			typename kf2kf_pose_traits<KF2KF_POSE_TYPE>::k2k_edge_vector_t * out_path_edges = NULL) const;
+			typename kf2kf_pose_traits<KF2KF_POSE_TYPE>::k2k_edge_vector_t * out_path_edges = NULL,
+			bfs_workspace_t           * aux_ws = NULL) const;
 
 
 		/** Computes stats on the degree (# of adjacent nodes) of all the nodes in the graph. Runs in O(N) with N=# of keyframes */
@@ -75,7 +75,8 @@ protected:
 	void test_schur_dense_vs_sparse(
 		const TGraphInitRandom  *init_random,
 		const TGraphInitManual  *init_manual,
-		const double lambda = 1e3 )
+		const double lambda = 1e3,
+		const bool parallel = false )
 	{
 		// A linear system object holds the sparse Jacobians for a set of observations.
 		my_rba_t::rba_problem_state_t::TLinearSystem  lin_system;
@@ -240,7 +241,8 @@ protected:
 			schur_compl(
 				HAp,Hf,HApf, // The different symbolic/numeric Hessian
 				&minus_grad[0],  // minus gradient of the Ap part
-				&minus_grad[idx_start_f]   // minus gradient of the features part
+				&minus_grad[idx_start_f],   // minus gradient of the features part
+				parallel
 				);
 
 		schur_compl.numeric_build_reduced_system(lambda);
@@ -362,3 +364,14 @@ TEST_F(SchurTests,DenseVsSparseCheck_5k2k_30k2f)
 		test_schur_dense_vs_sparse(&gir,NULL );
 	}
 }
+
+TEST_F(SchurTests,DenseVsSparseCheck_5k2k_30k2f_parallel)
+{
+	mrpt::system::setNumberOfParallelThreads(4);
+	for (uint32_t random_seed=1;random_seed<5;random_seed++)
+	{
+		TGraphInitRandom gir(random_seed, 5,30, 0.9 /* Probability of Obs. */);
+		test_schur_dense_vs_sparse(&gir,NULL, 1e3, true /* parallel */ );
+	}
+	mrpt::system::setNumberOfParallelThreads(0);
+}
@@ -10,6 +10,7 @@
 #include <mrpt/srba.h>
 #include <mrpt/base.h>
 #include <mrpt/random.h>
+#include <mrpt/system/parallelization.h>
 
 #include <gtest/gtest.h>
 
@@ -245,3 +246,91 @@ TEST(SpanTreeTests,LinearGraphsInv)        { run_spantree_topology(100);  }
 TEST(SpanTreeTests,LinearGraphsWithLoops)     { run_spantree_topology(1);  }
 TEST(SpanTreeTests,LinearGraphsWithLoopsInv)  { run_spantree_topology(101);  }
 
+
+
+// Body for mrpt::system::parallel_for(): runs find_path_bfs() for a range of source KFs, from several threads at once
+struct TFindPathsBody
+{
+	const my_rba_t & rba;
+	const size_t     nKFs;
+	std::vector<std::vector<std::vector<TKeyFrameID> > > & paths; // [src][dst]
+
+	TFindPathsBody(const my_rba_t &rba_, size_t nKFs_, std::vector<std::vector<std::vector<TKeyFrameID> > > &paths_) : rba(rba_),nKFs(nKFs_),paths(paths_) {}
+
+	void operator()(const mrpt::system::BlockedRange &r) const
+	{
+		for (int src=r.begin();src!=r.end();++src)
+			for (size_t dst=0;dst<nKFs;dst++)
+				rba.find_path_bfs(src,dst,paths[src][dst]);
+	}
+};
+
+// find_path_bfs() must return shortest paths, no matter whether it reuses a working space or runs simultaneously from several threads:
+TEST(SpanTreeTests,FindPathBFS)
+{
+	randomGenerator.randomize(1234);
+	my_rba_t::traits_t::new_kf_observations_t  dummy_obs; // Not used
+
+	my_rba_t rba;
+	rba.enable_time_profiler(false);
+	rba.parameters.srba.max_tree_depth = 2;
+
+	// Linear graph with loop closures:
+	const size_t nKFs = 60;
+	for (size_t kf=0;kf<nKFs;kf++)
+	{
+		const TKeyFrameID new_kf = rba.alloc_keyframe();
+		if (!new_kf) continue;
+
+		rba.create_kf2kf_edge(new_kf, TPairKeyFrameID(new_kf-1, new_kf), dummy_obs, mrpt::poses::CPose3D() );
+		if (new_kf>2 && randomGenerator.drawUniform(0,1)<0.1)
+		{
+			TKeyFrameID id;
+			randomGenerator.drawUniformUnsignedIntRange(id,0,new_kf-2);
+			if ( !rba.get_rba_state().are_keyframes_connected(id,new_kf) )
+				rba.create_kf2kf_edge(new_kf, TPairKeyFrameID(id, new_kf), dummy_obs, mrpt::poses::CPose3D() );
+		}
+	}
+
+	// Topological distances from each KF, as the smallest depth of a complete spanning tree which reaches the other KF:
+	std::vector<std::vector<size_t> > dists(nKFs, std::vector<size_t>(nKFs, std::numeric_limits<size_t>::max()) );
+	for (size_t src=0;src<nKFs;src++)
+		for (size_t depth=0;depth<nKFs;depth++)
+		{
+			my_rba_t::frameid2pose_map_t st;
+			rba.create_complete_spanning_tree(src,st,depth);
+			for (my_rba_t::frameid2pose_map_t::const_iterator it=st.begin();it!=st.end();++it)
+				dists[src][it->first] = std::min(dists[src][it->first], depth);
+		}
+
+	// Serial searches, reusing one working space:
+	my_rba_t::rba_problem_state_t::bfs_workspace_t ws;
+	std::vector<std::vector<std::vector<TKeyFrameID> > > paths(nKFs, std::vector<std::vector<TKeyFrameID> >(nKFs));
+	for (size_t src=0;src<nKFs;src++)
+		for (size_t dst=0;dst<nKFs;dst++)
+		{
+			std::vector<TKeyFrameID> &path = paths[src][dst];
+			EXPECT_TRUE( rba.find_path_bfs(src,dst,path,&ws) );
+			EXPECT_EQ( dists[src][dst], path.size() ) << "src=" << src << " dst=" << dst;
+
+			// The path must be a sequence of connected KFs ending at "dst":
+			TKeyFrameID prev = src;
+			for (size_t i=0;i<path.size();i++)
+			{
+				EXPECT_TRUE( rba.get_rba_state().are_keyframes_connected(prev,path[i]) );
+				prev = path[i];
+			}
+			EXPECT_EQ(dst, prev);
+		}
+
+	// The working space must be left ready for the next call:
+	for (size_t i=0;i<ws.entries.size();i++)
+		EXPECT_EQ( std::numeric_limits<topo_dist_t>::max(), ws.entries[i].dist );
+
+	// Simultaneous searches from several threads:
+	std::vector<std::vector<std::vector<TKeyFrameID> > > paths_par(nKFs, std::vector<std::vector<TKeyFrameID> >(nKFs));
+	mrpt::system::parallel_for( mrpt::system::BlockedRange(0,static_cast<int>(nKFs),1), TFindPathsBody(rba,nKFs,paths_par) );
+	for (size_t src=0;src<nKFs;src++)
+		for (size_t dst=0;dst<nKFs;dst++)
+			EXPECT_TRUE( paths[src][dst]==paths_par[src][dst] ) << "src=" << src << " dst=" << dst;
+}
@@ -29,6 +29,7 @@
 #include <mrpt/vision/tracking.h>
 #include <mrpt/vision/descriptor_kdtrees.h>
 #include <mrpt/vision/descriptor_pairing.h>
+#include <mrpt/vision/CHammingLSHIndex.h>
 #include <mrpt/vision/bundle_adjustment.h>
 #include <mrpt/vision/CUndistortMap.h>
 #include <mrpt/vision/CStereoRectifyMap.h>
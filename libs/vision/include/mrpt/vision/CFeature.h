@@ -99,12 +99,14 @@ namespace mrpt
 				mrpt::math::CMatrix			    LogPolarImg;	        //!< A log-polar image centered at the interest point
 				bool						    polarImgsNoRotation;    //!< If set to true (manually, default=false) the call to "descriptorDistanceTo" will not consider all the rotations between polar image descriptors (PolarImg, LogPolarImg)
 				deque<vector<vector<int32_t> > >    multiSIFTDescriptors;   //!< A set of SIFT-like descriptors for each orientation and scale of the multiResolution feature (there is a vector of descriptors for each scale)
+				std::vector<uint8_t>	        ORB;			        //!< Binary descriptor: 256 bits packed in 32 bytes (see CFeatureExtraction::computeDescriptors)
 
 				bool hasDescriptorSIFT() const { return !SIFT.empty(); };                       //!< Whether this feature has this kind of descriptor
 				bool hasDescriptorSURF() const { return !SURF.empty(); }                        //!< Whether this feature has this kind of descriptor
 				bool hasDescriptorSpinImg() const { return !SpinImg.empty(); };                 //!< Whether this feature has this kind of descriptor
 				bool hasDescriptorPolarImg() const { return PolarImg.rows()!=0; } ;             //!< Whether this feature has this kind of descriptor
 				bool hasDescriptorLogPolarImg() const { return LogPolarImg.rows()!=0; } ;       //!< Whether this feature has this kind of descriptor
+				bool hasDescriptorORB() const { return !ORB.empty(); }                          //!< Whether this feature has this kind of descriptor
 				bool hasDescriptorMultiSIFT() const {
                     return (multiSIFTDescriptors.size() > 0 && multiSIFTDescriptors[0].size() > 0); //!< Whether this feature has this kind of descriptor
                 }
@@ -137,6 +139,10 @@ namespace mrpt
 			/** Computes the Euclidean Distance between "this" and the "other" descriptors */
 			float descriptorSpinImgDistanceTo( const CFeature &oFeature, bool normalize_distances = true ) const;
 
+			/** Computes the Hamming distance between "this" and the "other" ORB descriptors (the number of different bits), divided by the number of bits if \a normalize_distances is true.
+			  * \sa mrpt::vision::hammingDistance */
+			float descriptorORBDistanceTo( const CFeature &oFeature, bool normalize_distances = true ) const;
+
 			/** Returns the minimum Euclidean Distance between "this" and the "other" polar image descriptor, for the best shift in orientation.
 			  * \param oFeature The other feature to compare with.
 			  * \param minDistAngle The placeholder for the angle at which the smallest distance is found.
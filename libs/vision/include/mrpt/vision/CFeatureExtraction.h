@@ -14,6 +14,7 @@
 #include <mrpt/vision/utils.h>
 #include <mrpt/vision/CFeature.h>
 #include <mrpt/vision/TSimpleFeature.h>
+#include <mrpt/vision/CImagePyramid.h>
 
 namespace mrpt
 {
@@ -37,6 +38,7 @@ namespace mrpt
 		  *		- SURF: OpenCV's implementation of SURF detector and descriptor.
 		  *		- The FAST feature detector (OpenCV's implementation)
 		  *		- The FASTER (9,10,12) detectors (Edward Rosten's libcvd implementation optimized for SSE2).
+		  *		- ORB: FASTER-9 run in parallel on all the octaves of an image pyramid, with the intensity-centroid orientation and the ORB descriptor (see TOptions::ORBOptions).
 		  *
 		  *  Additionally, given a list of interest points onto an image, the following
 		  *   <b>descriptors</b> can be computed for each point by calling CFeatureExtraction::computeDescriptors :
@@ -45,12 +47,14 @@ namespace mrpt
 		  *		- Intensity-domain spin images (SpinImage): Creates a vector descriptor with the 2D histogram as a single row.
 		  *		- A circular patch in polar coordinates (Polar images): The matrix descriptor is a 2D polar image centered at the interest point.
 		  *		- A log-polar image patch (Log-polar images): The matrix descriptor is the 2D log-polar image centered at the interest point.
+		  *		- ORB descriptor: a 256 bit binary descriptor (BRIEF intensity tests steered by the intensity-centroid orientation), compared with the Hamming distance. It is computed natively (OpenCV is not used).
 		  *
 		  *
 		  *  Apart from the normal entry point \a detectFeatures(), these other low-level static methods are provided for convenience:
 		  *   - CFeatureExtraction::detectFeatures_SSE2_FASTER9()
 		  *   - CFeatureExtraction::detectFeatures_SSE2_FASTER10()
 		  *   - CFeatureExtraction::detectFeatures_SSE2_FASTER12()
+		  *   - CFeatureExtraction::detectFeatures_SSE2_FASTER_pyramid()
 		  *
 		  * \note The descriptor "Intensity-domain spin images" is described in "A sparse texture representation using affine-invariant regions", S Lazebnik, C Schmid, J Ponce, 2003 IEEE Computer Society Conference on Computer Vision.
 		  * \sa mrpt::vision::CFeature
@@ -190,6 +194,14 @@ namespace mrpt
 					double rho_scale;			//!< (default=5) Log-Polar image patch will have dimensions WxH, with:  W=num_angles,  H= rho_scale * log(radius)
 				} LogPolarImagesOptions;
 
+				/** ORB Options (for the featORB detector). The FASTER threshold is taken from FASTOptions.threshold.
+				  */
+				struct VISION_IMPEXP TORBOptions
+				{
+					unsigned int n_levels;      //!< (default=3) Number of octaves of the image pyramid where features are detected (1 means only the original image)
+					float        min_distance;  //!< (default=7) Minimum distance between features detected in the same octave, in pixels of that octave
+				} ORBOptions;
+
 			};
 
 			TOptions options;  //!< Set all the parameters of the desired method here before calling "detectFeatures"
@@ -303,6 +315,21 @@ namespace mrpt
 				uint8_t octave = 0,
 				std::vector<size_t> * out_feats_index_by_row = NULL );
 
+			/** Runs the SSE2-optimized FASTER-N detector (N=9,10 or 12) on all the octaves of an image pyramid, which must be grayscale.
+			  *  The octaves are split in bands of rows and all of them are processed in parallel (see mrpt::system::parallel_for).
+			  *
+			  * \param[out] corners_by_octave One list of corners for each octave (resized to pyr.images.size()), with their coordinates in the
+			  *   resolution of that octave (i.e. they are NOT scaled to the 0-level image as with \a octave in \a detectFeatures_SSE2_FASTER9() ), sorted by rows.
+			  *
+			  *  Only the pt.{x,y} fields are filled out for each feature: the rest of fields are left <b>uninitialized</b>.
+			  * \ingroup mrptvision_features
+			  */
+			static void detectFeatures_SSE2_FASTER_pyramid(
+				const CImagePyramid &pyr,
+				std::vector<TSimpleFeatureList> & corners_by_octave,
+				const int threshold = 20,
+				const int N = 9 );
+
 			/** @} */
 
 		private:
@@ -351,6 +378,16 @@ namespace mrpt
 			void  internal_computeLogPolarImageDescriptors( const CImage	&in_img,
 										  CFeatureList		&in_features) const;
 
+			/** Compute the ORB descriptor (and the intensity-centroid orientation) of the provided features into the input image
+			* \param in_img (input) The image from where to compute the descriptors.
+			* \param in_features (input/output) The list of features whose descriptors are going to be computed.
+			*
+			* \note The features' \a orientation is overwritten with the intensity-centroid orientation (in radians). For featORB features, the descriptor is computed
+			*        in the pyramid octave given by the feature \a scale (2^octave).
+			*/
+			void  internal_computeORBDescriptors( const CImage	&in_img,
+										  CFeatureList		&in_features) const;
+
 			/** Select good features using the openCV implementation of the KLT method.
 			* \param img (input) The image from where to select extract the images.
 			* \param feats (output) A complete list of features (containing a patch for each one of them if options.patchsize > 0).
@@ -453,6 +490,15 @@ namespace mrpt
 				const TImageROI			&ROI = TImageROI()) const;
 
 
+			/** Multi-scale FASTER-9 detector with ORB orientations & descriptors (see TOptions::ORBOptions) */
+			void  extractFeaturesORB(
+				const CImage			&img,
+				CFeatureList			&feats,
+				unsigned int			init_ID = 0,
+				unsigned int			nDesiredFeatures = 0,
+				const TImageROI			&ROI = TImageROI()) const;
+
+
 			// ------------------------------------------------------------------------------------
 			//								my_scale_space_extrema
 			// ------------------------------------------------------------------------------------
@@ -0,0 +1,174 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef mrpt_vision_CHammingLSHIndex_H
+#define mrpt_vision_CHammingLSHIndex_H
+
+#include <mrpt/vision/types.h>
+#include <mrpt/vision/CFeature.h>
+#include <mrpt/vision/link_pragmas.h>
+
+#include <map>
+#include <limits>
+
+namespace mrpt
+{
+	namespace vision
+	{
+		/** \addtogroup  mrptvision_descr_kdtrees
+		    @{ */
+
+		/** An index of binary descriptors (e.g. ORB, see mrpt::vision::descORB) for approximate nearest neighbor searches in Hamming distance,
+		  *  the binary counterpart of the kd-trees for SIFT and SURF in TSIFTDescriptorsKDTreeIndex and TSURFDescriptorsKDTreeIndex.
+		  *
+		  *  It implements multi-probe Locality-Sensitive Hashing (LSH): each of the \a num_tables hash tables indexes the descriptors by
+		  *   the values of \a key_bits of their bits, chosen at random. A query looks into the bucket with its own key in each table and,
+		  *   depending on \a multi_probe_level, also in the buckets whose keys differ in 1 or 2 bits. Then, the exact Hamming distance
+		  *   (see mrpt::vision::hammingDistance) is only computed for the descriptors found in those buckets.
+		  *
+		  *  Unlike the kd-trees, descriptors can be inserted incrementally at any time (e.g. those of each new keyframe), without rebuilding the index.
+		  *   Each descriptor may be tagged with a "group" number (e.g. the ID of its keyframe), which allows place recognition
+		  *   by counting the matches of a set of query features with each group (see countMatchesByGroup).
+		  *
+		  *  Searches are thread-safe as long as no descriptors are inserted at the same time, and the batched versions of the searches
+		  *   already run in parallel (see mrpt::system::parallel_for).
+		  *
+		  *  Example of usage:
+		  *  \code
+		  *    CHammingLSHIndex  index;
+		  *    index.insert(feats_keyframe1, 1);  // ORB features
+		  *    index.insert(feats_keyframe2, 2);
+		  *    // ...
+		  *    std::vector<std::vector<size_t> >   idxs;
+		  *    std::vector<std::vector<uint32_t> > dists;
+		  *    index.knnSearch(query_feats, 2, idxs, dists);
+		  *  \endcode
+		  *
+		  * \sa mrpt::vision::find_descriptor_pairings
+		  */
+		class VISION_IMPEXP CHammingLSHIndex
+		{
+		public:
+			/** Creates an empty index.
+			  * \param desc_bytes The length of the descriptors (32 for ORB).
+			  * \param num_tables The number of hash tables: more tables give better recall, but slower searches and more memory.
+			  * \param key_bits The number of bits of the key of each table (at most 20, since each table has 2^key_bits buckets): more bits give smaller buckets, and faster but less accurate searches.
+			  * \param multi_probe_level 0: look only in the bucket with the same key; 1: also in those with keys at Hamming distance 1; 2: also at distance 2.
+			  * \param random_seed The seed to choose the bits of the keys.
+			  */
+			CHammingLSHIndex(
+				const size_t desc_bytes = 32,
+				const unsigned int num_tables = 8,
+				const unsigned int key_bits = 16,
+				const unsigned int multi_probe_level = 1,
+				const uint32_t random_seed = 0x1234 );
+
+			/** Removes all the descriptors, keeping the parameters of the index */
+			void clear();
+
+			/** The number of indexed descriptors */
+			inline size_t size() const { return m_groups.size(); }
+
+			/** Inserts one descriptor of \a getDescriptorBytes() bytes.
+			  * \return Its index, which is the number of descriptors inserted before it.
+			  */
+			size_t insert(const uint8_t *desc, const uint32_t group = 0);
+
+			/** Inserts the ORB descriptors of a list of features, all of them in the given group. The indices of the new descriptors follow the order of the list.
+			  * \return The index of the first new descriptor.
+			  * \exception std::exception If any feature has no ORB descriptor, or it has a different length.
+			  */
+			size_t insert(const CFeatureList &feats, const uint32_t group = 0);
+
+			/** Finds the (approximate) \a k nearest neighbors of one descriptor, sorted by ascending Hamming distance.
+			  *  Less than \a k neighbors may be returned if not enough descriptors share a bucket with the query.
+			  */
+			void knnSearch(
+				const uint8_t          *query,
+				const size_t            k,
+				std::vector<size_t>    &out_indices,
+				std::vector<uint32_t>  &out_distances ) const;
+
+			/** Finds the (approximate) \a k nearest neighbors of a batch of \a nQueries descriptors (stored one after another), in parallel. \sa knnSearch */
+			void knnSearch(
+				const uint8_t          *queries,
+				const size_t            nQueries,
+				const size_t            k,
+				std::vector<std::vector<size_t> >    &out_indices,
+				std::vector<std::vector<uint32_t> >  &out_distances ) const;
+
+			/** \overload For the ORB descriptors of a list of features (in parallel). */
+			void knnSearch(
+				const CFeatureList     &feats,
+				const size_t            k,
+				std::vector<std::vector<size_t> >    &out_indices,
+				std::vector<std::vector<uint32_t> >  &out_distances ) const;
+
+			/** For place recognition: for each query feature, looks for its nearest neighbor and, if its Hamming distance is at most
+			  *  \a max_distance and, if \a max_ratio<1, also below \a max_ratio times the distance to the nearest descriptor of a different group,
+			  *  counts one vote for the group of that neighbor.
+			  * \param out_votes The number of votes of each group (groups without votes are not included).
+			  */
+			void countMatchesByGroup(
+				const CFeatureList          &feats,
+				const uint32_t               max_distance,
+				std::map<uint32_t,size_t>   &out_votes,
+				const float                  max_ratio = 1.0f ) const;
+
+			inline size_t getDescriptorBytes() const { return m_desc_bytes; }  //!< The length of the descriptors
+			inline const uint8_t *getDescriptor(const size_t idx) const { return &m_descs[idx*m_desc_bytes]; } //!< One indexed descriptor (no bounds checking)
+			inline uint32_t getGroup(const size_t idx) const { return m_groups[idx]; } //!< The group of one indexed descriptor (no bounds checking)
+
+		private:
+			size_t        m_desc_bytes;
+			unsigned int  m_key_bits, m_multi_probe_level;
+
+			std::vector<uint8_t>    m_descs;   //!< All the descriptors, one after another
+			std::vector<uint32_t>   m_groups;  //!< The group of each descriptor
+
+			struct TTable
+			{
+				std::vector<uint16_t>  bits;     //!< The positions of the bits of the descriptors which make the key
+				std::vector<std::vector<uint32_t> > buckets; //!< The indices of the descriptors with each key
+			};
+			std::vector<TTable>  m_tables;
+
+			uint32_t computeKey(const TTable &t, const uint8_t *desc) const;
+
+			/** Fills \a cands with the (unique, sorted) indices of the descriptors sharing a bucket with \a query */
+			void getCandidates(const uint8_t *query, std::vector<uint32_t> &cands) const;
+
+			struct TKNNSearchBody;  // Bodies for mrpt::system::parallel_for
+			struct TVotingBody;
+		};
+
+		/** Search for pairings between a set of features and those in a CHammingLSHIndex, using their ORB descriptors.
+		  *  This is the equivalent for binary descriptors of the version of mrpt::vision::find_descriptor_pairings for kd-trees
+		  *  (the indices in the pairings are those of the descriptors in the index), and it runs in parallel.
+		  * \param descriptor Must be descORB.
+		  * \param max_neighbors The number of nearest neighbors to look for each feature.
+		  * \param max_relative_distance Neighbors are accepted if their distance is below this factor times the distance to the nearest one.
+		  * \param max_distance Neighbors are accepted if their Hamming distance is below this number of bits.
+		  * \return The overall number of pairings.
+		  * \sa CHammingLSHIndex
+		  */
+		size_t VISION_IMPEXP find_descriptor_pairings(
+			std::vector<vector_size_t>             * pairings_1_to_multi_2,
+			std::vector<std::pair<size_t,size_t> > * pairings_1_to_2,
+			const CFeatureList                     & feats_img1,
+			const CHammingLSHIndex                 & feats_img2_index,
+			const mrpt::vision::TDescriptorType      descriptor = descORB,
+			const size_t                             max_neighbors = 4,
+			const double                             max_relative_distance = 1.2,
+			const uint32_t                           max_distance = std::numeric_limits<uint32_t>::max()
+			);
+
+		/** @} */
+	}
+}
+#endif
@@ -15,6 +15,7 @@
 
 #include <mrpt/vision/CFeature.h>
 #include <mrpt/vision/TSimpleFeature.h>
+#include <mrpt/vision/CImagePyramid.h>
 #include <mrpt/utils/CImage.h>
 #include <mrpt/utils/CTimeLogger.h>
 #include <mrpt/utils/TParameters.h>
@@ -226,6 +227,13 @@ namespace mrpt
 		  *		- "LK_epsilon" (Default=0.1) Minimum epsilon step in interations of LK_tracking.
 		  *		- "LK_max_tracking_error" (Default=150.0) The maximum "tracking error" of LK tracking such as a feature is marked as "lost".
 		  *
+		  *  This is a native implementation of the pyramidal Lucas-Kanade algorithm (J.Y. Bouguet, "Pyramidal implementation of the Lucas Kanade
+		  *   feature tracker"), equivalent to OpenCV's cvCalcOpticalFlowPyrLK() but without any conversion to OpenCV images:
+		  *		- The image pyramids (see CImagePyramid) and their Scharr gradients are kept between calls: when the "old" image of one call is the
+		  *		   "new" image of the previous call (the usual case while tracking a video), its pyramid and gradients are reused, so only one pyramid is built per frame.
+		  *		- Features are tracked in parallel (see mrpt::system::parallel_for), and the inner loops have SSE2-optimized versions (if available).
+		  *		- The "tracking error" is the mean absolute difference of the intensities (in the range [0,255]) between the patches in both images.
+		  *
 		  *  \sa OpenCV's method cvCalcOpticalFlowPyrLK
 		  */
 		struct VISION_IMPEXP CFeatureTracker_KL : public CGenericFeatureTracker
@@ -235,12 +243,34 @@ namespace mrpt
 			/** Ctor with extra parameters */
 			inline CFeatureTracker_KL(mrpt::utils::TParametersDouble extraParams) : CGenericFeatureTracker(extraParams)	{ }
 
+			/** Frees the image pyramids kept from the last call (they are rebuilt automatically when needed) */
+			void clearPyramidCache();
+
+			/** The image pyramid of one image, with the gradients of each octave (computed only when needed) */
+			struct VISION_IMPEXP TLKPyramid
+			{
+				TLKPyramid() : has_gradients(false) { }
+
+				CImagePyramid  pyr;
+				std::vector<std::vector<int16_t> >  grad_x, grad_y;  //!< For each octave, its Scharr gradients (row-major, 32 times the intensity gradient)
+				bool           has_gradients;
+
+				void swap(TLKPyramid &o);
+				void clear();
+			};
+
 		protected:
 			virtual void trackFeatures_impl(const CImage &old_img,const CImage &new_img,vision::CFeatureList &inout_featureList );
 			virtual void trackFeatures_impl(const CImage &old_img,const CImage &new_img,TSimpleFeatureList  &inout_featureList );
 			virtual void trackFeatures_impl(const CImage &old_img,const CImage &new_img,TSimpleFeaturefList  &inout_featureList );
 
 		private:
+			TLKPyramid  m_prev_pyr; //!< The pyramid of the "old" image in the last call
+			TLKPyramid  m_cur_pyr;  //!< The pyramid of the "new" image in the last call, to be reused as "old" in the next one
+
+			/** Makes m_prev_pyr and m_cur_pyr to be the pyramids of both images, reusing the last ones if possible */
+			void updatePyramids(const CImage &old_img,const CImage &new_img, const size_t nOctaves);
+
 			template <typename FEATLIST>
 			void trackFeatures_impl_templ(
 				const CImage &old_img,
@@ -55,7 +55,8 @@ namespace mrpt
 			featFAST,				//!< FAST feature detector, OpenCV's implementation ("Faster and better: A machine learning approach to corner detection", E. Rosten, R. Porter and T. Drummond, PAMI, 2009).
 			featFASTER9,			//!< FASTER-9 detector, Edward Rosten's libcvd implementation optimized for SSE2.
 			featFASTER10,			//!< FASTER-9 detector, Edward Rosten's libcvd implementation optimized for SSE2.
-			featFASTER12			//!< FASTER-9 detector, Edward Rosten's libcvd implementation optimized for SSE2.
+			featFASTER12,			//!< FASTER-9 detector, Edward Rosten's libcvd implementation optimized for SSE2.
+			featORB					//!< Multi-scale FASTER-9 detector with intensity-centroid orientation, run on each octave of an image pyramid ("ORB: an efficient alternative to SIFT or SURF", E. Rublee et al., ICCV 2011).
 		};
 
 		/** The bitwise OR combination of values of TDescriptorType are used in CFeatureExtraction::computeDescriptors to indicate which descriptors are to be computed for features.
@@ -67,7 +68,8 @@ namespace mrpt
 			descSURF			= 2,  //!< SURF descriptors
 			descSpinImages      = 4,  //!< Intensity-domain spin image descriptors
 			descPolarImages     = 8,  //!< Polar image descriptor
-			descLogPolarImages	= 16  //!< Log-Polar image descriptor
+			descLogPolarImages	= 16, //!< Log-Polar image descriptor
+			descORB				= 32  //!< Oriented binary descriptor (256 intensity comparisons steered by the keypoint orientation, as in ORB)
 		};
 
 		enum TFeatureTrackStatus
@@ -294,7 +296,10 @@ namespace mrpt
 				mmDescriptorSURF,
 				/** Matching by sum of absolute differences of the image patches
 				  */
-				mmSAD
+				mmSAD,
+				/** Matching by Hamming distance between ORB descriptors
+				  */
+				mmDescriptorORB
 			};
 
 			// For determining
@@ -327,6 +332,10 @@ namespace mrpt
 			double	maxSAD_TH;                  //!< Minimum Euclidean Distance Between Sum of Absolute Differences
 			double  SAD_RATIO;                  //!< Boundary Ratio between the two highest SAD
 
+			// ORB
+			float	maxORB_TH;					//!< Maximum Hamming distance between ORB descriptors, as a fraction of the descriptor length in bits (default=0.25)
+			float	ORB_RATIO;					//!< Boundary Ratio between the two lowest Hamming distances (default=0.8)
+
 //			// To estimate depth
 			bool    estimateDepth;              //!< Whether or not estimate the 3D position of the real features for the matches (only with parallelOpticalAxis by now).
 			double  maxDepthThreshold;          //!< The maximum allowed depth for the matching. If its computed depth is larger than this, the match won't be considered.
@@ -267,6 +267,15 @@ namespace mrpt
                                 const CImage                        & patch1,
                                 const CImage                        & patch2 );
 
+			/** Computes the Hamming distance (the number of different bits) between two binary descriptors of \a nBytes bytes each, e.g. CFeature::TDescriptors::ORB.
+			  *  The bits are counted 64 at a time with the POPCNT instruction if MRPT is built with SSE4 support for a CPU which has it.
+			  * \sa CFeature::descriptorORBDistanceTo
+			  */
+			uint32_t VISION_IMPEXP hammingDistance(
+								const uint8_t                       * desc1,
+								const uint8_t                       * desc2,
+								const size_t                        nBytes );
+
 			/** Draw rectangles around each of the features on a copy of the input image.
 			  * \param inImg    [IN]    The input image where to draw the features.
 			  * \param theList  [IN]    The list of features.
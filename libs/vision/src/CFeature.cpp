@@ -17,6 +17,7 @@
 #include <mrpt/utils/CStdOutStream.h>
 #include <mrpt/vision/CFeature.h>
 #include <mrpt/vision/types.h>
+#include <mrpt/vision/utils.h>
 #include <mrpt/math/utils.h>
 
 using namespace mrpt;
@@ -251,6 +252,7 @@ void CFeature::dumpToTextStream( mrpt::utils::CStream &out) const
 	    case 7: out.printf("FASTER-9\n"); break;
 	    case 8: out.printf("FASTER-10\n"); break;
 	    case 9: out.printf("FASTER-12\n"); break;
+	    case 10: out.printf("ORB\n"); break;
 	}
 	out.printf("Status:                         ");
 	switch( track_status )
@@ -283,6 +285,8 @@ void CFeature::dumpToTextStream( mrpt::utils::CStream &out) const
 	descriptors.hasDescriptorPolarImg() ? out.printf("Yes\n") : out.printf("No\n");
 	out.printf("Has Log Polar descriptor?:      ");
 	descriptors.hasDescriptorLogPolarImg() ? out.printf("Yes\n") : out.printf("No\n");
+	out.printf("Has ORB descriptor?:            ");
+	descriptors.hasDescriptorORB() ? out.printf("Yes\n") : out.printf("No\n");
 
 	out.printf("Has multiscale?:                ");
     if( !descriptors.hasDescriptorMultiSIFT() )
@@ -316,7 +320,7 @@ void CFeature::dumpToConsole() const
 void  CFeature::writeToStream(CStream &out,int *version) const
 {
 	if (version)
-		*version = 1;
+		*version = 2;
 	else
 	{
 		// The coordinates:
@@ -347,7 +351,8 @@ void  CFeature::writeToStream(CStream &out,int *version) const
 			<< descriptors.PolarImg
 			<< descriptors.LogPolarImg
 			<< descriptors.polarImgsNoRotation
-			<< descriptors.multiSIFTDescriptors;
+			<< descriptors.multiSIFTDescriptors
+			<< descriptors.ORB;
 	}
 }
 
@@ -357,6 +362,7 @@ void  CFeature::readFromStream(CStream &in,int version)
 	{
 	case 0:
 	case 1:
+	case 2:
 		{
 			// The coordinates:
 			uint32_t aux_type, aux_KLTS;
@@ -392,6 +398,9 @@ void  CFeature::readFromStream(CStream &in,int version)
 				>> descriptors.polarImgsNoRotation;
             if( version > 0 )
                 in  >> descriptors.multiSIFTDescriptors;
+            if( version > 1 )
+                in  >> descriptors.ORB;
+            else descriptors.ORB.clear();
 
 			type		    = (TFeatureType)aux_type;
 			track_status	= (TFeatureTrackStatus)aux_KLTS;
@@ -472,6 +481,8 @@ float CFeature::descriptorDistanceTo(
 			descriptorToUse = descPolarImages;
 		else if (descriptors.hasDescriptorLogPolarImg())
 			descriptorToUse = descLogPolarImages;
+		else if (descriptors.hasDescriptorORB())
+			descriptorToUse = descORB;
 		else THROW_EXCEPTION("Feature has no descriptors and descriptorToUse=descAny")
 	}
 
@@ -493,6 +504,8 @@ float CFeature::descriptorDistanceTo(
 			float minAng;
 			return descriptorLogPolarImgDistanceTo(oFeature,minAng,normalize_distances);
 		}
+	case descORB:
+		return descriptorORBDistanceTo(oFeature,normalize_distances);
 	default:
 		THROW_EXCEPTION_CUSTOM_MSG1("Unknown value for 'descriptorToUse'=%u",(unsigned)descriptorToUse);
 	}
@@ -545,6 +558,19 @@ float CFeature::descriptorSURFDistanceTo( const CFeature &oFeature, bool normali
 	return dist;
 } // end descriptorSURFDistanceTo
 
+// --------------------------------------------------
+// descriptorORBDistanceTo
+// --------------------------------------------------
+float CFeature::descriptorORBDistanceTo( const CFeature &oFeature, bool normalize_distances ) const
+{
+	ASSERT_( this->descriptors.ORB.size() == oFeature.descriptors.ORB.size() );
+	ASSERT_( this->descriptors.hasDescriptorORB() && oFeature.descriptors.hasDescriptorORB() )
+
+	float dist = mrpt::vision::hammingDistance( &this->descriptors.ORB[0], &oFeature.descriptors.ORB[0], this->descriptors.ORB.size() );
+	if (normalize_distances) dist/= 8*this->descriptors.ORB.size();
+	return dist;
+} // end descriptorORBDistanceTo
+
 // --------------------------------------------------
 // descriptorSpinImgDistanceTo
 // --------------------------------------------------
@@ -1190,5 +1216,13 @@ bool CFeature::getFirstDescriptorAsMatrix(mrpt::math::CMatrixFloat &desc) const
 		desc = descriptors.LogPolarImg;
 		return true;
 	}
+	else if (descriptors.hasDescriptorORB())
+	{
+		// One element per bit:
+		desc.setSize(1,8*descriptors.ORB.size());
+		for (size_t i=0;i<8*descriptors.ORB.size();i++)
+			desc(0,i)=(descriptors.ORB[i>>3] >> (i & 7)) & 1;
+		return true;
+	}
 	else return false;
 }
@@ -0,0 +1,577 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/vision.h>  // Precompiled headers
+
+#include <mrpt/vision/CFeatureExtraction.h>
+#include <mrpt/system/parallelization.h>
+#include <mrpt/random/RandomGenerators.h>
+
+// Universal include for all versions of OpenCV
+#include <mrpt/otherlibs/do_opencv_includes.h>
+
+#if MRPT_HAS_OPENCV
+#	include "faster/faster_corner_prototypes.h"
+#endif
+
+using namespace mrpt;
+using namespace mrpt::vision;
+using namespace mrpt::system;
+using namespace std;
+
+// This is a native implementation of the ORB descriptor, as described in:
+//  "ORB: an efficient alternative to SIFT or SURF", E. Rublee, V. Rabaud, K. Konolige, G. Bradski, ICCV 2011.
+// Each bit is the result of one intensity comparison between two points of a smoothed patch (BRIEF), whose
+// pattern is rotated according to the intensity-centroid orientation of the patch. The 256 test pairs are drawn
+// once from an isotropic Gaussian (like the "G II" pattern of BRIEF) with a fixed seed, so descriptors are always comparable.
+
+namespace
+{
+	const int ORB_HALF_PATCH     = 15;   // Radius of the circular patch for the intensity centroid
+	const int ORB_PATTERN_RADIUS = 13;   // All the test points lie within this radius (for any rotation)
+	const int ORB_SMOOTH_HALF    = 2;    // The patch is smoothed with a 5x5 box filter
+	const int ORB_BORDER         = 16;   // Features closer than this to the image borders need clamped pixel accesses
+	const unsigned int ORB_NBITS   = 256;
+	const unsigned int ORB_NBYTES  = ORB_NBITS/8;
+	const unsigned int ORB_NANGLES = 30;   // The pattern is rotated in steps of 12 deg
+
+	/** The test pattern, precomputed for each discretized orientation */
+	struct TORBPattern
+	{
+		int8_t pts[ORB_NANGLES][ORB_NBITS][4];  // x1,y1,x2,y2
+		int    umax[ORB_HALF_PATCH+1];          // Half-width of each row of the circular patch
+
+		TORBPattern()
+		{
+			mrpt::random::CRandomGenerator rng(0x0B5E12);
+			const double sigma = (2*ORB_HALF_PATCH+1)/5.0;
+			const int R2 = ORB_PATTERN_RADIUS*ORB_PATTERN_RADIUS;
+
+			int base[ORB_NBITS][4];
+			for (unsigned int i=0;i<ORB_NBITS;i++)
+			{
+				do
+				{
+					for (int k=0;k<4;k++)
+					{
+						int v;
+						do { v = mrpt::utils::round( rng.drawGaussian1D(0,sigma) ); } while (v*v>R2);
+						base[i][k] = v;
+					}
+				} while ( base[i][0]*base[i][0]+base[i][1]*base[i][1]>R2 || base[i][2]*base[i][2]+base[i][3]*base[i][3]>R2 ||
+						  (base[i][0]==base[i][2] && base[i][1]==base[i][3]) );
+			}
+
+			for (unsigned int a=0;a<ORB_NANGLES;a++)
+			{
+				const double ang = a*M_2PI/ORB_NANGLES;
+				const double c = cos(ang), s = sin(ang);
+				for (unsigned int i=0;i<ORB_NBITS;i++)
+					for (int k=0;k<4;k+=2)
+					{
+						pts[a][i][k  ] = static_cast<int8_t>( mrpt::utils::round( c*base[i][k] - s*base[i][k+1] ) );
+						pts[a][i][k+1] = static_cast<int8_t>( mrpt::utils::round( s*base[i][k] + c*base[i][k+1] ) );
+					}
+			}
+
+			for (int v=0;v<=ORB_HALF_PATCH;v++)
+				umax[v] = static_cast<int>( floor( sqrt( double(ORB_HALF_PATCH*ORB_HALF_PATCH - v*v) ) + 0.5 ) );
+		}
+	};
+	const TORBPattern orb_pattern;
+
+	/** Pixel access to a gray image, for points far enough from the borders */
+	struct TPixelsDirect
+	{
+		const uint8_t *data;
+		size_t         stride;
+		TPixelsDirect(const uint8_t *_data, size_t _stride) : data(_data),stride(_stride) { }
+		inline int operator()(int x, int y) const { return data[y*stride+x]; }
+	};
+
+	/** Pixel access to a gray image, clamping coordinates to the image */
+	struct TPixelsClamped
+	{
+		const uint8_t *data;
+		size_t         stride;
+		int            w, h;
+		TPixelsClamped(const uint8_t *_data, size_t _stride, int _w, int _h) : data(_data),stride(_stride),w(_w),h(_h) { }
+		inline int operator()(int x, int y) const { return data[std::max(0,std::min(h-1,y))*stride+std::max(0,std::min(w-1,x))]; }
+	};
+
+	/** One octave of the pyramid, and its smoothed version (only for the intensity tests) */
+	struct TORBLevel
+	{
+		const CImage         *img;
+		std::vector<uint8_t>  smoothed;
+	};
+
+	/** 5x5 box filter of a grayscale image (replicating the borders) */
+	void boxSmooth5x5(const CImage &img, std::vector<uint8_t> &out)
+	{
+		const int w = static_cast<int>(img.getWidth());
+		const int h = static_cast<int>(img.getHeight());
+		out.resize(w*h);
+		if (!w || !h) return;
+
+		// Horizontal pass:
+		std::vector<uint16_t> tmp(w*h);
+		for (int y=0;y<h;y++)
+		{
+			const uint8_t *row = img.get_unsafe(0,y);
+			uint16_t *trow = &tmp[y*w];
+			for (int x=0;x<w;x++)
+			{
+				uint16_t sum = 0;
+				for (int k=-ORB_SMOOTH_HALF;k<=ORB_SMOOTH_HALF;k++)
+					sum += row[std::max(0,std::min(w-1,x+k))];
+				trow[x] = sum;
+			}
+		}
+		// Vertical pass:
+		const int AREA = (2*ORB_SMOOTH_HALF+1)*(2*ORB_SMOOTH_HALF+1);
+		for (int y=0;y<h;y++)
+		{
+			const uint16_t *rows[2*ORB_SMOOTH_HALF+1];
+			for (int k=-ORB_SMOOTH_HALF;k<=ORB_SMOOTH_HALF;k++)
+				rows[k+ORB_SMOOTH_HALF] = &tmp[std::max(0,std::min(h-1,y+k))*w];
+			uint8_t *orow = &out[y*w];
+			for (int x=0;x<w;x++)
+			{
+				unsigned int sum = 0;
+				for (int k=0;k<2*ORB_SMOOTH_HALF+1;k++)
+					sum += rows[k][x];
+				orow[x] = static_cast<uint8_t>( (sum + AREA/2) / AREA );
+			}
+		}
+	}
+
+	/** Intensity-centroid orientation and binary descriptor at (cx,cy) */
+	template <class PIXELS>
+	void computeORB(const PIXELS &img, const PIXELS &smoothed, const int cx, const int cy, float &out_angle, uint8_t *out_desc)
+	{
+		// Intensity centroid within a circular patch:
+		int m01 = 0, m10 = 0;
+		for (int u=-ORB_HALF_PATCH;u<=ORB_HALF_PATCH;u++)
+			m10 += u * img(cx+u,cy);
+		for (int v=1;v<=ORB_HALF_PATCH;v++)
+		{
+			int v_sum = 0;
+			const int d = orb_pattern.umax[v];
+			for (int u=-d;u<=d;u++)
+			{
+				const int val_plus = img(cx+u,cy+v), val_minus = img(cx+u,cy-v);
+				v_sum += (val_plus - val_minus);
+				m10 += u * (val_plus + val_minus);
+			}
+			m01 += v * v_sum;
+		}
+		out_angle = static_cast<float>( atan2( double(m01), double(m10) ) );
+
+		// Tests with the pattern rotated to the closest discretized orientation:
+		int a = mrpt::utils::round( out_angle * (ORB_NANGLES/M_2PI) );
+		if (a<0) a+=ORB_NANGLES;
+		if (a>=int(ORB_NANGLES)) a-=ORB_NANGLES;
+		const int8_t (*pts)[4] = orb_pattern.pts[a];
+
+		for (unsigned int i=0;i<ORB_NBYTES;i++)
+		{
+			uint8_t byte = 0;
+			for (unsigned int b=0;b<8;b++, pts++)
+				if ( smoothed(cx+(*pts)[0],cy+(*pts)[1]) < smoothed(cx+(*pts)[2],cy+(*pts)[3]) )
+					byte |= (1 << b);
+			out_desc[i] = byte;
+		}
+	}
+
+	/** Computes the orientation & descriptor of a point in one octave */
+	void computeORBAt(const TORBLevel &level, const float x, const float y, float &out_angle, std::vector<uint8_t> &out_desc)
+	{
+		const int w = static_cast<int>(level.img->getWidth());
+		const int h = static_cast<int>(level.img->getHeight());
+		const int cx = std::max(0,std::min(w-1,mrpt::utils::round(x)));
+		const int cy = std::max(0,std::min(h-1,mrpt::utils::round(y)));
+
+		out_desc.resize(ORB_NBYTES);
+		if (cx>=ORB_BORDER && cy>=ORB_BORDER && cx<w-ORB_BORDER && cy<h-ORB_BORDER)
+		{
+			computeORB(
+				TPixelsDirect(level.img->get_unsafe(0,0),level.img->getRowStride()),
+				TPixelsDirect(&level.smoothed[0],w),
+				cx,cy,out_angle,&out_desc[0]);
+		}
+		else
+		{
+			computeORB(
+				TPixelsClamped(level.img->get_unsafe(0,0),level.img->getRowStride(),w,h),
+				TPixelsClamped(&level.smoothed[0],w,w,h),
+				cx,cy,out_angle,&out_desc[0]);
+		}
+	}
+
+	/** Smooths the octaves of the pyramid, in parallel */
+	struct TSmoothLevelsBody
+	{
+		const CImagePyramid     &m_pyr;
+		std::vector<TORBLevel>  &m_levels;
+
+		TSmoothLevelsBody(const CImagePyramid &pyr, std::vector<TORBLevel> &levels) : m_pyr(pyr),m_levels(levels) { }
+
+		void operator()(const BlockedRange &r) const
+		{
+			for (int i=r.begin();i<r.end();i++)
+			{
+				m_levels[i].img = &m_pyr.images[i];
+				boxSmooth5x5(m_pyr.images[i],m_levels[i].smoothed);
+			}
+		}
+	};
+
+	/** Computes the descriptors of features [first,last) of a list, in parallel */
+	struct TComputeORBBody
+	{
+		const std::vector<TORBLevel> &m_levels;
+		CFeatureList                 &m_feats;
+		const std::vector<uint8_t>   &m_feat_octave;  // Octave of each feature in [first,last)
+		const size_t                 m_first;
+
+		TComputeORBBody(const std::vector<TORBLevel> &levels, CFeatureList &feats, const std::vector<uint8_t> &feat_octave, size_t first) :
+			m_levels(levels),m_feats(feats),m_feat_octave(feat_octave),m_first(first) { }
+
+		void operator()(const BlockedRange &r) const
+		{
+			for (int i=r.begin();i<r.end();i++)
+			{
+				CFeature &f = *m_feats[m_first+i];
+				const uint8_t octave = m_feat_octave[i];
+				const float k = 1.0f/(1<<octave);
+				computeORBAt(m_levels[octave], f.x*k, f.y*k, f.orientation, f.descriptors.ORB);
+			}
+		}
+	};
+
+	/** Computes the descriptors of features [first,end) of a list on an already built pyramid */
+	void computeORBDescriptorsInPyramid(const CImagePyramid &pyr, CFeatureList &feats, const size_t first, const std::vector<uint8_t> &feat_octave)
+	{
+		const size_t nLevels = pyr.images.size();
+		std::vector<TORBLevel> levels(nLevels);
+		mrpt::system::parallel_for( BlockedRange(0,static_cast<int>(nLevels)), TSmoothLevelsBody(pyr,levels) );
+
+		mrpt::system::parallel_for( BlockedRange(0,static_cast<int>(feats.size()-first),16), TComputeORBBody(levels,feats,feat_octave,first) );
+	}
+
+#if MRPT_HAS_OPENCV
+	/** A band of rows of one octave, the unit of work of the parallel FASTER detector */
+	struct TFASTERBand
+	{
+		size_t              octave;
+		int                 y0, y1;   // Rows [y0,y1)
+		TSimpleFeatureList  corners;
+	};
+
+	struct TFASTERBandsBody
+	{
+		const CImagePyramid        &m_pyr;
+		std::vector<TFASTERBand>   &m_bands;
+		const int                  m_threshold, m_N;
+
+		TFASTERBandsBody(const CImagePyramid &pyr, std::vector<TFASTERBand> &bands, int threshold, int N) :
+			m_pyr(pyr),m_bands(bands),m_threshold(threshold),m_N(N) { }
+
+		void operator()(const BlockedRange &r) const
+		{
+			for (int i=r.begin();i<r.end();i++)
+			{
+				TFASTERBand &band = m_bands[i];
+				const IplImage *IPL = m_pyr.images[band.octave].getAs<IplImage>();
+
+				// The band plus 3 rows above and below, the radius of the FAST circle, so corners are detected exactly
+				// as in the whole image (FAST never reports corners in the first and last 3 rows):
+				const int first_row = std::max(0,band.y0-3);
+				const int last_row  = std::min(IPL->height,band.y1+3);
+				IplImage hdr = *IPL;
+				hdr.roi       = NULL;
+				hdr.height    = last_row-first_row;
+				hdr.imageData = IPL->imageData + first_row*IPL->widthStep;
+				hdr.imageSize = hdr.height*IPL->widthStep;
+
+				TSimpleFeatureList detected;
+				switch (m_N)
+				{
+				case 9:  fast_corner_detect_9 (&hdr,detected,m_threshold,0,NULL); break;
+				case 10: fast_corner_detect_10(&hdr,detected,m_threshold,0,NULL); break;
+				case 12: fast_corner_detect_12(&hdr,detected,m_threshold,0,NULL); break;
+				};
+
+				band.corners.clear();
+				band.corners.reserve(detected.size());
+				for (size_t k=0;k<detected.size();k++)
+				{
+					TSimpleFeature f = detected[k];
+					f.pt.y += first_row;
+					if (f.pt.y<band.y0 || f.pt.y>=band.y1) continue;
+					f.octave = static_cast<uint8_t>(band.octave);
+					band.corners.push_back_fast(f);
+				}
+			}
+		}
+	};
+#endif
+
+	// For sorting candidates of all the octaves by response:
+	struct TORBCandidateSorter
+	{
+		const std::vector<TSimpleFeatureList> &m_corners;
+		TORBCandidateSorter(const std::vector<TSimpleFeatureList> &corners) : m_corners(corners) { }
+		bool operator()(const std::pair<uint8_t,size_t> &a, const std::pair<uint8_t,size_t> &b) const {
+			return m_corners[a.first][a.second].response > m_corners[b.first][b.second].response;
+		}
+	};
+
+	/** Computes the KLT response of the corners of each octave, in parallel */
+	struct TKLTResponseBody
+	{
+		const CImagePyramid              &m_pyr;
+		std::vector<TSimpleFeatureList>  &m_corners;
+
+		TKLTResponseBody(const CImagePyramid &pyr, std::vector<TSimpleFeatureList> &corners) : m_pyr(pyr),m_corners(corners) { }
+
+		void operator()(const BlockedRange &r) const
+		{
+			const int KLT_half_win = 4;
+			for (int o=r.begin();o<r.end();o++)
+			{
+				const CImage &img = m_pyr.images[o];
+				TSimpleFeatureList &corners = m_corners[o];
+				const int w = static_cast<int>(img.getWidth()), h = static_cast<int>(img.getHeight());
+				for (size_t i=0;i<corners.size();i++)
+				{
+					const int x = corners[i].pt.x, y = corners[i].pt.y;
+					// Features without room for the whole ORB patch are discarded:
+					if (x>=ORB_BORDER && y>=ORB_BORDER && x<w-ORB_BORDER && y<h-ORB_BORDER)
+							corners[i].response = img.KLT_response(x,y,KLT_half_win);
+					else	corners[i].response = -1;
+				}
+			}
+		}
+	};
+}
+
+/************************************************************************************************
+*								detectFeatures_SSE2_FASTER_pyramid								*
+************************************************************************************************/
+void CFeatureExtraction::detectFeatures_SSE2_FASTER_pyramid(
+	const CImagePyramid &pyr,
+	std::vector<TSimpleFeatureList> & corners_by_octave,
+	const int threshold,
+	const int N )
+{
+	MRPT_START
+#if MRPT_HAS_OPENCV
+	ASSERT_(N==9 || N==10 || N==12)
+
+	const size_t nOctaves = pyr.images.size();
+	corners_by_octave.resize(nOctaves);
+
+	// Split each octave in bands of rows, so the work of the large octaves is also shared among threads:
+	const int BAND_ROWS = 64;
+	std::vector<TFASTERBand> bands;
+	for (size_t o=0;o<nOctaves;o++)
+	{
+		ASSERTMSG_(!pyr.images[o].isColor(), "The image pyramid must be grayscale")
+		const int h = static_cast<int>(pyr.images[o].getHeight());
+		for (int y0=0;y0<h;y0+=BAND_ROWS)
+		{
+			TFASTERBand b;
+			b.octave = o;
+			b.y0 = y0;
+			b.y1 = std::min(h,y0+BAND_ROWS);
+			bands.push_back(b);
+		}
+	}
+
+	mrpt::system::parallel_for( BlockedRange(0,static_cast<int>(bands.size())), TFASTERBandsBody(pyr,bands,threshold,N) );
+
+	// Join the bands, in order:
+	for (size_t o=0;o<nOctaves;o++)
+		corners_by_octave[o].clear();
+	for (size_t i=0;i<bands.size();i++)
+	{
+		TSimpleFeatureList &out = corners_by_octave[bands[i].octave];
+		for (size_t k=0;k<bands[i].corners.size();k++)
+			out.push_back_fast(bands[i].corners[k]);
+	}
+#else
+	MRPT_UNUSED_PARAM(pyr); MRPT_UNUSED_PARAM(corners_by_octave);
+	MRPT_UNUSED_PARAM(threshold); MRPT_UNUSED_PARAM(N);
+	THROW_EXCEPTION("MRPT built without OpenCV support!")
+#endif
+	MRPT_END
+}
+
+/************************************************************************************************
+*								extractFeaturesORB												*
+************************************************************************************************/
+void  CFeatureExtraction::extractFeaturesORB(
+	const mrpt::utils::CImage	& inImg,
+	CFeatureList			    & feats,
+	unsigned int			    init_ID,
+	unsigned int			    nDesiredFeatures,
+	const TImageROI			    & ROI )  const
+{
+	MRPT_START
+
+#if MRPT_HAS_OPENCV
+	ASSERT_(options.ORBOptions.n_levels>=1)
+
+	// Gray-scale pyramid:
+	CImagePyramid pyr;
+	pyr.buildPyramid(inImg, options.ORBOptions.n_levels, true /*smooth*/, true /*grayscale*/);
+	const size_t nOctaves = pyr.images.size();
+
+	// Detect in all the octaves at once, then compute the responses:
+	std::vector<TSimpleFeatureList> corners;
+	detectFeatures_SSE2_FASTER_pyramid(pyr, corners, options.FASTOptions.threshold, 9);
+	mrpt::system::parallel_for( BlockedRange(0,static_cast<int>(nOctaves)), TKLTResponseBody(pyr,corners) );
+
+	// Sort all the candidates by response:
+	const bool use_ROI = !( ROI.xMax == 0 && ROI.xMin == 0 && ROI.yMax == 0 && ROI.yMin == 0 );
+	std::vector<std::pair<uint8_t,size_t> > candidates;
+	for (size_t o=0;o<nOctaves;o++)
+	{
+		const float scale = static_cast<float>(1<<o);
+		for (size_t i=0;i<corners[o].size();i++)
+		{
+			const TSimpleFeature &c = corners[o][i];
+			if (c.response<0) continue;
+			if (use_ROI && ( c.pt.x*scale<ROI.xMin || c.pt.x*scale>ROI.xMax || c.pt.y*scale<ROI.yMin || c.pt.y*scale>ROI.yMax ) )
+				continue;
+			candidates.push_back( std::make_pair(static_cast<uint8_t>(o),i) );
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), TORBCandidateSorter(corners) );
+
+	// Filter by min-distance within each octave (see the comments in extractFeaturesFASTER_N), and convert to CFeature's:
+	const bool do_filter_min_dist = options.ORBOptions.min_distance>1;
+	const unsigned int occupied_grid_cell_size = do_filter_min_dist ? options.ORBOptions.min_distance/2.0 : 1;
+	const float occupied_grid_cell_size_inv = 1.0f/occupied_grid_cell_size;
+
+	std::vector<mrpt::math::CMatrixBool> occupied_sections(nOctaves);
+	for (size_t o=0;o<nOctaves;o++)
+	{
+		occupied_sections[o].setSize(
+			!do_filter_min_dist ? 1 : (unsigned int)(1 + pyr.images[o].getWidth() * occupied_grid_cell_size_inv),
+			!do_filter_min_dist ? 1 : (unsigned int)(1 + pyr.images[o].getHeight() * occupied_grid_cell_size_inv) );
+		occupied_sections[o].fillAll(false);
+	}
+
+	const size_t	nMax	= (nDesiredFeatures!=0 && candidates.size() > nDesiredFeatures) ? nDesiredFeatures : candidates.size();
+	const int		offset	= (int)this->options.patchSize/2 + 1;
+	const int		size_2	= options.patchSize/2;
+	const int		imgH	= inImg.getHeight();
+	const int		imgW	= inImg.getWidth();
+	TFeatureID		nextID	= init_ID;
+
+	if( !options.addNewFeatures )
+		feats.clear();
+	const size_t first_new_feat = feats.size();
+	std::vector<uint8_t> feat_octave;
+	feat_octave.reserve(nMax);
+
+	for (size_t i=0; i<candidates.size() && feat_octave.size()<nMax; i++)
+	{
+		const uint8_t octave = candidates[i].first;
+		const TSimpleFeature &feat = corners[octave][candidates[i].second];
+		const int scale = 1<<octave;
+		const int x = feat.pt.x*scale, y = feat.pt.y*scale;
+
+		// Patch out of the image??
+		if (options.patchSize>0 && !( x+size_2 < imgW && x-size_2 > 0 && y+size_2 < imgH && y-size_2 > 0 ))
+			continue;
+
+		if (do_filter_min_dist)
+		{
+			mrpt::math::CMatrixBool &occ = occupied_sections[octave];
+			const size_t section_idx_x = size_t(feat.pt.x * occupied_grid_cell_size_inv);
+			const size_t section_idx_y = size_t(feat.pt.y * occupied_grid_cell_size_inv);
+
+			if (occ(section_idx_x,section_idx_y))
+				continue; // Already occupied! skip.
+
+			// Mark section as occupied
+			occ.set_unsafe(section_idx_x,section_idx_y, true);
+			if (section_idx_x>0)	occ.set_unsafe(section_idx_x-1,section_idx_y, true);
+			if (section_idx_y>0)	occ.set_unsafe(section_idx_x,section_idx_y-1, true);
+			if (section_idx_x<occ.getRowCount()-1)	occ.set_unsafe(section_idx_x+1,section_idx_y, true);
+			if (section_idx_y<occ.getColCount()-1)	occ.set_unsafe(section_idx_x,section_idx_y+1, true);
+		}
+
+		// All tests passed: add new feature:
+		CFeaturePtr ft		= CFeature::Create();
+		ft->type			= featORB;
+		ft->ID				= nextID++;
+		ft->x				= x;
+		ft->y				= y;
+		ft->response		= feat.response;
+		ft->orientation		= 0;
+		ft->scale			= scale;
+		ft->patchSize		= options.patchSize;		// The size of the feature patch
+
+		if( options.patchSize > 0 )
+		{
+			inImg.extract_patch(
+				ft->patch,
+				x - offset,
+				y - offset,
+				options.patchSize,
+				options.patchSize );						// Image patch surronding the feature
+		}
+		feats.push_back( ft );
+		feat_octave.push_back( octave );
+	}
+
+	// Orientations & descriptors, on the same pyramid:
+	computeORBDescriptorsInPyramid(pyr, feats, first_new_feat, feat_octave);
+
+#else
+	MRPT_UNUSED_PARAM(inImg); MRPT_UNUSED_PARAM(feats); MRPT_UNUSED_PARAM(init_ID);
+	MRPT_UNUSED_PARAM(nDesiredFeatures); MRPT_UNUSED_PARAM(ROI);
+	THROW_EXCEPTION("MRPT built without OpenCV support!")
+#endif
+	MRPT_END
+}
+
+/************************************************************************************************
+*								internal_computeORBDescriptors									*
+************************************************************************************************/
+void  CFeatureExtraction::internal_computeORBDescriptors(
+	const CImage	&in_img,
+	CFeatureList		&in_features) const
+{
+	MRPT_START
+
+	// The octave of each feature: only featORB features come from other octaves than the original image.
+	std::vector<uint8_t> feat_octave(in_features.size(),0);
+	size_t nOctaves = 1;
+	for (size_t i=0;i<in_features.size();i++)
+	{
+		if (in_features[i]->type==featORB && in_features[i]->scale>1)
+		{
+			feat_octave[i] = static_cast<uint8_t>( std::min(15, mrpt::utils::round( log(double(in_features[i]->scale))/log(2.0) ) ) );
+			nOctaves = std::max(nOctaves, size_t(feat_octave[i])+1);
+		}
+	}
+
+	CImagePyramid pyr;
+	pyr.buildPyramid(in_img, nOctaves, true /*smooth*/, true /*grayscale*/);
+
+	computeORBDescriptorsInPyramid(pyr, in_features, 0, feat_octave);
+
+	MRPT_END
+}
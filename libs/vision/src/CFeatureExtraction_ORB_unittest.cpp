@@ -0,0 +1,175 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/vision/CFeatureExtraction.h>
+#include <mrpt/vision/utils.h>
+#include <mrpt/random.h>
+#include <mrpt/system/parallelization.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::vision;
+using namespace mrpt::utils;
+using namespace std;
+
+// CImage has no pixel storage without OpenCV
+#if MRPT_HAS_OPENCV
+
+namespace
+{
+	/** A synthetic scene, defined at any integer coordinates: overlapping rectangles on top of a smooth random texture */
+	struct TSyntheticScene
+	{
+		struct TRect { int x0,y0,x1,y1; int intensity; };
+		std::vector<TRect>   rects;
+		std::vector<uint8_t> texture;  // Random values at the nodes of a grid of 8x8 pixels cells
+		static const int TEX_NODES = 64, TEX_CELL = 8;
+
+		TSyntheticScene(const unsigned int seed)
+		{
+			mrpt::random::CRandomGenerator rnd(seed);
+			for (int i=0;i<80;i++)
+			{
+				TRect r;
+				r.x0 = rnd.drawUniform32bit()%400 - 40;
+				r.y0 = rnd.drawUniform32bit()%320 - 40;
+				r.x1 = r.x0 + 10 + rnd.drawUniform32bit()%50;
+				r.y1 = r.y0 + 10 + rnd.drawUniform32bit()%50;
+				r.intensity = rnd.drawUniform32bit()%160;
+				rects.push_back(r);
+			}
+			texture.resize(TEX_NODES*TEX_NODES);
+			for (size_t i=0;i<texture.size();i++)
+				texture[i] = static_cast<uint8_t>(rnd.drawUniform32bit()%64);
+		}
+
+		uint8_t operator()(const int x, const int y) const
+		{
+			int v = 96;
+			for (size_t i=0;i<rects.size();i++)
+				if (x>=rects[i].x0 && x<rects[i].x1 && y>=rects[i].y0 && y<rects[i].y1)
+					v = rects[i].intensity;
+			// Bilinear interpolation of the texture:
+			const int tx = x+2*TEX_CELL, ty = y+2*TEX_CELL;  // Allow a margin of negative coordinates
+			const int cx = tx/TEX_CELL, cy = ty/TEX_CELL, fx = tx%TEX_CELL, fy = ty%TEX_CELL;
+			const int t00 = texture[cy*TEX_NODES+cx], t01 = texture[cy*TEX_NODES+cx+1];
+			const int t10 = texture[(cy+1)*TEX_NODES+cx], t11 = texture[(cy+1)*TEX_NODES+cx+1];
+			v += ( t00*(TEX_CELL-fx)*(TEX_CELL-fy) + t01*fx*(TEX_CELL-fy) + t10*(TEX_CELL-fx)*fy + t11*fx*fy ) / (TEX_CELL*TEX_CELL);
+			return static_cast<uint8_t>(v);
+		}
+
+		/** Renders the scene with its origin at pixel (ox,oy) of the image */
+		void render(CImage &img, const int ox, const int oy) const
+		{
+			img = CImage(320,240,CH_GRAY);
+			for (unsigned int y=0;y<img.getHeight();y++)
+				for (unsigned int x=0;x<img.getWidth();x++)
+					*img(x,y) = (*this)(int(x)-ox,int(y)-oy);
+		}
+	};
+
+	void setupORB(CFeatureExtraction &fext)
+	{
+		fext.options.featsType = featORB;
+		fext.options.patchSize = 0;
+		fext.options.FASTOptions.threshold = 20;
+		fext.options.ORBOptions.n_levels = 3;
+		fext.options.ORBOptions.min_distance = 0; // Keep all the corners, so the same ones are found in the shifted image
+	}
+}
+
+TEST(CFeatureExtraction, ORB_deterministic)
+{
+	const TSyntheticScene scene(1234);
+	CImage img;
+	scene.render(img,0,0);
+
+	CFeatureExtraction fext;
+	setupORB(fext);
+
+	// Runs with several threads must give exactly the same features:
+	CFeatureList feats1, feats2;
+	mrpt::system::setNumberOfParallelThreads(4); // Even on single-core machines
+	fext.detectFeatures(img, feats1);
+	fext.detectFeatures(img, feats2);
+	mrpt::system::setNumberOfParallelThreads(0);
+
+	ASSERT_GT(feats1.size(), 200u);
+	ASSERT_EQ(feats1.size(), feats2.size());
+	for (size_t i=0;i<feats1.size();i++)
+	{
+		EXPECT_EQ(feats1[i]->x, feats2[i]->x);
+		EXPECT_EQ(feats1[i]->y, feats2[i]->y);
+		EXPECT_EQ(feats1[i]->scale, feats2[i]->scale);
+		EXPECT_EQ(feats1[i]->response, feats2[i]->response);
+		EXPECT_EQ(feats1[i]->orientation, feats2[i]->orientation);
+		ASSERT_EQ(32u, feats1[i]->descriptors.ORB.size());
+		EXPECT_TRUE(feats1[i]->descriptors.ORB==feats2[i]->descriptors.ORB);
+	}
+
+	// Computing the descriptors of the detected features again gives the same ones:
+	CFeatureList feats3 = feats1;
+	for (size_t i=0;i<feats3.size();i++)
+	{
+		feats3[i].make_unique();
+		feats3[i]->descriptors.ORB.clear();
+	}
+	fext.computeDescriptors(img, feats3, descORB);
+	for (size_t i=0;i<feats1.size();i++)
+		EXPECT_TRUE(feats1[i]->descriptors.ORB==feats3[i]->descriptors.ORB);
+}
+
+TEST(CFeatureExtraction, ORB_shiftedImage)
+{
+	// The shift is a multiple of 4 pixels, so the pyramid octaves 1 and 2 are also exactly shifted:
+	const int DX = 16, DY = 8;
+	const TSyntheticScene scene(5678);
+	CImage img1, img2;
+	scene.render(img1,0,0);
+	scene.render(img2,DX,DY);
+
+	CFeatureExtraction fext;
+	setupORB(fext);
+	CFeatureList feats1, feats2;
+	fext.detectFeatures(img1, feats1);
+	fext.detectFeatures(img2, feats2);
+
+	// Features far enough from the borders of both images must be in both of them, with the same descriptor,
+	//  and their nearest neighbor in Hamming distance must be the right one:
+	size_t nInterior = 0, nFound = 0, nMatched = 0;
+	for (size_t i=0;i<feats1.size();i++)
+	{
+		const CFeature &f1 = *feats1[i];
+		const float margin = 40*f1.scale;
+		if (f1.x<margin || f1.y<margin || f1.x+DX>img1.getWidth()-margin || f1.y+DY>img1.getHeight()-margin)
+			continue;
+		nInterior++;
+
+		uint32_t best_dist = std::numeric_limits<uint32_t>::max();
+		size_t best_idx = 0;
+		for (size_t j=0;j<feats2.size();j++)
+		{
+			const CFeature &f2 = *feats2[j];
+			const uint32_t d = hammingDistance(&f1.descriptors.ORB[0],&f2.descriptors.ORB[0],32);
+			if (f2.x==f1.x+DX && f2.y==f1.y+DY && f2.scale==f1.scale)
+			{
+				nFound++;
+				EXPECT_EQ(0u, d);
+				EXPECT_EQ(f1.orientation, f2.orientation);
+			}
+			if (d<best_dist) { best_dist=d; best_idx=j; }
+		}
+		if (feats2[best_idx]->x==f1.x+DX && feats2[best_idx]->y==f1.y+DY) nMatched++;
+	}
+	EXPECT_GT(nInterior, 100u);
+	EXPECT_EQ(nInterior, nFound);
+	EXPECT_GE(nMatched, nInterior*9/10);
+}
+
+#endif
@@ -191,6 +191,10 @@ void  CFeatureExtraction::detectFeatures(
 			extractFeaturesFASTER_N(12,img, feats, init_ID, nDesiredFeatures, ROI);
 			break;
 
+		case featORB:
+			extractFeaturesORB(img, feats, init_ID, nDesiredFeatures, ROI);
+			break;
+
 		default:
 			THROW_EXCEPTION("options.method has an invalid value!");
 			break;
@@ -234,6 +238,11 @@ void  CFeatureExtraction::computeDescriptors(
 		this->internal_computeLogPolarImageDescriptors(in_img,inout_features);
 		++nDescComputed;
 	}
+	if ((in_descriptor_list & descORB) != 0)
+	{
+		this->internal_computeORBDescriptors(in_img,inout_features);
+		++nDescComputed;
+	}
 
 	if (!nDescComputed)
 		THROW_EXCEPTION_CUSTOM_MSG1("No known descriptor value found in in_descriptor_list=%u",(unsigned)in_descriptor_list)
@@ -317,6 +326,10 @@ CFeatureExtraction::TOptions::TOptions(const TFeatureType _featsType) :
 	LogPolarImagesOptions.num_angles	= 16; // Log-Polar image patch will have dimensions WxH, with:  W=num_angles,  H= rho_scale * log(radius)
 	LogPolarImagesOptions.rho_scale		= 5;
 
+	// ORBOptions
+	ORBOptions.n_levels					= 3;
+	ORBOptions.min_distance				= 7;
+
 }
 
 /*---------------------------------------------------------------
@@ -368,6 +381,9 @@ void CFeatureExtraction::TOptions::dumpToTextStream(CStream	&out) const
 	LOADABLEOPTS_DUMP_VAR(LogPolarImagesOptions.num_angles,int)
 	LOADABLEOPTS_DUMP_VAR(LogPolarImagesOptions.rho_scale,double)
 
+	LOADABLEOPTS_DUMP_VAR(ORBOptions.n_levels,int)
+	LOADABLEOPTS_DUMP_VAR(ORBOptions.min_distance,float)
+
 	out.printf("\n");
 }
 
@@ -423,5 +439,8 @@ void CFeatureExtraction::TOptions::loadFromConfigFile(
 	MRPT_LOAD_CONFIG_VAR(LogPolarImagesOptions.num_angles,int,  iniFile,section)
 	MRPT_LOAD_CONFIG_VAR(LogPolarImagesOptions.rho_scale,double,  iniFile,section)
 
+	MRPT_LOAD_CONFIG_VAR(ORBOptions.n_levels,int,  iniFile,section)
+	MRPT_LOAD_CONFIG_VAR(ORBOptions.min_distance,float,  iniFile,section)
+
 }
 
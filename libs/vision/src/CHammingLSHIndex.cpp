@@ -0,0 +1,375 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/vision.h>  // Precompiled headers
+
+#include <mrpt/vision/CHammingLSHIndex.h>
+#include <mrpt/vision/utils.h>
+#include <mrpt/system/parallelization.h>
+#include <mrpt/random/RandomGenerators.h>
+
+using namespace mrpt;
+using namespace mrpt::vision;
+using namespace mrpt::system;
+using namespace std;
+
+/*-------------------------------------------------------------
+					Constructor
+-------------------------------------------------------------*/
+CHammingLSHIndex::CHammingLSHIndex(
+	const size_t desc_bytes,
+	const unsigned int num_tables,
+	const unsigned int key_bits,
+	const unsigned int multi_probe_level,
+	const uint32_t random_seed ) :
+		m_desc_bytes(desc_bytes),
+		m_key_bits(key_bits),
+		m_multi_probe_level(multi_probe_level)
+{
+	MRPT_START
+	ASSERT_(desc_bytes>0 && desc_bytes*8<=65536)
+	ASSERT_(num_tables>0)
+	ASSERT_(key_bits>0 && key_bits<=20 && key_bits<=desc_bytes*8)
+	ASSERT_BELOWEQ_(multi_probe_level,2)
+
+	// Each table takes a different random subset of the bits of the descriptors:
+	mrpt::random::CRandomGenerator rng(random_seed);
+	std::vector<uint16_t> all_bits(desc_bytes*8);
+	for (size_t i=0;i<all_bits.size();i++) all_bits[i]=static_cast<uint16_t>(i);
+
+	m_tables.resize(num_tables);
+	for (unsigned int t=0;t<num_tables;t++)
+	{
+		// Partial Fisher-Yates shuffle: the first key_bits positions are a random subset
+		for (unsigned int j=0;j<key_bits;j++)
+			std::swap(all_bits[j], all_bits[j + rng.drawUniform32bit() % (all_bits.size()-j)]);
+
+		m_tables[t].bits.assign(all_bits.begin(),all_bits.begin()+key_bits);
+		m_tables[t].buckets.resize(size_t(1)<<key_bits);
+	}
+	MRPT_END
+}
+
+/*-------------------------------------------------------------
+					clear
+-------------------------------------------------------------*/
+void CHammingLSHIndex::clear()
+{
+	m_descs.clear();
+	m_groups.clear();
+	for (size_t t=0;t<m_tables.size();t++)
+	{
+		std::vector<std::vector<uint32_t> > &buckets = m_tables[t].buckets;
+		for (size_t b=0;b<buckets.size();b++) buckets[b].clear();
+	}
+}
+
+/*-------------------------------------------------------------
+					computeKey
+-------------------------------------------------------------*/
+uint32_t CHammingLSHIndex::computeKey(const TTable &t, const uint8_t *desc) const
+{
+	uint32_t key = 0;
+	for (unsigned int j=0;j<m_key_bits;j++)
+	{
+		const uint16_t pos = t.bits[j];
+		if ( (desc[pos>>3] >> (pos & 0x07)) & 0x01 )
+			key |= (uint32_t(1) << j);
+	}
+	return key;
+}
+
+/*-------------------------------------------------------------
+					insert
+-------------------------------------------------------------*/
+size_t CHammingLSHIndex::insert(const uint8_t *desc, const uint32_t group)
+{
+	ASSERT_(m_groups.size()<std::numeric_limits<uint32_t>::max())
+
+	const size_t idx = m_groups.size();
+	m_descs.insert(m_descs.end(), desc, desc+m_desc_bytes);
+	m_groups.push_back(group);
+
+	for (size_t t=0;t<m_tables.size();t++)
+		m_tables[t].buckets[ computeKey(m_tables[t],desc) ].push_back(static_cast<uint32_t>(idx));
+
+	return idx;
+}
+
+size_t CHammingLSHIndex::insert(const CFeatureList &feats, const uint32_t group)
+{
+	MRPT_START
+	const size_t first = m_groups.size();
+	m_descs.reserve(m_descs.size() + feats.size()*m_desc_bytes);
+	m_groups.reserve(m_groups.size() + feats.size());
+
+	for (CFeatureList::const_iterator it=feats.begin();it!=feats.end();++it)
+	{
+		const std::vector<uint8_t> &orb = (*it)->descriptors.ORB;
+		ASSERTMSG_(!orb.empty(), "CHammingLSHIndex::insert: A feature has no ORB descriptor")
+		ASSERTMSG_(orb.size()==m_desc_bytes, "CHammingLSHIndex::insert: ORB descriptor length does not match the index")
+		insert(&orb[0],group);
+	}
+	return first;
+	MRPT_END
+}
+
+/*-------------------------------------------------------------
+					getCandidates
+-------------------------------------------------------------*/
+void CHammingLSHIndex::getCandidates(const uint8_t *query, std::vector<uint32_t> &cands) const
+{
+	cands.clear();
+	for (size_t t=0;t<m_tables.size();t++)
+	{
+		const std::vector<std::vector<uint32_t> > &buckets = m_tables[t].buckets;
+		const uint32_t key = computeKey(m_tables[t],query);
+
+		const std::vector<uint32_t> &b0 = buckets[key];
+		cands.insert(cands.end(),b0.begin(),b0.end());
+
+		// Multi-probe: the buckets whose keys are 1 or 2 bits away from the query key
+		if (m_multi_probe_level>=1)
+		{
+			for (unsigned int i=0;i<m_key_bits;i++)
+			{
+				const uint32_t key1 = key ^ (uint32_t(1)<<i);
+				const std::vector<uint32_t> &b1 = buckets[key1];
+				cands.insert(cands.end(),b1.begin(),b1.end());
+
+				if (m_multi_probe_level>=2)
+				{
+					for (unsigned int j=i+1;j<m_key_bits;j++)
+					{
+						const std::vector<uint32_t> &b2 = buckets[key1 ^ (uint32_t(1)<<j)];
+						cands.insert(cands.end(),b2.begin(),b2.end());
+					}
+				}
+			}
+		}
+	}
+
+	// The same descriptor is usually found in several tables:
+	std::sort(cands.begin(),cands.end());
+	cands.erase( std::unique(cands.begin(),cands.end()), cands.end() );
+}
+
+/*-------------------------------------------------------------
+					knnSearch
+-------------------------------------------------------------*/
+void CHammingLSHIndex::knnSearch(
+	const uint8_t          *query,
+	const size_t            k,
+	std::vector<size_t>    &out_indices,
+	std::vector<uint32_t>  &out_distances ) const
+{
+	out_indices.clear();
+	out_distances.clear();
+	if (!k) return;
+
+	std::vector<uint32_t> cands;
+	getCandidates(query,cands);
+
+	std::vector<std::pair<uint32_t,uint32_t> > dist_idx(cands.size());  // (distance,index): ties are broken by the lower index
+	for (size_t i=0;i<cands.size();i++)
+		dist_idx[i] = std::make_pair( hammingDistance(query,getDescriptor(cands[i]),m_desc_bytes), cands[i] );
+
+	const size_t nOut = std::min(k,dist_idx.size());
+	std::partial_sort(dist_idx.begin(),dist_idx.begin()+nOut,dist_idx.end());
+
+	out_indices.resize(nOut);
+	out_distances.resize(nOut);
+	for (size_t i=0;i<nOut;i++)
+	{
+		out_distances[i] = dist_idx[i].first;
+		out_indices[i]   = dist_idx[i].second;
+	}
+}
+
+/** Runs knnSearch() for a batch of queries, in parallel */
+struct CHammingLSHIndex::TKNNSearchBody
+{
+	const CHammingLSHIndex                &m_index;
+	const uint8_t                         *m_queries;
+	const size_t                           m_k;
+	std::vector<std::vector<size_t> >     &m_indices;
+	std::vector<std::vector<uint32_t> >   &m_distances;
+
+	TKNNSearchBody(const CHammingLSHIndex &index, const uint8_t *queries, size_t k, std::vector<std::vector<size_t> > &indices, std::vector<std::vector<uint32_t> > &distances) :
+		m_index(index),m_queries(queries),m_k(k),m_indices(indices),m_distances(distances) { }
+
+	void operator()(const BlockedRange &r) const
+	{
+		for (int i=r.begin();i<r.end();i++)
+			m_index.knnSearch(m_queries + i*m_index.m_desc_bytes, m_k, m_indices[i], m_distances[i]);
+	}
+};
+
+void CHammingLSHIndex::knnSearch(
+	const uint8_t          *queries,
+	const size_t            nQueries,
+	const size_t            k,
+	std::vector<std::vector<size_t> >    &out_indices,
+	std::vector<std::vector<uint32_t> >  &out_distances ) const
+{
+	out_indices.resize(nQueries);
+	out_distances.resize(nQueries);
+	if (!nQueries) return;
+
+	mrpt::system::parallel_for( BlockedRange(0,static_cast<int>(nQueries),16), TKNNSearchBody(*this,queries,k,out_indices,out_distances) );
+}
+
+void CHammingLSHIndex::knnSearch(
+	const CFeatureList     &feats,
+	const size_t            k,
+	std::vector<std::vector<size_t> >    &out_indices,
+	std::vector<std::vector<uint32_t> >  &out_distances ) const
+{
+	MRPT_START
+	// Pack the descriptors one after another:
+	std::vector<uint8_t> queries;
+	queries.reserve(feats.size()*m_desc_bytes);
+	for (CFeatureList::const_iterator it=feats.begin();it!=feats.end();++it)
+	{
+		const std::vector<uint8_t> &orb = (*it)->descriptors.ORB;
+		ASSERTMSG_(orb.size()==m_desc_bytes, "CHammingLSHIndex::knnSearch: A feature has no ORB descriptor or its length does not match the index")
+		queries.insert(queries.end(),orb.begin(),orb.end());
+	}
+
+	knnSearch(queries.empty() ? NULL : &queries[0], feats.size(), k, out_indices, out_distances);
+	MRPT_END
+}
+
+/** Finds the group voted by each query feature, in parallel (-1: no vote) */
+struct CHammingLSHIndex::TVotingBody
+{
+	const CHammingLSHIndex   &m_index;
+	const CFeatureList       &m_feats;
+	const uint32_t            m_max_distance;
+	const float               m_max_ratio;
+	std::vector<int64_t>     &m_voted_group;
+
+	TVotingBody(const CHammingLSHIndex &index, const CFeatureList &feats, uint32_t max_distance, float max_ratio, std::vector<int64_t> &voted_group) :
+		m_index(index),m_feats(feats),m_max_distance(max_distance),m_max_ratio(max_ratio),m_voted_group(voted_group) { }
+
+	void operator()(const BlockedRange &r) const
+	{
+		std::vector<uint32_t> cands;
+		for (int i=r.begin();i<r.end();i++)
+		{
+			m_voted_group[i] = -1;
+			const uint8_t *query = &m_feats[i]->descriptors.ORB[0];
+			m_index.getCandidates(query,cands);
+
+			// The nearest neighbor:
+			uint32_t best_dist = std::numeric_limits<uint32_t>::max();
+			size_t   best_idx  = 0;
+			for (size_t j=0;j<cands.size();j++)
+			{
+				const uint32_t d = hammingDistance(query,m_index.getDescriptor(cands[j]),m_index.m_desc_bytes);
+				if (d<best_dist) { best_dist=d; best_idx=cands[j]; }
+			}
+			if (cands.empty() || best_dist>m_max_distance) continue;
+
+			const uint32_t best_group = m_index.m_groups[best_idx];
+			if (m_max_ratio<1.0f)
+			{
+				// The nearest neighbor in another group must be clearly farther away:
+				uint32_t other_dist = std::numeric_limits<uint32_t>::max();
+				for (size_t j=0;j<cands.size();j++)
+				{
+					if (m_index.m_groups[cands[j]]==best_group) continue;
+					const uint32_t d = hammingDistance(query,m_index.getDescriptor(cands[j]),m_index.m_desc_bytes);
+					if (d<other_dist) other_dist=d;
+				}
+				if (other_dist!=std::numeric_limits<uint32_t>::max() && best_dist>=m_max_ratio*other_dist)
+					continue;
+			}
+			m_voted_group[i] = best_group;
+		}
+	}
+};
+
+/*-------------------------------------------------------------
+					countMatchesByGroup
+-------------------------------------------------------------*/
+void CHammingLSHIndex::countMatchesByGroup(
+	const CFeatureList          &feats,
+	const uint32_t               max_distance,
+	std::map<uint32_t,size_t>   &out_votes,
+	const float                  max_ratio ) const
+{
+	MRPT_START
+	out_votes.clear();
+	const size_t N = feats.size();
+	if (!N) return;
+
+	for (size_t i=0;i<N;i++)
+		ASSERTMSG_(feats[i]->descriptors.ORB.size()==m_desc_bytes, "CHammingLSHIndex::countMatchesByGroup: A feature has no ORB descriptor or its length does not match the index")
+
+	std::vector<int64_t> voted_group(N);
+	mrpt::system::parallel_for( BlockedRange(0,static_cast<int>(N),16), TVotingBody(*this,feats,max_distance,max_ratio,voted_group) );
+
+	for (size_t i=0;i<N;i++)
+		if (voted_group[i]>=0)
+			out_votes[static_cast<uint32_t>(voted_group[i])]++;
+	MRPT_END
+}
+
+/*-------------------------------------------------------------
+					find_descriptor_pairings
+-------------------------------------------------------------*/
+size_t mrpt::vision::find_descriptor_pairings(
+	std::vector<vector_size_t>             * pairings_1_to_multi_2,
+	std::vector<std::pair<size_t,size_t> > * pairings_1_to_2,
+	const CFeatureList                     & feats_img1,
+	const CHammingLSHIndex                 & feats_img2_index,
+	const mrpt::vision::TDescriptorType      descriptor,
+	const size_t                             max_neighbors,
+	const double                             max_relative_distance,
+	const uint32_t                           max_distance )
+{
+	MRPT_START
+	ASSERT_ABOVEEQ_(max_neighbors,1)
+	ASSERT_(pairings_1_to_multi_2!=NULL || pairings_1_to_2!=NULL)
+	if (descriptor!=descORB) { THROW_EXCEPTION("This function only supports ORB descriptors") }
+
+	const size_t N=feats_img1.size();
+	if (pairings_1_to_multi_2) pairings_1_to_multi_2->assign(N, vector_size_t()); // Reset output container
+	if (pairings_1_to_2) { pairings_1_to_2->clear(); pairings_1_to_2->reserve(N); }
+
+	size_t overall_pairs = 0;
+
+	if (!N) return overall_pairs; // No features -> nothing to do
+
+	ASSERTMSG_(feats_img1[0]->descriptors.hasDescriptorORB(), "Request to match ORB features but feats_img1 has no ORB descriptors!")
+
+	std::vector<std::vector<size_t> >   indices;
+	std::vector<std::vector<uint32_t> > distances;
+	feats_img2_index.knnSearch(feats_img1, max_neighbors, indices, distances);
+
+	for (size_t i=0;i<N;i++)
+	{
+		if (distances[i].empty()) continue;
+
+		// Include all correspondences below the absolute and the relative threshold (indices comes ordered by distances):
+		const double this_thresh = std::min( max_relative_distance*distances[i][0], static_cast<double>(max_distance) );
+		for (size_t j=0;j<distances[i].size();j++)
+		{
+			if (distances[i][j]<=this_thresh) {
+				overall_pairs++;
+				if (pairings_1_to_multi_2) (*pairings_1_to_multi_2)[i].push_back(indices[i][j]);
+				if (pairings_1_to_2) pairings_1_to_2->push_back(std::make_pair(i,indices[i][j]));
+			}
+			else break;
+		}
+	}
+	return overall_pairs;
+	MRPT_END
+}
@@ -0,0 +1,230 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/vision/CHammingLSHIndex.h>
+#include <mrpt/vision/utils.h>
+#include <mrpt/random.h>
+#include <mrpt/system/parallelization.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::vision;
+using namespace std;
+
+namespace
+{
+	const size_t DESC_BYTES = 32;
+
+	void randomDescriptors(mrpt::random::CRandomGenerator &rnd, const size_t N, std::vector<uint8_t> &out)
+	{
+		out.resize(N*DESC_BYTES);
+		for (size_t i=0;i<out.size();i++)
+			out[i] = static_cast<uint8_t>(rnd.drawUniform32bit() & 0xFF);
+	}
+
+	// A copy of a descriptor with a few of its bits flipped:
+	void noisyCopy(mrpt::random::CRandomGenerator &rnd, const uint8_t *desc, const unsigned int nFlips, uint8_t *out)
+	{
+		std::copy(desc,desc+DESC_BYTES,out);
+		for (unsigned int i=0;i<nFlips;i++)
+		{
+			const unsigned int bit = rnd.drawUniform32bit() % (DESC_BYTES*8);
+			out[bit>>3] ^= (1 << (bit & 0x07));
+		}
+	}
+
+	// The smallest Hamming distance between a query and all the descriptors, by brute force:
+	uint32_t bruteForceNearestDistance(const std::vector<uint8_t> &descs, const uint8_t *query)
+	{
+		uint32_t best = std::numeric_limits<uint32_t>::max();
+		for (size_t i=0;i<descs.size()/DESC_BYTES;i++)
+			best = std::min(best, hammingDistance(query,&descs[i*DESC_BYTES],DESC_BYTES));
+		return best;
+	}
+
+	void appendFeatures(const std::vector<uint8_t> &descs, CFeatureList &feats)
+	{
+		for (size_t i=0;i<descs.size()/DESC_BYTES;i++)
+		{
+			CFeaturePtr f = CFeature::Create();
+			f->descriptors.ORB.assign(descs.begin()+i*DESC_BYTES, descs.begin()+(i+1)*DESC_BYTES);
+			feats.push_back(f);
+		}
+	}
+}
+
+TEST(CHammingLSHIndex, knnSearchRecall)
+{
+	mrpt::random::CRandomGenerator rnd(123);
+	std::vector<uint8_t> descs;
+	randomDescriptors(rnd,3000,descs);
+
+	CHammingLSHIndex index(DESC_BYTES);
+	for (size_t i=0;i<descs.size()/DESC_BYTES;i++)
+		EXPECT_EQ(i, index.insert(&descs[i*DESC_BYTES]));
+	EXPECT_EQ(3000u, index.size());
+
+	// Queries: noisy copies of indexed descriptors, as a descriptor of the same point in another image
+	const size_t nQueries = 300;
+	std::vector<uint8_t> query(DESC_BYTES);
+	size_t nFound = 0;
+	std::vector<size_t>   idxs;
+	std::vector<uint32_t> dists;
+	for (size_t q=0;q<nQueries;q++)
+	{
+		noisyCopy(rnd, &descs[(rnd.drawUniform32bit()%3000)*DESC_BYTES], 12, &query[0]);
+		index.knnSearch(&query[0], 3, idxs, dists);
+		ASSERT_EQ(idxs.size(), dists.size());
+		ASSERT_LE(idxs.size(), 3u);
+
+		// The reported distances are right and sorted, and they can't beat brute force:
+		for (size_t i=0;i<idxs.size();i++)
+		{
+			EXPECT_EQ(dists[i], hammingDistance(&query[0],index.getDescriptor(idxs[i]),DESC_BYTES));
+			if (i>0) EXPECT_LE(dists[i-1], dists[i]);
+		}
+		const uint32_t best = bruteForceNearestDistance(descs,&query[0]);
+		if (!dists.empty())
+		{
+			EXPECT_GE(dists[0], best);
+			if (dists[0]==best) nFound++;
+		}
+	}
+	// Recall of the true nearest neighbor:
+	EXPECT_GE(nFound, nQueries*9/10);
+}
+
+TEST(CHammingLSHIndex, incrementalInsertion)
+{
+	mrpt::random::CRandomGenerator rnd(456);
+	std::vector<uint8_t> descs1, descs2;
+	randomDescriptors(rnd,1000,descs1);
+	randomDescriptors(rnd,1000,descs2);
+
+	// One index built in two steps (with a search in between), another one at once:
+	CHammingLSHIndex index_inc(DESC_BYTES), index_all(DESC_BYTES);
+	CFeatureList feats1, feats2;
+	appendFeatures(descs1,feats1);
+	appendFeatures(descs2,feats2);
+
+	EXPECT_EQ(0u, index_inc.insert(feats1,1));
+	std::vector<size_t>   idxs;
+	std::vector<uint32_t> dists;
+	index_inc.knnSearch(&descs2[0], 1, idxs, dists);
+	if (!idxs.empty()) EXPECT_GT(dists[0], 0u);  // Not indexed yet
+
+	EXPECT_EQ(1000u, index_inc.insert(feats2,2));
+	EXPECT_EQ(2000u, index_inc.size());
+	EXPECT_EQ(1u, index_inc.getGroup(999));
+	EXPECT_EQ(2u, index_inc.getGroup(1000));
+
+	index_all.insert(feats1,1);
+	index_all.insert(feats2,2);
+
+	// The new descriptors are found right away, and the results are the same than with the other index:
+	std::vector<uint8_t> query(DESC_BYTES);
+	std::vector<size_t>   idxs_all;
+	std::vector<uint32_t> dists_all;
+	for (size_t i=0;i<1000;i++)
+	{
+		index_inc.knnSearch(&descs2[i*DESC_BYTES], 1, idxs, dists);
+		ASSERT_EQ(1u, idxs.size());
+		EXPECT_EQ(1000+i, idxs[0]);
+		EXPECT_EQ(0u, dists[0]);
+
+		noisyCopy(rnd, &descs1[i*DESC_BYTES], 10, &query[0]);
+		index_inc.knnSearch(&query[0], 2, idxs, dists);
+		index_all.knnSearch(&query[0], 2, idxs_all, dists_all);
+		EXPECT_TRUE(idxs==idxs_all);
+		EXPECT_TRUE(dists==dists_all);
+	}
+
+	index_inc.clear();
+	EXPECT_EQ(0u, index_inc.size());
+	index_inc.knnSearch(&descs1[0], 1, idxs, dists);
+	EXPECT_TRUE(idxs.empty());
+}
+
+TEST(CHammingLSHIndex, countMatchesByGroup)
+{
+	mrpt::random::CRandomGenerator rnd(789);
+
+	// Three "keyframes" with different descriptors:
+	CHammingLSHIndex index(DESC_BYTES);
+	std::vector<std::vector<uint8_t> > descs(3);
+	for (uint32_t g=0;g<3;g++)
+	{
+		randomDescriptors(rnd,400,descs[g]);
+		CFeatureList feats;
+		appendFeatures(descs[g],feats);
+		index.insert(feats,10+g);
+	}
+
+	// The query "image": noisy copies of 100 descriptors of the second keyframe, plus 50 unrelated ones:
+	std::vector<uint8_t> qdescs(150*DESC_BYTES), unrelated;
+	for (size_t i=0;i<100;i++)
+		noisyCopy(rnd, &descs[1][i*DESC_BYTES], 8, &qdescs[i*DESC_BYTES]);
+	randomDescriptors(rnd,50,unrelated);
+	std::copy(unrelated.begin(),unrelated.end(),qdescs.begin()+100*DESC_BYTES);
+	CFeatureList qfeats;
+	appendFeatures(qdescs,qfeats);
+
+	std::map<uint32_t,size_t> votes;
+	index.countMatchesByGroup(qfeats, 40, votes);
+	EXPECT_GE(votes[11], 90u);
+	EXPECT_LE(votes[10]+votes[12], 5u);  // Unrelated descriptors are ~128 bits away
+
+	// A descriptor which is also in another group is rejected by the ratio test, but counted without it:
+	CFeatureList ambiguous;
+	appendFeatures(std::vector<uint8_t>(descs[1].begin(),descs[1].begin()+DESC_BYTES), ambiguous);
+	index.insert(&descs[1][0], 12);
+
+	index.countMatchesByGroup(ambiguous, 40, votes);
+	EXPECT_EQ(1u, votes.size());
+	index.countMatchesByGroup(ambiguous, 40, votes, 0.8f);
+	EXPECT_TRUE(votes.empty());
+}
+
+TEST(CHammingLSHIndex, batchEqualsSingleQueries)
+{
+	mrpt::random::CRandomGenerator rnd(1011);
+	std::vector<uint8_t> descs, queries;
+	randomDescriptors(rnd,2000,descs);
+
+	CHammingLSHIndex index(DESC_BYTES);
+	for (size_t i=0;i<2000;i++)
+		index.insert(&descs[i*DESC_BYTES]);
+
+	const size_t nQueries = 250;
+	queries.resize(nQueries*DESC_BYTES);
+	for (size_t q=0;q<nQueries;q++)
+		noisyCopy(rnd, &descs[(rnd.drawUniform32bit()%2000)*DESC_BYTES], 15, &queries[q*DESC_BYTES]);
+	CFeatureList qfeats;
+	appendFeatures(queries,qfeats);
+
+	std::vector<std::vector<size_t> >   b_idxs, f_idxs;
+	std::vector<std::vector<uint32_t> > b_dists, f_dists;
+	mrpt::system::setNumberOfParallelThreads(4); // Even on single-core machines
+	index.knnSearch(&queries[0], nQueries, 4, b_idxs, b_dists);
+	index.knnSearch(qfeats, 4, f_idxs, f_dists);
+	mrpt::system::setNumberOfParallelThreads(0);
+
+	ASSERT_EQ(nQueries, b_idxs.size());
+	ASSERT_EQ(nQueries, f_idxs.size());
+	std::vector<size_t>   idxs;
+	std::vector<uint32_t> dists;
+	for (size_t q=0;q<nQueries;q++)
+	{
+		index.knnSearch(&queries[q*DESC_BYTES], 4, idxs, dists);
+		EXPECT_TRUE(idxs==b_idxs[q]);
+		EXPECT_TRUE(dists==b_dists[q]);
+		EXPECT_TRUE(idxs==f_idxs[q]);
+		EXPECT_TRUE(dists==f_dists[q]);
+	}
+}
@@ -9,20 +9,407 @@
 
 #include <mrpt/vision.h>  // Precompiled headers
 
-#include <mrpt/system/memory.h>
 #include <mrpt/vision/tracking.h>
-#include <mrpt/vision/CFeatureExtraction.h>
-
-// Universal include for all versions of OpenCV
-#include <mrpt/otherlibs/do_opencv_includes.h>
+#include <mrpt/system/parallelization.h>
+#include <mrpt/utils/SSE_types.h>
 
 
 using namespace mrpt;
 using namespace mrpt::vision;
 using namespace mrpt::utils;
+using namespace mrpt::system;
 using namespace std;
 
 
+
+// This is a native implementation of the pyramidal Lucas-Kanade tracker, as described in:
+//  J.Y. Bouguet, "Pyramidal implementation of the Lucas Kanade feature tracker. Description of the algorithm", Intel Corp., 2000.
+// All the patches are interpolated with fixed-point bilinear weights, with the same scaling than OpenCV's cvCalcOpticalFlowPyrLK():
+//  intensities are kept multiplied by 32, and the Scharr gradients already are 32 times the intensity gradient.
+namespace
+{
+	const int   W_BITS    = 14;
+	const float FLT_SCALE = 1.f/(1<<20);
+	const float MIN_EIG_THRESHOLD = 1e-4f;
+
+	inline int descale(const int x, const int n) { return (x + (1 << (n-1))) >> n; }
+
+	struct TLKPoint { float x,y; };
+
+	/** One octave of a pyramid, as plain buffers */
+	struct TLKLevel
+	{
+		const uint8_t  *img;
+		size_t          stride;  // In bytes
+		const int16_t  *gx, *gy; // Stride = cols
+		int             cols, rows;
+	};
+
+	/** Per-thread working memory */
+	struct TLKScratch
+	{
+		std::vector<uint8_t>  patch_img;
+		std::vector<int16_t>  patch_gx, patch_gy;
+		std::vector<int16_t>  Iw, Ixw, Iyw;  // The interpolated window in the old image, and its gradients
+	};
+
+	/** Returns a pointer to a (pw x ph) block of "data" with its top-left corner at (ix,iy), which may fall partly
+	  *  out of the image: in that case, the block is copied into "buf" with replicated borders. */
+	template <typename T>
+	const T* getPatch(const T *data, const size_t stride, const int cols, const int rows, const int ix, const int iy, const int pw, const int ph, std::vector<T> &buf, size_t &out_stride)
+	{
+		if (ix>=0 && iy>=0 && ix+pw<=cols && iy+ph<=rows)
+		{
+			out_stride = stride;
+			return data + iy*stride + ix;
+		}
+		buf.resize(pw*ph);
+		for (int r=0;r<ph;r++)
+		{
+			const T *row = data + std::min(std::max(iy+r,0),rows-1)*stride;
+			for (int c=0;c<pw;c++)
+				buf[r*pw+c] = row[std::min(std::max(ix+c,0),cols-1)];
+		}
+		out_stride = pw;
+		return &buf[0];
+	}
+
+	/** Computes the Scharr gradients of one image, for the rows in a given range (replicating borders) */
+	struct TScharrBody
+	{
+		const CImage &m_img;
+		int16_t      *m_gx, *m_gy;
+
+		TScharrBody(const CImage &img, int16_t *gx, int16_t *gy) : m_img(img),m_gx(gx),m_gy(gy) { }
+
+		void operator()(const BlockedRange &r) const
+		{
+			const int cols = m_img.getWidth(), rows = m_img.getHeight();
+			for (int y=r.begin();y<r.end();y++)
+			{
+				const uint8_t *p0 = m_img.get_unsafe(0,std::max(y-1,0));
+				const uint8_t *p1 = m_img.get_unsafe(0,y);
+				const uint8_t *p2 = m_img.get_unsafe(0,std::min(y+1,rows-1));
+				int16_t *gx = m_gx + y*cols, *gy = m_gy + y*cols;
+
+				for (int x=0;x<cols;x++)
+				{
+					const int xm = x>0 ? x-1 : 0;
+					const int xp = x<cols-1 ? x+1 : cols-1;
+					gx[x] = static_cast<int16_t>( 3*(p0[xp]+p2[xp]) + 10*p1[xp] - 3*(p0[xm]+p2[xm]) - 10*p1[xm] );
+					gy[x] = static_cast<int16_t>( 3*(p2[xm]+p2[xp]) + 10*p2[x] - 3*(p0[xm]+p0[xp]) - 10*p0[x] );
+				}
+			}
+		}
+	};
+
+	/** Returns true if both images are grayscale, with the same size and contents */
+	bool isSameGrayImage(const CImage &a, const CImage &b)
+	{
+		if (a.isColor() || b.isColor()) return false;
+		const size_t w = a.getWidth(), h = a.getHeight();
+		if (w!=b.getWidth() || h!=b.getHeight()) return false;
+		for (size_t y=0;y<h;y++)
+			if (memcmp(a.get_unsafe(0,y),b.get_unsafe(0,y),w)) return false;
+		return true;
+	}
+
+	/** Tracks a range of features, independently from each other */
+	struct TLKTrackBody
+	{
+		const std::vector<TLKLevel> &m_prev, &m_next;
+		const std::vector<TLKPoint> &m_pts;
+		std::vector<TLKPoint>  &m_out_pts;
+		std::vector<char>       &m_status;
+		std::vector<float>      &m_err;
+		const int    m_win_w, m_win_h;
+		const size_t m_max_iters;
+		const float  m_epsilon_sqr;
+
+		TLKTrackBody(const std::vector<TLKLevel> &prev, const std::vector<TLKLevel> &next, const std::vector<TLKPoint> &pts, std::vector<TLKPoint> &out_pts, std::vector<char> &status, std::vector<float> &err, int win_w, int win_h, size_t max_iters, float epsilon) :
+			m_prev(prev),m_next(next),m_pts(pts),m_out_pts(out_pts),m_status(status),m_err(err),m_win_w(win_w),m_win_h(win_h),m_max_iters(max_iters),m_epsilon_sqr(epsilon*epsilon)
+		{ }
+
+		void operator()(const BlockedRange &r) const
+		{
+			TLKScratch  sc;
+			sc.Iw.resize(m_win_w*m_win_h);
+			sc.Ixw.resize(m_win_w*m_win_h);
+			sc.Iyw.resize(m_win_w*m_win_h);
+
+			for (int i=r.begin();i<r.end();i++)
+				m_status[i] = trackOne(m_pts[i],m_out_pts[i],m_err[i],sc) ? 1:0;
+		}
+
+		/** Interpolates the window of the old image at (x,y) (its top-left corner) and computes the spatial gradient matrix.
+		  * \return false if the window is completely out of the image. */
+		bool computeTemplate(const TLKLevel &L, const float x, const float y, TLKScratch &sc, float &A11, float &A12, float &A22) const
+		{
+			const int ix = static_cast<int>(floor(x)), iy = static_cast<int>(floor(y));
+			if (ix < -m_win_w || ix >= L.cols || iy < -m_win_h || iy >= L.rows) return false;
+
+			const float a = x-ix, b = y-iy;
+			const int iw00 = mrpt::utils::round((1.f-a)*(1.f-b)*(1<<W_BITS));
+			const int iw01 = mrpt::utils::round(a*(1.f-b)*(1<<W_BITS));
+			const int iw10 = mrpt::utils::round((1.f-a)*b*(1<<W_BITS));
+			const int iw11 = (1<<W_BITS) - iw00 - iw01 - iw10;
+
+			size_t s, sg;
+			const uint8_t *src = getPatch(L.img,L.stride,L.cols,L.rows,ix,iy,m_win_w+1,m_win_h+1,sc.patch_img,s);
+			const int16_t *gx  = getPatch(L.gx,L.cols,L.cols,L.rows,ix,iy,m_win_w+1,m_win_h+1,sc.patch_gx,sg);
+			const int16_t *gy  = getPatch(L.gy,L.cols,L.cols,L.rows,ix,iy,m_win_w+1,m_win_h+1,sc.patch_gy,sg);
+
+			float a11=0,a12=0,a22=0;
+			for (int r=0;r<m_win_h;r++, src+=s, gx+=sg, gy+=sg)
+			{
+				int16_t *Iw = &sc.Iw[r*m_win_w], *Ixw = &sc.Ixw[r*m_win_w], *Iyw = &sc.Iyw[r*m_win_w];
+				for (int c=0;c<m_win_w;c++)
+				{
+					const int ival  = descale(src[c]*iw00 + src[c+1]*iw01 + src[c+s]*iw10 + src[c+s+1]*iw11, W_BITS-5);
+					const int ixval = descale(gx[c]*iw00 + gx[c+1]*iw01 + gx[c+sg]*iw10 + gx[c+sg+1]*iw11, W_BITS);
+					const int iyval = descale(gy[c]*iw00 + gy[c+1]*iw01 + gy[c+sg]*iw10 + gy[c+sg+1]*iw11, W_BITS);
+					Iw[c]  = static_cast<int16_t>(ival);
+					Ixw[c] = static_cast<int16_t>(ixval);
+					Iyw[c] = static_cast<int16_t>(iyval);
+					a11 += static_cast<float>(ixval*ixval);
+					a12 += static_cast<float>(ixval*iyval);
+					a22 += static_cast<float>(iyval*iyval);
+				}
+			}
+			A11 = a11*FLT_SCALE; A12 = a12*FLT_SCALE; A22 = a22*FLT_SCALE;
+			return true;
+		}
+
+		/** Computes the mismatch vector between the template and the new image at (x,y) (the top-left corner of the window),
+		  *  or the mean absolute difference of intensities if "err" is not NULL.
+		  * \return false if the window is completely out of the image. */
+		bool computeMismatch(const TLKLevel &L, const float x, const float y, TLKScratch &sc, float &b1, float &b2, float *err = NULL) const
+		{
+			const int ix = static_cast<int>(floor(x)), iy = static_cast<int>(floor(y));
+			if (ix < -m_win_w || ix >= L.cols || iy < -m_win_h || iy >= L.rows) return false;
+
+			const float a = x-ix, b = y-iy;
+			const int iw00 = mrpt::utils::round((1.f-a)*(1.f-b)*(1<<W_BITS));
+			const int iw01 = mrpt::utils::round(a*(1.f-b)*(1<<W_BITS));
+			const int iw10 = mrpt::utils::round((1.f-a)*b*(1<<W_BITS));
+			const int iw11 = (1<<W_BITS) - iw00 - iw01 - iw10;
+
+			size_t s;
+			const uint8_t *src = getPatch(L.img,L.stride,L.cols,L.rows,ix,iy,m_win_w+1,m_win_h+1,sc.patch_img,s);
+
+			float sb1=0, sb2=0;
+			int   sum_abs_diff=0;
+#if MRPT_HAS_SSE2
+			const __m128i z  = _mm_setzero_si128();
+			const __m128i qw0 = _mm_set1_epi32( (iw00 & 0xFFFF) | (iw01 << 16) );
+			const __m128i qw1 = _mm_set1_epi32( (iw10 & 0xFFFF) | (iw11 << 16) );
+			const __m128i qdelta = _mm_set1_epi32( 1 << (W_BITS-5-1) );
+			__m128 qb1 = _mm_setzero_ps(), qb2 = _mm_setzero_ps();
+#endif
+			for (int r=0;r<m_win_h;r++, src+=s)
+			{
+				const int16_t *Iw = &sc.Iw[r*m_win_w], *Ixw = &sc.Ixw[r*m_win_w], *Iyw = &sc.Iyw[r*m_win_w];
+				int c=0;
+#if MRPT_HAS_SSE2
+				if (!err)
+				{
+					for (;c+8<=m_win_w;c+=8)
+					{
+						const __m128i v00 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src+c)),z);
+						const __m128i v01 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src+c+1)),z);
+						const __m128i v10 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src+c+s)),z);
+						const __m128i v11 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src+c+s+1)),z);
+
+						__m128i t0 = _mm_add_epi32( _mm_madd_epi16(_mm_unpacklo_epi16(v00,v01),qw0), _mm_madd_epi16(_mm_unpacklo_epi16(v10,v11),qw1) );
+						__m128i t1 = _mm_add_epi32( _mm_madd_epi16(_mm_unpackhi_epi16(v00,v01),qw0), _mm_madd_epi16(_mm_unpackhi_epi16(v10,v11),qw1) );
+						t0 = _mm_srai_epi32(_mm_add_epi32(t0,qdelta), W_BITS-5);
+						t1 = _mm_srai_epi32(_mm_add_epi32(t1,qdelta), W_BITS-5);
+
+						const __m128i diff = _mm_sub_epi16( _mm_packs_epi32(t0,t1), _mm_loadu_si128(reinterpret_cast<const __m128i*>(Iw+c)) );
+						qb1 = _mm_add_ps(qb1, _mm_cvtepi32_ps(_mm_madd_epi16(diff,_mm_loadu_si128(reinterpret_cast<const __m128i*>(Ixw+c)))));
+						qb2 = _mm_add_ps(qb2, _mm_cvtepi32_ps(_mm_madd_epi16(diff,_mm_loadu_si128(reinterpret_cast<const __m128i*>(Iyw+c)))));
+					}
+				}
+#endif
+				for (;c<m_win_w;c++)
+				{
+					const int diff = descale(src[c]*iw00 + src[c+1]*iw01 + src[c+s]*iw10 + src[c+s+1]*iw11, W_BITS-5) - Iw[c];
+					sb1 += static_cast<float>(diff*Ixw[c]);
+					sb2 += static_cast<float>(diff*Iyw[c]);
+					sum_abs_diff += std::abs(diff);
+				}
+			}
+#if MRPT_HAS_SSE2
+			MRPT_ALIGN16 float bbuf[4];
+			_mm_store_ps(bbuf, qb1);  sb1 += bbuf[0]+bbuf[1]+bbuf[2]+bbuf[3];
+			_mm_store_ps(bbuf, qb2);  sb2 += bbuf[0]+bbuf[1]+bbuf[2]+bbuf[3];
+#endif
+			b1 = sb1*FLT_SCALE;
+			b2 = sb2*FLT_SCALE;
+			if (err) *err = sum_abs_diff/(32.f*m_win_w*m_win_h);
+			return true;
+		}
+
+		bool trackOne(const TLKPoint &pt, TLKPoint &out_pt, float &err, TLKScratch &sc) const
+		{
+			const int   maxLevel = static_cast<int>(m_prev.size())-1;
+			const float half_w = (m_win_w-1)*0.5f, half_h = (m_win_h-1)*0.5f;
+			const float win_area = static_cast<float>(m_win_w*m_win_h);
+
+			float nx=0, ny=0;  // The estimated position in the new image, at the current octave
+			err = 0;
+			for (int level=maxLevel;level>=0;level--)
+			{
+				const float scale = 1.f/(1<<level);
+				const float px = pt.x*scale - half_w, py = pt.y*scale - half_h;
+				if (level==maxLevel) { nx = pt.x*scale; ny = pt.y*scale; }
+				else                 { nx *= 2; ny *= 2; }
+				nx -= half_w; ny -= half_h;
+
+				float A11,A12,A22;
+				if (!computeTemplate(m_prev[level],px,py,sc,A11,A12,A22))
+				{
+					if (level==0) return false;
+					nx += half_w; ny += half_h;
+					continue;
+				}
+
+				const float minEig = (A22 + A11 - std::sqrt((A11-A22)*(A11-A22) + 4.f*A12*A12))/(2*win_area);
+				const float D = A11*A22 - A12*A12;
+				if (minEig < MIN_EIG_THRESHOLD || D < 1e-6f)
+				{
+					if (level==0) return false;
+					nx += half_w; ny += half_h;
+					continue;
+				}
+				const float iD = 1.f/D;
+
+				float prev_dx=0, prev_dy=0;
+				for (size_t j=0;j<m_max_iters;j++)
+				{
+					float b1,b2;
+					if (!computeMismatch(m_next[level],nx,ny,sc,b1,b2))
+					{
+						if (level==0) return false;
+						break;
+					}
+					const float dx = (A12*b2 - A22*b1) * iD;
+					const float dy = (A12*b1 - A11*b2) * iD;
+					nx += dx; ny += dy;
+
+					if (dx*dx+dy*dy <= m_epsilon_sqr)
+						break;
+					if (j>0 && std::abs(dx+prev_dx) < 0.01f && std::abs(dy+prev_dy) < 0.01f)
+					{	// Oscillating around the solution:
+						nx -= dx*0.5f; ny -= dy*0.5f;
+						break;
+					}
+					prev_dx = dx; prev_dy = dy;
+				}
+
+				if (level==0)
+				{
+					float b1,b2;
+					if (!computeMismatch(m_next[0],nx,ny,sc,b1,b2,&err))
+						return false;
+				}
+				nx += half_w; ny += half_h;
+			}
+			out_pt.x = nx;
+			out_pt.y = ny;
+			return true;
+		}
+	};
+
+	void getLevels(const CFeatureTracker_KL::TLKPyramid &p, std::vector<TLKLevel> &levels)
+	{
+		const size_t N = p.pyr.images.size();
+		levels.resize(N);
+		for (size_t i=0;i<N;i++)
+		{
+			const CImage &im = p.pyr.images[i];
+			TLKLevel &L = levels[i];
+			L.img    = im.get_unsafe(0,0);
+			L.stride = im.getRowStride();
+			L.cols   = im.getWidth();
+			L.rows   = im.getHeight();
+			L.gx     = p.has_gradients ? &p.grad_x[i][0] : NULL;
+			L.gy     = p.has_gradients ? &p.grad_y[i][0] : NULL;
+		}
+	}
+
+	void buildLKPyramid(CFeatureTracker_KL::TLKPyramid &p, const CImage &img, const size_t nOctaves)
+	{
+		CImage im(img);  // The pyramid must own its data, since it will be kept for the next call
+		p.pyr.buildPyramidFast(im,nOctaves,true /*smooth*/,true /*grayscale*/);
+		p.has_gradients = false;
+	}
+
+	void computeLKGradients(CFeatureTracker_KL::TLKPyramid &p)
+	{
+		if (p.has_gradients) return;
+		const size_t N = p.pyr.images.size();
+		p.grad_x.resize(N);
+		p.grad_y.resize(N);
+		for (size_t i=0;i<N;i++)
+		{
+			const CImage &im = p.pyr.images[i];
+			const size_t n = im.getWidth()*im.getHeight();
+			p.grad_x[i].resize(n);
+			p.grad_y[i].resize(n);
+			parallel_for( BlockedRange(0,static_cast<int>(im.getHeight()),32), TScharrBody(im,&p.grad_x[i][0],&p.grad_y[i][0]) );
+		}
+		p.has_gradients = true;
+	}
+}
+
+void CFeatureTracker_KL::TLKPyramid::swap(TLKPyramid &o)
+{
+	pyr.images.swap(o.pyr.images);
+	grad_x.swap(o.grad_x);
+	grad_y.swap(o.grad_y);
+	std::swap(has_gradients,o.has_gradients);
+}
+
+void CFeatureTracker_KL::TLKPyramid::clear()
+{
+	pyr.images.clear();
+	grad_x.clear();
+	grad_y.clear();
+	has_gradients = false;
+}
+
+void CFeatureTracker_KL::clearPyramidCache()
+{
+	m_prev_pyr.clear();
+	m_cur_pyr.clear();
+}
+
+void CFeatureTracker_KL::updatePyramids(const CImage &old_img,const CImage &new_img, const size_t nOctaves)
+{
+	// The usual case: the old image is the new one of the last call:
+	if (m_cur_pyr.pyr.images.size()==nOctaves && isSameGrayImage(old_img,m_cur_pyr.pyr.images[0]))
+	{
+		m_timlog.enter("[CFeatureTracker_KL] reuse pyramid");
+		m_prev_pyr.swap(m_cur_pyr);
+		m_timlog.leave("[CFeatureTracker_KL] reuse pyramid");
+	}
+	else if (!(m_prev_pyr.pyr.images.size()==nOctaves && isSameGrayImage(old_img,m_prev_pyr.pyr.images[0])))
+	{
+		m_timlog.enter("[CFeatureTracker_KL] build pyramid");
+		buildLKPyramid(m_prev_pyr,old_img,nOctaves);
+		m_timlog.leave("[CFeatureTracker_KL] build pyramid");
+	}
+
+	m_timlog.enter("[CFeatureTracker_KL] gradients");
+	computeLKGradients(m_prev_pyr);
+	m_timlog.leave("[CFeatureTracker_KL] gradients");
+
+	m_timlog.enter("[CFeatureTracker_KL] build pyramid");
+	buildLKPyramid(m_cur_pyr,new_img,nOctaves);
+	m_timlog.leave("[CFeatureTracker_KL] build pyramid");
+}
+
 /** Track a set of features from old_img -> new_img using sparse optimal flow (classic KL method)
   *  Optional parameters that can be passed in "extra_params":
   *		- "window_width"  (Default=15)
@@ -36,65 +423,54 @@ void CFeatureTracker_KL::trackFeatures_impl_templ(
 	const CImage &new_img,
 	FEATLIST &featureList )
 {
-MRPT_START
+	MRPT_START
 
-#if MRPT_HAS_OPENCV
 	const unsigned int 	window_width = extra_params.getWithDefaultVal("window_width",15);
 	const unsigned int 	window_height = extra_params.getWithDefaultVal("window_height",15);
 
 	const int 	LK_levels    = extra_params.getWithDefaultVal("LK_levels",3);
 	const int 	LK_max_iters = extra_params.getWithDefaultVal("LK_max_iters",10);
-	const int 	LK_epsilon   = extra_params.getWithDefaultVal("LK_epsilon",0.1);
+	const float LK_epsilon   = extra_params.getWithDefaultVal("LK_epsilon",0.1);
 	const float LK_max_tracking_error = extra_params.getWithDefaultVal("LK_max_tracking_error",150.0f);
 
-
 	// Both images must be of the same size
 	ASSERT_( old_img.getWidth() == new_img.getWidth() && old_img.getHeight() == new_img.getHeight() );
+	ASSERT_( window_width>0 && window_height>0 && LK_levels>=0 );
 
 	const size_t  img_width  = old_img.getWidth();
 	const size_t  img_height = old_img.getHeight();
 
 	const size_t nFeatures	= featureList.size();					// Number of features
 
-	// Grayscale images
-	const CImage prev_gray(old_img, FAST_REF_OR_CONVERT_TO_GRAY);
-	const CImage cur_gray(new_img, FAST_REF_OR_CONVERT_TO_GRAY);
+	// Number of octaves: "LK_levels" halvings, as long as the windows fit into the smallest image:
+	size_t nOctaves = 1+LK_levels;
+	while (nOctaves>1 && ( (img_width>>(nOctaves-1))<=window_width || (img_height>>(nOctaves-1))<=window_height ) )
+		nOctaves--;
+
+	// Pyramids of both images (the one of old_img is usually reused from the last call):
+	updatePyramids(old_img,new_img,nOctaves);
 
-	// Array conversion MRPT->OpenCV
 	if (nFeatures>0)
 	{
-		CvPoint2D32f *points[2];
-
-		points[0] = reinterpret_cast<CvPoint2D32f *>( mrpt_alloca(sizeof(CvPoint2D32f)*nFeatures) );
-		points[1] = reinterpret_cast<CvPoint2D32f *>( mrpt_alloca(sizeof(CvPoint2D32f)*nFeatures) );
+		std::vector<TLKLevel> prev_levels, next_levels;
+		getLevels(m_prev_pyr,prev_levels);
+		getLevels(m_cur_pyr,next_levels);
 
-		std::vector<char>	status(nFeatures);
+		std::vector<TLKPoint> points0(nFeatures), points1(nFeatures);
+		std::vector<char>      status(nFeatures);
+		std::vector<float>     track_error(nFeatures);
 
 		for(size_t i=0;i<nFeatures;++i)
 		{
-			points[0][i].x = featureList.getFeatureX(i);
-			points[0][i].y = featureList.getFeatureY(i);
+			points0[i].x = featureList.getFeatureX(i);
+			points0[i].y = featureList.getFeatureY(i);
 		} // end for
 
-		// local scope for auxiliary variables around cvCalcOpticalFlowPyrLK()
-		const IplImage *prev_gray_ipl = prev_gray.getAs<IplImage>();
-		const IplImage *cur_gray_ipl  = cur_gray.getAs<IplImage>();
-
-		// Pyramids
-		// JL: It seems that cache'ing the pyramids of previous images doesn't really improve the efficiency (!?!?)
-		IplImage* pPyr = NULL;
-		IplImage* cPyr = NULL;
-
-		int	flags = 0;
-
-		float* track_error = reinterpret_cast<float*>( mrpt_alloca(sizeof(float)*nFeatures) );
-
-		cvCalcOpticalFlowPyrLK(prev_gray_ipl, cur_gray_ipl, pPyr, cPyr,
-			&points[0][0], &points[1][0], nFeatures, cvSize( window_width, window_height ), LK_levels, &status[0], track_error,
-			cvTermCriteria(CV_TERMCRIT_ITER|CV_TERMCRIT_EPS,LK_max_iters,LK_epsilon), flags );
-
-		cvReleaseImage( &pPyr );
-		cvReleaseImage( &cPyr );
+		m_timlog.enter("[CFeatureTracker_KL] track");
+		parallel_for(
+			BlockedRange(0,static_cast<int>(nFeatures),8),
+			TLKTrackBody(prev_levels,next_levels,points0,points1,status,track_error,window_width,window_height,LK_max_iters,LK_epsilon) );
+		m_timlog.leave("[CFeatureTracker_KL] track");
 
 		for(size_t i=0;i<nFeatures;++i)
 		{
@@ -102,12 +478,12 @@ MRPT_START
 
 			if( status[i] == 1 &&
 				!trck_err_too_large &&
-				points[1][i].x > 0 && points[1][i].y > 0 &&
-				points[1][i].x < img_width && points[1][i].y < img_height )
+				points1[i].x > 0 && points1[i].y > 0 &&
+				points1[i].x < img_width && points1[i].y < img_height )
 			{
 				// Feature could be tracked
-				featureList.setFeatureXf(i, points[1][i].x );
-				featureList.setFeatureYf(i, points[1][i].y );
+				featureList.setFeatureXf(i, points1[i].x );
+				featureList.setFeatureYf(i, points1[i].y );
 				featureList.setTrackStatus(i, status_TRACKED );
 			} // end if
 			else	// Feature could not be tracked
@@ -118,19 +494,10 @@ MRPT_START
 			} // end else
 		} // end for
 
-		mrpt_alloca_free( points[0] );
-		mrpt_alloca_free( points[1] );
-		mrpt_alloca_free( track_error );
-
-
 		// In case it needs to rebuild a kd-tree or whatever
 		featureList.mark_as_outdated();
 	}
 
-#else
-	THROW_EXCEPTION("The MRPT has been compiled with MRPT_HAS_OPENCV=0 !");
-#endif
-
 	MRPT_END
 } // end trackFeatures
 
@@ -0,0 +1,136 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/vision/tracking.h>
+#include <mrpt/system/parallelization.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::vision;
+using namespace mrpt::utils;
+using namespace std;
+
+// CImage has no pixel storage without OpenCV
+#if MRPT_HAS_OPENCV
+
+namespace
+{
+	/** A smooth texture, with gradients in all directions, rendered with its origin at the sub-pixel coordinates (ox,oy) */
+	void renderTexture(CImage &img, const double ox, const double oy)
+	{
+		img = CImage(320,240,CH_GRAY);
+		for (unsigned int y=0;y<img.getHeight();y++)
+			for (unsigned int x=0;x<img.getWidth();x++)
+			{
+				const double u = x-ox, v = y-oy;
+				const double val = 128
+					+ 40*sin(0.23*u + 0.6*sin(0.05*v))
+					+ 35*cos(0.19*v - 0.4*cos(0.07*u))
+					+ 20*sin(0.11*(u+v));
+				*img(x,y) = static_cast<uint8_t>( mrpt::utils::round(val) );
+			}
+	}
+
+	void gridOfFeatures(TSimpleFeaturefList &feats)
+	{
+		feats.clear();
+		TFeatureID id = 0;
+		for (int y=40;y<=200;y+=20)
+			for (int x=40;x<=280;x+=20)
+			{
+				TSimpleFeaturef f(static_cast<float>(x),static_cast<float>(y));
+				f.ID = id++;
+				f.track_status = status_IDLE;
+				f.response = 0;
+				f.octave = 0;
+				f.user_flags = 0;
+				feats.push_back(f);
+			}
+	}
+}
+
+TEST(CFeatureTracker_KL, subpixelShift)
+{
+	// Shifts per frame, both below and above the size of one pixel in the coarsest octaves:
+	const double DX[] = { 0.3, 1.7,  4.6 };
+	const double DY[] = { -0.6, 0.45, -3.2 };
+
+	CImage img0;
+	renderTexture(img0,0,0);
+	for (int k=0;k<3;k++)
+	{
+		CImage img1;
+		renderTexture(img1,DX[k],DY[k]);
+
+		TSimpleFeaturefList feats0, feats;
+		gridOfFeatures(feats0);
+		feats = feats0;
+
+		CFeatureTracker_KL tracker;
+		tracker.trackFeatures(img0,img1,feats);
+
+		ASSERT_EQ(feats0.size(), feats.size());
+		double sum_err = 0;
+		for (size_t i=0;i<feats.size();i++)
+		{
+			EXPECT_EQ(status_TRACKED, feats[i].track_status);
+			EXPECT_NEAR(feats0[i].pt.x+DX[k], feats[i].pt.x, 0.1) << "shift #" << k << " feature #" << i;
+			EXPECT_NEAR(feats0[i].pt.y+DY[k], feats[i].pt.y, 0.1) << "shift #" << k << " feature #" << i;
+			sum_err += std::abs(feats0[i].pt.x+DX[k]-feats[i].pt.x) + std::abs(feats0[i].pt.y+DY[k]-feats[i].pt.y);
+		}
+		// The intensities are rounded to integers, so the error is a small fraction of one pixel:
+		EXPECT_LT(sum_err/(2*feats.size()), 0.03) << "shift #" << k;
+	}
+}
+
+TEST(CFeatureTracker_KL, reusedPyramidEqualsNewOne)
+{
+	CImage img0, img1, img2;
+	renderTexture(img0,0,0);
+	renderTexture(img1,1.2,-0.7);
+	renderTexture(img2,2.9,-0.2);
+
+	TSimpleFeaturefList feats;
+	gridOfFeatures(feats);
+
+	// A video: the pyramid of img1 is built in the first call, and reused in the second one:
+	mrpt::system::setNumberOfParallelThreads(4); // Even on single-core machines
+	CFeatureTracker_KL tracker;
+	tracker.enableTimeLogger();
+	tracker.trackFeatures(img0,img1,feats);
+	TSimpleFeaturefList feats_new = feats;
+	tracker.trackFeatures(img1,img2,feats);
+
+	std::map<std::string,CTimeLogger::TCallStats> stats;
+	tracker.getProfiler().getStats(stats);
+	EXPECT_EQ(1u, stats["[CFeatureTracker_KL] reuse pyramid"].n_calls);
+	EXPECT_EQ(3u, stats["[CFeatureTracker_KL] build pyramid"].n_calls);
+
+	// The same with a new tracker, which must build both pyramids, and after clearing the cache:
+	CFeatureTracker_KL tracker_new;
+	TSimpleFeaturefList feats_clear = feats_new;
+	tracker_new.trackFeatures(img1,img2,feats_new);
+	tracker.clearPyramidCache();
+	tracker.trackFeatures(img1,img2,feats_clear);
+	mrpt::system::setNumberOfParallelThreads(0);
+
+	ASSERT_EQ(feats.size(), feats_new.size());
+	ASSERT_EQ(feats.size(), feats_clear.size());
+	for (size_t i=0;i<feats.size();i++)
+	{
+		EXPECT_EQ(status_TRACKED, feats[i].track_status);
+		EXPECT_EQ(feats[i].track_status, feats_new[i].track_status);
+		EXPECT_EQ(feats[i].pt.x, feats_new[i].pt.x);
+		EXPECT_EQ(feats[i].pt.y, feats_new[i].pt.y);
+		EXPECT_EQ(feats[i].pt.x, feats_clear[i].pt.x);
+		EXPECT_EQ(feats[i].pt.y, feats_clear[i].pt.y);
+	}
+}
+
+#endif
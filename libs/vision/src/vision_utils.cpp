@@ -38,6 +38,14 @@ using namespace mrpt::math;
 using namespace mrpt::system;
 using namespace std;
 
+// POPCNT instruction, for the Hamming distance of binary descriptors:
+#if MRPT_HAS_SSE4 && (defined(__POPCNT__) || defined(_MSC_VER)) && (defined(__x86_64__) || defined(_M_X64))
+	#include <nmmintrin.h>
+	#define MRPT_VISION_USE_POPCNT64 1
+#else
+	#define MRPT_VISION_USE_POPCNT64 0
+#endif
+
 #ifdef MRPT_OS_WINDOWS
     #include <process.h>
     #include <windows.h>		// TODO: This is temporary!!!
@@ -619,6 +627,28 @@ size_t vision::matchFeatures(
 					break; // end case featSURF
 				} // end mmDescriptorSURF
 
+				case TMatchingOptions::mmDescriptorORB:
+				{
+					// Ensure that both features have ORB descriptors
+					ASSERT_((*itList1)->descriptors.hasDescriptorORB() && (*itList2)->descriptors.hasDescriptorORB() );
+
+					// Compute the (normalized) Hamming distance between descriptors
+					distDesc = (*itList1)->descriptorORBDistanceTo( *(*itList2) );
+
+					// Search for the two minimum values
+					if( distDesc < minDist1 )
+					{
+						minDist2 = minDist1;
+						minDist1 = distDesc;
+						minLeftIdx  = lFeat;
+						minRightIdx = rFeat;
+					}
+					else if ( distDesc < minDist2 )
+						minDist2 = distDesc;
+
+					break;
+				} // end mmDescriptorORB
+
 				case TMatchingOptions::mmSAD:
 				{
 					// Ensure that both features have patches
@@ -698,6 +728,11 @@ size_t vision::matchFeatures(
 				cond2 = (minDist1/minDist2) < options.EDSD_RATIO;			// Ratio between the two lowest EDSD
 				minVal = minDist1;
 				break;
+			case TMatchingOptions::mmDescriptorORB:
+				cond1 = minDist1 < options.maxORB_TH;						// Maximum Hamming distance between ORB descriptors
+				cond2 = (minDist1/minDist2) < options.ORB_RATIO;			// Ratio between the two lowest distances
+				minVal = minDist1;
+				break;
 			case TMatchingOptions::mmSAD:
 				cond1 = minSAD1 < options.maxSAD_TH;
 				cond2 = (minSAD1/minSAD2) < options.SAD_RATIO;
@@ -880,6 +915,45 @@ double vision::computeSAD(
     MRPT_END
 } // end computeSAD
 
+/*-------------------------------------------------------------
+                        hammingDistance
+-------------------------------------------------------------*/
+uint32_t vision::hammingDistance(
+                    const uint8_t               * desc1,
+                    const uint8_t               * desc2,
+                    const size_t                nBytes )
+{
+	uint32_t dist = 0;
+	size_t i = 0;
+
+#if MRPT_VISION_USE_POPCNT64
+	// 64 bits at once (memcpy: the descriptors may be unaligned)
+	for ( ; i+8<=nBytes; i+=8)
+	{
+		uint64_t a,b;
+		::memcpy(&a,desc1+i,sizeof(a));
+		::memcpy(&b,desc2+i,sizeof(b));
+		dist += static_cast<uint32_t>( _mm_popcnt_u64(a ^ b) );
+	}
+#elif defined(__GNUC__)
+	for ( ; i+8<=nBytes; i+=8)
+	{
+		uint64_t a,b;
+		::memcpy(&a,desc1+i,sizeof(a));
+		::memcpy(&b,desc2+i,sizeof(b));
+		dist += __builtin_popcountll(a ^ b);
+	}
+#endif
+
+	// The remaining bytes (or all of them, if there is no popcount instruction available):
+	for ( ; i<nBytes; i++)
+	{
+		uint8_t v = desc1[i] ^ desc2[i];
+		for ( ; v; v&=v-1) dist++;
+	}
+	return dist;
+} // end hammingDistance
+
 /*-------------------------------------------------------------
 					addFeaturesToImage
 -------------------------------------------------------------*/
@@ -2184,6 +2258,10 @@ TMatchingOptions::TMatchingOptions() :
 	maxSAD_TH	( 0.4 ),
 	SAD_RATIO	( 0.5 ),
 
+	// ORB
+	maxORB_TH	( 0.25f ),
+	ORB_RATIO	( 0.8f ),
+
 	// For estimating depth
 	estimateDepth       ( false ),
 	maxDepthThreshold   ( 15.0 )
@@ -2216,6 +2294,9 @@ void  TMatchingOptions::loadFromConfigFile(
 	case 3:
 		matching_method = mmSAD;
 		break;
+	case 4:
+		matching_method = mmDescriptorORB;
+		break;
 	} // end switch
 
     useEpipolarRestriction  = iniFile.read_bool(section.c_str(), "useEpipolarRestriction", useEpipolarRestriction );
@@ -2235,6 +2316,8 @@ void  TMatchingOptions::loadFromConfigFile(
 	maxSAD_TH		= iniFile.read_float(section.c_str(),"maxSAD_TH",maxSAD_TH);
 	SAD_RATIO		= iniFile.read_float(section.c_str(),"SAD_RATIO",SAD_RATIO);
 	SAD_RATIO		= iniFile.read_float(section.c_str(),"SAD_RATIO",SAD_RATIO);
+	maxORB_TH		= iniFile.read_float(section.c_str(),"maxORB_TH",maxORB_TH);
+	ORB_RATIO		= iniFile.read_float(section.c_str(),"ORB_RATIO",ORB_RATIO);
 
 	estimateDepth       = iniFile.read_bool(section.c_str(), "estimateDepth", estimateDepth );
 	maxDepthThreshold   = iniFile.read_float(section.c_str(), "maxDepthThreshold", maxDepthThreshold );
@@ -2275,6 +2358,11 @@ void  TMatchingOptions::dumpToTextStream(
         out.printf("· Max. Dif. SAD Threshold:      %f\n", maxSAD_TH);
         out.printf("· Ratio SAD Threshold:          %f\n", SAD_RATIO);
 		break;
+	case mmDescriptorORB:
+		out.printf("ORB descriptor\n");
+        out.printf("· Max. Hamming dist. Threshold: %f\n", maxORB_TH);
+        out.printf("· Hamming dist. Ratio:          %f\n", ORB_RATIO);
+		break;
 	} // end switch
 	out.printf("Epipolar Thres:                 %.2f px\n", epipolar_TH);
 	out.printf("Using epipolar restriction?:    ");
@@ -0,0 +1,54 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2014, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/vision/utils.h>
+#include <mrpt/random.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::vision;
+using namespace std;
+
+// Reference: one bit at a time
+static uint32_t hammingDistanceBitByBit(const uint8_t *a, const uint8_t *b, const size_t nBytes)
+{
+	uint32_t dist = 0;
+	for (size_t i=0;i<nBytes;i++)
+		for (unsigned int bit=0;bit<8;bit++)
+			if ( ((a[i]>>bit) & 1) != ((b[i]>>bit) & 1) ) dist++;
+	return dist;
+}
+
+TEST(VisionUtils, hammingDistance)
+{
+	mrpt::random::CRandomGenerator rnd(1234);
+	std::vector<uint8_t> buf1(100), buf2(100);
+
+	// All the lengths around the 8-byte blocks of the POPCNT path (the remaining bytes go through the scalar loop),
+	//  at unaligned addresses, and with both random and all-different bits:
+	for (size_t nBytes=0;nBytes<=70;nBytes++)
+	{
+		for (size_t offset=0;offset<8;offset++)
+		{
+			for (size_t i=0;i<buf1.size();i++)
+			{
+				buf1[i] = static_cast<uint8_t>(rnd.drawUniform32bit() & 0xFF);
+				buf2[i] = static_cast<uint8_t>(rnd.drawUniform32bit() & 0xFF);
+			}
+			const uint8_t *a = &buf1[offset], *b = &buf2[offset];
+			EXPECT_EQ(hammingDistanceBitByBit(a,b,nBytes), hammingDistance(a,b,nBytes)) << "nBytes=" << nBytes << " offset=" << offset;
+			EXPECT_EQ(hammingDistance(a,b,nBytes), hammingDistance(b,a,nBytes));
+			EXPECT_EQ(0u, hammingDistance(a,a,nBytes));
+
+			std::vector<uint8_t> inv(nBytes);
+			for (size_t i=0;i<nBytes;i++) inv[i] = ~a[i];
+			if (nBytes) EXPECT_EQ(8*nBytes, hammingDistance(a,&inv[0],nBytes));
+		}
+	}
+}
@@ -274,6 +274,50 @@ void BenchmarkGridmaps()
 		cout << "-> " << 1000*T/N << " ms/iter" << endl;
 	}
 
+	// test 9: Ray tracing likelihood right after each insertion, as in a RBPF (one map per particle)
+	//  The single-pose evaluation doesn't rebuild the distance fields of laserScanSimulatorBatch(), which
+	//  would cost a transform of the whole grid per evaluation; the batch of poses amortizes it.
+	// -------------------------------------------------------------------------------------------------
+	if (1)
+	{
+		N = 200;
+		const size_t nPoses = 100;
+
+		*gridMap = gridMapCopy;
+		gridMap->likelihoodOptions.likelihoodMethod = COccupancyGridMap2D::lmRayTracing;
+
+		std::vector<mrpt::math::TPose2D> poses(nPoses);
+		for (size_t k=0;k<nPoses;k++)
+			poses[k] = mrpt::math::TPose2D(
+				randomGenerator.drawUniform(-1.0,1.0),
+				randomGenerator.drawUniform(-1.0,1.0),
+				randomGenerator.drawUniform(-M_PI,M_PI) );
+
+		cout << "Running test #9: Insert + rayTracing likelihood (single)... "; cout.flush();
+		double R = 0;
+		tictac.Tic();
+		for (i=0;i<N;i++)
+		{
+			const CPose3D pose3D( CPose2D(poses[i%nPoses]) );
+			gridMap->insertObservation( &scan1, &pose3D );
+			R+=gridMap->computeObservationLikelihood(&scan1,CPose2D(poses[(i+1)%nPoses]));
+		}
+		double T = tictac.Tac();
+		cout << "-> " << 1000*T/N << " ms/iter" << endl;
+
+		cout << "Running test #9: Insert + rayTracing likelihood (batch of " << nPoses << ")... "; cout.flush();
+		std::vector<double> logliks;
+		tictac.Tic();
+		for (i=0;i<N;i++)
+		{
+			const CPose3D pose3D( CPose2D(poses[i%nPoses]) );
+			gridMap->insertObservation( &scan1, &pose3D );
+			gridMap->computeObservationLikelihood_rayTracingBatch(scan1,poses,logliks);
+		}
+		T = tictac.Tac();
+		cout << "-> " << 1000*T/N << " ms/iter, " << 1e6*T/(N*nPoses) << " us/pose" << endl;
+	}
+
 }
 
 int main(int argc, char **argv)